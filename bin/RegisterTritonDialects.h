@@ -15,7 +15,10 @@ namespace test {
 void registerTestAliasPass();
 void registerTestAlignmentPass();
 void registerTestAllocationPass();
+void registerTestCodegenQualityPass();
 void registerTestMembarPass();
+void registerTestRegisterPressurePass();
+void registerTestUniformityPass();
 } // namespace test
 } // namespace mlir
 
@@ -26,7 +29,10 @@ inline void registerTritonDialects(mlir::DialectRegistry &registry) {
   mlir::test::registerTestAliasPass();
   mlir::test::registerTestAlignmentPass();
   mlir::test::registerTestAllocationPass();
+  mlir::test::registerTestCodegenQualityPass();
   mlir::test::registerTestMembarPass();
+  mlir::test::registerTestRegisterPressurePass();
+  mlir::test::registerTestUniformityPass();
   mlir::triton::registerConvertTritonToTritonGPUPass();
   mlir::triton::registerConvertTritonGPUToLLVMPass();
 
@@ -20,12 +20,43 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/ToolOutputFile.h"
 
+#include <atomic>
+#include <mutex>
+#include <optional>
+
 namespace mlir {
 namespace triton {
 
+OwningOpRef<ModuleOp>
+loadMLIRModule(std::unique_ptr<llvm::MemoryBuffer> ownedBuffer,
+               MLIRContext &context) {
+  mlir::DialectRegistry registry;
+  registry
+      .insert<TritonDialect, triton::gpu::TritonGPUDialect,
+              mlir::math::MathDialect, arith::ArithDialect, scf::SCFDialect>();
+
+  context.appendDialectRegistry(registry);
+
+  llvm::SourceMgr sourceMgr;
+  sourceMgr.AddNewSourceBuffer(std::move(ownedBuffer), SMLoc());
+
+  context.loadAllAvailableDialects();
+  context.allowUnregisteredDialects();
+
+  OwningOpRef<ModuleOp> module = parseSourceFile<ModuleOp>(sourceMgr, &context);
+  if (!module) {
+    llvm::errs() << "Parse MLIR file failed.";
+    return nullptr;
+  }
+
+  return module;
+}
+
 OwningOpRef<ModuleOp> loadMLIRModule(llvm::StringRef inputFilename,
                                      MLIRContext &context) {
   std::string errorMessage;
@@ -34,50 +65,158 @@ OwningOpRef<ModuleOp> loadMLIRModule(llvm::StringRef inputFilename,
     llvm::errs() << errorMessage << "\n";
     return nullptr;
   }
+  return loadMLIRModule(std::move(input), context);
+}
 
-  mlir::DialectRegistry registry;
-  registry
-      .insert<TritonDialect, triton::gpu::TritonGPUDialect,
-              mlir::math::MathDialect, arith::ArithDialect, scf::SCFDialect>();
+struct TranslateOptions {
+  std::string target;
+  int SMArch;
+  int ptxVersion;
+  int optLevel;
+  std::string GCNArch;
+  std::string GCNTriple;
+  std::string GCNFeatures;
+};
 
-  context.appendDialectRegistry(registry);
+// Translates `module` to the target of `options`, returns the text of the
+// result, or nothing on failure
+std::optional<std::string> translateModule(ModuleOp module,
+                                           const TranslateOptions &options) {
+  llvm::LLVMContext llvmContext;
+  auto llvmir = translateTritonGPUToLLVMIR(
+      &llvmContext, module, options.SMArch, false /*isRocm*/,
+      /*fastMath=*/false, /*printBuffer=*/false, options.optLevel);
+  if (!llvmir) {
+    llvm::errs() << "Translate to LLVM IR failed";
+    return std::nullopt;
+  }
 
-  auto processBuffer = [&](std::unique_ptr<llvm::MemoryBuffer> ownedBuffer)
-      -> OwningOpRef<ModuleOp> {
-    llvm::SourceMgr sourceMgr;
-    sourceMgr.AddNewSourceBuffer(std::move(ownedBuffer), SMLoc());
+  std::string result;
+  llvm::raw_string_ostream os(result);
+  if (options.target == "llvmir")
+    os << *llvmir << '\n';
+  else if (options.target == "ptx")
+    os << ::triton::translateLLVMIRToPTX(*llvmir, options.SMArch,
+                                         options.ptxVersion, options.optLevel);
+  else if (options.target == "hsaco") {
+    auto [module, hsaco] = ::triton::translateLLVMIRToHSACO(
+        *llvmir, options.GCNArch, options.GCNTriple, options.GCNFeatures);
+    os << hsaco;
+  } else {
+    llvm::errs() << "Error: Unknown target specified: " << options.target
+                 << "\n";
+    return std::nullopt;
+  }
+  os.flush();
+  return result;
+}
 
-    context.loadAllAvailableDialects();
-    context.allowUnregisteredDialects();
+// A module of a batch: its source and the file its translation goes to
+struct BatchJob {
+  std::unique_ptr<llvm::MemoryBuffer> buffer;
+  std::string outputFilename;
+};
 
-    OwningOpRef<ModuleOp> module =
-        parseSourceFile<ModuleOp>(sourceMgr, &context);
-    if (!module) {
-      llvm::errs() << "Parse MLIR file failed.";
-      return nullptr;
+// Builds the jobs of a batch. Each input, or each `// -----` separated chunk
+// of each input with `splitInputFile`, is a job whose output is named after
+// the input, with the chunk index and the target's extension, in `outputDir`
+// or next to the input.
+static FailureOr<std::vector<BatchJob>>
+getBatchJobs(llvm::ArrayRef<std::string> inputFilenames, bool splitInputFile,
+             llvm::StringRef outputDir, llvm::StringRef target) {
+  llvm::StringRef extension = target == "llvmir" ? ".ll"
+                              : target == "ptx"  ? ".ptx"
+                                                 : ".hsaco";
+  std::vector<BatchJob> jobs;
+  for (const std::string &inputFilename : inputFilenames) {
+    if (inputFilename == "-") {
+      llvm::errs() << "Error: batch mode cannot read from stdin\n";
+      return failure();
     }
-
-    return module;
-  };
-
-  auto module = processBuffer(std::move(input));
-  if (!module) {
-    return nullptr;
+    std::string errorMessage;
+    auto input = openInputFile(inputFilename, &errorMessage);
+    if (!input) {
+      llvm::errs() << errorMessage << "\n";
+      return failure();
+    }
+    llvm::SmallString<128> stem(outputDir.empty()
+                                    ? llvm::sys::path::parent_path(inputFilename)
+                                    : outputDir);
+    llvm::sys::path::append(stem, llvm::sys::path::stem(inputFilename));
+    if (!splitInputFile) {
+      jobs.push_back({std::move(input), (stem + extension).str()});
+      continue;
+    }
+    llvm::SmallVector<llvm::StringRef> chunks;
+    input->getBuffer().split(chunks, "// -----");
+    for (auto [idx, chunk] : llvm::enumerate(chunks))
+      jobs.push_back({llvm::MemoryBuffer::getMemBufferCopy(chunk, inputFilename),
+                      (stem + "." + llvm::Twine(idx) + extension).str()});
   }
+  return jobs;
+}
 
-  return module;
+// Translates the jobs on a thread pool, each with its own contexts
+static LogicalResult runBatch(std::vector<BatchJob> &jobs,
+                              const TranslateOptions &options,
+                              unsigned numThreads) {
+  std::atomic<bool> anyFailed{false};
+  std::mutex errorMutex;
+  llvm::ThreadPool pool(llvm::hardware_concurrency(numThreads));
+  for (BatchJob &job : jobs) {
+    pool.async([&]() {
+      MLIRContext context(MLIRContext::Threading::DISABLED);
+      auto module = loadMLIRModule(std::move(job.buffer), context);
+      std::optional<std::string> result;
+      if (module)
+        result = translateModule(*module, options);
+      std::string errorMessage;
+      std::unique_ptr<llvm::ToolOutputFile> output;
+      if (result)
+        output = openOutputFile(job.outputFilename, &errorMessage);
+      if (!output) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        llvm::errs() << "Error: failed to produce " << job.outputFilename
+                     << (errorMessage.empty() ? "" : ": ") << errorMessage
+                     << "\n";
+        anyFailed = true;
+        return;
+      }
+      output->os() << *result;
+      output->keep();
+    });
+  }
+  pool.wait();
+  return failure(anyFailed);
 }
 
 LogicalResult tritonTranslateMain(int argc, char **argv,
                                   llvm::StringRef toolName) {
-  static llvm::cl::opt<std::string> inputFilename(
-      llvm::cl::Positional, llvm::cl::desc("<input file>"),
-      llvm::cl::init("-"));
+  static llvm::cl::list<std::string> inputFilenames(
+      llvm::cl::Positional, llvm::cl::desc("<input files>"));
 
   static llvm::cl::opt<std::string> outputFilename(
       "o", llvm::cl::desc("Output filename"), llvm::cl::value_desc("filename"),
       llvm::cl::init("-"));
 
+  static llvm::cl::opt<bool> splitInputFile(
+      "split-input-file",
+      llvm::cl::desc("Translate each '// -----' separated chunk of the "
+                     "inputs as a separate module, in batch mode"),
+      llvm::cl::init(false));
+
+  static llvm::cl::opt<std::string> outputDir(
+      "output-dir",
+      llvm::cl::desc("Directory of the outputs in batch mode, defaults to "
+                     "the directory of each input"),
+      llvm::cl::value_desc("directory"), llvm::cl::init(""));
+
+  static llvm::cl::opt<unsigned> numThreads(
+      "j",
+      llvm::cl::desc("Number of modules translated concurrently in batch "
+                     "mode, 0 for one per hardware thread"),
+      llvm::cl::init(0));
+
   static llvm::cl::opt<std::string> targetKind(
       "target",
       llvm::cl::desc("<translation target, options: llvmir/ptx/hsaco>"),
@@ -89,6 +228,10 @@ LogicalResult tritonTranslateMain(int argc, char **argv,
   static llvm::cl::opt<int> ptxVersion(
       "ptx-version", llvm::cl::desc("PTX version"), llvm::cl::init(10000));
 
+  static llvm::cl::opt<int> optLevel(
+      "opt-level", llvm::cl::desc("LLVM optimization level (0-3)"),
+      llvm::cl::init(3));
+
   static llvm::cl::opt<std::string> GCNArch(
       "gfx", llvm::cl::desc("AMDGCN target. e.g. '90a'"),
       llvm::cl::value_desc("architecture"), llvm::cl::init("90a"));
@@ -107,8 +250,24 @@ LogicalResult tritonTranslateMain(int argc, char **argv,
   registerMLIRContextCLOptions();
   llvm::cl::ParseCommandLineOptions(argc, argv, toolName);
 
+  TranslateOptions options{targetKind,         SMArch,
+                           ptxVersion,         optLevel,
+                           GCNArch.getValue(), GCNTriple.getValue(),
+                           GCNFeatures.getValue()};
+
+  // Several inputs, or split inputs, are translated in batch mode, with
+  // outputs written side by side
+  if (inputFilenames.size() > 1 || splitInputFile) {
+    auto jobs = getBatchJobs(inputFilenames, splitInputFile, outputDir,
+                             targetKind);
+    if (failed(jobs))
+      return failure();
+    return runBatch(*jobs, options, numThreads);
+  }
+
   mlir::MLIRContext context;
-  auto module = loadMLIRModule(inputFilename, context);
+  auto module = loadMLIRModule(
+      inputFilenames.empty() ? "-" : inputFilenames.front(), context);
   if (!module) {
     return failure();
   }
@@ -120,28 +279,11 @@ LogicalResult tritonTranslateMain(int argc, char **argv,
     return failure();
   }
 
-  llvm::LLVMContext llvmContext;
-  auto llvmir = translateTritonGPUToLLVMIR(&llvmContext, *module,
-                                           SMArch.getValue(), false /*isRocm*/);
-  if (!llvmir) {
-    llvm::errs() << "Translate to LLVM IR failed";
-  }
-
-  if (targetKind == "llvmir")
-    llvm::outs() << *llvmir << '\n';
-  else if (targetKind == "ptx")
-    llvm::outs() << ::triton::translateLLVMIRToPTX(*llvmir, SMArch.getValue(),
-                                                   ptxVersion.getValue());
-  else if (targetKind == "hsaco") {
-    auto [module, hsaco] = ::triton::translateLLVMIRToHSACO(
-        *llvmir, GCNArch.getValue(), GCNTriple.getValue(),
-        GCNFeatures.getValue());
-    llvm::outs() << hsaco;
-  } else {
-    llvm::errs() << "Error: Unknown target specified: " << targetKind << "\n";
+  auto result = translateModule(*module, options);
+  if (!result)
     return failure();
-  }
-
+  output->os() << *result;
+  output->keep();
   return success();
 }
 
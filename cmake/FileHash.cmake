@@ -0,0 +1,4 @@
+# Writes the MD5 hash of FILE to OUTPUT, so that the runtime can read the hash
+# of a shipped library instead of hashing it at startup.
+file(MD5 ${FILE} hash)
+file(WRITE ${OUTPUT} ${hash})
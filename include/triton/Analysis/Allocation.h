@@ -1,6 +1,7 @@
 #ifndef TRITON_ANALYSIS_ALLOCATION_H
 #define TRITON_ANALYSIS_ALLOCATION_H
 
+#include "mlir/Pass/AnalysisManager.h"
 #include "triton/Analysis/Utility.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/MapVector.h"
@@ -17,9 +18,28 @@ namespace mlir {
 namespace triton {
 class AllocationAnalysis;
 
+/// Swizzling of the rows of the scratch buffer of a conversion between
+/// distributed layouts: chunk `c` of `vec` elements of row `r` is stored at
+/// chunk `c ^ ((r / perPhase) % maxPhase)`. The rows are padded instead when
+/// `maxPhase` is 1.
+struct CvtSwizzle {
+  unsigned vec = 1;
+  unsigned perPhase = 1;
+  unsigned maxPhase = 1;
+};
+
+/// Returns the shape of the scratch buffer of `op`, and the vector widths of
+/// its stores and loads. Conversions between distributed layouts get the
+/// padding or swizzling of the rows, returned in `swizzle`, with the fewest
+/// bank conflicts for the threads of a warp.
 SmallVector<unsigned>
 getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
-                             unsigned &outVec);
+                             unsigned &outVec, CvtSwizzle *swizzle = nullptr);
+
+/// Whether `op` stores the MMAv3 accumulators of 16-bit elements it converts
+/// to its scratch buffer with `stmatrix`, which writes rows of 16 bytes: the
+/// rows of the buffer are then padded by 16 bytes instead of swizzled.
+bool isStMatrixCvt(triton::gpu::ConvertLayoutOp op);
 
 } // namespace triton
 
@@ -133,6 +153,10 @@ public:
   /// Returns the size of total shared memory allocated
   size_t getSharedMemorySize() const { return sharedMemorySize; }
 
+  /// Returns the largest total size of the buffers live at the same time,
+  /// a lower bound on the shared memory any allocation needs
+  size_t getSharedMemoryLowerBound() const { return sharedMemoryLowerBound; }
+
 private:
   /// A class that represents a shared memory buffer
   struct BufferT {
@@ -148,16 +172,19 @@ private:
     BufferId id;
     size_t size;
     size_t offset;
+    /// The offset is a multiple of the alignment
+    size_t alignment;
 
     bool operator==(const BufferT &other) const { return id == other.id; }
     bool operator<(const BufferT &other) const { return id < other.id; }
 
     BufferT() : BufferT(BufferKind::Explicit) {}
     BufferT(BufferKind kind)
-        : kind(kind), id(InvalidBufferId), size(0), offset(0) {}
+        : kind(kind), id(InvalidBufferId), size(0), offset(0), alignment(1) {}
     BufferT(BufferKind kind, size_t size) : BufferT(kind, size, 0) {}
     BufferT(BufferKind kind, size_t size, size_t offset)
-        : kind(kind), id(nextId++), size(size), offset(offset) {}
+        : kind(kind), id(nextId++), size(size), offset(offset), alignment(1) {
+    }
   };
 
   /// Op -> Scratch Buffer
@@ -195,6 +222,7 @@ private:
   AliasBufferMapT aliasBuffer;
   BufferSetT bufferSet;
   size_t sharedMemorySize = 0;
+  size_t sharedMemoryLowerBound = 0;
 
   friend class triton::AllocationAnalysis;
 };
@@ -222,6 +250,17 @@ public:
         });
   }
 
+  /// Constructor used by the pass analysis manager, through
+  /// `getAnalysis<ModuleAllocation>()`
+  explicit ModuleAllocation(Operation *op)
+      : ModuleAllocation(cast<ModuleOp>(op)) {}
+
+  /// Buffers are keyed by values, so any pass that rewrites ops invalidates
+  /// the allocation unless it explicitly preserves it.
+  bool isInvalidated(const AnalysisManager::PreservedAnalyses &pa) {
+    return !pa.isPreserved<ModuleAllocation>();
+  }
+
   size_t getSharedMemorySize() {
     size_t size = 0;
     for (auto funcOp : getRoots()) {
@@ -231,6 +270,15 @@ public:
     return size;
   }
 
+  size_t getSharedMemoryLowerBound() {
+    size_t size = 0;
+    for (auto funcOp : getRoots()) {
+      auto *alloc = getFuncData(funcOp);
+      size = std::max(size, alloc->getSharedMemoryLowerBound());
+    }
+    return size;
+  }
+
   size_t getSharedMemorySize(FunctionOpInterface funcOp) {
     return getFuncData(funcOp)->getSharedMemorySize();
   }
@@ -4,6 +4,7 @@
 #include "mlir/Analysis/DataFlow/SparseAnalysis.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include "mlir/Pass/AnalysisManager.h"
 #include "mlir/Support/LLVM.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
@@ -22,6 +23,8 @@ namespace mlir {
 class AxisInfo {
 public:
   typedef SmallVector<int64_t, 4> DimVectorT;
+  /// Inclusive bounds `[min, max]` of signed integer values
+  typedef std::pair<int64_t, int64_t> RangeT;
 
 public:
   /// Default constructor
@@ -32,9 +35,14 @@ public:
       : AxisInfo(knownContiguity, knownDivisibility, knownConstancy, {}) {}
   AxisInfo(DimVectorT knownContiguity, DimVectorT knownDivisibility,
            DimVectorT knownConstancy, std::optional<int64_t> knownConstantValue)
+      : AxisInfo(knownContiguity, knownDivisibility, knownConstancy,
+                 knownConstantValue, {}) {}
+  AxisInfo(DimVectorT knownContiguity, DimVectorT knownDivisibility,
+           DimVectorT knownConstancy, std::optional<int64_t> knownConstantValue,
+           std::optional<RangeT> knownValueRange)
       : contiguity(knownContiguity), divisibility(knownDivisibility),
         constancy(knownConstancy), constantValue(knownConstantValue),
-        rank(contiguity.size()) {
+        valueRange(knownValueRange), rank(contiguity.size()) {
     assert(knownContiguity.size() == static_cast<size_t>(rank));
     assert(knownDivisibility.size() == static_cast<size_t>(rank));
     assert(knownConstancy.size() == static_cast<size_t>(rank));
@@ -54,6 +62,8 @@ public:
 
   std::optional<int64_t> getConstantValue() const { return constantValue; }
 
+  std::optional<RangeT> getValueRange() const { return valueRange; }
+
   template <class T>
   static void
   initPessimisticStateFromFunc(int argNumber, T funcOp, DimVectorT *contiguity,
@@ -63,7 +73,8 @@ public:
     return (contiguity == other.contiguity) &&
            (divisibility == other.divisibility) &&
            (constancy == other.constancy) &&
-           (constantValue == other.constantValue) && (rank == other.rank);
+           (constantValue == other.constantValue) &&
+           (valueRange == other.valueRange) && (rank == other.rank);
   }
 
   /// The pessimistic value state of the contiguity is unknown.
@@ -72,7 +83,8 @@ public:
   }
   static AxisInfo getPessimisticValueState(Value value);
 
-  /// The gcd of both arguments for each dimension
+  /// The gcd of both arguments for each dimension, and the union of their
+  /// value ranges
   static AxisInfo join(const AxisInfo &lhs, const AxisInfo &rhs);
 
   void print(raw_ostream &os) const {
@@ -89,6 +101,9 @@ public:
       os << *constantValue;
     else
       os << "<none>";
+    if (valueRange)
+      os << ", value_range = [" << valueRange->first << ", "
+         << valueRange->second << "]";
   }
 
 private:
@@ -153,6 +168,15 @@ private:
   /// The constant value of the lattice if we can infer it.
   std::optional<int64_t> constantValue;
 
+  /// Bounds on the values of all elements, if we can infer them. Booleans
+  /// are in [0, 1].
+  /// For example
+  /// [0, 1, ..., 127] % 64
+  /// would have value range [0, 63]
+  /// Comparisons decided by the ranges of their operands fold to constants,
+  /// which lets the lowering drop masks that are always true.
+  std::optional<RangeT> valueRange;
+
   // number of dimensions of the lattice
   int rank{};
 };
@@ -291,6 +315,15 @@ public:
   void visitOperation(Operation *op,
                       ArrayRef<const dataflow::Lattice<AxisInfo> *> operands,
                       ArrayRef<dataflow::Lattice<AxisInfo> *> results) override;
+
+  /// The axis info of `value` if it is a loop-carried value of an scf.for
+  /// advanced by a loop-invariant step, `init + i * step` at iteration `i`.
+  /// It is solved in closed form from the lattices of `init` and `step`
+  /// returned by `getLattice`, instead of from the fixpoint over the back
+  /// edge of the loop, which widens value ranges.
+  std::optional<AxisInfo> getLoopRecurrenceAxisInfo(
+      Value value,
+      function_ref<const dataflow::Lattice<AxisInfo> *(Value)> getLattice);
 };
 
 /// Module level axis info analysis based on the call graph, assuming that we
@@ -327,6 +360,17 @@ public:
     }
   }
 
+  /// Constructor used by the pass analysis manager, through
+  /// `getAnalysis<ModuleAxisInfoAnalysis>()`
+  explicit ModuleAxisInfoAnalysis(Operation *op)
+      : ModuleAxisInfoAnalysis(cast<ModuleOp>(op)) {}
+
+  /// The axis info is keyed by values, so any pass that rewrites ops
+  /// invalidates it unless it explicitly preserves it.
+  bool isInvalidated(const AnalysisManager::PreservedAnalyses &pa) {
+    return !pa.isPreserved<ModuleAxisInfoAnalysis>();
+  }
+
   AxisInfo *getAxisInfo(Value value) {
     auto funcOp =
         value.getParentRegion()->getParentOfType<FunctionOpInterface>();
@@ -347,6 +391,18 @@ public:
 
   unsigned getMaskAlignment(Value mask);
 
+  /// Number of elements along the fastest-varying dimension of the tensor
+  /// that the accesses of `op` can be aligned to
+  unsigned getBlockLoadAlignment(triton::BlockLoadOp op);
+
+  /// Whether every element of `mask` is known to be true
+  bool isAllTrueMask(Value mask);
+
+  /// Whether, in each aligned group of `vec` elements along the
+  /// fastest-varying dimension of `mask`, the true elements are known to come
+  /// first, as in the bounds checks of tiles at the edge of a tensor
+  bool isPrefixMask(Value mask, unsigned vec);
+
 private:
   void initialize(FunctionOpInterface funcOp);
 
@@ -4,61 +4,139 @@
 #include "Allocation.h"
 #include "llvm/ADT/SmallPtrSet.h"
 
+#include <algorithm>
 #include <set>
 
 namespace mlir {
 
 class OpBuilder;
 
+/// Describes which warps access each byte of a shared memory interval:
+/// `type` is the shared memory tensor accessed, which fixes the element
+/// stored at every byte, and `warpTiling` the mapping of elements to the
+/// warps owning them. Two accesses to the same interval with the same
+/// mapping touch every byte from the same warps, so that ordering them only
+/// needs a warp-level sync. A null `type` means the mapping is unknown.
+struct WarpMapping {
+  Type type;
+  SmallVector<unsigned> warpTiling;
+
+  bool isKnown() const { return static_cast<bool>(type); }
+
+  bool operator<(const WarpMapping &other) const {
+    if (type != other.type)
+      return type.getAsOpaquePointer() < other.type.getAsOpaquePointer();
+    return warpTiling < other.warpTiling;
+  }
+
+  bool operator==(const WarpMapping &other) const {
+    return type == other.type && warpTiling == other.warpTiling;
+  }
+};
+
+/// A shared memory access not ordered by a CTA barrier yet.
+struct SharedAccess {
+  Interval<size_t> interval;
+  WarpMapping mapping;
+  /// Whether a warp-level sync orders the access.
+  bool warpSynced = false;
+
+  SharedAccess(Interval<size_t> interval, WarpMapping mapping = {})
+      : interval(interval), mapping(std::move(mapping)) {}
+
+  bool operator<(const SharedAccess &other) const {
+    if (interval != other.interval)
+      return interval < other.interval;
+    if (!(mapping == other.mapping))
+      return mapping < other.mapping;
+    return warpSynced < other.warpSynced;
+  }
+
+  bool operator==(const SharedAccess &other) const {
+    return interval == other.interval && mapping == other.mapping &&
+           warpSynced == other.warpSynced;
+  }
+};
+
 struct BlockInfo {
   using BufferIdSetT = Allocation::BufferIdSetT;
-  using IntervalSetT = std::set<Interval<size_t>>;
+  using AccessSetT = std::set<SharedAccess>;
+
+  /// The synchronization an operation needs with the accesses before it.
+  enum class Hazard { None, Warp, CTA };
 
-  IntervalSetT syncReadIntervals;
-  IntervalSetT syncWriteIntervals;
+  AccessSetT syncReadAccesses;
+  AccessSetT syncWriteAccesses;
 
   BlockInfo() = default;
 
   /// Unions two BlockInfo objects.
   BlockInfo &join(const BlockInfo &other) {
-    syncReadIntervals.insert(other.syncReadIntervals.begin(),
-                             other.syncReadIntervals.end());
-    syncWriteIntervals.insert(other.syncWriteIntervals.begin(),
-                              other.syncWriteIntervals.end());
+    syncReadAccesses.insert(other.syncReadAccesses.begin(),
+                            other.syncReadAccesses.end());
+    syncWriteAccesses.insert(other.syncWriteAccesses.begin(),
+                             other.syncWriteAccesses.end());
     return *this;
   }
 
-  /// Returns true if intervals in two BlockInfo objects are intersected.
+  /// Returns the synchronization needed before accesses of `other`.
+  Hazard getHazard(const BlockInfo &other) const {
+    return std::max(
+        {/*RAW*/ getHazard(syncWriteAccesses, other.syncReadAccesses),
+         /*WAR*/ getHazard(syncReadAccesses, other.syncWriteAccesses),
+         /*WAW*/ getHazard(syncWriteAccesses, other.syncWriteAccesses)});
+  }
+
+  /// Returns true if accesses in two BlockInfo objects are intersected.
   bool isIntersected(const BlockInfo &other) const {
-    return /*RAW*/ isIntersected(syncWriteIntervals, other.syncReadIntervals) ||
-           /*WAR*/
-           isIntersected(syncReadIntervals, other.syncWriteIntervals) ||
-           /*WAW*/
-           isIntersected(syncWriteIntervals, other.syncWriteIntervals);
+    return getHazard(other) != Hazard::None;
   }
 
-  /// Clears the intervals because a barrier is inserted.
+  /// Clears the accesses because a barrier is inserted.
   void sync() {
-    syncReadIntervals.clear();
-    syncWriteIntervals.clear();
+    syncReadAccesses.clear();
+    syncWriteAccesses.clear();
+  }
+
+  /// Marks the accesses ordered within each warp because a warp-level sync is
+  /// inserted. They still need a barrier before accesses from other warps.
+  void warpSync() {
+    warpSync(syncReadAccesses);
+    warpSync(syncWriteAccesses);
   }
 
   /// Compares two BlockInfo objects.
   bool operator==(const BlockInfo &other) const {
-    return syncReadIntervals == other.syncReadIntervals &&
-           syncWriteIntervals == other.syncWriteIntervals;
+    return syncReadAccesses == other.syncReadAccesses &&
+           syncWriteAccesses == other.syncWriteAccesses;
   }
 
   bool operator!=(const BlockInfo &other) const { return !(*this == other); }
 
 private:
-  bool isIntersected(const IntervalSetT &lhsIntervalSet,
-                     const IntervalSetT &rhsIntervalSet) const {
-    for (auto &lhs : lhsIntervalSet)
-      for (auto &rhs : rhsIntervalSet)
-        if (lhs.intersects(rhs))
-          return true;
-    return false;
+  Hazard getHazard(const AccessSetT &lhsAccessSet,
+                   const AccessSetT &rhsAccessSet) const {
+    Hazard hazard = Hazard::None;
+    for (auto &lhs : lhsAccessSet)
+      for (auto &rhs : rhsAccessSet) {
+        if (!lhs.interval.intersects(rhs.interval))
+          continue;
+        if (!lhs.mapping.isKnown() || lhs.interval != rhs.interval ||
+            !(lhs.mapping == rhs.mapping))
+          return Hazard::CTA;
+        if (!lhs.warpSynced)
+          hazard = Hazard::Warp;
+      }
+    return hazard;
+  }
+
+  static void warpSync(AccessSetT &accessSet) {
+    AccessSetT synced;
+    for (auto access : accessSet) {
+      access.warpSynced = true;
+      synced.insert(access);
+    }
+    accessSet = std::move(synced);
   }
 };
 
@@ -77,6 +155,10 @@ public:
   /// The following circumstances do not require a barrier:
   /// - WAW: not possible because overlapped memory allocation is not allowed.
   /// - RAR: no write is performed.
+  /// If every byte involved in a RAW or WAR hazard is accessed by the same
+  /// warps on both sides, e.g. a tensor stored to and loaded from shared
+  /// memory in blocked layouts mapping its elements to the same warps, a
+  /// warp-level sync is inserted instead of a barrier.
   /// Temporary storage of operations such as Reduce are considered as both
   /// a shared memory read. If the temporary storage is written but not read,
   /// it is considered as the problem of the operation itself but not the membar
@@ -88,6 +170,11 @@ public:
   /// necessary.
   void run(FuncBlockInfoMapT &funcBlockInfoMap);
 
+  /// Attribute of the barriers inserted by the analysis, the only ones it may
+  /// remove: other barriers, e.g. from `tl.debug_barrier`, may order global
+  /// memory accesses.
+  static StringRef getInsertedBarrierAttrName() { return "triton_gpu.membar"; }
+
 private:
   /// Applies the barrier analysis based on the SCF dialect, in which each
   /// region has a single basic block only.
@@ -110,6 +197,22 @@ private:
   void update(Operation *operation, BlockInfo *blockInfo,
               FuncBlockInfoMapT *funcBlockInfoMap, OpBuilder *builder);
 
+  /// Removes the barriers inserted by the analysis (and warp syncs) that
+  /// every path reaches without a memory access since the previous barrier,
+  /// e.g. the back-to-back barriers at the end of a loop body and the top of
+  /// the next iteration.
+  void removeRedundantBarriers(FunctionOpInterface funcOp);
+
+  /// Returns true if the operation may access shared memory.
+  bool accessesSharedMemory(Operation *operation) const;
+
+  /// Returns true if the operation may access global memory.
+  bool accessesGlobalMemory(Operation *operation) const;
+
+  /// Inserts a barrier, tagged as inserted by the analysis, at the insertion
+  /// point of `builder`.
+  void insertBarrier(OpBuilder *builder, Location loc);
+
   /// Collects the successors of the terminator
   void visitTerminator(Operation *operation, SmallVector<Block *> &successors);
 
@@ -0,0 +1,69 @@
+#ifndef TRITON_ANALYSIS_REGISTER_PRESSURE_H
+#define TRITON_ANALYSIS_REGISTER_PRESSURE_H
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Operation.h"
+#include "llvm/ADT/DenseMap.h"
+
+namespace mlir {
+
+class AxisInfo;
+class ModuleAxisInfoAnalysis;
+
+/// Static estimate of the number of 32-bit registers each thread keeps live
+/// in a TritonGPU module, derived from the encodings of its tensors.
+///
+/// Values are live from their definition to their last use in the same
+/// block, uses in nested regions counting as uses by their ancestor op.
+/// Results may reuse the registers of the operands dying at their op, and
+/// splat constants are assumed to be materialized as immediates. Tensors in
+/// shared memory hold no registers. Given the axis info of the module,
+/// elements of a thread known to be equal share a register, as do pointers
+/// accessed by the same vector memory op.
+class RegisterPressureAnalysis {
+public:
+  /// Hardware limit on the registers of a thread
+  static constexpr unsigned kMaxRegistersPerThread = 255;
+  /// Size of the register file of an SM, in 32-bit registers
+  static constexpr unsigned kRegistersPerSM = 64 * 1024;
+
+  /// Registers a thread of a CTA of `numWarps` warps can use without spilling
+  static unsigned getRegisterBudget(int numWarps, int threadsPerWarp = 32);
+  /// Register budget of the threads of `moduleOp`; only the hardware limit
+  /// applies when its number of warps is not set
+  static unsigned getRegisterBudget(ModuleOp moduleOp);
+
+  /// Registers a thread holds for a value of type `type`, with `axisInfo`
+  /// if known
+  static unsigned getNumRegisters(Type type,
+                                  const AxisInfo *axisInfo = nullptr);
+
+  explicit RegisterPressureAnalysis(
+      Operation *op, ModuleAxisInfoAnalysis *axisInfoAnalysis = nullptr);
+
+  /// Peak pressure over the whole operation
+  unsigned getMaxPressure() const { return maxPressure; }
+
+  /// Peak pressure while `op`, including its regions, executes; 0 if `op`
+  /// was not analyzed
+  unsigned getPressure(Operation *op) const {
+    return opPressure.lookup(op);
+  }
+
+private:
+  /// Returns the peak pressure of the values defined in `block`, and
+  /// records the pressure of its ops given `liveAround` registers held
+  /// outside of it
+  unsigned visitBlock(Block *block, unsigned liveAround);
+
+  /// Registers held by `value` until its last use
+  unsigned getLiveRegisters(Value value) const;
+
+  ModuleAxisInfoAnalysis *axisInfoAnalysis;
+  DenseMap<Operation *, unsigned> opPressure;
+  unsigned maxPressure = 0;
+};
+
+} // namespace mlir
+
+#endif // TRITON_ANALYSIS_REGISTER_PRESSURE_H
@@ -0,0 +1,64 @@
+#ifndef TRITON_ANALYSIS_UNIFORMITY_H
+#define TRITON_ANALYSIS_UNIFORMITY_H
+
+#include "mlir/IR/Value.h"
+#include "llvm/ADT/DenseMap.h"
+
+namespace mlir {
+
+class AxisInfo;
+class ModuleAxisInfoAnalysis;
+
+/// The threads over which all the elements of a value are equal, from the
+/// narrowest to the widest scope
+enum class Uniformity {
+  /// Elements may differ within a thread
+  None,
+  /// The elements a thread holds are equal
+  Thread,
+  /// The elements the threads of a warp hold are equal
+  Warp,
+  /// All the elements of the tensor are equal
+  CTA,
+};
+
+StringRef stringifyUniformity(Uniformity uniformity);
+
+/// Uniformity of the values of a TritonGPU module, derived from the
+/// constancy of their axis info and the distribution of their elements.
+///
+/// Along every dimension, the elements of a thread (a warp) lie in a block of
+/// the size of its `sizePerThread` (times its `threadsPerWarp`) when the
+/// layout covers the tensor once, and span the whole dimension otherwise. A
+/// value is uniform over a thread (a warp) when every such block lies within
+/// a block of equal elements. Layouts other than blocked ones are only
+/// uniform when the whole tensor is; scalars are uniform over the CTA.
+///
+/// The axis info does not model most floating-point ops, so the results of
+/// elementwise ops without side effects are also at least as uniform as the
+/// least uniform of their operands.
+class UniformityAnalysis {
+public:
+  explicit UniformityAnalysis(ModuleAxisInfoAnalysis &axisInfoAnalysis)
+      : axisInfoAnalysis(axisInfoAnalysis) {}
+
+  /// Uniformity of a value of type `type` with `axisInfo`
+  static Uniformity getUniformity(Type type, const AxisInfo &axisInfo);
+
+  /// Uniformity of `value`
+  Uniformity getUniformity(Value value) const;
+
+  /// Whether a thread holds a single distinct element of `value`, which the
+  /// lowering can compute once and reuse for all of them
+  bool isUniformPerThread(Value value) const {
+    return getUniformity(value) >= Uniformity::Thread;
+  }
+
+private:
+  ModuleAxisInfoAnalysis &axisInfoAnalysis;
+  mutable DenseMap<Value, Uniformity> uniformity;
+};
+
+} // namespace mlir
+
+#endif // TRITON_ANALYSIS_UNIFORMITY_H
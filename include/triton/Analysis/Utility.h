@@ -6,6 +6,7 @@
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include <algorithm>
 #include <numeric>
+#include <optional>
 #include <string>
 
 namespace mlir {
@@ -37,6 +38,8 @@ public:
 
   bool isFastReduction();
 
+  // Whether each warp holds all the elements it reduces together, so that
+  // the reduction completes with warp shuffles, without shared memory
   bool isWarpSynchronous();
 
   unsigned getInterWarpSize();
@@ -67,10 +70,7 @@ private:
 
 class ScanLoweringHelper {
 public:
-  explicit ScanLoweringHelper(triton::ScanOp op) : scanOp(op) {
-    auto type = scanOp.getOperand(0).getType().cast<RankedTensorType>();
-    srcEncoding = type.getEncoding();
-  }
+  explicit ScanLoweringHelper(triton::ScanOp op);
   // Return true if the lowering of the scan op is supported.
   bool isSupported();
   // Return the number of elements per thread along axis dim.
@@ -89,7 +89,9 @@ public:
   unsigned getAxisNumBlocks();
   // Return the number of blocks along non axis dim.
   unsigned getNonAxisNumBlocks();
-  // Return the size of the scratch space needed for scan lowering.
+  // Return the size of the scratch space needed for scan lowering. It is
+  // zero when the axis is within a single warp, as the partial scans are then
+  // carried between threads with warp shuffles only.
   unsigned getScratchSizeInBytes();
 
   // Stride between contiguous element along axis dim.
@@ -100,13 +102,20 @@ public:
   unsigned getAxisBlockStride();
 
   Location getLoc() { return scanOp.getLoc(); }
-  unsigned getAxis() { return scanOp.getAxis(); }
+  unsigned getAxis() { return axis; }
+  ArrayRef<int64_t> getShape() { return shape; }
   triton::gpu::BlockedEncodingAttr getEncoding();
   Region &getCombineOp();
 
 private:
   triton::ScanOp scanOp;
   Attribute srcEncoding;
+  // The blocked layout, shape and axis the scan is computed in. Slices of
+  // blocked layouts are scanned in their parent layout, with a single element
+  // along the sliced dimension.
+  triton::gpu::BlockedEncodingAttr encoding;
+  SmallVector<int64_t> shape;
+  unsigned axis;
 };
 
 bool maybeSharedAllocationOp(Operation *op);
@@ -117,10 +126,32 @@ bool supportMMA(triton::DotOp op, int version);
 
 bool supportMMA(Value value, int version);
 
+// Whether `type` is an fp8 format the tensor cores of sm_89 and later
+// multiply natively: e4m3 or e5m2
+bool isNativeFp8(Type type);
+
 bool isSingleValue(Value value);
 
+// Whether the atomic `op` is lowered to a reduction (`red`), which returns no
+// old value: its result is unused, and its semantics and kind are ones `red`
+// supports (relaxed or release, no exchange)
+bool isAtomicReduction(triton::AtomicRMWOp op);
+
 bool isMmaToDotShortcut(RankedTensorType &srcTy, RankedTensorType &dstTy);
 
+/// Returns, for each register of a thread of the blocked layout of `dstTy`,
+/// the register of the blocked layout of `srcTy` holding the same element in
+/// a lane of the same warp, or std::nullopt if some element only lives in
+/// another warp. Such conversions are lowered to warp shuffles, without
+/// going through shared memory. The lane of each element is that of the
+/// first thread of the source layout holding it; `sameLane` is set when it
+/// is always the lane of the thread itself.
+std::optional<SmallVector<unsigned>>
+getWarpShuffleCvtSrcRegs(RankedTensorType srcTy, RankedTensorType dstTy,
+                         bool *sameLane = nullptr);
+
+bool isWarpShuffleCvt(triton::gpu::ConvertLayoutOp op);
+
 Type getElementType(Value value);
 
 template <typename T_OUT, typename T_IN>
@@ -6,6 +6,8 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/StringSaver.h"
 #include <memory>
 #include <string>
 
@@ -21,6 +23,37 @@ inline std::string strJoin(llvm::ArrayRef<std::string> strs,
   return llvm::join(strs.begin(), strs.end(), delimiter);
 }
 
+// Bump allocator owning the operands, instructions and executions of an asm
+// builder, which all live as long as the builder, and the string fragments
+// they are printed from, interned so that the common suffixes and
+// constraints are stored once.
+class AsmArena {
+public:
+  AsmArena() = default;
+  AsmArena(const AsmArena &) = delete;
+  AsmArena &operator=(const AsmArena &) = delete;
+
+  ~AsmArena() {
+    for (auto it = destructors.rbegin(); it != destructors.rend(); ++it)
+      it->second(it->first);
+  }
+
+  template <typename T, typename... Args> T *create(Args &&...args) {
+    T *obj = new (allocator.Allocate<T>()) T(std::forward<Args>(args)...);
+    if (!std::is_trivially_destructible<T>::value)
+      destructors.emplace_back(
+          obj, [](void *ptr) { static_cast<T *>(ptr)->~T(); });
+    return obj;
+  }
+
+  StringRef intern(StringRef str) { return strings.save(str); }
+
+private:
+  llvm::BumpPtrAllocator allocator;
+  llvm::UniqueStringSaver strings{allocator};
+  llvm::SmallVector<std::pair<void *, void (*)(void *)>, 16> destructors;
+};
+
 } // namespace triton
 } // namespace mlir
 
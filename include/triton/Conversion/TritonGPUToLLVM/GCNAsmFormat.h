@@ -2,6 +2,7 @@
 #define TRITON_CONVERSION_TRITON_GPU_TO_LLVM_GCN_FORMAT_H_
 
 #include "mlir/IR/Value.h"
+#include "triton/Conversion/TritonGPUToLLVM/AsmFormat.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
@@ -146,8 +147,9 @@ struct GCNBuilder {
 
   template <typename INSTR = GCNInstr, typename... Args>
   INSTR *create(Args &&...args) {
-    instrs.emplace_back(std::make_unique<INSTR>(this, args...));
-    return static_cast<INSTR *>(instrs.back().get());
+    auto *instr = arena.create<INSTR>(this, args...);
+    instrs.push_back(instr);
+    return instr;
   }
 
   // Create a list of operands.
@@ -214,23 +216,21 @@ struct GCNBuilder {
 
 private:
   Operand *newOperand() {
-    argArchive.emplace_back(std::make_unique<Operand>());
-    return argArchive.back().get();
+    auto *opr = arena.create<Operand>();
+    argArchive.push_back(opr);
+    return opr;
   }
 
-  Modifier *newModifier() {
-    modArchive.emplace_back(std::make_unique<Modifier>());
-    return modArchive.back().get();
-  }
+  Modifier *newModifier() { return arena.create<Modifier>(); }
 
   friend class GCNInstr;
   friend class GCNInstrCommon;
 
 protected:
-  llvm::SmallVector<std::unique_ptr<Operand>, 6> argArchive;
-  llvm::SmallVector<std::unique_ptr<Modifier>, 2> modArchive;
-  llvm::SmallVector<std::unique_ptr<GCNInstrCommon>, 2> instrs;
-  llvm::SmallVector<std::unique_ptr<GCNInstrExecution>, 4> executions;
+  AsmArena arena;
+  llvm::SmallVector<Operand *, 6> argArchive;
+  llvm::SmallVector<GCNInstrCommon *, 2> instrs;
+  llvm::SmallVector<GCNInstrExecution *, 4> executions;
   int oprCounter{};
 };
 
@@ -261,8 +261,10 @@ protected:
   GCNInstrExecution &call(llvm::ArrayRef<Operand *> oprs,
                           ArrayRef<Modifier *> mods);
 
+  StringRef intern(StringRef str) { return builder->arena.intern(str); }
+
   GCNBuilder *builder{};
-  llvm::SmallVector<std::string, 4> instrParts;
+  llvm::SmallVector<StringRef, 4> instrParts;
 
   friend class GCNInstrExecution;
 };
@@ -271,14 +273,14 @@ template <class ConcreteT> struct GCNInstrBase : public GCNInstrCommon {
   using Operand = GCNBuilder::Operand;
   using Modifier = GCNBuilder::Modifier;
 
-  explicit GCNInstrBase(GCNBuilder *builder, const std::string &name)
+  explicit GCNInstrBase(GCNBuilder *builder, StringRef name)
       : GCNInstrCommon(builder) {
     o(name);
   }
 
-  ConcreteT &o(const std::string &suffix, bool predicate = true) {
+  ConcreteT &o(StringRef suffix, bool predicate = true) {
     if (predicate)
-      instrParts.push_back(suffix);
+      instrParts.push_back(intern(suffix));
     return *static_cast<ConcreteT *>(this);
   }
 };
@@ -2,6 +2,7 @@
 #define TRITON_CONVERSION_TRITON_GPU_TO_LLVM_PTX_ASM_FORMAT_H_
 
 #include "mlir/IR/Value.h"
+#include "triton/Conversion/TritonGPUToLLVM/AsmFormat.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
@@ -71,9 +72,12 @@ struct PTXInstrExecution;
 //
 // There are several derived instruction type for typical instructions, for
 // example, the PtxIOInstr for ld and st instructions.
+//
+// The operands, instructions and executions are allocated in the arena of the
+// builder and live as long as it does.
 struct PTXBuilder {
   struct Operand {
-    std::string constraint;
+    StringRef constraint;
     Value value;
     int idx{-1};
     llvm::SmallVector<Operand *> list;
@@ -102,8 +106,9 @@ struct PTXBuilder {
 
   template <typename INSTR = PTXInstr, typename... Args>
   INSTR *create(Args &&...args) {
-    instrs.emplace_back(std::make_unique<INSTR>(this, args...));
-    return static_cast<INSTR *>(instrs.back().get());
+    auto *instr = arena.create<INSTR>(this, args...);
+    instrs.push_back(instr);
+    return instr;
   }
 
   // Create a list of operands.
@@ -172,8 +177,9 @@ struct PTXBuilder {
 
 private:
   Operand *newOperand() {
-    argArchive.emplace_back(std::make_unique<Operand>());
-    return argArchive.back().get();
+    auto *opr = arena.create<Operand>();
+    argArchive.push_back(opr);
+    return opr;
   }
 
   void initOperand(Operand *opr);
@@ -184,23 +190,23 @@ private:
     // The order in argArchive is unnecessary when onlyAttachMLIRArgs=false, but
     // it does necessary when onlyAttachMLIRArgs is true for the $0, $1... are
     // determined by PTX code snippet passed from external.
-    sort(argArchive.begin(), argArchive.end(),
-         [&](std::unique_ptr<Operand> &a, std::unique_ptr<Operand> &b) {
-           auto ida = std::find(order.begin(), order.end(), a.get());
-           auto idb = std::find(order.begin(), order.end(), b.get());
-           assert(ida != order.end());
-           assert(idb != order.end());
-           return ida < idb;
-         });
+    sort(argArchive.begin(), argArchive.end(), [&](Operand *a, Operand *b) {
+      auto ida = std::find(order.begin(), order.end(), a);
+      auto idb = std::find(order.begin(), order.end(), b);
+      assert(ida != order.end());
+      assert(idb != order.end());
+      return ida < idb;
+    });
   }
 
   friend struct PTXInstr;
   friend struct PTXInstrCommon;
 
 protected:
-  llvm::SmallVector<std::unique_ptr<Operand>, 6> argArchive;
-  llvm::SmallVector<std::unique_ptr<PTXInstrCommon>, 2> instrs;
-  llvm::SmallVector<std::unique_ptr<PTXInstrExecution>, 4> executions;
+  AsmArena arena;
+  llvm::SmallVector<Operand *, 6> argArchive;
+  llvm::SmallVector<PTXInstrCommon *, 2> instrs;
+  llvm::SmallVector<PTXInstrExecution *, 4> executions;
   int oprCounter{};
 };
 
@@ -235,8 +241,10 @@ protected:
   PTXInstrExecution &call(llvm::ArrayRef<Operand *> oprs,
                           bool onlyAttachMLIRArgs = false);
 
+  StringRef intern(StringRef str) { return builder->arena.intern(str); }
+
   PTXBuilder *builder{};
-  llvm::SmallVector<std::string, 4> instrParts;
+  llvm::SmallVector<StringRef, 4> instrParts;
 
   friend struct PTXInstrExecution;
 };
@@ -244,7 +252,7 @@ protected:
 template <class ConcreteT> struct PTXInstrBase : public PTXInstrCommon {
   using Operand = PTXBuilder::Operand;
 
-  explicit PTXInstrBase(PTXBuilder *builder, const std::string &name)
+  explicit PTXInstrBase(PTXBuilder *builder, StringRef name)
       : PTXInstrCommon(builder) {
     o(name);
   }
@@ -254,9 +262,9 @@ template <class ConcreteT> struct PTXInstrBase : public PTXInstrCommon {
   // A predicate is used to tell whether to apply the suffix, so that no if-else
   // code needed. e.g. `PTXInstr("add").o("s32", isS32).o("u32", !isS32);` will
   // get a `add.s32` if isS32 is true.
-  ConcreteT &o(const std::string &suffix, bool predicate = true) {
+  ConcreteT &o(StringRef suffix, bool predicate = true) {
     if (predicate)
-      instrParts.push_back(suffix);
+      instrParts.push_back(intern(suffix));
     return *static_cast<ConcreteT *>(this);
   }
 };
@@ -320,7 +328,7 @@ struct PTXCpAsyncLoadInstr : PTXInstrBase<PTXCpAsyncLoadInstr> {
   explicit PTXCpAsyncLoadInstr(PTXBuilder *builder,
                                triton::CacheModifier modifier)
       : PTXInstrBase(builder, "cp.async") {
-    o(triton::stringifyCacheModifier(modifier).str());
+    o(triton::stringifyCacheModifier(modifier));
     o("shared");
     o("global");
   }
@@ -14,7 +14,8 @@ namespace triton {
 
 std::unique_ptr<OperationPass<ModuleOp>>
 createConvertTritonGPUToLLVMPass(int computeCapability = 80,
-                                 bool isROCM = false);
+                                 bool isROCM = false, bool fastMath = false,
+                                 bool printBuffer = false);
 
 } // namespace triton
 
@@ -11,7 +11,14 @@ std::unique_ptr<Pass> createCombineOpsPass();
 std::unique_ptr<Pass> createReorderBroadcastPass();
 
 std::unique_ptr<Pass>
-createRewriteTensorPointerPass(int computeCapability = 80);
+createRewriteTensorPointerPass(int computeCapability = 80,
+                               bool enableTMA = false);
+
+std::unique_ptr<Pass> createNarrowOffsetsPass(bool assumeSmallTensors = false);
+
+std::unique_ptr<Pass> createSwizzleProgramIdsPass(int groupSize = 8);
+
+std::unique_ptr<Pass> createLinearizeProgramIdsPass();
 
 } // namespace triton
 
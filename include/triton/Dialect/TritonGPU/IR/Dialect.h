@@ -81,8 +81,28 @@ bool isaDistributedLayout(Attribute layout);
 
 bool isSharedEncoding(Value value);
 
+// Whether `layout` is the layout of a dot operand that the tensor cores read
+// from shared memory, i.e. whose parent is an MMAv3 encoding
+bool isMmaV3DotOperand(Attribute layout);
+
 bool isExpensiveCat(CatOp cat, Attribute &targetEncoding);
 
+// Whether `view` with a result in `targetEncoding` is not a renaming of the
+// registers of its operand
+bool isExpensiveView(ViewOp view, Attribute &targetEncoding);
+
+// Whether each thread holds as many elements of a tensor of `dstType` as of
+// the tensors of `srcTypes` together, all of them distinct, so that ops which
+// may reorder elements, like `tt.view` and `tt.cat`, only rename registers
+bool isRegisterRenaming(ArrayRef<RankedTensorType> srcTypes,
+                        RankedTensorType dstType);
+
+// A blocked encoding for tensors of shape `newShape` into which the elements
+// of a tensor of `type` can be viewed or concatenated by renaming registers
+// (see `isRegisterRenaming`), or null if there is none
+Attribute getRenamingEncoding(RankedTensorType type,
+                              ArrayRef<int64_t> newShape);
+
 } // namespace gpu
 } // namespace triton
 } // namespace mlir
@@ -4,10 +4,19 @@
 #include "mlir/Pass/Pass.h"
 
 namespace mlir {
-std::unique_ptr<Pass> createTritonGPUPipelinePass(int numStages = 2);
+std::unique_ptr<Pass>
+createTritonGPUPipelinePass(int numStages = 2,
+                            int64_t sharedMemoryBudget = 48 * 1024);
 
 std::unique_ptr<Pass>
-createTritonGPUAccelerateMatmulPass(int computeCapability = 80);
+createTritonGPUAccelerateMatmulPass(int computeCapability = 80,
+                                    int mfmaVersion = 0, int ptxVersion = 80);
+
+std::unique_ptr<Pass> createTritonGPUFlattenLoopsPass();
+
+std::unique_ptr<Pass> createTritonGPUUnrollLoopsPass();
+
+std::unique_ptr<Pass> createTritonGPUWarpSpecializePass(int numStages = 3);
 
 std::unique_ptr<Pass> createTritonGPUPrefetchPass();
 
@@ -19,6 +28,10 @@ std::unique_ptr<Pass> createTritonGPUReorderInstructionsPass();
 
 std::unique_ptr<Pass> createTritonGPUDecomposeConversionsPass();
 
+std::unique_ptr<Pass> createTritonGPURematerializePass();
+
+std::unique_ptr<Pass> createTritonGPUAssignLayoutsPass();
+
 std::unique_ptr<Pass> createTritonGPURemoveLayoutConversionsPass();
 
 std::unique_ptr<Pass> createTritonGPUVerifier();
@@ -13,8 +13,11 @@ namespace mlir {
 
 class TritonGPUTypeConverter : public TypeConverter {
 public:
+  // `elemBitwidth` is the width of the widest elements loaded or stored by
+  // the converted code; it sets how many consecutive elements of a 1-D
+  // tensor a thread holds by default.
   TritonGPUTypeConverter(MLIRContext *context, int numWarps,
-                         int threadsPerWarp);
+                         int threadsPerWarp, int elemBitwidth = 32);
   int getNumWarps() const { return numWarps; }
   int getThreadsPerWarp() const { return threadsPerWarp; }
 
@@ -22,6 +25,7 @@ private:
   MLIRContext *context;
   int numWarps;
   int threadsPerWarp;
+  int elemBitwidth;
 };
 
 class TritonGPUConversionTarget : public ConversionTarget {
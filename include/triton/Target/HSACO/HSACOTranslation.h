@@ -11,7 +11,7 @@ class Module;
 
 namespace triton {
 
-// Translate TritonGPU IR to HSACO code.
+// Translate TritonGPU IR to AMDGCN assembly and the HSACO binary.
 std::tuple<std::string, std::string>
 translateLLVMIRToHSACO(llvm::Module &module, std::string gfx_arch,
                        std::string gfx_triple, std::string gfx_features);
@@ -17,21 +17,39 @@ class ModuleOp;
 namespace mlir {
 namespace triton {
 
+// Wall time, in seconds, spent in the phases of translateTritonGPUToLLVMIR.
+struct TranslationTimings {
+  // TritonGPU -> LLVM dialect conversion pipeline
+  double lowering = 0;
+  // LLVM dialect -> LLVM IR, including linking of external libraries
+  double translation = 0;
+  // LLVM optimization pipeline
+  double optimization = 0;
+};
+
 // add external dependent libs
 void addExternalLibs(mlir::ModuleOp &module,
                      const std::vector<std::string> &names,
                      const std::vector<std::string> &paths);
 
 // Translate TritonGPU dialect to LLVMIR, return null if failed.
+// With `fastMath`, f32 math is lowered to approximate instructions and the
+// LLVM IR is optimized with fast-math flags. With `printBuffer`, tt.print
+// writes binary records to the ring buffer of the runtime. `optLevel` (0-3)
+// selects the LLVM optimization pipeline; lower levels trade code quality
+// for compile time.
 std::unique_ptr<llvm::Module>
 translateTritonGPUToLLVMIR(llvm::LLVMContext *llvmContext,
                            mlir::ModuleOp module, int computeCapability,
-                           bool isROCM);
+                           bool isROCM, bool fastMath = false,
+                           bool printBuffer = false, int optLevel = 3,
+                           TranslationTimings *timings = nullptr);
 
 // Translate mlir LLVM dialect to LLVMIR, return null if failed.
 std::unique_ptr<llvm::Module>
 translateLLVMToLLVMIR(llvm::LLVMContext *llvmContext, mlir::ModuleOp module,
-                      bool isROCM);
+                      bool isROCM, bool fastMath = false, int optLevel = 3,
+                      TranslationTimings *timings = nullptr);
 
 } // namespace triton
 } // namespace mlir
@@ -9,8 +9,10 @@ class Module;
 
 namespace triton {
 
-// Translate TritonGPU IR to PTX code.
-std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version);
+// Translate TritonGPU IR to PTX code. `optLevel` (0-3) selects the code
+// generation optimization level of the NVPTX backend.
+std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version,
+                                 int optLevel = 3);
 
 } // namespace triton
 
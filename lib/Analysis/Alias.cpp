@@ -38,6 +38,13 @@ void SharedMemoryAliasAnalysis::visitOperation(
       // insert_slice %src into %dst[%offsets]
       aliasInfo = AliasInfo(operands[1]->getValue());
       pessimistic = false;
+    } else if (isa<triton::gpu::ConvertLayoutOp>(op) &&
+               triton::gpu::isMmaV3DotOperand(
+                   result.getType().cast<RankedTensorType>().getEncoding())) {
+      // MMAv3 dot operands are read from the shared memory they are
+      // converted from, by the dot that uses them
+      aliasInfo = AliasInfo(operands[0]->getValue());
+      pessimistic = false;
     } else if (triton::gpu::isSharedEncoding(result)) {
       aliasInfo.insert(result);
       pessimistic = false;
@@ -6,10 +6,14 @@
 #include "triton/Analysis/Alias.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
 
 #include <algorithm>
+#include <functional>
 #include <limits>
 #include <numeric>
+#include <optional>
 
 using ::mlir::triton::gpu::BlockedEncodingAttr;
 using ::mlir::triton::gpu::DotOperandEncodingAttr;
@@ -17,10 +21,14 @@ using ::mlir::triton::gpu::getContigPerThread;
 using ::mlir::triton::gpu::getOrder;
 using ::mlir::triton::gpu::getShapePerCTA;
 using ::mlir::triton::gpu::getSizePerThread;
+using ::mlir::triton::gpu::isaDistributedLayout;
+using ::mlir::triton::gpu::MfmaEncodingAttr;
 using ::mlir::triton::gpu::MmaEncodingAttr;
 using ::mlir::triton::gpu::SharedEncodingAttr;
 using ::mlir::triton::gpu::SliceEncodingAttr;
 
+#define DEBUG_TYPE "allocation-shared-memory"
+
 namespace mlir {
 
 //===----------------------------------------------------------------------===//
@@ -31,16 +39,32 @@ namespace triton {
 // Bitwidth of pointers
 constexpr int kPtrBitWidth = 64;
 
+// Modules with at most this many buffers get an exact search for the
+// smallest allocation when the heuristics miss the lower bound
+constexpr size_t kExactSearchMaxBuffers = 8;
+
+// wgmma swizzles the shared memory addresses of its operands with a period of
+// up to 1024 bytes, on which their buffers are aligned
+constexpr size_t kMmaV3OperandAlignment = 1024;
+
+// cp.async.bulk.tensor writes to 128-byte aligned shared memory
+constexpr size_t kTMABoxAlignment = 128;
+
+// stmatrix writes rows of 16 bytes to 16-byte aligned shared memory
+constexpr unsigned kStMatrixRowBytes = 16;
+
 static std::pair<SmallVector<unsigned>, SmallVector<unsigned>>
 getCvtOrder(Attribute srcLayout, Attribute dstLayout) {
-  auto srcMmaLayout = srcLayout.dyn_cast<MmaEncodingAttr>();
+  bool srcMmaLayout =
+      srcLayout.isa<MmaEncodingAttr>() || srcLayout.isa<MfmaEncodingAttr>();
   auto srcDotLayout = srcLayout.dyn_cast<DotOperandEncodingAttr>();
-  auto dstMmaLayout = dstLayout.dyn_cast<MmaEncodingAttr>();
+  bool dstMmaLayout =
+      dstLayout.isa<MmaEncodingAttr>() || dstLayout.isa<MfmaEncodingAttr>();
   auto dstDotLayout = dstLayout.dyn_cast<DotOperandEncodingAttr>();
   assert(!(srcMmaLayout && dstMmaLayout) &&
          "Unexpected mma -> mma layout conversion");
-  // mma or dot layout does not have an order, so the order depends on the
-  // layout of the other operand.
+  // mma, mfma or dot layout does not have an order, so the order depends on
+  // the layout of the other operand.
   auto inOrd = (srcMmaLayout || srcDotLayout) ? getOrder(dstLayout)
                                               : getOrder(srcLayout);
   auto outOrd = (dstMmaLayout || dstDotLayout) ? getOrder(srcLayout)
@@ -49,9 +73,204 @@ getCvtOrder(Attribute srcLayout, Attribute dstLayout) {
   return {inOrd, outOrd};
 }
 
+// Number of shared memory banks, and their width in bytes
+constexpr unsigned kNumBanks = 32;
+constexpr unsigned kBankBytes = 4;
+
+// Coordinates of an element in the replica of a conversion
+using CvtCoord = std::pair<unsigned, unsigned>;
+
+// Returns, for each access of `vec` elements of the threads of the first
+// warp to the replica of shape `repShape`, the first element accessed by each
+// lane; std::nullopt when the offsets of `layout` are not known here
+static std::optional<SmallVector<SmallVector<CvtCoord>>>
+getWarpAccesses(Attribute layout, ArrayRef<int64_t> shape,
+                ArrayRef<unsigned> repShape, unsigned vec) {
+  auto sizePerThread = getSizePerThread(layout);
+  unsigned numLanes = 32;
+  std::function<CvtCoord(unsigned, unsigned)> getCoord;
+  if (auto blockedLayout = layout.dyn_cast<BlockedEncodingAttr>()) {
+    auto threadsPerWarp = blockedLayout.getThreadsPerWarp();
+    auto order = blockedLayout.getOrder();
+    numLanes = product<unsigned>(threadsPerWarp);
+    getCoord = [=](unsigned lane, unsigned elemId) {
+      unsigned coord[2];
+      coord[order[0]] =
+          lane % threadsPerWarp[order[0]] * sizePerThread[order[0]] +
+          elemId % sizePerThread[order[0]];
+      coord[order[1]] = lane / threadsPerWarp[order[0]] *
+                            sizePerThread[order[1]] +
+                        elemId / sizePerThread[order[0]];
+      return CvtCoord{coord[0], coord[1]};
+    };
+  } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
+    if (!mmaLayout.isAmpere() && !mmaLayout.isHopper())
+      return std::nullopt;
+    getCoord = [](unsigned lane, unsigned elemId) {
+      return CvtCoord{lane / 4 + (elemId < 2 ? 0 : 8),
+                      lane % 4 * 2 + elemId % 2};
+    };
+  } else {
+    return std::nullopt;
+  }
+  auto shapePerCTA = getShapePerCTA(layout, shape);
+  unsigned numCTAs[2];
+  for (unsigned d = 0; d < 2; ++d)
+    numCTAs[d] = std::max<unsigned>(
+        repShape[d] / std::min<unsigned>(shape[d], shapePerCTA[d]), 1);
+  SmallVector<SmallVector<CvtCoord>> accesses;
+  for (unsigned cta0 = 0; cta0 < numCTAs[0]; ++cta0)
+    for (unsigned cta1 = 0; cta1 < numCTAs[1]; ++cta1)
+      for (unsigned elemId = 0; elemId < product<unsigned>(sizePerThread);
+           elemId += vec) {
+        SmallVector<CvtCoord> &access = accesses.emplace_back();
+        for (unsigned lane = 0; lane < numLanes; ++lane) {
+          auto [c0, c1] = getCoord(lane, elemId);
+          access.push_back({(c0 + cta0 * shapePerCTA[0]) % repShape[0],
+                            (c1 + cta1 * shapePerCTA[1]) % repShape[1]});
+        }
+      }
+  return accesses;
+}
+
+// Shared memory wavefronts of `accesses` of `vec` elements of `elemBytes`
+// bytes, given the offset of each element; `maxDegree` is updated with the
+// largest number of accesses to a bank in a wavefront
+static unsigned
+countWavefronts(ArrayRef<SmallVector<CvtCoord>> accesses, unsigned vec,
+                unsigned elemBytes,
+                const std::function<unsigned(CvtCoord)> &getOffset,
+                unsigned &maxDegree) {
+  // Vector accesses wider than a bank are split into phases of the lanes
+  // accessing at most one word per bank each
+  unsigned accessBytes = vec * elemBytes;
+  unsigned lanesPerPhase =
+      std::max<unsigned>(kNumBanks * kBankBytes / std::max(accessBytes, 1u), 1);
+  unsigned wavefronts = 0;
+  for (ArrayRef<CvtCoord> access : accesses) {
+    for (unsigned first = 0; first < access.size(); first += lanesPerPhase) {
+      SmallVector<SmallVector<unsigned>> words(kNumBanks);
+      for (unsigned lane = first;
+           lane < std::min<unsigned>(first + lanesPerPhase, access.size());
+           ++lane) {
+        unsigned begin = getOffset(access[lane]) * elemBytes;
+        for (unsigned byte = begin; byte < begin + accessBytes;
+             byte += kBankBytes) {
+          unsigned word = byte / kBankBytes;
+          auto &bankWords = words[word % kNumBanks];
+          if (!llvm::is_contained(bankWords, word))
+            bankWords.push_back(word);
+        }
+      }
+      unsigned degree = 1;
+      for (auto &bankWords : words)
+        degree = std::max<unsigned>(degree, bankWords.size());
+      wavefronts += degree;
+      maxDegree = std::max(maxDegree, degree);
+    }
+  }
+  return wavefronts;
+}
+
+// Chooses the swizzling of the rows of the replica `repShape` of `op` whose
+// stores and loads take the fewest wavefronts, if fewer than with the rows
+// padded by `pad` elements
+static std::optional<CvtSwizzle>
+getSwizzleForCvtLayout(triton::gpu::ConvertLayoutOp op,
+                       ArrayRef<unsigned> repShape, unsigned inVec,
+                       unsigned outVec, unsigned pad) {
+  auto srcTy = op.getSrc().getType().cast<RankedTensorType>();
+  auto dstTy = op.getResult().getType().cast<RankedTensorType>();
+  if (dstTy.getRank() != 2)
+    return std::nullopt;
+  auto stores = getWarpAccesses(srcTy.getEncoding(), srcTy.getShape(),
+                                repShape, inVec);
+  auto loads = getWarpAccesses(dstTy.getEncoding(), dstTy.getShape(),
+                               repShape, outVec);
+  if (!stores || !loads)
+    return std::nullopt;
+  // The replica is laid out along the order of the destination, as in the
+  // lowering of the conversion
+  auto outOrd = getOrder(dstTy.getEncoding());
+  unsigned rowLength = repShape[outOrd[0]];
+  if (!llvm::isPowerOf2_32(rowLength))
+    return std::nullopt;
+  Type elemTy = dstTy.getElementType();
+  unsigned elemBytes = elemTy.isa<triton::PointerType>()
+                           ? kPtrBitWidth / 8
+                           : std::max<unsigned>(
+                                 elemTy.getIntOrFloatBitWidth(), 8) / 8;
+
+  auto getCost = [&](const CvtSwizzle &swizzle, unsigned &storeDegree,
+                     unsigned &loadDegree) {
+    auto getOffset = [&](CvtCoord coord) {
+      unsigned coords[2] = {coord.first, coord.second};
+      unsigned row = coords[outOrd[1]];
+      unsigned col = coords[outOrd[0]];
+      if (swizzle.maxPhase == 1)
+        return row * (rowLength + pad) + col;
+      unsigned phase = (row / swizzle.perPhase) % swizzle.maxPhase;
+      col = ((col / swizzle.vec) ^ phase) * swizzle.vec + col % swizzle.vec;
+      return row * rowLength + col;
+    };
+    storeDegree = loadDegree = 0;
+    return countWavefronts(*stores, inVec, elemBytes, getOffset,
+                           storeDegree) +
+           countWavefronts(*loads, outVec, elemBytes, getOffset, loadDegree);
+  };
+
+  CvtSwizzle padded;
+  unsigned storeDegree, loadDegree;
+  unsigned paddedCost = getCost(padded, storeDegree, loadDegree);
+  LLVM_DEBUG(llvm::dbgs() << "padded scratch of " << op << ": " << storeDegree
+                          << "-way store and " << loadDegree
+                          << "-way load bank conflicts\n");
+  std::optional<CvtSwizzle> best;
+  unsigned bestCost = paddedCost;
+  // Chunks hold whole vectors of both the stores and the loads
+  for (unsigned vec = std::max(inVec, outVec); vec <= rowLength; vec *= 2)
+    for (unsigned maxPhase = 2; maxPhase * vec <= rowLength; maxPhase *= 2)
+      for (unsigned perPhase = 1; perPhase <= repShape[outOrd[1]];
+           perPhase *= 2) {
+        CvtSwizzle swizzle{vec, perPhase, maxPhase};
+        unsigned cost = getCost(swizzle, storeDegree, loadDegree);
+        if (cost < bestCost) {
+          best = swizzle;
+          bestCost = cost;
+        }
+      }
+  if (best) {
+    getCost(*best, storeDegree, loadDegree);
+    LLVM_DEBUG(llvm::dbgs() << "swizzled scratch (vec = " << best->vec
+                            << ", perPhase = " << best->perPhase
+                            << ", maxPhase = " << best->maxPhase
+                            << "): " << storeDegree << "-way store and "
+                            << loadDegree << "-way load bank conflicts\n");
+  }
+  return best;
+}
+
+bool isStMatrixCvt(triton::gpu::ConvertLayoutOp op) {
+  auto srcTy = op.getSrc().getType().cast<RankedTensorType>();
+  auto dstTy = op.getResult().getType().cast<RankedTensorType>();
+  Attribute srcLayout = srcTy.getEncoding();
+  Attribute dstLayout = dstTy.getEncoding();
+  auto srcMmaLayout = srcLayout.dyn_cast<MmaEncodingAttr>();
+  if (!srcMmaLayout || !srcMmaLayout.isHopper() ||
+      !isaDistributedLayout(dstLayout) || dstLayout.isa<MmaEncodingAttr>())
+    return false;
+  Type elemTy = srcTy.getElementType();
+  if (elemTy.isa<triton::PointerType>() || elemTy.getIntOrFloatBitWidth() != 16)
+    return false;
+  // Each warp stores 16x8 tiles, whose rows are contiguous in the scratch
+  auto shape = srcTy.getShape();
+  auto [inOrd, outOrd] = getCvtOrder(srcLayout, dstLayout);
+  return shape[0] % 16 == 0 && shape[1] % 8 == 0 && outOrd[0] == 1;
+}
+
 SmallVector<unsigned>
 getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
-                             unsigned &outVec) {
+                             unsigned &outVec, CvtSwizzle *swizzle) {
   auto srcTy = op.getSrc().getType().cast<RankedTensorType>();
   auto dstTy = op.getResult().getType().cast<RankedTensorType>();
   Attribute srcLayout = srcTy.getEncoding();
@@ -92,6 +311,22 @@ getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
   if (auto dstBlockedLayout = dstLayout.dyn_cast<BlockedEncodingAttr>()) {
     paddedDim = dstBlockedLayout.getOrder()[0];
   }
+  if (isStMatrixCvt(op)) {
+    // The 8 rows of 16 bytes each stmatrix writes are on distinct banks
+    if (swizzle)
+      *swizzle = CvtSwizzle();
+    paddedRepShape[paddedDim] +=
+        kStMatrixRowBytes * 8 / srcTy.getElementTypeBitWidth();
+    return paddedRepShape;
+  }
+  if (auto best =
+          getSwizzleForCvtLayout(op, paddedRepShape, inVec, outVec, pad)) {
+    if (swizzle)
+      *swizzle = *best;
+    return paddedRepShape;
+  }
+  if (swizzle)
+    *swizzle = CvtSwizzle();
   paddedRepShape[paddedDim] += pad;
   return paddedRepShape;
 }
@@ -135,6 +370,7 @@ private:
 
   void run() {
     getValuesAndSizes();
+    getAlignments();
     resolveLiveness();
     computeOffsets();
   }
@@ -189,9 +425,10 @@ private:
         return;
       }
       // ConvertLayoutOp with both input/output non-shared_layout
-      // TODO: Besides of implementing ConvertLayoutOp via shared memory, it's
-      //       also possible to realize it with other approaches in restricted
-      //       conditions, such as warp-shuffle
+      if (isWarpShuffleCvt(cvtLayout)) {
+        // Elements only move between lanes of the same warp
+        return;
+      }
       unsigned inVec = 0;
       unsigned outVec = 0;
       auto smemShape = getScratchConfigForCvtLayout(cvtLayout, inVec, outVec);
@@ -202,11 +439,14 @@ private:
               ? elems * kPtrBitWidth / 8
               : elems * std::max<int>(8, srcTy.getElementTypeBitWidth()) / 8;
       maybeAddScratchBuffer<BufferT::BufferKind::Scratch>(op, bytes);
+      if (isStMatrixCvt(cvtLayout))
+        allocation->opScratch[op]->alignment = kStMatrixRowBytes;
     } else if (auto atomicRMWOp = dyn_cast<triton::AtomicRMWOp>(op)) {
       auto value = op->getOperand(0);
-      // only scalar requires scratch memory
-      // make it explicit for readability
-      if (value.getType().dyn_cast<RankedTensorType>()) {
+      // only scalar requires scratch memory, to broadcast the old value when
+      // it is returned; make it explicit for readability
+      if (value.getType().dyn_cast<RankedTensorType>() ||
+          isAtomicReduction(atomicRMWOp)) {
         // nothing to do
       } else {
         auto smemShape = getScratchConfigForAtomicRMW(atomicRMWOp);
@@ -231,6 +471,15 @@ private:
                        ? elems * kPtrBitWidth / 8
                        : elems * elemTy.getIntOrFloatBitWidth() / 8;
       maybeAddScratchBuffer<BufferT::BufferKind::Scratch>(op, bytes);
+    } else if (auto tmaLoadOp = dyn_cast<triton::TMALoadOp>(op)) {
+      // The box the TMA writes, followed by the mbarrier tracking the copy
+      auto tensorType =
+          tmaLoadOp.getResult().getType().cast<RankedTensorType>();
+      unsigned bytes = tensorType.getNumElements() *
+                           tensorType.getElementTypeBitWidth() / 8 +
+                       8;
+      maybeAddScratchBuffer<BufferT::BufferKind::Scratch>(op, bytes);
+      allocation->opScratch[op]->alignment = kTMABoxAlignment;
     } else if (auto callOp = dyn_cast<CallOpInterface>(op)) {
       auto callable = callOp.resolveCallable();
       auto funcOp = dyn_cast<FunctionOpInterface>(callable);
@@ -278,6 +527,19 @@ private:
     });
   }
 
+  /// Aligns the buffers that MMAv3 dots read their operands from
+  void getAlignments() {
+    operation->walk([&](triton::gpu::ConvertLayoutOp cvtOp) {
+      auto dstType = cvtOp.getType().cast<RankedTensorType>();
+      if (!triton::gpu::isMmaV3DotOperand(dstType.getEncoding()))
+        return;
+      for (auto bufferId : allocation->getBufferIds(cvtOp.getSrc())) {
+        auto &buffer = allocation->bufferSet.at(bufferId);
+        buffer.alignment = std::max(buffer.alignment, kMmaV3OperandAlignment);
+      }
+    });
+  }
+
   /// Computes the liveness range of the allocated value.
   /// Each buffer is allocated only once.
   void resolveExplicitBufferLiveness(
@@ -314,8 +576,15 @@ private:
   /// Computes the liveness range of scratched buffers.
   /// Some operations may have a temporary buffer that is not explicitly
   /// allocated, but is used to store intermediate results.
+  /// The warp groups of a warp-specialized module run their parts of a
+  /// function at the same time, so a scratch buffer of one group must not
+  /// be reused by the other: scratch buffers are then live across the whole
+  /// function.
   void resolveScratchBufferLiveness(
       const DenseMap<Operation *, size_t> &operationId) {
+    auto mod = operation->getParentOfType<ModuleOp>();
+    bool concurrentGroups =
+        mod && triton::gpu::TritonGPUDialect::getNumWarpGroups(mod) > 1;
     // Analyze liveness of scratch buffers and vritual buffers.
     auto processScratchMemory = [&](const auto &container) {
       for (auto opScratchIter : container) {
@@ -323,8 +592,11 @@ private:
         // range.
         auto *op = opScratchIter.first;
         auto *buffer = opScratchIter.second;
-        bufferRange.insert({buffer, Interval(operationId.lookup(op),
-                                             operationId.lookup(op) + 1)});
+        if (concurrentGroups)
+          bufferRange.insert({buffer, Interval<size_t>(0, operationId.size())});
+        else
+          bufferRange.insert({buffer, Interval(operationId.lookup(op),
+                                               operationId.lookup(op) + 1)});
       }
     };
     processScratchMemory(allocation->opScratch);
@@ -379,12 +651,39 @@ private:
   /// Computes the shared memory offsets for all related values.
   /// Paper: Algorithms for Compile-Time Memory Optimization
   /// (https://www.cs.utexas.edu/users/harrison/papers/compile-time.pdf)
+  ///
+  /// The greedy heuristic of the paper can end up well above the max-live
+  /// lower bound, so its result is compared against a best-fit packing of
+  /// the liveness intervals (and, for few buffers, an exact search), and the
+  /// smallest footprint wins.
   void computeOffsets() {
     SmallVector<BufferT *> buffers;
     for (auto bufferIter : bufferRange) {
       buffers.emplace_back(bufferIter.first);
     }
+    size_t lowerBound = computeLowerBound(buffers);
+    allocation->sharedMemoryLowerBound = lowerBound;
+
+    computeGreedyOffsets(buffers);
+    size_t greedySize = allocation->sharedMemorySize;
+    if (greedySize <= lowerBound)
+      return;
 
+    DenseMap<BufferT *, size_t> packedOffsets;
+    size_t packedSize = packBestFit(buffers, packedOffsets);
+    if (packedSize > lowerBound && buffers.size() <= kExactSearchMaxBuffers)
+      packedSize =
+          searchExact(buffers, lowerBound, packedOffsets, packedSize);
+    if (packedSize >= greedySize)
+      return;
+    for (auto *buffer : buffers)
+      buffer->offset = packedOffsets.lookup(buffer);
+    allocation->sharedMemorySize = packedSize;
+  }
+
+  /// Computes the offsets with the greedy triple-map heuristic followed by
+  /// interference graph coloring.
+  void computeGreedyOffsets(const SmallVector<BufferT *> &buffers) {
     DenseMap<BufferT *, size_t> bufferStart;
     calculateStarts(buffers, bufferStart);
 
@@ -403,6 +702,150 @@ private:
     } while (!interference.empty());
   }
 
+  /// Returns the largest total size of the buffers live at the same time,
+  /// which no allocation can go below.
+  size_t computeLowerBound(const SmallVector<BufferT *> &buffers) {
+    size_t lowerBound = 0;
+    for (auto *x : buffers) {
+      // The live set only grows at the start of a range
+      auto point = bufferRange.lookup(x).start();
+      size_t live = 0;
+      for (auto *y : buffers)
+        if (bufferRange.lookup(y).contains(point))
+          live += y->size;
+      lowerBound = std::max(lowerBound, live);
+    }
+    return lowerBound;
+  }
+
+  /// Returns the offset at which `buffer` is placed, given the offsets of the
+  /// already `placed` buffers: with `bestFit`, in the smallest free gap among
+  /// the buffers whose liveness overlaps it, otherwise in the lowest one. If
+  /// no gap is large enough, the buffer goes on top of them. Gaps start at
+  /// the alignment of the buffer.
+  size_t findOffset(BufferT *buffer, ArrayRef<BufferT *> placed,
+                    const DenseMap<BufferT *, size_t> &offsets, bool bestFit) {
+    auto range = bufferRange.lookup(buffer);
+    SmallVector<Interval<size_t>> occupied;
+    for (auto *other : placed) {
+      if (bufferRange.lookup(other).intersects(range)) {
+        auto offset = offsets.lookup(other);
+        occupied.push_back({offset, offset + other->size});
+      }
+    }
+    llvm::sort(occupied);
+    size_t top = 0;
+    std::optional<Interval<size_t>> bestGap;
+    for (auto interval : occupied) {
+      size_t start = llvm::alignTo(top, buffer->alignment);
+      if (interval.start() > start) {
+        Interval<size_t> gap(start, interval.start());
+        if (gap.size() >= buffer->size) {
+          if (!bestFit)
+            return gap.start();
+          if (!bestGap || gap.size() < bestGap->size())
+            bestGap = gap;
+        }
+      }
+      top = std::max(top, interval.end());
+    }
+    return bestGap ? bestGap->start() : llvm::alignTo(top, buffer->alignment);
+  }
+
+  /// Packs the buffers in `order`, returning the resulting footprint.
+  size_t packInOrder(ArrayRef<BufferT *> order,
+                     DenseMap<BufferT *, size_t> &offsets) {
+    size_t size = 0;
+    for (auto it = order.begin(); it != order.end(); ++it) {
+      auto offset = findOffset(*it, ArrayRef<BufferT *>(order.begin(), it),
+                               offsets, /*bestFit=*/true);
+      offsets[*it] = offset;
+      size = std::max(size, offset + (*it)->size);
+    }
+    return size;
+  }
+
+  /// Best-fit offline allocation of the liveness intervals: buffers are
+  /// placed one at a time in the tightest gap left by the buffers they are
+  /// live with, for a few placement orders, keeping the smallest footprint.
+  size_t packBestFit(const SmallVector<BufferT *> &buffers,
+                     DenseMap<BufferT *, size_t> &offsets) {
+    auto length = [&](BufferT *buffer) {
+      return bufferRange.lookup(buffer).size();
+    };
+    auto start = [&](BufferT *buffer) {
+      return bufferRange.lookup(buffer).start();
+    };
+    SmallVector<std::function<bool(BufferT *, BufferT *)>> orders = {
+        // largest buffers first
+        [&](BufferT *x, BufferT *y) {
+          return std::make_tuple(-(ptrdiff_t)x->size, start(x), x->id) <
+                 std::make_tuple(-(ptrdiff_t)y->size, start(y), y->id);
+        },
+        // in program order
+        [&](BufferT *x, BufferT *y) {
+          return std::make_tuple(start(x), -(ptrdiff_t)x->size, x->id) <
+                 std::make_tuple(start(y), -(ptrdiff_t)y->size, y->id);
+        },
+        // longest-lived buffers first
+        [&](BufferT *x, BufferT *y) {
+          return std::make_tuple(-(ptrdiff_t)length(x), -(ptrdiff_t)x->size,
+                                 x->id) <
+                 std::make_tuple(-(ptrdiff_t)length(y), -(ptrdiff_t)y->size,
+                                 y->id);
+        }};
+    size_t bestSize = std::numeric_limits<size_t>::max();
+    for (auto &order : orders) {
+      SmallVector<BufferT *> sorted = buffers;
+      llvm::sort(sorted, order);
+      DenseMap<BufferT *, size_t> candidate;
+      size_t size = packInOrder(sorted, candidate);
+      if (size < bestSize) {
+        bestSize = size;
+        offsets = std::move(candidate);
+      }
+    }
+    return bestSize;
+  }
+
+  /// Exhaustively searches the placement orders, each buffer going to the
+  /// lowest offset that fits and is a multiple of its alignment: placing the
+  /// buffers of any optimal allocation in the order of their offsets only
+  /// ever moves them down, to offsets that are still aligned, so this finds
+  /// the optimum among the aligned allocations. Only improves on `bestSize`,
+  /// and stops early once `lowerBound` is reached (which ignores alignment
+  /// padding, so it may not be reachable).
+  size_t searchExact(const SmallVector<BufferT *> &buffers, size_t lowerBound,
+                     DenseMap<BufferT *, size_t> &bestOffsets,
+                     size_t bestSize) {
+    SmallVector<BufferT *> remaining = buffers;
+    llvm::sort(remaining, [](BufferT *x, BufferT *y) { return x->id < y->id; });
+    SmallVector<BufferT *> placed;
+    DenseMap<BufferT *, size_t> offsets;
+    std::function<void(size_t)> search = [&](size_t size) {
+      if (size >= bestSize)
+        return;
+      if (remaining.empty()) {
+        bestSize = size;
+        bestOffsets = offsets;
+        return;
+      }
+      for (size_t i = 0; i < remaining.size() && bestSize > lowerBound; ++i) {
+        auto *buffer = remaining[i];
+        auto offset = findOffset(buffer, placed, offsets, /*bestFit=*/false);
+        offsets[buffer] = offset;
+        placed.push_back(buffer);
+        remaining.erase(remaining.begin() + i);
+        search(std::max(size, offset + buffer->size));
+        remaining.insert(remaining.begin() + i, buffer);
+        placed.pop_back();
+        offsets.erase(buffer);
+      }
+    };
+    search(0);
+    return bestSize;
+  }
+
   /// Computes the initial shared memory offsets.
   void calculateStarts(const SmallVector<BufferT *> &buffers,
                        DenseMap<BufferT *, size_t> &bufferStart) {
@@ -526,7 +969,8 @@ private:
       for (auto y : interference.lookup(x)) {
         adj = std::max(adj, bufferStart.lookup(y) + y->size);
       }
-      x->offset = bufferStart.lookup(x) + colors.lookup(x) * adj;
+      x->offset = llvm::alignTo(bufferStart.lookup(x) + colors.lookup(x) * adj,
+                                x->alignment);
       bufferStart[x] = x->offset;
       allocation->sharedMemorySize =
           std::max(allocation->sharedMemorySize, x->offset + x->size);
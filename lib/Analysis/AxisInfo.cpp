@@ -1,11 +1,16 @@
 #include "mlir/Analysis/DataFlowFramework.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/IR/TypeUtilities.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "triton/Analysis/AxisInfo.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 
+#include <deque>
+
 namespace mlir {
 
 // Function for extended Euclidean Algorithm
@@ -72,6 +77,7 @@ AxisInfo AxisInfo::getPessimisticValueState(Value value) {
   DimVectorT knownContiguity(rank, 1);
   DimVectorT knownDivisibility(rank, 1);
   DimVectorT knownConstancy(rank, 1);
+  std::optional<RangeT> knownValueRange;
 
   BlockArgument blockArg = value.dyn_cast<BlockArgument>();
 
@@ -107,6 +113,23 @@ AxisInfo AxisInfo::getPessimisticValueState(Value value) {
                 knownDivisibility = DimVectorT(rank, k);
             }
           }
+          // The induction variable is in [lb, ub) when all bounds are
+          // constants
+          auto getConstant = [](Value v) -> std::optional<int64_t> {
+            if (auto constOp = v.getDefiningOp<arith::ConstantOp>())
+              if (auto intAttr = constOp.getValue().dyn_cast<IntegerAttr>())
+                return intAttr.getValue().getSExtValue();
+            return {};
+          };
+          auto lb = getConstant(forOp.getLowerBound());
+          auto ub = getConstant(forOp.getUpperBound());
+          auto step = getConstant(forOp.getStep());
+          if (lb && ub && step && *step > 0) {
+            int64_t last = *lb;
+            if (*ub > *lb)
+              last += (*ub - 1 - *lb) / *step * *step;
+            knownValueRange = RangeT{*lb, last};
+          }
         }
       }
     }
@@ -125,7 +148,44 @@ AxisInfo AxisInfo::getPessimisticValueState(Value value) {
     }
   }
 
-  return AxisInfo(knownContiguity, knownDivisibility, knownConstancy);
+  return AxisInfo(knownContiguity, knownDivisibility, knownConstancy,
+                  /*knownConstantValue=*/{}, knownValueRange);
+}
+
+// Round `value` up to the next 2^k - 1
+static int64_t widenUp(int64_t value) {
+  if (value <= 0)
+    return 0;
+  return llvm::PowerOf2Ceil(static_cast<uint64_t>(value) + 1) - 1;
+}
+
+// Round `value` down to the previous -2^k
+static int64_t widenDown(int64_t value) {
+  if (value >= 0)
+    return 0;
+  uint64_t magnitude = llvm::PowerOf2Ceil(-static_cast<uint64_t>(value));
+  return -static_cast<int64_t>(magnitude - 1) - 1;
+}
+
+static bool contains(const AxisInfo::RangeT &outer,
+                     const AxisInfo::RangeT &inner) {
+  return outer.first <= inner.first && inner.second <= outer.second;
+}
+
+// The union of both ranges. The bounds of a union that is larger than both
+// ranges are rounded to powers of two, so that values growing across loop
+// iterations reach a fixed point in a few steps.
+static std::optional<AxisInfo::RangeT>
+joinValueRanges(std::optional<AxisInfo::RangeT> lhs,
+                std::optional<AxisInfo::RangeT> rhs) {
+  if (!lhs || !rhs)
+    return {};
+  if (contains(*lhs, *rhs))
+    return lhs;
+  if (contains(*rhs, *lhs))
+    return rhs;
+  return AxisInfo::RangeT{widenDown(std::min(lhs->first, rhs->first)),
+                          widenUp(std::max(lhs->second, rhs->second))};
 }
 
 // The gcd of both arguments for each dimension
@@ -148,7 +208,8 @@ AxisInfo AxisInfo::join(const AxisInfo &lhs, const AxisInfo &rhs) {
       rhs.getConstantValue().has_value() &&
       lhs.getConstantValue() == rhs.getConstantValue())
     constantValue = lhs.getConstantValue();
-  return AxisInfo(contiguity, divisibility, constancy, constantValue);
+  return AxisInfo(contiguity, divisibility, constancy, constantValue,
+                  joinValueRanges(lhs.getValueRange(), rhs.getValueRange()));
 }
 
 //===----------------------------------------------------------------------===//
@@ -852,6 +913,275 @@ public:
   }
 };
 
+//===----------------------------------------------------------------------===//
+// Value ranges
+//===----------------------------------------------------------------------===//
+
+using RangeT = AxisInfo::RangeT;
+
+static bool fitsType(const RangeT &range, Type elemTy) {
+  if (elemTy.isIndex())
+    return true;
+  auto bitWidth = elemTy.getIntOrFloatBitWidth();
+  if (bitWidth == 1)
+    return range.first >= 0 && range.second <= 1;
+  if (bitWidth >= 64)
+    return true;
+  int64_t max = (int64_t(1) << (bitWidth - 1)) - 1;
+  return range.first >= -max - 1 && range.second <= max;
+}
+
+static bool isNonNegative(const RangeT &range) { return range.first >= 0; }
+
+static RangeT hull(const RangeT &lhs, const RangeT &rhs) {
+  return {std::min(lhs.first, rhs.first), std::max(lhs.second, rhs.second)};
+}
+
+// The bounds of `fn` applied to the corners of both ranges, which is exact
+// for functions monotone in each argument. Fails on overflow.
+template <typename FnT>
+static std::optional<RangeT> applyToCorners(const RangeT &lhs,
+                                            const RangeT &rhs, FnT fn) {
+  std::optional<RangeT> result;
+  for (int64_t l : {lhs.first, lhs.second})
+    for (int64_t r : {rhs.first, rhs.second}) {
+      int64_t value;
+      if (fn(l, r, value))
+        return {};
+      result = result ? hull(*result, {value, value}) : RangeT{value, value};
+    }
+  return result;
+}
+
+static std::optional<RangeT> getConstantRange(Attribute value) {
+  auto getInt = [](const APInt &v) {
+    return v.getBitWidth() == 1 ? static_cast<int64_t>(v.getZExtValue())
+                                : v.getSExtValue();
+  };
+  if (auto intAttr = value.dyn_cast<IntegerAttr>()) {
+    int64_t v = getInt(intAttr.getValue());
+    return RangeT{v, v};
+  }
+  if (auto boolAttr = value.dyn_cast<BoolAttr>()) {
+    int64_t v = boolAttr.getValue();
+    return RangeT{v, v};
+  }
+  auto denseAttr = value.dyn_cast<DenseIntElementsAttr>();
+  if (!denseAttr || denseAttr.empty())
+    return {};
+  if (denseAttr.isSplat()) {
+    int64_t v = getInt(denseAttr.getSplatValue<APInt>());
+    return RangeT{v, v};
+  }
+  std::optional<RangeT> result;
+  for (const APInt &element : denseAttr.getValues<APInt>()) {
+    int64_t v = getInt(element);
+    result = result ? hull(*result, {v, v}) : RangeT{v, v};
+  }
+  return result;
+}
+
+// Whether `pred` holds for every pair of values of both ranges (true), for
+// none of them (false), or neither
+static std::optional<bool> decideCmp(arith::CmpIPredicate pred,
+                                     const RangeT &lhs, const RangeT &rhs) {
+  switch (pred) {
+  case arith::CmpIPredicate::ult:
+  case arith::CmpIPredicate::ule:
+  case arith::CmpIPredicate::ugt:
+  case arith::CmpIPredicate::uge:
+    // Unsigned and signed orders agree on non-negative values
+    if (!isNonNegative(lhs) || !isNonNegative(rhs))
+      return {};
+    break;
+  default:
+    break;
+  }
+  switch (pred) {
+  case arith::CmpIPredicate::eq:
+  case arith::CmpIPredicate::ne: {
+    bool eq = pred == arith::CmpIPredicate::eq;
+    if (lhs.first == lhs.second && lhs == rhs)
+      return eq;
+    if (lhs.second < rhs.first || rhs.second < lhs.first)
+      return !eq;
+    return {};
+  }
+  case arith::CmpIPredicate::slt:
+  case arith::CmpIPredicate::ult:
+    if (lhs.second < rhs.first)
+      return true;
+    if (lhs.first >= rhs.second)
+      return false;
+    return {};
+  case arith::CmpIPredicate::sle:
+  case arith::CmpIPredicate::ule:
+    if (lhs.second <= rhs.first)
+      return true;
+    if (lhs.first > rhs.second)
+      return false;
+    return {};
+  case arith::CmpIPredicate::sgt:
+  case arith::CmpIPredicate::ugt:
+    return decideCmp(arith::CmpIPredicate::slt, rhs, lhs);
+  case arith::CmpIPredicate::sge:
+  case arith::CmpIPredicate::uge:
+    return decideCmp(arith::CmpIPredicate::sle, rhs, lhs);
+  }
+  return {};
+}
+
+// Bounds on the integer values of the result of `op`, given those of its
+// operands
+static std::optional<RangeT>
+inferValueRange(Operation *op,
+                ArrayRef<const dataflow::Lattice<AxisInfo> *> operands) {
+  if (op->getNumResults() != 1)
+    return {};
+  Type elemTy = getElementTypeOrSelf(op->getResult(0).getType());
+  if (!elemTy.isIntOrIndex())
+    return {};
+  auto range = [&](unsigned i) -> std::optional<RangeT> {
+    if (i >= operands.size())
+      return {};
+    return operands[i]->getValue().getValueRange();
+  };
+  auto lhs = range(0);
+  auto rhs = range(1);
+
+  std::optional<RangeT> result;
+  if (auto constOp = dyn_cast<arith::ConstantOp>(op)) {
+    result = getConstantRange(constOp.getValue());
+  } else if (auto makeRange = dyn_cast<triton::MakeRangeOp>(op)) {
+    result = RangeT{makeRange.getStart(), int64_t(makeRange.getEnd()) - 1};
+  } else if (auto pidOp = dyn_cast<triton::GetProgramIdOp>(op)) {
+    // Grid dimensions are at most 2^31 - 1 along x and 65535 along y and z
+    result = RangeT{0, pidOp.getAxisAsInt() == 0 ? (int64_t(1) << 31) - 2 : 65534};
+  } else if (auto numOp = dyn_cast<triton::GetNumProgramsOp>(op)) {
+    result = RangeT{1, numOp.getAxis() == 0 ? (int64_t(1) << 31) - 1 : 65535};
+  } else if (auto extOp = dyn_cast<arith::ExtSIOp>(op)) {
+    // i1 ranges are kept zero-extended, so sign extension maps 1 to -1
+    if (lhs && getElementTypeOrSelf(extOp.getIn().getType()).isInteger(1))
+      result = RangeT{-lhs->second, -lhs->first};
+    else
+      result = lhs;
+  } else if (isa<arith::TruncIOp>(op)) {
+    // Truncation wraps values outside of the destination width
+    unsigned width = elemTy.getIntOrFloatBitWidth();
+    if (lhs && width == 1) {
+      if (lhs->first >= 0 && lhs->second <= 1)
+        result = lhs;
+    } else if (lhs && width < 64) {
+      int64_t bound = int64_t(1) << (width - 1);
+      if (lhs->first >= -bound && lhs->second < bound)
+        result = lhs;
+    } else {
+      result = lhs;
+    }
+  } else if (isa<arith::IndexCastOp, triton::gpu::ConvertLayoutOp,
+                 UnrealizedConversionCastOp, triton::SplatOp,
+                 triton::BroadcastOp, triton::ExpandDimsOp, triton::ViewOp,
+                 triton::TransOp>(op)) {
+    result = lhs;
+  } else if (isa<arith::ExtUIOp>(op)) {
+    if (lhs && isNonNegative(*lhs))
+      result = lhs;
+  } else if (!lhs || (op->getNumOperands() > 1 && !rhs &&
+                      !isa<arith::SelectOp, triton::gpu::SelectOp>(op))) {
+    return {};
+  } else if (isa<arith::AddIOp>(op)) {
+    result = RangeT{};
+    if (llvm::AddOverflow(lhs->first, rhs->first, result->first) ||
+        llvm::AddOverflow(lhs->second, rhs->second, result->second))
+      return {};
+  } else if (isa<arith::SubIOp>(op)) {
+    result = RangeT{};
+    if (llvm::SubOverflow(lhs->first, rhs->second, result->first) ||
+        llvm::SubOverflow(lhs->second, rhs->first, result->second))
+      return {};
+  } else if (isa<arith::MulIOp>(op)) {
+    result = applyToCorners(*lhs, *rhs, [](int64_t l, int64_t r, int64_t &v) {
+      return llvm::MulOverflow(l, r, v);
+    });
+  } else if (isa<arith::DivSIOp, arith::DivUIOp>(op)) {
+    bool isUnsigned = isa<arith::DivUIOp>(op);
+    if (rhs->first > 0 && (!isUnsigned || isNonNegative(*lhs)))
+      result = applyToCorners(*lhs, *rhs, [](int64_t l, int64_t r, int64_t &v) {
+        v = l / r;
+        return false;
+      });
+  } else if (isa<arith::RemSIOp, arith::RemUIOp>(op)) {
+    bool isUnsigned = isa<arith::RemUIOp>(op);
+    if (rhs->first > 0 && (!isUnsigned || isNonNegative(*lhs))) {
+      if (isNonNegative(*lhs) && lhs->second < rhs->first)
+        result = lhs;
+      else
+        // The remainder has the sign of the dividend
+        result = RangeT{std::min<int64_t>(0, std::max(lhs->first,
+                                                      1 - rhs->second)),
+                        std::max<int64_t>(0, std::min(lhs->second,
+                                                      rhs->second - 1))};
+    }
+  } else if (isa<arith::AndIOp>(op)) {
+    if (isNonNegative(*lhs) && isNonNegative(*rhs))
+      result = elemTy.isInteger(1)
+                   ? RangeT{std::min(lhs->first, rhs->first),
+                            std::min(lhs->second, rhs->second)}
+                   : RangeT{0, std::min(lhs->second, rhs->second)};
+  } else if (isa<arith::OrIOp>(op)) {
+    if (isNonNegative(*lhs) && isNonNegative(*rhs))
+      result = elemTy.isInteger(1)
+                   ? RangeT{std::max(lhs->first, rhs->first),
+                            std::max(lhs->second, rhs->second)}
+                   : RangeT{std::max(lhs->first, rhs->first),
+                            widenUp(std::max(lhs->second, rhs->second))};
+  } else if (isa<arith::MaxSIOp, arith::MinSIOp, arith::MaxUIOp,
+                 arith::MinUIOp>(op)) {
+    if (isa<arith::MaxUIOp, arith::MinUIOp>(op) &&
+        (!isNonNegative(*lhs) || !isNonNegative(*rhs)))
+      return {};
+    if (isa<arith::MaxSIOp, arith::MaxUIOp>(op))
+      result = RangeT{std::max(lhs->first, rhs->first),
+                      std::max(lhs->second, rhs->second)};
+    else
+      result = RangeT{std::min(lhs->first, rhs->first),
+                      std::min(lhs->second, rhs->second)};
+  } else if (isa<arith::SelectOp, triton::gpu::SelectOp>(op)) {
+    auto trueRange = range(1);
+    auto falseRange = range(2);
+    if (*lhs == RangeT{1, 1})
+      result = trueRange;
+    else if (*lhs == RangeT{0, 0})
+      result = falseRange;
+    else if (trueRange && falseRange)
+      result = hull(*trueRange, *falseRange);
+  } else if (isa<arith::CmpIOp, triton::gpu::CmpIOp>(op)) {
+    auto pred = isa<arith::CmpIOp>(op)
+                    ? cast<arith::CmpIOp>(op).getPredicate()
+                    : cast<triton::gpu::CmpIOp>(op).getPredicate();
+    if (auto decided = decideCmp(pred, *lhs, *rhs))
+      result = RangeT{*decided, *decided};
+    else
+      result = RangeT{0, 1};
+  } else if (isa<arith::ShLIOp, arith::ShRSIOp, arith::ShRUIOp>(op)) {
+    if (rhs->first != rhs->second || rhs->first < 0 || rhs->first > 62)
+      return {};
+    int64_t shift = rhs->first;
+    if (isa<arith::ShLIOp>(op))
+      result = applyToCorners(*lhs, {int64_t(1) << shift, int64_t(1) << shift},
+                              [](int64_t l, int64_t r, int64_t &v) {
+                                return llvm::MulOverflow(l, r, v);
+                              });
+    else if (isa<arith::ShRSIOp>(op) || isNonNegative(*lhs))
+      result = RangeT{lhs->first >> shift, lhs->second >> shift};
+  }
+  if (elemTy.isInteger(1) && !result)
+    result = RangeT{0, 1};
+  if (result && !fitsType(*result, elemTy))
+    return {};
+  return result;
+}
+
 //===----------------------------------------------------------------------===//
 // AxisInfoAnalysis
 //===----------------------------------------------------------------------===//
@@ -907,18 +1237,50 @@ AxisInfoAnalysis::AxisInfoAnalysis(DataFlowSolver &solver)
 void AxisInfoAnalysis::visitOperation(
     Operation *op, ArrayRef<const dataflow::Lattice<AxisInfo> *> operands,
     ArrayRef<dataflow::Lattice<AxisInfo> *> results) {
+  // Loop-carried recurrences are solved in closed form
+  std::deque<dataflow::Lattice<AxisInfo>> recurrences;
+  SmallVector<const dataflow::Lattice<AxisInfo> *> newOperands(
+      operands.begin(), operands.end());
+  for (auto [i, operand] : llvm::enumerate(op->getOperands())) {
+    auto recurrence = getLoopRecurrenceAxisInfo(
+        operand, [&](Value value) { return getLatticeElementFor(op, value); });
+    if (!recurrence)
+      continue;
+    recurrences.emplace_back(operand);
+    recurrences.back().join(*recurrence);
+    newOperands[i] = &recurrences.back();
+  }
+  operands = newOperands;
   // TODO: For sure not the right way to do this
   // but why is scf.if not initialized otherwise?
   for (auto op : operands)
     if (op->getValue().getRank() == 0)
       setToEntryState((dataflow::Lattice<AxisInfo> *)op);
   AxisInfo curr = visitors.apply(op, operands);
-  if (curr.getRank() == 0)
-    return setAllToEntryStates(results);
-  // override with hint
+  auto valueRange = inferValueRange(op, operands);
+  if (curr.getRank() == 0) {
+    if (!valueRange)
+      return setAllToEntryStates(results);
+    curr = AxisInfo::getPessimisticValueState(op->getResult(0));
+  }
   auto newContiguity = curr.getContiguity();
   auto newDivisibility = curr.getDivisibility();
   auto newConstancy = curr.getConstancy();
+  auto newConstantValue = curr.getConstantValue();
+  // a range holding a single value makes the result a constant
+  if (valueRange && valueRange->first == valueRange->second &&
+      valueRange->first >= 0 && !newConstantValue) {
+    auto rank = curr.getRank();
+    newConstantValue = valueRange->first;
+    newContiguity = AxisInfo::DimVectorT(rank, 1);
+    newDivisibility =
+        AxisInfo::DimVectorT(rank, highestPowOf2Divisor(*newConstantValue));
+    newConstancy = AxisInfo::DimVectorT(rank, 1);
+    if (auto ty = op->getResult(0).getType().dyn_cast<RankedTensorType>())
+      newConstancy =
+          AxisInfo::DimVectorT(ty.getShape().begin(), ty.getShape().end());
+  }
+  // override with hint
   if (Attribute attr = op->getDiscardableAttr("tt.contiguity")) {
     auto vals = attr.cast<DenseElementsAttr>().getValues<int>();
     newContiguity = AxisInfo::DimVectorT(vals.begin(), vals.end());
@@ -932,12 +1294,80 @@ void AxisInfoAnalysis::visitOperation(
     newConstancy = AxisInfo::DimVectorT(vals.begin(), vals.end());
   }
   curr = mlir::AxisInfo(newContiguity, newDivisibility, newConstancy,
-                        curr.getConstantValue());
+                        newConstantValue, valueRange);
   // join all lattice elements
   for (auto *result : results)
     propagateIfChanged(result, result->join(curr));
 }
 
+std::optional<AxisInfo> AxisInfoAnalysis::getLoopRecurrenceAxisInfo(
+    Value value,
+    function_ref<const dataflow::Lattice<AxisInfo> *(Value)> getLattice) {
+  auto blockArg = value.dyn_cast<BlockArgument>();
+  if (!blockArg || blockArg.getArgNumber() == 0)
+    return {};
+  auto forOp = dyn_cast<scf::ForOp>(blockArg.getOwner()->getParentOp());
+  if (!forOp)
+    return {};
+  unsigned iterArgIdx = blockArg.getArgNumber() - 1;
+  Operation *addOp =
+      forOp.getBody()->getTerminator()->getOperand(iterArgIdx).getDefiningOp();
+  if (!addOp || !isa<triton::AddPtrOp, arith::AddIOp>(addOp))
+    return {};
+  // value + step, or step + value for additions
+  Value step;
+  if (addOp->getOperand(0) == value)
+    step = addOp->getOperand(1);
+  else if (isa<arith::AddIOp>(addOp) && addOp->getOperand(1) == value)
+    step = addOp->getOperand(0);
+  if (!step || !forOp.isDefinedOutsideOfLoop(step))
+    return {};
+  const auto *init = getLattice(forOp.getInitArgs()[iterArgIdx]);
+  const auto *stepLattice = getLattice(step);
+  if (init->getValue().getRank() == 0 ||
+      stepLattice->getValue().getRank() == 0)
+    return {};
+
+  // Every iteration only adds multiples of `step` to `init`
+  SmallVector<const dataflow::Lattice<AxisInfo> *, 2> addOperands = {
+      init, stepLattice};
+  if (addOp->getOperand(0) != value)
+    std::swap(addOperands[0], addOperands[1]);
+  AxisInfo next = visitors.apply(addOp, addOperands);
+  if (next.getRank() == 0)
+    return {};
+  AxisInfo initInfo = init->getValue();
+  AxisInfo result = AxisInfo::join(initInfo, next);
+
+  // Values are in `init + [0, n - 1] * step` when the loop bounds are
+  // constants, with `n` its trip count
+  std::optional<RangeT> valueRange;
+  auto lb = getConstantIntValue(forOp.getLowerBound());
+  auto ub = getConstantIntValue(forOp.getUpperBound());
+  auto forStep = getConstantIntValue(forOp.getStep());
+  auto initRange = initInfo.getValueRange();
+  auto stepRange = stepLattice->getValue().getValueRange();
+  if (lb && ub && forStep && *forStep > 0 && initRange && stepRange) {
+    int64_t lastIter = *ub > *lb ? (*ub - *lb - 1) / *forStep : 0;
+    auto delta =
+        applyToCorners({lastIter, lastIter}, *stepRange,
+                       [](int64_t l, int64_t r, int64_t &v) {
+                         return llvm::MulOverflow(l, r, v);
+                       });
+    RangeT last;
+    if (delta &&
+        !llvm::AddOverflow(initRange->first, std::min<int64_t>(0, delta->first),
+                           last.first) &&
+        !llvm::AddOverflow(initRange->second,
+                           std::max<int64_t>(0, delta->second), last.second) &&
+        fitsType(last, getElementTypeOrSelf(value.getType())))
+      valueRange = last;
+  }
+  return AxisInfo(result.getContiguity(), result.getDivisibility(),
+                  result.getConstancy(), result.getConstantValue(),
+                  valueRange);
+}
+
 unsigned ModuleAxisInfoAnalysis::getPtrContiguity(Value ptr) {
   auto tensorTy = ptr.getType().dyn_cast<RankedTensorType>();
   if (!tensorTy)
@@ -989,6 +1419,86 @@ unsigned ModuleAxisInfoAnalysis::getMaskAlignment(Value mask) {
   return alignment;
 }
 
+unsigned ModuleAxisInfoAnalysis::getBlockLoadAlignment(triton::BlockLoadOp op) {
+  auto resultTy = op.getType().cast<RankedTensorType>();
+  unsigned rank = resultTy.getRank();
+  unsigned contigDim = op.getOrder()[0];
+  auto getDivisibility = [&](Value value) -> int64_t {
+    auto *axisInfo = getAxisInfo(value);
+    return axisInfo ? axisInfo->getDivisibility(0) : 1;
+  };
+  // Elements are only contiguous along a dimension of unit stride
+  auto *strideInfo = getAxisInfo(op.getStrides()[contigDim]);
+  if (!strideInfo || strideInfo->getConstantValue() != 1)
+    return 1;
+  auto elemNumBits = resultTy.getElementTypeBitWidth();
+  auto elemNumBytes = std::max<unsigned>(elemNumBits / 8, 1);
+  int64_t alignment =
+      std::max<int64_t>(getDivisibility(op.getBase()) / elemNumBytes, 1);
+  alignment = std::min(alignment, getDivisibility(op.getOffsets()[contigDim]));
+  for (unsigned d = 0; d < rank; ++d)
+    if (d != contigDim)
+      alignment = std::min(alignment, getDivisibility(op.getStrides()[d]));
+  // Vectors must not straddle the bound of a checked dimension
+  if (llvm::is_contained(op.getBoundaryCheck(), int32_t(contigDim)))
+    alignment = std::min(alignment, getDivisibility(op.getShape()[contigDim]));
+  alignment = std::min(alignment, resultTy.getShape()[contigDim]);
+  return std::max<int64_t>(alignment, 1);
+}
+
+bool ModuleAxisInfoAnalysis::isAllTrueMask(Value mask) {
+  auto *axisInfo = getAxisInfo(mask);
+  return axisInfo && axisInfo->getConstantValue() == 1;
+}
+
+bool ModuleAxisInfoAnalysis::isPrefixMask(Value mask, unsigned vec) {
+  auto tensorTy = mask.getType().dyn_cast<RankedTensorType>();
+  if (!tensorTy)
+    return true;
+  unsigned dim = triton::gpu::getOrder(tensorTy.getEncoding())[0];
+  auto isContiguous = [&](Value v) {
+    auto *axisInfo = getAxisInfo(v);
+    return axisInfo && axisInfo->getContiguity(dim) % vec == 0;
+  };
+  auto isConstant = [&](Value v) {
+    auto *axisInfo = getAxisInfo(v);
+    return axisInfo && axisInfo->getConstancy(dim) % vec == 0;
+  };
+  if (isConstant(mask))
+    return true;
+  Operation *defOp = mask.getDefiningOp();
+  if (!defOp)
+    return false;
+  // A broadcast along other dimensions keeps the groups of its operand
+  if (auto broadcastOp = dyn_cast<triton::BroadcastOp>(defOp)) {
+    auto srcTy = broadcastOp.getSrc().getType().cast<RankedTensorType>();
+    return srcTy.getShape()[dim] == tensorTy.getShape()[dim] &&
+           isPrefixMask(broadcastOp.getSrc(), vec);
+  }
+  // The conjunction of prefixes is a prefix
+  if (auto andOp = dyn_cast<arith::AndIOp>(defOp))
+    return isPrefixMask(andOp.getLhs(), vec) &&
+           isPrefixMask(andOp.getRhs(), vec);
+  // Increasing offsets compared against a bound
+  if (auto cmpOp = dyn_cast<arith::CmpIOp>(defOp)) {
+    switch (cmpOp.getPredicate()) {
+    case arith::CmpIPredicate::slt:
+    case arith::CmpIPredicate::sle:
+    case arith::CmpIPredicate::ult:
+    case arith::CmpIPredicate::ule:
+      return isContiguous(cmpOp.getLhs()) && isConstant(cmpOp.getRhs());
+    case arith::CmpIPredicate::sgt:
+    case arith::CmpIPredicate::sge:
+    case arith::CmpIPredicate::ugt:
+    case arith::CmpIPredicate::uge:
+      return isConstant(cmpOp.getLhs()) && isContiguous(cmpOp.getRhs());
+    default:
+      return false;
+    }
+  }
+  return false;
+}
+
 void ModuleAxisInfoAnalysis::initialize(FunctionOpInterface funcOp) {
   std::unique_ptr<DataFlowSolver> solver = createDataFlowSolver();
   AxisInfoAnalysis *analysis = solver->load<AxisInfoAnalysis>();
@@ -997,6 +1507,9 @@ void ModuleAxisInfoAnalysis::initialize(FunctionOpInterface funcOp) {
   auto *axisInfoMap = getFuncData(funcOp);
   auto updateAxisInfoMap = [&](Value value) {
     auto axisInfo = analysis->getLatticeElement(value)->getValue();
+    if (auto recurrence = analysis->getLoopRecurrenceAxisInfo(
+            value, [&](Value v) { return analysis->getLatticeElement(v); }))
+      axisInfo = *recurrence;
     AxisInfo curAxisInfo;
     if (axisInfoMap->count(value)) {
       curAxisInfo = AxisInfo::join(axisInfo, axisInfoMap->lookup(value));
@@ -1,5 +1,6 @@
 #include "triton/Analysis/Membar.h"
 #include "triton/Analysis/Alias.h"
+#include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
@@ -9,11 +10,56 @@
 
 namespace mlir {
 
+namespace {
+
+/// Returns the mapping of the bytes of `sharedValue`, a tensor in shared
+/// memory, to the warps owning them in `layout`, if every thread accesses
+/// exactly the elements it owns there and each element is owned by a single
+/// warp.
+WarpMapping getWarpMapping(Allocation *allocation, Value sharedValue,
+                           Attribute layout) {
+  auto blockedLayout = layout.dyn_cast<triton::gpu::BlockedEncodingAttr>();
+  if (!blockedLayout)
+    return {};
+  // Views of a buffer, e.g. extract_slice, don't start at a fixed byte
+  if (allocation->getBufferIds(sharedValue).size() != 1 ||
+      allocation->getBufferId(sharedValue) == Allocation::InvalidBufferId)
+    return {};
+  WarpMapping mapping;
+  mapping.type = sharedValue.getType();
+  auto warpsPerCTA = blockedLayout.getWarpsPerCTA();
+  if (product<unsigned>(warpsPerCTA) == 1) {
+    // A single warp owns every element, whatever the tiling
+    mapping.warpTiling.push_back(1);
+    return mapping;
+  }
+  // Along each dimension, warps own tiles of sizePerThread * threadsPerWarp
+  // elements, and are numbered following `order`
+  auto sizePerThread = blockedLayout.getSizePerThread();
+  auto threadsPerWarp = blockedLayout.getThreadsPerWarp();
+  // Warps along a dimension that the tensor does not cover hold copies of
+  // the elements of other warps, which are then not ordered by warp syncs
+  auto shape = sharedValue.getType().cast<RankedTensorType>().getShape();
+  for (unsigned d = 0; d < shape.size(); ++d)
+    if (warpsPerCTA[d] > 1 &&
+        shape[d] < sizePerThread[d] * threadsPerWarp[d] * warpsPerCTA[d])
+      return {};
+  mapping.warpTiling.append(warpsPerCTA.begin(), warpsPerCTA.end());
+  for (unsigned d = 0; d < sizePerThread.size(); ++d)
+    mapping.warpTiling.push_back(sizePerThread[d] * threadsPerWarp[d]);
+  auto order = blockedLayout.getOrder();
+  mapping.warpTiling.append(order.begin(), order.end());
+  return mapping;
+}
+
+} // namespace
+
 void MembarAnalysis::run(FuncBlockInfoMapT &funcBlockInfoMap) {
   FunctionOpInterface funcOp =
       dyn_cast<FunctionOpInterface>(allocation->getOperation());
   OpBuilder builder(funcOp.getContext());
   resolve(funcOp, &funcBlockInfoMap, &builder);
+  removeRedundantBarriers(funcOp);
 }
 
 void MembarAnalysis::resolve(FunctionOpInterface funcOp,
@@ -77,6 +123,108 @@ void MembarAnalysis::resolve(FunctionOpInterface funcOp,
   });
 }
 
+bool MembarAnalysis::accessesSharedMemory(Operation *op) const {
+  if (isa<triton::gpu::ExtractSliceOp>(op) ||
+      isa<triton::gpu::AllocTensorOp>(op) || isa<triton::TransOp>(op) ||
+      op->hasTrait<OpTrait::IsTerminator>())
+    return false;
+  // Async copies land in shared memory when waited for, and callees may
+  // access shared memory after their last barrier
+  if (isa<triton::gpu::AsyncWaitOp>(op) || isa<triton::CallOp>(op))
+    return true;
+  auto result = op->walk([&](Operation *nestedOp) {
+    if (nestedOp->hasTrait<OpTrait::IsTerminator>())
+      return WalkResult::advance();
+    if (allocation->getBufferId(nestedOp) != Allocation::InvalidBufferId)
+      return WalkResult::interrupt();
+    for (Value value : nestedOp->getOperands())
+      if (!allocation->getBufferIds(value).empty())
+        return WalkResult::interrupt();
+    for (Value value : nestedOp->getResults())
+      if (allocation->getBufferId(value) != Allocation::InvalidBufferId)
+        return WalkResult::interrupt();
+    return WalkResult::advance();
+  });
+  return result.wasInterrupted();
+}
+
+bool MembarAnalysis::accessesGlobalMemory(Operation *op) const {
+  // Global accesses, in particular atomics, may be ordered by barriers that
+  // the analysis can't see the need for
+  auto result = op->walk([&](Operation *nestedOp) {
+    if (isa<triton::LoadOp, triton::StoreOp, triton::AtomicRMWOp,
+            triton::AtomicCASOp, triton::CallOp>(nestedOp))
+      return WalkResult::interrupt();
+    return WalkResult::advance();
+  });
+  return result.wasInterrupted();
+}
+
+void MembarAnalysis::insertBarrier(OpBuilder *builder, Location loc) {
+  auto barrierOp = builder->create<gpu::BarrierOp>(loc);
+  barrierOp->setAttr(getInsertedBarrierAttrName(), builder->getUnitAttr());
+}
+
+void MembarAnalysis::removeRedundantBarriers(FunctionOpInterface funcOp) {
+  // Whether every path to a program point went through a barrier (resp. a
+  // barrier or a warp sync) after its last memory access
+  struct SyncState {
+    bool synced = true;
+    bool warpSynced = true;
+
+    bool operator==(const SyncState &other) const {
+      return synced == other.synced && warpSynced == other.warpSynced;
+    }
+  };
+
+  // Runs the block from `state`, erasing barriers the state makes redundant
+  // if `erase` is set, and returns the state at its end.
+  auto visitBlock = [&](Block *block, SyncState state, bool erase) {
+    for (auto &op : llvm::make_early_inc_range(block->getOperations())) {
+      bool redundant = false;
+      if (isa<gpu::BarrierOp>(&op)) {
+        redundant = state.synced && op.hasAttr(getInsertedBarrierAttrName());
+        state.synced = state.warpSynced = true;
+      } else if (isa<triton::gpu::WarpSyncOp>(&op)) {
+        redundant = state.warpSynced;
+        state.warpSynced = true;
+      } else if (accessesSharedMemory(&op) || accessesGlobalMemory(&op)) {
+        state.synced = state.warpSynced = false;
+      }
+      if (redundant && erase)
+        op.erase();
+    }
+    return state;
+  };
+
+  // A forward must-analysis: states start optimistic and only decrease
+  DenseMap<Block *, SyncState> inputStateMap;
+  std::deque<Block *> blockList;
+  for (auto &block : funcOp.getFunctionBody()) {
+    inputStateMap[&block] = SyncState();
+    blockList.emplace_back(&block);
+  }
+  // Shared memory may be accessed before the function starts, e.g. in callers
+  inputStateMap[&funcOp.getFunctionBody().front()] = {false, false};
+  while (!blockList.empty()) {
+    auto *block = blockList.front();
+    blockList.pop_front();
+    auto outputState = visitBlock(block, inputStateMap[block], false);
+    for (auto *successor : block->getSuccessors()) {
+      auto &inputState = inputStateMap[successor];
+      SyncState joined{inputState.synced && outputState.synced,
+                       inputState.warpSynced && outputState.warpSynced};
+      if (joined == inputState)
+        continue;
+      inputState = joined;
+      blockList.emplace_back(successor);
+    }
+  }
+
+  for (auto &block : funcOp.getFunctionBody())
+    visitBlock(&block, inputStateMap[&block], true);
+}
+
 void MembarAnalysis::visitTerminator(Operation *op,
                                      SmallVector<Block *> &successors) {
   if (auto branchInterface = dyn_cast<BranchOpInterface>(op)) {
@@ -109,6 +257,18 @@ void MembarAnalysis::update(Operation *op, BlockInfo *blockInfo,
     return;
   }
 
+  if (isa<triton::gpu::WarpSyncOp>(op)) {
+    blockInfo->warpSync();
+    return;
+  }
+
+  if (isa<triton::gpu::AsyncWaitOp>(op) &&
+      isa<triton::gpu::AsyncWaitOp>(op->getNextNode())) {
+    // The barrier after the last of consecutive waits makes the copies
+    // waited for by all of them visible
+    return;
+  }
+
   if (isa<triton::gpu::AsyncWaitOp>(op) &&
       !isa<gpu::BarrierOp>(op->getNextNode())) {
     // If the current op is an async wait and the next op is not a barrier we
@@ -116,7 +276,7 @@ void MembarAnalysis::update(Operation *op, BlockInfo *blockInfo,
     blockInfo->sync();
     OpBuilder::InsertionGuard g(*builder);
     builder->setInsertionPointAfter(op);
-    builder->create<gpu::BarrierOp>(op->getLoc());
+    insertBarrier(builder, op->getLoc());
     blockInfo->sync();
     return;
   }
@@ -131,6 +291,7 @@ void MembarAnalysis::update(Operation *op, BlockInfo *blockInfo,
     }
   } else {
     // Intra-function dependencies
+    auto cvtOp = dyn_cast<triton::gpu::ConvertLayoutOp>(op);
     for (Value value : op->getOperands()) {
       for (auto bufferId : allocation->getBufferIds(value)) {
         if (bufferId != Allocation::InvalidBufferId) {
@@ -138,12 +299,17 @@ void MembarAnalysis::update(Operation *op, BlockInfo *blockInfo,
               isa<tensor::InsertSliceOp>(op)) {
             // FIXME(Keren): insert_slice and insert_slice_async are always
             // alias for now
-            curBlockInfo.syncWriteIntervals.insert(
+            curBlockInfo.syncWriteAccesses.insert(
                 allocation->getAllocatedInterval(bufferId));
           } else {
             // ConvertLayoutOp: shared memory -> registers
-            curBlockInfo.syncReadIntervals.insert(
-                allocation->getAllocatedInterval(bufferId));
+            WarpMapping mapping;
+            if (cvtOp)
+              mapping = getWarpMapping(
+                  allocation, value,
+                  cvtOp.getType().cast<RankedTensorType>().getEncoding());
+            curBlockInfo.syncReadAccesses.insert(SharedAccess(
+                allocation->getAllocatedInterval(bufferId), mapping));
           }
         }
       }
@@ -152,25 +318,37 @@ void MembarAnalysis::update(Operation *op, BlockInfo *blockInfo,
       // ConvertLayoutOp: registers -> shared memory
       auto bufferId = allocation->getBufferId(value);
       if (bufferId != Allocation::InvalidBufferId) {
-        curBlockInfo.syncWriteIntervals.insert(
-            allocation->getAllocatedInterval(bufferId));
+        WarpMapping mapping;
+        if (cvtOp)
+          mapping = getWarpMapping(
+              allocation, value,
+              cvtOp.getSrc().getType().cast<RankedTensorType>().getEncoding());
+        curBlockInfo.syncWriteAccesses.insert(SharedAccess(
+            allocation->getAllocatedInterval(bufferId), mapping));
       }
     }
     // Scratch buffer is considered as both shared memory write & read
     auto bufferId = allocation->getBufferId(op);
     if (bufferId != Allocation::InvalidBufferId) {
-      curBlockInfo.syncWriteIntervals.insert(
+      curBlockInfo.syncWriteAccesses.insert(
           allocation->getAllocatedInterval(bufferId));
-      curBlockInfo.syncReadIntervals.insert(
+      curBlockInfo.syncReadAccesses.insert(
           allocation->getAllocatedInterval(bufferId));
     }
   }
 
-  if (blockInfo->isIntersected(curBlockInfo)) {
+  auto hazard = blockInfo->getHazard(curBlockInfo);
+  if (hazard == BlockInfo::Hazard::CTA) {
     OpBuilder::InsertionGuard g(*builder);
     builder->setInsertionPoint(op);
-    builder->create<gpu::BarrierOp>(op->getLoc());
+    insertBarrier(builder, op->getLoc());
     blockInfo->sync();
+  } else if (hazard == BlockInfo::Hazard::Warp) {
+    // Every byte involved is accessed by the same warps before and after
+    OpBuilder::InsertionGuard g(*builder);
+    builder->setInsertionPoint(op);
+    builder->create<triton::gpu::WarpSyncOp>(op->getLoc());
+    blockInfo->warpSync();
   }
   // Update the region info, even if barrier is inserted, we have to maintain
   // the current op's read/write buffers.
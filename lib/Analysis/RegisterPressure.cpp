@@ -0,0 +1,170 @@
+#include "triton/Analysis/RegisterPressure.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <algorithm>
+
+namespace mlir {
+
+unsigned RegisterPressureAnalysis::getRegisterBudget(int numWarps,
+                                                     int threadsPerWarp) {
+  unsigned numThreads = std::max(numWarps * threadsPerWarp, 1);
+  return std::min(kMaxRegistersPerThread, kRegistersPerSM / numThreads);
+}
+
+unsigned RegisterPressureAnalysis::getRegisterBudget(ModuleOp moduleOp) {
+  using triton::gpu::TritonGPUDialect;
+  if (!moduleOp->hasAttr(TritonGPUDialect::getNumWarpsAttrName()))
+    return kMaxRegistersPerThread;
+  // Every warp group has `num-warps` warps
+  return getRegisterBudget(TritonGPUDialect::getNumWarps(moduleOp) *
+                               TritonGPUDialect::getNumWarpGroups(moduleOp),
+                           TritonGPUDialect::getThreadsPerWarp(moduleOp));
+}
+
+static unsigned getBitWidth(Type type) {
+  if (type.isa<triton::PointerType>())
+    return 64;
+  // Indices are lowered to i32
+  if (type.isIndex())
+    return 32;
+  // Sub-byte elements are not packed
+  if (type.isIntOrFloat())
+    return std::max(type.getIntOrFloatBitWidth(), 8u);
+  return 0;
+}
+
+unsigned RegisterPressureAnalysis::getNumRegisters(Type type,
+                                                   const AxisInfo *axisInfo) {
+  auto tensorTy = type.dyn_cast<RankedTensorType>();
+  if (!tensorTy)
+    return llvm::divideCeil(getBitWidth(type), 32);
+  Attribute encoding = tensorTy.getEncoding();
+  if (!encoding || encoding.isa<triton::gpu::SharedEncodingAttr>() ||
+      triton::gpu::isMmaV3DotOperand(encoding))
+    return 0;
+  Type elemTy = tensorTy.getElementType();
+  unsigned numElems = triton::gpu::getTotalElemsPerThread(type);
+  auto blockedLayout = encoding.dyn_cast<triton::gpu::BlockedEncodingAttr>();
+  if (axisInfo && blockedLayout && axisInfo->getRank() == tensorTy.getRank()) {
+    // Count the distinct elements of the thread: along each dimension, its
+    // elements come in chunks of `sizePerThread`, repeated every `coverage`
+    // elements, and equal elements are held once
+    auto sizePerThread = blockedLayout.getSizePerThread();
+    auto threadsPerWarp = blockedLayout.getThreadsPerWarp();
+    auto warpsPerCTA = blockedLayout.getWarpsPerCTA();
+    auto elemsPerThread = triton::gpu::getElemsPerThread(type);
+    unsigned fastestDim = blockedLayout.getOrder()[0];
+    auto ptrTy = elemTy.dyn_cast<triton::PointerType>();
+    numElems = 1;
+    for (unsigned d = 0; d < sizePerThread.size(); ++d) {
+      int64_t numSame = std::max<int64_t>(axisInfo->getConstancy(d), 1);
+      if (d == fastestDim && ptrTy && ptrTy.getPointeeType().isIntOrFloat()) {
+        // A vector access of up to 128 bits only uses its first pointer
+        int64_t maxVec = std::max<int64_t>(
+            128 / ptrTy.getPointeeType().getIntOrFloatBitWidth(), 1);
+        numSame =
+            std::max(numSame, std::min(axisInfo->getContiguity(d), maxVec));
+      }
+      int64_t coverage = sizePerThread[d] * threadsPerWarp[d] * warpsPerCTA[d];
+      int64_t numRepeats = elemsPerThread[d] / sizePerThread[d];
+      if (numSame >= coverage)
+        numElems *= llvm::divideCeil(numRepeats * coverage, numSame);
+      else
+        numElems *= elemsPerThread[d] /
+                    std::min<int64_t>(numSame, sizePerThread[d]);
+    }
+  }
+  return llvm::divideCeil(numElems * getBitWidth(elemTy), 32);
+}
+
+unsigned RegisterPressureAnalysis::getLiveRegisters(Value value) const {
+  if (value.use_empty())
+    return 0;
+  if (auto constOp = value.getDefiningOp<arith::ConstantOp>()) {
+    auto denseAttr = constOp.getValue().dyn_cast<DenseElementsAttr>();
+    if (!denseAttr || denseAttr.isSplat())
+      return 0;
+  }
+  AxisInfo *axisInfo =
+      axisInfoAnalysis ? axisInfoAnalysis->getAxisInfo(value) : nullptr;
+  return getNumRegisters(value.getType(), axisInfo);
+}
+
+RegisterPressureAnalysis::RegisterPressureAnalysis(
+    Operation *op, ModuleAxisInfoAnalysis *axisInfoAnalysis)
+    : axisInfoAnalysis(axisInfoAnalysis) {
+  for (Region &region : op->getRegions())
+    for (Block &block : region)
+      maxPressure = std::max(maxPressure, visitBlock(&block, 0));
+}
+
+unsigned RegisterPressureAnalysis::visitBlock(Block *block,
+                                              unsigned liveAround) {
+  unsigned numOps = block->getOperations().size();
+  // Registers of the values whose last use is the i-th op, and of those that
+  // are used in the regions of that op rather than only as its operands. The
+  // last entry holds the values used in other blocks, live until the end.
+  SmallVector<unsigned> dying(numOps + 1, 0);
+  SmallVector<unsigned> captured(numOps + 1, 0);
+  DenseMap<Operation *, unsigned> opIndex;
+  for (auto en : llvm::enumerate(*block))
+    opIndex[&en.value()] = en.index();
+
+  auto addValue = [&](Value value) -> unsigned {
+    unsigned regs = getLiveRegisters(value);
+    if (regs == 0)
+      return 0;
+    unsigned lastUse = 0;
+    bool isCaptured = false;
+    for (OpOperand &use : value.getUses()) {
+      Operation *owner = use.getOwner();
+      Operation *ancestor = block->findAncestorOpInBlock(*owner);
+      unsigned index = ancestor ? opIndex[ancestor] : numOps;
+      if (index > lastUse) {
+        lastUse = index;
+        isCaptured = false;
+      }
+      if (index == lastUse && ancestor != owner)
+        isCaptured = true;
+    }
+    dying[lastUse] += regs;
+    if (isCaptured)
+      captured[lastUse] += regs;
+    return regs;
+  };
+
+  unsigned live = 0;
+  for (BlockArgument arg : block->getArguments())
+    live += addValue(arg);
+  unsigned peak = live;
+  for (auto en : llvm::enumerate(*block)) {
+    Operation &op = en.value();
+    unsigned index = en.index();
+    unsigned results = 0;
+    for (Value result : op.getResults())
+      results += addValue(result);
+    unsigned after = live - dying[index] + results;
+    unsigned pressure = std::max(live, after);
+    if (op.getNumRegions() > 0) {
+      // Operands only forwarded to the regions, e.g. loop inits, are
+      // accounted for by the region arguments
+      unsigned around = live - (dying[index] - captured[index]);
+      unsigned inner = 0;
+      for (Region &region : op.getRegions())
+        for (Block &nested : region)
+          inner = std::max(inner, visitBlock(&nested, liveAround + around));
+      pressure = std::max(pressure, around + inner);
+    }
+    opPressure[&op] = liveAround + pressure;
+    peak = std::max(peak, pressure);
+    live = after;
+  }
+  return peak;
+}
+
+} // namespace mlir
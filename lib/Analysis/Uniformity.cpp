@@ -0,0 +1,85 @@
+#include "triton/Analysis/Uniformity.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+
+#include <algorithm>
+
+namespace mlir {
+
+StringRef stringifyUniformity(Uniformity uniformity) {
+  switch (uniformity) {
+  case Uniformity::None:
+    return "none";
+  case Uniformity::Thread:
+    return "thread";
+  case Uniformity::Warp:
+    return "warp";
+  case Uniformity::CTA:
+    return "cta";
+  }
+  llvm_unreachable("Unknown uniformity");
+}
+
+Uniformity UniformityAnalysis::getUniformity(Type type,
+                                             const AxisInfo &axisInfo) {
+  auto tensorTy = type.dyn_cast<RankedTensorType>();
+  if (!tensorTy)
+    return Uniformity::CTA;
+  auto shape = tensorTy.getShape();
+  unsigned rank = shape.size();
+  if (axisInfo.getRank() != rank)
+    return Uniformity::None;
+  bool uniformPerCTA = true;
+  for (unsigned d = 0; d < rank; ++d)
+    uniformPerCTA &= axisInfo.getConstancy(d) >= shape[d];
+  if (uniformPerCTA)
+    return Uniformity::CTA;
+  Attribute encoding = tensorTy.getEncoding();
+  auto blockedLayout =
+      encoding.dyn_cast_or_null<triton::gpu::BlockedEncodingAttr>();
+  if (!blockedLayout)
+    return Uniformity::None;
+  auto sizePerThread = blockedLayout.getSizePerThread();
+  auto threadsPerWarp = blockedLayout.getThreadsPerWarp();
+  auto warpsPerCTA = blockedLayout.getWarpsPerCTA();
+  bool uniformPerThread = true;
+  bool uniformPerWarp = true;
+  for (unsigned d = 0; d < rank; ++d) {
+    int64_t coverage = sizePerThread[d] * threadsPerWarp[d] * warpsPerCTA[d];
+    // A layout repeated along the dimension spreads the elements of a thread
+    // over all of it
+    int64_t threadSpan = shape[d] > coverage ? shape[d] : sizePerThread[d];
+    int64_t warpSpan =
+        shape[d] > coverage ? shape[d] : sizePerThread[d] * threadsPerWarp[d];
+    int64_t constancy = axisInfo.getConstancy(d);
+    uniformPerThread &= constancy >= std::min(threadSpan, shape[d]);
+    uniformPerWarp &= constancy >= std::min(warpSpan, shape[d]);
+  }
+  if (uniformPerWarp)
+    return Uniformity::Warp;
+  if (uniformPerThread)
+    return Uniformity::Thread;
+  return Uniformity::None;
+}
+
+Uniformity UniformityAnalysis::getUniformity(Value value) const {
+  auto it = uniformity.find(value);
+  if (it != uniformity.end())
+    return it->second;
+  Uniformity result = Uniformity::None;
+  if (AxisInfo *axisInfo = axisInfoAnalysis.getAxisInfo(value))
+    result = getUniformity(value.getType(), *axisInfo);
+  Operation *op = value.getDefiningOp();
+  if (result != Uniformity::CTA && op && op->getNumOperands() > 0 &&
+      op->hasTrait<OpTrait::Elementwise>() && isMemoryEffectFree(op)) {
+    Uniformity operands = Uniformity::CTA;
+    for (Value operand : op->getOperands())
+      operands = std::min(operands, getUniformity(operand));
+    result = std::max(result, operands);
+  }
+  uniformity[value] = result;
+  return result;
+}
+
+} // namespace mlir
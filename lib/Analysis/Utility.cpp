@@ -7,6 +7,7 @@
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Tools/Sys/GetEnv.hpp"
 #include <deque>
+#include <map>
 
 namespace mlir {
 
@@ -27,6 +28,61 @@ SmallVector<unsigned> getParentOrder(Attribute layout) {
   return triton::gpu::getOrder(layout);
 }
 
+SmallVector<unsigned> delinearize(unsigned linear, ArrayRef<unsigned> shape,
+                                  ArrayRef<unsigned> order) {
+  SmallVector<unsigned> multiDim(shape.size());
+  for (unsigned d : order) {
+    multiDim[d] = linear % shape[d];
+    linear /= shape[d];
+  }
+  return multiDim;
+}
+
+// Offsets of the elements held by a thread of `layout` from its first one,
+// in the order of its registers
+SmallVector<SmallVector<unsigned>>
+getBlockedRegOffsets(triton::gpu::BlockedEncodingAttr layout,
+                     ArrayRef<int64_t> shape) {
+  auto sizePerThread = layout.getSizePerThread();
+  auto order = layout.getOrder();
+  auto shapePerCTA = triton::gpu::getShapePerCTA(layout);
+  unsigned rank = shape.size();
+  SmallVector<unsigned> tilesPerDim(rank);
+  for (unsigned k = 0; k < rank; ++k)
+    tilesPerDim[k] = ceil<unsigned>(shape[k], shapePerCTA[k]);
+  unsigned totalSizePerThread = product<unsigned>(sizePerThread);
+  unsigned numRegs = product<unsigned>(tilesPerDim) * totalSizePerThread;
+  SmallVector<SmallVector<unsigned>> offsets(numRegs);
+  for (unsigned n = 0; n < numRegs; ++n) {
+    auto tileId = delinearize(n / totalSizePerThread, tilesPerDim, order);
+    auto elemId = delinearize(n % totalSizePerThread, sizePerThread, order);
+    for (unsigned k = 0; k < rank; ++k)
+      offsets[n].push_back(tileId[k] * shapePerCTA[k] + elemId[k]);
+  }
+  return offsets;
+}
+
+// Coordinates of the first element held by `lane` of `warp` in `layout`,
+// wrapped around like emitBaseIndexForBlockedLayout does
+SmallVector<unsigned> getBlockedThreadBase(
+    triton::gpu::BlockedEncodingAttr layout, ArrayRef<int64_t> shape,
+    unsigned warp, unsigned lane) {
+  auto sizePerThread = layout.getSizePerThread();
+  auto threadsPerWarp = layout.getThreadsPerWarp();
+  auto order = layout.getOrder();
+  auto warpId = delinearize(warp, layout.getWarpsPerCTA(), order);
+  auto laneId = delinearize(lane, threadsPerWarp, order);
+  SmallVector<unsigned> base(shape.size());
+  for (unsigned k = 0; k < shape.size(); ++k) {
+    unsigned maxWarps =
+        ceil<unsigned>(shape[k], sizePerThread[k] * threadsPerWarp[k]);
+    unsigned maxThreads = ceil<unsigned>(shape[k], sizePerThread[k]);
+    base[k] = sizePerThread[k] * (laneId[k] % maxThreads +
+                                  warpId[k] % maxWarps * threadsPerWarp[k]);
+  }
+  return base;
+}
+
 } // namespace
 
 bool ReduceOpHelper::isFastReduction() {
@@ -82,37 +138,38 @@ SmallVector<unsigned> ReduceOpHelper::getScratchConfigBasic() {
 }
 
 bool ReduceOpHelper::isWarpSynchronous() {
-  auto argsLayout = getSrcLayout();
-  return isFastReduction() &&
-         (triton::gpu::getWarpsPerCTA(argsLayout)[axis] == 1);
+  if (::triton::tools::getBoolEnv("DISABLE_FAST_REDUCTION"))
+    return false;
+  // The lanes of a blocked layout along any axis are a fixed stride apart,
+  // other layouts are only shuffled along their fastest axis
+  auto srcLayout = getSrcLayout();
+  if (!isFastReduction() && !srcLayout.isa<triton::gpu::BlockedEncodingAttr>())
+    return false;
+  return triton::gpu::getWarpsPerCTAWithUniqueData(srcLayout,
+                                                   getSrcShape())[axis] == 1;
 }
 
 SmallVector<SmallVector<unsigned>> ReduceOpHelper::getScratchConfigsFast() {
-  SmallVector<SmallVector<unsigned>> smemShapes(3);
-
-  auto argLayout = getSrcLayout();
-  auto argLayoutMma = argLayout.dyn_cast<triton::gpu::MmaEncodingAttr>();
+  SmallVector<SmallVector<unsigned>> smemShapes(1);
 
   // that case doesn't need inter-warp communication
   if (isWarpSynchronous())
-    return {{0, 0}, {0, 0}};
+    return {{0, 0}};
 
   /// shared memory block0
   smemShapes[0] = convertType<unsigned>(getSrcShape());
   smemShapes[0][axis] = getInterWarpSize();
 
-  /// FIXME(Qingyi): This size is actually larger than required.
-  /// shared memory block1:
-  auto mod = op->getParentOfType<ModuleOp>();
-  unsigned numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
-  unsigned threadsPerWarp =
-      triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
-  smemShapes[1].push_back(numWarps * threadsPerWarp);
-
+  // The inter-warp round reads the partial results back in place, and
+  // threads past the last of them read element 0, so no second block of
+  // numWarps * threadsPerWarp elements is needed.
   return smemShapes;
 }
 
 unsigned ReduceOpHelper::getScratchSizeInBytes() {
+  if (isWarpSynchronous())
+    return 0;
+
   unsigned elems = 0;
   if (isFastReduction()) {
     auto smemShapes = getScratchConfigsFast();
@@ -136,7 +193,7 @@ bool ReduceOpHelper::isSupportedLayout() {
     return true;
   }
   if (auto mmaLayout = srcLayout.dyn_cast<triton::gpu::MmaEncodingAttr>()) {
-    if (mmaLayout.isAmpere()) {
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
       return true;
     }
   }
@@ -146,6 +203,33 @@ bool ReduceOpHelper::isSupportedLayout() {
   return false;
 }
 
+ScanLoweringHelper::ScanLoweringHelper(triton::ScanOp op) : scanOp(op) {
+  auto type = scanOp.getOperand(0).getType().cast<RankedTensorType>();
+  srcEncoding = type.getEncoding();
+  shape = SmallVector<int64_t>(type.getShape().begin(), type.getShape().end());
+  axis = scanOp.getAxis();
+  encoding = srcEncoding.dyn_cast<triton::gpu::BlockedEncodingAttr>();
+  auto sliceLayout = srcEncoding.dyn_cast<triton::gpu::SliceEncodingAttr>();
+  if (!sliceLayout)
+    return;
+  auto parent =
+      sliceLayout.getParent().dyn_cast<triton::gpu::BlockedEncodingAttr>();
+  if (!parent)
+    return;
+  // The elements of a slice are those of its parent layout for a tensor with
+  // a single element along the sliced dimension, in the same order.
+  unsigned dim = sliceLayout.getDim();
+  SmallVector<unsigned> sizePerThread(parent.getSizePerThread().begin(),
+                                      parent.getSizePerThread().end());
+  sizePerThread[dim] = 1;
+  encoding = triton::gpu::BlockedEncodingAttr::get(
+      op.getContext(), sizePerThread, parent.getThreadsPerWarp(),
+      parent.getWarpsPerCTA(), parent.getOrder());
+  shape.insert(shape.begin() + dim, 1);
+  if (axis >= dim)
+    ++axis;
+}
+
 unsigned ScanLoweringHelper::getAxisNumElementsPerThread() {
   return getEncoding().getSizePerThread()[getAxis()];
 }
@@ -177,43 +261,38 @@ unsigned ScanLoweringHelper::getNonAxisNumThreadsPerCTA() {
   return numParallelThreadsPerWarp * numParallelWarpsPerCTA;
 }
 unsigned ScanLoweringHelper::getAxisNumWarps() {
-  auto warpsPerCTA = triton::gpu::getWarpsPerCTA(srcEncoding);
-  return warpsPerCTA[getAxis()];
+  return getEncoding().getWarpsPerCTA()[getAxis()];
 }
 
 unsigned ScanLoweringHelper::getAxisNumBlocks() {
-  auto type = scanOp.getOperand(0).getType().cast<RankedTensorType>();
-  auto sizePerThreads = triton::gpu::getSizePerThread(srcEncoding);
-  auto threadsPerWarp = triton::gpu::getThreadsPerWarp(srcEncoding);
-  auto warpsPerCTA = triton::gpu::getWarpsPerCTA(srcEncoding);
+  auto sizePerThreads = triton::gpu::getSizePerThread(getEncoding());
+  auto threadsPerWarp = triton::gpu::getThreadsPerWarp(getEncoding());
+  auto warpsPerCTA = triton::gpu::getWarpsPerCTA(getEncoding());
   unsigned axis = getAxis();
   return ceil<unsigned>(
-      type.getShape()[axis],
+      getShape()[axis],
       (sizePerThreads[axis] * threadsPerWarp[axis] * warpsPerCTA[axis]));
 }
 
 unsigned ScanLoweringHelper::getNonAxisNumBlocks() {
-  auto type = scanOp.getOperand(0).getType().cast<RankedTensorType>();
-  auto sizePerThreads = triton::gpu::getSizePerThread(srcEncoding);
-  auto threadsPerWarp = triton::gpu::getThreadsPerWarp(srcEncoding);
-  auto warpsPerCTA = triton::gpu::getWarpsPerCTA(srcEncoding);
+  auto sizePerThreads = triton::gpu::getSizePerThread(getEncoding());
+  auto threadsPerWarp = triton::gpu::getThreadsPerWarp(getEncoding());
+  auto warpsPerCTA = triton::gpu::getWarpsPerCTA(getEncoding());
   unsigned axis = getAxis();
   unsigned numBlocks = 1;
   for (unsigned i = 0; i < sizePerThreads.size(); i++) {
     if (i == axis)
       continue;
     numBlocks *= ceil<unsigned>(
-        type.getShape()[i],
+        getShape()[i],
         (sizePerThreads[i] * threadsPerWarp[i] * warpsPerCTA[i]));
   }
   return numBlocks;
 }
 
 bool ScanLoweringHelper::isSupported() {
-  // TODO: Support the following cases:
-  // 1. Scan on non-blocking encodings
-  // 2. Scan with multiple operands
-  if (!isa<triton::gpu::BlockedEncodingAttr>(srcEncoding))
+  // TODO: Support scan with multiple operands and on mma layouts.
+  if (!encoding)
     return false;
   if (scanOp.getNumOperands() != 1)
     return false;
@@ -221,6 +300,8 @@ bool ScanLoweringHelper::isSupported() {
 }
 
 unsigned ScanLoweringHelper::getScratchSizeInBytes() {
+  if (getAxisNumWarps() == 1)
+    return 0;
   auto type = scanOp.getOperand(0).getType().cast<RankedTensorType>();
   unsigned elementSizeInBytes = type.getElementTypeBitWidth() / 8;
   auto mod = scanOp->getParentOfType<ModuleOp>();
@@ -233,11 +314,11 @@ unsigned ScanLoweringHelper::getScratchSizeInBytes() {
 }
 
 triton::gpu::BlockedEncodingAttr ScanLoweringHelper::getEncoding() {
-  return srcEncoding.cast<triton::gpu::BlockedEncodingAttr>();
+  return encoding;
 }
 
 unsigned ScanLoweringHelper::getAxisElementStride() {
-  auto order = triton::gpu::getOrder(srcEncoding);
+  auto order = triton::gpu::getOrder(getEncoding());
   unsigned stride = 1;
   for (unsigned dim : order) {
     if (dim == getAxis())
@@ -248,7 +329,7 @@ unsigned ScanLoweringHelper::getAxisElementStride() {
 }
 
 unsigned ScanLoweringHelper::getAxisThreadStride() {
-  auto order = triton::gpu::getOrder(srcEncoding);
+  auto order = triton::gpu::getOrder(getEncoding());
   unsigned stride = 1;
   for (unsigned dim : order) {
     if (dim == getAxis())
@@ -259,17 +340,17 @@ unsigned ScanLoweringHelper::getAxisThreadStride() {
 }
 
 unsigned ScanLoweringHelper::getAxisBlockStride() {
-  auto order = triton::gpu::getOrder(srcEncoding);
+  auto order = triton::gpu::getOrder(getEncoding());
   unsigned stride = 1;
-  auto type = scanOp.getOperand(0).getType().cast<RankedTensorType>();
-  auto sizePerThreads = triton::gpu::getSizePerThread(srcEncoding);
-  auto threadsPerWarp = triton::gpu::getThreadsPerWarp(srcEncoding);
-  auto warpsPerCTA = triton::gpu::getWarpsPerCTA(srcEncoding);
+  auto sizePerThreads = triton::gpu::getSizePerThread(getEncoding());
+  auto threadsPerWarp = triton::gpu::getThreadsPerWarp(getEncoding());
+  auto warpsPerCTA = triton::gpu::getWarpsPerCTA(getEncoding());
   for (unsigned dim : order) {
     if (dim == getAxis())
       return stride;
-    stride *= type.getShape()[dim] /
-              (sizePerThreads[dim] * threadsPerWarp[dim] * warpsPerCTA[dim]);
+    stride *= ceil<unsigned>(
+        getShape()[dim],
+        sizePerThreads[dim] * threadsPerWarp[dim] * warpsPerCTA[dim]);
   }
   llvm_unreachable("Axis not found in order");
 }
@@ -309,12 +390,19 @@ bool supportMMA(Value value, int version) {
   // Tell whether a DotOp support HMMA by the operand type(either $a or $b).
   // We cannot get both the operand types(in TypeConverter), here we assume the
   // types of both the operands are identical here.
-  assert((version == 1 || version == 2) &&
+  assert((version == 1 || version == 2 || version == 3) &&
          "Unexpected MMA layout version found");
   auto elemTy = value.getType().cast<RankedTensorType>().getElementType();
+  // int8 wgmma is not lowered yet. fp8 tensor cores need sm_89, which the
+  // frontend checks before emitting fp8 dots.
   return elemTy.isF16() || elemTy.isBF16() ||
          (elemTy.isF32() && version >= 2) ||
-         (elemTy.isInteger(8) && version >= 2);
+         (elemTy.isInteger(8) && version == 2) ||
+         (isNativeFp8(elemTy) && version >= 2);
+}
+
+bool isNativeFp8(Type type) {
+  return type.isa<mlir::Float8E4M3FNUZType, mlir::Float8E5M2Type>();
 }
 
 Type getElementType(Value value) {
@@ -338,6 +426,85 @@ bool isMmaToDotShortcut(RankedTensorType &srcTy, RankedTensorType &dstTy) {
          !srcTy.getElementType().isF32();
 }
 
+std::optional<SmallVector<unsigned>>
+getWarpShuffleCvtSrcRegs(RankedTensorType srcTy, RankedTensorType dstTy,
+                         bool *sameLane) {
+  auto srcLayout =
+      srcTy.getEncoding().dyn_cast<triton::gpu::BlockedEncodingAttr>();
+  auto dstLayout =
+      dstTy.getEncoding().dyn_cast<triton::gpu::BlockedEncodingAttr>();
+  if (!srcLayout || !dstLayout || srcLayout == dstLayout)
+    return std::nullopt;
+  unsigned numWarps = product<unsigned>(srcLayout.getWarpsPerCTA());
+  if (numWarps != product<unsigned>(dstLayout.getWarpsPerCTA()))
+    return std::nullopt;
+  auto shape = srcTy.getShape();
+  auto srcSizePerThread = srcLayout.getSizePerThread();
+  auto srcThreadsPerWarp = srcLayout.getThreadsPerWarp();
+  auto srcOrder = srcLayout.getOrder();
+  auto srcOffsets = getBlockedRegOffsets(srcLayout, shape);
+  auto dstOffsets = getBlockedRegOffsets(dstLayout, shape);
+  std::map<SmallVector<unsigned>, unsigned> srcRegOfOffset;
+  for (auto it : llvm::enumerate(srcOffsets))
+    srcRegOfOffset[it.value()] = it.index();
+
+  unsigned rank = shape.size();
+  unsigned warpSize = product<unsigned>(srcThreadsPerWarp);
+  SmallVector<std::optional<unsigned>> srcRegs(dstOffsets.size());
+  bool isSameLane = true;
+  for (unsigned warp = 0; warp < numWarps; ++warp)
+    for (unsigned lane = 0; lane < warpSize; ++lane) {
+      auto dstBase = getBlockedThreadBase(dstLayout, shape, warp, lane);
+      for (unsigned reg = 0; reg < dstOffsets.size(); ++reg) {
+        // Lane of the first source thread holding the element
+        unsigned srcLane = 0;
+        SmallVector<unsigned> coord(rank);
+        SmallVector<unsigned> srcLaneId(rank);
+        for (unsigned k = 0; k < rank; ++k) {
+          coord[k] = dstBase[k] + dstOffsets[reg][k];
+          srcLaneId[k] =
+              coord[k] / srcSizePerThread[k] % srcThreadsPerWarp[k];
+        }
+        for (unsigned d : llvm::reverse(srcOrder))
+          srcLane = srcLane * srcThreadsPerWarp[d] + srcLaneId[d];
+        isSameLane &= srcLane == lane;
+        auto srcBase = getBlockedThreadBase(srcLayout, shape, warp, srcLane);
+        SmallVector<unsigned> offset(rank);
+        for (unsigned k = 0; k < rank; ++k) {
+          if (coord[k] < srcBase[k])
+            return std::nullopt;
+          offset[k] = coord[k] - srcBase[k];
+        }
+        auto srcReg = srcRegOfOffset.find(offset);
+        if (srcReg == srcRegOfOffset.end())
+          return std::nullopt;
+        if (srcRegs[reg] && *srcRegs[reg] != srcReg->second)
+          return std::nullopt;
+        srcRegs[reg] = srcReg->second;
+      }
+    }
+  if (sameLane)
+    *sameLane = isSameLane;
+  SmallVector<unsigned> result;
+  for (auto srcReg : srcRegs)
+    result.push_back(*srcReg);
+  return result;
+}
+
+bool isWarpShuffleCvt(triton::gpu::ConvertLayoutOp op) {
+  auto srcTy = op.getSrc().getType().cast<RankedTensorType>();
+  auto dstTy = op.getType().cast<RankedTensorType>();
+  return getWarpShuffleCvtSrcRegs(srcTy, dstTy).has_value();
+}
+
+bool isAtomicReduction(triton::AtomicRMWOp op) {
+  auto sem = op.getSem();
+  return op->use_empty() &&
+         (sem == triton::MemSemantic::RELAXED ||
+          sem == triton::MemSemantic::RELEASE) &&
+         op.getAtomicRmwOp() != triton::RMWOp::XCHG;
+}
+
 bool isSingleValue(Value value) {
   // Don't consider load as expensive if it is loading a scalar.
   if (auto tensorTy = value.getType().dyn_cast<RankedTensorType>())
@@ -5,6 +5,7 @@ using ::mlir::LLVM::delinearize;
 using ::mlir::LLVM::getSharedMemoryObjectFromStruct;
 using ::mlir::LLVM::getStridesFromShapeAndOrder;
 using ::mlir::LLVM::linearize;
+using ::mlir::LLVM::shflIdxSync;
 using ::mlir::triton::gpu::DotOperandEncodingAttr;
 using ::mlir::triton::gpu::getContigPerThread;
 using ::mlir::triton::gpu::getOrder;
@@ -12,6 +13,7 @@ using ::mlir::triton::gpu::getShapePerCTA;
 using ::mlir::triton::gpu::getSizePerThread;
 using ::mlir::triton::gpu::getTotalElemsPerThread;
 using ::mlir::triton::gpu::isaDistributedLayout;
+using ::mlir::triton::gpu::MfmaEncodingAttr;
 using ::mlir::triton::gpu::SharedEncodingAttr;
 
 // Forward declarations
@@ -42,6 +44,14 @@ Value convertLayout(int opIdx, ConversionPatternRewriter &rewriter,
                     TritonGPUToLLVMTypeConverter *typeConverter, Value thread);
 }
 
+namespace SharedToDotOperandMFMA {
+Value convertLayout(int opIdx, ConversionPatternRewriter &rewriter,
+                    Location loc, Value tensor,
+                    DotOperandEncodingAttr encoding,
+                    const SharedMemoryObject &smemObj,
+                    TritonGPUToLLVMTypeConverter *typeConverter, Value thread);
+}
+
 namespace SharedToDotOperandFMA {
 Value convertLayout(int opIdx, Value B, Value llB, BlockedEncodingAttr dLayout,
                     Value thread, Location loc,
@@ -73,6 +83,8 @@ public:
       return lowerSharedToDotOperand(op, adaptor, rewriter);
     }
     if (isaDistributedLayout(srcLayout) && isaDistributedLayout(dstLayout)) {
+      if (isWarpShuffleCvt(op))
+        return lowerDistributedWithinWarps(op, adaptor, rewriter);
       return lowerDistributedToDistributed(op, adaptor, rewriter);
     }
     if (srcLayout.isa<MmaEncodingAttr>() &&
@@ -154,7 +166,7 @@ private:
       Value _4 = i32_val(4);
       Value _8 = i32_val(8);
       Value _16 = i32_val(16);
-      if (mmaLayout.isAmpere()) {
+      if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
         multiDimWarpId[0] = urem(multiDimWarpId[0], i32_val(shape[0] / 16));
         multiDimWarpId[1] = urem(multiDimWarpId[1], i32_val(shape[1] / 8));
         Value mmaGrpId = udiv(laneId, _4);
@@ -176,7 +188,7 @@ private:
 
       assert(rank == 2);
       SmallVector<Value> multiDimOffset(rank);
-      if (mmaLayout.isAmpere()) {
+      if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
         multiDimOffset[0] = elemId < 2 ? mmaRowIdx[0] : mmaRowIdx[1];
         multiDimOffset[1] = elemId % 2 == 0 ? mmaColIdx[0] : mmaColIdx[1];
         multiDimOffset[0] = add(
@@ -195,17 +207,30 @@ private:
       }
       return multiDimOffset;
     }
+    if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>()) {
+      // elemId / 4 is the group of 4 consecutive rows, 8 rows apart
+      auto multiDimBase = emitBaseIndexForLayout(loc, rewriter, layout, type);
+      SmallVector<Value> multiDimOffset(rank);
+      multiDimOffset[0] =
+          add(multiDimBase[0], i32_val(multiDimCTAInRepId[0] * shapePerCTA[0] +
+                                       elemId / 4 * 8 + elemId % 4));
+      multiDimOffset[1] = add(multiDimBase[1],
+                              i32_val(multiDimCTAInRepId[1] * shapePerCTA[1]));
+      return multiDimOffset;
+    }
     llvm_unreachable("unexpected layout in getMultiDimOffset");
   }
 
-  // shared memory rd/st for blocked or mma layout with data padding
+  // shared memory rd/st for blocked or mma layout with data padding or
+  // swizzling
   void processReplica(Location loc, ConversionPatternRewriter &rewriter,
                       bool stNotRd, RankedTensorType type,
                       ArrayRef<unsigned> numCTAsEachRep,
                       ArrayRef<unsigned> multiDimRepId, unsigned vec,
                       ArrayRef<unsigned> paddedRepShape,
                       ArrayRef<unsigned> outOrd, SmallVector<Value> &vals,
-                      Value smemBase) const {
+                      Value smemBase,
+                      const triton::CvtSwizzle &swizzle = {}) const {
     auto accumNumCTAsEachRep = product<unsigned>(numCTAsEachRep);
     auto layout = type.getEncoding();
     auto rank = type.getRank();
@@ -246,6 +271,17 @@ private:
         SmallVector<Value> multiDimOffset =
             getMultiDimOffset(layout, loc, rewriter, elemId, type,
                               multiDimCTAInRepId, shapePerCTA);
+        if (swizzle.maxPhase > 1) {
+          // Permute the chunks of the row, see CvtSwizzle
+          Value row = multiDimOffset[outOrd[1]];
+          Value col = multiDimOffset[outOrd[0]];
+          Value swizzleVec = i32_val(swizzle.vec);
+          Value phase = urem(udiv(row, i32_val(swizzle.perPhase)),
+                             i32_val(swizzle.maxPhase));
+          Value chunk = xor_(udiv(col, swizzleVec), phase);
+          multiDimOffset[outOrd[0]] =
+              add(mul(chunk, swizzleVec), urem(col, swizzleVec));
+        }
         Value offset =
             linearize(rewriter, loc, multiDimOffset, paddedRepShape, outOrd);
 
@@ -281,6 +317,79 @@ private:
     }
   }
 
+  // Stores the MMAv3 accumulators of 16-bit elements of a replica with
+  // stmatrix: the two 8x8 halves of the 16x8 tile of each warp are the two
+  // matrices of an .x2 store, whose rows lanes 0-15 address. Each thread holds
+  // two elements of each matrix, i.e. one of its registers.
+  void storeReplicaWithStMatrix(Location loc,
+                                ConversionPatternRewriter &rewriter,
+                                RankedTensorType type,
+                                ArrayRef<unsigned> numCTAsEachRep,
+                                ArrayRef<unsigned> multiDimRepId,
+                                ArrayRef<unsigned> paddedRepShape,
+                                ArrayRef<Value> vals, Value smemBase) const {
+    auto mmaLayout = type.getEncoding().cast<MmaEncodingAttr>();
+    auto shape = type.getShape();
+    auto shapePerCTA = getShapePerCTA(mmaLayout, shape);
+    auto order = getOrder(mmaLayout);
+    SmallVector<unsigned> numCTAs(2);
+    for (unsigned d = 0; d < 2; ++d)
+      numCTAs[d] = ceil<unsigned>(shape[d], shapePerCTA[d]);
+    unsigned accumSizePerThread =
+        product<unsigned>(getSizePerThread(mmaLayout));
+
+    Value threadId = getThreadId(rewriter, loc);
+    Value laneId = urem(threadId, i32_val(32));
+    Value warpId = udiv(threadId, i32_val(32));
+    SmallVector<Value> multiDimWarpId =
+        delinearize(rewriter, loc, warpId, mmaLayout.getWarpsPerCTA(), order);
+    // The row of the tile the lane addresses, and its first column
+    Value rowBase =
+        add(mul(urem(multiDimWarpId[0], i32_val(shape[0] / 16)), i32_val(16)),
+            urem(laneId, i32_val(16)));
+    Value colBase =
+        mul(urem(multiDimWarpId[1], i32_val(shape[1] / 8)), i32_val(8));
+
+    auto elemTy = getTypeConverter()->convertType(type.getElementType());
+    Type packedTy = vec_ty(elemTy, 2);
+    for (unsigned ctaId = 0; ctaId < product<unsigned>(numCTAsEachRep);
+         ++ctaId) {
+      auto multiDimCTAInRepId =
+          getMultiDimIndex<unsigned>(ctaId, numCTAsEachRep, order);
+      SmallVector<unsigned> multiDimCTAId(2);
+      for (unsigned d = 0; d < 2; ++d)
+        multiDimCTAId[d] =
+            multiDimRepId[d] * numCTAsEachRep[d] + multiDimCTAInRepId[d];
+      auto linearCTAId =
+          getLinearIndex<unsigned>(multiDimCTAId, numCTAs, order);
+
+      Value row =
+          add(rowBase, i32_val(multiDimCTAInRepId[0] * shapePerCTA[0]));
+      Value col =
+          add(colBase, i32_val(multiDimCTAInRepId[1] * shapePerCTA[1]));
+      Value offset = add(mul(row, i32_val(paddedRepShape[1])), col);
+      Value ptr = gep(ptr_ty(elemTy, 3), smemBase, offset);
+
+      // Rows r and r + 8 of the tile, two elements each
+      SmallVector<std::pair<Value, std::string>> regs;
+      for (unsigned half = 0; half < 2; ++half) {
+        Value packed = undef(packedTy);
+        for (unsigned v = 0; v < 2; ++v) {
+          Value val = vals[linearCTAId * accumSizePerThread + 2 * half + v];
+          packed = insert_element(packedTy, packed, val, i32_val(v));
+        }
+        regs.push_back({bitcast(packed, i32_ty), "r"});
+      }
+      PTXBuilder builder;
+      auto &stmatrix =
+          *builder.create<>("stmatrix.sync.aligned.m8n8.x2.shared.b16");
+      auto *addrOpr = builder.newAddrOperand(ptr, "r");
+      auto *valsOpr = builder.newListOperand(regs);
+      stmatrix(addrOpr, valsOpr);
+      builder.launch(rewriter, loc, void_ty(rewriter.getContext()));
+    }
+  }
+
   // The MMAV1's result is quite different from the existing "Replica"
   // structure, add a new simple but clear implementation for it to avoid
   // modifying the logic of the existing one.
@@ -382,8 +491,50 @@ private:
     }
   }
 
+  // blocked -> blocked, when each thread only needs elements held by lanes of
+  // its own warp: each element is read from the first lane of the source
+  // layout holding it with a shuffle, which needs no shared memory and no
+  // barrier.
+  LogicalResult
+  lowerDistributedWithinWarps(triton::gpu::ConvertLayoutOp op,
+                              OpAdaptor adaptor,
+                              ConversionPatternRewriter &rewriter) const {
+    auto loc = op.getLoc();
+    auto srcTy = op.getSrc().getType().cast<RankedTensorType>();
+    auto dstTy = op.getType().cast<RankedTensorType>();
+    auto srcLayout = srcTy.getEncoding().cast<BlockedEncodingAttr>();
+    bool sameLane = false;
+    auto srcRegs = *getWarpShuffleCvtSrcRegs(srcTy, dstTy, &sameLane);
+    auto vals = getTypeConverter()->unpackLLElements(loc, adaptor.getSrc(),
+                                                     rewriter, srcTy);
+    SmallVector<Value> outVals(srcRegs.size());
+    if (sameLane) {
+      for (unsigned i = 0; i < srcRegs.size(); ++i)
+        outVals[i] = vals[srcRegs[i]];
+    } else {
+      auto sizePerThread = srcLayout.getSizePerThread();
+      auto threadsPerWarp = srcLayout.getThreadsPerWarp();
+      auto order = srcLayout.getOrder();
+      auto indices = emitIndices(loc, rewriter, dstTy.getEncoding(), dstTy);
+      for (unsigned i = 0; i < srcRegs.size(); ++i) {
+        SmallVector<Value> srcLaneId;
+        for (unsigned k = 0; k < dstTy.getRank(); ++k) {
+          Value threadId = udiv(indices[i][k], i32_val(sizePerThread[k]));
+          srcLaneId.push_back(urem(threadId, i32_val(threadsPerWarp[k])));
+        }
+        Value srcLane =
+            linearize(rewriter, loc, srcLaneId, threadsPerWarp, order);
+        outVals[i] = shflIdxSync(loc, rewriter, vals[srcRegs[i]], srcLane);
+      }
+    }
+    Value result =
+        getTypeConverter()->packLLElements(loc, outVals, rewriter, dstTy);
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+
   // blocked/mma -> blocked/mma.
-  // Data padding in shared memory to avoid bank conflict.
+  // Data padding or swizzling in shared memory to avoid bank conflict.
   LogicalResult
   lowerDistributedToDistributed(triton::gpu::ConvertLayoutOp op,
                                 OpAdaptor adaptor,
@@ -443,7 +594,9 @@ private:
                                                      rewriter, srcTy);
     unsigned inVec = 0;
     unsigned outVec = 0;
-    auto paddedRepShape = getScratchConfigForCvtLayout(op, inVec, outVec);
+    triton::CvtSwizzle swizzle;
+    auto paddedRepShape =
+        getScratchConfigForCvtLayout(op, inVec, outVec, &swizzle);
     if (getElementTypeOrSelf(op.getType()).isa<mlir::Float8E4M3B11FNUZType>()) {
       assert(inVec % 4 == 0 && "conversion not supported for FP8E4M3B15");
       assert(outVec % 4 == 0 && "conversion not supported for FP8E4M3B15");
@@ -452,6 +605,7 @@ private:
     unsigned outElems = getTotalElemsPerThread(dstTy);
     auto outOrd = getOrder(dstLayout);
     SmallVector<Value> outVals(outElems);
+    bool useStMatrix = isStMatrixCvt(op);
 
     for (unsigned repId = 0; repId < accumNumReplicates; ++repId) {
       auto multiDimRepId =
@@ -460,15 +614,20 @@ private:
         barrier();
       if (srcLayout.isa<BlockedEncodingAttr>() ||
           srcLayout.isa<SliceEncodingAttr>() ||
-          srcLayout.isa<MmaEncodingAttr>()) {
+          srcLayout.isa<MmaEncodingAttr>() ||
+          srcLayout.isa<MfmaEncodingAttr>()) {
         if (isSrcMmaV1)
           processReplicaForMMAV1(loc, rewriter, /*stNotRd*/ true, srcTy,
                                  multiDimRepId, inVec, paddedRepShape, outOrd,
                                  vals, smemBase, shape);
+        else if (useStMatrix)
+          storeReplicaWithStMatrix(loc, rewriter, srcTy, inNumCTAsEachRep,
+                                   multiDimRepId, paddedRepShape, vals,
+                                   smemBase);
         else
           processReplica(loc, rewriter, /*stNotRd*/ true, srcTy,
                          inNumCTAsEachRep, multiDimRepId, inVec, paddedRepShape,
-                         outOrd, vals, smemBase);
+                         outOrd, vals, smemBase, swizzle);
       } else {
         assert(0 && "ConvertLayout with input layout not implemented");
         return failure();
@@ -477,7 +636,8 @@ private:
       barrier();
       if (dstLayout.isa<BlockedEncodingAttr>() ||
           dstLayout.isa<SliceEncodingAttr>() ||
-          dstLayout.isa<MmaEncodingAttr>()) {
+          dstLayout.isa<MmaEncodingAttr>() ||
+          dstLayout.isa<MfmaEncodingAttr>()) {
         if (isDstMmaV1)
           processReplicaForMMAV1(loc, rewriter, /*stNotRd*/ false, dstTy,
                                  multiDimRepId, outVec, paddedRepShape, outOrd,
@@ -485,7 +645,7 @@ private:
         else
           processReplica(loc, rewriter, /*stNotRd*/ false, dstTy,
                          outNumCTAsEachRep, multiDimRepId, outVec,
-                         paddedRepShape, outOrd, outVals, smemBase);
+                         paddedRepShape, outOrd, outVals, smemBase, swizzle);
       } else {
         assert(0 && "ConvertLayout with output layout not implemented");
         return failure();
@@ -595,6 +755,12 @@ private:
             dotOperandLayout.getParent().dyn_cast_or_null<MmaEncodingAttr>()) {
       res = lowerSharedToDotOperandMMA(op, adaptor, rewriter, mmaLayout,
                                        dotOperandLayout, isOuter);
+    } else if (dotOperandLayout.getParent().isa<MfmaEncodingAttr>()) {
+      auto smemObj =
+          getSharedMemoryObjectFromStruct(loc, adaptor.getSrc(), rewriter);
+      res = SharedToDotOperandMFMA::convertLayout(
+          dotOperandLayout.getOpIdx(), rewriter, loc, src, dotOperandLayout,
+          smemObj, getTypeConverter(), tid_val());
     } else if (auto blockedLayout =
                    dotOperandLayout.getParent()
                        .dyn_cast_or_null<BlockedEncodingAttr>()) {
@@ -699,6 +865,10 @@ private:
           dotOperandLayout.getOpIdx(), rewriter, loc, src, dotOperandLayout,
           smemObj, getTypeConverter(), tid_val());
 
+    } else if (mmaLayout.isHopper()) { // tensor core v3
+      // wgmma reads the operand from shared memory: the dot operand is the
+      // shared memory object itself
+      res = adaptor.getSrc();
     } else if (!isOuter && mmaLayout.isVolta() &&
                supportMMA(dst, mmaLayout.getVersionMajor())) { // tensor core v1
       bool isMMAv1Row = dotOperandLayout.getMMAv1IsRow();
@@ -86,6 +86,32 @@ ValueTable getValueTableFromStruct(Value val, int K, int n0, int shapePerCTA,
   return res;
 }
 
+// Number of elements of `elemTy` loaded at once along a contiguous run of
+// `len` elements of shared memory, up to 128 bits.
+static int getVecWidth(int len, Type elemTy) {
+  if (!elemTy.isIntOrFloat() || elemTy.getIntOrFloatBitWidth() < 8)
+    return 1;
+  int maxVec = 128 / elemTy.getIntOrFloatBitWidth();
+  int vec = 1;
+  while (vec * 2 <= maxVec && len % (vec * 2) == 0)
+    vec *= 2;
+  return vec;
+}
+
+// Loads `vec` consecutive elements of shared memory starting at `ptr`.
+static SmallVector<Value> loadSharedVec(Value ptr, Type elemTy, int vec,
+                                        ConversionPatternRewriter &rewriter,
+                                        Location loc) {
+  if (vec == 1)
+    return {load(ptr)};
+  Type vecTy = vec_ty(elemTy, vec);
+  Value v = load(bitcast(ptr, ptr_ty(vecTy, 3)));
+  SmallVector<Value> elems;
+  for (int i = 0; i < vec; ++i)
+    elems.push_back(extract_element(elemTy, v, i32_val(i)));
+  return elems;
+}
+
 Value loadAFMA(Value A, Value llA, BlockedEncodingAttr dLayout, Value thread,
                Location loc, TritonGPUToLLVMTypeConverter *typeConverter,
                ConversionPatternRewriter &rewriter) {
@@ -137,16 +163,26 @@ Value loadAFMA(Value A, Value llA, BlockedEncodingAttr dLayout, Value thread,
   int mShapePerCTA = getShapePerCTAForMN(dLayout, true /*isM*/);
   int mSizePerThread = getSizePerThreadForMN(dLayout, true /*isM*/);
 
-  for (unsigned k = 0; k < K; ++k)
+  // Vectorize the loads along the contiguous dimension of A.
+  int kVec = isARow ? getVecWidth(K, elemTy) : 1;
+  int mVec = isARow ? 1 : getVecWidth(mSizePerThread, elemTy);
+  ValueTable aVals;
+  for (unsigned k = 0; k < K; k += kVec)
     for (unsigned m = 0; m < M; m += mShapePerCTA)
-      for (unsigned mm = 0; mm < mSizePerThread; ++mm) {
+      for (unsigned mm = 0; mm < mSizePerThread; mm += mVec) {
         Value offset =
             add(mul(i32_val(m + mm), strideAM), mul(i32_val(k), strideAK));
         Value pa = gep(ptrTy, aPtrs[0], offset);
-        Value va = load(pa);
-        vas.emplace_back(va);
+        auto elems = loadSharedVec(pa, elemTy, kVec * mVec, rewriter, loc);
+        for (unsigned i = 0; i < elems.size(); ++i)
+          aVals[{m + mm + i % mVec, k + i / mVec}] = elems[i];
       }
 
+  for (unsigned k = 0; k < K; ++k)
+    for (unsigned m = 0; m < M; m += mShapePerCTA)
+      for (unsigned mm = 0; mm < mSizePerThread; ++mm)
+        vas.emplace_back(aVals[{m + mm, k}]);
+
   return getStructFromValueTable(vas, rewriter, loc, typeConverter, elemTy);
 }
 
@@ -201,16 +237,26 @@ Value loadBFMA(Value B, Value llB, BlockedEncodingAttr dLayout, Value thread,
   int nShapePerCTA = getShapePerCTAForMN(dLayout, false /*isM*/);
   int nSizePerThread = getSizePerThreadForMN(dLayout, false /*isM*/);
 
-  for (unsigned k = 0; k < K; ++k)
+  // Vectorize the loads along the contiguous dimension of B.
+  int kVec = isBRow ? 1 : getVecWidth(K, elemTy);
+  int nVec = isBRow ? getVecWidth(nSizePerThread, elemTy) : 1;
+  ValueTable bVals;
+  for (unsigned k = 0; k < K; k += kVec)
     for (unsigned n = 0; n < N; n += nShapePerCTA)
-      for (unsigned nn = 0; nn < nSizePerThread; ++nn) {
+      for (unsigned nn = 0; nn < nSizePerThread; nn += nVec) {
         Value offset =
             add(mul(i32_val(n + nn), strideBN), mul(i32_val(k), strideBK));
         Value pb = gep(ptrTy, bPtrs[0], offset);
-        Value vb = load(pb);
-        vbs.emplace_back(vb);
+        auto elems = loadSharedVec(pb, elemTy, kVec * nVec, rewriter, loc);
+        for (unsigned i = 0; i < elems.size(); ++i)
+          bVals[{n + nn + i % nVec, k + i / nVec}] = elems[i];
       }
 
+  for (unsigned k = 0; k < K; ++k)
+    for (unsigned n = 0; n < N; n += nShapePerCTA)
+      for (unsigned nn = 0; nn < nSizePerThread; ++nn)
+        vbs.emplace_back(bVals[{n + nn, k}]);
+
   return getStructFromValueTable(vbs, rewriter, loc, typeConverter, elemTy);
 }
 
@@ -0,0 +1,81 @@
+#include "../ConvertLayoutOpToLLVM.h"
+#include "../Utility.h"
+
+using namespace mlir;
+
+using ::mlir::LLVM::delinearize;
+using ::mlir::triton::gpu::DotOperandEncodingAttr;
+using ::mlir::triton::gpu::getOrder;
+using ::mlir::triton::gpu::MfmaEncodingAttr;
+using ::mlir::triton::gpu::SharedEncodingAttr;
+
+namespace SharedToDotOperandMFMA {
+
+// Loads operand `opIdx` of a 32x32 mfma from shared memory. For every
+// instruction, lane l holds the kWidth consecutive values of k starting at
+// (l / 32) * kWidth of row l % 32 of a (column l % 32 of b). The values are
+// ordered by tile along m (n), then by step along k.
+Value convertLayout(int opIdx, ConversionPatternRewriter &rewriter,
+                    Location loc, Value tensor,
+                    DotOperandEncodingAttr encoding,
+                    const SharedMemoryObject &smemObj,
+                    TritonGPUToLLVMTypeConverter *typeConverter, Value thread) {
+  auto tensorTy = tensor.getType().cast<RankedTensorType>();
+  auto shape = tensorTy.getShape();
+  auto sharedLayout = tensorTy.getEncoding().cast<SharedEncodingAttr>();
+  auto mfmaLayout = encoding.getParent().cast<MfmaEncodingAttr>();
+  auto warpsPerCTA = mfmaLayout.getWarpsPerCTA();
+  Type elemTy = typeConverter->convertType(tensorTy.getElementType());
+
+  int bitwidth = tensorTy.getElementType().getIntOrFloatBitWidth();
+  int kWidth = encoding.getMFMAOperandKWidth(bitwidth);
+  auto rep = encoding.getMFMARep(shape, bitwidth);
+  // m of a or n of b, and k
+  unsigned nonKDim = opIdx == 0 ? 0 : 1;
+  unsigned kDim = 1 - nonKDim;
+
+  Value warpSize = i32_val(64);
+  Value lane = urem(thread, warpSize);
+  Value warp = udiv(thread, warpSize);
+  SmallVector<Value> multiDimWarpId =
+      delinearize(rewriter, loc, warp, warpsPerCTA, getOrder(mfmaLayout));
+  Value warpOff =
+      mul(urem(multiDimWarpId[nonKDim],
+               i32_val(ceil<unsigned>(shape[nonKDim], 32))),
+          i32_val(32));
+  Value nonKBase = add(urem(lane, i32_val(32)), warpOff);
+  Value kBase = mul(udiv(lane, i32_val(32)), i32_val(kWidth));
+
+  Value strideNonK = smemObj.strides[nonKDim];
+  Value strideK = smemObj.strides[kDim];
+  Type ptrTy = ptr_ty(elemTy, 3);
+  Value base = gep(ptrTy, smemObj.base,
+                   add(mul(nonKBase, strideNonK), mul(kBase, strideK)));
+  // The values of a lane are contiguous for a row-major a and a
+  // column-major b
+  bool isKContig = sharedLayout.getOrder()[0] == kDim;
+  Type vecTy = vec_ty(elemTy, kWidth);
+
+  SmallVector<Value> vals;
+  for (int t = 0; t < rep[nonKDim]; ++t)
+    for (int k = 0; k < rep[kDim]; ++k) {
+      Value offset =
+          add(mul(i32_val(t * 32 * warpsPerCTA[nonKDim]), strideNonK),
+              mul(i32_val(k * 2 * kWidth), strideK));
+      Value ptr = gep(ptrTy, base, offset);
+      if (isKContig && kWidth > 1) {
+        Value vec = load(bitcast(ptr, ptr_ty(vecTy, 3)));
+        for (int e = 0; e < kWidth; ++e)
+          vals.push_back(extract_element(elemTy, vec, i32_val(e)));
+      } else {
+        for (int e = 0; e < kWidth; ++e)
+          vals.push_back(load(gep(ptrTy, ptr, mul(i32_val(e), strideK))));
+      }
+    }
+
+  Type structTy = LLVM::LLVMStructType::getLiteral(
+      tensor.getContext(), SmallVector<Type>(vals.size(), elemTy));
+  return typeConverter->packLLElements(loc, vals, rewriter, structTy);
+}
+
+} // namespace SharedToDotOperandMFMA
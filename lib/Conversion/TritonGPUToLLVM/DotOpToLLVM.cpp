@@ -5,6 +5,7 @@ using namespace mlir;
 using namespace mlir::triton;
 
 using ::mlir::triton::gpu::DotOperandEncodingAttr;
+using ::mlir::triton::gpu::MfmaEncodingAttr;
 using ::mlir::triton::gpu::MmaEncodingAttr;
 
 LogicalResult convertFMADot(triton::DotOp op, triton::DotOp::Adaptor adaptor,
@@ -19,6 +20,20 @@ LogicalResult convertMMA16816(triton::DotOp op, triton::DotOp::Adaptor adaptor,
                               TritonGPUToLLVMTypeConverter *typeConverter,
                               ConversionPatternRewriter &rewriter);
 
+LogicalResult convertMMA16832Sparse(triton::SparseDotOp op,
+                                    triton::SparseDotOp::Adaptor adaptor,
+                                    TritonGPUToLLVMTypeConverter *typeConverter,
+                                    ConversionPatternRewriter &rewriter,
+                                    Value thread);
+
+LogicalResult convertWGMMA(triton::DotOp op, triton::DotOp::Adaptor adaptor,
+                           TritonGPUToLLVMTypeConverter *typeConverter,
+                           ConversionPatternRewriter &rewriter, Value thread);
+
+LogicalResult convertMFMA(triton::DotOp op, triton::DotOp::Adaptor adaptor,
+                          TritonGPUToLLVMTypeConverter *typeConverter,
+                          ConversionPatternRewriter &rewriter);
+
 struct DotOpConversion : public ConvertTritonGPUOpToLLVMPattern<triton::DotOp> {
   using ConvertTritonGPUOpToLLVMPattern<
       triton::DotOp>::ConvertTritonGPUOpToLLVMPattern;
@@ -45,11 +60,18 @@ struct DotOpConversion : public ConvertTritonGPUOpToLLVMPattern<triton::DotOp> {
         return convertMMA884(op, adaptor, getTypeConverter(), rewriter);
       if (mmaLayout.isAmpere())
         return convertMMA16816(op, adaptor, getTypeConverter(), rewriter);
+      if (mmaLayout.isHopper())
+        return convertWGMMA(op, adaptor, getTypeConverter(), rewriter,
+                            getThreadId(rewriter, op.getLoc()));
 
       llvm::report_fatal_error(
           "Unsupported MMA kind found when converting DotOp to LLVM.");
     }
 
+    auto dEncoding = D.getType().cast<RankedTensorType>().getEncoding();
+    if (!isOuter && dEncoding.isa<MfmaEncodingAttr>())
+      return convertMFMA(op, adaptor, getTypeConverter(), rewriter);
+
     if (D.getType()
             .cast<RankedTensorType>()
             .getEncoding()
@@ -61,9 +83,33 @@ struct DotOpConversion : public ConvertTritonGPUOpToLLVMPattern<triton::DotOp> {
   }
 };
 
+struct SparseDotOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::SparseDotOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::SparseDotOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::SparseDotOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    // The operands are dense ones in the dot operand layouts of an Ampere
+    // mma, and the metadata of A stays in shared memory.
+    MmaEncodingAttr mmaLayout = op.getD()
+                                    .getType()
+                                    .cast<RankedTensorType>()
+                                    .getEncoding()
+                                    .dyn_cast<MmaEncodingAttr>();
+    if (!mmaLayout || !mmaLayout.isAmpere())
+      return op.emitError("sparse dots require an Ampere mma layout, which "
+                          "needs compute capability 8.0 or later");
+    return convertMMA16832Sparse(op, adaptor, getTypeConverter(), rewriter,
+                                 getThreadId(rewriter, op.getLoc()));
+  }
+};
+
 void populateDotOpToLLVMPatterns(TritonGPUToLLVMTypeConverter &typeConverter,
                                  RewritePatternSet &patterns,
                                  ModuleAllocation &allocation,
                                  PatternBenefit benefit) {
   patterns.add<DotOpConversion>(typeConverter, allocation, benefit);
+  patterns.add<SparseDotOpConversion>(typeConverter, allocation, benefit);
 }
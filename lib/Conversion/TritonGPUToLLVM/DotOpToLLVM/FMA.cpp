@@ -25,6 +25,29 @@ static ValueTableFMA getValueTableFromStructFMA(
   return res;
 }
 
+// Number of f16x2 FMAs accumulated in half precision before the partial sums
+// are folded into the accumulator, to bound the rounding error of the f16
+// accumulation when the accumulator is fp32.
+constexpr unsigned kF16x2FoldPeriod = 8;
+
+static Value packF16x2(Value lo, Value hi, ConversionPatternRewriter &rewriter,
+                       Location loc) {
+  auto vecTy = vec_ty(f16_ty, 2);
+  Value vec = undef(vecTy);
+  vec = insert_element(vecTy, vec, lo, i32_val(0));
+  return insert_element(vecTy, vec, hi, i32_val(1));
+}
+
+// Adds the two halves of the f16x2 partial sum `partial` to `acc`.
+static Value foldF16x2(Value acc, Value partial,
+                       ConversionPatternRewriter &rewriter, Location loc) {
+  Value lo = extract_element(f16_ty, partial, i32_val(0));
+  Value hi = extract_element(f16_ty, partial, i32_val(1));
+  if (acc.getType().isF16())
+    return fadd(acc, fadd(lo, hi));
+  return fadd(acc, fadd(fpext(f32_ty, lo), fpext(f32_ty, hi)));
+}
+
 LogicalResult convertFMADot(triton::DotOp op, triton::DotOp::Adaptor adaptor,
                             TritonGPUToLLVMTypeConverter *typeConverter,
                             ConversionPatternRewriter &rewriter) {
@@ -77,20 +100,71 @@ LogicalResult convertFMADot(triton::DotOp op, triton::DotOp::Adaptor adaptor,
 
   SmallVector<Value> ret = cc;
   bool isCRow = order[0] == 1;
-
-  for (unsigned k = 0; k < K; k++) {
-    for (unsigned m = 0; m < M; m += mShapePerCTA)
-      for (unsigned n = 0; n < N; n += nShapePerCTA)
+  auto getRetIdx = [&](unsigned m, unsigned n, unsigned mm, unsigned nn) {
+    int mIdx = m / mShapePerCTA * mSizePerThread + mm;
+    int nIdx = n / nShapePerCTA * nSizePerThread + nn;
+    return isCRow ? mIdx * N / nShapePerCTA * mSizePerThread + nIdx
+                  : nIdx * M / mShapePerCTA * nSizePerThread + mIdx;
+  };
+
+  Type aElemTy = aTensorTy.getElementType();
+  Type bElemTy = bTensorTy.getElementType();
+  Type dElemTy = dTensorTy.getElementType();
+  bool useF16x2 = aElemTy.isF16() && bElemTy.isF16() && K % 2 == 0 &&
+                  (dElemTy.isF16() || dElemTy.isF32());
+
+  if (useF16x2) {
+    // Multiply pairs of consecutive k with fma.rn.f16x2, and fold the f16x2
+    // partial sums into the accumulator every kF16x2FoldPeriod pairs.
+    ValueTableFMA hasPacked, hbsPacked;
+    for (unsigned k = 0; k < K; k += 2) {
+      for (unsigned m = 0; m < M; m += mShapePerCTA)
         for (unsigned mm = 0; mm < mSizePerThread; ++mm)
-          for (unsigned nn = 0; nn < nSizePerThread; ++nn) {
-            int mIdx = m / mShapePerCTA * mSizePerThread + mm;
-            int nIdx = n / nShapePerCTA * nSizePerThread + nn;
-
-            int z = isCRow ? mIdx * N / nShapePerCTA * mSizePerThread + nIdx
-                           : nIdx * M / mShapePerCTA * nSizePerThread + mIdx;
-            ret[z] = rewriter.create<LLVM::FMulAddOp>(loc, has[{m + mm, k}],
-                                                      hbs[{n + nn, k}], ret[z]);
+          hasPacked[{m + mm, k}] = packF16x2(
+              has[{m + mm, k}], has[{m + mm, k + 1}], rewriter, loc);
+      for (unsigned n = 0; n < N; n += nShapePerCTA)
+        for (unsigned nn = 0; nn < nSizePerThread; ++nn)
+          hbsPacked[{n + nn, k}] = packF16x2(
+              hbs[{n + nn, k}], hbs[{n + nn, k + 1}], rewriter, loc);
+    }
+
+    SmallVector<Value> partial(ret.size());
+    for (unsigned k = 0; k < K; k += 2) {
+      for (unsigned m = 0; m < M; m += mShapePerCTA)
+        for (unsigned n = 0; n < N; n += nShapePerCTA)
+          for (unsigned mm = 0; mm < mSizePerThread; ++mm)
+            for (unsigned nn = 0; nn < nSizePerThread; ++nn) {
+              int z = getRetIdx(m, n, mm, nn);
+              Value a = hasPacked[{m + mm, k}];
+              Value b = hbsPacked[{n + nn, k}];
+              partial[z] = partial[z] ? rewriter.create<LLVM::FMAOp>(
+                                            loc, a, b, partial[z])
+                                      : fmul(a, b);
+            }
+      if ((k / 2 + 1) % kF16x2FoldPeriod == 0 || k + 2 == K)
+        for (unsigned z = 0; z < ret.size(); ++z)
+          if (partial[z]) {
+            ret[z] = foldF16x2(ret[z], partial[z], rewriter, loc);
+            partial[z] = Value();
           }
+    }
+  } else {
+    for (unsigned k = 0; k < K; k++) {
+      for (unsigned m = 0; m < M; m += mShapePerCTA)
+        for (unsigned n = 0; n < N; n += nShapePerCTA)
+          for (unsigned mm = 0; mm < mSizePerThread; ++mm)
+            for (unsigned nn = 0; nn < nSizePerThread; ++nn) {
+              int z = getRetIdx(m, n, mm, nn);
+              Value a = has[{m + mm, k}];
+              Value b = hbs[{n + nn, k}];
+              // Operands narrower than the accumulator are extended to it.
+              if (a.getType() != ret[z].getType())
+                a = fpext(ret[z].getType(), a);
+              if (b.getType() != ret[z].getType())
+                b = fpext(ret[z].getType(), b);
+              ret[z] = rewriter.create<LLVM::FMulAddOp>(loc, a, b, ret[z]);
+            }
+    }
   }
 
   auto res = typeConverter->packLLElements(loc, ret, rewriter, dTensorTy);
@@ -0,0 +1,101 @@
+#include "../DotOpToLLVM.h"
+#include "../Utility.h"
+
+#include "mlir/Dialect/LLVMIR/ROCDLDialect.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+using ::mlir::triton::gpu::DotOperandEncodingAttr;
+using ::mlir::triton::gpu::MfmaEncodingAttr;
+
+// The 32x32 mfma instruction for the operands of `elemTy`: 8 values of k per
+// instruction for 16-bit types, 2 for float32.
+static Value createMfma32x32(Type elemTy, Value a, Value b, Value acc,
+                             ConversionPatternRewriter &rewriter,
+                             Location loc) {
+  Type resTy = acc.getType();
+  // cbsz, abid and blgp: no broadcast of the operands between the blocks
+  SmallVector<Value> args{a, b, acc, i32_val(0), i32_val(0), i32_val(0)};
+  if (elemTy.isF16())
+    return rewriter.create<ROCDL::mfma_f32_32x32x8f16>(loc, resTy, args);
+  if (elemTy.isBF16())
+    return rewriter.create<ROCDL::mfma_f32_32x32x8bf16_1k>(loc, resTy, args);
+  assert(elemTy.isF32() && "Unexpected mfma operand type");
+  return rewriter.create<ROCDL::mfma_f32_32x32x2f32>(loc, resTy, args);
+}
+
+// Packs the kWidth consecutive values of k of an operand into the vector
+// that an mfma reads from a register; bf16 values are passed as i16.
+static Value packOperand(ArrayRef<Value> vals, Type elemTy,
+                         ConversionPatternRewriter &rewriter, Location loc) {
+  if (vals.size() == 1)
+    return vals[0];
+  Type packElemTy = elemTy.isBF16() ? i16_ty : elemTy;
+  Type vecTy = vec_ty(packElemTy, vals.size());
+  Value vec = undef(vecTy);
+  for (unsigned i = 0; i < vals.size(); ++i) {
+    Value val = elemTy.isBF16() ? bitcast(vals[i], i16_ty) : vals[i];
+    vec = insert_element(vecTy, vec, val, i32_val(i));
+  }
+  return vec;
+}
+
+LogicalResult convertMFMA(triton::DotOp op, triton::DotOp::Adaptor adaptor,
+                          TritonGPUToLLVMTypeConverter *typeConverter,
+                          ConversionPatternRewriter &rewriter) {
+  auto loc = op.getLoc();
+  auto aTensorTy = op.getA().getType().cast<RankedTensorType>();
+  auto bTensorTy = op.getB().getType().cast<RankedTensorType>();
+  auto dTensorTy = op.getD().getType().cast<RankedTensorType>();
+  auto aEncoding = aTensorTy.getEncoding().cast<DotOperandEncodingAttr>();
+  auto bEncoding = bTensorTy.getEncoding().cast<DotOperandEncodingAttr>();
+
+  Type elemTy = aTensorTy.getElementType();
+  int bitwidth = elemTy.getIntOrFloatBitWidth();
+  int kWidth = aEncoding.getMFMAOperandKWidth(bitwidth);
+  auto aRep = aEncoding.getMFMARep(aTensorTy.getShape(), bitwidth);
+  auto bRep = bEncoding.getMFMARep(bTensorTy.getShape(), bitwidth);
+  int repM = aRep[0];
+  int repN = bRep[1];
+  int repK = aRep[1];
+  assert(repK == bRep[0] && "Mismatched k of the mfma operands");
+
+  auto aVals =
+      typeConverter->unpackLLElements(loc, adaptor.getA(), rewriter, aTensorTy);
+  auto bVals =
+      typeConverter->unpackLLElements(loc, adaptor.getB(), rewriter, bTensorTy);
+  auto cVals =
+      typeConverter->unpackLLElements(loc, adaptor.getC(), rewriter, dTensorTy);
+  assert(aVals.size() == repM * repK * kWidth &&
+         bVals.size() == repN * repK * kWidth &&
+         cVals.size() == repM * repN * 16 &&
+         "Unexpected number of values of the mfma operands");
+
+  // The operands hold their values by tile along m (n), then by step along
+  // k, and the accumulator its 16 values by tile along m, then along n.
+  Type accTy = vec_ty(f32_ty, 16);
+  SmallVector<Value> dVals(cVals.size());
+  for (int m = 0; m < repM; ++m)
+    for (int n = 0; n < repN; ++n) {
+      int tile = (m * repN + n) * 16;
+      Value acc = undef(accTy);
+      for (int v = 0; v < 16; ++v)
+        acc = insert_element(accTy, acc, cVals[tile + v], i32_val(v));
+      for (int k = 0; k < repK; ++k) {
+        ArrayRef<Value> a(&aVals[(m * repK + k) * kWidth], kWidth);
+        ArrayRef<Value> b(&bVals[(n * repK + k) * kWidth], kWidth);
+        acc = createMfma32x32(elemTy, packOperand(a, elemTy, rewriter, loc),
+                              packOperand(b, elemTy, rewriter, loc), acc,
+                              rewriter, loc);
+      }
+      for (int v = 0; v < 16; ++v)
+        dVals[tile + v] = extract_element(f32_ty, acc, i32_val(v));
+    }
+
+  Type structTy = LLVM::LLVMStructType::getLiteral(
+      op.getContext(), SmallVector<Type>(dVals.size(), f32_ty));
+  Value res = typeConverter->packLLElements(loc, dVals, rewriter, structTy);
+  rewriter.replaceOp(op, res);
+  return success();
+}
@@ -4,6 +4,7 @@
 using namespace mlir;
 using namespace mlir::triton;
 
+using ::mlir::LLVM::getSharedMemoryObjectFromStruct;
 using ::mlir::triton::gpu::DotOperandEncodingAttr;
 using ::mlir::triton::gpu::MmaEncodingAttr;
 
@@ -78,6 +79,11 @@ enum class TensorCoreType : uint8_t {
   FP32_BF16_BF16_FP32,
   FP32_TF32_TF32_FP32,
   FP16_FP16_FP16_FP16,
+  // fp8 tensor core instr, from sm_89
+  FP32_FP8E5M2_FP8E5M2_FP32,
+  FP32_FP8E5M2_FP8E4M3_FP32,
+  FP32_FP8E4M3_FP8E5M2_FP32,
+  FP32_FP8E4M3_FP8E4M3_FP32,
   // integer tensor core instr
   INT32_INT1_INT1_INT32, // Not implemented
   INT32_INT4_INT4_INT32, // Not implemented
@@ -105,6 +111,11 @@ Type getMmaRetType(TensorCoreType mmaType, MLIRContext *ctx) {
     return fp32x4Ty;
   case TensorCoreType::FP16_FP16_FP16_FP16:
     return fp16x2Pack2Ty;
+  case TensorCoreType::FP32_FP8E5M2_FP8E5M2_FP32:
+  case TensorCoreType::FP32_FP8E5M2_FP8E4M3_FP32:
+  case TensorCoreType::FP32_FP8E4M3_FP8E5M2_FP32:
+  case TensorCoreType::FP32_FP8E4M3_FP8E4M3_FP32:
+    return fp32x4Ty;
   case TensorCoreType::INT32_INT8_INT8_INT32:
     return i32x4Ty;
   default:
@@ -130,6 +141,17 @@ TensorCoreType getMmaType(triton::DotOp op) {
     if (aTy.getElementType().isF32() && bTy.getElementType().isF32() &&
         op.getAllowTF32())
       return TensorCoreType::FP32_TF32_TF32_FP32;
+    auto aElemTy = aTy.getElementType();
+    auto bElemTy = bTy.getElementType();
+    if (isNativeFp8(aElemTy) && isNativeFp8(bElemTy)) {
+      bool isAE5M2 = aElemTy.isa<mlir::Float8E5M2Type>();
+      bool isBE5M2 = bElemTy.isa<mlir::Float8E5M2Type>();
+      if (isAE5M2)
+        return isBE5M2 ? TensorCoreType::FP32_FP8E5M2_FP8E5M2_FP32
+                       : TensorCoreType::FP32_FP8E5M2_FP8E4M3_FP32;
+      return isBE5M2 ? TensorCoreType::FP32_FP8E4M3_FP8E5M2_FP32
+                     : TensorCoreType::FP32_FP8E4M3_FP8E4M3_FP32;
+    }
   } else if (dTy.getElementType().isInteger(32)) {
     if (aTy.getElementType().isInteger(8) && bTy.getElementType().isInteger(8))
       return TensorCoreType::INT32_INT8_INT8_INT32;
@@ -158,6 +180,16 @@ inline static const std::map<TensorCoreType, std::string> mmaInstrPtx = {
 
     {TensorCoreType::FP16_FP16_FP16_FP16,
      "mma.sync.aligned.m16n8k16.row.col.f16.f16.f16.f16"},
+
+    // PTX ISA 8.4 and later, which AccelerateMatmul requires of fp8 dots
+    {TensorCoreType::FP32_FP8E5M2_FP8E5M2_FP32,
+     "mma.sync.aligned.m16n8k32.row.col.f32.e5m2.e5m2.f32"},
+    {TensorCoreType::FP32_FP8E5M2_FP8E4M3_FP32,
+     "mma.sync.aligned.m16n8k32.row.col.f32.e5m2.e4m3.f32"},
+    {TensorCoreType::FP32_FP8E4M3_FP8E5M2_FP32,
+     "mma.sync.aligned.m16n8k32.row.col.f32.e4m3.e5m2.f32"},
+    {TensorCoreType::FP32_FP8E4M3_FP8E4M3_FP32,
+     "mma.sync.aligned.m16n8k32.row.col.f32.e4m3.e4m3.f32"},
 };
 
 LogicalResult convertDot(TritonGPUToLLVMTypeConverter *typeConverter,
@@ -289,3 +321,110 @@ LogicalResult convertMMA16816(triton::DotOp op, triton::DotOp::Adaptor adaptor,
   return convertDot(typeConverter, rewriter, op.getLoc(), A, B, C, op.getD(),
                     loadedA, loadedB, loadedC, op, adaptor);
 }
+
+// Convert to mma.sp.m16n8k32, which multiplies an m16k16 tile of the
+// compressed A by a k32n8 tile of B, with the positions of the elements of A
+// in its 2:4 sparse k32 rows given by 32-bit metadata
+LogicalResult convertMMA16832Sparse(triton::SparseDotOp op,
+                                    triton::SparseDotOp::Adaptor adaptor,
+                                    TritonGPUToLLVMTypeConverter *typeConverter,
+                                    ConversionPatternRewriter &rewriter,
+                                    Value thread) {
+  auto loc = op.getLoc();
+  auto aTensorTy = op.getA().getType().cast<RankedTensorType>();
+  auto bTensorTy = op.getB().getType().cast<RankedTensorType>();
+  auto dTensorTy = op.getD().getType().cast<RankedTensorType>();
+  auto mmaLayout = dTensorTy.getEncoding().cast<MmaEncodingAttr>();
+
+  int bitwidth = aTensorTy.getElementType().getIntOrFloatBitWidth();
+  auto repA =
+      aTensorTy.getEncoding().cast<DotOperandEncodingAttr>().getMMAv2Rep(
+          aTensorTy.getShape(), bitwidth);
+  auto repB =
+      bTensorTy.getEncoding().cast<DotOperandEncodingAttr>().getMMAv2Rep(
+          bTensorTy.getShape(), bitwidth);
+  // every k16 step of the compressed A is a k32 step of B
+  assert(2 * repA[1] == repB[0]);
+  int repM = repA[0], repN = repB[1], repK = repA[1];
+
+  auto ha = getValuesFromDotOperandLayoutStruct(
+      typeConverter, loc, rewriter, adaptor.getA(), repM, repK, aTensorTy);
+  auto hb = getValuesFromDotOperandLayoutStruct(
+      typeConverter, loc, rewriter, adaptor.getB(), std::max(repN / 2, 1),
+      2 * repK, bTensorTy);
+  Value loadedC =
+      loadC(op.getC(), adaptor.getC(), typeConverter, loc, rewriter);
+  auto fc = typeConverter->unpackLLElements(loc, loadedC, rewriter, dTensorTy);
+
+  // With sparsity selector 0, lanes 4g and 4g + 1 hold the metadata of rows
+  // g and g + 8 of an m16 tile, which are 16 2-bit positions each: two i16
+  // of the metadata tensor.
+  auto metaSmem =
+      getSharedMemoryObjectFromStruct(loc, adaptor.getAMeta(), rewriter);
+  auto warpsPerCTA = mmaLayout.getWarpsPerCTA();
+  Value laneId = urem(thread, i32_val(32));
+  Value warpId = udiv(thread, i32_val(32));
+  SmallVector<Value> multiDimWarpId = delinearize(
+      rewriter, loc, warpId, warpsPerCTA, triton::gpu::getOrder(mmaLayout));
+  int64_t numTilesM = std::max<int64_t>(dTensorTy.getShape()[0] / 16, 1);
+  Value warpM = urem(urem(multiDimWarpId[0], i32_val(warpsPerCTA[0])),
+                     i32_val(numTilesM));
+  Value row = add(add(mul(warpM, i32_val(16)), udiv(laneId, i32_val(4))),
+                  mul(urem(laneId, i32_val(2)), i32_val(8)));
+  Type ptrTy = ptr_ty(i16_ty, 3);
+  ValueTableV2 meta;
+  for (int m = 0; m < repM; ++m)
+    for (int k = 0; k < repK; ++k) {
+      Value mRow = add(row, i32_val(m * 16 * warpsPerCTA[0]));
+      Value offset = add(mul(mRow, metaSmem.strides[0]),
+                         mul(i32_val(2 * k), metaSmem.strides[1]));
+      Value ptr = gep(ptrTy, metaSmem.base, offset);
+      Value lo = zext(i32_ty, load(ptr));
+      Value hi = zext(i32_ty, load(gep(ptrTy, ptr, metaSmem.strides[1])));
+      meta[{m, k}] = or_(lo, shl(hi, i32_val(16)));
+    }
+
+  std::string mmaInstr =
+      aTensorTy.getElementType().isBF16()
+          ? "mma.sp.sync.aligned.m16n8k32.row.col.f32.bf16.bf16.f32"
+          : "mma.sp.sync.aligned.m16n8k32.row.col.f32.f16.f16.f32";
+  Type f32x4Ty = LLVM::LLVMStructType::getLiteral(
+      op.getContext(), SmallVector<Type>(4, f32_ty));
+  auto callMma = [&](unsigned m, unsigned n, unsigned k) {
+    unsigned colsPerThread = repN * 2;
+    PTXBuilder builder;
+    auto &mma = *builder.create(mmaInstr);
+    auto retArgs = builder.newListOperand(4, "=f");
+    auto aArgs = builder.newListOperand({
+        {ha[{2 * m, 2 * k}], "r"},
+        {ha[{2 * m + 1, 2 * k}], "r"},
+        {ha[{2 * m, 2 * k + 1}], "r"},
+        {ha[{2 * m + 1, 2 * k + 1}], "r"},
+    });
+    auto bArgs = builder.newListOperand({
+        {hb[{n, 4 * k}], "r"},
+        {hb[{n, 4 * k + 1}], "r"},
+        {hb[{n, 4 * k + 2}], "r"},
+        {hb[{n, 4 * k + 3}], "r"},
+    });
+    auto cArgs = builder.newListOperand();
+    unsigned cIdx = 2 * m * colsPerThread + 4 * n;
+    for (int i = 0; i < 4; ++i)
+      cArgs->listAppend(builder.newOperand(fc[cIdx + i], std::to_string(i)));
+    auto eArg = builder.newOperand(meta[{m, k}], "r");
+    auto fArg = builder.newConstantOperand(0);
+    mma(retArgs, aArgs, bArgs, cArgs, eArg, fArg);
+    Value mmaOut = builder.launch(rewriter, loc, f32x4Ty);
+    for (int i = 0; i < 4; ++i)
+      fc[cIdx + i] = extract_val(f32_ty, mmaOut, i);
+  };
+
+  for (int k = 0; k < repK; ++k)
+    for (int m = 0; m < repM; ++m)
+      for (int n = 0; n < repN; ++n)
+        callMma(m, n, k);
+
+  Value res = typeConverter->packLLElements(loc, fc, rewriter, dTensorTy);
+  rewriter.replaceOp(op, res);
+  return success();
+}
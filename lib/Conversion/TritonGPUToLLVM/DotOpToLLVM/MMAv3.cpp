@@ -0,0 +1,218 @@
+#include "../DotOpToLLVM.h"
+#include "../Utility.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+using ::mlir::LLVM::getSharedMemoryObjectFromStruct;
+using ::mlir::triton::gpu::MmaEncodingAttr;
+using ::mlir::triton::gpu::SharedEncodingAttr;
+
+// Returns the order of the shared memory an operand of a wgmma dot is
+// converted from
+static ArrayRef<unsigned> getOperandOrder(Value operand) {
+  auto cvt = operand.getDefiningOp<triton::gpu::ConvertLayoutOp>();
+  assert(cvt && "wgmma operands are converted from shared memory");
+  return cvt.getSrc()
+      .getType()
+      .cast<RankedTensorType>()
+      .getEncoding()
+      .cast<SharedEncodingAttr>()
+      .getOrder();
+}
+
+// Swizzle modes of the wgmma matrix descriptors, by the size in bytes of the
+// shared memory rows they swizzle
+static int getMmaV3SwizzleMode(int rowBytes) {
+  switch (rowBytes) {
+  case 128:
+    return 1;
+  case 64:
+    return 2;
+  case 32:
+    return 3;
+  default:
+    llvm::report_fatal_error("Unsupported row size for wgmma operands");
+  }
+}
+
+// Returns the 64-bit matrix descriptor of the operand tile starting at `ptr`,
+// whose rows of `rowBytes` bytes are swizzled as in SharedEncodingAttr.
+// A swizzle period spans 8 rows, so the stride between the 8-row core
+// matrices is 8 * rowBytes; the leading byte offset is unused since a single
+// swizzled row covers the contiguous dimension of the tile.
+static Value getMmaV3Descriptor(ConversionPatternRewriter &rewriter,
+                                Location loc, Value ptr, int rowBytes) {
+  Value addr = ptrtoint(i32_ty, ptr);
+  Value start = udiv(and_(addr, i32_val(0x3FFFF)), i32_val(16));
+  uint64_t leadingOffset = 1;
+  uint64_t strideOffset = 8 * rowBytes / 16;
+  uint64_t mode = getMmaV3SwizzleMode(rowBytes);
+  uint64_t fields = (leadingOffset << 16) | (strideOffset << 32) | (mode << 62);
+  return or_(zext(i64_ty, start), int_val(64, fields));
+}
+
+// Returns the element types in the wgmma instruction name
+static std::string getMmaV3TypeSuffix(Type aElemTy, Type bElemTy) {
+  if (aElemTy.isF16())
+    return "f32.f16.f16";
+  if (aElemTy.isBF16())
+    return "f32.bf16.bf16";
+  if (aElemTy.isF32())
+    return "f32.tf32.tf32";
+  // supportMMA leaves e4m3 and e5m2 operands, in any combination
+  assert(isNativeFp8(aElemTy) && isNativeFp8(bElemTy) &&
+         "Unsupported operand type for wgmma");
+  auto fp8Name = [](Type t) {
+    return t.isa<mlir::Float8E5M2Type>() ? "e5m2" : "e4m3";
+  };
+  return std::string("f32.") + fp8Name(aElemTy) + "." + fp8Name(bElemTy);
+}
+
+// Returns the largest wgmma N, a multiple of 8 not greater than 256, that
+// divides the N of the dot
+static int getMmaV3InstrN(int64_t N) {
+  for (int instrN = 256; instrN >= 8; instrN -= 8)
+    if (N % instrN == 0)
+      return instrN;
+  llvm::report_fatal_error("Unsupported N for wgmma");
+}
+
+// Convert to wgmma.mma_async.m64nNk16 (k8 for tf32, k32 for fp8)
+LogicalResult convertWGMMA(triton::DotOp op, triton::DotOp::Adaptor adaptor,
+                           TritonGPUToLLVMTypeConverter *typeConverter,
+                           ConversionPatternRewriter &rewriter, Value thread) {
+  auto loc = op.getLoc();
+  auto ctx = op.getContext();
+  auto aTensorTy = op.getA().getType().cast<RankedTensorType>();
+  auto bTensorTy = op.getB().getType().cast<RankedTensorType>();
+  auto dTensorTy = op.getD().getType().cast<RankedTensorType>();
+  auto mmaLayout = dTensorTy.getEncoding().cast<MmaEncodingAttr>();
+  assert(dTensorTy.getElementType().isF32() &&
+         "wgmma is only lowered for fp32 accumulators");
+
+  auto aElemTy = aTensorTy.getElementType();
+  int bitwidth = aElemTy.getIntOrFloatBitWidth();
+  int elemBytes = bitwidth / 8;
+  auto aShape = aTensorTy.getShape();
+  auto bShape = bTensorTy.getShape();
+  int64_t M = aShape[0], K = aShape[1], N = bShape[1];
+
+  // The operands are lowered to the shared memory objects they are read from
+  auto aSmem = getSharedMemoryObjectFromStruct(loc, adaptor.getA(), rewriter);
+  auto bSmem = getSharedMemoryObjectFromStruct(loc, adaptor.getB(), rewriter);
+  auto aOrder = getOperandOrder(op.getA());
+  auto bOrder = getOperandOrder(op.getB());
+  assert(aOrder[0] == 1 && "wgmma reads A with K contiguous");
+  bool isBKMajor = bOrder[0] == 0;
+  int aRowBytes = K * elemBytes;
+  int bRowBytes = (isBKMajor ? K : N) * elemBytes;
+
+  int instrK = 256 / bitwidth;
+  int instrN = isBKMajor ? getMmaV3InstrN(N) : N;
+  assert(instrN <= 256 && "wgmma N is at most 256");
+  int numWarps = mmaLayout.getWarpsPerCTA()[0];
+  int repM = M / (16 * numWarps);
+  int repN = N / instrN;
+  // Every thread holds 4 accumulators per 8 columns of an instruction
+  int numRegs = instrN / 2;
+
+  Value warpGroup = udiv(thread, i32_val(128));
+  Value aRow = mul(warpGroup, i32_val(64));
+
+  auto fc = typeConverter->unpackLLElements(loc, adaptor.getC(), rewriter,
+                                            dTensorTy);
+  auto elemPtrTy = aSmem.base.getType();
+  std::string suffix =
+      getMmaV3TypeSuffix(aElemTy, bTensorTy.getElementType());
+  // only 16-bit operands can be read transposed
+  bool hasTranspose = bitwidth == 16;
+
+  auto callWGMMA = [&](int m, int n, int k) {
+    // A tile rows [m * 16 * numWarps + 64 * warpGroup, ... + 64), K-major
+    Value aOffset = add(mul(add(aRow, i32_val(m * 16 * numWarps)), i32_val(K)),
+                        i32_val(k * instrK));
+    // B tile columns [n * instrN, (n + 1) * instrN)
+    Value bOffset = isBKMajor ? i32_val(n * instrN * K + k * instrK)
+                              : i32_val(k * instrK * N);
+    Value aDesc = getMmaV3Descriptor(
+        rewriter, loc, gep(elemPtrTy, aSmem.base, aOffset), aRowBytes);
+    Value bDesc = getMmaV3Descriptor(
+        rewriter, loc,
+        gep(bSmem.base.getType(), bSmem.base, bOffset), bRowBytes);
+
+    PTXBuilder builder;
+    SmallVector<PTXBuilder::Operand *> operands;
+    for (int i = 0; i < numRegs; ++i)
+      operands.push_back(builder.newOperand("=f"));
+    int cBase = (m * repN + n) * numRegs;
+    for (int i = 0; i < numRegs; ++i)
+      operands.push_back(builder.newOperand(fc[cBase + i], std::to_string(i)));
+    operands.push_back(builder.newOperand(aDesc, "l"));
+    operands.push_back(builder.newOperand(bDesc, "l"));
+    operands.push_back(builder.newOperand(i32_val(1), "r"));
+
+    std::string dRegs;
+    for (int i = 0; i < numRegs; ++i)
+      dRegs += (i ? ", $" : "$") + std::to_string(i);
+    std::string aDescReg = "$" + std::to_string(2 * numRegs);
+    std::string bDescReg = "$" + std::to_string(2 * numRegs + 1);
+    std::string scaleReg = "$" + std::to_string(2 * numRegs + 2);
+    // scale-d is a predicate: accumulate into the C of the dot
+    std::string ptx = "{\n"
+                      ".reg .pred p;\n"
+                      "setp.ne.b32 p, " +
+                      scaleReg + ", 0;\n"
+                      "wgmma.mma_async.sync.aligned.m64n" +
+                      std::to_string(instrN) + "k" + std::to_string(instrK) +
+                      "." + suffix + " {" + dRegs + "}, " + aDescReg + ", " +
+                      bDescReg + ", p, 1, 1";
+    if (hasTranspose)
+      ptx += std::string(", 0, ") + (isBKMajor ? "0" : "1");
+    ptx += ";\n}";
+    auto &wgmma = *builder.create(ptx);
+    wgmma(operands, /*onlyAttachMLIRArgs=*/true);
+    Value res = builder.launch(rewriter, loc,
+                               struct_ty(SmallVector<Type>(numRegs, f32_ty)));
+    for (int i = 0; i < numRegs; ++i)
+      fc[cBase + i] = extract_val(f32_ty, res, i);
+  };
+
+  auto emitNoOperands = [&](const std::string &instr) {
+    PTXBuilder builder;
+    auto &ptxOp = *builder.create<>(instr);
+    ptxOp();
+    builder.launch(rewriter, loc, void_ty(ctx));
+  };
+
+  // The operands were written to shared memory by the generic proxy
+  emitNoOperands("fence.proxy.async.shared::cta");
+  emitNoOperands("wgmma.fence.sync.aligned");
+  for (int k = 0; k < K / instrK; ++k)
+    for (int m = 0; m < repM; ++m)
+      for (int n = 0; n < repN; ++n)
+        callWGMMA(m, n, k);
+  emitNoOperands("wgmma.commit_group.sync.aligned");
+
+  // Wait for the group, passing the accumulators through the wait so that
+  // they are not read before it
+  PTXBuilder builder;
+  SmallVector<PTXBuilder::Operand *> operands;
+  for (int i = 0; i < fc.size(); ++i)
+    operands.push_back(builder.newOperand("=f"));
+  for (int i = 0; i < fc.size(); ++i)
+    operands.push_back(builder.newOperand(fc[i], std::to_string(i)));
+  auto &wait = *builder.create("wgmma.wait_group.sync.aligned 0;");
+  wait(operands, /*onlyAttachMLIRArgs=*/true);
+  Value waited = builder.launch(
+      rewriter, loc, struct_ty(SmallVector<Type>(fc.size(), f32_ty)));
+  SmallVector<Value> results(fc.size());
+  for (int i = 0; i < fc.size(); ++i)
+    results[i] = extract_val(f32_ty, waited, i);
+
+  Value res = typeConverter->packLLElements(
+      loc, results, rewriter,
+      struct_ty(SmallVector<Type>(results.size(), f32_ty)));
+  rewriter.replaceOp(op, res);
+  return success();
+}
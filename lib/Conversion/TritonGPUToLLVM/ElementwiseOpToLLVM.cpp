@@ -1,4 +1,5 @@
 #include "ElementwiseOpToLLVM.h"
+#include "triton/Analysis/Uniformity.h"
 
 using namespace mlir;
 using namespace mlir::triton;
@@ -263,6 +264,57 @@ const std::string Bf16_to_Fp8E4M3 =
     "or.b32 $0, nosign, sign;                    \n" // restore sign
     "}";
 
+/* ----- FP8 in hardware ------ */
+// sm_89+ converts packed FP8E4M3 and FP8E5M2 pairs with cvt, denormals
+// included. Down-casts always saturate to the largest finite value.
+
+const std::string Fp8E4M3_to_Fp16_HW = "{                              \n"
+                                       ".reg .b16 a<2>;                \n"
+                                       "mov.b32 {a0, a1}, $2;          \n"
+                                       "cvt.rn.f16x2.e4m3x2 $0, a0;    \n"
+                                       "cvt.rn.f16x2.e4m3x2 $1, a1;    \n"
+                                       "}";
+
+const std::string Fp8E5M2_to_Fp16_HW = "{                              \n"
+                                       ".reg .b16 a<2>;                \n"
+                                       "mov.b32 {a0, a1}, $2;          \n"
+                                       "cvt.rn.f16x2.e5m2x2 $0, a0;    \n"
+                                       "cvt.rn.f16x2.e5m2x2 $1, a1;    \n"
+                                       "}";
+
+const std::string Fp16_to_Fp8E4M3_HW =
+    "{                                      \n"
+    ".reg .b16 a<2>;                        \n"
+    "cvt.rn.satfinite.e4m3x2.f16x2 a0, $1;  \n"
+    "cvt.rn.satfinite.e4m3x2.f16x2 a1, $2;  \n"
+    "mov.b32 $0, {a0, a1};                  \n"
+    "}";
+
+const std::string Fp16_to_Fp8E5M2_HW =
+    "{                                      \n"
+    ".reg .b16 a<2>;                        \n"
+    "cvt.rn.satfinite.e5m2x2.f16x2 a0, $1;  \n"
+    "cvt.rn.satfinite.e5m2x2.f16x2 a1, $2;  \n"
+    "mov.b32 $0, {a0, a1};                  \n"
+    "}";
+
+// The first source of cvt goes to the upper half of the result
+const std::string Fp32_to_Fp8E4M3_HW =
+    "{                                      \n"
+    ".reg .b16 a<2>;                        \n"
+    "cvt.rn.satfinite.e4m3x2.f32 a0, $2, $1; \n"
+    "cvt.rn.satfinite.e4m3x2.f32 a1, $4, $3; \n"
+    "mov.b32 $0, {a0, a1};                  \n"
+    "}";
+
+const std::string Fp32_to_Fp8E5M2_HW =
+    "{                                      \n"
+    ".reg .b16 a<2>;                        \n"
+    "cvt.rn.satfinite.e5m2x2.f32 a0, $2, $1; \n"
+    "cvt.rn.satfinite.e5m2x2.f32 a1, $4, $3; \n"
+    "mov.b32 $0, {a0, a1};                  \n"
+    "}";
+
 /* ----- Packed integer to BF16 ------ */
 const std::string S8_to_Bf16 =
     "{                                           \n"
@@ -480,6 +532,10 @@ public:
 //
 // Also supports processing the inputs in a vectorized form by consuming and
 // producing multiple operand sets in ConcreteT::createDestOps.
+//
+// When a thread holds a single distinct element of the result, as per the
+// uniformity analysis, and the op has no side effects, that element is
+// computed once and reused for all of them.
 template <typename SourceOp, typename ConcreteT>
 class ElementwiseOpConversionBase
     : public ConvertTritonGPUOpToLLVMPattern<SourceOp> {
@@ -487,8 +543,10 @@ public:
   using OpAdaptor = typename SourceOp::Adaptor;
 
   explicit ElementwiseOpConversionBase(
-      TritonGPUToLLVMTypeConverter &typeConverter, PatternBenefit benefit = 1)
-      : ConvertTritonGPUOpToLLVMPattern<SourceOp>(typeConverter, benefit) {}
+      TritonGPUToLLVMTypeConverter &typeConverter,
+      ModuleAxisInfoAnalysis &axisAnalysisPass, PatternBenefit benefit = 1)
+      : ConvertTritonGPUOpToLLVMPattern<SourceOp>(typeConverter, benefit),
+        uniformityAnalysis(axisAnalysisPass) {}
 
   LogicalResult
   matchAndRewrite(SourceOp op, OpAdaptor adaptor,
@@ -499,10 +557,10 @@ public:
     auto resultElementTy = getElementTypeOrSelf(resultTy);
     Type elemTy = this->getTypeConverter()->convertType(resultElementTy);
     SmallVector<SmallVector<Value>> allOperands;
-    for (auto operand : adaptor.getOperands()) {
-      auto argTy = op->getOperand(0).getType();
+    for (auto operand : llvm::enumerate(adaptor.getOperands())) {
+      auto argTy = op->getOperand(operand.index()).getType();
       auto subOperands = this->getTypeConverter()->unpackLLElements(
-          loc, operand, rewriter, argTy);
+          loc, operand.value(), rewriter, argTy);
       subOperands = unpackI32(subOperands, argTy, rewriter, loc,
                               this->getTypeConverter());
       allOperands.resize(subOperands.size());
@@ -513,17 +571,46 @@ public:
       allOperands.push_back({});
 
     SmallVector<Value> resultVals;
-    for (auto it = allOperands.begin(), end = allOperands.end(); it != end;) {
+    if (allOperands.size() > 1 && isMemoryEffectFree(op) &&
+        uniformityAnalysis.isUniformPerThread(op->getResult(0))) {
       auto curr = static_cast<const ConcreteT *>(this)->createDestOps(
-          op, adaptor, rewriter, elemTy, MultipleOperandsRange(it, end), loc);
-      if (curr.size() == 0)
+          op, adaptor, rewriter, elemTy,
+          MultipleOperandsRange(allOperands.begin(), allOperands.end()), loc);
+      if (curr.size() == 0 || !static_cast<bool>(curr[0]))
         return failure();
-      for (auto v : curr) {
-        if (!static_cast<bool>(v))
+      resultVals.assign(allOperands.size(), curr[0]);
+    } else {
+      // Broadcasts hold the same value in every position they replicate, so
+      // elements whose operands are the same values have the same result,
+      // computed once when the op converts one element at a time
+      bool computeOnce = isMemoryEffectFree(op);
+      DenseMap<ArrayRef<Value>, Value> computed;
+      for (auto it = allOperands.begin(), end = allOperands.end();
+           it != end;) {
+        if (computeOnce) {
+          if (Value v = computed.lookup(*it)) {
+            resultVals.push_back(v);
+            ++it;
+            continue;
+          }
+        }
+        auto curr = static_cast<const ConcreteT *>(this)->createDestOps(
+            op, adaptor, rewriter, elemTy, MultipleOperandsRange(it, end),
+            loc);
+        if (curr.size() == 0)
           return failure();
-        resultVals.push_back(v);
+        for (auto v : curr) {
+          if (!static_cast<bool>(v))
+            return failure();
+          resultVals.push_back(v);
+        }
+        // ops converting packs of elements rely on their alignment
+        if (curr.size() > 1)
+          computeOnce = false;
+        else if (computeOnce && !it->empty())
+          computed[*it] = curr[0];
+        it += curr.size();
       }
-      it += curr.size();
     }
     if (op->getNumOperands() > 0) {
       auto argTy = op->getOperand(0).getType();
@@ -537,6 +624,9 @@ public:
 
     return success();
   }
+
+private:
+  UniformityAnalysis uniformityAnalysis;
 };
 
 template <typename SourceOp, typename DestOp>
@@ -550,9 +640,10 @@ struct ElementwiseOpConversion
   using OpAdaptor = typename Base::OpAdaptor;
 
   explicit ElementwiseOpConversion(LLVMTypeConverter &typeConverter,
+                                   ModuleAxisInfoAnalysis &axisAnalysisPass,
                                    PatternBenefit benefit = 1)
       : ElementwiseOpConversionBase<SourceOp, ElementwiseOpConversion>(
-            typeConverter, benefit) {}
+            typeConverter, axisAnalysisPass, benefit) {}
 
   // An interface to support variant DestOp builder.
   SmallVector<DestOp> createDestOps(SourceOp op, OpAdaptor adaptor,
@@ -567,8 +658,11 @@ struct ElementwiseOpConversion
 // Attempts to use vectorized conversions via inline PTX when possible.
 struct FpToFpOpConversion
     : public ElementwiseOpConversionBase<triton::FpToFpOp, FpToFpOpConversion> {
-  using ElementwiseOpConversionBase<
-      triton::FpToFpOp, FpToFpOpConversion>::ElementwiseOpConversionBase;
+  FpToFpOpConversion(TritonGPUToLLVMTypeConverter &typeConverter,
+                     ModuleAxisInfoAnalysis &axisAnalysisPass,
+                     int computeCapability, PatternBenefit benefit)
+      : ElementwiseOpConversionBase(typeConverter, axisAnalysisPass, benefit),
+        computeCapability(computeCapability) {}
 
   static Value convertBf16ToFp32(Location loc,
                                  ConversionPatternRewriter &rewriter,
@@ -616,6 +710,34 @@ struct FpToFpOpConversion
     return builder.launch(rewriter, loc, f16_ty, false);
   }
 
+  // Returns the packed hardware conversion from `srcTy` to `dstTy`, if sm_89+
+  // has one with the semantics asked for; down-casts need `saturate`.
+  std::optional<std::string> getHWConversion(Type srcTy, Type dstTy,
+                                             bool saturate) const {
+    if (computeCapability < 89)
+      return std::nullopt;
+    auto F8E4M3TyID = TypeID::get<mlir::Float8E4M3FNUZType>();
+    auto F8E5M2TyID = TypeID::get<mlir::Float8E5M2Type>();
+    auto F16TyID = TypeID::get<mlir::Float16Type>();
+    auto F32TyID = TypeID::get<mlir::Float32Type>();
+    static DenseMap<std::pair<TypeID, TypeID>, std::string> upcastMap = {
+        {{F8E4M3TyID, F16TyID}, Fp8E4M3_to_Fp16_HW},
+        {{F8E5M2TyID, F16TyID}, Fp8E5M2_to_Fp16_HW},
+    };
+    static DenseMap<std::pair<TypeID, TypeID>, std::string> downcastMap = {
+        {{F16TyID, F8E4M3TyID}, Fp16_to_Fp8E4M3_HW},
+        {{F16TyID, F8E5M2TyID}, Fp16_to_Fp8E5M2_HW},
+        {{F32TyID, F8E4M3TyID}, Fp32_to_Fp8E4M3_HW},
+        {{F32TyID, F8E5M2TyID}, Fp32_to_Fp8E5M2_HW},
+    };
+    std::pair<TypeID, TypeID> key = {srcTy.getTypeID(), dstTy.getTypeID()};
+    if (upcastMap.count(key))
+      return upcastMap.lookup(key);
+    if (saturate && downcastMap.count(key))
+      return downcastMap.lookup(key);
+    return std::nullopt;
+  }
+
   ConverterT getConversionFunc(Type srcTy, Type dstTy) const {
     auto F8E4M3B15TyID = TypeID::get<mlir::Float8E4M3B11FNUZType>();
     auto F8E4M3TyID = TypeID::get<mlir::Float8E4M3FNUZType>();
@@ -662,8 +784,19 @@ struct FpToFpOpConversion
     auto dstElementType = getElementType(op.getResult());
     bool isSrcFP32 = srcElementType.isF32();
     bool isDstFP32 = dstElementType.isF32();
-    auto cvtFunc = getConversionFunc(isSrcFP32 ? f16_ty : srcElementType,
-                                     isDstFP32 ? f16_ty : dstElementType);
+    // f32 is down-cast directly by the hardware, and through f16 otherwise
+    auto ptx = getHWConversion(srcElementType, dstElementType,
+                               op.getSaturate());
+    if (ptx)
+      isSrcFP32 = false;
+    Type srcTy = isSrcFP32 ? f16_ty : srcElementType;
+    Type dstTy = isDstFP32 ? f16_ty : dstElementType;
+    if (!ptx)
+      ptx = getHWConversion(srcTy, dstTy, op.getSaturate());
+    auto cvtFunc = ptx ? makeConverterFromPtx(
+                             *ptx, getTypeConverter()->convertType(srcTy),
+                             getTypeConverter()->convertType(dstTy))
+                       : getConversionFunc(srcTy, dstTy);
     SmallVector<Value> inVals = {operands[0][0], operands[1][0], operands[2][0],
                                  operands[3][0]};
     if (isSrcFP32)
@@ -678,6 +811,9 @@ struct FpToFpOpConversion
     // Pack values
     return outVals;
   }
+
+private:
+  int computeCapability;
 };
 
 struct CmpIOpConversion
@@ -853,12 +989,72 @@ struct FDivOpConversion
   }
 };
 
+// Applies the binary DestOp to the first two operand sets of `operands` at
+// once, as vectors of two f16s, which NVPTX selects into f16x2 instructions
+// (and contracts into fma.rn.f16x2).
+template <typename DestOp>
+static SmallVector<Value> emitF16x2Op(Location loc,
+                                      ConversionPatternRewriter &rewriter,
+                                      MultipleOperandsRange operands) {
+  auto vecTy = vec_ty(f16_ty, 2);
+  SmallVector<Value> vecOperands;
+  for (unsigned i = 0; i < 2; ++i) {
+    Value vec = undef(vecTy);
+    for (unsigned j = 0; j < 2; ++j)
+      vec = insert_element(vecTy, vec, operands[j][i], i32_val(j));
+    vecOperands.push_back(vec);
+  }
+  Value res =
+      rewriter.create<DestOp>(loc, vecTy, vecOperands[0], vecOperands[1]);
+  return {extract_element(f16_ty, res, i32_val(0)),
+          extract_element(f16_ty, res, i32_val(1))};
+}
+
+// Applies the binary `ptxAsm` to the first two operand sets of `operands` at
+// once, with the bf16s of both sets packed into bf16x2 registers.
+static SmallVector<Value> emitBf16x2Op(Location loc,
+                                       ConversionPatternRewriter &rewriter,
+                                       MultipleOperandsRange operands,
+                                       const char *ptxAsm) {
+  auto vecTy = vec_ty(i16_ty, 2);
+  PTXBuilder builder;
+  auto &inst = *builder.create<PTXInstr>(ptxAsm);
+  SmallVector<PTXBuilder::Operand *> oprs = {builder.newOperand("=r")};
+  for (unsigned i = 0; i < 2; ++i) {
+    Value vec = undef(vecTy);
+    for (unsigned j = 0; j < 2; ++j)
+      vec = insert_element(vecTy, vec, operands[j][i], i32_val(j));
+    oprs.push_back(builder.newOperand(bitcast(vec, i32_ty), "r"));
+  }
+  inst(oprs, /*onlyAttachMLIRArgs=*/true);
+  Value res = bitcast(builder.launch(rewriter, loc, i32_ty, false), vecTy);
+  return {extract_element(i16_ty, res, i32_val(0)),
+          extract_element(i16_ty, res, i32_val(1))};
+}
+
+// Base of the half-precision binary arithmetic conversions, which process
+// the elements of a thread in pairs with f16x2/bf16x2 instructions. bf16x2
+// add, sub and mul need sm_90 and are fused multiply-adds with a constant
+// before.
+template <typename SourceOp, typename ConcreteT>
+struct Half2OpConversionBase
+    : ElementwiseOpConversionBase<SourceOp, ConcreteT> {
+  using Base = ElementwiseOpConversionBase<SourceOp, ConcreteT>;
+  using OpAdaptor = typename Base::OpAdaptor;
+
+  Half2OpConversionBase(TritonGPUToLLVMTypeConverter &typeConverter,
+                        ModuleAxisInfoAnalysis &axisAnalysisPass,
+                        int computeCapability, PatternBenefit benefit)
+      : Base(typeConverter, axisAnalysisPass, benefit),
+        computeCapability(computeCapability) {}
+
+protected:
+  int computeCapability;
+};
+
 struct FMulOpConversion
-    : ElementwiseOpConversionBase<mlir::arith::MulFOp, FMulOpConversion> {
-  using Base =
-      ElementwiseOpConversionBase<mlir::arith::MulFOp, FMulOpConversion>;
-  using Base::Base;
-  using Adaptor = typename Base::OpAdaptor;
+    : Half2OpConversionBase<mlir::arith::MulFOp, FMulOpConversion> {
+  using Half2OpConversionBase::Half2OpConversionBase;
 
   SmallVector<Value> createDestOps(mlir::arith::MulFOp op, OpAdaptor adaptor,
                                    ConversionPatternRewriter &rewriter,
@@ -867,6 +1063,13 @@ struct FMulOpConversion
     auto lhsElemTy = getElementType(op.getLhs());
     auto rhsElemTy = getElementType(op.getRhs());
     if (lhsElemTy.isBF16() && rhsElemTy.isBF16()) {
+      if (operands.size() >= 2)
+        return emitBf16x2Op(loc, rewriter, operands,
+                            computeCapability >= 90
+                                ? "mul.rn.bf16x2 $0, $1, $2;"
+                                : "{ .reg .b32 c;             \n"
+                                  "  mov.b32 c, 0x80008000U;  \n" // 0.0
+                                  "  fma.rn.bf16x2 $0, $1, $2, c; } \n");
       PTXBuilder builder;
       auto ptxAsm = " { .reg .b16 c;        \n"
                     "    mov.b16 c, 0x8000U; \n" // 0.0
@@ -877,6 +1080,8 @@ struct FMulOpConversion
       auto rhs = builder.newOperand(operands[0][1], "h");
       fMul({res, lhs, rhs}, /*onlyAttachMLIRArgs=*/true);
       return {builder.launch(rewriter, loc, i16_ty, false)};
+    } else if (elemTy.isF16() && operands.size() >= 2) {
+      return emitF16x2Op<LLVM::FMulOp>(loc, rewriter, operands);
     } else {
       return {rewriter.create<LLVM::FMulOp>(loc, elemTy, operands[0][0],
                                             operands[0][1])};
@@ -885,11 +1090,8 @@ struct FMulOpConversion
 };
 
 struct FAddOpConversion
-    : ElementwiseOpConversionBase<mlir::arith::AddFOp, FAddOpConversion> {
-  using Base =
-      ElementwiseOpConversionBase<mlir::arith::AddFOp, FAddOpConversion>;
-  using Base::Base;
-  using Adaptor = typename Base::OpAdaptor;
+    : Half2OpConversionBase<mlir::arith::AddFOp, FAddOpConversion> {
+  using Half2OpConversionBase::Half2OpConversionBase;
 
   SmallVector<Value> createDestOps(mlir::arith::AddFOp op, OpAdaptor adaptor,
                                    ConversionPatternRewriter &rewriter,
@@ -898,6 +1100,13 @@ struct FAddOpConversion
     auto lhsElemTy = getElementType(op.getLhs());
     auto rhsElemTy = getElementType(op.getRhs());
     if (lhsElemTy.isBF16() && rhsElemTy.isBF16()) {
+      if (operands.size() >= 2)
+        return emitBf16x2Op(loc, rewriter, operands,
+                            computeCapability >= 90
+                                ? "add.rn.bf16x2 $0, $1, $2;"
+                                : "{ .reg .b32 c;             \n"
+                                  "  mov.b32 c, 0x3f803f80U;  \n" // 1.0
+                                  "  fma.rn.bf16x2 $0, $1, c, $2; } \n");
       PTXBuilder builder;
       auto ptxAsm = "{ .reg .b16 c;         \n"
                     "   mov.b16 c, 0x3f80U; \n" // 1.0
@@ -908,6 +1117,8 @@ struct FAddOpConversion
       auto rhs = builder.newOperand(operands[0][1], "h");
       fAdd({res, lhs, rhs}, /*onlyAttachMLIRArgs=*/true);
       return {builder.launch(rewriter, loc, i16_ty, false)};
+    } else if (elemTy.isF16() && operands.size() >= 2) {
+      return emitF16x2Op<LLVM::FAddOp>(loc, rewriter, operands);
     } else {
       return {rewriter.create<LLVM::FAddOp>(loc, elemTy, operands[0][0],
                                             operands[0][1])};
@@ -916,11 +1127,8 @@ struct FAddOpConversion
 };
 
 struct FSubOpConversion
-    : ElementwiseOpConversionBase<mlir::arith::SubFOp, FSubOpConversion> {
-  using Base =
-      ElementwiseOpConversionBase<mlir::arith::SubFOp, FSubOpConversion>;
-  using Base::Base;
-  using Adaptor = typename Base::OpAdaptor;
+    : Half2OpConversionBase<mlir::arith::SubFOp, FSubOpConversion> {
+  using Half2OpConversionBase::Half2OpConversionBase;
 
   SmallVector<Value> createDestOps(mlir::arith::SubFOp op, OpAdaptor adaptor,
                                    ConversionPatternRewriter &rewriter,
@@ -929,6 +1137,13 @@ struct FSubOpConversion
     auto lhsElemTy = getElementType(op.getLhs());
     auto rhsElemTy = getElementType(op.getRhs());
     if (lhsElemTy.isBF16() && rhsElemTy.isBF16()) {
+      if (operands.size() >= 2)
+        return emitBf16x2Op(loc, rewriter, operands,
+                            computeCapability >= 90
+                                ? "sub.rn.bf16x2 $0, $1, $2;"
+                                : "{ .reg .b32 c;             \n"
+                                  "  mov.b32 c, 0xbf80bf80U;  \n" // -1.0
+                                  "  fma.rn.bf16x2 $0, $2, c, $1; } \n");
       PTXBuilder builder;
       auto ptxAsm = " { .reg .b16 c;         \n"
                     "    mov.b16 c, 0xbf80U; \n" // -1.0
@@ -939,6 +1154,8 @@ struct FSubOpConversion
       auto rhs = builder.newOperand(operands[0][1], "h");
       fSub({res, lhs, rhs}, /*onlyAttachMLIRArgs=*/true);
       return {builder.launch(rewriter, loc, i16_ty, false)};
+    } else if (elemTy.isF16() && operands.size() >= 2) {
+      return emitF16x2Op<LLVM::FSubOp>(loc, rewriter, operands);
     } else {
       return {rewriter.create<LLVM::FSubOp>(loc, elemTy, operands[0][0],
                                             operands[0][1])};
@@ -1045,6 +1262,9 @@ struct TruncFOpConversion
   }
 };
 
+constexpr double log2e = 1.4426950408889634;
+constexpr double ln2 = 0.6931471805599453;
+
 struct ExpOpConversionApprox
     : ElementwiseOpConversionBase<mlir::math::ExpOp, ExpOpConversionApprox> {
   using Base =
@@ -1060,7 +1280,6 @@ struct ExpOpConversionApprox
     if (elemTy.getIntOrFloatBitWidth() != 32)
       return {};
 
-    const double log2e = 1.4426950408889634;
     Value prod = fmul(f32_ty, operands[0][0], f32_val(log2e));
 
     PTXBuilder ptxBuilder;
@@ -1072,6 +1291,109 @@ struct ExpOpConversionApprox
   }
 };
 
+// Emits the approximate f32 PTX instruction `instr` on `operands`, with its
+// single operand scaled by `inScale` and its result by `outScale`.
+static Value emitApproxF32(Location loc, ConversionPatternRewriter &rewriter,
+                           StringRef instr, ValueRange operands,
+                           double inScale = 1.0, double outScale = 1.0) {
+  PTXBuilder ptxBuilder;
+  auto &approx = *ptxBuilder.create<PTXInstr>(instr.str());
+  SmallVector<PTXBuilder::Operand *> oprs = {ptxBuilder.newOperand("=f")};
+  for (Value operand : operands) {
+    if (inScale != 1.0)
+      operand = fmul(f32_ty, operand, f32_val(inScale));
+    oprs.push_back(ptxBuilder.newOperand(operand, "f"));
+  }
+  approx(oprs);
+  Value ret = ptxBuilder.launch(rewriter, loc, f32_ty, false);
+  if (outScale != 1.0)
+    ret = fmul(f32_ty, ret, f32_val(outScale));
+  return ret;
+}
+
+// With fast math, lowers f32 SourceOp to an approximate PTX instruction that
+// flushes denormals to zero. Other types are left to the precise patterns.
+template <typename SourceOp>
+struct FastMathOpConversion
+    : ElementwiseOpConversionBase<SourceOp, FastMathOpConversion<SourceOp>> {
+  using Base =
+      ElementwiseOpConversionBase<SourceOp, FastMathOpConversion<SourceOp>>;
+  using OpAdaptor = typename Base::OpAdaptor;
+
+  FastMathOpConversion(TritonGPUToLLVMTypeConverter &typeConverter,
+                       ModuleAxisInfoAnalysis &axisAnalysisPass,
+                       StringRef instr, double inScale, double outScale,
+                       PatternBenefit benefit)
+      : Base(typeConverter, axisAnalysisPass, benefit), instr(instr.str()),
+        inScale(inScale), outScale(outScale) {}
+
+  SmallVector<Value> createDestOps(SourceOp op, OpAdaptor adaptor,
+                                   ConversionPatternRewriter &rewriter,
+                                   Type elemTy, MultipleOperandsRange operands,
+                                   Location loc) const {
+    if (!elemTy.isF32())
+      return {};
+    return {emitApproxF32(loc, rewriter, instr, operands[0], inScale,
+                          outScale)};
+  }
+
+private:
+  std::string instr;
+  double inScale;
+  double outScale;
+};
+
+// With fast math, lowers the calls to the f32 libdevice functions that have
+// an approximate PTX instruction to that instruction.
+template <typename T>
+struct FastMathExternElementwiseOpConversion
+    : ElementwiseOpConversionBase<T, FastMathExternElementwiseOpConversion<T>> {
+  using Base =
+      ElementwiseOpConversionBase<T, FastMathExternElementwiseOpConversion<T>>;
+  using OpAdaptor = typename Base::OpAdaptor;
+
+  FastMathExternElementwiseOpConversion(
+      TritonGPUToLLVMTypeConverter &typeConverter,
+      ModuleAxisInfoAnalysis &axisAnalysisPass, int computeCapability,
+      PatternBenefit benefit)
+      : Base(typeConverter, axisAnalysisPass, benefit),
+        computeCapability(computeCapability) {}
+
+  SmallVector<Value> createDestOps(T op, OpAdaptor adaptor,
+                                   ConversionPatternRewriter &rewriter,
+                                   Type elemTy, MultipleOperandsRange operands,
+                                   Location loc) const {
+    struct Approx {
+      const char *instr;
+      double inScale;
+      double outScale;
+    };
+    static const llvm::StringMap<Approx> approxs = {
+        {"__nv_fdividef", {"div.approx.ftz.f32", 1.0, 1.0}},
+        {"__nv_sqrtf", {"sqrt.approx.ftz.f32", 1.0, 1.0}},
+        {"__nv_rsqrtf", {"rsqrt.approx.ftz.f32", 1.0, 1.0}},
+        {"__nv_exp2f", {"ex2.approx.ftz.f32", 1.0, 1.0}},
+        {"__nv_expf", {"ex2.approx.ftz.f32", log2e, 1.0}},
+        {"__nv_log2f", {"lg2.approx.ftz.f32", 1.0, 1.0}},
+        {"__nv_logf", {"lg2.approx.ftz.f32", 1.0, ln2}},
+        {"__nv_sinf", {"sin.approx.ftz.f32", 1.0, 1.0}},
+        {"__nv_cosf", {"cos.approx.ftz.f32", 1.0, 1.0}},
+        {"__nv_tanhf", {"tanh.approx.f32", 1.0, 1.0}},
+    };
+    auto it = approxs.find(op.getSymbol());
+    if (!elemTy.isF32() || it == approxs.end())
+      return {};
+    // tanh.approx needs sm_75
+    if (op.getSymbol() == "__nv_tanhf" && computeCapability < 75)
+      return {};
+    return {emitApproxF32(loc, rewriter, it->second.instr, operands[0],
+                          it->second.inScale, it->second.outScale)};
+  }
+
+private:
+  int computeCapability;
+};
+
 struct AbsIOpConversion
     : ElementwiseOpConversionBase<mlir::math::AbsIOp, AbsIOpConversion> {
   using Base =
@@ -1149,15 +1471,18 @@ struct IndexCastOpLowering
 
 void populateElementwiseOpToLLVMPatterns(
     TritonGPUToLLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
-    PatternBenefit benefit) {
+    ModuleAxisInfoAnalysis &axisInfoAnalysis, int computeCapability,
+    bool fastMath, PatternBenefit benefit) {
 #define POPULATE_TERNARY_OP(SRC_OP, DST_OP)                                    \
-  patterns.add<ElementwiseOpConversion<SRC_OP, DST_OP>>(typeConverter, benefit);
+  patterns.add<ElementwiseOpConversion<SRC_OP, DST_OP>>(                       \
+      typeConverter, axisInfoAnalysis, benefit);
   POPULATE_TERNARY_OP(triton::gpu::SelectOp, LLVM::SelectOp)
   POPULATE_TERNARY_OP(arith::SelectOp, LLVM::SelectOp)
 #undef POPULATE_TERNARY_OP
 
 #define POPULATE_BINARY_OP(SRC_OP, DST_OP)                                     \
-  patterns.add<ElementwiseOpConversion<SRC_OP, DST_OP>>(typeConverter, benefit);
+  patterns.add<ElementwiseOpConversion<SRC_OP, DST_OP>>(                       \
+      typeConverter, axisInfoAnalysis, benefit);
   POPULATE_BINARY_OP(arith::SubIOp, LLVM::SubOp) // -
   POPULATE_BINARY_OP(arith::AddIOp, LLVM::AddOp) // +
   POPULATE_BINARY_OP(arith::MulIOp, LLVM::MulOp) // *
@@ -1177,7 +1502,8 @@ void populateElementwiseOpToLLVMPatterns(
 #undef POPULATE_BINARY_OP
 
 #define POPULATE_UNARY_OP(SRC_OP, DST_OP)                                      \
-  patterns.add<ElementwiseOpConversion<SRC_OP, DST_OP>>(typeConverter, benefit);
+  patterns.add<ElementwiseOpConversion<SRC_OP, DST_OP>>(                       \
+      typeConverter, axisInfoAnalysis, benefit);
   POPULATE_UNARY_OP(arith::TruncIOp, LLVM::TruncOp)
   POPULATE_UNARY_OP(arith::ExtSIOp, LLVM::SExtOp)
   POPULATE_UNARY_OP(arith::ExtUIOp, LLVM::ZExtOp)
@@ -1193,32 +1519,64 @@ void populateElementwiseOpToLLVMPatterns(
   POPULATE_UNARY_OP(triton::PtrToIntOp, LLVM::PtrToIntOp)
 #undef POPULATE_UNARY_OP
 
-  patterns.add<AbsIOpConversion>(typeConverter, benefit);
-  patterns.add<AbsFOpConversion>(typeConverter, benefit);
-  patterns.add<CmpIOpConversion>(typeConverter, benefit);
-  patterns.add<CmpFOpConversion>(typeConverter, benefit);
-
-  patterns.add<FDivOpConversion>(typeConverter, benefit);
-  patterns.add<FSubOpConversion>(typeConverter, benefit);
-  patterns.add<FAddOpConversion>(typeConverter, benefit);
-  patterns.add<FMulOpConversion>(typeConverter, benefit);
-
-  patterns.add<ExtFOpConversion>(typeConverter, benefit);
-  patterns.add<TruncFOpConversion>(typeConverter, benefit);
-  patterns.add<FPToSIOpConversion>(typeConverter, benefit);
-  patterns.add<SIToFPOpConversion>(typeConverter, benefit);
-  patterns.add<IndexCastOpLowering>(typeConverter, benefit);
-
-  patterns.add<FpToFpOpConversion>(typeConverter, benefit);
+  patterns.add<AbsIOpConversion>(typeConverter, axisInfoAnalysis, benefit);
+  patterns.add<AbsFOpConversion>(typeConverter, axisInfoAnalysis, benefit);
+  patterns.add<CmpIOpConversion>(typeConverter, axisInfoAnalysis, benefit);
+  patterns.add<CmpFOpConversion>(typeConverter, axisInfoAnalysis, benefit);
+
+  patterns.add<FDivOpConversion>(typeConverter, axisInfoAnalysis, benefit);
+  patterns.add<FSubOpConversion>(typeConverter, axisInfoAnalysis,
+                                computeCapability, benefit);
+  patterns.add<FAddOpConversion>(typeConverter, axisInfoAnalysis,
+                                computeCapability, benefit);
+  patterns.add<FMulOpConversion>(typeConverter, axisInfoAnalysis,
+                                computeCapability, benefit);
+
+  patterns.add<ExtFOpConversion>(typeConverter, axisInfoAnalysis, benefit);
+  patterns.add<TruncFOpConversion>(typeConverter, axisInfoAnalysis, benefit);
+  patterns.add<FPToSIOpConversion>(typeConverter, axisInfoAnalysis, benefit);
+  patterns.add<SIToFPOpConversion>(typeConverter, axisInfoAnalysis, benefit);
+  patterns.add<IndexCastOpLowering>(typeConverter, axisInfoAnalysis,
+                                   benefit);
+
+  patterns.add<FpToFpOpConversion>(typeConverter, axisInfoAnalysis,
+                                  computeCapability, benefit);
 
   patterns.add<ExternElementwiseOpConversion<triton::PureExternElementwiseOp>>(
-      typeConverter, benefit);
+      typeConverter, axisInfoAnalysis, benefit);
   patterns
       .add<ExternElementwiseOpConversion<triton::ImpureExternElementwiseOp>>(
-          typeConverter, benefit);
+          typeConverter, axisInfoAnalysis, benefit);
   // ExpOpConversionApprox will try using ex2.approx if the input type is
   // FP32. For other input types, ExpOpConversionApprox will return failure and
   // ElementwiseOpConversion<math::ExpOp, math::ExpOp> defined below will call
   // __nv_expf for higher-precision calculation
-  patterns.add<ExpOpConversionApprox>(typeConverter, benefit);
+  patterns.add<ExpOpConversionApprox>(typeConverter, axisInfoAnalysis,
+                                     benefit);
+
+  // With fast math, the approximate lowerings of f32 take precedence
+  if (fastMath) {
+    PatternBenefit fastBenefit(benefit.getBenefit() + 1);
+    patterns.add<FastMathOpConversion<arith::DivFOp>>(
+        typeConverter, axisInfoAnalysis, "div.approx.ftz.f32", 1.0, 1.0,
+        fastBenefit);
+    patterns.add<FastMathOpConversion<math::SqrtOp>>(
+        typeConverter, axisInfoAnalysis, "sqrt.approx.ftz.f32", 1.0, 1.0,
+        fastBenefit);
+    patterns.add<FastMathOpConversion<math::ExpOp>>(
+        typeConverter, axisInfoAnalysis, "ex2.approx.ftz.f32", log2e, 1.0,
+        fastBenefit);
+    patterns.add<FastMathOpConversion<math::LogOp>>(
+        typeConverter, axisInfoAnalysis, "lg2.approx.ftz.f32", 1.0, ln2,
+        fastBenefit);
+    patterns.add<FastMathOpConversion<math::SinOp>>(
+        typeConverter, axisInfoAnalysis, "sin.approx.ftz.f32", 1.0, 1.0,
+        fastBenefit);
+    patterns.add<FastMathOpConversion<math::CosOp>>(
+        typeConverter, axisInfoAnalysis, "cos.approx.ftz.f32", 1.0, 1.0,
+        fastBenefit);
+    patterns.add<
+        FastMathExternElementwiseOpConversion<triton::PureExternElementwiseOp>>(
+        typeConverter, axisInfoAnalysis, computeCapability, fastBenefit);
+  }
 }
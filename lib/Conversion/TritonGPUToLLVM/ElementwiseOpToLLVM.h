@@ -8,7 +8,8 @@ using namespace mlir::triton;
 
 void populateElementwiseOpToLLVMPatterns(
     TritonGPUToLLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
-    PatternBenefit benefit);
+    ModuleAxisInfoAnalysis &axisInfoAnalysis, int computeCapability,
+    bool fastMath, PatternBenefit benefit);
 
 bool isLegalElementwiseOp(Operation *op);
 
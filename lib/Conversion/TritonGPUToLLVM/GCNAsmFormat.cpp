@@ -11,8 +11,8 @@ namespace triton {
 GCNInstr::Operand *
 GCNBuilder::newOperand(mlir::Value value, StringRef constraint,
                        std::function<std::string(int)> formatter) {
-  argArchive.emplace_back(std::make_unique<Operand>(value, constraint));
-  auto *opr = argArchive.back().get();
+  auto *opr = arena.create<Operand>(value, constraint);
+  argArchive.push_back(opr);
   opr->repr = formatter;
   opr->idx = oprCounter++;
   return opr;
@@ -37,9 +37,9 @@ GCNBuilder::Modifier *GCNBuilder::newModifier(StringRef modifier,
 }
 
 GCNBuilder::Operand *GCNBuilder::newConstantOperand(const std::string &v) {
-  argArchive.emplace_back(std::make_unique<Operand>());
-  argArchive.back()->repr = [v](int idx) { return v; };
-  return argArchive.back().get();
+  auto *opr = newOperand();
+  opr->repr = [v](int idx) { return v; };
+  return opr;
 }
 
 GCNBuilder::Operand *GCNBuilder::newConstantOperand(int v) {
@@ -58,7 +58,7 @@ std::string GCNBuilder::getConstraints() const {
 
 llvm::SmallVector<Value, 4> GCNBuilder::getAllMLIRArgs() const {
   llvm::SmallVector<Value, 4> res;
-  for (auto &arg : argArchive) {
+  for (auto *arg : argArchive) {
     if (!arg->isList() && arg->value)
       res.push_back(arg->value);
   }
@@ -67,9 +67,9 @@ llvm::SmallVector<Value, 4> GCNBuilder::getAllMLIRArgs() const {
 
 SmallVector<GCNBuilder::Operand *, 4> GCNBuilder::getAllArgs() const {
   llvm::SmallVector<Operand *, 4> res;
-  for (auto &x : argArchive)
+  for (auto *x : argArchive)
     if (!x->isList())
-      res.push_back(x.get());
+      res.push_back(x);
   return res;
 }
 
@@ -128,7 +128,7 @@ GCNInstr::Operand *GCNBuilder::newAddrOperand(mlir::Value addr,
 
 std::string GCNBuilder::dump() const {
   llvm::SmallVector<std::string> lines;
-  for (auto &exec : executions) {
+  for (auto *exec : executions) {
     lines.push_back(exec->dump());
   }
 
@@ -137,9 +137,9 @@ std::string GCNBuilder::dump() const {
 
 GCNInstrExecution &GCNInstrCommon::call(ArrayRef<Operand *> oprs,
                                         ArrayRef<Modifier *> mods) {
-  builder->executions.emplace_back(
-      std::make_unique<GCNInstrExecution>(this, oprs, mods));
-  return *builder->executions.back();
+  auto *exec = builder->arena.create<GCNInstrExecution>(this, oprs, mods);
+  builder->executions.push_back(exec);
+  return *exec;
 }
 
 GCNInstrExecution &GCNInstrCommon::operator()(ArrayRef<Operand *> oprs,
@@ -151,7 +151,7 @@ std::string GCNInstrExecution::dump() const {
   std::string osStr;
   llvm::raw_string_ostream os(osStr);
 
-  std::string instrRepr = strJoin(instr->instrParts, "_");
+  std::string instrRepr = llvm::join(instr->instrParts, "_");
 
   llvm::SmallVector<std::string, 4> argReprs;
   for (auto *arg : argsInOrder) {
@@ -1,20 +1,44 @@
+#include "mlir/Dialect/LLVMIR/ROCDLDialect.h"
 #include "mlir/IR/Matchers.h"
 #include "mlir/IR/TypeUtilities.h"
 
 #include "ConvertLayoutOpToLLVM.h"
 #include "LoadStoreOpToLLVM.h"
 
+#include <limits>
+
 using namespace mlir;
 using namespace mlir::triton;
 
 using ::mlir::LLVM::getSharedMemoryObjectFromStruct;
+using ::mlir::LLVM::shflIdxSync;
 using ::mlir::triton::gpu::getTotalElemsPerThread;
 using ::mlir::triton::gpu::SharedEncodingAttr;
 
+// The last dword of the descriptors of untyped buffers on the AMD GPUs of
+// `mod`, whose layout depends on the architecture: dst_sel, num_format and
+// data_format on gfx9, and format and out-of-bounds checking on gfx10 and
+// gfx11. None for other architectures, which get no buffer loads.
+static std::optional<int32_t> getBufferResourceFlags(ModuleOp mod) {
+  switch (triton::gpu::TritonGPUDialect::getGfxMajor(mod)) {
+  case 9:
+    return 0x00027000;
+  case 10:
+    return 0x31014000;
+  case 11:
+    return 0x31004000;
+  default:
+    return std::nullopt;
+  }
+}
+
 // Contains some helper functions for both Load and Store conversions.
 struct LoadStoreConversionBase {
-  explicit LoadStoreConversionBase(ModuleAxisInfoAnalysis &axisAnalysisPass)
-      : axisAnalysisPass(axisAnalysisPass) {}
+  explicit LoadStoreConversionBase(ModuleAxisInfoAnalysis &axisAnalysisPass,
+                                   int computeCapability = 80,
+                                   bool isROCM = false)
+      : axisAnalysisPass(axisAnalysisPass),
+        computeCapability(computeCapability), isROCM(isROCM) {}
 
   unsigned getContiguity(Value ptr) const {
     auto tensorTy = ptr.getType().dyn_cast<RankedTensorType>();
@@ -37,10 +61,347 @@ struct LoadStoreConversionBase {
     return axisAnalysisPass.getMaskAlignment(mask);
   }
 
+  // Masks known to be all true are dropped, with their `other` values
+  bool isAllTrueMask(Value mask) const {
+    return mask && axisAnalysisPass.isAllTrueMask(mask);
+  }
+
+  bool isPrefixMask(Value mask, unsigned vec) const {
+    return axisAnalysisPass.isPrefixMask(mask, vec);
+  }
+
+  // Returns the L2 cache policy giving the lines accessed the `l2Evict`
+  // eviction priority, or a null value for the normal priority. L2 cache
+  // hints need sm_80 and are dropped before, and on AMD GPUs.
+  Value getL2CachePolicy(ConversionPatternRewriter &rewriter, Location loc,
+                         triton::EvictionPolicy l2Evict) const {
+    if (l2Evict == triton::EvictionPolicy::NORMAL || isROCM ||
+        computeCapability < 80)
+      return Value();
+    PTXBuilder ptxBuilder;
+    auto &createPolicy =
+        ptxBuilder.create<>("createpolicy")
+            ->o("fractional")
+            .o("L2::evict_first",
+               l2Evict == triton::EvictionPolicy::EVICT_FIRST)
+            .o("L2::evict_last", l2Evict == triton::EvictionPolicy::EVICT_LAST)
+            .b(64);
+    // The priority applies to all the lines accessed
+    createPolicy(ptxBuilder.newOperand("=l"),
+                 ptxBuilder.newConstantOperand("1.0"));
+    return ptxBuilder.launch(rewriter, loc, i64_ty, /*hasSideEffect=*/false);
+  }
+
+  // Same as getL2CachePolicy for loads: `ld.volatile` takes no cache hint, so
+  // volatile loads keep the normal priority.
+  Value getLoadL2CachePolicy(ConversionPatternRewriter &rewriter, Location loc,
+                             triton::EvictionPolicy l2Evict,
+                             bool isVolatile) const {
+    if (isVolatile)
+      return Value();
+    return getL2CachePolicy(rewriter, loc, l2Evict);
+  }
+
+  // Returns the scalar base and the i32 element offsets of `ptr` when the
+  // accesses at `ptr` can be AMD buffer loads: `ptr` is a splat base plus
+  // offsets whose bytes are known to be in [0, 2GB), by their value range or,
+  // for bases that are function arguments, by the promise of the module that
+  // the tensors it accesses are smaller than 2GB.
+  std::optional<std::pair<Value, Value>> getBufferOperands(Value ptr) const {
+    auto tensorTy = ptr.getType().dyn_cast<RankedTensorType>();
+    if (!isROCM || !tensorTy)
+      return std::nullopt;
+    auto mod = ptr.getParentRegion()->getParentOfType<ModuleOp>();
+    if (!getBufferResourceFlags(mod))
+      return std::nullopt;
+    auto addPtrOp = ptr.getDefiningOp<triton::AddPtrOp>();
+    if (!addPtrOp)
+      return std::nullopt;
+    auto splatOp = addPtrOp.getPtr().getDefiningOp<triton::SplatOp>();
+    Value offset = addPtrOp.getOffset();
+    if (!splatOp || !getElementTypeOrSelf(offset.getType()).isInteger(32))
+      return std::nullopt;
+    Value base = splatOp.getSrc();
+    int64_t elemBytes =
+        std::max<int64_t>(triton::getPointeeBitWidth(tensorTy) / 8, 1);
+    bool inRange = false;
+    if (auto *axisInfo = axisAnalysisPass.getAxisInfo(offset))
+      if (auto range = axisInfo->getValueRange())
+        inRange = range->first >= 0 &&
+                  range->second <=
+                      std::numeric_limits<int32_t>::max() / elemBytes;
+    if (!inRange) {
+      auto arg = base.dyn_cast<BlockArgument>();
+      inRange = arg && arg.getOwner()->isEntryBlock() &&
+                isa<FunctionOpInterface>(arg.getOwner()->getParentOp()) &&
+                mod->hasAttr("tt.small_tensors");
+    }
+    if (!inRange)
+      return std::nullopt;
+    return std::make_pair(base, offset);
+  }
+
 protected:
   ModuleAxisInfoAnalysis &axisAnalysisPass;
+  int computeCapability;
+  bool isROCM;
 };
 
+// Loads the elements at `ptrElems`, `vec` at a time, predicated by
+// `maskElems` if there are any. The masked-off elements are `otherElems`, or
+// the integer `otherSplatInt`, if there are any, and undefined otherwise.
+// `l2Policy`, if any, is the L2 cache policy of the loads.
+static SmallVector<Value>
+emitGlobalLoads(ConversionPatternRewriter &rewriter, Location loc,
+                Type indexTy, Type valueElemTy, ArrayRef<Value> ptrElems,
+                ArrayRef<Value> maskElems, ArrayRef<Value> otherElems,
+                std::optional<int64_t> otherSplatInt, unsigned vec,
+                triton::CacheModifier cache, triton::EvictionPolicy evict,
+                bool isVolatile, Value l2Policy) {
+  MLIRContext *ctx = rewriter.getContext();
+  size_t numElems = ptrElems.size();
+  const int valueElemNBits = std::max(8u, valueElemTy.getIntOrFloatBitWidth());
+  const int numVecs = numElems / vec;
+
+  SmallVector<Value> loadedVals;
+  for (size_t vecStart = 0; vecStart < numElems; vecStart += vec) {
+    // TODO: optimization when ptr is GEP with constant offset
+    size_t in_off = 0;
+
+    const size_t maxWordWidth = std::max<size_t>(32, valueElemNBits);
+    const size_t totalWidth = valueElemNBits * vec;
+    const size_t width = std::min(totalWidth, maxWordWidth);
+    const size_t nWords = std::max<size_t>(1, totalWidth / width);
+    const size_t wordNElems = width / valueElemNBits;
+    const size_t movWidth = width < 16 ? 16 : width;
+    assert(wordNElems * nWords * numVecs == numElems);
+
+    const bool hasL2EvictPolicy = l2Policy != nullptr;
+
+    PTXBuilder ptxBuilder;
+
+    Value pred = maskElems.empty() ? int_val(1, 1) : maskElems[vecStart];
+
+    const std::string readConstraint =
+        (width == 64) ? "l" : ((width == 32) ? "r" : "c");
+    const std::string writeConstraint =
+        (width == 64) ? "=l" : ((width == 32) ? "=r" : "=c");
+
+    // prepare asm operands
+    auto *dstsOpr = ptxBuilder.newListOperand();
+    for (size_t wordIdx = 0; wordIdx < nWords; ++wordIdx) {
+      auto *opr = ptxBuilder.newOperand(writeConstraint,
+                                        /*init=*/true); // =r operations
+      dstsOpr->listAppend(opr);
+    }
+
+    auto *addrOpr = ptxBuilder.newAddrOperand(ptrElems[vecStart], "l", in_off);
+
+    // Define the instruction opcode
+    auto &ld = ptxBuilder.create<>("ld")
+                   ->o("volatile", isVolatile)
+                   .global()
+                   .o("ca", cache == triton::CacheModifier::CA)
+                   .o("cg", cache == triton::CacheModifier::CG)
+                   .o("L1::evict_first",
+                      evict == triton::EvictionPolicy::EVICT_FIRST)
+                   .o("L1::evict_last",
+                      evict == triton::EvictionPolicy::EVICT_LAST)
+                   .o("L2::cache_hint", hasL2EvictPolicy)
+                   .v(nWords)
+                   .b(width);
+
+    PTXBuilder::Operand *evictOpr{};
+    if (hasL2EvictPolicy)
+      evictOpr = ptxBuilder.newOperand(l2Policy, "l");
+
+    if (!evictOpr)
+      ld(dstsOpr, addrOpr).predicate(pred, "b");
+    else
+      ld(dstsOpr, addrOpr, evictOpr).predicate(pred, "b");
+
+    if (!otherElems.empty() || otherSplatInt) {
+      for (size_t ii = 0; ii < nWords; ++ii) {
+        // PTX doesn't support mov.u8, so we need to use mov.u16
+        PTXInstr &mov =
+            ptxBuilder.create<>("mov")->o("u" + std::to_string(movWidth));
+
+        PTXInstr::Operand *opr{};
+
+        if (otherSplatInt) {
+          // The element is repeated over the word
+          uint64_t elemMask = valueElemNBits == 64
+                                  ? ~uint64_t(0)
+                                  : (uint64_t(1) << valueElemNBits) - 1;
+          uint64_t word = 0;
+          for (size_t s = 0; s < width; s += valueElemNBits)
+            word |= (uint64_t(*otherSplatInt) & elemMask) << s;
+          opr = ptxBuilder.newConstantOperand(word);
+        } else {
+          size_t size = width / valueElemNBits;
+
+          auto vecTy = LLVM::getFixedVectorType(valueElemTy, size);
+          Value v = undef(vecTy);
+          for (size_t s = 0; s < size; ++s) {
+            Value falseVal = otherElems[vecStart + ii * size + s];
+            Value sVal = createIndexAttrConstant(rewriter, loc, indexTy, s);
+            v = insert_element(vecTy, v, falseVal, sVal);
+          }
+          v = bitcast(v, IntegerType::get(ctx, width));
+          opr = ptxBuilder.newOperand(v, readConstraint);
+        }
+
+        mov(dstsOpr->listGet(ii), opr).predicateNot(pred, "b");
+      }
+    }
+
+    // Create inline ASM signature
+    SmallVector<Type> retTys(nWords, IntegerType::get(ctx, width));
+    Type retTy = retTys.size() > 1
+                     ? LLVM::LLVMStructType::getLiteral(ctx, retTys)
+                     : retTys[0];
+
+    Value ret = ptxBuilder.launch(rewriter, loc, retTy);
+
+    // Extract and store return values
+    SmallVector<Value> rets;
+    for (unsigned int ii = 0; ii < nWords; ++ii) {
+      Value curr;
+      if (retTy.isa<LLVM::LLVMStructType>()) {
+        curr = extract_val(IntegerType::get(ctx, width), ret, ii);
+      } else {
+        curr = ret;
+      }
+      curr = bitcast(curr, LLVM::getFixedVectorType(valueElemTy,
+                                                    width / valueElemNBits));
+      rets.push_back(curr);
+    }
+    int tmp = width / valueElemNBits;
+    for (size_t ii = 0; ii < vec; ++ii) {
+      Value vecIdx = createIndexAttrConstant(rewriter, loc, indexTy, ii % tmp);
+      Value loaded = extract_element(valueElemTy, rets[ii / tmp], vecIdx);
+      loadedVals.push_back(loaded);
+    }
+  } // end vec
+  return loadedVals;
+}
+
+// AMD buffer loads address memory through a resource descriptor, uniform
+// across the threads, and per-thread 32-bit byte offsets into it. Returns
+// the descriptor of the 2GB starting at `base`, as raw bytes (no stride).
+static Value createBufferResource(ConversionPatternRewriter &rewriter,
+                                  Location loc, Value base) {
+  auto mod = base.getParentRegion()->getParentOfType<ModuleOp>();
+  std::optional<int32_t> flags = getBufferResourceFlags(mod);
+  assert(flags && "buffer loads are not supported on this architecture");
+  Value addr = ptrtoint(i64_ty, base);
+  Value lo = rewriter.create<LLVM::TruncOp>(loc, i32_ty, addr);
+  Value hi = rewriter.create<LLVM::TruncOp>(
+      loc, i32_ty, rewriter.create<LLVM::LShrOp>(loc, addr, int_val(64, 32)));
+  // The high half of the second dword is the stride, left to 0
+  hi = and_(hi, i32_val(0xffff));
+  auto rsrcTy = vec_ty(i32_ty, 4);
+  Value rsrc = undef(rsrcTy);
+  Value dwords[] = {lo, hi, i32_val(std::numeric_limits<int32_t>::max()),
+                    i32_val(*flags)};
+  for (auto [i, dword] : llvm::enumerate(dwords))
+    rsrc = insert_element(rsrcTy, rsrc, dword, i32_val(i));
+  return rsrc;
+}
+
+// Loads a `wordTy` vector at `byteOffset` into `rsrc`, or zeros if `pred`
+// is false: the hardware returns zeros for the bytes out of the resource,
+// where masked-off words are moved.
+static Value emitBufferLoad(ConversionPatternRewriter &rewriter, Location loc,
+                            Value rsrc, Value byteOffset, Value pred,
+                            VectorType wordTy, bool isVolatile) {
+  unsigned numBits =
+      wordTy.getNumElements() * wordTy.getElementTypeBitWidth();
+  Type rawTy = int_ty(numBits);
+  if (numBits > 32)
+    rawTy = vec_ty(i32_ty, numBits / 32);
+  if (pred)
+    byteOffset = select(pred, byteOffset,
+                        i32_val(std::numeric_limits<int32_t>::min()));
+  // The glc bit of the auxiliary operand bypasses the non-coherent L1
+  Value aux = i32_val(isVolatile ? 1 : 0);
+  Value word = rewriter.create<ROCDL::RawBufferLoadOp>(loc, rawTy, rsrc,
+                                                       byteOffset,
+                                                       i32_val(0), aux);
+  return bitcast(word, wordTy);
+}
+
+// Loads a `wordTy` vector at `ptr`, or `passThru` (zeros if null) if `pred`
+// is false, without buffer resources.
+static Value emitMaskedLoad(ConversionPatternRewriter &rewriter, Location loc,
+                            Value ptr, Value pred, Value passThru,
+                            VectorType wordTy) {
+  auto ptrTy = ptr.getType().cast<LLVM::LLVMPointerType>();
+  Value wordPtr = bitcast(ptr, ptr_ty(wordTy, ptrTy.getAddressSpace()));
+  if (!pred)
+    return load(wordPtr);
+  if (!passThru)
+    passThru = rewriter.create<LLVM::ConstantOp>(loc, wordTy,
+                                                 rewriter.getZeroAttr(wordTy));
+  auto maskTy = vec_ty(i1_ty, wordTy.getNumElements());
+  Value mask = undef(maskTy);
+  for (unsigned i = 0; i < wordTy.getNumElements(); ++i)
+    mask = insert_element(maskTy, mask, pred, i32_val(i));
+  unsigned alignment =
+      wordTy.getNumElements() * wordTy.getElementTypeBitWidth() / 8;
+  return rewriter.create<LLVM::MaskedLoadOp>(
+      loc, wordTy, wordPtr, mask, ValueRange{passThru},
+      rewriter.getI32IntegerAttr(alignment));
+}
+
+// Loads the elements at `ptrElems` on AMD GPUs, `vec` at a time, predicated
+// by `maskElems` if there are any, the masked-off elements being
+// `otherElems`, if there are any. With `bufferOperands`, the remapped scalar
+// base and the i32 element offsets of the pointers, the loads are buffer
+// loads.
+static SmallVector<Value>
+emitAMDGlobalLoads(ConversionPatternRewriter &rewriter, Location loc,
+                   Type valueElemTy, ArrayRef<Value> ptrElems,
+                   ArrayRef<Value> maskElems, ArrayRef<Value> otherElems,
+                   std::optional<std::pair<Value, SmallVector<Value>>>
+                       bufferOperands,
+                   unsigned vec, bool isVolatile) {
+  auto wordTy = vec_ty(valueElemTy, vec);
+  unsigned elemBytes = std::max(valueElemTy.getIntOrFloatBitWidth() / 8, 1u);
+  Value rsrc;
+  if (bufferOperands)
+    rsrc = createBufferResource(rewriter, loc, bufferOperands->first);
+  SmallVector<Value> loadedVals;
+  for (size_t vecStart = 0; vecStart < ptrElems.size(); vecStart += vec) {
+    Value pred = maskElems.empty() ? Value() : maskElems[vecStart];
+    Value word;
+    if (bufferOperands) {
+      Value byteOffset =
+          mul(bufferOperands->second[vecStart], i32_val(elemBytes));
+      word = emitBufferLoad(rewriter, loc, rsrc, byteOffset, pred, wordTy,
+                            isVolatile);
+    } else {
+      Value passThru;
+      if (pred && !otherElems.empty()) {
+        passThru = undef(wordTy);
+        for (unsigned i = 0; i < vec; ++i)
+          passThru = insert_element(wordTy, passThru,
+                                    otherElems[vecStart + i], i32_val(i));
+      }
+      word = emitMaskedLoad(rewriter, loc, ptrElems[vecStart], pred, passThru,
+                            wordTy);
+    }
+    for (unsigned i = 0; i < vec; ++i) {
+      Value elem = extract_element(valueElemTy, word, i32_val(i));
+      // Buffer loads give zeros for masked-off elements
+      if (bufferOperands && pred && !otherElems.empty())
+        elem = select(pred, elem, otherElems[vecStart + i]);
+      loadedVals.push_back(elem);
+    }
+  }
+  return loadedVals;
+}
+
 struct LoadOpConversion
     : public ConvertTritonGPUOpToLLVMPattern<triton::LoadOp>,
       public LoadStoreConversionBase {
@@ -49,9 +410,9 @@ struct LoadOpConversion
 
   LoadOpConversion(TritonGPUToLLVMTypeConverter &converter,
                    ModuleAxisInfoAnalysis &axisAnalysisPass,
-                   PatternBenefit benefit)
+                   int computeCapability, bool isROCM, PatternBenefit benefit)
       : ConvertTritonGPUOpToLLVMPattern<triton::LoadOp>(converter, benefit),
-        LoadStoreConversionBase(axisAnalysisPass) {}
+        LoadStoreConversionBase(axisAnalysisPass, computeCapability, isROCM) {}
 
   LogicalResult
   matchAndRewrite(triton::LoadOp op, OpAdaptor adaptor,
@@ -68,6 +429,9 @@ struct LoadOpConversion
     Value llMask = adaptor.getMask();
     Value llOther = adaptor.getOther();
 
+    if (isAllTrueMask(mask))
+      mask = other = llMask = llOther = nullptr;
+
     // Determine the vectorization size
     Type valueTy = op.getResult().getType();
     Type valueElemTy =
@@ -93,15 +457,12 @@ struct LoadOpConversion
     // Get the LLVM values for `other`
     // TODO: (goostavz) handle when other is const but not splat, which
     //       should be rarely seen
-    bool otherIsSplatConstInt = false;
+    std::optional<int64_t> otherSplatInt;
     DenseElementsAttr constAttr;
-    int64_t splatVal = 0;
     if (other && valueElemTy.isa<IntegerType>() &&
         matchPattern(other, m_Constant(&constAttr)) && constAttr.isSplat() &&
-        constAttr.getElementType().isa<IntegerType>()) {
-      otherIsSplatConstInt = true;
-      splatVal = constAttr.getSplatValue<APInt>().getSExtValue();
-    }
+        constAttr.getElementType().isa<IntegerType>())
+      otherSplatInt = constAttr.getSplatValue<APInt>().getSExtValue();
     SmallVector<Value> otherElems;
     if (other) {
       otherElems = getTypeConverter()->unpackLLElements(loc, llOther, rewriter,
@@ -109,141 +470,135 @@ struct LoadOpConversion
     }
 
     // vectorized iteration through all the pointer/mask/other elements
-    const int valueElemNBits =
-        std::max(8u, valueElemTy.getIntOrFloatBitWidth());
-    const int numVecs = numElems / vec;
-
     SmallVector<Value> loadedVals;
-    for (size_t vecStart = 0; vecStart < numElems; vecStart += vec) {
-      // TODO: optimization when ptr is GEP with constant offset
-      size_t in_off = 0;
-
-      const size_t maxWordWidth = std::max<size_t>(32, valueElemNBits);
-      const size_t totalWidth = valueElemNBits * vec;
-      const size_t width = std::min(totalWidth, maxWordWidth);
-      const size_t nWords = std::max<size_t>(1, totalWidth / width);
-      const size_t wordNElems = width / valueElemNBits;
-      const size_t movWidth = width < 16 ? 16 : width;
-      assert(wordNElems * nWords * numVecs == numElems);
-
-      // TODO(Superjomn) Add cache policy fields to StoreOp.
-      // TODO(Superjomn) Deal with cache policy here.
-      const bool hasL2EvictPolicy = false;
-
-      PTXBuilder ptxBuilder;
-
-      Value pred = mask ? maskElems[vecStart] : int_val(1, 1);
-
-      const std::string readConstraint =
-          (width == 64) ? "l" : ((width == 32) ? "r" : "c");
-      const std::string writeConstraint =
-          (width == 64) ? "=l" : ((width == 32) ? "=r" : "=c");
-
-      // prepare asm operands
-      auto *dstsOpr = ptxBuilder.newListOperand();
-      for (size_t wordIdx = 0; wordIdx < nWords; ++wordIdx) {
-        auto *opr = ptxBuilder.newOperand(writeConstraint,
-                                          /*init=*/true); // =r operations
-        dstsOpr->listAppend(opr);
+    if (isROCM && valueElemTy.isIntOrFloat()) {
+      std::optional<std::pair<Value, SmallVector<Value>>> bufferOperands;
+      if (auto operands = getBufferOperands(ptr)) {
+        auto [base, offset] = *operands;
+        Value llBase = rewriter.getRemappedValue(base);
+        Value llOffset = rewriter.getRemappedValue(offset);
+        if (llBase && llOffset)
+          bufferOperands = std::make_pair(
+              llBase, getTypeConverter()->unpackLLElements(
+                          loc, llOffset, rewriter, offset.getType()));
       }
+      loadedVals = emitAMDGlobalLoads(rewriter, loc, valueElemTy, ptrElems,
+                                      maskElems, otherElems, bufferOperands,
+                                      vec, op.getIsVolatile());
+    } else {
+      loadedVals = emitGlobalLoads(
+          rewriter, loc, getTypeConverter()->getIndexType(), valueElemTy,
+          ptrElems, maskElems, otherElems, otherSplatInt, vec, op.getCache(),
+          op.getEvict(), op.getIsVolatile(),
+          getLoadL2CachePolicy(rewriter, loc, op.getL2Evict(),
+                               op.getIsVolatile()));
+    }
 
-      auto *addrOpr =
-          ptxBuilder.newAddrOperand(ptrElems[vecStart], "l", in_off);
-
-      // Define the instruction opcode
-      auto &ld = ptxBuilder.create<>("ld")
-                     ->o("volatile", op.getIsVolatile())
-                     .global()
-                     .o("ca", op.getCache() == triton::CacheModifier::CA)
-                     .o("cg", op.getCache() == triton::CacheModifier::CG)
-                     .o("L1::evict_first",
-                        op.getEvict() == triton::EvictionPolicy::EVICT_FIRST)
-                     .o("L1::evict_last",
-                        op.getEvict() == triton::EvictionPolicy::EVICT_LAST)
-                     .o("L1::cache_hint", hasL2EvictPolicy)
-                     .v(nWords)
-                     .b(width);
-
-      PTXBuilder::Operand *evictOpr{};
-
-      // Here lack a mlir::Value to bind to this operation, so disabled.
-      // if (has_l2_evict_policy)
-      //   evictOpr = ptxBuilder.newOperand(l2Evict, "l");
-
-      if (!evictOpr)
-        ld(dstsOpr, addrOpr).predicate(pred, "b");
-      else
-        ld(dstsOpr, addrOpr, evictOpr).predicate(pred, "b");
-
-      if (other) {
-        for (size_t ii = 0; ii < nWords; ++ii) {
-          // PTX doesn't support mov.u8, so we need to use mov.u16
-          PTXInstr &mov =
-              ptxBuilder.create<>("mov")->o("u" + std::to_string(movWidth));
-
-          size_t size = width / valueElemNBits;
-
-          auto vecTy = LLVM::getFixedVectorType(valueElemTy, size);
-          Value v = undef(vecTy);
-          for (size_t s = 0; s < size; ++s) {
-            Value falseVal = otherElems[vecStart + ii * size + s];
-            Value sVal = createIndexAttrConstant(
-                rewriter, loc, this->getTypeConverter()->getIndexType(), s);
-            v = insert_element(vecTy, v, falseVal, sVal);
-          }
-          v = bitcast(v, IntegerType::get(getContext(), width));
+    Type llvmResultStructTy = getTypeConverter()->convertType(valueTy);
+    Value resultStruct = getTypeConverter()->packLLElements(
+        loc, loadedVals, rewriter, llvmResultStructTy);
+    rewriter.replaceOp(op, {resultStruct});
+    return success();
+  }
+};
 
-          PTXInstr::Operand *opr{};
+struct BlockLoadOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::BlockLoadOp>,
+      public LoadStoreConversionBase {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::BlockLoadOp>::ConvertTritonGPUOpToLLVMPattern;
 
-          if (otherIsSplatConstInt) {
-            for (size_t s = 0; s < 32; s += valueElemNBits)
-              splatVal |= splatVal << valueElemNBits;
-            opr = ptxBuilder.newConstantOperand(splatVal);
-          } else
-            opr = ptxBuilder.newOperand(v, readConstraint);
+  BlockLoadOpConversion(
+      TritonGPUToLLVMTypeConverter &converter,
+      ModuleAxisInfoAnalysis &axisAnalysisPass,
+      ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
+      int computeCapability, PatternBenefit benefit)
+      : ConvertTritonGPUOpToLLVMPattern<triton::BlockLoadOp>(
+            converter, indexCacheInfo, benefit),
+        LoadStoreConversionBase(axisAnalysisPass, computeCapability) {}
 
-          mov(dstsOpr->listGet(ii), opr).predicateNot(pred, "b");
-        }
+  LogicalResult
+  matchAndRewrite(triton::BlockLoadOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    auto resultTy = op.getType().cast<RankedTensorType>();
+    auto layout = resultTy.getEncoding();
+    auto shape = resultTy.getShape();
+    unsigned rank = shape.size();
+    Type valueElemTy =
+        getTypeConverter()->convertType(resultTy.getElementType());
+    unsigned bitwidth = std::max(8u, valueElemTy.getIntOrFloatBitWidth());
+    auto boundaryCheck = op.getBoundaryCheck();
+
+    // Elements are read as vectors along the unit-stride dimension of the
+    // block, if the threads hold them in that order
+    unsigned contigDim = op.getOrder()[0];
+    unsigned vec = 1;
+    if (triton::gpu::getOrder(layout)[0] == contigDim)
+      vec = std::min({axisAnalysisPass.getBlockLoadAlignment(op),
+                      triton::gpu::getUniqueContigPerThread(layout,
+                                                            shape)[contigDim],
+                      128 / bitwidth});
+
+    // The offsets of the block are added to its base once, each thread only
+    // adds the indices of its vectors, and checks them against the shape
+    // along the dimensions of `boundaryCheck`
+    auto llShape = adaptor.getShape();
+    auto llStrides = adaptor.getStrides();
+    auto llOffsets = adaptor.getOffsets();
+    Type ptrTy = getTypeConverter()->convertType(op.getBase().getType());
+    Value blockOffset = int_val(64, 0);
+    for (unsigned d = 0; d < rank; ++d)
+      blockOffset = add(blockOffset, mul(llOffsets[d], llStrides[d]));
+    Value blockBase = gep(ptrTy, adaptor.getBase(), blockOffset);
+
+    auto indices = emitIndices(loc, rewriter, layout, resultTy);
+    unsigned numElems = indices.size();
+    SmallVector<Value> ptrElems(numElems), maskElems;
+    if (!boundaryCheck.empty())
+      maskElems.resize(numElems);
+    for (unsigned i = 0; i < numElems; i += vec) {
+      Value elemOffset = int_val(64, 0);
+      Value mask;
+      for (unsigned d = 0; d < rank; ++d) {
+        Value index = sext(i64_ty, indices[i][d]);
+        elemOffset = add(elemOffset, mul(index, llStrides[d]));
+        if (!llvm::is_contained(boundaryCheck, int32_t(d)))
+          continue;
+        Value coord = add(llOffsets[d], index);
+        Value inBounds = and_(icmp_sge(coord, int_val(64, 0)),
+                              icmp_slt(coord, llShape[d]));
+        mask = mask ? and_(mask, inBounds) : inBounds;
       }
+      ptrElems[i] = gep(ptrTy, blockBase, elemOffset);
+      if (mask)
+        maskElems[i] = mask;
+    }
 
-      // Create inline ASM signature
-      SmallVector<Type> retTys(nWords, IntegerType::get(getContext(), width));
-      Type retTy = retTys.size() > 1
-                       ? LLVM::LLVMStructType::getLiteral(getContext(), retTys)
-                       : retTys[0];
-
-      // TODO: if (has_l2_evict_policy)
-      // auto asmDialectAttr =
-      // LLVM::AsmDialectAttr::get(rewriter.getContext(),
-      //                                                 LLVM::AsmDialect::AD_ATT);
-      Value ret = ptxBuilder.launch(rewriter, loc, retTy);
-
-      // Extract and store return values
-      SmallVector<Value> rets;
-      for (unsigned int ii = 0; ii < nWords; ++ii) {
-        Value curr;
-        if (retTy.isa<LLVM::LLVMStructType>()) {
-          curr = extract_val(IntegerType::get(getContext(), width), ret, ii);
-        } else {
-          curr = ret;
-        }
-        curr = bitcast(curr, LLVM::getFixedVectorType(valueElemTy,
-                                                      width / valueElemNBits));
-        rets.push_back(curr);
-      }
-      int tmp = width / valueElemNBits;
-      for (size_t ii = 0; ii < vec; ++ii) {
-        Value vecIdx = createIndexAttrConstant(
-            rewriter, loc, this->getTypeConverter()->getIndexType(), ii % tmp);
-        Value loaded = extract_element(valueElemTy, rets[ii / tmp], vecIdx);
-        loadedVals.push_back(loaded);
+    // Padding is a constant, moved into the masked-off words
+    std::optional<int64_t> otherSplatInt;
+    if (auto padding = op.getPadding()) {
+      if (*padding == triton::PaddingOption::PAD_NAN) {
+        auto floatTy = resultTy.getElementType().cast<FloatType>();
+        otherSplatInt = APFloat::getNaN(floatTy.getFloatSemantics())
+                            .bitcastToAPInt()
+                            .getZExtValue();
+      } else {
+        otherSplatInt = 0;
       }
-    } // end vec
+      if (maskElems.empty())
+        otherSplatInt = std::nullopt;
+    }
 
-    Type llvmResultStructTy = getTypeConverter()->convertType(valueTy);
-    Value resultStruct = getTypeConverter()->packLLElements(
-        loc, loadedVals, rewriter, llvmResultStructTy);
-    rewriter.replaceOp(op, {resultStruct});
+    SmallVector<Value> loadedVals = emitGlobalLoads(
+        rewriter, loc, getTypeConverter()->getIndexType(), valueElemTy,
+        ptrElems, maskElems, /*otherElems=*/{}, otherSplatInt, vec,
+        op.getCache(), op.getEvict(), op.getIsVolatile(),
+        getLoadL2CachePolicy(rewriter, loc, op.getL2Evict(),
+                             op.getIsVolatile()));
+    Value result = getTypeConverter()->packLLElements(loc, loadedVals,
+                                                      rewriter, resultTy);
+    rewriter.replaceOp(op, result);
     return success();
   }
 };
@@ -256,9 +611,9 @@ struct StoreOpConversion
 
   StoreOpConversion(TritonGPUToLLVMTypeConverter &converter,
                     ModuleAxisInfoAnalysis &axisAnalysisPass,
-                    PatternBenefit benefit)
+                    int computeCapability, PatternBenefit benefit)
       : ConvertTritonGPUOpToLLVMPattern<triton::StoreOp>(converter, benefit),
-        LoadStoreConversionBase(axisAnalysisPass) {}
+        LoadStoreConversionBase(axisAnalysisPass, computeCapability) {}
 
   LogicalResult
   matchAndRewrite(triton::StoreOp op, OpAdaptor adaptor,
@@ -269,6 +624,8 @@ struct StoreOpConversion
     Value llPtr = adaptor.getPtr();
     Value llMask = adaptor.getMask();
     Value llValue = adaptor.getValue();
+    if (isAllTrueMask(op.getMask()))
+      llMask = nullptr;
 
     auto loc = op->getLoc();
     MLIRContext *ctx = rewriter.getContext();
@@ -299,6 +656,7 @@ struct StoreOpConversion
     }
 
     Value mask = getMask(valueTy, rewriter, loc);
+    Value l2Policy = getL2CachePolicy(rewriter, loc, op.getL2Evict());
     const size_t dtsize =
         std::max<int>(1, valueElemTy.getIntOrFloatBitWidth() / 8);
     const size_t valueElemNBits = dtsize * 8;
@@ -315,9 +673,6 @@ struct StoreOpConversion
       const size_t wordNElems = width / valueElemNBits;
       assert(wordNElems * nWords * numVecs == elemsPerThread);
 
-      // TODO(Superjomn) Add cache policy fields to StoreOp.
-      // TODO(Superjomn) Deal with cache policy here.
-
       Type valArgTy = IntegerType::get(ctx, width);
       auto wordTy = vec_ty(valueElemTy, wordNElems);
 
@@ -362,9 +717,14 @@ struct StoreOpConversion
                  op.getEvict() == triton::EvictionPolicy::EVICT_FIRST)
               .o("L1::evict_last",
                  op.getEvict() == triton::EvictionPolicy::EVICT_LAST)
+              .o("L2::cache_hint", l2Policy != nullptr)
               .v(nWords)
               .b(width);
-      ptxStoreInstr(asmAddr, asmArgList).predicate(maskVal, "b");
+      if (l2Policy)
+        ptxStoreInstr(asmAddr, asmArgList, ptxBuilder.newOperand(l2Policy, "l"))
+            .predicate(maskVal, "b");
+      else
+        ptxStoreInstr(asmAddr, asmArgList).predicate(maskVal, "b");
 
       Type boolTy = getTypeConverter()->convertType(rewriter.getIntegerType(1));
       llvm::SmallVector<Type> argTys({boolTy, ptr.getType()});
@@ -379,6 +739,122 @@ struct StoreOpConversion
   }
 };
 
+// Copies the block with cp.async.bulk.tensor into the scratch buffer of the
+// op, followed by the mbarrier tracking the copy. Once the copy is complete,
+// every thread reads its elements from the dense box.
+struct TMALoadOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::TMALoadOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::TMALoadOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::TMALoadOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    MLIRContext *ctx = rewriter.getContext();
+    auto resultTy = op.getResult().getType().cast<RankedTensorType>();
+    auto layout = resultTy.getEncoding();
+    auto shape = resultTy.getShape();
+    auto order = op.getOrder();
+    unsigned rank = shape.size();
+    Type elemTy = getTypeConverter()->convertType(resultTy.getElementType());
+    unsigned bitwidth = elemTy.getIntOrFloatBitWidth();
+    unsigned boxBytes = resultTy.getNumElements() * bitwidth / 8;
+
+    Value smemBase = getSharedMemoryBase(loc, rewriter, op.getOperation());
+    Value boxAddr = ptrtoint(i32_ty, smemBase);
+    Value mbarAddr = add(boxAddr, i32_val(boxBytes));
+    Value isThread0 = icmp_eq(getThreadId(rewriter, loc), i32_val(0));
+
+    // A single arrival, that of the thread issuing the copy
+    PTXBuilder initBuilder;
+    auto &init =
+        *initBuilder.create<>("@$0 mbarrier.init.shared::cta.b64 [$1], 1;\n"
+                              "@$0 fence.mbarrier_init.release.cluster;");
+    init({initBuilder.newOperand(isThread0, "b"),
+          initBuilder.newOperand(mbarAddr, "r")},
+         /*onlyAttachMLIRArgs=*/true);
+    initBuilder.launch(rewriter, loc, void_ty(ctx));
+    barrier();
+
+    // The coordinates of the box follow the dimensions of the tensor map
+    PTXBuilder copyBuilder;
+    SmallVector<PTXBuilder::Operand *> copyOperands = {
+        copyBuilder.newOperand(isThread0, "b"),
+        copyBuilder.newOperand(mbarAddr, "r"),
+        copyBuilder.newOperand(boxAddr, "r"),
+        copyBuilder.newOperand(ptrtoint(i64_ty, adaptor.getDesc()), "l")};
+    std::string coords;
+    for (unsigned i = 0; i < rank; ++i) {
+      copyOperands.push_back(
+          copyBuilder.newOperand(adaptor.getOffsets()[order[i]], "r"));
+      coords += (i ? ", $" : "$") + std::to_string(4 + i);
+    }
+    // The box may have been read by the generic proxy before
+    std::string ptx =
+        "@$0 fence.proxy.async.shared::cta;\n"
+        "@$0 mbarrier.arrive.expect_tx.shared::cta.b64 _, [$1], " +
+        std::to_string(boxBytes) +
+        ";\n"
+        "@$0 cp.async.bulk.tensor." +
+        std::to_string(rank) +
+        "d.shared::cluster.global.mbarrier::complete_tx::bytes [$2], [$3, {" +
+        coords + "}], [$1];";
+    auto &bulkCopy = *copyBuilder.create<>(ptx);
+    bulkCopy(copyOperands, /*onlyAttachMLIRArgs=*/true);
+    copyBuilder.launch(rewriter, loc, void_ty(ctx));
+
+    PTXBuilder waitBuilder;
+    auto &tryWait = *waitBuilder.create<>(
+        "{\n"
+        ".reg .pred done;\n"
+        "wait_tma:\n"
+        "mbarrier.try_wait.parity.shared::cta.b64 done, [$0], 0;\n"
+        "@!done bra wait_tma;\n"
+        "}");
+    tryWait({waitBuilder.newOperand(mbarAddr, "r")},
+            /*onlyAttachMLIRArgs=*/true);
+    waitBuilder.launch(rewriter, loc, void_ty(ctx));
+
+    // The box is dense, with its dimensions in `order`. Elements contiguous
+    // in both the box and the threads are read as vectors.
+    auto indices = emitIndices(loc, rewriter, layout, resultTy);
+    unsigned vec = 1;
+    if (auto blocked = layout.dyn_cast<triton::gpu::BlockedEncodingAttr>())
+      if (blocked.getOrder()[0] == order[0])
+        vec = std::min<unsigned>(
+            triton::gpu::getUniqueContigPerThread(layout, shape)[order[0]],
+            128 / bitwidth);
+    Value elemPtr = bitcast(smemBase, ptr_ty(elemTy, 3));
+    SmallVector<Value> results(indices.size());
+    for (unsigned i = 0; i < indices.size(); i += vec) {
+      Value offset = i32_val(0);
+      for (int j = rank - 1; j >= 0; --j)
+        offset = add(mul(offset, i32_val(shape[order[j]])),
+                     indices[i][order[j]]);
+      Value ptr = gep(ptr_ty(elemTy, 3), elemPtr, offset);
+      Value vecVal = load(bitcast(ptr, ptr_ty(vec_ty(elemTy, vec), 3)));
+      for (unsigned k = 0; k < vec; ++k)
+        results[i + k] = extract_element(elemTy, vecVal, i32_val(k));
+    }
+
+    // The mbarrier is invalidated before its memory is reused
+    barrier();
+    PTXBuilder invalBuilder;
+    auto &inval = *invalBuilder.create<>(
+        "@$0 mbarrier.inval.shared::cta.b64 [$1];");
+    inval({invalBuilder.newOperand(isThread0, "b"),
+           invalBuilder.newOperand(mbarAddr, "r")},
+          /*onlyAttachMLIRArgs=*/true);
+    invalBuilder.launch(rewriter, loc, void_ty(ctx));
+
+    Value result =
+        getTypeConverter()->packLLElements(loc, results, rewriter, resultTy);
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+};
+
 struct AtomicCASOpConversion
     : public ConvertTritonGPUOpToLLVMPattern<triton::AtomicCASOp>,
       public LoadStoreConversionBase {
@@ -433,7 +909,8 @@ struct AtomicCASOpConversion
     std::string semStr;
     llvm::raw_string_ostream os(semStr);
     os << op.getSem();
-    atom.global().o(semStr).o("cas").o("b32");
+    auto scopeStr = stringifyMemSyncScope(op.getScope()).str();
+    atom.global().o(scopeStr).o(semStr).o("cas").o("b32");
     atom(dstOpr, ptrOpr, cmpOpr, valOpr).predicate(mask);
     auto old = ptxBuilderAtomicCAS.launch(rewriter, loc, valueElemTy);
     barrier();
@@ -463,10 +940,94 @@ struct AtomicRMWOpConversion
   AtomicRMWOpConversion(TritonGPUToLLVMTypeConverter &converter,
                         ModuleAllocation &allocation,
                         ModuleAxisInfoAnalysis &axisAnalysisPass,
-                        PatternBenefit benefit)
+                        int computeCapability, PatternBenefit benefit)
       : ConvertTritonGPUOpToLLVMPattern<triton::AtomicRMWOp>(
             converter, allocation, benefit),
-        LoadStoreConversionBase(axisAnalysisPass) {}
+        LoadStoreConversionBase(axisAnalysisPass, computeCapability) {}
+
+  // The most elements a single atom/red updates: two halves packed in an
+  // f16x2, and from sm_90 bf16x2 and .v2/.v4 vectors of 32-bit words.
+  unsigned getMaxAtomicVec(RMWOp rmwOp, Type elemTy) const {
+    if (rmwOp != RMWOp::FADD)
+      return 1;
+    bool hasVectorAtomics = computeCapability >= 90;
+    if (elemTy.isF16())
+      return hasVectorAtomics ? 8 : 2;
+    if (elemTy.isBF16() || elemTy.isF32())
+      return hasVectorAtomics ? 128 / elemTy.getIntOrFloatBitWidth() : 1;
+    return 1;
+  }
+
+  static Value combine(ConversionPatternRewriter &rewriter, Location loc,
+                       RMWOp rmwOp, Value a, Value b) {
+    switch (rmwOp) {
+    case RMWOp::FADD:
+      return fadd(a, b);
+    case RMWOp::ADD:
+      return add(a, b);
+    case RMWOp::MAX:
+      return smax(a, b);
+    case RMWOp::MIN:
+      return smin(a, b);
+    case RMWOp::UMAX:
+      return umax(a, b);
+    case RMWOp::UMIN:
+      return umin(a, b);
+    case RMWOp::AND:
+      return and_(a, b);
+    case RMWOp::OR:
+      return or_(a, b);
+    case RMWOp::XOR:
+      return xor_(a, b);
+    default:
+      // exchanges are never lowered to red, so never aggregated
+      llvm_unreachable("unexpected atomic op");
+    }
+  }
+
+  // Combines `val` over the lanes of the warp with the same `key` into the
+  // lowest of them, and returns whether the lane is that leader. The peers
+  // are found with match.any and reduced as a tree over their ranks: at
+  // step s, the peers of rank 2^s * (2i + 1) are added to those of rank
+  // 2^(s+1) * i, and leave.
+  std::pair<Value, Value>
+  aggregateWarpPeers(ConversionPatternRewriter &rewriter, Location loc,
+                     RMWOp rmwOp, Value laneId, Value key, Value val) const {
+    PTXBuilder matchBuilder;
+    auto &match = *matchBuilder.create<>("match.any.sync.b64");
+    match(matchBuilder.newOperand("=r"), matchBuilder.newOperand(key, "l"),
+          matchBuilder.newConstantOperand("0xffffffff"));
+    Value peers = matchBuilder.launch(rewriter, loc, i32_ty);
+
+    auto popc = [&](Value x) {
+      return rewriter.create<LLVM::CtPopOp>(loc, i32_ty, x).getResult();
+    };
+    auto ballot = [&](Value pred) {
+      PTXBuilder builder;
+      auto &vote = *builder.create<>("vote.sync.ballot.b32");
+      vote(builder.newOperand("=r"), builder.newOperand(pred, "b"),
+           builder.newConstantOperand("0xffffffff"));
+      return builder.launch(rewriter, loc, i32_ty);
+    };
+    Value laneBit = shl(i32_val(1), laneId);
+    Value lowerLanes = sub(laneBit, i32_val(1));
+    Value rank = popc(and_(peers, lowerLanes));
+    Value isLeader = icmp_eq(rank, i32_val(0));
+    // the peers above this lane, which have not been added yet
+    Value pending = and_(peers, xor_(or_(lowerLanes, laneBit), i32_val(-1)));
+    for (int step = 0; step < 5; ++step) {
+      // the lowest pending lane, 32 if there is none
+      Value lowest = and_(pending, sub(i32_val(0), pending));
+      Value next = popc(sub(lowest, i32_val(1)));
+      Value other = shflIdxSync(loc, rewriter, val, and_(next, i32_val(31)));
+      val = select(icmp_ne(pending, i32_val(0)),
+                   combine(rewriter, loc, rmwOp, val, other), val);
+      Value done = ballot(icmp_ne(and_(rank, i32_val(1)), i32_val(0)));
+      pending = and_(pending, xor_(done, i32_val(-1)));
+      rank = rewriter.create<LLVM::LShrOp>(loc, rank, i32_val(1));
+    }
+    return {val, isLeader};
+  }
 
   LogicalResult
   matchAndRewrite(triton::AtomicRMWOp op, OpAdaptor adaptor,
@@ -482,6 +1043,8 @@ struct AtomicRMWOpConversion
     Value llPtr = adaptor.getPtr();
     Value llVal = adaptor.getVal();
     Value llMask = adaptor.getMask();
+    if (isAllTrueMask(op.getMask()))
+      llMask = nullptr;
 
     auto valElements = getTypeConverter()->unpackLLElements(
         loc, llVal, rewriter, val.getType());
@@ -502,37 +1065,86 @@ struct AtomicRMWOpConversion
     // vec = 1, numElements = 1 for scalar
     auto vec = getVectorSize(ptr);
     int numElems = 1;
+    bool isBF16 = false;
     // tensor
     if (tensorTy) {
       auto valTy = val.getType().cast<RankedTensorType>();
-      vec = std::min<unsigned>(vec, valTy.getElementType().isF16() ? 2 : 1);
+      isBF16 = valTy.getElementType().isBF16();
+      vec = std::min<unsigned>(
+          vec, getMaxAtomicVec(atomicRmwAttr, valTy.getElementType()));
+      if (llMask)
+        vec = std::min<unsigned>(vec, getMaskAlignment(op.getMask()));
       // mask
       numElems = tensorTy.getNumElements();
     }
     Value mask = getMask(valueTy, rewriter, loc);
-
-    auto vecTy = vec_ty(valueElemTy, vec);
+    // Without users, the old values are not returned and red is used, if it
+    // supports the semantics and kind of the atomic. For a scalar, this also
+    // saves the broadcast of the old value through shared memory.
+    bool isReduction = isAtomicReduction(op);
+    bool aggregate = isReduction && tensorTy && op.getAggregate() &&
+                     vec == 1 && computeCapability >= 70 && !isBF16;
+    Value laneId;
+    if (aggregate)
+      laneId = urem(getThreadId(rewriter, loc), i32_val(32));
+
+    // Halves are packed in pairs in 32-bit words, which are updated .v2 or
+    // .v4 at a time
+    bool isPacked = valueElemNBits == 16 && vec >= 2;
+    unsigned elemsPerWord = isPacked ? 2 : 1;
+    unsigned numWords = vec / elemsPerWord;
+    Type wordTy = isPacked ? i32_ty : valueElemTy;
+    auto packedTy = vec_ty(valueElemTy, 2);
     SmallVector<Value> resultVals(elemsPerThread);
     for (size_t i = 0; i < elemsPerThread; i += vec) {
-      Value rmwVal = undef(vecTy);
-      for (int ii = 0; ii < vec; ++ii) {
-        Value iiVal = createIndexAttrConstant(
-            rewriter, loc, getTypeConverter()->getIndexType(), ii);
-        rmwVal = insert_element(vecTy, rmwVal, valElements[i + ii], iiVal);
-      }
-
       Value rmwPtr = ptrElements[i];
       Value rmwMask = llMask ? and_(mask, maskElements[i]) : mask;
+      SmallVector<Value> words;
+      for (unsigned w = 0; w < numWords; ++w) {
+        if (!isPacked) {
+          words.push_back(valElements[i + w]);
+          continue;
+        }
+        Value word = undef(packedTy);
+        for (int ii = 0; ii < 2; ++ii)
+          word = insert_element(packedTy, word, valElements[i + 2 * w + ii],
+                                i32_val(ii));
+        words.push_back(bitcast(word, i32_ty));
+      }
+      if (aggregate) {
+        // masked lanes get distinct keys, which no address can match
+        Value key = select(rmwMask, ptrtoint(i64_ty, rmwPtr),
+                           sub(int_val(64, -1), zext(i64_ty, laneId)));
+        auto [aggregated, isLeader] = aggregateWarpPeers(
+            rewriter, loc, atomicRmwAttr, laneId, key, words[0]);
+        words[0] = aggregated;
+        rmwMask = and_(rmwMask, isLeader);
+      }
+
       std::string sTy;
       PTXBuilder ptxBuilderAtomicRMW;
-      std::string tyId = valueElemNBits * vec == 64
-                             ? "l"
-                             : (valueElemNBits * vec == 32 ? "r" : "h");
-      auto *dstOpr = ptxBuilderAtomicRMW.newOperand("=" + tyId, /*init=*/true);
+      unsigned wordNBits = valueElemNBits * elemsPerWord;
+      std::string tyId =
+          wordNBits == 64 ? "l" : (wordNBits == 32 ? "r" : "h");
+      PTXBuilder::Operand *dstOpr = nullptr;
+      if (!isReduction)
+        dstOpr = numWords == 1 ? ptxBuilderAtomicRMW.newOperand(
+                                     "=" + tyId, /*init=*/true)
+                               : ptxBuilderAtomicRMW.newListOperand(
+                                     numWords, "=" + tyId);
       auto *ptrOpr = ptxBuilderAtomicRMW.newAddrOperand(rmwPtr, "l");
-      auto *valOpr = ptxBuilderAtomicRMW.newOperand(rmwVal, tyId);
+      PTXBuilder::Operand *valOpr = nullptr;
+      if (numWords == 1) {
+        valOpr = ptxBuilderAtomicRMW.newOperand(words[0], tyId);
+      } else {
+        valOpr = ptxBuilderAtomicRMW.newListOperand();
+        for (Value word : words)
+          valOpr->listAppend(ptxBuilderAtomicRMW.newOperand(word, tyId));
+      }
 
-      auto &atom = ptxBuilderAtomicRMW.create<>("atom")->global().o("gpu");
+      auto &atom = ptxBuilderAtomicRMW.create<>(isReduction ? "red" : "atom")
+                       ->global()
+                       .o(stringifyMemSyncScope(op.getScope()).str());
       auto rmwOp = stringifyRMWOp(atomicRmwAttr).str();
       auto sBits = std::to_string(valueElemNBits);
       switch (atomicRmwAttr) {
@@ -551,8 +1163,10 @@ struct AtomicRMWOpConversion
       case RMWOp::FADD:
         rmwOp = "add";
         rmwOp += (valueElemNBits == 16 ? ".noftz" : "");
-        sTy = "f" + sBits;
-        sTy += (vec == 2 && valueElemNBits == 16) ? "x2" : "";
+        if (numWords > 1)
+          rmwOp += ".v" + std::to_string(numWords);
+        sTy = (isBF16 ? "bf" : "f") + sBits;
+        sTy += isPacked ? "x2" : "";
         break;
       case RMWOp::MAX:
         sTy = "s" + sBits;
@@ -578,22 +1192,34 @@ struct AtomicRMWOpConversion
       llvm::raw_string_ostream os(semStr);
       os << op.getSem();
       atom.o(semStr).o(rmwOp).o(sTy);
-      if (tensorTy) {
+      if (isReduction) {
+        atom(ptrOpr, valOpr).predicate(rmwMask);
+        ptxBuilderAtomicRMW.launch(rewriter, loc, void_ty(ctx));
+        if (!tensorTy) {
+          rewriter.replaceOp(op, {undef(valueElemTy)});
+          return success();
+        }
+      } else if (tensorTy) {
         atom(dstOpr, ptrOpr, valOpr).predicate(rmwMask);
-        auto retType = vec == 1 ? valueElemTy : vecTy;
+        Type retType = numWords == 1
+                           ? wordTy
+                           : struct_ty(SmallVector<Type>(numWords, wordTy));
         auto ret = ptxBuilderAtomicRMW.launch(rewriter, loc, retType);
-        for (int ii = 0; ii < vec; ++ii) {
-          resultVals[i + ii] =
-              vec == 1 ? ret : extract_element(valueElemTy, ret, i32_val(ii));
+        for (unsigned w = 0; w < numWords; ++w) {
+          Value word = numWords == 1 ? ret : extract_val(wordTy, ret, w);
+          if (!isPacked) {
+            resultVals[i + w] = word;
+            continue;
+          }
+          Value pair = bitcast(word, packedTy);
+          for (int ii = 0; ii < 2; ++ii)
+            resultVals[i + 2 * w + ii] =
+                extract_element(valueElemTy, pair, i32_val(ii));
         }
       } else {
         auto ASMReturnTy = void_ty(ctx);
         atom(dstOpr, ptrOpr, valOpr).predicate(rmwMask);
         auto old = ptxBuilderAtomicRMW.launch(rewriter, loc, valueElemTy);
-        if (op->user_begin() == op->user_end()) {
-          rewriter.replaceOp(op, {old});
-          return success();
-        }
         Value atomPtr = getSharedMemoryBase(loc, rewriter, op.getOperation());
         atomPtr = bitcast(atomPtr, ptr_ty(valueElemTy, 3));
         // Only threads with rmwMask = True store the result
@@ -611,9 +1237,13 @@ struct AtomicRMWOpConversion
       }
     }
     if (tensorTy) {
-      Type structTy = getTypeConverter()->convertType(tensorTy);
-      Value resultStruct = getTypeConverter()->packLLElements(
-          loc, resultVals, rewriter, structTy);
+      Value resultStruct;
+      // The result of a red is unused, undef values stand for it
+      if (isReduction)
+        resultStruct = undef(getTypeConverter()->convertType(tensorTy));
+      else
+        resultStruct = getTypeConverter()->packLLElements(loc, resultVals,
+                                                          rewriter, tensorTy);
       rewriter.replaceOp(op, {resultStruct});
     }
     return success();
@@ -697,10 +1327,11 @@ struct InsertSliceAsyncOpConversion
   InsertSliceAsyncOpConversion(
       TritonGPUToLLVMTypeConverter &converter, ModuleAllocation &allocation,
       ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
-      ModuleAxisInfoAnalysis &axisAnalysisPass, PatternBenefit benefit)
+      ModuleAxisInfoAnalysis &axisAnalysisPass, int computeCapability,
+      bool isROCM, PatternBenefit benefit)
       : ConvertTritonGPUOpToLLVMPattern<triton::gpu::InsertSliceAsyncOp>(
             converter, allocation, indexCacheInfo, benefit),
-        LoadStoreConversionBase(axisAnalysisPass) {}
+        LoadStoreConversionBase(axisAnalysisPass, computeCapability, isROCM) {}
 
   LogicalResult
   matchAndRewrite(triton::gpu::InsertSliceAsyncOp op, OpAdaptor adaptor,
@@ -785,6 +1416,18 @@ struct InsertSliceAsyncOpConversion
     unsigned minVec = inVec;
     if (outVec > 1)
       minVec = std::min(outVec, inVec);
+    // The valid elements of a partially masked vector are copied with the
+    // vector, its tail being filled with zeros by cp.async, when they are
+    // known to come first. Other masks, and all masks on AMD GPUs, split the
+    // copies.
+    bool prefixMask = true;
+    if (mask && getMaskAlignment(mask) < minVec) {
+      prefixMask = !isROCM && isPrefixMask(mask, minVec);
+      if (!prefixMask) {
+        minVec = getMaskAlignment(mask);
+        inVec = std::min(inVec, minVec);
+      }
+    }
     unsigned numElems = getTotalElemsPerThread(srcTy);
     unsigned perPhase = resSharedLayout.getPerPhase();
     unsigned maxPhase = resSharedLayout.getMaxPhase();
@@ -806,6 +1449,42 @@ struct InsertSliceAsyncOpConversion
     auto numVecCols = std::max<unsigned>(inVec / outVec, 1);
 
     auto srcIndices = emitIndices(loc, rewriter, srcBlockedLayout, srcTy);
+    Value l2Policy = getL2CachePolicy(rewriter, loc, op.getL2Evict());
+
+    // Copies bypass L1 (.cg, only available for 16 bytes) unless the load
+    // asks to keep its lines there, so that streamed operands do not evict
+    // the data reused across iterations
+    bool keepInL1 = op.getCache() == triton::CacheModifier::CA ||
+                    op.getEvict() == triton::EvictionPolicy::EVICT_LAST;
+
+    // Prefetch into L2 the bytes of a row of the tile contiguous in global
+    // memory, up to 256
+    StringRef l2PrefetchSize;
+    if (auto *axisInfo = axisAnalysisPass.getAxisInfo(src)) {
+      unsigned rowBytes = axisInfo->getContiguity(inOrder[0]) *
+                          resElemTy.getIntOrFloatBitWidth() / 8;
+      if (rowBytes >= 256)
+        l2PrefetchSize = "L2::256B";
+      else if (rowBytes >= 128)
+        l2PrefetchSize = "L2::128B";
+    }
+
+    // AMD GPUs have no asynchronous copies: the words go through registers,
+    // from buffer loads when possible. They are still in shared memory at
+    // the async_wait of the copy, so the pipeline multi-buffers them the
+    // same way.
+    Value rsrc;
+    SmallVector<Value> offsetElems;
+    if (auto operands = getBufferOperands(src)) {
+      auto [base, offset] = *operands;
+      Value llBase = rewriter.getRemappedValue(base);
+      Value llOffset = rewriter.getRemappedValue(offset);
+      if (llBase && llOffset) {
+        rsrc = createBufferResource(rewriter, loc, llBase);
+        offsetElems = getTypeConverter()->unpackLLElements(
+            loc, llOffset, rewriter, offset.getType());
+      }
+    }
 
     for (unsigned elemIdx = 0; elemIdx < numElems; elemIdx += minVec) {
       // 16 * 8 = 128bits
@@ -816,19 +1495,39 @@ struct InsertSliceAsyncOpConversion
       auto numWords = vecBitWidth / bitWidth;
       auto numWordElems = bitWidth / resElemTy.getIntOrFloatBitWidth();
 
-      // Tune CG and CA here.
       auto byteWidth = bitWidth / 8;
       CacheModifier srcCacheModifier =
-          byteWidth == 16 ? CacheModifier::CG : CacheModifier::CA;
-      assert(byteWidth == 16 || byteWidth == 8 || byteWidth == 4);
+          byteWidth == 16 && !keepInL1 ? CacheModifier::CG : CacheModifier::CA;
+      assert(isROCM || byteWidth == 16 || byteWidth == 8 || byteWidth == 4);
       auto resByteWidth = resElemTy.getIntOrFloatBitWidth() / 8;
 
       Value basePtr = sharedPtrs[elemIdx];
       for (size_t wordIdx = 0; wordIdx < numWords; ++wordIdx) {
-        PTXBuilder ptxBuilder;
         auto wordElemIdx = wordIdx * numWordElems;
+        if (isROCM) {
+          auto wordTy = vec_ty(resElemTy, numWordElems);
+          Value pred =
+              op.getMask() ? maskElems[elemIdx + wordElemIdx] : Value();
+          Value word;
+          if (rsrc) {
+            Value byteOffset = mul(offsetElems[elemIdx + wordElemIdx],
+                                   i32_val(resByteWidth));
+            word = emitBufferLoad(rewriter, loc, rsrc, byteOffset, pred,
+                                  wordTy, /*isVolatile=*/false);
+          } else {
+            word = emitMaskedLoad(rewriter, loc,
+                                  srcElems[elemIdx + wordElemIdx], pred,
+                                  /*passThru=*/Value(), wordTy);
+          }
+          Value dstPtr = gep(dstPtrTy, basePtr, i32_val(wordElemIdx));
+          store(word, bitcast(dstPtr, ptr_ty(wordTy, 3)));
+          continue;
+        }
+        PTXBuilder ptxBuilder;
         auto &copyAsyncOp =
             *ptxBuilder.create<PTXCpAsyncLoadInstr>(srcCacheModifier);
+        copyAsyncOp.o("L2::cache_hint", l2Policy != nullptr)
+            .o(l2PrefetchSize, !l2PrefetchSize.empty());
         auto *dstOperand =
             ptxBuilder.newAddrOperand(basePtr, "r", wordElemIdx * resByteWidth);
         auto *srcOperand =
@@ -840,11 +1539,24 @@ struct InsertSliceAsyncOpConversion
           // if there's any mask. cp.async will automatically fill the
           // remaining slots with 0 if cp-size > src-size.
           // XXX(Keren): Always assume other = 0 for now.
-          auto selectOp = select(maskElems[elemIdx + wordElemIdx],
-                                 i32_val(byteWidth), i32_val(0));
-          srcSize = ptxBuilder.newOperand(selectOp, "r");
+          Value size = i32_val(0);
+          if (getMaskAlignment(mask) >= numWordElems) {
+            size = select(maskElems[elemIdx + wordElemIdx], i32_val(byteWidth),
+                          i32_val(0));
+          } else {
+            // The valid elements of the word come first: copy as many
+            assert(prefixMask);
+            for (unsigned i = 0; i < numWordElems; ++i)
+              size = add(size, select(maskElems[elemIdx + wordElemIdx + i],
+                                      i32_val(resByteWidth), i32_val(0)));
+          }
+          srcSize = ptxBuilder.newOperand(size, "r");
         }
-        copyAsyncOp(dstOperand, srcOperand, copySize, srcSize);
+        if (l2Policy)
+          copyAsyncOp(dstOperand, srcOperand, copySize, srcSize,
+                      ptxBuilder.newOperand(l2Policy, "l"));
+        else
+          copyAsyncOp(dstOperand, srcOperand, copySize, srcSize);
         ptxBuilder.launch(rewriter, loc, void_ty(getContext()));
       }
     }
@@ -854,19 +1566,50 @@ struct InsertSliceAsyncOpConversion
   }
 };
 
+// The copies of insert_slice_async being synchronous on AMD GPUs, there is
+// nothing to wait for
+template <typename AsyncOp>
+struct EraseAsyncOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<AsyncOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      AsyncOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(AsyncOp op, typename AsyncOp::Adaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
 void populateLoadStoreOpToLLVMPatterns(
     TritonGPUToLLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
     ModuleAxisInfoAnalysis &axisInfoAnalysis, ModuleAllocation &allocation,
     ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
-    PatternBenefit benefit) {
-  patterns.add<LoadOpConversion>(typeConverter, axisInfoAnalysis, benefit);
-  patterns.add<StoreOpConversion>(typeConverter, axisInfoAnalysis, benefit);
+    int computeCapability, bool isROCM, PatternBenefit benefit) {
+  patterns.add<LoadOpConversion>(typeConverter, axisInfoAnalysis,
+                                 computeCapability, isROCM, benefit);
+  patterns.add<StoreOpConversion>(typeConverter, axisInfoAnalysis,
+                                  computeCapability, benefit);
+  patterns.add<BlockLoadOpConversion>(typeConverter, axisInfoAnalysis,
+                                      indexCacheInfo, computeCapability,
+                                      benefit);
+  patterns.add<TMALoadOpConversion>(typeConverter, allocation,
+                                    indexCacheInfo, benefit);
   patterns.add<AtomicCASOpConversion>(typeConverter, allocation,
                                       axisInfoAnalysis, benefit);
   patterns.add<AtomicRMWOpConversion>(typeConverter, allocation,
-                                      axisInfoAnalysis, benefit);
+                                      axisInfoAnalysis, computeCapability,
+                                      benefit);
   patterns.add<InsertSliceOpConversion>(typeConverter, allocation,
                                         indexCacheInfo, benefit);
-  patterns.add<InsertSliceAsyncOpConversion>(
-      typeConverter, allocation, indexCacheInfo, axisInfoAnalysis, benefit);
+  patterns.add<InsertSliceAsyncOpConversion>(typeConverter, allocation,
+                                             indexCacheInfo, axisInfoAnalysis,
+                                             computeCapability, isROCM,
+                                             benefit);
+  // Tried before the PTX lowering of the async ops
+  if (isROCM)
+    patterns.add<EraseAsyncOpConversion<triton::gpu::AsyncWaitOp>,
+                 EraseAsyncOpConversion<triton::gpu::AsyncCommitGroupOp>>(
+        typeConverter, PatternBenefit(benefit.getBenefit() + 1));
 }
@@ -12,8 +12,8 @@ namespace triton {
 PTXInstr::Operand *
 PTXBuilder::newOperand(mlir::Value value, StringRef constraint,
                        std::function<std::string(int)> formatter) {
-  argArchive.emplace_back(std::make_unique<Operand>(value, constraint));
-  auto *opr = argArchive.back().get();
+  auto *opr = arena.create<Operand>(value, arena.intern(constraint));
+  argArchive.push_back(opr);
   opr->repr = formatter;
   opr->idx = oprCounter++;
   return opr;
@@ -29,7 +29,7 @@ void PTXBuilder::initOperand(Operand *opr) {
   else if (opr->constraint[1] == 'l')
     numBits = 64;
   else
-    llvm_unreachable(("Unknown constraint: " + opr->constraint).c_str());
+    llvm_unreachable(("Unknown constraint: " + opr->constraint.str()).c_str());
   // If numBits is less than 16, we use 16 as default because PTX does not
   // support 8-bit mov.
   numBits = numBits < 16 ? 16 : numBits;
@@ -43,7 +43,7 @@ PTXBuilder::Operand *PTXBuilder::newOperand(StringRef constraint, bool init) {
   assert(constraint.size() == 2 && constraint[0] == '=');
   auto *opr = newOperand();
   opr->idx = oprCounter++;
-  opr->constraint = constraint;
+  opr->constraint = arena.intern(constraint);
   if (init) {
     initOperand(opr);
   }
@@ -51,9 +51,9 @@ PTXBuilder::Operand *PTXBuilder::newOperand(StringRef constraint, bool init) {
 }
 
 PTXBuilder::Operand *PTXBuilder::newConstantOperand(const std::string &v) {
-  argArchive.emplace_back(std::make_unique<Operand>());
-  argArchive.back()->repr = [v](int idx) { return v; };
-  return argArchive.back().get();
+  auto *opr = newOperand();
+  opr->repr = [v](int idx) { return v; };
+  return opr;
 }
 
 PTXBuilder::Operand *PTXBuilder::newConstantOperand(int64_t v) {
@@ -66,13 +66,13 @@ std::string PTXBuilder::getConstraints() const {
   auto args = getAllArgs();
   llvm::SmallVector<std::string, 4> argReprs;
   for (auto arg : args)
-    argReprs.push_back(arg->constraint);
+    argReprs.push_back(arg->constraint.str());
   return strJoin(argReprs, ",");
 }
 
 llvm::SmallVector<Value, 4> PTXBuilder::getAllMLIRArgs() const {
   llvm::SmallVector<Value, 4> res;
-  for (auto &arg : argArchive) {
+  for (auto *arg : argArchive) {
     if (!arg->isList() && arg->value)
       res.push_back(arg->value);
   }
@@ -81,9 +81,9 @@ llvm::SmallVector<Value, 4> PTXBuilder::getAllMLIRArgs() const {
 
 SmallVector<PTXBuilder::Operand *, 4> PTXBuilder::getAllArgs() const {
   llvm::SmallVector<Operand *, 4> res;
-  for (auto &x : argArchive)
+  for (auto *x : argArchive)
     if (!x->isList())
-      res.push_back(x.get());
+      res.push_back(x);
   return res;
 }
 
@@ -131,7 +131,7 @@ PTXInstr::Operand *PTXBuilder::newAddrOperand(mlir::Value addr,
 
 std::string PTXBuilder::dump() const {
   llvm::SmallVector<std::string> lines;
-  for (auto &exec : executions) {
+  for (auto *exec : executions) {
     lines.push_back(exec->dump());
   }
 
@@ -149,10 +149,10 @@ PTXInstrExecution &PTXInstrCommon::call(ArrayRef<Operand *> oprs,
     builder->reorderArgArchive(oprs);
   }
 
-  builder->executions.emplace_back(
-      std::make_unique<PTXInstrExecution>(this, oprs, onlyAttachMLIRArgs));
-
-  return *builder->executions.back();
+  auto *exec =
+      builder->arena.create<PTXInstrExecution>(this, oprs, onlyAttachMLIRArgs);
+  builder->executions.push_back(exec);
+  return *exec;
 }
 
 PTXInstrExecution &PTXInstrCommon::operator()(ArrayRef<Operand *> oprs,
@@ -164,7 +164,7 @@ std::string PTXInstrExecution::dump() const {
   std::string osStr;
   llvm::raw_string_ostream os(osStr);
 
-  std::string instrRepr = strJoin(instr->instrParts, ".");
+  std::string instrRepr = llvm::join(instr->instrParts, ".");
   if (onlyAttachMLIRArgs)
     return instrRepr;
 
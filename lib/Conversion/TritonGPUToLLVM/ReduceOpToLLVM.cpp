@@ -14,18 +14,74 @@ using ::mlir::triton::gpu::getTotalElemsPerThread;
 struct ReduceOpConversion
     : public ConvertTritonGPUOpToLLVMPattern<triton::ReduceOp> {
 public:
-  using ConvertTritonGPUOpToLLVMPattern<
-      triton::ReduceOp>::ConvertTritonGPUOpToLLVMPattern;
+  ReduceOpConversion(
+      TritonGPUToLLVMTypeConverter &typeConverter, ModuleAllocation &allocation,
+      ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
+      int computeCapability, PatternBenefit benefit)
+      : ConvertTritonGPUOpToLLVMPattern<triton::ReduceOp>(
+            typeConverter, allocation, indexCacheInfo, benefit),
+        computeCapability(computeCapability) {}
 
   LogicalResult
   matchAndRewrite(triton::ReduceOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
-    if (ReduceOpHelper(op).isFastReduction())
+    ReduceOpHelper helper(op);
+    if (helper.isFastReduction() || helper.isWarpSynchronous())
       return matchAndRewriteFast(op, adaptor, rewriter);
     return matchAndRewriteBasic(op, adaptor, rewriter);
   }
 
 private:
+  int computeCapability;
+
+  // Returns the operation and type of the redux.sync computing the combine
+  // region of `op` on sm80+, i.e. a 32-bit integer add, min or max
+  std::optional<std::pair<StringRef, StringRef>>
+  getReduxKind(triton::ReduceOp op) const {
+    if (computeCapability < 80 || op.getNumOperands() != 1 ||
+        !op.getElementTypes()[0].isInteger(32))
+      return std::nullopt;
+    Block &block = op.getCombineOp().front();
+    if (block.getOperations().size() != 2)
+      return std::nullopt;
+    // The combine must be `op(%acc, %cur)` on the arguments of the region
+    Operation *combine = &block.front();
+    auto isArgument = [&](Value v) {
+      auto arg = v.dyn_cast<BlockArgument>();
+      return arg && arg.getOwner() == &block;
+    };
+    if (combine->getNumOperands() != 2 || combine->getNumResults() != 1 ||
+        !isArgument(combine->getOperand(0)) ||
+        !isArgument(combine->getOperand(1)) ||
+        combine->getOperand(0) == combine->getOperand(1) ||
+        block.getTerminator()->getOperand(0) != combine->getResult(0))
+      return std::nullopt;
+    if (isa<arith::AddIOp>(combine))
+      return std::make_pair("add", "s32");
+    if (isa<arith::MinSIOp>(combine))
+      return std::make_pair("min", "s32");
+    if (isa<arith::MaxSIOp>(combine))
+      return std::make_pair("max", "s32");
+    if (isa<arith::MinUIOp>(combine))
+      return std::make_pair("min", "u32");
+    if (isa<arith::MaxUIOp>(combine))
+      return std::make_pair("max", "u32");
+    return std::nullopt;
+  }
+
+  // Reduces `val` over all the lanes of the warp
+  Value reduxSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
+                  std::pair<StringRef, StringRef> kind) const {
+    PTXBuilder builder;
+    auto &redux =
+        builder.create("redux.sync")->o(kind.first.str()).o(kind.second.str());
+    auto *dOpr = builder.newOperand("=r");
+    auto *aOpr = builder.newOperand(val, "r");
+    auto *maskOpr = builder.newConstantOperand("0xffffffff");
+    redux(dOpr, aOpr, maskOpr);
+    return builder.launch(rewriter, loc, val.getType(), false);
+  }
+
   void accumulate(ConversionPatternRewriter &rewriter, Region &combineOp,
                   llvm::SmallVectorImpl<Value> &acc, ValueRange cur,
                   bool isFirst) const {
@@ -114,7 +170,7 @@ private:
       // writeIdx[originalAxis] = index[originalAxis] / axisSizePerThread
       writeIdx[originalAxis] = udiv(index[originalAxis], axisSizePerThread);
     } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-      if (!mmaLayout.isAmpere()) {
+      if (!mmaLayout.isAmpere() && !mmaLayout.isHopper()) {
         llvm::report_fatal_error("Unsupported layout");
       }
       if (originalAxis == 0) {
@@ -329,7 +385,6 @@ private:
 
     auto smemShapes = helper.getScratchConfigsFast();
     unsigned elems = product<unsigned>(smemShapes[0]);
-    unsigned maxElems = std::max(elems, product<unsigned>(smemShapes[1]));
 
     unsigned sizeIntraWarps = helper.getIntraWarpSizeWithUniqueData();
     unsigned sizeInterWarps = helper.getInterWarpSizeWithUniqueData();
@@ -342,7 +397,7 @@ private:
           getSharedMemoryBase(loc, rewriter, op.getOperation()), elemPtrTys[0]);
       for (unsigned i = 1; i < op.getNumOperands(); ++i) {
         smemBases[i] =
-            bitcast(gep(elemPtrTys[i - 1], smemBases[i - 1], i32_val(maxElems)),
+            bitcast(gep(elemPtrTys[i - 1], smemBases[i - 1], i32_val(elems)),
                     elemPtrTys[i]);
       }
     }
@@ -391,16 +446,33 @@ private:
     Value zero = i32_val(0);
     Value laneZero = icmp_eq(laneIdAxis, zero);
 
+    // Lanes along the reduced axis of a warp-synchronous reduction on
+    // another axis than the fastest are this many lanes apart
+    unsigned laneStride = 1;
+    if (!helper.isFastReduction()) {
+      auto layoutThreadsPerWarp = triton::gpu::getThreadsPerWarp(srcLayout);
+      for (unsigned d : order) {
+        if (d == axis)
+          break;
+        laneStride *= layoutThreadsPerWarp[d];
+      }
+    }
+    // A single redux.sync reduces the values of all the lanes of the warp
+    auto reduxKind = getReduxKind(op);
+    bool useRedux = reduxKind && sizeIntraWarps == 32;
+
     std::map<SmallVector<unsigned>, SmallVector<Value>> finalAccs;
     for (auto it : accs) {
       const SmallVector<unsigned> &key = it.first;
       SmallVector<Value> acc = it.second;
 
       // Reduce within warps
-      for (unsigned N = sizeIntraWarps / 2; N > 0; N >>= 1) {
+      if (useRedux)
+        acc[0] = reduxSync(loc, rewriter, acc[0], *reduxKind);
+      for (unsigned N = useRedux ? 0 : sizeIntraWarps / 2; N > 0; N >>= 1) {
         SmallVector<Value> shfl(op.getNumOperands());
         for (unsigned i = 0; i < op.getNumOperands(); ++i) {
-          shfl[i] = shflSync(loc, rewriter, acc[i], N);
+          shfl[i] = shflSync(loc, rewriter, acc[i], N * laneStride);
         }
         accumulate(rewriter, *combineOp, acc, shfl, false);
       }
@@ -460,11 +532,13 @@ private:
     unsigned elemsPerThread = std::max<unsigned>(elems / numThreads, 1);
     Value readOffset = threadId;
     for (unsigned round = 0; round < elemsPerThread; ++round) {
-      // FIXME(Qingyi): need predicate icmp_slt(threadId,
-      // i32_val(sizeInerWarps))
+      // The scratch buffer only holds `elems` partial results; threads past
+      // them read the first one, and their results are never stored.
+      Value threadIsNeeded = icmp_slt(readOffset, i32_val(elems));
+      Value clampedReadOffset = select(threadIsNeeded, readOffset, zero);
       SmallVector<Value> acc(op.getNumOperands());
       for (unsigned i = 0; i < op.getNumOperands(); ++i) {
-        Value readPtr = gep(elemPtrTys[i], smemBases[i], readOffset);
+        Value readPtr = gep(elemPtrTys[i], smemBases[i], clampedReadOffset);
         acc[i] = load(readPtr);
       }
 
@@ -482,7 +556,6 @@ private:
       for (unsigned i = 0; i < op.getNumOperands(); ++i) {
         writePtrs[i] = gep(elemPtrTys[i], smemBases[i], writeOffset);
       }
-      Value threadIsNeeded = icmp_slt(threadId, i32_val(elems));
       Value laneIdModSizeInterWarps = urem(laneId, i32_val(sizeInterWarps));
       Value laneIdModSizeInterWarpsIsZero =
           icmp_eq(laneIdModSizeInterWarps, zero);
@@ -537,7 +610,7 @@ void populateReduceOpToLLVMPatterns(
     TritonGPUToLLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
     ModuleAllocation &allocation,
     ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
-    PatternBenefit benefit) {
+    int computeCapability, PatternBenefit benefit) {
   patterns.add<ReduceOpConversion>(typeConverter, allocation, indexCacheInfo,
-                                   benefit);
+                                   computeCapability, benefit);
 }
@@ -7,6 +7,7 @@ using namespace mlir::triton;
 
 using ::mlir::LLVM::delinearize;
 using ::mlir::LLVM::linearize;
+using ::mlir::LLVM::shflIdxSync;
 using ::mlir::LLVM::shflUpSync;
 using ::mlir::LLVM::storeShared;
 
@@ -210,6 +211,68 @@ static void AddPartialReduce(SmallVector<Value> &srcValues,
   }
 }
 
+// Same as AddPartialReduce when the scan axis is within a single warp. The
+// partial reduction of the previous blocks along axis is then held by the last
+// lane along axis, and is broadcast to the other lanes with a warp shuffle
+// instead of going through shared memory.
+static void AddPartialReduceOneWarp(SmallVector<Value> &srcValues,
+                                    ConversionPatternRewriter &rewriter,
+                                    ScanLoweringHelper &helper, Value laneId,
+                                    Value laneIdAxis) {
+  Location loc = helper.getLoc();
+  unsigned scanElementsPerThreads = helper.getAxisNumElementsPerThread();
+  unsigned parallelElementsPerThread = helper.getNonAxisNumElementsPerThread();
+  unsigned elementStride = helper.getAxisElementStride();
+  unsigned threadStride = helper.getAxisThreadStride();
+  unsigned scanDim = helper.getAxisNumThreadsPerWarp();
+  unsigned numScanBlocks = helper.getAxisNumBlocks();
+  unsigned numParallelBlocks = helper.getNonAxisNumBlocks();
+  unsigned blockStride = helper.getAxisBlockStride();
+  Value maskFirstLane = icmp_eq(laneIdAxis, i32_val(0));
+  Value lastLaneId =
+      add(laneId, mul(sub(i32_val(scanDim - 1), laneIdAxis),
+                      i32_val(threadStride)));
+  SmallVector<Value> accumulators(numParallelBlocks *
+                                  parallelElementsPerThread);
+  unsigned chunkId = 0;
+  for (unsigned srcIndex = 0; srcIndex < srcValues.size(); srcIndex++) {
+    unsigned elementIdx = (srcIndex / elementStride) % scanElementsPerThreads;
+    // Only consider the last element of each contiguous chunk of elements.
+    if (elementIdx != scanElementsPerThreads - 1)
+      continue;
+    unsigned blockId = chunkId / parallelElementsPerThread;
+    unsigned parallelBlockId =
+        blockId % blockStride +
+        ((blockId / blockStride) / numScanBlocks) * blockStride;
+    unsigned accumulatorIndex = chunkId % parallelElementsPerThread +
+                                parallelBlockId * parallelElementsPerThread;
+    Value &accumulator = accumulators[accumulatorIndex];
+    // Combine the chunk with the reduction of the previous blocks, if any.
+    if (accumulator) {
+      Value temp = accumulator;
+      accumulate(rewriter, helper.getCombineOp(), temp, srcValues[srcIndex]);
+      srcValues[srcIndex] = temp;
+    }
+    // Update the rest of the contiguous elements.
+    Value lastElement =
+        shflUpSync(loc, rewriter, srcValues[srcIndex], threadStride);
+    if (accumulator)
+      lastElement = select(maskFirstLane, accumulator, lastElement);
+    for (unsigned i = 1; i < scanElementsPerThreads; ++i) {
+      Value laneValue = lastElement;
+      accumulate(rewriter, helper.getCombineOp(), laneValue,
+                 srcValues[srcIndex - i * elementStride]);
+      // The first lane of the first block has nothing to accumulate.
+      if (!accumulator)
+        laneValue = select(maskFirstLane,
+                           srcValues[srcIndex - i * elementStride], laneValue);
+      srcValues[srcIndex - i * elementStride] = laneValue;
+    }
+    accumulator = shflIdxSync(loc, rewriter, srcValues[srcIndex], lastLaneId);
+    chunkId++;
+  }
+}
+
 namespace {
 struct ScanOpConversion
     : public ConvertTritonGPUOpToLLVMPattern<triton::ScanOp> {
@@ -294,18 +357,25 @@ ScanOpConversion::emitFastScan(triton::ScanOp op, triton::ScanOpAdaptor adaptor,
   // elements.
   warpScan(srcValues, rewriter, helper, laneIdAxis);
 
-  // Store the partial reducing for each warp into shared memory.
-  Type elemPtrTys = LLVM::LLVMPointerType::get(srcValues[0].getType(), 3);
-  Value baseSharedMemPtr = bitcast(
-      getSharedMemoryBase(loc, rewriter, op.getOperation()), elemPtrTys);
-  storeWarpAccumulator(srcValues, rewriter, helper, laneIdAxis, warpIdAxis,
-                       baseSharedMemPtr, flatIdParallel);
-  barrier();
-  // Read back the partial reduction of each warp and accumulate them based on
-  // warpId. Then update each chunk of contiguous elements by adding the
-  // accumulated value from the previous lane.
-  AddPartialReduce(srcValues, rewriter, helper, baseSharedMemPtr, warpIdAxis,
-                   laneIdAxis, flatIdParallel);
+  if (helper.getAxisNumWarps() == 1) {
+    // The whole axis is within a warp: carry the partial reductions between
+    // blocks and chunks of contiguous elements with warp shuffles only.
+    Value laneId = urem(getThreadId(rewriter, loc), i32_val(32));
+    AddPartialReduceOneWarp(srcValues, rewriter, helper, laneId, laneIdAxis);
+  } else {
+    // Store the partial reducing for each warp into shared memory.
+    Type elemPtrTys = LLVM::LLVMPointerType::get(srcValues[0].getType(), 3);
+    Value baseSharedMemPtr = bitcast(
+        getSharedMemoryBase(loc, rewriter, op.getOperation()), elemPtrTys);
+    storeWarpAccumulator(srcValues, rewriter, helper, laneIdAxis, warpIdAxis,
+                         baseSharedMemPtr, flatIdParallel);
+    barrier();
+    // Read back the partial reduction of each warp and accumulate them based
+    // on warpId. Then update each chunk of contiguous elements by adding the
+    // accumulated value from the previous lane.
+    AddPartialReduce(srcValues, rewriter, helper, baseSharedMemPtr,
+                     warpIdAxis, laneIdAxis, flatIdParallel);
+  }
 
   Value results = getTypeConverter()->packLLElements(loc, srcValues, rewriter,
                                                      input.getType());
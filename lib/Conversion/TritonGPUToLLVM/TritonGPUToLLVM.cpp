@@ -244,6 +244,215 @@ struct PrintOpConversion
   }
 };
 
+// With the print buffer, each warp reserves a record in a ring buffer of
+// global memory with a single atomic and writes its values there as binary,
+// for the runtime to format after the kernel. The ring buffer is described
+// by the `triton_print_buffer` global, which the runtime sets when it loads
+// the module: the address of its words, the number of words for records
+// (a power of two) and the key of the module. The first two words hold the
+// 64-bit count of words ever reserved, the records follow.
+//
+// A record is made of the words:
+//   [0] its logical offset, the count of words reserved before it
+//   [1] the key of the module
+//   [2] the id of the print in the module << 16 | the number of words
+//   [3, 6) the program id
+//   [6] the warp id
+// and then, for each 32-bit word of each element of each argument, the words
+// of the 32 lanes.
+struct BufferedPrintOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::PrintOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::PrintOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  static constexpr int kNumHeaderWords = 7;
+  static constexpr int kWarpSize = 32;
+
+  LogicalResult
+  matchAndRewrite(triton::PrintOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op->getLoc();
+    auto printId = op->getAttrOfType<IntegerAttr>("print_id");
+    if (!printId)
+      return failure();
+    // the 32-bit words of every value of the thread
+    SmallVector<Value> words;
+    for (size_t i = 0; i < op.getNumOperands(); i++) {
+      auto elems = getTypeConverter()->unpackLLElements(
+          loc, adaptor.getOperands()[i], rewriter, op.getOperand(i).getType());
+      for (Value elem : elems) {
+        Type ty = elem.getType();
+        if (ty.isa<LLVM::LLVMPointerType>())
+          elem = ptrtoint(i64_ty, elem);
+        unsigned bits = elem.getType().getIntOrFloatBitWidth();
+        if (!elem.getType().isInteger(bits))
+          elem = bitcast(elem, int_ty(bits));
+        if (bits > 32) {
+          Value high =
+              rewriter.create<LLVM::LShrOp>(loc, elem, int_val(bits, 32));
+          words.push_back(rewriter.create<LLVM::TruncOp>(loc, i32_ty, elem));
+          words.push_back(rewriter.create<LLVM::TruncOp>(loc, i32_ty, high));
+        } else {
+          words.push_back(bits < 32 ? zext(i32_ty, elem) : elem);
+        }
+      }
+    }
+    int64_t numWords = kNumHeaderWords + kWarpSize * words.size();
+    if (numWords >= (1 << 16))
+      return failure();
+
+    auto global = getPrintBufferDeclaration(rewriter);
+    Value globalPtr = rewriter.create<LLVM::AddressOfOp>(loc, global);
+    auto field = [&](int i) {
+      return load(gep(ptr_ty(i64_ty, 1), globalPtr,
+                      ArrayRef<Value>{i32_val(0), i32_val(i)}));
+    };
+    Value base = field(0);
+    Value capacityMask = sub(field(1), int_val(64, 1));
+    Value key = rewriter.create<LLVM::TruncOp>(loc, i32_ty, field(2));
+    Value enabled = icmp_ne(base, int_val(64, 0));
+    Value basePtr = inttoptr(ptr_ty(i32_ty, 1), base);
+
+    Value threadId = getThreadId(rewriter, loc);
+    Value laneId = urem(threadId, i32_val(kWarpSize));
+    Value warpId = udiv(threadId, i32_val(kWarpSize));
+
+    // the first lane reserves the record of the warp
+    PTXBuilder ptxBuilderAtom;
+    auto *dstOpr = ptxBuilderAtom.newOperand("=l", /*init=*/true);
+    auto *headOpr = ptxBuilderAtom.newAddrOperand(basePtr, "l");
+    auto *sizeOpr = ptxBuilderAtom.newOperand(int_val(64, numWords), "l");
+    auto &atom = ptxBuilderAtom.create<>("atom")->global().o("add").o("u64");
+    atom(dstOpr, headOpr, sizeOpr)
+        .predicate(and_(enabled, icmp_eq(laneId, i32_val(0))), "b");
+    Value offset = ptxBuilderAtom.launch(rewriter, loc, i64_ty);
+    offset = shflIdxSync(loc, rewriter, offset, i32_val(0));
+
+    auto storeWord = [&](Value idx, Value word, Value pred) {
+      Value ringIdx = and_(add(offset, zext(i64_ty, idx)), capacityMask);
+      Value ptr = gep(ptr_ty(i32_ty, 1), basePtr,
+                      add(ringIdx, int_val(64, 2)));
+      PTXBuilder ptxBuilderStore;
+      auto &st = ptxBuilderStore.create<>("st")->global().b(32);
+      st(ptxBuilderStore.newAddrOperand(ptr, "l"),
+         ptxBuilderStore.newOperand(word, "r"))
+          .predicate(pred, "b");
+      ptxBuilderStore.launch(rewriter, loc, void_ty(rewriter.getContext()));
+    };
+
+    // lane i writes header word i
+    SmallVector<Value> header = {
+        rewriter.create<LLVM::TruncOp>(loc, i32_ty, offset), key,
+        i32_val(printId.getInt() << 16 | numWords)};
+    for (auto dim : {mlir::gpu::Dimension::x, mlir::gpu::Dimension::y,
+                     mlir::gpu::Dimension::z})
+      header.push_back(rewriter.create<arith::IndexCastOp>(
+          loc, i32_ty, rewriter.create<::mlir::gpu::BlockIdOp>(loc, dim)));
+    header.push_back(warpId);
+    Value headerWord = header.back();
+    for (int i = kNumHeaderWords - 2; i >= 0; --i)
+      headerWord = select(icmp_eq(laneId, i32_val(i)), header[i], headerWord);
+    storeWord(laneId, headerWord,
+              and_(enabled, icmp_ult(laneId, i32_val(kNumHeaderWords))));
+
+    for (const auto &word : llvm::enumerate(words)) {
+      Value idx = add(laneId, i32_val(kNumHeaderWords +
+                                      kWarpSize * word.index()));
+      storeWord(idx, word.value(), enabled);
+    }
+    rewriter.eraseOp(op);
+    return success();
+  }
+
+  static LLVM::GlobalOp
+  getPrintBufferDeclaration(ConversionPatternRewriter &rewriter) {
+    auto moduleOp =
+        rewriter.getBlock()->getParent()->getParentOfType<ModuleOp>();
+    StringRef name("triton_print_buffer");
+    if (Operation *global = moduleOp.lookupSymbol(name))
+      return cast<LLVM::GlobalOp>(global);
+
+    auto *ctx = rewriter.getContext();
+    ConversionPatternRewriter::InsertionGuard guard(rewriter);
+    rewriter.setInsertionPointToStart(moduleOp.getBody());
+    auto type = LLVM::LLVMArrayType::get(i64_ty, 3);
+    auto zeros = DenseElementsAttr::get(
+        RankedTensorType::get({3}, i64_ty), rewriter.getI64IntegerAttr(0));
+    return rewriter.create<LLVM::GlobalOp>(
+        UnknownLoc::get(ctx), type, /*isConstant=*/false,
+        LLVM::Linkage::External, name, zeros, /*alignment=*/8,
+        /*addrSpace=*/1);
+  }
+};
+
+// The first lane of each warp subtracts the clock from the cycles of the
+// region at its entry, and adds it at its exit, along with a visit. The
+// `triton_profile_buffer` global, which the runtime sets when it loads the
+// module, holds the address of the two 64-bit counters of each region.
+struct ProfileRegionOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::ProfileRegionOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::ProfileRegionOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::ProfileRegionOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op->getLoc();
+    auto regionId = op->getAttrOfType<IntegerAttr>("region_id");
+    if (!regionId)
+      return failure();
+    auto global = getProfileBufferDeclaration(rewriter);
+    Value base = load(rewriter.create<LLVM::AddressOfOp>(loc, global));
+    Value laneId = urem(getThreadId(rewriter, loc), i32_val(32));
+    Value pred = and_(icmp_ne(base, int_val(64, 0)),
+                      icmp_eq(laneId, i32_val(0)));
+    Value counters = gep(ptr_ty(i64_ty, 1),
+                         inttoptr(ptr_ty(i64_ty, 1), base),
+                         i32_val(2 * regionId.getInt()));
+
+    PTXBuilder ptxBuilderClock;
+    auto &mov = ptxBuilderClock.create<>("mov")->o("u64");
+    mov(ptxBuilderClock.newOperand("=l", /*init=*/true),
+        ptxBuilderClock.newConstantOperand("%clock64"));
+    Value clock = ptxBuilderClock.launch(rewriter, loc, i64_ty);
+
+    auto accumulate = [&](int offset, Value val) {
+      PTXBuilder ptxBuilderRed;
+      auto &red = ptxBuilderRed.create<>("red")->global().o("add").o("u64");
+      red(ptxBuilderRed.newAddrOperand(
+              gep(ptr_ty(i64_ty, 1), counters, i32_val(offset)), "l"),
+          ptxBuilderRed.newOperand(val, "l"))
+          .predicate(pred, "b");
+      ptxBuilderRed.launch(rewriter, loc, void_ty(rewriter.getContext()));
+    };
+    if (op.getEnd()) {
+      accumulate(0, clock);
+      accumulate(1, int_val(64, 1));
+    } else {
+      accumulate(0, sub(int_val(64, 0), clock));
+    }
+    rewriter.eraseOp(op);
+    return success();
+  }
+
+  static LLVM::GlobalOp
+  getProfileBufferDeclaration(ConversionPatternRewriter &rewriter) {
+    auto moduleOp =
+        rewriter.getBlock()->getParent()->getParentOfType<ModuleOp>();
+    StringRef name("triton_profile_buffer");
+    if (Operation *global = moduleOp.lookupSymbol(name))
+      return cast<LLVM::GlobalOp>(global);
+
+    auto *ctx = rewriter.getContext();
+    ConversionPatternRewriter::InsertionGuard guard(rewriter);
+    rewriter.setInsertionPointToStart(moduleOp.getBody());
+    return rewriter.create<LLVM::GlobalOp>(
+        UnknownLoc::get(ctx), i64_ty, /*isConstant=*/false,
+        LLVM::Linkage::External, name, rewriter.getI64IntegerAttr(0),
+        /*alignment=*/8, /*addrSpace=*/1);
+  }
+};
+
 struct AssertOpConversion
     : public ConvertTritonGPUOpToLLVMPattern<triton::AssertOp> {
   using ConvertTritonGPUOpToLLVMPattern<
@@ -426,6 +635,63 @@ struct GetNumProgramsOpConversion
                                                   mlir::gpu::Dimension::z};
 };
 
+// Reads the special register `reg` of the cluster of the CTA
+static Value getClusterRegister(ConversionPatternRewriter &rewriter,
+                                Location loc, StringRef reg) {
+  PTXBuilder ptxBuilder;
+  auto &mov = ptxBuilder.create<>("mov")->o("u32");
+  mov(ptxBuilder.newOperand("=r"), ptxBuilder.newConstantOperand(reg.str()));
+  return ptxBuilder.launch(rewriter, loc, i32_ty, /*hasSideEffect=*/false);
+}
+
+struct GetClusterCTARankOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::GetClusterCTARankOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::GetClusterCTARankOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::GetClusterCTARankOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    rewriter.replaceOp(
+        op, getClusterRegister(rewriter, op.getLoc(), "%cluster_ctarank"));
+    return success();
+  }
+};
+
+struct GetClusterNumCTAsOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::GetClusterNumCTAsOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::GetClusterNumCTAsOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::GetClusterNumCTAsOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    rewriter.replaceOp(
+        op, getClusterRegister(rewriter, op.getLoc(), "%cluster_nctarank"));
+    return success();
+  }
+};
+
+struct ClusterBarrierOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::ClusterBarrierOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::ClusterBarrierOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::ClusterBarrierOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    // the arrival releases and the wait acquires the memory accesses of the
+    // threads of the cluster
+    PTXBuilder ptxBuilder;
+    ptxBuilder.create<>("barrier.cluster.arrive.release.aligned")
+        ->operator()();
+    ptxBuilder.create<>("barrier.cluster.wait.acquire.aligned")->operator()();
+    ptxBuilder.launch(rewriter, op.getLoc(), void_ty(op.getContext()));
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
 struct AddPtrOpConversion
     : public ConvertTritonGPUOpToLLVMPattern<triton::AddPtrOp> {
   using ConvertTritonGPUOpToLLVMPattern<
@@ -575,6 +841,24 @@ struct AsyncWaitOpConversion
   }
 };
 
+struct WarpSyncOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::WarpSyncOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::gpu::WarpSyncOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::WarpSyncOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    PTXBuilder ptxBuilder;
+    auto &warpSyncOp = *ptxBuilder.create<>("bar.warp.sync");
+    warpSyncOp(ptxBuilder.newConstantOperand("0xffffffff"));
+    ptxBuilder.launch(rewriter, op.getLoc(), void_ty(op.getContext()));
+    // Safe to remove the op since it doesn't have any return value.
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
 struct AsyncCommitGroupOpConversion
     : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::AsyncCommitGroupOp> {
   using ConvertTritonGPUOpToLLVMPattern<
@@ -593,6 +877,87 @@ struct AsyncCommitGroupOpConversion
   }
 };
 
+struct GetWarpGroupIdOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::GetWarpGroupIdOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::gpu::GetWarpGroupIdOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::GetWarpGroupIdOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    Value groupId = i32_val(0);
+    if (int groupSize = getWarpGroupSize(rewriter))
+      groupId = udiv(getCTAThreadId(rewriter, loc), i32_val(groupSize));
+    rewriter.replaceOp(op, groupId);
+    return success();
+  }
+};
+
+// `bar.arrive` or `bar.sync` of the executing warps on barrier `barrier`
+static void createNamedBarrier(ConversionPatternRewriter &rewriter,
+                               Location loc, const std::string &instr,
+                               Value barrier, int numThreads) {
+  PTXBuilder ptxBuilder;
+  auto &barOp = *ptxBuilder.create<>(instr);
+  barOp(ptxBuilder.newOperand(barrier, "r"),
+        ptxBuilder.newConstantOperand(numThreads));
+  ptxBuilder.launch(rewriter, loc, void_ty(rewriter.getContext()));
+}
+
+struct NamedBarrierArriveOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<
+          triton::gpu::NamedBarrierArriveOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::gpu::NamedBarrierArriveOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::NamedBarrierArriveOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    createNamedBarrier(rewriter, op.getLoc(), "bar.arrive",
+                       adaptor.getBarrier(), op.getNumThreads());
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+struct NamedBarrierWaitOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::NamedBarrierWaitOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::gpu::NamedBarrierWaitOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::NamedBarrierWaitOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    createNamedBarrier(rewriter, op.getLoc(), "bar.sync", adaptor.getBarrier(),
+                       op.getNumThreads());
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+// With several warp groups, a barrier only synchronizes the warps of the
+// executing group, on the barrier of that group
+struct WarpGroupBarrierOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<mlir::gpu::BarrierOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      mlir::gpu::BarrierOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(mlir::gpu::BarrierOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    int groupSize = getWarpGroupSize(rewriter);
+    if (!groupSize)
+      return failure();
+    Location loc = op->getLoc();
+    Value groupId = udiv(getCTAThreadId(rewriter, loc), i32_val(groupSize));
+    createNamedBarrier(rewriter, loc, "bar.sync", add(groupId, i32_val(1)),
+                       groupSize);
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
 namespace mlir {
 namespace LLVM {
 
@@ -620,20 +985,35 @@ void populateTritonGPUToLLVMPatterns(
     TritonGPUToLLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
     ModuleAllocation &moduleAllocation,
     ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
-    PatternBenefit benefit) {
+    bool printBuffer, PatternBenefit benefit) {
   patterns.add<AddPtrOpConversion>(typeConverter, benefit);
   patterns.add<AllocTensorOpConversion>(typeConverter, moduleAllocation,
                                         benefit);
   patterns.add<AsyncCommitGroupOpConversion>(typeConverter, benefit);
   patterns.add<AsyncWaitOpConversion>(typeConverter, benefit);
   patterns.add<BroadcastOpConversion>(typeConverter, benefit);
+  patterns.add<WarpSyncOpConversion>(typeConverter, benefit);
 
   patterns.add<ExtractSliceOpConversion>(typeConverter, moduleAllocation,
                                          benefit);
   patterns.add<GetProgramIdOpConversion>(typeConverter, benefit);
   patterns.add<GetNumProgramsOpConversion>(typeConverter, benefit);
+  patterns.add<GetClusterCTARankOpConversion>(typeConverter, benefit);
+  patterns.add<GetClusterNumCTAsOpConversion>(typeConverter, benefit);
+  patterns.add<ClusterBarrierOpConversion>(typeConverter, benefit);
+  patterns.add<GetWarpGroupIdOpConversion>(typeConverter, benefit);
+  patterns.add<NamedBarrierArriveOpConversion>(typeConverter, benefit);
+  patterns.add<NamedBarrierWaitOpConversion>(typeConverter, benefit);
+  // Tried before the native lowering of barriers
+  patterns.add<WarpGroupBarrierOpConversion>(
+      typeConverter, PatternBenefit(benefit.getBenefit() + 1));
   patterns.add<MakeRangeOpConversion>(typeConverter, indexCacheInfo, benefit);
   patterns.add<ReturnOpConversion>(typeConverter, benefit);
   patterns.add<PrintOpConversion>(typeConverter, benefit);
+  // Buffered prints too long for a record fall back to vprintf
+  if (printBuffer)
+    patterns.add<BufferedPrintOpConversion>(
+        typeConverter, PatternBenefit(benefit.getBenefit() + 1));
   patterns.add<AssertOpConversion>(typeConverter, benefit);
+  patterns.add<ProfileRegionOpConversion>(typeConverter, benefit);
 }
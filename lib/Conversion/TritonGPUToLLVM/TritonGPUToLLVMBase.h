@@ -19,6 +19,7 @@ using ::mlir::LLVM::delinearize;
 using ::mlir::LLVM::SharedMemoryObject;
 using ::mlir::triton::gpu::BlockedEncodingAttr;
 using ::mlir::triton::gpu::DotOperandEncodingAttr;
+using ::mlir::triton::gpu::MfmaEncodingAttr;
 using ::mlir::triton::gpu::MmaEncodingAttr;
 using ::mlir::triton::gpu::SliceEncodingAttr;
 
@@ -171,12 +172,20 @@ class ConvertTritonGPUOpToLLVMPatternBase {
 public:
   // Two levels of value cache in emitting indices calculation:
   // Key: pair<layout, shape>
-  struct IndexCacheInfo {
+  // The indices, and the thread id they derive from, are emitted once per
+  // function at its entry, so that they dominate and serve all its blocks.
+  struct FuncIndexCache {
     DenseMap<IndexCacheKeyT, SmallVector<Value>, CacheKeyDenseMapInfo>
-        *baseIndexCache;
+        baseIndexCache;
     DenseMap<IndexCacheKeyT, SmallVector<SmallVector<Value>>,
-             CacheKeyDenseMapInfo> *indexCache;
-    OpBuilder::InsertPoint *indexInsertPoint;
+             CacheKeyDenseMapInfo>
+        indexCache;
+    Value threadId;
+    OpBuilder::InsertPoint insertPoint;
+  };
+  struct IndexCacheInfo {
+    // Key: the LLVM function
+    DenseMap<Operation *, FuncIndexCache> *funcIndexCaches = nullptr;
   };
 
   explicit ConvertTritonGPUOpToLLVMPatternBase(
@@ -217,12 +226,41 @@ public:
     return llvmStruct;
   }
 
-  Value getThreadId(ConversionPatternRewriter &rewriter, Location loc) const {
+  // Thread id in the CTA, not accounting for warp groups
+  static Value getCTAThreadId(ConversionPatternRewriter &rewriter,
+                              Location loc) {
     auto tid = rewriter.create<::mlir::gpu::ThreadIdOp>(
         loc, ::mlir::gpu::Dimension::x);
     return rewriter.create<arith::IndexCastOp>(loc, i32_ty, tid);
   }
 
+  // Number of threads of a warp group, 0 if the CTA has a single group
+  static int getWarpGroupSize(ConversionPatternRewriter &rewriter) {
+    auto mod = rewriter.getBlock()->getParentOp()->getParentOfType<ModuleOp>();
+    if (triton::gpu::TritonGPUDialect::getNumWarpGroups(mod) <= 1)
+      return 0;
+    return triton::gpu::TritonGPUDialect::getNumWarps(mod) *
+           triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+  }
+
+  Value getThreadId(ConversionPatternRewriter &rewriter, Location loc) const {
+    FuncIndexCache *cache = getFuncIndexCache(rewriter);
+    if (cache && cache->threadId)
+      return cache->threadId;
+    ConversionPatternRewriter::InsertionGuard guard(rewriter);
+    if (cache)
+      restoreInsertionPointIfSet(cache, rewriter);
+    Value tid = getCTAThreadId(rewriter, loc);
+    // Each warp group sees the thread ids of a CTA of its own
+    if (int groupSize = getWarpGroupSize(rewriter))
+      tid = urem(tid, i32_val(groupSize));
+    if (cache) {
+      cache->threadId = tid;
+      cache->insertPoint = rewriter.saveInsertionPoint();
+    }
+    return tid;
+  }
+
   // -----------------------------------------------------------------------
   // Shared memory utilities
   // -----------------------------------------------------------------------
@@ -478,7 +516,7 @@ public:
       auto warpsPerCTA = triton::gpu::getWarpsPerCTA(layout);
       auto order = triton::gpu::getOrder(layout);
       auto shapePerCTA = triton::gpu::getShapePerCTA(layout, shape);
-      Value warpSize = i32_val(32);
+      Value warpSize = i32_val(product<unsigned>(threadsPerWarp));
       Value laneId = urem(tid, warpSize);
       Value warpId = udiv(tid, warpSize);
       SmallVector<Value> multiDimWarpId =
@@ -540,14 +578,13 @@ public:
                                             Attribute layout,
                                             RankedTensorType type) const {
     IndexCacheKeyT key = std::make_pair(layout, type);
-    auto cache = indexCacheInfo.baseIndexCache;
-    auto insertPt = indexCacheInfo.indexInsertPoint;
-    if (cache && cache->count(key) > 0) {
-      return cache->lookup(key);
+    FuncIndexCache *cache = getFuncIndexCache(rewriter);
+    if (cache && cache->baseIndexCache.count(key) > 0) {
+      return cache->baseIndexCache.lookup(key);
     } else {
       ConversionPatternRewriter::InsertionGuard guard(rewriter);
       if (cache)
-        restoreInsertionPointIfSet(insertPt, rewriter);
+        restoreInsertionPointIfSet(cache, rewriter);
       SmallVector<Value> result;
       if (auto blockedLayout = layout.dyn_cast<BlockedEncodingAttr>()) {
         result =
@@ -555,8 +592,10 @@ public:
       } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
         if (mmaLayout.isVolta())
           result = emitBaseIndexForMmaLayoutV1(loc, rewriter, mmaLayout, type);
-        if (mmaLayout.isAmpere())
+        if (mmaLayout.isAmpere() || mmaLayout.isHopper())
           result = emitBaseIndexForMmaLayoutV2(loc, rewriter, mmaLayout, type);
+      } else if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>()) {
+        result = emitBaseIndexForMfmaLayout(loc, rewriter, mfmaLayout, type);
       } else if (auto sliceLayout = layout.dyn_cast<SliceEncodingAttr>()) {
         auto parentLayout = sliceLayout.getParent();
         auto parentShape = sliceLayout.paddedShape(type.getShape());
@@ -568,8 +607,8 @@ public:
         llvm_unreachable("unsupported emitBaseIndexForLayout");
       }
       if (cache) {
-        cache->insert(std::make_pair(key, result));
-        *insertPt = rewriter.saveInsertionPoint();
+        cache->baseIndexCache.insert(std::make_pair(key, result));
+        cache->insertPoint = rewriter.saveInsertionPoint();
       }
       return result;
     }
@@ -582,9 +621,11 @@ public:
     if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
       if (mmaLayout.isVolta())
         return emitOffsetForMmaLayoutV1(mmaLayout, type);
-      if (mmaLayout.isAmpere())
+      if (mmaLayout.isAmpere() || mmaLayout.isHopper())
         return emitOffsetForMmaLayoutV2(mmaLayout, type);
     }
+    if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>())
+      return emitOffsetForMfmaLayout(mfmaLayout, type);
     if (auto sliceLayout = layout.dyn_cast<SliceEncodingAttr>())
       return emitOffsetForSliceLayout(sliceLayout, type);
     llvm_unreachable("unsupported emitOffsetForLayout");
@@ -598,19 +639,20 @@ public:
                                               Attribute layout,
                                               RankedTensorType type) const {
     IndexCacheKeyT key(layout, type);
-    auto cache = indexCacheInfo.indexCache;
-    auto insertPt = indexCacheInfo.indexInsertPoint;
-    if (cache && cache->count(key) > 0) {
-      return cache->lookup(key);
+    FuncIndexCache *cache = getFuncIndexCache(b);
+    if (cache && cache->indexCache.count(key) > 0) {
+      return cache->indexCache.lookup(key);
     } else {
       ConversionPatternRewriter::InsertionGuard guard(b);
       if (cache)
-        restoreInsertionPointIfSet(insertPt, b);
+        restoreInsertionPointIfSet(cache, b);
       SmallVector<SmallVector<Value>> result;
       if (auto blocked = layout.dyn_cast<BlockedEncodingAttr>()) {
         result = emitIndicesForDistributedLayout(loc, b, blocked, type);
       } else if (auto mma = layout.dyn_cast<MmaEncodingAttr>()) {
         result = emitIndicesForDistributedLayout(loc, b, mma, type);
+      } else if (auto mfma = layout.dyn_cast<MfmaEncodingAttr>()) {
+        result = emitIndicesForDistributedLayout(loc, b, mfma, type);
       } else if (auto slice = layout.dyn_cast<SliceEncodingAttr>()) {
         result = emitIndicesForDistributedLayout(loc, b, slice, type);
       } else {
@@ -619,21 +661,36 @@ public:
             "implemented yet");
       }
       if (cache) {
-        cache->insert(std::make_pair(key, result));
-        *insertPt = b.saveInsertionPoint();
+        cache->indexCache.insert(std::make_pair(key, result));
+        cache->insertPoint = b.saveInsertionPoint();
       }
       return result;
     }
   }
 
 private:
-  void restoreInsertionPointIfSet(OpBuilder::InsertPoint *insertPt,
+  // The index cache of the function being rewritten, if caching is enabled
+  FuncIndexCache *getFuncIndexCache(ConversionPatternRewriter &rewriter) const {
+    if (!indexCacheInfo.funcIndexCaches)
+      return nullptr;
+    Operation *parentOp = rewriter.getInsertionBlock()->getParentOp();
+    auto func = dyn_cast<LLVM::LLVMFuncOp>(parentOp);
+    if (!func)
+      func = parentOp->getParentOfType<LLVM::LLVMFuncOp>();
+    if (!func)
+      return nullptr;
+    return &(*indexCacheInfo.funcIndexCaches)[func];
+  }
+
+  void restoreInsertionPointIfSet(FuncIndexCache *cache,
                                   ConversionPatternRewriter &rewriter) const {
-    if (insertPt->isSet()) {
-      rewriter.restoreInsertionPoint(*insertPt);
+    if (cache->insertPoint.isSet()) {
+      rewriter.restoreInsertionPoint(cache->insertPoint);
     } else {
-      auto func =
-          rewriter.getInsertionPoint()->getParentOfType<LLVM::LLVMFuncOp>();
+      Operation *parentOp = rewriter.getInsertionBlock()->getParentOp();
+      auto func = dyn_cast<LLVM::LLVMFuncOp>(parentOp);
+      if (!func)
+        func = parentOp->getParentOfType<LLVM::LLVMFuncOp>();
       rewriter.setInsertionPointToStart(&func.getBody().front());
     }
   }
@@ -647,12 +704,12 @@ private:
       Location loc, ConversionPatternRewriter &rewriter,
       const BlockedEncodingAttr &blocked_layout, RankedTensorType type) const {
     auto shape = type.getShape();
+    auto sizePerThread = blocked_layout.getSizePerThread();
+    auto threadsPerWarp = blocked_layout.getThreadsPerWarp();
     Value threadId = getThreadId(rewriter, loc);
-    Value warpSize = i32_val(32);
+    Value warpSize = i32_val(product<unsigned>(threadsPerWarp));
     Value laneId = urem(threadId, warpSize);
     Value warpId = udiv(threadId, warpSize);
-    auto sizePerThread = blocked_layout.getSizePerThread();
-    auto threadsPerWarp = blocked_layout.getThreadsPerWarp();
     auto warpsPerCTA = blocked_layout.getWarpsPerCTA();
     auto order = blocked_layout.getOrder();
     unsigned rank = shape.size();
@@ -910,6 +967,56 @@ private:
     return ret;
   }
 
+  // -----------------------------------------------------------------------
+  // Mfma layout indices
+  // -----------------------------------------------------------------------
+
+  SmallVector<Value>
+  emitBaseIndexForMfmaLayout(Location loc, ConversionPatternRewriter &rewriter,
+                             const MfmaEncodingAttr &mfmaLayout,
+                             RankedTensorType type) const {
+    auto shape = type.getShape();
+    auto warpsPerCTA = mfmaLayout.getWarpsPerCTA();
+    assert(warpsPerCTA.size() == 2);
+    auto order = triton::gpu::getOrder(mfmaLayout);
+    Value threadId = getThreadId(rewriter, loc);
+    Value warpSize = i32_val(64);
+    Value laneId = urem(threadId, warpSize);
+    Value warpId = udiv(threadId, warpSize);
+
+    SmallVector<Value> multiDimWarpId =
+        delinearize(rewriter, loc, warpId, warpsPerCTA, order);
+    multiDimWarpId[0] =
+        urem(multiDimWarpId[0], i32_val(ceil<unsigned>(shape[0], 32)));
+    multiDimWarpId[1] =
+        urem(multiDimWarpId[1], i32_val(ceil<unsigned>(shape[1], 32)));
+    Value offWarp0 = mul(multiDimWarpId[0], i32_val(32));
+    Value offWarp1 = mul(multiDimWarpId[1], i32_val(32));
+
+    // The two halves of the wavefront start 4 rows apart
+    SmallVector<Value> multiDimBase(2);
+    multiDimBase[0] = add(mul(udiv(laneId, i32_val(32)), i32_val(4)), offWarp0);
+    multiDimBase[1] = add(urem(laneId, i32_val(32)), offWarp1);
+    return multiDimBase;
+  }
+
+  SmallVector<SmallVector<unsigned>>
+  emitOffsetForMfmaLayout(const MfmaEncodingAttr &mfmaLayout,
+                          RankedTensorType type) const {
+    auto shape = type.getShape();
+    auto shapePerCTA = getShapePerCTA(mfmaLayout);
+    SmallVector<SmallVector<unsigned>> ret;
+
+    for (unsigned i = 0; i < shape[0]; i += shapePerCTA[0]) {
+      for (unsigned j = 0; j < shape[1]; j += shapePerCTA[1]) {
+        // 4 groups of 4 consecutive rows, 8 rows apart
+        for (unsigned elemId = 0; elemId < 16; ++elemId)
+          ret.push_back({i + elemId / 4 * 8 + elemId % 4, j});
+      }
+    }
+    return ret;
+  }
+
   // Emit indices calculation within each ConversionPattern, and returns a
   // [elemsPerThread X rank] index matrix.
   SmallVector<SmallVector<Value>> emitIndicesForDistributedLayout(
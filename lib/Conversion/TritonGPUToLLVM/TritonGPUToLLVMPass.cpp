@@ -157,6 +157,14 @@ struct FuncOpConversion : public FuncOpConversionBase {
       // Set an attribute to indicate this function is a kernel entry.
       newFuncOp->setAttr("nvvm.kernel",
                          rewriter.getIntegerAttr(type::u1Ty(ctx), 1));
+      // Launch bounds, emitted as `nvvm.annotations` like maxntid
+      auto mod = funcOp->getParentOfType<ModuleOp>();
+      if (int maxNReg = triton::gpu::TritonGPUDialect::getMaxNReg(mod))
+        newFuncOp->setAttr("nvvm.maxnreg", rewriter.getI32IntegerAttr(maxNReg));
+      if (int minBlocks =
+              triton::gpu::TritonGPUDialect::getMinBlocksPerSM(mod))
+        newFuncOp->setAttr("nvvm.minctasm",
+                           rewriter.getI32IntegerAttr(minBlocks));
     } else {
       // The noinline attribute will be used by the LLVM codegen to prevent
       // inlining.
@@ -299,8 +307,13 @@ class ConvertTritonGPUToLLVM
     : public ConvertTritonGPUToLLVMBase<ConvertTritonGPUToLLVM> {
 
 public:
-  explicit ConvertTritonGPUToLLVM(int computeCapability, bool isROCM)
-      : computeCapability(computeCapability), isROCM(isROCM) {}
+  ConvertTritonGPUToLLVM(int computeCapability, bool isROCM, bool fastMath,
+                         bool printBuffer) {
+    this->computeCapability = computeCapability;
+    this->isROCM = isROCM;
+    this->fastMath = fastMath;
+    this->printBuffer = printBuffer;
+  }
 
   void runOnOperation() override {
     MLIRContext *context = &getContext();
@@ -317,11 +330,37 @@ public:
     decomposeMmaToDotOperand(mod, numWarps, threadsPerWarp);
     decomposeBlockedToDotOperand(mod);
     decomposeInsertSliceAsyncOp(mod);
+    // The runtime decodes the records of buffered prints by their order in
+    // the module
+    if (printBuffer) {
+      int printId = 0;
+      mod.walk([&](triton::PrintOp op) {
+        op->setAttr("print_id",
+                    IntegerAttr::get(IntegerType::get(context, 32), printId++));
+      });
+    }
+    // Profiled regions are numbered in the order of their first marker, as
+    // the runtime names their counters
+    llvm::StringMap<int> regionIds;
+    mod.walk([&](triton::ProfileRegionOp op) {
+      int regionId =
+          regionIds.try_emplace(op.getName(), regionIds.size()).first->second;
+      op->setAttr("region_id",
+                  IntegerAttr::get(IntegerType::get(context, 32), regionId));
+    });
 
     // Allocate shared memory and set barrier
-    ModuleAllocation allocation(mod);
+    ModuleAllocation &allocation = getAnalysis<ModuleAllocation>();
     ModuleMembarAnalysis membarPass(&allocation);
     membarPass.run();
+    if (isROCM) {
+      // Keep full barriers on AMD GPUs, which only lower gpu.barrier
+      mod.walk([&](triton::gpu::WarpSyncOp warpSyncOp) {
+        OpBuilder builder(warpSyncOp);
+        builder.create<mlir::gpu::BarrierOp>(warpSyncOp.getLoc());
+        warpSyncOp.erase();
+      });
+    }
 
     // Lower functions
     {
@@ -329,8 +368,11 @@ public:
       TritonGPUToLLVMTypeConverter typeConverter(context, option);
       TritonLLVMFunctionConversionTarget funcTarget(*context, isROCM);
       RewritePatternSet funcPatterns(context);
-      funcPatterns.add<FuncOpConversion>(typeConverter, numWarps, allocation,
-                                         /*benefit=*/1);
+      // Every warp group runs `numWarps` warps
+      int numCTAWarps =
+          numWarps * triton::gpu::TritonGPUDialect::getNumWarpGroups(mod);
+      funcPatterns.add<FuncOpConversion>(typeConverter, numCTAWarps,
+                                         allocation, /*benefit=*/1);
       mlir::cf::populateControlFlowToLLVMConversionPatterns(typeConverter,
                                                             funcPatterns);
       if (failed(
@@ -361,25 +403,25 @@ public:
     // Rewrite ops
     RewritePatternSet patterns(context);
     // TritonGPU lowering patterns
-    OpBuilder::InsertPoint indexInsertPoint;
     ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo indexCacheInfo{
-        &baseIndexCache, &indexCache, &indexInsertPoint};
-    // TODO: enable index cache if there are multiple functions
-    if (axisInfoAnalysis.getNumFunctions() > 1) {
-      indexCacheInfo = {nullptr, nullptr, nullptr};
-    }
+        &funcIndexCaches};
     populateTritonGPUToLLVMPatterns(typeConverter, patterns, allocation,
-                                    indexCacheInfo, /*benefit=*/1);
+                                    indexCacheInfo, printBuffer && !isROCM,
+                                    /*benefit=*/1);
     populateConvertLayoutOpToLLVMPatterns(typeConverter, patterns, allocation,
                                           indexCacheInfo, /*benefit=*/1);
     populateDotOpToLLVMPatterns(typeConverter, patterns, allocation,
                                 /*benefit=*/1);
-    populateElementwiseOpToLLVMPatterns(typeConverter, patterns, /*benefit=*/1);
+    populateElementwiseOpToLLVMPatterns(typeConverter, patterns,
+                                        axisInfoAnalysis, computeCapability,
+                                        fastMath, /*benefit=*/1);
     populateLoadStoreOpToLLVMPatterns(typeConverter, patterns, axisInfoAnalysis,
                                       allocation, indexCacheInfo,
+                                      computeCapability, isROCM,
                                       /*benefit=*/1);
     populateReduceOpToLLVMPatterns(typeConverter, patterns, allocation,
-                                   indexCacheInfo, /*benefit=*/1);
+                                   indexCacheInfo, computeCapability,
+                                   /*benefit=*/1);
     populateScanOpToLLVMPatterns(typeConverter, patterns, allocation,
                                  indexCacheInfo, /*benefit=*/1);
     populateViewOpToLLVMPatterns(typeConverter, patterns, /*benefit=*/1);
@@ -399,15 +441,8 @@ public:
   }
 
 private:
-  using IndexCacheKeyT = std::pair<Attribute, RankedTensorType>;
-  DenseMap<IndexCacheKeyT, SmallVector<Value>, CacheKeyDenseMapInfo>
-      baseIndexCache;
-  DenseMap<IndexCacheKeyT, SmallVector<SmallVector<Value>>,
-           CacheKeyDenseMapInfo>
-      indexCache;
-
-  int computeCapability{};
-  bool isROCM{};
+  DenseMap<Operation *, ConvertTritonGPUOpToLLVMPatternBase::FuncIndexCache>
+      funcIndexCaches;
 
   void initSharedMemory(ModuleAllocation &allocation,
                         TritonGPUToLLVMTypeConverter &typeConverter) {
@@ -441,6 +476,9 @@ private:
     mod->setAttr("triton_gpu.shared",
                  mlir::IntegerAttr::get(mlir::IntegerType::get(ctx, 32),
                                         allocation.getSharedMemorySize()));
+    mod->setAttr("triton_gpu.shared_lower_bound",
+                 mlir::IntegerAttr::get(mlir::IntegerType::get(ctx, 32),
+                                        allocation.getSharedMemoryLowerBound()));
   }
 
   void decomposeFp8e4b15Convert(ModuleOp mod) const {
@@ -473,15 +511,33 @@ private:
   void decomposeMmaToDotOperand(ModuleOp mod, int numWarps,
                                 int threadsPerWarp) const {
     // Replace `mma -> dot_op` with `mma -> blocked -> dot_op`
-    // unless certain conditions are met
+    // unless certain conditions are met, and `mfma -> dot_op` with
+    // `mfma -> shared -> dot_op`, as mfma operands are only read from shared
+    // memory
     mod.walk([&](triton::gpu::ConvertLayoutOp cvtOp) -> void {
       OpBuilder builder(cvtOp);
       auto srcType = cvtOp.getOperand().getType().cast<RankedTensorType>();
       auto dstType = cvtOp.getType().cast<RankedTensorType>();
       auto srcMma =
           srcType.getEncoding().dyn_cast<triton::gpu::MmaEncodingAttr>();
+      auto srcMfma =
+          srcType.getEncoding().dyn_cast<triton::gpu::MfmaEncodingAttr>();
       auto dstDotOp =
           dstType.getEncoding().dyn_cast<triton::gpu::DotOperandEncodingAttr>();
+      if (srcMfma && dstDotOp) {
+        auto tmpType = RankedTensorType::get(
+            dstType.getShape(), dstType.getElementType(),
+            triton::gpu::SharedEncodingAttr::get(
+                mod.getContext(), dstDotOp, srcType.getShape(),
+                getOrder(srcMfma), srcType.getElementType()));
+        auto tmp = builder.create<triton::gpu::ConvertLayoutOp>(
+            cvtOp.getLoc(), tmpType, cvtOp.getOperand());
+        auto newConvert = builder.create<triton::gpu::ConvertLayoutOp>(
+            cvtOp.getLoc(), dstType, tmp);
+        cvtOp.replaceAllUsesWith(newConvert.getResult());
+        cvtOp.erase();
+        return;
+      }
       if (srcMma && dstDotOp && !isMmaToDotShortcut(srcType, dstType)) {
         auto tmpType = RankedTensorType::get(
             dstType.getShape(), dstType.getElementType(),
@@ -592,7 +648,7 @@ private:
           // TODO(Chenggang): confirm `boundaryCheck` and `padding`
           /*boundaryCheck=*/nullptr, /*padding=*/nullptr,
           insertSliceAsyncOp.getCache(), insertSliceAsyncOp.getEvict(),
-          insertSliceAsyncOp.getIsVolatile());
+          insertSliceAsyncOp.getIsVolatile(), insertSliceAsyncOp.getL2Evict());
 
       // insert_slice
       auto axis = insertSliceAsyncOp.getAxis();
@@ -640,8 +696,10 @@ namespace mlir {
 namespace triton {
 
 std::unique_ptr<OperationPass<ModuleOp>>
-createConvertTritonGPUToLLVMPass(int computeCapability, bool isROCM) {
-  return std::make_unique<::ConvertTritonGPUToLLVM>(computeCapability, isROCM);
+createConvertTritonGPUToLLVMPass(int computeCapability, bool isROCM,
+                                 bool fastMath, bool printBuffer) {
+  return std::make_unique<::ConvertTritonGPUToLLVM>(computeCapability, isROCM,
+                                                    fastMath, printBuffer);
 }
 
 } // namespace triton
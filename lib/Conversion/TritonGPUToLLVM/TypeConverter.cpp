@@ -9,6 +9,7 @@ using namespace mlir::triton;
 using ::mlir::triton::gpu::BlockedEncodingAttr;
 using ::mlir::triton::gpu::DotOperandEncodingAttr;
 using ::mlir::triton::gpu::getTotalElemsPerThread;
+using ::mlir::triton::gpu::isMmaV3DotOperand;
 using ::mlir::triton::gpu::MmaEncodingAttr;
 using ::mlir::triton::gpu::SharedEncodingAttr;
 using ::mlir::triton::gpu::SliceEncodingAttr;
@@ -105,7 +106,7 @@ Type TritonGPUToLLVMTypeConverter::getElementTypeForStruct(
   if (!dotOpLayout)
     return elemTy;
   auto mmaParent = dotOpLayout.getParent().dyn_cast<MmaEncodingAttr>();
-  if (!mmaParent)
+  if (!mmaParent || mmaParent.isHopper())
     return elemTy;
   if (mmaParent.isAmpere()) {
     int bitwidth = elemTy.getIntOrFloatBitWidth();
@@ -124,7 +125,9 @@ Type TritonGPUToLLVMTypeConverter::convertTritonTensorType(
   SmallVector<int64_t> shape(type.getShape().begin(), type.getShape().end());
   Type eltType = getElementTypeForStruct(type);
 
-  if (auto shared_layout = layout.dyn_cast<SharedEncodingAttr>()) {
+  // MMAv3 reads its operands from shared memory, so that they are lowered to
+  // the shared memory object they are read from
+  if (layout.isa<SharedEncodingAttr>() || isMmaV3DotOperand(layout)) {
     SmallVector<Type, 4> types;
     // base ptr
     auto ptrType = LLVM::LLVMPointerType::get(eltType, 3);
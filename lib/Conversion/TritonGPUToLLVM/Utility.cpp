@@ -199,6 +199,45 @@ Value shflUpSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
   return commonShflSync(loc, rewriter, val, i, "up", "0x0");
 }
 
+Value shflIdxSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
+                  Value i) {
+  Type ty = val.getType();
+  if (ty.isa<LLVM::LLVMPointerType>()) {
+    Value res = shflIdxSync(loc, rewriter, ptrtoint(i64_ty, val), i);
+    return inttoptr(ty, res);
+  }
+
+  unsigned bits = ty.getIntOrFloatBitWidth();
+  if (bits == 64) {
+    Type vecTy = vec_ty(i32_ty, 2);
+    Value vec = bitcast(val, vecTy);
+    Value val0 = extract_element(i32_ty, vec, i32_val(0));
+    Value val1 = extract_element(i32_ty, vec, i32_val(1));
+    val0 = shflIdxSync(loc, rewriter, val0, i);
+    val1 = shflIdxSync(loc, rewriter, val1, i);
+    vec = undef(vecTy);
+    vec = insert_element(vecTy, vec, val0, i32_val(0));
+    vec = insert_element(vecTy, vec, val1, i32_val(1));
+    return bitcast(vec, ty);
+  }
+  if (bits < 32) {
+    Value word = zext(i32_ty, bitcast(val, int_ty(bits)));
+    word = shflIdxSync(loc, rewriter, word, i);
+    return bitcast(rewriter.create<LLVM::TruncOp>(loc, int_ty(bits), word),
+                   ty);
+  }
+
+  PTXBuilder builder;
+  auto &shfl = builder.create("shfl.sync")->o("idx").o("b32");
+  auto *dOpr = builder.newOperand("=r");
+  auto *aOpr = builder.newOperand(val, "r");
+  auto *bOpr = builder.newOperand(i, "r");
+  auto *cOpr = builder.newConstantOperand("0x1f");
+  auto *maskOpr = builder.newConstantOperand("0xffffffff");
+  shfl(dOpr, aOpr, bOpr, cOpr, maskOpr);
+  return builder.launch(rewriter, loc, ty, false);
+}
+
 Value addStringToModule(Location loc, ConversionPatternRewriter &rewriter,
                         StringRef key, StringRef content) {
   auto moduleOp = rewriter.getBlock()->getParent()->getParentOfType<ModuleOp>();
@@ -206,6 +206,13 @@ struct TransOpConversion
   matchAndRewrite(triton::TransOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
     Location loc = op->getLoc();
+    // Transpositions of blocked tensors keep every element in its register
+    // (see `inferTransOpEncoding`)
+    if (op.getType().cast<RankedTensorType>().getEncoding().isa<
+            triton::gpu::BlockedEncodingAttr>()) {
+      rewriter.replaceOp(op, adaptor.getSrc());
+      return success();
+    }
     auto srcSmemObj =
         getSharedMemoryObjectFromStruct(loc, adaptor.getSrc(), rewriter);
     SmallVector<Value> dstStrides = {srcSmemObj.strides[1],
@@ -259,6 +259,34 @@ struct TritonExpandDimsPattern
   }
 };
 
+// Blocked layout of the result of a dot of shape `shape`
+static Attribute getDotResultEncoding(MLIRContext *ctx,
+                                      ArrayRef<int64_t> shape, int numWarps,
+                                      int threadsPerWarp) {
+  SmallVector<unsigned> retSizePerThread = {1, 1};
+  if (shape[0] * shape[1] / (numWarps * threadsPerWarp) >= 4)
+    retSizePerThread = {2, 2};
+  if (shape[0] * shape[1] / (numWarps * threadsPerWarp) >= 16)
+    retSizePerThread = {4, 4};
+  SmallVector<unsigned> retOrder = {1, 0};
+  return triton::gpu::BlockedEncodingAttr::get(
+      ctx, shape, retSizePerThread, retOrder, numWarps, threadsPerWarp);
+}
+
+// Converts the operand `opIdx` of a dot to the dot operand layout of
+// `dEncoding`, unless it already has one
+static Value convertToDotOperand(ConversionPatternRewriter &rewriter, Value v,
+                                 unsigned opIdx, Attribute dEncoding) {
+  auto type = v.getType().cast<RankedTensorType>();
+  if (type.getEncoding().isa<triton::gpu::DotOperandEncodingAttr>())
+    return v;
+  Attribute encoding = triton::gpu::DotOperandEncodingAttr::get(
+      rewriter.getContext(), opIdx, dEncoding, type.getElementType());
+  auto dstType =
+      RankedTensorType::get(type.getShape(), type.getElementType(), encoding);
+  return rewriter.create<triton::gpu::ConvertLayoutOp>(v.getLoc(), dstType, v);
+}
+
 struct TritonDotPattern : public OpConversionPattern<triton::DotOp> {
   using OpConversionPattern<triton::DotOp>::OpConversionPattern;
 
@@ -271,43 +299,18 @@ struct TritonDotPattern : public OpConversionPattern<triton::DotOp> {
     int numWarps = typeConverter->getNumWarps();
     int threadsPerWarp = typeConverter->getThreadsPerWarp();
 
-    SmallVector<unsigned> retSizePerThread = {1, 1};
-    if (origShape[0] * origShape[1] / (numWarps * threadsPerWarp) >= 4)
-      retSizePerThread = {2, 2};
-    if (origShape[0] * origShape[1] / (numWarps * threadsPerWarp) >= 16)
-      retSizePerThread = {4, 4};
-    SmallVector<unsigned> retOrder = {1, 0};
-    Attribute dEncoding = triton::gpu::BlockedEncodingAttr::get(
-        getContext(), origShape, retSizePerThread, retOrder, numWarps,
-        threadsPerWarp);
+    Attribute dEncoding = getDotResultEncoding(getContext(), origShape,
+                                               numWarps, threadsPerWarp);
     RankedTensorType retType =
         RankedTensorType::get(origShape, origType.getElementType(), dEncoding);
     // a & b must be of smem layout
     auto aType = adaptor.getA().getType().cast<RankedTensorType>();
     auto bType = adaptor.getB().getType().cast<RankedTensorType>();
-    Type aEltType = aType.getElementType();
-    Type bEltType = bType.getElementType();
-    Attribute aEncoding = aType.getEncoding();
-    Attribute bEncoding = bType.getEncoding();
-    if (!aEncoding || !bEncoding)
+    if (!aType.getEncoding() || !bType.getEncoding())
       return failure();
-    Value a = adaptor.getA();
-    Value b = adaptor.getB();
+    Value a = convertToDotOperand(rewriter, adaptor.getA(), 0, dEncoding);
+    Value b = convertToDotOperand(rewriter, adaptor.getB(), 1, dEncoding);
     Value c = adaptor.getC();
-    if (!aEncoding.isa<triton::gpu::DotOperandEncodingAttr>()) {
-      Attribute encoding = triton::gpu::DotOperandEncodingAttr::get(
-          getContext(), 0, dEncoding, aEltType);
-      auto dstType =
-          RankedTensorType::get(aType.getShape(), aEltType, encoding);
-      a = rewriter.create<triton::gpu::ConvertLayoutOp>(a.getLoc(), dstType, a);
-    }
-    if (!bEncoding.isa<triton::gpu::DotOperandEncodingAttr>()) {
-      Attribute encoding = triton::gpu::DotOperandEncodingAttr::get(
-          getContext(), 1, dEncoding, bEltType);
-      auto dstType =
-          RankedTensorType::get(bType.getShape(), bEltType, encoding);
-      b = rewriter.create<triton::gpu::ConvertLayoutOp>(b.getLoc(), dstType, b);
-    }
     c = rewriter.create<triton::gpu::ConvertLayoutOp>(c.getLoc(), retType, c);
 
     addNamedAttrs(rewriter.replaceOpWithNewOp<triton::DotOp>(
@@ -317,6 +320,39 @@ struct TritonDotPattern : public OpConversionPattern<triton::DotOp> {
   }
 };
 
+// The metadata of a sparse dot keeps the layout of its producer until the
+// dot is mapped to tensor cores
+struct TritonSparseDotPattern
+    : public OpConversionPattern<triton::SparseDotOp> {
+  using OpConversionPattern<triton::SparseDotOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::SparseDotOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    RankedTensorType origType = op.getType().cast<RankedTensorType>();
+    auto origShape = origType.getShape();
+    auto typeConverter = getTypeConverter<TritonGPUTypeConverter>();
+    Attribute dEncoding = getDotResultEncoding(
+        getContext(), origShape, typeConverter->getNumWarps(),
+        typeConverter->getThreadsPerWarp());
+    RankedTensorType retType =
+        RankedTensorType::get(origShape, origType.getElementType(), dEncoding);
+    auto aType = adaptor.getA().getType().cast<RankedTensorType>();
+    auto bType = adaptor.getB().getType().cast<RankedTensorType>();
+    if (!aType.getEncoding() || !bType.getEncoding())
+      return failure();
+    Value a = convertToDotOperand(rewriter, adaptor.getA(), 0, dEncoding);
+    Value b = convertToDotOperand(rewriter, adaptor.getB(), 1, dEncoding);
+    Value c = adaptor.getC();
+    c = rewriter.create<triton::gpu::ConvertLayoutOp>(c.getLoc(), retType, c);
+
+    addNamedAttrs(rewriter.replaceOpWithNewOp<triton::SparseDotOp>(
+                      op, retType, a, b, c, adaptor.getAMeta()),
+                  adaptor.getAttributes());
+    return success();
+  }
+};
+
 struct TritonCatPattern : public OpConversionPattern<triton::CatOp> {
 
   using OpConversionPattern<triton::CatOp>::OpConversionPattern;
@@ -378,6 +414,19 @@ struct TritonTransPattern : public OpConversionPattern<triton::TransOp> {
     Attribute srcEncoding = srcType.getEncoding();
     if (!srcEncoding)
       return failure();
+    // Transpositions only feeding dots go through shared memory, which the
+    // dots read their operands from; others transpose blocked tensors in
+    // registers, and the layout conversions they may need are left to the
+    // TritonGPU passes
+    bool feedsDotsOnly = llvm::all_of(op->getUsers(), [](Operation *user) {
+      return isa<triton::DotOp>(user);
+    });
+    if (srcEncoding.isa<triton::gpu::BlockedEncodingAttr>() &&
+        (op->use_empty() || !feedsDotsOnly)) {
+      addNamedAttrs(rewriter.replaceOpWithNewOp<triton::TransOp>(op, src),
+                    adaptor.getAttributes());
+      return success();
+    }
     if (!srcEncoding.isa<triton::gpu::SharedEncodingAttr>()) {
       // TODO: end-to-end correctness is broken if
       // the input is blocked and the output is shared
@@ -410,7 +459,7 @@ struct TritonLoadPattern : public OpConversionPattern<triton::LoadOp> {
                       adaptor.getPtr(), adaptor.getMask(), adaptor.getOther(),
                       adaptor.getBoundaryCheckAttr(), adaptor.getPaddingAttr(),
                       adaptor.getCache(), adaptor.getEvict(),
-                      adaptor.getIsVolatile()),
+                      adaptor.getIsVolatile(), adaptor.getL2Evict()),
                   adaptor.getAttributes());
     return success();
   }
@@ -425,7 +474,7 @@ struct TritonStorePattern : public OpConversionPattern<triton::StoreOp> {
     addNamedAttrs(rewriter.replaceOpWithNewOp<triton::StoreOp>(
                       op, adaptor.getPtr(), adaptor.getValue(),
                       adaptor.getMask(), adaptor.getCache(),
-                      adaptor.getEvict()),
+                      adaptor.getEvict(), adaptor.getL2Evict()),
                   adaptor.getAttributes());
     return success();
   }
@@ -441,7 +490,7 @@ struct TritonAtomicCASPattern
     addNamedAttrs(rewriter.replaceOpWithNewOp<triton::AtomicCASOp>(
                       op, typeConverter->convertType(op.getType()),
                       adaptor.getPtr(), adaptor.getCmp(), adaptor.getVal(),
-                      op.getSem()),
+                      op.getSem(), op.getScope()),
                   adaptor.getAttributes());
     return success();
   }
@@ -457,7 +506,8 @@ struct TritonAtomicRMWPattern
     addNamedAttrs(rewriter.replaceOpWithNewOp<triton::AtomicRMWOp>(
                       op, typeConverter->convertType(op.getType()),
                       adaptor.getAtomicRmwOp(), adaptor.getPtr(),
-                      adaptor.getVal(), adaptor.getMask(), op.getSem()),
+                      adaptor.getVal(), adaptor.getMask(), op.getSem(),
+                      op.getAggregate(), op.getScope()),
                   adaptor.getAttributes());
     return success();
   }
@@ -671,8 +721,10 @@ void populateTritonPatterns(TritonGPUTypeConverter &typeConverter,
           TritonGenericPattern<triton::AddPtrOp>, TritonCatPattern,
           TritonReducePattern, TritonReduceReturnPattern, TritonScanPattern,
           TritonScanReturnPattern, TritonTransPattern, TritonExpandDimsPattern,
-          TritonMakeRangePattern, TritonDotPattern, TritonLoadPattern,
-          TritonStorePattern,
+          TritonMakeRangePattern, TritonDotPattern, TritonSparseDotPattern,
+          TritonLoadPattern, TritonStorePattern,
+          TritonGenericPattern<triton::TMALoadOp>,
+          TritonGenericPattern<triton::BlockLoadOp>,
           TritonExternElementwisePattern<triton::PureExternElementwiseOp>,
           TritonExternElementwisePattern<triton::ImpureExternElementwiseOp>,
           TritonPrintPattern, TritonAssertPattern, TritonAtomicRMWPattern,
@@ -884,6 +936,27 @@ void populateCFPatterns(TritonGPUTypeConverter &typeConverter,
 }
 //
 
+// Width of the widest elements of the tensors `mod` loads or stores, 32 when
+// it accesses none
+static int getMaxAccessBitwidth(ModuleOp mod) {
+  int bitwidth = 0;
+  mod.walk([&](Operation *op) {
+    Value value;
+    if (auto load = dyn_cast<triton::LoadOp>(op))
+      value = load.getResult();
+    else if (auto store = dyn_cast<triton::StoreOp>(op))
+      value = store.getValue();
+    else
+      return;
+    auto tensorTy = value.getType().dyn_cast<RankedTensorType>();
+    if (!tensorTy || !tensorTy.getElementType().isIntOrFloat())
+      return;
+    int elemBitwidth = tensorTy.getElementType().getIntOrFloatBitWidth();
+    bitwidth = std::max(bitwidth, elemBitwidth);
+  });
+  return bitwidth ? bitwidth : 32;
+}
+
 class ConvertTritonToTritonGPU
     : public ConvertTritonToTritonGPUBase<ConvertTritonToTritonGPU> {
 public:
@@ -898,7 +971,8 @@ public:
     MLIRContext *context = &getContext();
     ModuleOp mod = getOperation();
     // type converter
-    TritonGPUTypeConverter typeConverter(context, numWarps, threadsPerWarp);
+    TritonGPUTypeConverter typeConverter(context, numWarps, threadsPerWarp,
+                                         getMaxAccessBitwidth(mod));
     TritonGPUConversionTarget target(*context, typeConverter);
     // rewrite patterns
     RewritePatternSet patterns(context);
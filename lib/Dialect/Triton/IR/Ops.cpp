@@ -66,9 +66,12 @@ void LoadOp::print(OpAsmPrinter &printer) {
   printer << " ";
   printer << getOperation()->getOperands();
 
-  // `operandSegmentSizes` can be deduced, so we don't print it.
-  printer.printOptionalAttrDict(getOperation()->getAttrs(),
-                                {getOperandSegmentSizesAttrName()});
+  // `operandSegmentSizes` can be deduced, so we don't print it, nor the
+  // default L2 eviction policy.
+  SmallVector<StringRef, 2> elidedAttrs = {getOperandSegmentSizesAttrName()};
+  if (getL2Evict() == EvictionPolicy::NORMAL)
+    elidedAttrs.push_back(getL2EvictAttrName());
+  printer.printOptionalAttrDict(getOperation()->getAttrs(), elidedAttrs);
 
   // `type(ptr) -> type(result)`
   printer << " : ";
@@ -121,7 +124,11 @@ ParseResult StoreOp::parse(OpAsmParser &parser, OperationState &result) {
 void StoreOp::print(OpAsmPrinter &printer) {
   printer << " ";
   printer << getOperation()->getOperands();
-  printer.printOptionalAttrDict(getOperation()->getAttrs(), /*elidedAttrs=*/{});
+  // The default L2 eviction policy is not printed
+  SmallVector<StringRef, 1> elidedAttrs;
+  if (getL2Evict() == EvictionPolicy::NORMAL)
+    elidedAttrs.push_back(getL2EvictAttrName());
+  printer.printOptionalAttrDict(getOperation()->getAttrs(), elidedAttrs);
 
   // `type(ptr), type(value)`
   printer << " : ";
@@ -158,34 +165,39 @@ static Type getLoadOpResultType(::mlir::OpBuilder &builder, Type ptrType) {
 
 void LoadOp::build(::mlir::OpBuilder &builder, ::mlir::OperationState &state,
                    ::mlir::Value ptr, ::mlir::triton::CacheModifier cache,
-                   ::mlir::triton::EvictionPolicy evict, bool isVolatile) {
+                   ::mlir::triton::EvictionPolicy evict, bool isVolatile,
+                   ::mlir::triton::EvictionPolicy l2Evict) {
   LoadOp::build(builder, state, ptr, /*mask=*/{}, /*other=*/{},
-                /*boundaryCheck=*/{}, /*padding=*/{}, cache, evict, isVolatile);
+                /*boundaryCheck=*/{}, /*padding=*/{}, cache, evict, isVolatile,
+                l2Evict);
 }
 
 void LoadOp::build(::mlir::OpBuilder &builder, ::mlir::OperationState &state,
                    ::mlir::Value ptr, ArrayRef<int32_t> boundaryCheck,
                    std::optional<::mlir::triton::PaddingOption> padding,
                    ::mlir::triton::CacheModifier cache,
-                   ::mlir::triton::EvictionPolicy evict, bool isVolatile) {
+                   ::mlir::triton::EvictionPolicy evict, bool isVolatile,
+                   ::mlir::triton::EvictionPolicy l2Evict) {
   LoadOp::build(builder, state, ptr, /*mask=*/{}, /*other=*/{}, boundaryCheck,
-                padding, cache, evict, isVolatile);
+                padding, cache, evict, isVolatile, l2Evict);
 }
 
 void LoadOp::build(::mlir::OpBuilder &builder, ::mlir::OperationState &state,
                    ::mlir::Value ptr, ::mlir::Value mask,
                    ::mlir::triton::CacheModifier cache,
-                   ::mlir::triton::EvictionPolicy evict, bool isVolatile) {
+                   ::mlir::triton::EvictionPolicy evict, bool isVolatile,
+                   ::mlir::triton::EvictionPolicy l2Evict) {
   LoadOp::build(builder, state, ptr, mask, /*other=*/{}, /*boundaryCheck=*/{},
-                /*padding=*/{}, cache, evict, isVolatile);
+                /*padding=*/{}, cache, evict, isVolatile, l2Evict);
 }
 
 void LoadOp::build(::mlir::OpBuilder &builder, ::mlir::OperationState &state,
                    ::mlir::Value ptr, ::mlir::Value mask, ::mlir::Value other,
                    ::mlir::triton::CacheModifier cache,
-                   ::mlir::triton::EvictionPolicy evict, bool isVolatile) {
+                   ::mlir::triton::EvictionPolicy evict, bool isVolatile,
+                   ::mlir::triton::EvictionPolicy l2Evict) {
   LoadOp::build(builder, state, ptr, mask, other, /*boundaryCheck=*/{},
-                /*padding=*/{}, cache, evict, isVolatile);
+                /*padding=*/{}, cache, evict, isVolatile, l2Evict);
 }
 
 void LoadOp::build(::mlir::OpBuilder &builder, ::mlir::OperationState &state,
@@ -193,7 +205,8 @@ void LoadOp::build(::mlir::OpBuilder &builder, ::mlir::OperationState &state,
                    std::optional<ArrayRef<int32_t>> boundaryCheck,
                    std::optional<::mlir::triton::PaddingOption> padding,
                    ::mlir::triton::CacheModifier cache,
-                   ::mlir::triton::EvictionPolicy evict, bool isVolatile) {
+                   ::mlir::triton::EvictionPolicy evict, bool isVolatile,
+                   ::mlir::triton::EvictionPolicy l2Evict) {
   // Operands
   state.addOperands(ptr);
   if (mask) {
@@ -224,6 +237,9 @@ void LoadOp::build(::mlir::OpBuilder &builder, ::mlir::OperationState &state,
       ::mlir::triton::EvictionPolicyAttr::get(builder.getContext(), evict));
   state.addAttribute(getIsVolatileAttrName(state.name),
                      builder.getBoolAttr(isVolatile));
+  state.addAttribute(
+      getL2EvictAttrName(state.name),
+      ::mlir::triton::EvictionPolicyAttr::get(builder.getContext(), l2Evict));
 
   // Result type
   Type resultType = getLoadOpResultType(builder, ptr.getType());
@@ -258,7 +274,8 @@ struct CanonicalizeMaskedLoadPattern
       rewriter.replaceOpWithNewOp<triton::LoadOp>(
           loadOp, loadOp.getType(), loadOp.getPtr(), Value(), Value(),
           loadOp.getBoundaryCheckAttr(), loadOp.getPaddingAttr(),
-          loadOp.getCache(), loadOp.getEvict(), loadOp.getIsVolatile());
+          loadOp.getCache(), loadOp.getEvict(), loadOp.getIsVolatile(),
+          loadOp.getL2Evict());
     } else {
       // mask = splat(0)
 
@@ -282,27 +299,30 @@ void triton::LoadOp::getCanonicalizationPatterns(RewritePatternSet &results,
 void StoreOp::build(::mlir::OpBuilder &builder, ::mlir::OperationState &state,
                     ::mlir::Value ptr, ::mlir::Value value,
                     ::mlir::triton::CacheModifier cache,
-                    ::mlir::triton::EvictionPolicy evict) {
+                    ::mlir::triton::EvictionPolicy evict,
+                    ::mlir::triton::EvictionPolicy l2Evict) {
   return StoreOp::build(builder, state, ptr, value, /*mask=*/{},
-                        /*boundaryCheck=*/{}, cache, evict);
+                        /*boundaryCheck=*/{}, cache, evict, l2Evict);
 }
 
 void StoreOp::build(::mlir::OpBuilder &builder, ::mlir::OperationState &state,
                     ::mlir::Value ptr, ::mlir::Value value, ::mlir::Value mask,
                     ::mlir::triton::CacheModifier cache,
-                    ::mlir::triton::EvictionPolicy evict) {
+                    ::mlir::triton::EvictionPolicy evict,
+                    ::mlir::triton::EvictionPolicy l2Evict) {
   return StoreOp::build(builder, state, ptr, value, mask, /*boundaryCheck=*/{},
-                        cache, evict);
+                        cache, evict, l2Evict);
 }
 
 void StoreOp::build(::mlir::OpBuilder &builder, ::mlir::OperationState &state,
                     ::mlir::Value ptr, ::mlir::Value value,
                     ArrayRef<int32_t> boundaryCheck,
                     ::mlir::triton::CacheModifier cache,
-                    ::mlir::triton::EvictionPolicy evict) {
+                    ::mlir::triton::EvictionPolicy evict,
+                    ::mlir::triton::EvictionPolicy l2Evict) {
   return StoreOp::build(builder, state, ptr, value, /*mask=*/{},
                         builder.getDenseI32ArrayAttr(boundaryCheck), cache,
-                        evict);
+                        evict, l2Evict);
 }
 
 // store(ptr, value, splat(1), ...) -> store(ptr, value, ...)
@@ -332,7 +352,7 @@ struct CanonicalizeMaskedStorePattern
       // mask = splat(1)
       rewriter.replaceOpWithNewOp<triton::StoreOp>(
           storeOp, storeOp.getPtr(), storeOp.getValue(), storeOp.getCache(),
-          storeOp.getEvict());
+          storeOp.getEvict(), storeOp.getL2Evict());
     } else {
       // mask = splat(0)
       rewriter.eraseOp(storeOp);
@@ -374,10 +394,12 @@ mlir::LogicalResult mlir::triton::TransOp::inferReturnTypes(
 }
 
 //-- DotOp --
-mlir::LogicalResult mlir::triton::DotOp::inferReturnTypes(
-    MLIRContext *context, std::optional<Location> location, ValueRange operands,
-    DictionaryAttr attributes, OpaqueProperties properties, RegionRange regions,
-    SmallVectorImpl<Type> &inferredReturnTypes) {
+// The result of a dot is of the type of its accumulator `operands[2]`, whose
+// encoding must be the parent of the encodings of `operands[0]` and
+// `operands[1]`
+static mlir::LogicalResult
+inferDotReturnTypes(std::optional<Location> location, ValueRange operands,
+                    SmallVectorImpl<Type> &inferredReturnTypes) {
   // type is the same as the accumulator
   auto accTy = operands[2].getType().cast<RankedTensorType>();
   inferredReturnTypes.push_back(accTy);
@@ -398,6 +420,13 @@ mlir::LogicalResult mlir::triton::DotOp::inferReturnTypes(
   return mlir::success();
 }
 
+mlir::LogicalResult mlir::triton::DotOp::inferReturnTypes(
+    MLIRContext *context, std::optional<Location> location, ValueRange operands,
+    DictionaryAttr attributes, OpaqueProperties properties, RegionRange regions,
+    SmallVectorImpl<Type> &inferredReturnTypes) {
+  return inferDotReturnTypes(location, operands, inferredReturnTypes);
+}
+
 LogicalResult mlir::triton::DotOp::verify() {
   auto aTy = getOperand(0).getType().cast<RankedTensorType>();
   auto bTy = getOperand(1).getType().cast<RankedTensorType>();
@@ -416,6 +445,48 @@ LogicalResult mlir::triton::DotOp::verify() {
                                                      bEncoding);
 }
 
+//-- SparseDotOp --
+mlir::LogicalResult mlir::triton::SparseDotOp::inferReturnTypes(
+    MLIRContext *context, std::optional<Location> location, ValueRange operands,
+    DictionaryAttr attributes, OpaqueProperties properties, RegionRange regions,
+    SmallVectorImpl<Type> &inferredReturnTypes) {
+  return inferDotReturnTypes(location, operands, inferredReturnTypes);
+}
+
+LogicalResult mlir::triton::SparseDotOp::verify() {
+  auto aTy = getA().getType().cast<RankedTensorType>();
+  auto bTy = getB().getType().cast<RankedTensorType>();
+  auto metaTy = getAMeta().getType().cast<RankedTensorType>();
+  auto dTy = getD().getType().cast<RankedTensorType>();
+  if (aTy.getElementType() != bTy.getElementType())
+    return emitError("element types of operands A and B must match");
+  // Sparse dots are only lowered to the f16/bf16 mma.sp.m16n8k32 of sm80+
+  if (!aTy.getElementType().isF16() && !aTy.getElementType().isBF16())
+    return emitError("operands A and B must be of f16 or bf16");
+  if (!dTy.getElementType().isF32())
+    return emitError("result must be of f32");
+  if (!metaTy.getElementType().isInteger(16))
+    return emitError("metadata of operand A must be of i16");
+  auto aShape = aTy.getShape();
+  auto bShape = bTy.getShape();
+  if (aShape.size() != 2 || bShape.size() != 2 || 2 * aShape[1] != bShape[0])
+    return emitError("operand A must hold half of the K elements of operand B");
+  if (aShape[0] % 16 != 0 || bShape[0] % 32 != 0 || bShape[1] % 16 != 0)
+    return emitError("M and N must be multiples of 16 and K a multiple of 32");
+  if (metaTy.getShape() != ArrayRef<int64_t>({aShape[0], bShape[0] / 16}))
+    return emitError("metadata of operand A must be of shape M x K/16");
+  auto aEncoding = aTy.getEncoding();
+  auto bEncoding = bTy.getEncoding();
+  if (!aEncoding && !bEncoding)
+    return mlir::success();
+  if (!aEncoding || !bEncoding)
+    return emitError("mismatching encoding between A and B operands");
+  Dialect &dialect = aEncoding.getDialect();
+  auto interface = cast<DialectInferLayoutInterface>(&dialect);
+  return interface->verifyDotOpEncodingCompatibility(getOperation(), aEncoding,
+                                                     bEncoding);
+}
+
 //-- ReduceOp --
 static mlir::LogicalResult
 inferReduceReturnShape(const RankedTensorType &argTy, const Type &retEltTy,
@@ -1,4 +1,5 @@
 #include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/IRMapping.h"
 #include "mlir/IR/Matchers.h"
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/Pass/Pass.h"
@@ -95,28 +96,62 @@ public:
     rewriter.replaceOpWithNewOp<triton::LoadOp>(
         op, loadOp.getPtr(), loadOp.getMask(), falseValue,
         loadOp.getBoundaryCheck(), loadOp.getPadding(), loadOp.getCache(),
-        loadOp.getEvict(), loadOp.getIsVolatile());
+        loadOp.getEvict(), loadOp.getIsVolatile(), loadOp.getL2Evict());
     return mlir::success();
   }
 };
 
 // sum(x[:, :, None] * y[None, :, :], 1)
 // -> dot(x, y)
+// The accumulate form `d + sum(...)` is then folded into the dot accumulator
+// by the CombineDotAdd patterns, since the new dot starts from a zero tensor.
 class CombineBroadcastMulReducePattern : public mlir::RewritePattern {
 private:
-  static bool isAddF32(const Operation *op) {
-    if (auto addf = dyn_cast_or_null<arith::AddFOp>(op))
-      return addf.getType().getIntOrFloatBitWidth() <= 32;
-    return false;
+  static bool isAddF32(Operation *op) {
+    auto addf = dyn_cast_or_null<arith::AddFOp>(op);
+    if (!addf || !addf.getType().isF32())
+      return false;
+    // must combine the two block arguments of the reduction region
+    Block *block = op->getBlock();
+    return block->getNumArguments() == 2 &&
+           ((addf.getLhs() == block->getArgument(0) &&
+             addf.getRhs() == block->getArgument(1)) ||
+            (addf.getLhs() == block->getArgument(1) &&
+             addf.getRhs() == block->getArgument(0)));
   }
 
-  static SmallVector<int> getEqualIndices(ArrayRef<int64_t> x,
-                                          ArrayRef<int64_t> y) {
-    SmallVector<int> res;
-    for (int i = 0; i < x.size(); ++i)
-      if (x[i] == y[i])
-        res.push_back(i);
-    return res;
+  static bool isDotOperandType(Type elemTy) {
+    return elemTy.isF16() || elemTy.isBF16() || elemTy.isF32();
+  }
+
+  // Peel `broadcast(expand_dims(x, axis))`, optionally widened to f32 with
+  // arith.extf at any step, and return the 2D operand `x`.
+  static Value getDotOperand(Value v, int axis) {
+    auto peelExt = [](Value v) -> Value {
+      if (auto extOp = v.getDefiningOp<arith::ExtFOp>())
+        return extOp.getIn();
+      return v;
+    };
+    auto broadcastOp = peelExt(v).getDefiningOp<triton::BroadcastOp>();
+    if (!broadcastOp)
+      return Value();
+    auto expandOp =
+        peelExt(broadcastOp.getSrc()).getDefiningOp<triton::ExpandDimsOp>();
+    if (!expandOp || expandOp.getAxis() != axis)
+      return Value();
+    Value operand = peelExt(expandOp.getSrc());
+    auto operandTy = operand.getType().dyn_cast<RankedTensorType>();
+    if (!operandTy || operandTy.getRank() != 2 ||
+        !isDotOperandType(operandTy.getElementType()))
+      return Value();
+    return operand;
+  }
+
+  // tt.dot needs every dimension to be a power of two of at least 16.
+  static bool isDotShape(ArrayRef<int64_t> shape) {
+    return llvm::all_of(shape, [](int64_t dim) {
+      return dim >= 16 && llvm::isPowerOf2_64(dim);
+    });
   }
 
 public:
@@ -127,9 +162,10 @@ public:
   mlir::LogicalResult matchAndRewrite(mlir::Operation *op,
                                       mlir::PatternRewriter &rewriter) const {
     auto reduceOp = llvm::dyn_cast<triton::ReduceOp>(op);
-    if (!reduceOp)
+    if (!reduceOp || reduceOp->getNumOperands() != 1 ||
+        reduceOp.getAxis() != 1)
       return mlir::failure();
-    // only support reduce with simple addition
+    // only support reduce with simple f32 addition
     Region &combineOp = reduceOp.getCombineOp();
     bool isReduceAdd = combineOp.hasOneBlock() &&
                        combineOp.front().getOperations().size() == 2 &&
@@ -137,52 +173,120 @@ public:
     if (!isReduceAdd)
       return mlir::failure();
     // operand of reduce has to be mul
-    auto mulOp = llvm::dyn_cast_or_null<arith::MulFOp>(
-        reduceOp.getOperand(0).getDefiningOp());
+    auto mulOp = reduceOp->getOperand(0).getDefiningOp<arith::MulFOp>();
     if (!mulOp)
       return mlir::failure();
-    // mul operand has to be broadcast
-    auto broadcastLhsOp = llvm::dyn_cast_or_null<triton::BroadcastOp>(
-        mulOp.getOperand(0).getDefiningOp());
-    if (!broadcastLhsOp)
-      return mlir::failure();
-    auto broadcastRhsOp = llvm::dyn_cast_or_null<triton::BroadcastOp>(
-        mulOp.getOperand(1).getDefiningOp());
-    if (!broadcastRhsOp)
+    // mul operands are x[:, :, None] and y[None, :, :], in either order
+    Value a = getDotOperand(mulOp.getLhs(), 2);
+    Value b = getDotOperand(mulOp.getRhs(), 0);
+    if (!a || !b) {
+      a = getDotOperand(mulOp.getRhs(), 2);
+      b = getDotOperand(mulOp.getLhs(), 0);
+    }
+    if (!a || !b)
       return mlir::failure();
-    // broadcast operand is expand dims
-    auto expandLhsOp = llvm::dyn_cast_or_null<triton::ExpandDimsOp>(
-        broadcastLhsOp.getOperand().getDefiningOp());
-    if (!expandLhsOp)
+    auto aTy = a.getType().cast<RankedTensorType>();
+    auto bTy = b.getType().cast<RankedTensorType>();
+    if (aTy.getElementType() != bTy.getElementType() ||
+        aTy.getShape()[1] != bTy.getShape()[0])
       return mlir::failure();
-    auto expandRhsOp = llvm::dyn_cast_or_null<triton::ExpandDimsOp>(
-        broadcastRhsOp.getOperand().getDefiningOp());
-    if (!expandRhsOp)
+    auto resTy = reduceOp->getResult(0).getType().cast<RankedTensorType>();
+    if (resTy.getShape()[0] != aTy.getShape()[0] ||
+        resTy.getShape()[1] != bTy.getShape()[1])
       return mlir::failure();
-    // get not-broadcast dimensions
-    int expandLhsAxis = expandLhsOp.getAxis();
-    int expandRhsAxis = expandRhsOp.getAxis();
-    if (expandLhsAxis != 2 || expandRhsAxis != 0)
+    if (!isDotShape(aTy.getShape()) || !isDotShape(bTy.getShape()))
       return mlir::failure();
-    auto broadcastLhsShape =
-        broadcastLhsOp.getType().cast<ShapedType>().getShape();
-    auto broadcastRhsShape =
-        broadcastLhsOp.getType().cast<ShapedType>().getShape();
-    if (broadcastLhsShape[2] < 16 || broadcastRhsShape[0] < 16)
+    // products of f16/bf16 values are exact in f32, so only f32 inputs could
+    // lose precision on tensor cores; keep them out of tf32.
+    bool allowTF32 = !aTy.getElementType().isF32();
+    rewriter.setInsertionPoint(op);
+    auto zero = rewriter.create<arith::ConstantOp>(
+        op->getLoc(), resTy,
+        DenseElementsAttr::get(resTy, rewriter.getF32FloatAttr(0)));
+    rewriter.replaceOpWithNewOp<triton::DotOp>(op, a, b, zero, allowTF32);
+    return mlir::success();
+  }
+};
+
+// reduce(x, axis) {f}; ...; reduce(y, axis) {g}
+// -> reduce(x, y, axis) {f, g}
+// Sibling reductions of operands of the same shape along the same axis
+// share one reduction tree, and a single exchange through shared memory
+// (with its barriers) instead of one per reduction.
+class CombineSiblingReducesPattern : public mlir::RewritePattern {
+private:
+  // Whether all the users of `op` come after `point`, in the same block.
+  static bool usedAfter(Operation *op, Operation *point) {
+    Block *block = point->getBlock();
+    for (Operation *user : op->getUsers()) {
+      Operation *ancestor = block->findAncestorOpInBlock(*user);
+      if (!ancestor || ancestor == point || ancestor->isBeforeInBlock(point))
+        return false;
+    }
+    return true;
+  }
+
+public:
+  CombineSiblingReducesPattern(mlir::MLIRContext *context)
+      : mlir::RewritePattern(triton::ReduceOp::getOperationName(), 1, context) {
+  }
+
+  mlir::LogicalResult matchAndRewrite(mlir::Operation *op,
+                                      mlir::PatternRewriter &rewriter) const {
+    auto reduceOp = llvm::cast<triton::ReduceOp>(op);
+    auto shape = reduceOp.getInputTypes()[0].getShape();
+    // the closest earlier sibling whose results are only used after this
+    // reduction, which then cannot depend on them either
+    triton::ReduceOp sibling;
+    for (Operation *prev = op->getPrevNode(); prev && !sibling;
+         prev = prev->getPrevNode()) {
+      auto prevReduce = dyn_cast<triton::ReduceOp>(prev);
+      if (prevReduce && prevReduce.getAxis() == reduceOp.getAxis() &&
+          prevReduce.getInputTypes()[0].getShape() == shape &&
+          usedAfter(prev, op))
+        sibling = prevReduce;
+    }
+    if (!sibling)
       return mlir::failure();
-    Type newAccType =
-        RankedTensorType::get({broadcastLhsShape[0], broadcastRhsShape[2]},
-                              broadcastLhsOp.getOperand()
-                                  .getType()
-                                  .cast<ShapedType>()
-                                  .getElementType());
+
+    SmallVector<Value> operands(sibling.getOperands());
+    operands.append(reduceOp.getOperands().begin(),
+                    reduceOp.getOperands().end());
     rewriter.setInsertionPoint(op);
-    auto newAcc = rewriter.create<triton::SplatOp>(
-        op->getLoc(), newAccType,
-        rewriter.create<arith::ConstantOp>(op->getLoc(),
-                                           rewriter.getF32FloatAttr(0)));
-    rewriter.replaceOpWithNewOp<triton::DotOp>(
-        op, expandLhsOp.getOperand(), expandRhsOp.getOperand(), newAcc, true);
+    auto merged = rewriter.create<triton::ReduceOp>(op->getLoc(), operands,
+                                                    reduceOp.getAxis());
+    // the combine region takes the lhs of all operands, then their rhs
+    unsigned n = operands.size();
+    unsigned n0 = sibling.getNumOperands();
+    SmallVector<Type> argTys;
+    SmallVector<Location> argLocs;
+    for (unsigned i = 0; i < 2 * n; ++i) {
+      argTys.push_back(getElementTypeOrSelf(operands[i % n].getType()));
+      argLocs.push_back(op->getLoc());
+    }
+    Block *block = rewriter.createBlock(&merged.getCombineOp(), {}, argTys,
+                                        argLocs);
+    SmallVector<Value> results;
+    auto cloneCombine = [&](triton::ReduceOp from, unsigned offset) {
+      Block &body = from.getCombineOp().front();
+      unsigned m = from.getNumOperands();
+      IRMapping mapping;
+      for (unsigned i = 0; i < m; ++i) {
+        mapping.map(body.getArgument(i), block->getArgument(offset + i));
+        mapping.map(body.getArgument(m + i),
+                    block->getArgument(n + offset + i));
+      }
+      for (Operation &bodyOp : body.without_terminator())
+        rewriter.clone(bodyOp, mapping);
+      for (Value result : body.getTerminator()->getOperands())
+        results.push_back(mapping.lookupOrDefault(result));
+    };
+    cloneCombine(sibling, 0);
+    cloneCombine(reduceOp, n0);
+    rewriter.create<triton::ReduceReturnOp>(op->getLoc(), results);
+
+    rewriter.replaceOp(sibling, merged.getResult().take_front(n0));
+    rewriter.replaceOp(op, merged.getResult().drop_front(n0));
     return mlir::success();
   }
 };
@@ -202,6 +306,8 @@ public:
     patterns.add<CombineDotAddFPattern>(context);
     patterns.add<CombineDotAddIRevPattern>(context);
     patterns.add<CombineDotAddFRevPattern>(context);
+    patterns.add<CombineSparseDotAddFPattern>(context);
+    patterns.add<CombineSparseDotAddFRevPattern>(context);
     // %}
     patterns.add<CombineSelectMaskedLoadPattern>(context);
     // patterns.add<CombineAddPtrPattern>(context);
@@ -210,6 +316,13 @@ public:
 
     if (applyPatternsAndFoldGreedily(m, std::move(patterns)).failed())
       signalPassFailure();
+
+    // sibling reductions are merged once the patterns above, which match
+    // single reductions, are done
+    mlir::RewritePatternSet siblingPatterns(context);
+    siblingPatterns.add<CombineSiblingReducesPattern>(context);
+    if (applyPatternsAndFoldGreedily(m, std::move(siblingPatterns)).failed())
+      signalPassFailure();
   }
 };
 
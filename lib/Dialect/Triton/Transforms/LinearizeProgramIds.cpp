@@ -0,0 +1,110 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Pass/Pass.h"
+
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+
+#include <memory>
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace {
+
+class LinearizeProgramIdsPass
+    : public TritonLinearizeProgramIdsBase<LinearizeProgramIdsPass> {
+public:
+  // Adds the three dimensions of the logical grid to the arguments of
+  // `funcOp`, before the tensor maps of a kernel, which the launcher passes
+  // last, and returns the first of them
+  unsigned addGridArguments(triton::FuncOp funcOp, unsigned numTensorMaps) {
+    unsigned first = funcOp.getNumArguments();
+    if (funcOp.isPublic())
+      first -= numTensorMaps;
+    Type i32Ty = IntegerType::get(funcOp.getContext(), 32);
+    for (unsigned axis = 0; axis < 3; ++axis)
+      funcOp.insertArgument(first + axis, i32Ty, /*argAttrs=*/nullptr,
+                            funcOp.getLoc());
+    return first;
+  }
+
+  // Replaces the program ids of `funcOp` with their coordinates in the
+  // logical grid (num_x, num_y, num_z), computed once at its entry from the
+  // id of the program along axis 0:
+  //
+  //   x' = x % num_x
+  //   y' = x / num_x % num_y
+  //   z' = x / num_x / num_y
+  //
+  // and its numbers of programs with the dimensions of the logical grid
+  void linearize(triton::FuncOp funcOp, unsigned firstGridArg) {
+    SmallVector<triton::GetProgramIdOp> pidOps;
+    SmallVector<triton::GetNumProgramsOp> numOps;
+    funcOp.walk([&](Operation *op) {
+      if (auto pidOp = dyn_cast<triton::GetProgramIdOp>(op))
+        pidOps.push_back(pidOp);
+      else if (auto numOp = dyn_cast<triton::GetNumProgramsOp>(op))
+        numOps.push_back(numOp);
+    });
+    auto getNumPrograms = [&](int axis) -> Value {
+      return funcOp.getArgument(firstGridArg + axis);
+    };
+    for (auto op : numOps) {
+      op.getResult().replaceAllUsesWith(getNumPrograms(op.getAxis()));
+      op.erase();
+    }
+    if (pidOps.empty())
+      return;
+
+    Location loc = funcOp.getLoc();
+    auto builder = OpBuilder::atBlockBegin(&funcOp.getBody().front());
+    Value pid = builder.create<triton::GetProgramIdOp>(
+        loc, builder.getI32Type(),
+        triton::ProgramIDDimAttr::get(builder.getContext(),
+                                      triton::ProgramIDDim::X));
+    Value rows = builder.create<arith::DivSIOp>(loc, pid, getNumPrograms(0));
+    Value newPids[3] = {
+        builder.create<arith::RemSIOp>(loc, pid, getNumPrograms(0)),
+        builder.create<arith::RemSIOp>(loc, rows, getNumPrograms(1)),
+        builder.create<arith::DivSIOp>(loc, rows, getNumPrograms(1))};
+
+    for (auto op : pidOps) {
+      op.getResult().replaceAllUsesWith(newPids[op.getAxisAsInt()]);
+      op.erase();
+    }
+  }
+
+  void runOnOperation() override {
+    ModuleOp m = getOperation();
+    unsigned numTensorMaps = 0;
+    if (auto tensorMaps = m->getAttrOfType<ArrayAttr>("tt.tensor_maps"))
+      numTensorMaps = tensorMaps.size();
+
+    DenseMap<triton::FuncOp, unsigned> firstGridArgs;
+    for (auto funcOp : m.getOps<triton::FuncOp>())
+      if (!funcOp.isExternal())
+        firstGridArgs[funcOp] = addGridArguments(funcOp, numTensorMaps);
+
+    // Calls pass the logical grid of their caller on
+    m.walk([&](triton::CallOp callOp) {
+      auto callee = m.lookupSymbol<triton::FuncOp>(callOp.getCallee());
+      auto caller = callOp->getParentOfType<triton::FuncOp>();
+      if (!callee || !firstGridArgs.count(callee))
+        return;
+      auto gridArgs =
+          caller.getArguments().slice(firstGridArgs[caller], /*N=*/3);
+      callOp->insertOperands(callOp->getNumOperands(), gridArgs);
+    });
+
+    for (auto [funcOp, firstGridArg] : firstGridArgs)
+      linearize(funcOp, firstGridArg);
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> mlir::triton::createLinearizeProgramIdsPass() {
+  return std::make_unique<LinearizeProgramIdsPass>();
+}
@@ -0,0 +1,163 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/TypeUtilities.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+
+#include <limits>
+#include <memory>
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace {
+
+// `type`, an i64 scalar or tensor, with i32 elements
+Type getI32Type(Type type) {
+  auto i32Ty = IntegerType::get(type.getContext(), 32);
+  if (auto tensorTy = type.dyn_cast<RankedTensorType>())
+    return RankedTensorType::get(tensorTy.getShape(), i32Ty,
+                                 tensorTy.getEncoding());
+  return i32Ty;
+}
+
+bool isI64(Type type) { return getElementTypeOrSelf(type).isInteger(64); }
+
+// Ops whose low 32 result bits only depend on the low 32 bits of their
+// (non-condition) operands, so that they can be computed in i32
+bool isTruncatable(Operation *op) {
+  return isa<arith::AddIOp, arith::SubIOp, arith::MulIOp, arith::AndIOp,
+             arith::OrIOp, arith::XOrIOp, arith::SelectOp, triton::SplatOp,
+             triton::BroadcastOp, triton::ExpandDimsOp, triton::ViewOp,
+             triton::TransOp>(op);
+}
+
+class NarrowOffsetsPass : public TritonNarrowOffsetsBase<NarrowOffsetsPass> {
+private:
+  // i32 truncations of the i64 values already rewritten
+  DenseMap<Value, Value> truncated;
+
+  // Builds the truncation of `value` to i32, pushed up through the integer
+  // arithmetic that computes it
+  Value truncate(OpBuilder &builder, Value value) {
+    auto it = truncated.find(value);
+    if (it != truncated.end())
+      return it->second;
+    Type i32Ty = getI32Type(value.getType());
+    Operation *op = value.getDefiningOp();
+    Value result;
+    OpBuilder::InsertionGuard guard(builder);
+    builder.setInsertionPointAfterValue(value);
+    if (op && isa<arith::ExtSIOp, arith::ExtUIOp, arith::IndexCastOp>(op)) {
+      Value src = op->getOperand(0);
+      Type srcElemTy = getElementTypeOrSelf(src.getType());
+      if (srcElemTy.isIndex())
+        result = builder.create<arith::IndexCastOp>(op->getLoc(), i32Ty, src);
+      else if (srcElemTy.getIntOrFloatBitWidth() == 32)
+        result = src;
+      else if (srcElemTy.getIntOrFloatBitWidth() < 32 &&
+               isa<arith::ExtSIOp>(op))
+        result = builder.create<arith::ExtSIOp>(op->getLoc(), i32Ty, src);
+      else if (srcElemTy.getIntOrFloatBitWidth() < 32)
+        result = builder.create<arith::ExtUIOp>(op->getLoc(), i32Ty, src);
+    } else if (auto constOp = dyn_cast_or_null<arith::ConstantOp>(op)) {
+      Attribute attr;
+      if (auto intAttr = constOp.getValue().dyn_cast<IntegerAttr>())
+        attr = IntegerAttr::get(i32Ty, intAttr.getValue().trunc(32));
+      else if (auto denseAttr =
+                   constOp.getValue().dyn_cast<DenseIntElementsAttr>())
+        attr = denseAttr.mapValues(
+            getElementTypeOrSelf(i32Ty),
+            [](const APInt &v) -> APInt { return v.trunc(32); });
+      if (attr)
+        result = builder.create<arith::ConstantOp>(op->getLoc(), i32Ty,
+                                                   cast<TypedAttr>(attr));
+    } else if (op && op->getNumResults() == 1 && isTruncatable(op)) {
+      IRMapping mapping;
+      for (Value operand : op->getOperands())
+        if (isI64(operand.getType()))
+          mapping.map(operand, truncate(builder, operand));
+      Operation *newOp = builder.clone(*op, mapping);
+      newOp->getResult(0).setType(i32Ty);
+      result = newOp->getResult(0);
+    }
+    // Anything else is computed in i64 and truncated
+    if (!result)
+      result = builder.create<arith::TruncIOp>(value.getLoc(), i32Ty, value);
+    truncated[value] = result;
+    return result;
+  }
+
+  static bool fitsI32(AxisInfo *axisInfo) {
+    if (!axisInfo || !axisInfo->getValueRange())
+      return false;
+    auto [min, max] = *axisInfo->getValueRange();
+    return min >= std::numeric_limits<int32_t>::min() &&
+           max <= std::numeric_limits<int32_t>::max();
+  }
+
+public:
+  NarrowOffsetsPass(bool assumeSmallTensors) {
+    this->assumeSmallTensors = assumeSmallTensors;
+  }
+
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    // The promise is kept for the lowering, which can then address tensors
+    // with 32-bit offsets from their base
+    if (assumeSmallTensors)
+      mod->setAttr("tt.small_tensors", UnitAttr::get(mod.getContext()));
+    // Offsets are collected before rewriting anything, as the axis info
+    // is not updated with the new ops
+    SmallVector<triton::AddPtrOp> addPtrOps;
+    ModuleAxisInfoAnalysis &axisInfoAnalysis =
+        getAnalysis<ModuleAxisInfoAnalysis>();
+    mod.walk([&](triton::AddPtrOp addPtrOp) {
+      Value offset = addPtrOp.getOffset();
+      if (!isI64(offset.getType()))
+        return;
+      if (assumeSmallTensors || fitsI32(axisInfoAnalysis.getAxisInfo(offset)))
+        addPtrOps.push_back(addPtrOp);
+    });
+    if (addPtrOps.empty()) {
+      markAllAnalysesPreserved();
+      return;
+    }
+    // A GEP sign-extends its i32 index, which gives back the i64 offset when
+    // that offset fits in i32, whatever the intermediate values are: the low
+    // 32 bits of sums and products only depend on those of their operands.
+    OpBuilder builder(mod.getContext());
+    SetVector<Operation *> maybeDead;
+    for (auto addPtrOp : addPtrOps) {
+      Value offset = addPtrOp.getOffset();
+      addPtrOp.getOffsetMutable().assign(truncate(builder, offset));
+      if (Operation *def = offset.getDefiningOp())
+        maybeDead.insert(def);
+    }
+    // Erase the i64 computations left without users
+    while (!maybeDead.empty()) {
+      Operation *op = maybeDead.pop_back_val();
+      if (!isOpTriviallyDead(op))
+        continue;
+      for (Value operand : op->getOperands())
+        if (Operation *def = operand.getDefiningOp())
+          maybeDead.insert(def);
+      op->erase();
+    }
+    truncated.clear();
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass>
+mlir::triton::createNarrowOffsetsPass(bool assumeSmallTensors) {
+  return std::make_unique<NarrowOffsetsPass>(assumeSmallTensors);
+}
@@ -1,4 +1,5 @@
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
 #include "mlir/Pass/Pass.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/Triton/Transforms/Passes.h"
@@ -20,6 +21,7 @@ private:
   SmallVector<Value> strides;
   SmallVector<Value> offsets;
   ArrayRef<int64_t> tensorShape;
+  ArrayRef<int32_t> order;
 
   // A cache to avoid generating the same offset with range
   DenseMap<unsigned, Value> cachedOffsetWithRange;
@@ -32,15 +34,26 @@ public:
   RewritedInfo(Value base, const SmallVector<Value> &shape,
                const SmallVector<Value> &strides,
                const SmallVector<Value> &offsets,
-               const ArrayRef<int64_t> &tensorShape)
+               const ArrayRef<int64_t> &tensorShape,
+               const ArrayRef<int32_t> &order)
       : base(base), shape(shape), strides(strides), offsets(offsets),
-        tensorShape(tensorShape) {
+        tensorShape(tensorShape), order(order) {
     assert(shape.size() == strides.size() && shape.size() == offsets.size() &&
            shape.size() == tensorShape.size());
   }
 
   unsigned int length() const { return shape.size(); }
 
+  Value getBase() const { return base; }
+
+  ArrayRef<Value> getShape() const { return shape; }
+
+  ArrayRef<Value> getStrides() const { return strides; }
+
+  ArrayRef<int64_t> getTensorShape() const { return tensorShape; }
+
+  ArrayRef<int32_t> getOrder() const { return order; }
+
   Value getOffset(unsigned i) { return offsets[i]; }
 
   SmallVector<Value> getOffsets() { return offsets; }
@@ -186,15 +199,29 @@ public:
   }
 };
 
+/// A tensor map passed to the kernel, and the block pointers it describes
+struct TensorMapInfo {
+  Value base;
+  SmallVector<Value> shape;
+  SmallVector<Value> strides;
+  SmallVector<int64_t> box;
+  SmallVector<int32_t> order;
+  Value desc;
+};
+
 class RewriteTensorPointerPass
     : public TritonRewriteTensorPointerBase<RewriteTensorPointerPass> {
 private:
-  int computeCapability;
   DenseMap<Value, RewritedInfo> rewritedInfo;
+  SmallVector<TensorMapInfo> tensorMaps;
+  // What the launcher builds each tensor map from, see `tt.tensor_maps`
+  SmallVector<Attribute> tensorMapAttrs;
 
 public:
-  explicit RewriteTensorPointerPass(int computeCapability)
-      : computeCapability(computeCapability) {}
+  RewriteTensorPointerPass(int computeCapability, bool enableTMA) {
+    this->computeCapability = computeCapability;
+    this->enableTMA = enableTMA;
+  }
 
   static bool needRewrite(Operation *op) {
     return std::any_of(op->getOperands().begin(), op->getOperands().end(),
@@ -217,6 +244,172 @@ public:
     return newOperands;
   }
 
+  // Returns the index of the kernel argument `value` is, possibly
+  // sign-extended
+  static std::optional<unsigned> getKernelArgIndex(Value value) {
+    if (auto extOp = value.getDefiningOp<arith::ExtSIOp>())
+      value = extOp.getIn();
+    auto arg = value.dyn_cast<BlockArgument>();
+    if (!arg || !arg.getOwner()->isEntryBlock() ||
+        !isa<triton::FuncOp>(arg.getOwner()->getParentOp()))
+      return std::nullopt;
+    return arg.getArgNumber();
+  }
+
+  static int64_t getDivisibility(triton::FuncOp funcOp, unsigned argIdx) {
+    if (auto attr = funcOp.getArgAttrOfType<IntegerAttr>(argIdx,
+                                                         "tt.divisibility"))
+      return attr.getInt();
+    return 1;
+  }
+
+  // Records `value`, which the launcher passes to the tensor map encoder,
+  // as a kernel argument index or as a constant (with the index -1)
+  static bool recordArgOrConstant(Value value, SmallVector<int32_t> &args,
+                                  SmallVector<int64_t> &constants) {
+    if (auto argIdx = getKernelArgIndex(value)) {
+      args.push_back(*argIdx);
+      constants.push_back(0);
+      return true;
+    }
+    if (auto constant = getConstantIntValue(value)) {
+      args.push_back(-1);
+      constants.push_back(*constant);
+      return true;
+    }
+    return false;
+  }
+
+  // Returns the tensor map argument to load the block of `info` with, adding
+  // it to the kernel if it is new, or a null value if the tensor cannot be
+  // described by a tensor map: its base, shape and strides must be known to
+  // the launcher, and TMA requires 16-byte aligned base and strides, a
+  // contiguous box dimension of a multiple of 16 bytes and box dimensions of
+  // at most 256 elements
+  Value getTensorMap(OpBuilder &builder, triton::FuncOp funcOp,
+                     RewritedInfo &info) {
+    auto elemTy =
+        info.getBase().getType().cast<triton::PointerType>().getPointeeType();
+    if (!elemTy.isIntOrFloat())
+      return {};
+    unsigned bitwidth = elemTy.getIntOrFloatBitWidth();
+    if (bitwidth < 8 || bitwidth > 64 || !llvm::isPowerOf2_32(bitwidth))
+      return {};
+    int64_t elemBytes = bitwidth / 8;
+    unsigned rank = info.length();
+    if (rank > 5)
+      return {};
+
+    auto baseIdx = getKernelArgIndex(info.getBase());
+    if (!baseIdx || getDivisibility(funcOp, *baseIdx) % 16 != 0)
+      return {};
+
+    // Tensor maps list the dimensions fastest-varying first
+    auto order = info.getOrder();
+    SmallVector<int64_t> box, dims, strides;
+    SmallVector<int32_t> dimArgs, strideArgs;
+    for (unsigned i = 0; i < rank; ++i) {
+      unsigned dim = order[i];
+      box.push_back(info.getTensorShape()[dim]);
+      if (box.back() > 256)
+        return {};
+      if (!recordArgOrConstant(info.getShape()[dim], dimArgs, dims))
+        return {};
+      Value stride = info.getStrides()[dim];
+      if (i == 0) {
+        if (getConstantIntValue(stride) != 1)
+          return {};
+        continue;
+      }
+      if (!recordArgOrConstant(stride, strideArgs, strides))
+        return {};
+      int64_t divisibility = strideArgs.back() >= 0
+                                 ? getDivisibility(funcOp, strideArgs.back())
+                                 : strides.back();
+      if (divisibility <= 0 || divisibility * elemBytes % 16 != 0)
+        return {};
+    }
+    if (box[0] * elemBytes % 16 != 0)
+      return {};
+
+    // Blocks of the same tensor with the same shape share their tensor map
+    for (auto &tensorMap : tensorMaps)
+      if (tensorMap.base == info.getBase() &&
+          ArrayRef<Value>(tensorMap.shape) == info.getShape() &&
+          ArrayRef<Value>(tensorMap.strides) == info.getStrides() &&
+          ArrayRef<int64_t>(tensorMap.box) == ArrayRef<int64_t>(box) &&
+          ArrayRef<int32_t>(tensorMap.order) == order)
+        return tensorMap.desc;
+
+    unsigned descIdx = funcOp.getNumArguments();
+    funcOp.insertArgument(descIdx,
+                          triton::PointerType::get(builder.getI8Type(), 1),
+                          /*argAttrs=*/nullptr, funcOp.getLoc());
+    Value desc = funcOp.getArgument(descIdx);
+    tensorMaps.push_back({info.getBase(),
+                          SmallVector<Value>(info.getShape()),
+                          SmallVector<Value>(info.getStrides()), box,
+                          SmallVector<int32_t>(order), desc});
+
+    NamedAttrList attrs;
+    attrs.append("base", builder.getI32IntegerAttr(*baseIdx));
+    attrs.append("elem_bytes", builder.getI32IntegerAttr(elemBytes));
+    attrs.append("box", builder.getDenseI64ArrayAttr(box));
+    attrs.append("dim_args", builder.getDenseI32ArrayAttr(dimArgs));
+    attrs.append("dims", builder.getDenseI64ArrayAttr(dims));
+    attrs.append("stride_args", builder.getDenseI32ArrayAttr(strideArgs));
+    attrs.append("strides", builder.getDenseI64ArrayAttr(strides));
+    tensorMapAttrs.push_back(attrs.getDictionary(builder.getContext()));
+    return desc;
+  }
+
+  // Rewrites `loadOp` into a `tt.tma_load` if its block can be loaded with
+  // the Tensor Memory Accelerator
+  bool rewriteTMALoadOp(OpBuilder &builder, triton::LoadOp loadOp,
+                        RewritedInfo &info) {
+    if (!enableTMA || computeCapability < 90 || loadOp.getIsVolatile())
+      return false;
+    // Out of bounds elements are filled with zeros
+    auto padding = loadOp.getPadding();
+    if (padding.has_value() &&
+        padding.value() != triton::PaddingOption::PAD_ZERO)
+      return false;
+    auto funcOp = loadOp->getParentOfType<triton::FuncOp>();
+    if (!funcOp || !funcOp.isPublic())
+      return false;
+    Value desc = getTensorMap(builder, funcOp, info);
+    if (!desc)
+      return false;
+
+    SmallVector<Value> offsets;
+    for (unsigned i = 0; i < info.length(); ++i)
+      offsets.push_back(builder.create<arith::TruncIOp>(
+          loadOp.getLoc(), builder.getI32Type(), info.getOffset(i)));
+    auto tmaLoadOp = builder.create<triton::TMALoadOp>(
+        loadOp.getLoc(), loadOp.getType(), desc, offsets, info.getOrder());
+    loadOp.getResult().replaceAllUsesWith(tmaLoadOp.getResult());
+    return true;
+  }
+
+  // Rewrites `loadOp` into a `tt.block_load`, whose threads compute the
+  // addresses and masks of their own elements, unless it is in the body of a
+  // loop: the loop pipeliner copies such loads with `cp.async` from tensors of
+  // pointers
+  bool rewriteBlockLoadOp(OpBuilder &builder, triton::LoadOp loadOp,
+                          RewritedInfo &info) {
+    if (isa<scf::ForOp>(loadOp->getParentOp()))
+      return false;
+    auto boundaryCheck = loadOp.getBoundaryCheck();
+    auto blockLoadOp = builder.create<triton::BlockLoadOp>(
+        loadOp.getLoc(), loadOp.getType(), info.getBase(), info.getShape(),
+        info.getStrides(), info.getOffsets(), info.getOrder(),
+        boundaryCheck.value_or(ArrayRef<int32_t>()), loadOp.getPaddingAttr(),
+        loadOp.getCache(), loadOp.getEvict(), loadOp.getIsVolatile(),
+        loadOp.getL2Evict());
+    loadOp.getResult().replaceAllUsesWith(blockLoadOp.getResult());
+    return true;
+  }
+
   Operation *rewriteMakeTensorPtrOp(OpBuilder &builder,
                                     triton::MakeTensorPtrOp op,
                                     std::stack<Operation *> &eraser) {
@@ -235,7 +428,7 @@ public:
     // Save information
     rewritedInfo[op.getResult()] =
         RewritedInfo(op.getBase(), op.getShape(), op.getStrides(), i64Offsets,
-                     tensorType.getShape());
+                     tensorType.getShape(), op.getOrder());
 
     // Erase the original operation
     eraser.push(op);
@@ -281,6 +474,16 @@ public:
     assert(rewritedInfo.count(ptr));
     auto info = rewritedInfo[ptr];
 
+    // Loads keep their block, with the Tensor Memory Accelerator if it
+    // supports them
+    if (auto loadOp = dyn_cast<triton::LoadOp>(op)) {
+      if (rewriteTMALoadOp(builder, loadOp, info) ||
+          rewriteBlockLoadOp(builder, loadOp, info)) {
+        eraser.push(op);
+        return nullptr;
+      }
+    }
+
     // Load/store with tensor pointers implicitly will check the bound while
     // accessing memory, so we should set `mask` and `other` (according to the
     // padding). Also note that load with tensor pointers do not have `mask` and
@@ -305,12 +508,12 @@ public:
     if (auto loadOp = dyn_cast<triton::LoadOp>(op)) {
       auto newResult = builder.create<triton::LoadOp>(
           loadOp.getLoc(), newPtr, newMask, newOther, loadOp.getCache(),
-          loadOp.getEvict(), loadOp.getIsVolatile());
+          loadOp.getEvict(), loadOp.getIsVolatile(), loadOp.getL2Evict());
       op->getResult(0).replaceAllUsesWith(newResult);
     } else if (auto storeOp = dyn_cast<triton::StoreOp>(op)) {
-      builder.create<triton::StoreOp>(storeOp.getLoc(), newPtr,
-                                      storeOp.getValue(), newMask,
-                                      storeOp.getCache(), storeOp.getEvict());
+      builder.create<triton::StoreOp>(
+          storeOp.getLoc(), newPtr, storeOp.getValue(), newMask,
+          storeOp.getCache(), storeOp.getEvict(), storeOp.getL2Evict());
     }
 
     // Erase the original operation
@@ -490,6 +693,11 @@ public:
     // The operation could not be erased during visit, because they may have
     // later usages, so we erase after visit
     rewritedInfo.clear();
+    tensorMaps.clear();
+    if (!tensorMapAttrs.empty())
+      getOperation()->setAttr("tt.tensor_maps",
+                              ArrayAttr::get(&getContext(), tensorMapAttrs));
+    tensorMapAttrs.clear();
     while (!eraser.empty()) {
       auto op = eraser.top();
       eraser.pop();
@@ -499,6 +707,8 @@ public:
 };
 
 std::unique_ptr<Pass>
-triton::createRewriteTensorPointerPass(int computeCapability) {
-  return std::make_unique<RewriteTensorPointerPass>(computeCapability);
+triton::createRewriteTensorPointerPass(int computeCapability,
+                                       bool enableTMA) {
+  return std::make_unique<RewriteTensorPointerPass>(computeCapability,
+                                                    enableTMA);
 }
@@ -0,0 +1,88 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Pass/Pass.h"
+
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+
+#include <memory>
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+namespace {
+
+class SwizzleProgramIdsPass
+    : public TritonSwizzleProgramIdsBase<SwizzleProgramIdsPass> {
+public:
+  SwizzleProgramIdsPass(int groupSize) { this->groupSize = groupSize; }
+
+  // Replaces the `x` and `y` program ids of `funcOp` with their grouped
+  // coordinates, computed once at its entry:
+  //
+  //   pid = y * num_x + x
+  //   first_x = pid / (group_size * num_y) * group_size
+  //   group_x = min(num_x - first_x, group_size)
+  //   x' = first_x + pid % (group_size * num_y) % group_x
+  //   y' = pid % (group_size * num_y) / group_x
+  void swizzle(triton::FuncOp funcOp) {
+    SmallVector<triton::GetProgramIdOp> pidOps;
+    funcOp.walk([&](triton::GetProgramIdOp op) {
+      if (op.getAxis() != triton::ProgramIDDim::Z)
+        pidOps.push_back(op);
+    });
+    if (pidOps.empty())
+      return;
+
+    Location loc = funcOp.getLoc();
+    auto builder = OpBuilder::atBlockBegin(&funcOp.getBody().front());
+    Type i32Ty = builder.getI32Type();
+    auto getPid = [&](triton::ProgramIDDim axis) -> Value {
+      return builder.create<triton::GetProgramIdOp>(
+          loc, i32Ty,
+          triton::ProgramIDDimAttr::get(builder.getContext(), axis));
+    };
+    auto getNumPrograms = [&](int axis) -> Value {
+      return builder.create<triton::GetNumProgramsOp>(
+          loc, i32Ty, builder.getI32IntegerAttr(axis));
+    };
+    Value x = getPid(triton::ProgramIDDim::X);
+    Value y = getPid(triton::ProgramIDDim::Y);
+    Value numX = getNumPrograms(0);
+    Value numY = getNumPrograms(1);
+    Value size = builder.create<arith::ConstantIntOp>(loc, groupSize, 32);
+
+    Value pid = builder.create<arith::AddIOp>(
+        loc, builder.create<arith::MulIOp>(loc, y, numX), x);
+    Value groupPrograms = builder.create<arith::MulIOp>(loc, size, numY);
+    Value firstX = builder.create<arith::MulIOp>(
+        loc, builder.create<arith::DivSIOp>(loc, pid, groupPrograms), size);
+    Value groupX = builder.create<arith::MinSIOp>(
+        loc, builder.create<arith::SubIOp>(loc, numX, firstX), size);
+    Value inGroup = builder.create<arith::RemSIOp>(loc, pid, groupPrograms);
+    Value newX = builder.create<arith::AddIOp>(
+        loc, firstX, builder.create<arith::RemSIOp>(loc, inGroup, groupX));
+    Value newY = builder.create<arith::DivSIOp>(loc, inGroup, groupX);
+
+    for (auto op : pidOps) {
+      op.getResult().replaceAllUsesWith(
+          op.getAxis() == triton::ProgramIDDim::X ? newX : newY);
+      op.erase();
+    }
+  }
+
+  void runOnOperation() override {
+    if (groupSize <= 1)
+      return;
+    for (auto funcOp : getOperation().getOps<triton::FuncOp>())
+      if (!funcOp.isExternal())
+        swizzle(funcOp);
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> mlir::triton::createSwizzleProgramIdsPass(int groupSize) {
+  return std::make_unique<SwizzleProgramIdsPass>(groupSize);
+}
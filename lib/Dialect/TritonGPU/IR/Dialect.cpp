@@ -30,6 +30,8 @@ unsigned getTotalElemsPerThread(Attribute layout, ArrayRef<int64_t> shape,
     return sliceLayout.getTotalElemsPerThread(shape, eltTy);
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
     return mmaLayout.getTotalElemsPerThread(shape, eltTy);
+  } else if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>()) {
+    return mfmaLayout.getTotalElemsPerThread(shape, eltTy);
   } else if (auto sharedLayout = layout.dyn_cast<SharedEncodingAttr>()) {
     return sharedLayout.getTotalElemsPerThread(shape, eltTy);
   } else if (auto dotLayout = layout.dyn_cast<DotOperandEncodingAttr>()) {
@@ -48,6 +50,8 @@ SmallVector<unsigned> getElemsPerThread(Attribute layout,
     return sliceLayout.getElemsPerThread(shape, eltTy);
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
     return mmaLayout.getElemsPerThread(shape, eltTy);
+  } else if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>()) {
+    return mfmaLayout.getElemsPerThread(shape, eltTy);
   } else {
     assert(0 && "getElemsPerThread not implemented");
     return SmallVector<unsigned>();
@@ -78,9 +82,11 @@ SmallVector<unsigned> getThreadsPerWarp(Attribute layout) {
   if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
     if (mmaLayout.isVolta())
       return {4, 8};
-    if (mmaLayout.isAmpere())
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper())
       return {8, 4};
   }
+  if (layout.isa<MfmaEncodingAttr>())
+    return {2, 32};
   if (auto sliceLayout = layout.dyn_cast<SliceEncodingAttr>()) {
     auto parent = sliceLayout.getParent();
     auto parentThreadsPerWarp = getThreadsPerWarp(parent);
@@ -127,6 +133,10 @@ SmallVector<unsigned> getWarpsPerCTA(Attribute layout) {
     return SmallVector<unsigned>(mmaLayout.getWarpsPerCTA().begin(),
                                  mmaLayout.getWarpsPerCTA().end());
   }
+  if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>()) {
+    return SmallVector<unsigned>(mfmaLayout.getWarpsPerCTA().begin(),
+                                 mfmaLayout.getWarpsPerCTA().end());
+  }
   if (auto sliceLayout = layout.dyn_cast<SliceEncodingAttr>()) {
     auto parent = sliceLayout.getParent();
     auto parentWarpsPerCTA = getWarpsPerCTA(parent);
@@ -175,16 +185,26 @@ SmallVector<unsigned> getSizePerThread(Attribute layout) {
     sizePerThread.erase(sizePerThread.begin() + sliceLayout.getDim());
     return sizePerThread;
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-    if (mmaLayout.isAmpere()) {
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
       return {2, 2};
     } else if (mmaLayout.isVolta()) {
       return {1, 2};
     } else {
       llvm_unreachable("Unexpected mma version");
     }
+  } else if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>()) {
+    return {16, 1};
   } else if (auto dotLayout = layout.dyn_cast<DotOperandEncodingAttr>()) {
     auto parentLayout = dotLayout.getParent();
     assert(parentLayout && "DotOperandEncodingAttr must have a parent");
+    if (parentLayout.isa<MfmaEncodingAttr>()) {
+      // Each lane holds kWidth consecutive values along k, as set for the
+      // element type when the encoding was built (16-bit when left out)
+      unsigned kWidth = dotLayout.getMFMAOperandKWidth(16);
+      if (dotLayout.getOpIdx() == 0)
+        return {1, kWidth};
+      return {kWidth, 1};
+    }
     if (auto parentMmaLayout = parentLayout.dyn_cast<MmaEncodingAttr>()) {
       assert(parentMmaLayout.isAmpere() &&
              "mmaLayout version = 1 is not implemented yet");
@@ -211,8 +231,10 @@ SmallVector<unsigned> getSizePerThread(Attribute layout) {
 
 SmallVector<unsigned> getContigPerThread(Attribute layout) {
   if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-    assert(mmaLayout.isVolta() || mmaLayout.isAmpere());
+    assert(mmaLayout.isVolta() || mmaLayout.isAmpere() || mmaLayout.isHopper());
     return {1, 2};
+  } else if (layout.isa<MfmaEncodingAttr>()) {
+    return {4, 1};
   } else if (auto sliceLayout = layout.dyn_cast<SliceEncodingAttr>()) {
     auto parentLayout = sliceLayout.getParent();
     return getContigPerThread(parentLayout);
@@ -252,11 +274,14 @@ SmallVector<unsigned> getThreadsPerCTA(Attribute layout) {
       threads.push_back(blockedLayout.getThreadsPerWarp()[d] *
                         blockedLayout.getWarpsPerCTA()[d]);
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-    if (mmaLayout.isAmpere()) {
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
       threads = {8 * mmaLayout.getWarpsPerCTA()[0],
                  4 * mmaLayout.getWarpsPerCTA()[1]};
     } else
       assert(0 && "Unimplemented usage of MmaEncodingAttr");
+  } else if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>()) {
+    threads = {2 * mfmaLayout.getWarpsPerCTA()[0],
+               32 * mfmaLayout.getWarpsPerCTA()[1]};
   } else {
     assert(0 && "Unimplemented usage of getShapePerCTA");
   }
@@ -281,7 +306,7 @@ SmallVector<unsigned> getShapePerCTA(Attribute layout,
       shape.push_back(getShapePerCTA(parent, tensorShape)[d]);
     }
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-    if (mmaLayout.isAmpere())
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper())
       return {16 * mmaLayout.getWarpsPerCTA()[0],
               8 * mmaLayout.getWarpsPerCTA()[1]};
     if (mmaLayout.isVolta()) {
@@ -293,9 +318,20 @@ SmallVector<unsigned> getShapePerCTA(Attribute layout,
               static_cast<unsigned>(tensorShape[1])};
     }
     assert(0 && "Unexpected MMA layout version found");
+  } else if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>()) {
+    return {32 * mfmaLayout.getWarpsPerCTA()[0],
+            32 * mfmaLayout.getWarpsPerCTA()[1]};
   } else if (auto dotLayout = layout.dyn_cast<DotOperandEncodingAttr>()) {
     auto parentLayout = dotLayout.getParent();
     assert(parentLayout && "DotOperandEncodingAttr must have a parent");
+    if (parentLayout.isa<MfmaEncodingAttr>()) {
+      auto parentShapePerCTA = getShapePerCTA(parentLayout, tensorShape);
+      // The two halves of a wavefront cover 2 * kWidth values along k
+      unsigned kPerInstr = 2 * dotLayout.getMFMAOperandKWidth(16);
+      if (dotLayout.getOpIdx() == 0)
+        return {parentShapePerCTA[0], kPerInstr};
+      return {kPerInstr, parentShapePerCTA[1]};
+    }
     if (auto parentMmaLayout = parentLayout.dyn_cast<MmaEncodingAttr>()) {
       assert(parentMmaLayout.isAmpere() &&
              "mmaLayout version = 1 is not implemented yet");
@@ -324,6 +360,8 @@ SmallVector<unsigned> getOrder(Attribute layout) {
                                  blockedLayout.getOrder().end());
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
     return {1, 0};
+  } else if (auto mfmaLayout = layout.dyn_cast<MfmaEncodingAttr>()) {
+    return {1, 0};
   } else if (auto dotLayout = layout.dyn_cast<DotOperandEncodingAttr>()) {
     return {1, 0};
   } else if (auto sliceLayout = layout.dyn_cast<SliceEncodingAttr>()) {
@@ -350,7 +388,7 @@ SmallVector<unsigned> getOrder(Attribute layout) {
 
 bool isaDistributedLayout(Attribute layout) {
   return layout.isa<BlockedEncodingAttr>() || layout.isa<MmaEncodingAttr>() ||
-         layout.isa<SliceEncodingAttr>();
+         layout.isa<MfmaEncodingAttr>() || layout.isa<SliceEncodingAttr>();
 }
 
 bool isSharedEncoding(Value value) {
@@ -362,6 +400,14 @@ bool isSharedEncoding(Value value) {
   return false;
 }
 
+bool isMmaV3DotOperand(Attribute layout) {
+  auto dotOpLayout = layout.dyn_cast_or_null<DotOperandEncodingAttr>();
+  if (!dotOpLayout)
+    return false;
+  auto mmaParent = dotOpLayout.getParent().dyn_cast<MmaEncodingAttr>();
+  return mmaParent && mmaParent.isHopper();
+}
+
 bool isExpensiveCat(CatOp cat, Attribute &targetEncoding) {
   // If the new elements per thread is less than the old one, we will need to do
   // convert encoding that goes through shared memory anyway. So we consider it
@@ -372,7 +418,102 @@ bool isExpensiveCat(CatOp cat, Attribute &targetEncoding) {
   auto elemTy = tensorTy.getElementType();
   auto newTotalElemsPerThread =
       gpu::getTotalElemsPerThread(targetEncoding, shape, elemTy);
-  return newTotalElemsPerThread < totalElemsPerThread;
+  if (newTotalElemsPerThread < totalElemsPerThread)
+    return true;
+  // Otherwise the registers of the operands are only renamed if every thread
+  // holds distinct elements of all of them
+  auto newTy = RankedTensorType::get(shape, elemTy, targetEncoding);
+  SmallVector<RankedTensorType> srcTys;
+  for (Value operand : cat.getOperands())
+    srcTys.push_back(operand.getType().cast<RankedTensorType>());
+  return !isRegisterRenaming(srcTys, newTy);
+}
+
+bool isExpensiveView(ViewOp view, Attribute &targetEncoding) {
+  auto srcTy = view.getSrc().getType().cast<RankedTensorType>();
+  auto tensorTy = view.getResult().getType().cast<RankedTensorType>();
+  auto newTy = RankedTensorType::get(tensorTy.getShape(),
+                                     tensorTy.getElementType(), targetEncoding);
+  return !isRegisterRenaming({srcTy}, newTy);
+}
+
+// Threads of the CTA a tensor of `type` is distributed over, 0 if its
+// encoding is not supported
+static unsigned getNumThreads(RankedTensorType type) {
+  Attribute layout = type.getEncoding();
+  if (!layout || !layout.isa<BlockedEncodingAttr, MmaEncodingAttr,
+                             MfmaEncodingAttr, SliceEncodingAttr>())
+    return 0;
+  if (auto slice = layout.dyn_cast<SliceEncodingAttr>())
+    if (slice.getParent().isa<SliceEncodingAttr>() ||
+        getOrder(slice.getParent()).size() != 2)
+      return 0;
+  return product<unsigned>(getThreadsPerWarp(layout)) *
+         product<unsigned>(getWarpsPerCTA(layout));
+}
+
+// Whether no two threads hold the same element of a tensor of `type`
+static bool holdsDistinctElements(RankedTensorType type) {
+  unsigned numThreads = getNumThreads(type);
+  return numThreads > 0 && getTotalElemsPerThread(type) * numThreads ==
+                               static_cast<unsigned>(type.getNumElements());
+}
+
+bool isRegisterRenaming(ArrayRef<RankedTensorType> srcTypes,
+                        RankedTensorType dstType) {
+  // The elements of the result a thread holds are then a permutation of the
+  // elements it holds of the operands
+  if (!holdsDistinctElements(dstType))
+    return false;
+  int64_t numel = 0;
+  for (RankedTensorType srcType : srcTypes)
+    numel += srcType.getNumElements();
+  if (numel != dstType.getNumElements())
+    return false;
+  unsigned numThreads = getNumThreads(dstType);
+  return llvm::all_of(srcTypes, [&](RankedTensorType srcType) {
+    return holdsDistinctElements(srcType) &&
+           getNumThreads(srcType) == numThreads;
+  });
+}
+
+Attribute getRenamingEncoding(RankedTensorType type,
+                              ArrayRef<int64_t> newShape) {
+  if (!holdsDistinctElements(type))
+    return {};
+  unsigned numThreads = getNumThreads(type);
+  unsigned threadsPerWarp = product<unsigned>(getThreadsPerWarp(
+      type.getEncoding()));
+  int64_t newNumel = product<int64_t>(newShape);
+  if (newNumel % numThreads != 0)
+    return {};
+  // Elements of a thread are contiguous along the fastest dimensions, the
+  // order of `type` when it is blocked with the same rank
+  unsigned rank = newShape.size();
+  SmallVector<unsigned> order;
+  auto blocked = type.getEncoding().dyn_cast<BlockedEncodingAttr>();
+  if (blocked && blocked.getOrder().size() == rank)
+    order.assign(blocked.getOrder().begin(), blocked.getOrder().end());
+  else
+    for (unsigned i = 0; i < rank; ++i)
+      order.push_back(rank - 1 - i);
+  SmallVector<unsigned> sizePerThread(rank, 1);
+  int64_t remaining = newNumel / numThreads;
+  for (unsigned d : order) {
+    int64_t size = std::min<int64_t>(remaining, newShape[d]);
+    if (remaining % size != 0)
+      return {};
+    sizePerThread[d] = size;
+    remaining /= size;
+  }
+  auto encoding = BlockedEncodingAttr::get(
+      type.getContext(), newShape, sizePerThread, order,
+      numThreads / threadsPerWarp, threadsPerWarp);
+  auto newType =
+      RankedTensorType::get(newShape, type.getElementType(), encoding);
+  if (!isRegisterRenaming({type}, newType))
+    return {};
+  return encoding;
 }
 
 } // namespace gpu
@@ -503,7 +644,8 @@ SmallVector<unsigned>
 MmaEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape, Type eltTy) const {
   size_t rank = shape.size();
   assert(rank == 2 && "Unexpected rank of mma layout");
-  assert((isVolta() || isAmpere()) && "Only version 1 and 2 is supported");
+  assert((isVolta() || isAmpere() || isHopper()) &&
+         "Only version 1, 2 and 3 are supported");
 
   SmallVector<unsigned> elemsPerThread(rank);
   if (isVolta()) {
@@ -521,7 +663,8 @@ MmaEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape, Type eltTy) const {
     unsigned resN = 2 * repN * std::max<int>(1, shape[1] / (spwN * wptN));
     elemsPerThread[0] = resM;
     elemsPerThread[1] = resN;
-  } else if (isAmpere()) {
+  } else if (isAmpere() || isHopper()) {
+    // The accumulator of MMAv3 is partitioned like that of MMAv2
     unsigned elemsRow = ceil<unsigned>(shape[0], 16 * getWarpsPerCTA()[0]) * 2;
     unsigned elemsCol = ceil<unsigned>(shape[1], 8 * getWarpsPerCTA()[1]) * 2;
     elemsPerThread[0] = elemsRow;
@@ -538,6 +681,19 @@ unsigned MmaEncodingAttr::getTotalElemsPerThread(ArrayRef<int64_t> shape,
   return product<unsigned>(getElemsPerThread(shape, eltTy));
 }
 
+SmallVector<unsigned>
+MfmaEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape, Type eltTy) const {
+  assert(shape.size() == 2 && "Unexpected rank of mfma layout");
+  // Each lane holds 16 rows of one column of every 32x32 tile
+  return {ceil<unsigned>(shape[0], 32 * getWarpsPerCTA()[0]) * 16,
+          ceil<unsigned>(shape[1], 32 * getWarpsPerCTA()[1])};
+}
+
+unsigned MfmaEncodingAttr::getTotalElemsPerThread(ArrayRef<int64_t> shape,
+                                                  Type eltTy) const {
+  return product<unsigned>(getElemsPerThread(shape, eltTy));
+}
+
 SmallVector<unsigned>
 SharedEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape,
                                       Type eltTy) const {
@@ -568,6 +724,31 @@ DotOperandEncodingAttr::getMMAv2Rep(ArrayRef<int64_t> shape,
   }
 }
 
+int DotOperandEncodingAttr::getMFMAKWidth(int bitwidth) {
+  assert((bitwidth == 16 || bitwidth == 32) && "Unexpected mfma operand type");
+  return bitwidth == 32 ? 1 : 4;
+}
+
+int DotOperandEncodingAttr::getMFMAOperandKWidth(int bitwidth) const {
+  if (unsigned kWidth = getMMAv2kWidth())
+    return kWidth;
+  return getMFMAKWidth(bitwidth);
+}
+
+SmallVector<int64_t>
+DotOperandEncodingAttr::getMFMARep(ArrayRef<int64_t> shape,
+                                   int bitwidth) const {
+  auto warpsPerCTA = getParent().cast<MfmaEncodingAttr>().getWarpsPerCTA();
+  // The two halves of a wavefront hold consecutive kWidth values of k
+  int64_t kPerInstr = 2 * getMFMAOperandKWidth(bitwidth);
+  if (getOpIdx() == 0)
+    return {std::max<int64_t>(1, shape[0] / (32 * warpsPerCTA[0])),
+            std::max<int64_t>(1, shape[1] / kPerInstr)};
+  assert(getOpIdx() == 1);
+  return {std::max<int64_t>(1, shape[0] / kPerInstr),
+          std::max<int64_t>(1, shape[1] / (32 * warpsPerCTA[1]))};
+}
+
 SmallVector<unsigned>
 DotOperandEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape,
                                           Type eltTy) const {
@@ -577,6 +758,11 @@ DotOperandEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape,
 
 unsigned DotOperandEncodingAttr::getTotalElemsPerThread(ArrayRef<int64_t> shape,
                                                         Type eltTy) const {
+  if (getParent().isa<MfmaEncodingAttr>()) {
+    int bitwidth = eltTy.getIntOrFloatBitWidth();
+    auto rep = getMFMARep(shape, bitwidth);
+    return rep[0] * rep[1] * getMFMAOperandKWidth(bitwidth);
+  }
   if (auto mmaParent = getParent().dyn_cast<MmaEncodingAttr>()) {
     int warpsPerCTAM = mmaParent.getWarpsPerCTA()[0];
     int warpsPerCTAN = mmaParent.getWarpsPerCTA()[1];
@@ -780,6 +966,44 @@ void MmaEncodingAttr::print(AsmPrinter &printer) const {
           << "}>";
 }
 
+//===----------------------------------------------------------------------===//
+// MFMA encoding
+//===----------------------------------------------------------------------===//
+
+Attribute MfmaEncodingAttr::parse(AsmParser &parser, Type type) {
+  if (parser.parseLess().failed())
+    return {};
+  DictionaryAttr dict;
+  if (parser.parseAttribute(dict).failed())
+    return {};
+  if (parser.parseGreater().failed())
+    return {};
+
+  unsigned versionMajor = 0;
+  SmallVector<unsigned, 2> warpsPerCTA;
+
+  for (const NamedAttribute &attr : dict) {
+    if (attr.getName() == "versionMajor") {
+      if (parseUInt(parser, attr, versionMajor, "versionMajor").failed())
+        return {};
+    }
+    if (attr.getName() == "warpsPerCTA") {
+      if (parseIntArrayAttr(parser, attr, warpsPerCTA, "warpsPerCTA").failed())
+        return {};
+    }
+  }
+
+  return parser.getChecked<MfmaEncodingAttr>(parser.getContext(), versionMajor,
+                                             warpsPerCTA);
+}
+
+void MfmaEncodingAttr::print(AsmPrinter &printer) const {
+  printer << "<{"
+          << "versionMajor = " << getVersionMajor() << ", "
+          << "warpsPerCTA = [" << getWarpsPerCTA() << "]"
+          << "}>";
+}
+
 //===----------------------------------------------------------------------===//
 // Sliced Encoding
 //===----------------------------------------------------------------------===//
@@ -862,6 +1086,8 @@ bool MmaEncodingAttr::isVolta() const { return getVersionMajor() == 1; }
 
 bool MmaEncodingAttr::isAmpere() const { return getVersionMajor() == 2; }
 
+bool MmaEncodingAttr::isHopper() const { return getVersionMajor() == 3; }
+
 // Get [isARow, isBRow, isAVec4, isBVec4, id] from versionMinor
 std::tuple<bool, bool, bool, bool, int>
 MmaEncodingAttr::decodeVoltaLayoutStates() const {
@@ -895,9 +1121,9 @@ Attribute DotOperandEncodingAttr::parse(AsmParser &parser, Type type) {
   unsigned kWidth = 0;
   Attribute _kWidth = attrs.get("kWidth");
   if (_kWidth) {
-    if (!mmaParent || mmaParent.isVolta()) {
+    if ((!mmaParent || mmaParent.isVolta()) && !parent.isa<MfmaEncodingAttr>()) {
       auto loc = parser.getNameLoc();
-      parser.emitError(loc, "kWidth only supported for MMAv2+ parent");
+      parser.emitError(loc, "kWidth only supported for MMAv2+ and MFMA parents");
       return Attribute();
     }
     kWidth = _kWidth.cast<IntegerAttr>().getInt();
@@ -910,7 +1136,8 @@ void DotOperandEncodingAttr::print(mlir::AsmPrinter &printer) const {
   auto mmaParent = getParent().dyn_cast<MmaEncodingAttr>();
   printer << "<{"
           << "opIdx = " << getOpIdx() << ", parent = " << getParent();
-  if (mmaParent && mmaParent.isAmpere())
+  if ((mmaParent && mmaParent.isAmpere()) ||
+      (getParent().isa<MfmaEncodingAttr>() && getMMAv2kWidth() != 0))
     printer << ", kWidth = " << getMMAv2kWidth();
   printer << "}>";
 }
@@ -1015,9 +1242,12 @@ ParseResult InsertSliceAsyncOp::parse(OpAsmParser &parser,
 void InsertSliceAsyncOp::print(OpAsmPrinter &printer) {
   printer << " ";
   printer << getOperation()->getOperands();
-  // "operand_segment_sizes" can be deduced, so we don't print it.
-  printer.printOptionalAttrDict(getOperation()->getAttrs(),
-                                {getOperandSegmentSizesAttrName()});
+  // "operand_segment_sizes" can be deduced, so we don't print it, nor the
+  // default L2 eviction policy.
+  SmallVector<StringRef, 2> elidedAttrs = {getOperandSegmentSizesAttrName()};
+  if (getL2Evict() == triton::EvictionPolicy::NORMAL)
+    elidedAttrs.push_back(getL2EvictAttrName());
+  printer.printOptionalAttrDict(getOperation()->getAttrs(), elidedAttrs);
   printer << " : ";
   printer.printStrippedAttrOrType(getSrc().getType());
   printer << " -> ";
@@ -1036,6 +1266,9 @@ public:
     if (auto mmaAttr = attr.dyn_cast<MmaEncodingAttr>()) {
       os << "mma";
       return AliasResult::FinalAlias;
+    } else if (auto mfmaAttr = attr.dyn_cast<MfmaEncodingAttr>()) {
+      os << "mfma";
+      return AliasResult::FinalAlias;
     } else if (auto sharedAttr = attr.dyn_cast<SharedEncodingAttr>()) {
       os << "shared";
       return AliasResult::FinalAlias;
@@ -1064,6 +1297,25 @@ struct TritonGPUInferLayoutInterface
 
   LogicalResult inferTransOpEncoding(Attribute operandEncoding,
                                      Attribute &resultEncoding) const override {
+    // Threads hold the same elements of a blocked tensor and of its
+    // transposition in the blocked encoding with swapped dimensions, in the
+    // same order, so that the transposition renames no register
+    if (auto blockedEncoding = operandEncoding.dyn_cast<BlockedEncodingAttr>()) {
+      if (blockedEncoding.getOrder().size() != 2)
+        return failure();
+      auto swap = [](ArrayRef<unsigned> dims) {
+        return SmallVector<unsigned>{dims[1], dims[0]};
+      };
+      SmallVector<unsigned> retOrder;
+      for (unsigned dim : blockedEncoding.getOrder())
+        retOrder.push_back(1 - dim);
+      resultEncoding = BlockedEncodingAttr::get(
+          getDialect()->getContext(),
+          swap(blockedEncoding.getSizePerThread()),
+          swap(blockedEncoding.getThreadsPerWarp()),
+          swap(blockedEncoding.getWarpsPerCTA()), retOrder);
+      return success();
+    }
     SharedEncodingAttr sharedEncoding =
         operandEncoding.dyn_cast<SharedEncodingAttr>();
     if (!sharedEncoding)
@@ -1149,6 +1401,10 @@ LogicalResult ConvertLayoutOp::canonicalize(ConvertLayoutOp op,
     return mlir::failure();
   // cvt(view) -> view
   if (auto view = dyn_cast<triton::ViewOp>(arg)) {
+    auto encoding =
+        op->getResult(0).getType().cast<RankedTensorType>().getEncoding();
+    if (isExpensiveView(view, encoding))
+      return mlir::failure();
     rewriter.replaceOpWithNewOp<triton::ViewOp>(op, op->getResult(0).getType(),
                                                 view.getResult());
     return mlir::success();
@@ -1192,7 +1448,7 @@ LogicalResult ConvertLayoutOp::canonicalize(ConvertLayoutOp op,
         insert_slice.getIndex(), insert_slice.getMask(),
         insert_slice.getOther(), insert_slice.getCache(),
         insert_slice.getEvict(), insert_slice.getIsVolatile(),
-        insert_slice.getAxis());
+        insert_slice.getAxis(), insert_slice.getL2Evict());
     return mlir::success();
   }
   // cvt(extract_slice(x), type2) -> extract_slice(cvt(x, type2))
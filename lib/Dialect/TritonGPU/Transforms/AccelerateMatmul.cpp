@@ -1,9 +1,11 @@
 #include "mlir/IR/TypeUtilities.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "triton/Analysis/RegisterPressure.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include <limits>
 #include <memory>
 
 using namespace mlir;
@@ -12,6 +14,7 @@ using triton::DotOp;
 using triton::gpu::BlockedEncodingAttr;
 using triton::gpu::ConvertLayoutOp;
 using triton::gpu::DotOperandEncodingAttr;
+using triton::gpu::MfmaEncodingAttr;
 using triton::gpu::MmaEncodingAttr;
 using triton::gpu::SliceEncodingAttr;
 
@@ -23,8 +26,7 @@ int computeCapabilityToMMAVersion(int computeCapability) {
   } else if (computeCapability < 90) {
     return 2;
   } else if (computeCapability < 100) {
-    // FIXME: temporarily add this to pass unis tests
-    return 2;
+    return 3;
   } else {
     assert(false && "computeCapability > 100 not supported");
     return 3;
@@ -42,17 +44,31 @@ SmallVector<int64_t, 2> mmaVersionToShapePerWarp(int version) {
   }
 }
 
-SmallVector<unsigned, 2> warpsPerTileV2(triton::DotOp dotOp,
-                                        const ArrayRef<int64_t> shape,
-                                        int numWarps) {
-  auto filter = [&dotOp](Operation *op) {
-    return op->getParentRegion() == dotOp->getParentRegion();
-  };
-  auto slices = mlir::getSlice(dotOp, {filter});
-  for (Operation *op : slices)
-    if (isa<triton::DotOp>(op) && (op != dotOp))
-      return {(unsigned)numWarps, 1};
+// Registers per thread of the accumulator and operands of `dotOp` with the
+// MMAv2 `warpsPerTile`
+unsigned getDotRegistersV2(triton::DotOp dotOp,
+                           ArrayRef<unsigned> warpsPerTile) {
+  auto ctx = dotOp.getContext();
+  auto mmaEnc = MmaEncodingAttr::get(ctx, 2, 0, warpsPerTile);
+  auto retType = dotOp.getResult().getType().cast<RankedTensorType>();
+  unsigned regs = RegisterPressureAnalysis::getNumRegisters(
+      RankedTensorType::get(retType.getShape(), retType.getElementType(),
+                            mmaEnc));
+  SmallVector<Value, 2> operands = {dotOp.getA(), dotOp.getB()};
+  for (auto en : llvm::enumerate(operands)) {
+    auto type = en.value().getType().cast<RankedTensorType>();
+    auto enc = DotOperandEncodingAttr::get(ctx, en.index(), mmaEnc,
+                                           type.getElementType());
+    regs += RegisterPressureAnalysis::getNumRegisters(
+        RankedTensorType::get(type.getShape(), type.getElementType(), enc));
+  }
+  return regs;
+}
 
+// The tiling of `numWarps` warps over a dot result of shape `shape`, in
+// m16n8 MMAv2 tiles, that balances the rows and columns of each warp
+SmallVector<unsigned, 2> balancedWarpsPerTileV2(const ArrayRef<int64_t> shape,
+                                                int numWarps) {
   SmallVector<unsigned, 2> ret = {1, 1};
   SmallVector<int64_t, 2> shapePerWarp = {16, 8};
   bool changed = false;
@@ -73,37 +89,356 @@ SmallVector<unsigned, 2> warpsPerTileV2(triton::DotOp dotOp,
   return ret;
 }
 
+// How the uses of the result of a dot, and the producer of its A operand,
+// constrain its MMAv2 tiling
+struct DotUsesV2 {
+  // The result is the A operand of another dot
+  bool feedsDotA = false;
+  // The A operand is the result of another dot
+  bool fromDot = false;
+  // The result is reduced along each axis
+  bool reduced[2] = {false, false};
+};
+
+DotUsesV2 getDotUsesV2(triton::DotOp dotOp) {
+  auto filter = [&dotOp](Operation *op) {
+    return op->getParentRegion() == dotOp->getParentRegion();
+  };
+  DotUsesV2 uses;
+  SetVector<Operation *> backward;
+  getBackwardSlice(dotOp.getA(), &backward, {filter});
+  uses.fromDot = llvm::any_of(
+      backward, [](Operation *op) { return isa<triton::DotOp>(op); });
+  SetVector<Operation *> forward;
+  getForwardSlice(dotOp.getResult(), &forward, {filter});
+  for (Operation *op : forward) {
+    if (auto reduce = dyn_cast<triton::ReduceOp>(op)) {
+      auto type = reduce.getOperands()[0].getType().cast<RankedTensorType>();
+      if (type.getRank() == 2)
+        uses.reduced[reduce.getAxis()] = true;
+    } else if (auto user = dyn_cast<triton::DotOp>(op)) {
+      SetVector<Operation *> operandSlice;
+      getBackwardSlice(user.getA(), &operandSlice, {filter});
+      if (user.getA().getDefiningOp() == dotOp ||
+          operandSlice.contains(dotOp))
+        uses.feedsDotA = true;
+    }
+  }
+  return uses;
+}
+
+// Cost, in bytes moved through shared and local memory, of tiling `dotOp`
+// with the MMAv2 `warpsPerTile`:
+//  - each warp loads the rows of A and the columns of B of its tile from
+//    shared memory. Every tiling issues as many MMAs, so the bytes of the
+//    dot rank them as the bytes per MMA would;
+//  - the registers over the budget spill, and are stored and reloaded once;
+//  - a result converts to the A operand of a chained dot in registers only
+//    with all the warps along M, and goes through shared memory otherwise;
+//  - reducing a result across warps exchanges partial results through
+//    shared memory.
+int64_t getWarpsPerTileCostV2(triton::DotOp dotOp,
+                              ArrayRef<unsigned> warpsPerTile,
+                              const DotUsesV2 &uses, unsigned budget) {
+  auto aType = dotOp.getA().getType().cast<RankedTensorType>();
+  auto bType = dotOp.getB().getType().cast<RankedTensorType>();
+  auto retType = dotOp.getResult().getType().cast<RankedTensorType>();
+  auto shape = retType.getShape();
+  int64_t K = aType.getShape()[1];
+  int64_t aBytes = aType.getElementType().getIntOrFloatBitWidth() / 8;
+  int64_t bBytes = bType.getElementType().getIntOrFloatBitWidth() / 8;
+  int64_t retBytes = retType.getElementType().getIntOrFloatBitWidth() / 8;
+  int64_t numWarps = warpsPerTile[0] * warpsPerTile[1];
+
+  int64_t cost = numWarps * K *
+                 (ceil<int64_t>(shape[0], warpsPerTile[0]) * aBytes +
+                  ceil<int64_t>(shape[1], warpsPerTile[1]) * bBytes);
+  unsigned regs = getDotRegistersV2(dotOp, warpsPerTile);
+  if (regs > budget)
+    cost += 2 * int64_t(regs - budget) * 4 * 32 * numWarps;
+  if (warpsPerTile[1] > 1) {
+    if (uses.feedsDotA)
+      cost += 2 * shape[0] * shape[1] * aBytes;
+    if (uses.fromDot)
+      cost += 2 * shape[0] * K * aBytes;
+  }
+  for (unsigned axis = 0; axis < 2; ++axis)
+    if (uses.reduced[axis] && warpsPerTile[axis] > 1)
+      cost += 2 * shape[1 - axis] * warpsPerTile[axis] * retBytes;
+  return cost;
+}
+
+// The cheapest tiling of `numWarps` warps over the m16n8 MMAv2 tiles of the
+// result of `dotOp`, ties going to the tiling with more warps along M
+SmallVector<unsigned, 2> warpsPerTileV2(triton::DotOp dotOp,
+                                        const ArrayRef<int64_t> shape,
+                                        int numWarps, unsigned budget) {
+  DotUsesV2 uses = getDotUsesV2(dotOp);
+  SmallVector<unsigned, 2> ret;
+  int64_t minCost = std::numeric_limits<int64_t>::max();
+  for (unsigned m = numWarps; m >= 1; m /= 2) {
+    SmallVector<unsigned, 2> candidate = {m, numWarps / m};
+    if (m > std::max<int64_t>(shape[0] / 16, 1) ||
+        candidate[1] > std::max<int64_t>(shape[1] / 8, 1))
+      continue;
+    int64_t cost = getWarpsPerTileCostV2(dotOp, candidate, uses, budget);
+    if (cost < minCost) {
+      minCost = cost;
+      ret = candidate;
+    }
+  }
+  if (ret.empty())
+    return balancedWarpsPerTileV2(shape, numWarps);
+  return ret;
+}
+
+// Order of the layout the operand `v` of a dot is converted from, which the
+// shared memory it is staged in keeps
+SmallVector<unsigned> getOperandOrder(Value v) {
+  SetVector<Operation *> slice;
+  auto isCvt = [](Operation *op) { return isa<ConvertLayoutOp>(op); };
+  getBackwardSlice(v, &slice, {isCvt});
+  Operation *op = slice.empty() ? v.getDefiningOp() : slice[0];
+  if (auto cvt = dyn_cast_or_null<ConvertLayoutOp>(op))
+    return triton::gpu::getOrder(
+        cvt.getOperand().getType().cast<RankedTensorType>().getEncoding());
+  return {1, 0};
+}
+
+// Whether wgmma reads shared memory rows of `rowBytes` bytes with a swizzle
+bool isMmaV3SwizzledRow(int64_t rowBytes) {
+  return rowBytes == 32 || rowBytes == 64 || rowBytes == 128;
+}
+
+// Whether `dotOp` runs on wgmma with `numWarps` warps: warpgroups of four
+// warps tile the fp32 result in 64-row steps, and the tensor cores read the
+// operands in the shared memory layout of their loads, which must have K
+// contiguous for A, and K or, for 16-bit types, N contiguous for B
+bool supportMMAv3(triton::DotOp dotOp, int numWarps) {
+  if (!supportMMA(dotOp, 3) || numWarps % 4 != 0)
+    return false;
+  auto retType = dotOp.getResult().getType().cast<RankedTensorType>();
+  if (!retType.getElementType().isF32())
+    return false;
+  auto aType = dotOp.getA().getType().cast<RankedTensorType>();
+  auto bType = dotOp.getB().getType().cast<RankedTensorType>();
+  auto retShape = retType.getShape();
+  if (retShape[0] % (16 * numWarps) != 0 || retShape[1] % 8 != 0)
+    return false;
+  int64_t elemBytes = aType.getElementType().getIntOrFloatBitWidth() / 8;
+  if (getOperandOrder(dotOp.getA())[0] != 1 ||
+      !isMmaV3SwizzledRow(aType.getShape()[1] * elemBytes))
+    return false;
+  if (getOperandOrder(dotOp.getB())[0] == 0)
+    return isMmaV3SwizzledRow(bType.getShape()[0] * elemBytes);
+  return elemBytes == 2 && isMmaV3SwizzledRow(bType.getShape()[1] * elemBytes);
+}
+
+// Dots with at most this many rows, as in batch-1 decode, are candidates for
+// the reduction lowering of SkinnyDotToReduce
+constexpr int64_t kMaxSkinnyM = 16;
+
+// Rough per-thread costs, in issue slots, of the two lowerings of a skinny dot
+constexpr int64_t kBarrierCost = 32;
+constexpr int64_t kMmaCost = 16;
+constexpr int64_t kShuffleCost = 2;
+
+// The 3d layout of the M x K x N products of a skinny dot: lanes go along N
+// then K, so that the reduction over K stays within warps, and warps along M
+// then N
+BlockedEncodingAttr getSkinnyDotLayout(MLIRContext *ctx, int64_t M, int64_t K,
+                                       int64_t N, unsigned numWarps) {
+  unsigned tN = std::min<int64_t>(N, 32);
+  unsigned tK = std::min<int64_t>(K, 32 / tN);
+  unsigned tM = 32 / tN / tK;
+  unsigned wM = std::clamp<int64_t>(M / tM, 1, numWarps);
+  unsigned wN = std::clamp<int64_t>(N / tN, 1, numWarps / wM);
+  unsigned wK = numWarps / wM / wN;
+  return BlockedEncodingAttr::get(ctx, {1, 1, 1}, {tM, tK, tN}, {wM, wK, wN},
+                                  {2, 1, 0});
+}
+
+// Whether `dotOp` is cheaper as a broadcast multiply reduced over K in
+// `layout` than on tensor cores, whose operands are staged through shared
+// memory behind two barriers. The products must also fit in half of the
+// register budget.
+bool preferSkinnyDotReduce(triton::DotOp dotOp, BlockedEncodingAttr layout,
+                           unsigned numWarps, unsigned budget) {
+  auto aType = dotOp.getA().getType().cast<RankedTensorType>();
+  auto retType = dotOp.getResult().getType().cast<RankedTensorType>();
+  int64_t M = aType.getShape()[0];
+  int64_t K = aType.getShape()[1];
+  int64_t N = retType.getShape()[1];
+  int64_t threads = 32 * numWarps;
+  auto prodType =
+      RankedTensorType::get({M, K, N}, retType.getElementType(), layout);
+  if (RegisterPressureAnalysis::getNumRegisters(prodType) > budget / 2)
+    return false;
+
+  int64_t elemBytes = aType.getElementType().getIntOrFloatBitWidth() / 8;
+  int64_t sharedCost = ceil<int64_t>(2 * (M * K + K * N) * elemBytes,
+                                     16 * threads) +
+                       2 * kBarrierCost;
+  int64_t numMma = ceil<int64_t>(M, 16) * ceil<int64_t>(N, 8) *
+                   ceil<int64_t>(K * elemBytes, 32);
+  int64_t mmaCost = sharedCost + ceil<int64_t>(numMma, numWarps) * kMmaCost;
+
+  unsigned kLanes = layout.getThreadsPerWarp()[1];
+  unsigned kWarps = layout.getWarpsPerCTA()[1];
+  int64_t reduceCost = ceil<int64_t>(M * K * N, threads) +
+                       ceil<int64_t>(M * N * kLanes * kWarps, threads) *
+                           llvm::Log2_32(kLanes) * kShuffleCost;
+  if (kWarps > 1)
+    reduceCost += 2 * kBarrierCost;
+  return reduceCost < mmaCost;
+}
+
+// Lowers skinny dots, which would waste most of a tensor core tile, as a
+// multiply of the operands broadcast to M x K x N and a reduction over K
+// across lanes. The operands are converted from their blocked layouts
+// without going through shared memory, so that loads can be rematerialized
+// in the layout of the products.
+class SkinnyDotToReduce : public mlir::RewritePattern {
+  int computeCapability;
+
+public:
+  SkinnyDotToReduce(mlir::MLIRContext *context, int computeCapability)
+      : mlir::RewritePattern(triton::DotOp::getOperationName(), 3, context),
+        computeCapability(computeCapability) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(mlir::Operation *op,
+                  mlir::PatternRewriter &rewriter) const override {
+    auto dotOp = cast<triton::DotOp>(op);
+    auto retType = dotOp.getResult().getType().cast<RankedTensorType>();
+    if (!retType.getEncoding() ||
+        !retType.getEncoding().isa<BlockedEncodingAttr>())
+      return failure();
+    if (computeCapability < 70 || !supportMMA(dotOp, 2))
+      return failure();
+    auto aCvt = dotOp.getA().getDefiningOp<ConvertLayoutOp>();
+    auto bCvt = dotOp.getB().getDefiningOp<ConvertLayoutOp>();
+    if (!aCvt || !bCvt)
+      return failure();
+    auto aType = aCvt.getOperand().getType().cast<RankedTensorType>();
+    auto bType = bCvt.getOperand().getType().cast<RankedTensorType>();
+    if (!aType.getEncoding().isa<BlockedEncodingAttr>() ||
+        !bType.getEncoding().isa<BlockedEncodingAttr>())
+      return failure();
+    int64_t M = aType.getShape()[0];
+    int64_t K = aType.getShape()[1];
+    int64_t N = bType.getShape()[1];
+    if (M > kMaxSkinnyM)
+      return failure();
+    // fp8 operands are not extended outside of the tensor cores
+    if (isNativeFp8(aType.getElementType()))
+      return failure();
+
+    auto ctx = op->getContext();
+    auto mod = op->getParentOfType<mlir::ModuleOp>();
+    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+    auto layout = getSkinnyDotLayout(ctx, M, K, N, numWarps);
+    unsigned budget = RegisterPressureAnalysis::getRegisterBudget(mod);
+    if (!preferSkinnyDotReduce(dotOp, layout, numWarps, budget))
+      return failure();
+
+    // extend the operands to the accumulator type, in the slices of the
+    // products they are broadcast from
+    Location loc = dotOp.getLoc();
+    Type accElemTy = retType.getElementType();
+    auto convertOperand = [&](Value v, unsigned dim) -> Value {
+      auto type = v.getType().cast<RankedTensorType>();
+      auto sliceType = RankedTensorType::get(
+          type.getShape(), type.getElementType(),
+          SliceEncodingAttr::get(ctx, dim, layout));
+      v = rewriter.create<ConvertLayoutOp>(loc, sliceType, v);
+      auto extType = RankedTensorType::get(type.getShape(), accElemTy,
+                                           sliceType.getEncoding());
+      if (type.getElementType() == accElemTy)
+        return v;
+      if (accElemTy.isa<FloatType>())
+        return rewriter.create<arith::ExtFOp>(loc, extType, v);
+      return rewriter.create<arith::ExtSIOp>(loc, extType, v);
+    };
+    auto prodType = RankedTensorType::get({M, K, N}, accElemTy, layout);
+    Value a = rewriter.create<triton::ExpandDimsOp>(
+        loc, convertOperand(aCvt.getOperand(), 2), 2);
+    a = rewriter.create<triton::BroadcastOp>(loc, prodType, a);
+    Value b = rewriter.create<triton::ExpandDimsOp>(
+        loc, convertOperand(bCvt.getOperand(), 0), 0);
+    b = rewriter.create<triton::BroadcastOp>(loc, prodType, b);
+    bool isFloat = accElemTy.isa<FloatType>();
+    Value prod =
+        isFloat ? rewriter.create<arith::MulFOp>(loc, a, b).getResult()
+                : rewriter.create<arith::MulIOp>(loc, a, b).getResult();
+
+    auto reduce =
+        rewriter.create<triton::ReduceOp>(loc, ValueRange{prod}, /*axis=*/1);
+    {
+      OpBuilder::InsertionGuard guard(rewriter);
+      Block *combine = rewriter.createBlock(
+          &reduce.getCombineOp(), {}, {accElemTy, accElemTy}, {loc, loc});
+      Value lhs = combine->getArgument(0);
+      Value rhs = combine->getArgument(1);
+      Value sum =
+          isFloat ? rewriter.create<arith::AddFOp>(loc, lhs, rhs).getResult()
+                  : rewriter.create<arith::AddIOp>(loc, lhs, rhs).getResult();
+      rewriter.create<triton::ReduceReturnOp>(loc, sum);
+    }
+    Value sum = rewriter.create<ConvertLayoutOp>(loc, retType,
+                                                 reduce.getResult()[0]);
+    Value acc = dotOp.getC();
+    Value ret = isFloat
+                    ? rewriter.create<arith::AddFOp>(loc, sum, acc).getResult()
+                    : rewriter.create<arith::AddIOp>(loc, sum, acc).getResult();
+    rewriter.replaceOp(op, ret);
+    return success();
+  }
+};
+
 class BlockedToMMA : public mlir::RewritePattern {
   int computeCapability;
+  int ptxVersion;
   mutable int mmaV1Counter{}; // used to generate ID for MMAv1 encoding
 
   static bool bwdFilter(Operation *op) {
-    return op->getNumOperands() == 1 &&
+    return op->getNumOperands() >= 1 &&
            (isa<triton::FpToFpOp, triton::BitcastOp,
                 triton::gpu::ConvertLayoutOp>(op) ||
             op->getDialect()->getTypeID() ==
                 mlir::TypeID::get<arith::ArithDialect>());
   }
 
-  // finds the first different value bitwidth in the chain of
-  // shape-preserving unary ops  that x depends on
+  // finds the narrowest value bitwidth at the sources of the tree of
+  // shape-preserving elementwise ops that x depends on, e.g. the packed
+  // weights of a dequantization chain
   static int computeOrigBitWidth(Value x) {
     int finalBitWidth = getElementTypeOrSelf(x).getIntOrFloatBitWidth();
-    int origBitWidth = finalBitWidth;
     SetVector<Operation *> slice;
     mlir::getBackwardSlice(x, &slice, bwdFilter);
-    Operation *firstOp = slice.empty() ? nullptr : *slice.begin();
-    if (firstOp)
-      if (Value arg = firstOp->getOperand(0))
-        if (RankedTensorType argTy = arg.getType().dyn_cast<RankedTensorType>())
-          origBitWidth = argTy.getElementType().getIntOrFloatBitWidth();
-    return origBitWidth;
+    if (slice.empty())
+      return finalBitWidth;
+    int origBitWidth = 0;
+    for (Operation *op : slice)
+      for (Value arg : op->getOperands()) {
+        if (arg.getDefiningOp() && slice.contains(arg.getDefiningOp()))
+          continue;
+        auto argTy = arg.getType().dyn_cast<RankedTensorType>();
+        if (!argTy || !argTy.getElementType().isIntOrFloat())
+          continue;
+        int bitWidth = argTy.getElementType().getIntOrFloatBitWidth();
+        // predicates are not part of the data fed to the dot
+        if (bitWidth >= 8 && (!origBitWidth || bitWidth < origBitWidth))
+          origBitWidth = bitWidth;
+      }
+    return origBitWidth ? origBitWidth : finalBitWidth;
   }
 
 public:
-  BlockedToMMA(mlir::MLIRContext *context, int computeCapability)
+  BlockedToMMA(mlir::MLIRContext *context, int computeCapability,
+               int ptxVersion)
       : mlir::RewritePattern(triton::DotOp::getOperationName(), 2, context),
-        computeCapability(computeCapability) {}
+        computeCapability(computeCapability), ptxVersion(ptxVersion) {}
 
   mlir::LogicalResult
   matchAndRewrite(mlir::Operation *op,
@@ -120,13 +455,21 @@ public:
 
     // for FMA, should retain the blocked layout.
     int versionMajor = computeCapabilityToMMAVersion(computeCapability);
+    auto mod = op->getParentOfType<mlir::ModuleOp>();
+    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+    // the dots wgmma cannot run fall back to mma.sync on Hopper
+    if (versionMajor == 3 && !supportMMAv3(dotOp, numWarps))
+      versionMajor = 2;
     if (!supportMMA(dotOp, versionMajor))
       return failure();
+    // fp8 operands stay 8-bit up to the tensor cores, from sm_89 and with
+    // the e4m3/e5m2 forms of mma.sync that PTX ISA 8.4 introduced
+    if (isNativeFp8(getElementTypeOrSelf(dotOp.getA())) &&
+        (computeCapability < 89 || ptxVersion < 84))
+      return failure();
 
     // get MMA encoding for the given number of warps
     auto retShape = oldRetType.getShape();
-    auto mod = op->getParentOfType<mlir::ModuleOp>();
-    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
 
     // operands
     Value a = dotOp.getA();
@@ -167,12 +510,19 @@ public:
           oldRetType.getContext(), versionMajor, numWarps, oldAType.getShape(),
           oldBType.getShape(), retShape, isARow, isBRow, mmaV1Counter++);
     } else if (versionMajor == 2) {
-      auto warpsPerTile = warpsPerTileV2(dotOp, retShape, numWarps);
+      auto warpsPerTile =
+          warpsPerTileV2(dotOp, retShape, numWarps,
+                         RegisterPressureAnalysis::getRegisterBudget(mod));
       mmaEnc = triton::gpu::MmaEncodingAttr::get(
           oldRetType.getContext(), versionMajor, 0 /*versionMinor*/,
           warpsPerTile);
+    } else if (versionMajor == 3) {
+      // every warp holds 16 rows of the 64-row tiles of its warpgroup
+      mmaEnc = triton::gpu::MmaEncodingAttr::get(
+          oldRetType.getContext(), versionMajor, 0 /*versionMinor*/,
+          SmallVector<unsigned, 2>{(unsigned)numWarps, 1});
     } else {
-      llvm_unreachable("Mma layout only supports versionMajor in {1, 2}");
+      llvm_unreachable("Mma layout only supports versionMajor in {1, 2, 3}");
     }
     auto newRetType =
         RankedTensorType::get(retShape, oldRetType.getElementType(), mmaEnc);
@@ -206,6 +556,139 @@ public:
     return success();
   }
 };
+
+// Maps sparse dots to MMAv2, whose mma.sp instructions read the operands as
+// dense ones and the metadata of A from shared memory
+class SparseBlockedToMMA : public mlir::RewritePattern {
+  int computeCapability;
+
+public:
+  SparseBlockedToMMA(mlir::MLIRContext *context, int computeCapability)
+      : mlir::RewritePattern(triton::SparseDotOp::getOperationName(), 2,
+                             context),
+        computeCapability(computeCapability) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(mlir::Operation *op,
+                  mlir::PatternRewriter &rewriter) const override {
+    if (computeCapability < 80)
+      return failure();
+    auto dotOp = cast<triton::SparseDotOp>(op);
+    auto ctx = op->getContext();
+    auto oldRetType = dotOp.getResult().getType().cast<RankedTensorType>();
+    if (!oldRetType.getEncoding() ||
+        oldRetType.getEncoding().isa<triton::gpu::MmaEncodingAttr>())
+      return failure();
+    auto aElemTy = getElementTypeOrSelf(dotOp.getA());
+    if (!(aElemTy.isF16() || aElemTy.isBF16()) ||
+        !oldRetType.getElementType().isF32())
+      return failure();
+
+    auto mod = op->getParentOfType<mlir::ModuleOp>();
+    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+    auto retShape = oldRetType.getShape();
+    auto mmaEnc = triton::gpu::MmaEncodingAttr::get(
+        ctx, 2, 0 /*versionMinor*/,
+        balancedWarpsPerTileV2(retShape, numWarps));
+    auto newRetType =
+        RankedTensorType::get(retShape, oldRetType.getElementType(), mmaEnc);
+    auto convertTo = [&](Value v, Attribute encoding) -> Value {
+      auto type = v.getType().cast<RankedTensorType>();
+      auto newType = RankedTensorType::get(type.getShape(),
+                                           type.getElementType(), encoding);
+      return rewriter.create<ConvertLayoutOp>(v.getLoc(), newType, v);
+    };
+    Value acc = convertTo(dotOp.getC(), mmaEnc);
+    Value a = convertTo(dotOp.getA(),
+                        DotOperandEncodingAttr::get(ctx, 0, mmaEnc, aElemTy));
+    Value b = convertTo(dotOp.getB(),
+                        DotOperandEncodingAttr::get(ctx, 1, mmaEnc, aElemTy));
+    SmallVector<unsigned> metaOrder = {1, 0};
+    Value meta = convertTo(
+        dotOp.getAMeta(),
+        triton::gpu::SharedEncodingAttr::get(ctx, 1, 1, 1, metaOrder));
+    auto newDot = rewriter.create<triton::SparseDotOp>(
+        dotOp.getLoc(), newRetType, a, b, acc, meta);
+    rewriter.replaceOpWithNewOp<ConvertLayoutOp>(op, oldRetType,
+                                                 newDot.getResult());
+    return success();
+  }
+};
+
+// The tiling of `numWarps` warps over a dot result of shape `shape`, in the
+// 32x32 tiles of the mfma instructions, that balances the rows and columns of
+// each warp
+SmallVector<unsigned, 2> warpsPerTileMFMA(const ArrayRef<int64_t> shape,
+                                          int numWarps) {
+  SmallVector<unsigned, 2> ret = {1, 1};
+  while (ret[0] * ret[1] < numWarps) {
+    if (shape[0] / 32 / ret[0] >= shape[1] / 32 / ret[1] &&
+        ret[0] < shape[0] / 32)
+      ret[0] *= 2;
+    else
+      ret[1] *= 2;
+  }
+  return ret;
+}
+
+// Maps dots to the matrix cores of AMD GPUs, with the 32x32 mfma
+// instructions of f16, bf16 and f32 operands accumulating in f32. The
+// operands are read from shared memory without swizzling.
+class BlockedToMFMA : public mlir::RewritePattern {
+  int mfmaVersion;
+
+public:
+  BlockedToMFMA(mlir::MLIRContext *context, int mfmaVersion)
+      : mlir::RewritePattern(triton::DotOp::getOperationName(), 2, context),
+        mfmaVersion(mfmaVersion) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(mlir::Operation *op,
+                  mlir::PatternRewriter &rewriter) const override {
+    if (mfmaVersion == 0)
+      return failure();
+    auto dotOp = cast<triton::DotOp>(op);
+    auto ctx = op->getContext();
+    auto oldRetType = dotOp.getResult().getType().cast<RankedTensorType>();
+    if (!oldRetType.getEncoding() ||
+        !oldRetType.getEncoding().isa<BlockedEncodingAttr>() ||
+        !oldRetType.getElementType().isF32())
+      return failure();
+    auto aElemTy = getElementTypeOrSelf(dotOp.getA());
+    if (aElemTy != getElementTypeOrSelf(dotOp.getB()) ||
+        !(aElemTy.isF16() || aElemTy.isBF16() || aElemTy.isF32()))
+      return failure();
+    auto retShape = oldRetType.getShape();
+    int64_t K = dotOp.getA().getType().cast<RankedTensorType>().getShape()[1];
+    int64_t kPerInstr = 2 * DotOperandEncodingAttr::getMFMAKWidth(
+                                aElemTy.getIntOrFloatBitWidth());
+    if (retShape[0] % 32 != 0 || retShape[1] % 32 != 0 || K % kPerInstr != 0)
+      return failure();
+
+    auto mod = op->getParentOfType<mlir::ModuleOp>();
+    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+    auto mfmaEnc = MfmaEncodingAttr::get(
+        ctx, mfmaVersion, warpsPerTileMFMA(retShape, numWarps));
+    auto newRetType =
+        RankedTensorType::get(retShape, oldRetType.getElementType(), mfmaEnc);
+    auto convertTo = [&](Value v, Attribute encoding) -> Value {
+      auto type = v.getType().cast<RankedTensorType>();
+      auto newType = RankedTensorType::get(type.getShape(),
+                                           type.getElementType(), encoding);
+      return rewriter.create<ConvertLayoutOp>(v.getLoc(), newType, v);
+    };
+    Value acc = convertTo(dotOp.getC(), mfmaEnc);
+    Value a = convertTo(dotOp.getA(),
+                        DotOperandEncodingAttr::get(ctx, 0, mfmaEnc, aElemTy));
+    Value b = convertTo(dotOp.getB(),
+                        DotOperandEncodingAttr::get(ctx, 1, mfmaEnc, aElemTy));
+    auto newDot = rewriter.create<triton::DotOp>(dotOp.getLoc(), newRetType, a,
+                                                 b, acc, dotOp.getAllowTF32());
+    rewriter.replaceOpWithNewOp<ConvertLayoutOp>(op, oldRetType,
+                                                 newDot.getResult());
+    return success();
+  }
+};
 } // namespace
 
 #define GEN_PASS_CLASSES
@@ -215,15 +698,21 @@ class TritonGPUAccelerateMatmulPass
     : public TritonGPUAccelerateMatmulBase<TritonGPUAccelerateMatmulPass> {
 public:
   TritonGPUAccelerateMatmulPass() = default;
-  TritonGPUAccelerateMatmulPass(int computeCapability) {
+  TritonGPUAccelerateMatmulPass(int computeCapability, int mfmaVersion,
+                                int ptxVersion) {
     this->computeCapability = computeCapability;
+    this->mfmaVersion = mfmaVersion;
+    this->ptxVersion = ptxVersion;
   }
   void runOnOperation() override {
     MLIRContext *context = &getContext();
     ModuleOp m = getOperation();
 
     mlir::RewritePatternSet patterns(context);
-    patterns.add<::BlockedToMMA>(context, computeCapability);
+    patterns.add<::SkinnyDotToReduce>(context, computeCapability);
+    patterns.add<::BlockedToMMA>(context, computeCapability, ptxVersion);
+    patterns.add<::SparseBlockedToMMA>(context, computeCapability);
+    patterns.add<::BlockedToMFMA>(context, mfmaVersion);
     if (applyPatternsAndFoldGreedily(m, std::move(patterns)).failed()) {
       signalPassFailure();
     }
@@ -231,6 +720,8 @@ public:
 };
 
 std::unique_ptr<Pass>
-mlir::createTritonGPUAccelerateMatmulPass(int computeCapability) {
-  return std::make_unique<TritonGPUAccelerateMatmulPass>(computeCapability);
+mlir::createTritonGPUAccelerateMatmulPass(int computeCapability,
+                                          int mfmaVersion, int ptxVersion) {
+  return std::make_unique<TritonGPUAccelerateMatmulPass>(
+      computeCapability, mfmaVersion, ptxVersion);
 }
@@ -0,0 +1,496 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/Utility.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+//===----------------------------------------------------------------------===//
+// This file assigns the layouts of the tensors of each function at once,
+// rather than removing conversions one pattern at a time.
+//
+// Tensors that must share a layout form a web: the operands and result of an
+// op that can be computed in any layout (element-wise ops, splat, make_range,
+// splat constants), and the init value, region argument, yielded value and
+// result of each loop-carried value of scf.for (or of each result of scf.if).
+// Webs are bounded by conversions, and by the ops that need their own layout
+// (loads, stores, dots, reductions, ...), whose results and operands keep it:
+//
+//   %x = tt.load ...                  : #blocked   (anchored definition)
+//   scf.for ... iter_args(%acc = %c)  : #blocked   ({%c, %acc, %y, %r})
+//     %a = convert_layout %acc        : #mma       (conversion edge)
+//     %d = tt.dot ..., %a             : #mma       (anchored use)
+//     %y = convert_layout %d          : #blocked   (conversion edge)
+//   tt.store ..., %r                  : #blocked   (anchored use)
+//
+// Moving a web to another layout changes the cost of the conversions at its
+// boundary, which are either existing conversions or the ones it takes for
+// its anchors to keep their layout. It also changes the cost of computing its
+// ops, one instruction per element of each thread. Conversions go through
+// shared memory, between two barriers. Costs are weighted by the trip counts
+// of the loops around them, and the layouts of all webs are chosen to
+// minimize the total cost, starting from the current ones and moving one web
+// at a time to the layout of one of its neighbors until no move lowers it.
+//
+// The greedy patterns of tritongpu-remove-layout-conversions, which also
+// rematerialize the ops anchoring webs, still run after this pass.
+//===----------------------------------------------------------------------===//
+
+using namespace mlir;
+namespace ttg = triton::gpu;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+// Costs are in bytes moved through shared memory by each thread, computing an
+// element weighing as much as moving a byte
+constexpr int64_t kBarrierCost = 64;
+// Trip count assumed for the loops whose bounds are not constants
+constexpr int64_t kDefaultTripCount = 16;
+// Weight of the ops in deeper loop nests, which keeps costs within int64
+constexpr int64_t kMaxWeight = int64_t(1) << 24;
+constexpr int kMaxNumSweeps = 8;
+
+bool isDistributedTensor(Type type) {
+  auto tensorType = type.dyn_cast<RankedTensorType>();
+  if (!tensorType || !tensorType.getEncoding())
+    return false;
+  return tensorType.getEncoding()
+      .isa<ttg::BlockedEncodingAttr, ttg::MmaEncodingAttr,
+           ttg::SliceEncodingAttr>();
+}
+
+RankedTensorType getTypeWithEncoding(Type type, Attribute encoding) {
+  auto tensorType = type.cast<RankedTensorType>();
+  return RankedTensorType::get(tensorType.getShape(),
+                               tensorType.getElementType(), encoding);
+}
+
+/// Ops computed in the layout of their tensor operands and result, whichever
+/// it is
+bool isLayoutFlexible(Operation *op) {
+  if (op->getNumRegions() != 0 || op->getNumResults() != 1 ||
+      !isMemoryEffectFree(op) || isa<ttg::ConvertLayoutOp>(op))
+    return false;
+  Type resultType = op->getResult(0).getType();
+  if (!isDistributedTensor(resultType))
+    return false;
+  if (auto cst = dyn_cast<arith::ConstantOp>(op))
+    return cst.getValue().isa<SplatElementsAttr>();
+  if (isa<triton::MakeRangeOp>(op))
+    return true;
+  if (!op->hasTrait<OpTrait::Elementwise>() &&
+      !op->hasTrait<OpTrait::SameOperandsAndResultEncoding>())
+    return false;
+  auto shape = resultType.cast<RankedTensorType>().getShape();
+  return llvm::all_of(op->getOperandTypes(), [&](Type type) {
+    auto tensorType = type.dyn_cast<RankedTensorType>();
+    return !tensorType ||
+           (isDistributedTensor(type) && tensorType.getShape() == shape);
+  });
+}
+
+/// Whether `value` takes the layout of its web with its definition, rather
+/// than through a conversion of it
+bool isFlexibleDef(Value value) {
+  if (auto arg = value.dyn_cast<BlockArgument>())
+    return isa<scf::ForOp>(arg.getOwner()->getParentOp());
+  Operation *def = value.getDefiningOp();
+  return isLayoutFlexible(def) ||
+         isa<scf::ForOp, scf::IfOp, ttg::ConvertLayoutOp>(def);
+}
+
+/// Whether `use` takes the layout of the web of its value
+bool isFlexibleUse(OpOperand &use) {
+  Operation *user = use.getOwner();
+  if (isLayoutFlexible(user))
+    return true;
+  if (auto forOp = dyn_cast<scf::ForOp>(user))
+    return use.getOperandNumber() >= forOp.getNumControlOperands();
+  if (isa<scf::YieldOp>(user))
+    return isa<scf::ForOp, scf::IfOp>(user->getParentOp());
+  return false;
+}
+
+/// Estimated number of executions of the ops of `block` per execution of
+/// their function
+int64_t getWeight(Block *block) {
+  int64_t weight = 1;
+  for (Operation *parent = block->getParentOp();
+       parent && !isa<triton::FuncOp>(parent);
+       parent = parent->getParentOp()) {
+    int64_t tripCount = 1;
+    if (auto forOp = dyn_cast<scf::ForOp>(parent)) {
+      tripCount = kDefaultTripCount;
+      auto lb = getConstantIntValue(forOp.getLowerBound());
+      auto ub = getConstantIntValue(forOp.getUpperBound());
+      auto step = getConstantIntValue(forOp.getStep());
+      if (lb && ub && step && *step > 0)
+        tripCount = std::max<int64_t>(*ub > *lb ? (*ub - *lb - 1) / *step + 1
+                                                : 0,
+                                      1);
+    } else if (isa<scf::WhileOp>(parent)) {
+      tripCount = kDefaultTripCount;
+    }
+    weight = std::min(weight * std::min(tripCount, kMaxWeight), kMaxWeight);
+  }
+  return weight;
+}
+
+int64_t getWeight(Operation *op) { return getWeight(op->getBlock()); }
+
+class LayoutAssignment {
+  /// A conversion between two webs, or between a web and a fixed layout
+  struct Edge {
+    /// Webs of the source and result, -1 for fixed layouts
+    int src;
+    int dst;
+    Attribute srcEncoding;
+    Attribute dstEncoding;
+    /// Type of the source, for its shape and element type
+    RankedTensorType type;
+    int64_t weight;
+  };
+
+  struct Web {
+    SmallVector<unsigned> values;
+    /// Layouts the web may take: its own, and those of its neighbors
+    SetVector<Attribute> candidates;
+    SmallVector<unsigned> edges;
+    /// Results of the ops of the web, along with their weights
+    SmallVector<std::pair<Type, int64_t>> computations;
+    bool fixed = false;
+  };
+
+  triton::FuncOp funcOp;
+  int numThreads;
+
+  SmallVector<Value> values;
+  DenseMap<Value, unsigned> valueIds;
+  /// Union-find forest of the values
+  SmallVector<unsigned> parents;
+  SmallVector<unsigned> webIds;
+
+  SmallVector<Web> webs;
+  SmallVector<Edge> edges;
+  SmallVector<Attribute> encodings;
+
+  void addValue(Value value);
+  unsigned find(unsigned id);
+  void unite(Value lhs, Value rhs);
+  /// Web of `value`, -1 if its layout is not assigned
+  int getWeb(Value value);
+  void addEdge(int src, int dst, Value srcValue, Attribute dstEncoding,
+               int64_t weight);
+
+  void buildWebs();
+  void buildEdges();
+
+  int64_t getConversionCost(RankedTensorType type, Attribute dstEncoding);
+  int64_t getEdgeCost(const Edge &edge);
+  /// Cost of the edges and the computations of web `w`
+  int64_t getWebCost(unsigned w);
+  /// Move webs to the layouts of their neighbors while that lowers the cost
+  bool solve();
+  void rewriteWeb(unsigned w);
+
+public:
+  LayoutAssignment(triton::FuncOp funcOp, int numThreads)
+      : funcOp(funcOp), numThreads(numThreads) {}
+
+  /// Returns whether the layout of any web changed
+  bool run();
+};
+
+void LayoutAssignment::addValue(Value value) {
+  if (!isDistributedTensor(value.getType()))
+    return;
+  valueIds[value] = values.size();
+  parents.push_back(values.size());
+  values.push_back(value);
+}
+
+unsigned LayoutAssignment::find(unsigned id) {
+  while (parents[id] != id) {
+    parents[id] = parents[parents[id]];
+    id = parents[id];
+  }
+  return id;
+}
+
+void LayoutAssignment::unite(Value lhs, Value rhs) {
+  auto lhsIt = valueIds.find(lhs);
+  auto rhsIt = valueIds.find(rhs);
+  if (lhsIt == valueIds.end() || rhsIt == valueIds.end())
+    return;
+  parents[find(lhsIt->second)] = find(rhsIt->second);
+}
+
+int LayoutAssignment::getWeb(Value value) {
+  auto it = valueIds.find(value);
+  return it == valueIds.end() ? -1 : int(webIds[it->second]);
+}
+
+void LayoutAssignment::addEdge(int src, int dst, Value srcValue,
+                               Attribute dstEncoding, int64_t weight) {
+  auto type = srcValue.getType().cast<RankedTensorType>();
+  unsigned id = edges.size();
+  edges.push_back({src, dst, type.getEncoding(), dstEncoding, type, weight});
+  if (src >= 0)
+    webs[src].edges.push_back(id);
+  if (dst >= 0 && dst != src)
+    webs[dst].edges.push_back(id);
+}
+
+void LayoutAssignment::buildWebs() {
+  funcOp.walk([&](Operation *op) {
+    for (Region &region : op->getRegions())
+      for (Block &block : region)
+        for (BlockArgument arg : block.getArguments())
+          addValue(arg);
+    for (Value result : op->getResults())
+      addValue(result);
+  });
+
+  funcOp.walk([&](Operation *op) {
+    if (isLayoutFlexible(op)) {
+      for (Value operand : op->getOperands())
+        unite(op->getResult(0), operand);
+    } else if (auto forOp = dyn_cast<scf::ForOp>(op)) {
+      Operation *yieldOp = forOp.getBody()->getTerminator();
+      for (unsigned i = 0; i < forOp.getNumResults(); ++i) {
+        unite(forOp.getResult(i), forOp.getInitArgs()[i]);
+        unite(forOp.getResult(i), forOp.getRegionIterArgs()[i]);
+        unite(forOp.getResult(i), yieldOp->getOperand(i));
+      }
+    } else if (auto ifOp = dyn_cast<scf::IfOp>(op)) {
+      for (unsigned i = 0; i < ifOp.getNumResults(); ++i) {
+        unite(ifOp.getResult(i), ifOp.thenYield().getOperand(i));
+        if (!ifOp.getElseRegion().empty())
+          unite(ifOp.getResult(i), ifOp.elseYield().getOperand(i));
+      }
+    }
+  });
+
+  DenseMap<unsigned, unsigned> rootWebs;
+  for (unsigned id = 0; id < values.size(); ++id) {
+    auto it = rootWebs.try_emplace(find(id), webs.size()).first;
+    if (it->second == webs.size()) {
+      webs.emplace_back();
+      encodings.push_back(
+          values[id].getType().cast<RankedTensorType>().getEncoding());
+    }
+    webIds.push_back(it->second);
+    Web &web = webs[it->second];
+    web.values.push_back(id);
+    Attribute encoding =
+        values[id].getType().cast<RankedTensorType>().getEncoding();
+    // values sharing a layout by construction can only disagree in invalid IR
+    if (encoding != encodings[it->second])
+      web.fixed = true;
+    if (Operation *def = values[id].getDefiningOp())
+      if (isLayoutFlexible(def))
+        web.computations.push_back({values[id].getType(), getWeight(def)});
+  }
+}
+
+void LayoutAssignment::buildEdges() {
+  for (unsigned id = 0; id < values.size(); ++id) {
+    Value value = values[id];
+    int web = webIds[id];
+    Attribute encoding = value.getType().cast<RankedTensorType>().getEncoding();
+    bool flexibleDef = isFlexibleDef(value);
+    if (!flexibleDef) {
+      // anchored definitions are converted where they are defined to the
+      // layout of their web
+      Block *block = value.isa<BlockArgument>()
+                         ? value.cast<BlockArgument>().getOwner()
+                         : value.getDefiningOp()->getBlock();
+      addEdge(-1, web, value, encoding, getWeight(block));
+    } else if (auto cvt = value.getDefiningOp<ttg::ConvertLayoutOp>()) {
+      // conversions of anchored definitions keep reading the definition
+      Value src = cvt.getOperand();
+      int srcWeb = isFlexibleDef(src) ? getWeb(src) : -1;
+      addEdge(srcWeb, web, src, encoding, getWeight(cvt));
+    }
+    if (!flexibleDef)
+      continue;
+    for (OpOperand &use : value.getUses()) {
+      if (isFlexibleUse(use))
+        continue;
+      Operation *user = use.getOwner();
+      if (auto cvt = dyn_cast<ttg::ConvertLayoutOp>(user)) {
+        // conversions between webs are added along with their result
+        if (getWeb(cvt.getResult()) < 0)
+          addEdge(web, -1, value,
+                  cvt.getType().cast<RankedTensorType>().getEncoding(),
+                  getWeight(cvt));
+        continue;
+      }
+      // anchored uses get their value converted back to its current layout
+      addEdge(web, -1, value, encoding, getWeight(user));
+    }
+  }
+
+  for (unsigned w = 0; w < webs.size(); ++w) {
+    Web &web = webs[w];
+    web.candidates.insert(encodings[w]);
+    for (unsigned e : web.edges) {
+      const Edge &edge = edges[e];
+      int other = edge.src == int(w) ? edge.dst : edge.src;
+      Attribute candidate = other >= 0 ? encodings[other]
+                            : edge.src == int(w) ? edge.dstEncoding
+                                                 : edge.srcEncoding;
+      if (isDistributedTensor(getTypeWithEncoding(edge.type, candidate)))
+        web.candidates.insert(candidate);
+    }
+  }
+}
+
+int64_t LayoutAssignment::getConversionCost(RankedTensorType type,
+                                            Attribute dstEncoding) {
+  if (type.getEncoding() == dstEncoding)
+    return 0;
+  RankedTensorType dstType = getTypeWithEncoding(type, dstEncoding);
+  // MMA accumulators are converted to dot operands in registers
+  if (isMmaToDotShortcut(type, dstType))
+    return 0;
+  Type elementType = type.getElementType();
+  int64_t bytes = elementType.isa<triton::PointerType>()
+                      ? 8
+                      : std::max<int64_t>(
+                            elementType.getIntOrFloatBitWidth(), 8) / 8;
+  int64_t bytesPerThread =
+      (type.getNumElements() * bytes + numThreads - 1) / numThreads;
+  // every thread writes its elements and reads back those of the new layout
+  return 2 * bytesPerThread + 2 * kBarrierCost;
+}
+
+int64_t LayoutAssignment::getEdgeCost(const Edge &edge) {
+  if (edge.src >= 0 && edge.src == edge.dst)
+    return 0;
+  Attribute srcEncoding = edge.src >= 0 ? encodings[edge.src] : edge.srcEncoding;
+  Attribute dstEncoding = edge.dst >= 0 ? encodings[edge.dst] : edge.dstEncoding;
+  return edge.weight *
+         getConversionCost(getTypeWithEncoding(edge.type, srcEncoding),
+                           dstEncoding);
+}
+
+int64_t LayoutAssignment::getWebCost(unsigned w) {
+  int64_t cost = 0;
+  for (unsigned e : webs[w].edges)
+    cost += getEdgeCost(edges[e]);
+  for (auto [type, weight] : webs[w].computations)
+    cost += weight *
+            ttg::getTotalElemsPerThread(getTypeWithEncoding(type, encodings[w]));
+  return cost;
+}
+
+bool LayoutAssignment::solve() {
+  SmallVector<Attribute> initialEncodings = encodings;
+  for (int sweep = 0; sweep < kMaxNumSweeps; ++sweep) {
+    bool changed = false;
+    for (unsigned w = 0; w < webs.size(); ++w) {
+      if (webs[w].fixed || webs[w].candidates.size() < 2)
+        continue;
+      Attribute current = encodings[w];
+      Attribute best = current;
+      int64_t bestCost = getWebCost(w);
+      for (Attribute candidate : webs[w].candidates) {
+        encodings[w] = candidate;
+        int64_t cost = getWebCost(w);
+        if (cost < bestCost) {
+          best = candidate;
+          bestCost = cost;
+        }
+      }
+      encodings[w] = best;
+      changed |= best != current;
+    }
+    if (!changed)
+      break;
+  }
+  return encodings != initialEncodings;
+}
+
+void LayoutAssignment::rewriteWeb(unsigned w) {
+  for (unsigned id : webs[w].values) {
+    Value value = values[id];
+    auto type = value.getType().cast<RankedTensorType>();
+    if (type.getEncoding() == encodings[w])
+      continue;
+    RankedTensorType newType = getTypeWithEncoding(type, encodings[w]);
+
+    if (!isFlexibleDef(value)) {
+      OpBuilder builder(funcOp.getContext());
+      if (auto arg = value.dyn_cast<BlockArgument>())
+        builder.setInsertionPointToStart(arg.getOwner());
+      else
+        builder.setInsertionPointAfter(value.getDefiningOp());
+      auto cvt =
+          builder.create<ttg::ConvertLayoutOp>(value.getLoc(), newType, value);
+      value.replaceUsesWithIf(cvt.getResult(), [&](OpOperand &use) {
+        return use.getOwner() != cvt && isFlexibleUse(use);
+      });
+      continue;
+    }
+
+    for (OpOperand &use : llvm::make_early_inc_range(value.getUses())) {
+      Operation *user = use.getOwner();
+      if (isFlexibleUse(use) || isa<ttg::ConvertLayoutOp>(user))
+        continue;
+      OpBuilder builder(user);
+      use.set(builder.create<ttg::ConvertLayoutOp>(user->getLoc(), type, value));
+    }
+    value.setType(newType);
+    if (auto cst = value.getDefiningOp<arith::ConstantOp>()) {
+      auto splat = cst.getValue().cast<SplatElementsAttr>();
+      cst->setAttr(cst.getValueAttrName(),
+                   SplatElementsAttr::get(newType,
+                                          splat.getSplatValue<Attribute>()));
+    }
+  }
+}
+
+bool LayoutAssignment::run() {
+  buildWebs();
+  buildEdges();
+  if (!solve())
+    return false;
+  for (unsigned w = 0; w < webs.size(); ++w)
+    rewriteWeb(w);
+  // conversions within webs are now identities
+  funcOp.walk([](ttg::ConvertLayoutOp cvt) {
+    if (cvt.getType() == cvt.getOperand().getType()) {
+      cvt.replaceAllUsesWith(cvt.getOperand());
+      cvt.erase();
+    }
+  });
+  return true;
+}
+
+struct AssignLayoutsPass
+    : public TritonGPUAssignLayoutsBase<AssignLayoutsPass> {
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    int numThreads = ttg::TritonGPUDialect::getNumWarps(mod) *
+                     ttg::TritonGPUDialect::getThreadsPerWarp(mod);
+    bool changed = false;
+    mod.walk([&](triton::FuncOp funcOp) {
+      changed |= LayoutAssignment(funcOp, numThreads).run();
+    });
+    if (!changed)
+      markAllAnalysesPreserved();
+  }
+};
+
+} // namespace
+
+std::unique_ptr<Pass> mlir::createTritonGPUAssignLayoutsPass() {
+  return std::make_unique<AssignLayoutsPass>();
+}
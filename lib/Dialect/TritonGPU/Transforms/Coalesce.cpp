@@ -73,6 +73,47 @@ struct CoalescePass : public TritonGPUCoalesceBase<CoalescePass> {
     return encoding;
   }
 
+  // Block loads compute their addresses, which are contiguous along the
+  // unit-stride dimension of `order`
+  Attribute getBlockLoadEncoding(ModuleAxisInfoAnalysis &axisInfoAnalysis,
+                                 triton::BlockLoadOp op, int numWarps,
+                                 int threadsPerWarp) {
+    auto type = op.getType().cast<RankedTensorType>();
+    SmallVector<unsigned> order(op.getOrder().begin(), op.getOrder().end());
+    int numElems = product(type.getShape());
+    int numElemsPerThread =
+        std::max(numElems / (numWarps * threadsPerWarp), 1);
+    unsigned elemNumBits = type.getElementTypeBitWidth();
+    unsigned perThread =
+        std::min(axisInfoAnalysis.getBlockLoadAlignment(op),
+                 128 / std::max(elemNumBits, 8u));
+    SmallVector<unsigned, 4> sizePerThread(type.getRank(), 1);
+    sizePerThread[order[0]] = std::min<int>(perThread, numElemsPerThread);
+    return triton::gpu::BlockedEncodingAttr::get(
+        &getContext(), type.getShape(), sizePerThread, order, numWarps,
+        threadsPerWarp);
+  }
+
+  void coalesceBlockLoadOp(ModuleAxisInfoAnalysis &axisInfoAnalysis,
+                           triton::BlockLoadOp op) {
+    auto type = op.getType().cast<RankedTensorType>();
+    auto mod = op->getParentOfType<ModuleOp>();
+    Attribute encoding = getBlockLoadEncoding(
+        axisInfoAnalysis, op, triton::gpu::TritonGPUDialect::getNumWarps(mod),
+        triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod));
+    if (encoding == type.getEncoding())
+      return;
+    OpBuilder builder(op);
+    auto newType = RankedTensorType::get(type.getShape(),
+                                         type.getElementType(), encoding);
+    auto newOp = builder.create<triton::BlockLoadOp>(
+        op.getLoc(), newType, op->getOperands(), op->getAttrs());
+    Value newResult = builder.create<triton::gpu::ConvertLayoutOp>(
+        op.getLoc(), type, newOp.getResult());
+    op.getResult().replaceAllUsesWith(newResult);
+    op.erase();
+  }
+
   std::function<Type(Type)>
   getTypeConverter(ModuleAxisInfoAnalysis &axisInfoAnalysis, Value ptr,
                    int numWarps, int threadsPerWarp) {
@@ -123,14 +164,168 @@ struct CoalescePass : public TritonGPUCoalesceBase<CoalescePass> {
     op->erase();
   }
 
+  // The value v such that op(x, v) = x
+  static TypedAttr getAtomicIdentity(RMWOp rmwOp, Type elemTy) {
+    if (auto floatTy = elemTy.dyn_cast<FloatType>()) {
+      if (rmwOp != RMWOp::FADD)
+        return {};
+      return FloatAttr::get(
+          floatTy, APFloat::getZero(floatTy.getFloatSemantics(), true));
+    }
+    unsigned bitWidth = elemTy.getIntOrFloatBitWidth();
+    APInt identity;
+    switch (rmwOp) {
+    case RMWOp::ADD:
+    case RMWOp::OR:
+    case RMWOp::XOR:
+    case RMWOp::UMAX:
+      identity = APInt::getZero(bitWidth);
+      break;
+    case RMWOp::AND:
+    case RMWOp::UMIN:
+      identity = APInt::getAllOnes(bitWidth);
+      break;
+    case RMWOp::MAX:
+      identity = APInt::getSignedMinValue(bitWidth);
+      break;
+    case RMWOp::MIN:
+      identity = APInt::getSignedMaxValue(bitWidth);
+      break;
+    default:
+      return {};
+    }
+    return IntegerAttr::get(elemTy, identity);
+  }
+
+  static Value combineAtomicValues(OpBuilder &builder, Location loc,
+                                   RMWOp rmwOp, Value lhs, Value rhs) {
+    switch (rmwOp) {
+    case RMWOp::FADD:
+      return builder.create<arith::AddFOp>(loc, lhs, rhs);
+    case RMWOp::ADD:
+      return builder.create<arith::AddIOp>(loc, lhs, rhs);
+    case RMWOp::AND:
+      return builder.create<arith::AndIOp>(loc, lhs, rhs);
+    case RMWOp::OR:
+      return builder.create<arith::OrIOp>(loc, lhs, rhs);
+    case RMWOp::XOR:
+      return builder.create<arith::XOrIOp>(loc, lhs, rhs);
+    case RMWOp::MAX:
+      return builder.create<arith::MaxSIOp>(loc, lhs, rhs);
+    case RMWOp::MIN:
+      return builder.create<arith::MinSIOp>(loc, lhs, rhs);
+    case RMWOp::UMAX:
+      return builder.create<arith::MaxUIOp>(loc, lhs, rhs);
+    case RMWOp::UMIN:
+      return builder.create<arith::MinUIOp>(loc, lhs, rhs);
+    default:
+      llvm_unreachable("unexpected atomic op");
+    }
+  }
+
+  // An atomic whose addresses are all equal, according to their constancy,
+  // and whose old values are unused, is combined over the block: the
+  // masked-off values are replaced by the identity of the op, and the
+  // values, pointers and masks are reduced by a single tt.reduce per
+  // dimension. The scalar atomic left is issued by one thread.
+  static void reduceUniformAtomic(ModuleAxisInfoAnalysis &axisInfoAnalysis,
+                                  triton::AtomicRMWOp op) {
+    auto ptrTy = op.getPtr().getType().dyn_cast<RankedTensorType>();
+    if (!ptrTy || !op->use_empty())
+      return;
+    auto valTy = op.getVal().getType().cast<RankedTensorType>();
+    Type elemTy = valTy.getElementType();
+    TypedAttr identity = getAtomicIdentity(op.getAtomicRmwOp(), elemTy);
+    if (!identity)
+      return;
+    AxisInfo *axisInfo = axisInfoAnalysis.getAxisInfo(op.getPtr());
+    if (!axisInfo)
+      return;
+    for (int d = 0; d < ptrTy.getRank(); ++d)
+      if (axisInfo->getConstancy(d) < ptrTy.getShape()[d])
+        return;
+
+    OpBuilder builder(op);
+    Location loc = op.getLoc();
+    Type i32Ty = builder.getI32Type();
+    Type i64Ty = builder.getI64Type();
+    auto getTensorTy = [&](Type elemTy) {
+      return RankedTensorType::get(ptrTy.getShape(), elemTy,
+                                   ptrTy.getEncoding());
+    };
+    Value val = op.getVal();
+    Value ptr = builder.create<triton::PtrToIntOp>(loc, getTensorTy(i64Ty),
+                                                   op.getPtr());
+    Value mask;
+    if (op.getMask()) {
+      Value identities = builder.create<arith::ConstantOp>(
+          loc, valTy, DenseElementsAttr::get(valTy, identity));
+      val = builder.create<arith::SelectOp>(loc, op.getMask(), val,
+                                            identities);
+      mask = builder.create<arith::ExtUIOp>(loc, getTensorTy(i32Ty),
+                                            op.getMask());
+    }
+    SmallVector<Value> operands = {val, ptr};
+    if (mask)
+      operands.push_back(mask);
+    while (operands[0].getType().isa<RankedTensorType>()) {
+      auto reduce =
+          builder.create<triton::ReduceOp>(loc, operands, /*axis=*/0);
+      OpBuilder::InsertionGuard guard(builder);
+      SmallVector<Type> elemTys;
+      for (Value operand : operands)
+        elemTys.push_back(getElementTypeOrSelf(operand));
+      SmallVector<Type> argTys(elemTys);
+      argTys.append(elemTys.begin(), elemTys.end());
+      Block *combine = builder.createBlock(
+          &reduce.getCombineOp(), {}, argTys,
+          SmallVector<Location>(argTys.size(), loc));
+      unsigned n = operands.size();
+      SmallVector<Value> results = {
+          combineAtomicValues(builder, loc, op.getAtomicRmwOp(),
+                              combine->getArgument(0),
+                              combine->getArgument(n)),
+          // the pointers are all equal
+          combine->getArgument(1)};
+      if (mask)
+        results.push_back(builder.create<arith::MaxUIOp>(
+            loc, combine->getArgument(2), combine->getArgument(n + 2)));
+      builder.create<triton::ReduceReturnOp>(loc, results);
+      operands.assign(reduce.getResult().begin(), reduce.getResult().end());
+    }
+    Value scalarPtr = builder.create<triton::IntToPtrOp>(
+        loc, ptrTy.getElementType(), operands[1]);
+    Value scalarMask;
+    if (mask)
+      scalarMask = builder.create<arith::CmpIOp>(
+          loc, arith::CmpIPredicate::ne, operands[2],
+          builder.create<arith::ConstantIntOp>(loc, 0, 32));
+    builder.create<triton::AtomicRMWOp>(loc, elemTy, op.getAtomicRmwOp(),
+                                        scalarPtr, operands[0], scalarMask,
+                                        op.getSem(), op.getAggregate(),
+                                        op.getScope());
+    op->erase();
+  }
+
   void runOnOperation() override {
     // Run axis info analysis
     ModuleOp moduleOp = getOperation();
-    ModuleAxisInfoAnalysis axisInfoAnalysis(moduleOp);
+    ModuleAxisInfoAnalysis &axisInfoAnalysis =
+        getAnalysis<ModuleAxisInfoAnalysis>();
+
+    SmallVector<triton::AtomicRMWOp> atomics;
+    moduleOp.walk([&](triton::AtomicRMWOp op) { atomics.push_back(op); });
+    for (auto op : atomics)
+      reduceUniformAtomic(axisInfoAnalysis, op);
 
     // For each i/o operation, we determine what layout
     // the pointers should have for best memory coalescing
     LayoutMap layoutMap;
+    SmallVector<triton::BlockLoadOp> blockLoads;
+    moduleOp.walk(
+        [&](triton::BlockLoadOp op) { blockLoads.push_back(op); });
+    for (auto op : blockLoads)
+      coalesceBlockLoadOp(axisInfoAnalysis, op);
     moduleOp.walk([&](Operation *curr) {
       Value ptr;
       if (auto op = dyn_cast<triton::LoadOp>(curr))
@@ -156,6 +351,11 @@ struct CoalescePass : public TritonGPUCoalesceBase<CoalescePass> {
           getTypeConverter(axisInfoAnalysis, ptr, numWarps, threadsPerWarp);
       layoutMap[ptr] = convertType;
     });
+    if (layoutMap.empty()) {
+      if (blockLoads.empty())
+        markAllAnalysesPreserved();
+      return;
+    }
 
     // For each memory op that has a layout L1:
     // 1. Create a coalesced memory layout L2 of the pointer operands
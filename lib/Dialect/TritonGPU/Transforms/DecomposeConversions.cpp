@@ -44,7 +44,8 @@ public:
               srcEncoding.dyn_cast<triton::gpu::MmaEncodingAttr>()) {
 
         if (srcMmaEncoding.getVersionMajor() == 1 ||
-            (srcMmaEncoding.getWarpsPerCTA()[1] == 1 &&
+            (!srcMmaEncoding.isHopper() &&
+             srcMmaEncoding.getWarpsPerCTA()[1] == 1 &&
              dstDotOp.getParent() == srcMmaEncoding))
           return;
       }
@@ -0,0 +1,336 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+//===----------------------------------------------------------------------===//
+// This file flattens loop nests made of an outer loop around a single inner
+// loop, as in persistent kernels that iterate over the tiles of their output
+// and, for each tile, over K:
+//
+// scf.for %tile = %lb0 to %ub0 step %step0 iter_args(%o = %o0) {
+//   (pre-ops: e.g., tile pointers)
+//   %r = scf.for %k = %lb1 to %ub1 step %step1 iter_args(%i = %init) {
+//     (inner body: loads, dot)
+//   }
+//   (post-ops: e.g., epilogue stores)
+//   scf.yield %next_o
+// }
+//
+// into a single loop over all their iterations, which the pipeliner can then
+// prefetch across tiles:
+//
+// scf.for %it = 0 to tiles * ks step 1
+//     iter_args(%o = %o0, %i = %init, %kIdx = 0, %tile = %lb0) {
+//   %first = %kIdx == 0
+//   (pre-ops)
+//   %cur_i = select %first, %init, %i
+//   (inner body, with %k = %lb1 + %kIdx * %step1, giving %next_i)
+//   %last = %kIdx == ks - 1
+//   (post-ops needed by the outer yield)
+//   scf.if %last { (other post-ops) }
+//   scf.yield select(%last, %next_o, %o), %next_i,
+//             select(%last, 0, %kIdx + 1), select(%last, %tile + %step0, %tile)
+// }
+//
+// Pre-ops and the post-ops computing the outer loop-carried values run at
+// every iteration, so they must be free of side effects. The inner loop bounds
+// must be invariant in the outer loop; its trip count is checked at runtime,
+// the original nest being kept for the case where it is not positive or where
+// the total number of iterations overflows the type of the induction
+// variables.
+//===----------------------------------------------------------------------===//
+
+using namespace mlir;
+namespace ttg = triton::gpu;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+bool isPureOp(Operation *op) {
+  return op->getNumRegions() == 0 && isMemoryEffectFree(op);
+}
+
+// `cond ? trueValue : falseValue`, with the condition splat for tensors
+Value createSelect(OpBuilder &builder, Location loc, Value cond,
+                   Value trueValue, Value falseValue) {
+  auto tensorTy = trueValue.getType().dyn_cast<RankedTensorType>();
+  if (!tensorTy)
+    return builder.create<arith::SelectOp>(loc, cond, trueValue, falseValue);
+  auto condTy = RankedTensorType::get(
+      tensorTy.getShape(), builder.getI1Type(), tensorTy.getEncoding());
+  Value splatCond = builder.create<triton::SplatOp>(loc, condTy, cond);
+  return builder.create<ttg::SelectOp>(loc, tensorTy, splatCond, trueValue,
+                                       falseValue);
+}
+
+Value createConstant(OpBuilder &builder, Location loc, Type type,
+                     int64_t value) {
+  return builder.create<arith::ConstantOp>(
+      loc, type, builder.getIntegerAttr(type, value));
+}
+
+// Number of iterations of `forOp`, 0 if its upper bound is below its lower
+// bound
+Value createTripCount(OpBuilder &builder, Location loc, scf::ForOp forOp) {
+  Type type = forOp.getInductionVar().getType();
+  Value zero = createConstant(builder, loc, type, 0);
+  Value one = createConstant(builder, loc, type, 1);
+  Value range = builder.create<arith::SubIOp>(loc, forOp.getUpperBound(),
+                                              forOp.getLowerBound());
+  Value stepMinusOne =
+      builder.create<arith::SubIOp>(loc, forOp.getStep(), one);
+  Value count = builder.create<arith::DivSIOp>(
+      loc, builder.create<arith::AddIOp>(loc, range, stepMinusOne),
+      forOp.getStep());
+  return builder.create<arith::MaxSIOp>(loc, count, zero);
+}
+
+class LoopNestFlattener {
+  scf::ForOp outerLoop;
+  scf::ForOp innerLoop;
+  /// Ops of the outer loop body before and after the inner loop
+  SmallVector<Operation *> preOps;
+  SmallVector<Operation *> postOps;
+  /// Post-ops whose results are needed by the outer loop-carried values
+  DenseSet<Operation *> yieldDeps;
+
+  /// Build the flattened loop, given that the inner loop runs `innerTripCount`
+  /// > 0 times and the outer one `outerTripCount` times, and return its
+  /// results for the outer loop
+  SmallVector<Value> createFlatLoop(OpBuilder &builder, Value outerTripCount,
+                                    Value innerTripCount);
+
+public:
+  LoopNestFlattener(scf::ForOp outerLoop) : outerLoop(outerLoop) {}
+
+  /// Check that the nest can be flattened
+  LogicalResult initialize();
+
+  /// Replace the nest with its flattened version
+  void flatten();
+};
+
+LogicalResult LoopNestFlattener::initialize() {
+  Operation *yieldOp = outerLoop.getBody()->getTerminator();
+  for (Operation &op : outerLoop.getBody()->without_terminator()) {
+    if (auto forOp = dyn_cast<scf::ForOp>(op)) {
+      if (innerLoop)
+        return failure();
+      innerLoop = forOp;
+      continue;
+    }
+    (innerLoop ? postOps : preOps).push_back(&op);
+  }
+  if (!innerLoop)
+    return failure();
+
+  // Only innermost loops with loads to prefetch across tiles
+  bool hasLoads = false;
+  WalkResult hasLoops = innerLoop.getBody()->walk([&](Operation *op) {
+    if (isa<scf::ForOp, scf::WhileOp>(op))
+      return WalkResult::interrupt();
+    hasLoads |= isa<triton::LoadOp>(op);
+    return WalkResult::advance();
+  });
+  if (hasLoops.wasInterrupted() || !hasLoads)
+    return failure();
+
+  // The counters of both loops are carried together
+  if (innerLoop.getInductionVar().getType() !=
+      outerLoop.getInductionVar().getType())
+    return failure();
+  for (Value bound : {innerLoop.getLowerBound(), innerLoop.getUpperBound(),
+                      innerLoop.getStep()})
+    if (!outerLoop.isDefinedOutsideOfLoop(bound))
+      return failure();
+
+  if (!llvm::all_of(preOps, isPureOp))
+    return failure();
+  for (Operation *op : llvm::reverse(postOps))
+    if (llvm::any_of(op->getUsers(), [&](Operation *user) {
+          return user == yieldOp || yieldDeps.contains(user);
+        })) {
+      if (!isPureOp(op))
+        return failure();
+      yieldDeps.insert(op);
+    }
+  return success();
+}
+
+SmallVector<Value> LoopNestFlattener::createFlatLoop(OpBuilder &builder,
+                                                     Value outerTripCount,
+                                                     Value innerTripCount) {
+  Location loc = outerLoop.getLoc();
+  Type ivType = outerLoop.getInductionVar().getType();
+  Value zero = createConstant(builder, loc, ivType, 0);
+  Value one = createConstant(builder, loc, ivType, 1);
+  Value tripCount =
+      builder.create<arith::MulIOp>(loc, outerTripCount, innerTripCount);
+
+  // The inner loop-carried values are first selected from their init values
+  // at the first iteration of a tile: the ones of the first tile are computed
+  // ahead of the loop, to get values of the right types
+  IRMapping initMapping;
+  initMapping.map(outerLoop.getInductionVar(), outerLoop.getLowerBound());
+  for (auto [arg, init] :
+       llvm::zip(outerLoop.getRegionIterArgs(), outerLoop.getInitArgs()))
+    initMapping.map(arg, init);
+  for (Operation *op : preOps)
+    builder.clone(*op, initMapping);
+
+  // Order of args:
+  //   (outer loop-carried values)
+  //   (inner loop-carried values)
+  //   (inner iteration index)
+  //   (outer induction variable)
+  SmallVector<Value> initArgs(outerLoop.getInitArgs());
+  for (Value init : innerLoop.getInitArgs())
+    initArgs.push_back(initMapping.lookupOrDefault(init));
+  initArgs.push_back(zero);
+  initArgs.push_back(outerLoop.getLowerBound());
+  size_t numOuterArgs = outerLoop.getNumRegionIterArgs();
+  size_t numInnerArgs = innerLoop.getNumRegionIterArgs();
+  auto flatLoop =
+      builder.create<scf::ForOp>(loc, zero, tripCount, one, initArgs);
+  auto flatArgs = flatLoop.getRegionIterArgs();
+  Value innerIdx = flatArgs[numOuterArgs + numInnerArgs];
+  Value outerIV = flatArgs[numOuterArgs + numInnerArgs + 1];
+
+  OpBuilder bodyBuilder = OpBuilder::atBlockBegin(flatLoop.getBody());
+  IRMapping mapping;
+  mapping.map(outerLoop.getInductionVar(), outerIV);
+  for (size_t i = 0; i < numOuterArgs; ++i)
+    mapping.map(outerLoop.getRegionIterArgs()[i], flatArgs[i]);
+  Value isFirst = bodyBuilder.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::eq, innerIdx, zero);
+  for (Operation *op : preOps)
+    bodyBuilder.clone(*op, mapping);
+
+  // Inner loop body
+  Value innerIV = bodyBuilder.create<arith::AddIOp>(
+      loc, innerLoop.getLowerBound(),
+      bodyBuilder.create<arith::MulIOp>(loc, innerIdx, innerLoop.getStep()));
+  mapping.map(innerLoop.getInductionVar(), innerIV);
+  for (size_t i = 0; i < numInnerArgs; ++i)
+    mapping.map(innerLoop.getRegionIterArgs()[i],
+                createSelect(bodyBuilder, loc, isFirst,
+                             mapping.lookupOrDefault(innerLoop.getInitArgs()[i]),
+                             flatArgs[numOuterArgs + i]));
+  for (Operation &op : innerLoop.getBody()->without_terminator())
+    bodyBuilder.clone(op, mapping);
+  SmallVector<Value> nextInnerArgs;
+  for (Value v : innerLoop.getBody()->getTerminator()->getOperands())
+    nextInnerArgs.push_back(mapping.lookupOrDefault(v));
+  for (auto [result, next] : llvm::zip(innerLoop.getResults(), nextInnerArgs))
+    mapping.map(result, next);
+
+  // Post-ops only take effect at the last iteration of a tile
+  Value isLast = bodyBuilder.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::eq, innerIdx,
+      bodyBuilder.create<arith::SubIOp>(loc, innerTripCount, one));
+  for (Operation *op : postOps)
+    if (yieldDeps.contains(op))
+      bodyBuilder.clone(*op, mapping);
+  if (postOps.size() > yieldDeps.size()) {
+    auto ifOp = bodyBuilder.create<scf::IfOp>(loc, isLast,
+                                              /*withElseRegion=*/false);
+    OpBuilder thenBuilder = ifOp.getThenBodyBuilder();
+    for (Operation *op : postOps)
+      if (!yieldDeps.contains(op))
+        thenBuilder.clone(*op, mapping);
+  }
+
+  SmallVector<Value> yieldValues;
+  for (size_t i = 0; i < numOuterArgs; ++i)
+    yieldValues.push_back(createSelect(
+        bodyBuilder, loc, isLast,
+        mapping.lookupOrDefault(
+            outerLoop.getBody()->getTerminator()->getOperand(i)),
+        flatArgs[i]));
+  yieldValues.append(nextInnerArgs);
+  yieldValues.push_back(bodyBuilder.create<arith::SelectOp>(
+      loc, isLast, zero,
+      bodyBuilder.create<arith::AddIOp>(loc, innerIdx, one)));
+  yieldValues.push_back(bodyBuilder.create<arith::SelectOp>(
+      loc, isLast,
+      bodyBuilder.create<arith::AddIOp>(loc, outerIV, outerLoop.getStep()),
+      outerIV));
+  bodyBuilder.create<scf::YieldOp>(loc, yieldValues);
+
+  return SmallVector<Value>(flatLoop.getResults().take_front(numOuterArgs));
+}
+
+void LoopNestFlattener::flatten() {
+  OpBuilder builder(outerLoop);
+  Location loc = outerLoop.getLoc();
+  Value outerTripCount = createTripCount(builder, loc, outerLoop);
+  Value innerTripCount = createTripCount(builder, loc, innerLoop);
+  Value canFlatten = builder.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::sgt, innerTripCount,
+      createConstant(builder, loc, innerTripCount.getType(), 0));
+  // The total number of iterations must fit in the type of the induction
+  // variables, which is checked on their product in i64 for narrower types
+  auto intType = innerTripCount.getType().dyn_cast<IntegerType>();
+  if (intType && intType.getWidth() < 64) {
+    Type i64Type = builder.getI64Type();
+    Value product = builder.create<arith::MulIOp>(
+        loc, builder.create<arith::ExtSIOp>(loc, i64Type, outerTripCount),
+        builder.create<arith::ExtSIOp>(loc, i64Type, innerTripCount));
+    Value maxTripCount = createConstant(
+        builder, loc, i64Type,
+        APInt::getSignedMaxValue(intType.getWidth()).getSExtValue());
+    canFlatten = builder.create<arith::AndIOp>(
+        loc, canFlatten,
+        builder.create<arith::CmpIOp>(loc, arith::CmpIPredicate::sle, product,
+                                      maxTripCount));
+  }
+  auto ifOp = builder.create<scf::IfOp>(loc, outerLoop.getResultTypes(),
+                                        canFlatten, /*withElseRegion=*/true);
+
+  OpBuilder thenBuilder = ifOp.getThenBodyBuilder();
+  SmallVector<Value> results =
+      createFlatLoop(thenBuilder, outerTripCount, innerTripCount);
+  // Keep the original nest when the inner loop has no iterations or the
+  // flattened one would have too many
+  OpBuilder elseBuilder = ifOp.getElseBodyBuilder();
+  Operation *originalLoop = elseBuilder.clone(*outerLoop);
+  if (outerLoop.getNumResults() > 0) {
+    thenBuilder.create<scf::YieldOp>(loc, results);
+    elseBuilder.create<scf::YieldOp>(loc, originalLoop->getResults());
+  }
+
+  outerLoop.replaceAllUsesWith(ifOp.getResults());
+  outerLoop.erase();
+}
+
+struct FlattenLoopsPass : public TritonGPUFlattenLoopsBase<FlattenLoopsPass> {
+  FlattenLoopsPass() = default;
+
+  void runOnOperation() override {
+    SmallVector<LoopNestFlattener> flatteners;
+    getOperation()->walk([&](scf::ForOp forOp) {
+      LoopNestFlattener flattener(forOp);
+      if (flattener.initialize().succeeded())
+        flatteners.push_back(std::move(flattener));
+    });
+    if (flatteners.empty()) {
+      markAllAnalysesPreserved();
+      return;
+    }
+    for (LoopNestFlattener &flattener : flatteners)
+      flattener.flatten();
+  }
+};
+
+} // anonymous namespace
+
+std::unique_ptr<Pass> mlir::createTritonGPUFlattenLoopsPass() {
+  return std::make_unique<FlattenLoopsPass>();
+}
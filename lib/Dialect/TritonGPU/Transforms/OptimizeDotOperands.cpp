@@ -1,3 +1,4 @@
+#include "mlir/IR/IRMapping.h"
 #include "mlir/IR/TypeUtilities.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LogicalResult.h"
@@ -50,7 +51,9 @@ public:
     // encodings
     auto argEncoding = argType.getEncoding();
     auto XEncoding =
-        XType.getEncoding().cast<triton::gpu::SharedEncodingAttr>();
+        XType.getEncoding().dyn_cast<triton::gpu::SharedEncodingAttr>();
+    if (!XEncoding)
+      return mlir::failure();
     auto ZEncoding =
         ZType.getEncoding().dyn_cast<triton::gpu::DotOperandEncodingAttr>();
     if (!ZEncoding)
@@ -74,8 +77,82 @@ public:
   }
 };
 
+// Elementwise ops that can be computed on values held in a dot operand
+// layout: the element-wise lowering unpacks all operands with the same
+// packing, and only reorders values for equal widths or 8->16 and 16->32
+// widenings.
+static bool isDotOperandElementwise(Operation *op) {
+  if (op->getNumOperands() == 0 || op->getNumResults() != 1)
+    return false;
+  if (!isa<triton::FpToFpOp, triton::BitcastOp>(op) &&
+      op->getDialect()->getTypeID() !=
+          mlir::TypeID::get<arith::ArithDialect>())
+    return false;
+  auto getBitWidth = [](Type type) -> int {
+    auto tensorTy = type.dyn_cast<RankedTensorType>();
+    if (!tensorTy || !tensorTy.getElementType().isIntOrFloat())
+      return 0;
+    return tensorTy.getElementType().getIntOrFloatBitWidth();
+  };
+  int argBitWidth = getBitWidth(op->getOperand(0).getType());
+  int retBitWidth = getBitWidth(op->getResult(0).getType());
+  if (argBitWidth < 8 || retBitWidth < 8)
+    return false;
+  for (Value operand : op->getOperands())
+    if (getBitWidth(operand.getType()) != argBitWidth)
+      return false;
+  return argBitWidth == retBitWidth ||
+         (argBitWidth == 8 && retBitWidth == 16) ||
+         (argBitWidth == 16 && retBitWidth == 32);
+}
+
+// Whether v is computed by a tree of dot-operand elementwise ops of the
+// same region whose leaves include at least one load, e.g. the
+// unpack/convert/scale chain of weight-only quantized operands.
+static bool dependsOnLoadThroughElementwise(Value v, Region *region) {
+  SmallVector<Value> worklist{v};
+  DenseSet<Value> visited;
+  bool hasLoad = false;
+  while (!worklist.empty()) {
+    Value curr = worklist.pop_back_val();
+    if (!visited.insert(curr).second)
+      continue;
+    Operation *def = curr.getDefiningOp();
+    if (!def || def->getParentRegion() != region)
+      continue;
+    if (isa<triton::LoadOp>(def)) {
+      hasLoad = true;
+      continue;
+    }
+    if (!isDotOperandElementwise(def))
+      continue;
+    for (Value operand : def->getOperands())
+      worklist.push_back(operand);
+  }
+  return hasLoad;
+}
+
+// Returns v in the layout of type, rematerializing splats instead of
+// converting them.
+static Value convertToDotOperandLayout(PatternRewriter &rewriter, Location loc,
+                                       Value v, RankedTensorType type) {
+  Operation *def = v.getDefiningOp();
+  if (auto splat = dyn_cast_or_null<triton::SplatOp>(def))
+    return rewriter.create<triton::SplatOp>(loc, type, splat.getSrc());
+  if (auto cst = dyn_cast_or_null<arith::ConstantOp>(def))
+    if (auto value = cst.getValue().dyn_cast<SplatElementsAttr>())
+      return rewriter.create<arith::ConstantOp>(
+          loc, type,
+          DenseElementsAttr::get(type, value.getSplatValue<Attribute>()));
+  return rewriter.create<triton::gpu::ConvertLayoutOp>(loc, type, v);
+}
+
 // convert(layout_preserving_op(x), dot_operand)
 // -> layout_preserving_op(convert(x, dot_operand))
+//
+// Moving conversions up to the loads lets the pipeliner stage the narrow
+// loaded data (e.g. packed int8/int4 weights) in shared memory, and
+// dequantize it in registers right before the mma.
 class MoveOpAfterLayoutConversion : public mlir::RewritePattern {
 public:
   MoveOpAfterLayoutConversion(mlir::MLIRContext *context)
@@ -86,57 +163,31 @@ public:
   matchAndRewrite(mlir::Operation *op,
                   mlir::PatternRewriter &rewriter) const override {
     auto cvt = cast<triton::gpu::ConvertLayoutOp>(op);
-    // conversion should be dependent on a load
-    // and all operations between the load and the conversion
-    // should be layout preserving
-    SetVector<Operation *> slice;
-    getBackwardSlice(op, &slice);
-    int loadIdx = -1;
-    bool checkOp = false;
-    for (int i = 0; i < slice.size(); i++) {
-      Operation *currOp = *(slice.begin() + i);
-      if (currOp->getParentRegion() != op->getParentRegion())
-        continue;
-      if (isa<triton::LoadOp>(currOp))
-        checkOp = true;
-      else if (checkOp) {
-        if (!isa<triton::FpToFpOp, triton::BitcastOp>(currOp) &&
-            currOp->getDialect()->getTypeID() !=
-                mlir::TypeID::get<arith::ArithDialect>())
-          return mlir::failure();
-      }
-    }
-    if (!checkOp)
-      return mlir::failure();
-
     auto cvtTy = cvt.getType().cast<RankedTensorType>();
-    auto cvtArgOp = cvt.getSrc().getDefiningOp();
-    if (!cvtArgOp || cvtArgOp->getNumOperands() == 0)
+    // only considers conversions to dot operand, held in registers
+    if (!cvtTy.getEncoding().isa<triton::gpu::DotOperandEncodingAttr>() ||
+        triton::gpu::isMmaV3DotOperand(cvtTy.getEncoding()))
       return mlir::failure();
-    // only consider custom conversions or arith ops
-    if (!isa<triton::FpToFpOp, triton::BitcastOp>(cvtArgOp) &&
-        cvtArgOp->getDialect()->getTypeID() !=
-            mlir::TypeID::get<arith::ArithDialect>())
+    auto cvtArgOp = cvt.getSrc().getDefiningOp();
+    if (!cvtArgOp || !isDotOperandElementwise(cvtArgOp))
       return mlir::failure();
-    // only considers conversions to dot operand
-    if (!cvtTy.getEncoding().isa<triton::gpu::DotOperandEncodingAttr>())
+    // conversion should be dependent on a load, and all operations between
+    // the load and the conversion should be layout preserving
+    if (!dependsOnLoadThroughElementwise(cvt.getSrc(), op->getParentRegion()))
       return mlir::failure();
-    auto argTy = cvtArgOp->getOperand(0).getType().cast<RankedTensorType>();
+
     auto retTy = cvtArgOp->getResult(0).getType().cast<RankedTensorType>();
-    if (!argTy || !retTy)
-      return mlir::failure();
     Type newRetTy = RankedTensorType::get(
         retTy.getShape(), retTy.getElementType(), cvtTy.getEncoding());
-    Type newCvtTy = RankedTensorType::get(
-        retTy.getShape(), argTy.getElementType(), cvtTy.getEncoding());
-    int numArgs = cvtArgOp->getNumOperands();
-    SmallVector<triton::gpu::ConvertLayoutOp> newCvts(numArgs);
-    for (int i = 0; i < numArgs; i++)
-      newCvts[i] = rewriter.create<triton::gpu::ConvertLayoutOp>(
-          cvt.getLoc(), newCvtTy, cvtArgOp->getOperand(i));
-    auto newRet = rewriter.clone(*cvtArgOp);
-    for (int i = 0; i < numArgs; i++)
-      newRet->setOperand(i, newCvts[i]);
+    IRMapping mapping;
+    for (Value arg : cvtArgOp->getOperands()) {
+      auto argTy = arg.getType().cast<RankedTensorType>();
+      auto newArgTy = RankedTensorType::get(
+          argTy.getShape(), argTy.getElementType(), cvtTy.getEncoding());
+      mapping.map(arg, convertToDotOperandLayout(rewriter, cvt.getLoc(), arg,
+                                                 newArgTy));
+    }
+    auto newRet = rewriter.clone(*cvtArgOp, mapping);
     newRet->getResult(0).setType(newRetTy);
     rewriter.replaceOp(op, newRet->getResults());
     return mlir::success();
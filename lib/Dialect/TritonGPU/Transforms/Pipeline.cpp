@@ -3,7 +3,9 @@
 #include "mlir/IR/TypeUtilities.h"
 #include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "triton/Analysis/Allocation.h"
 #include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/RegisterPressure.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
@@ -17,7 +19,10 @@
 //
 // We divide the loop body into the following phases:
 // a. Pre-load operations: for instance, index computation.
-// b. Load operations: loading from global memory to shared memory.
+// b. Load operations: loading from global memory to shared memory. Loads of
+// dot operands are converted from shared memory to their dot operand layout;
+// other loads are converted back to their own (blocked) layout, provided the
+// buffers of the loop fit in the shared memory budget.
 // c. Compute operations: for instance, Triton dot.
 // d. Post-load operations: for instance, index computation.
 //
@@ -109,10 +114,15 @@ class LoopPipeliner {
   scf::ForOp forOp;
   scf::YieldOp yieldOp;
 
+  /// Axis info of the module, shared by the pipeliners of all its loops
+  ModuleAxisInfoAnalysis &axisInfoAnalysis;
+
   /// Loads to be pipelined
   SetVector<Value> validLoads;
   /// The value that each load will be mapped to (after layout conversion)
   DenseMap<Value, Value> loadsMapping;
+  /// Loads that do not feed a dot, converted back to their own layout
+  DenseSet<Value> distributedLoads;
   /// load => buffer
   DenseMap<Value, Value> loadsBuffer;
   /// load => buffer type (with shared layout after swizzling)
@@ -137,6 +147,12 @@ class LoopPipeliner {
   /// numStages-1 is appended after the loop body.
   int numStages;
 
+  /// Shared memory, in bytes, the buffers of the loop may use to pipeline
+  /// loads that do not feed a dot
+  int64_t sharedMemoryBudget;
+  /// Shared memory, in bytes, of the buffers of the pipelined loads
+  int64_t sharedMemorySize = 0;
+
   /// Arg indicies
   size_t bufferIdx, loadIdx, depArgsBeginIdx, ivIndex;
   DenseMap<BlockArgument, size_t> depArgsIdx;
@@ -178,9 +194,16 @@ class LoopPipeliner {
   /// Check if none of the ops has valid uses
   LogicalResult checkOpUses(SetVector<Operation *> &ops);
 
+  /// Bytes of the multi-buffer of `loadOp`
+  int64_t getBufferSize(triton::LoadOp loadOp);
+
   /// Check if ops have dependencies that are not pipelinable
   void checkOpDeps(SetVector<Operation *> &ops);
 
+  /// Check that the copies of the loop-carried values the loads depend on
+  /// fit in the register budget of the loop
+  LogicalResult checkRegisterPressure();
+
   void createBufferTypes();
 
   void createOrderedDeps();
@@ -217,6 +240,10 @@ class LoopPipeliner {
   /// Clone the forOp and return the new forOp
   scf::ForOp cloneForOp(ArrayRef<Value> newLoopArgs, OpBuilder &builder);
 
+  /// Wait for the async copy of each load right before the first use of its
+  /// slice in the body of `newForOp`
+  void emitAsyncWaits(scf::ForOp newForOp, OpBuilder &builder);
+
   /// Prefetch the next iteration for `newForOp`
   void prefetchNextIteration(scf::ForOp newForOp, OpBuilder &builder);
 
@@ -224,8 +251,10 @@ class LoopPipeliner {
   void finalizeYield(scf::ForOp newForOp, OpBuilder &builder);
 
 public:
-  LoopPipeliner(scf::ForOp forOp, int numStages)
-      : forOp(forOp), numStages(numStages) {
+  LoopPipeliner(scf::ForOp forOp, int numStages, int64_t sharedMemoryBudget,
+                ModuleAxisInfoAnalysis &axisInfoAnalysis)
+      : forOp(forOp), axisInfoAnalysis(axisInfoAnalysis),
+        numStages(numStages), sharedMemoryBudget(sharedMemoryBudget) {
     yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
   }
 
@@ -241,14 +270,14 @@ public:
   /// create the new ForOp (add new args & insert prefetched ops)
   scf::ForOp createNewForOp();
 
+  /// Shared memory, in bytes, of the buffers of the pipelined loads
+  int64_t getSharedMemorySize() const { return sharedMemorySize; }
+
   friend struct PipelinePass;
 };
 
 /// Collect loads to pipeline. Return success if we can pipeline this loop
 LogicalResult LoopPipeliner::collectOps(SetVector<Operation *> &ops) {
-  ModuleOp moduleOp = forOp->getParentOfType<ModuleOp>();
-  ModuleAxisInfoAnalysis axisInfoAnalysis(moduleOp);
-
   // We cannot use forOp.walk(...) here because we only want to visit the
   // operations in the loop body block. Nested blocks are handled separately.
   for (Operation &op : forOp)
@@ -256,7 +285,10 @@ LogicalResult LoopPipeliner::collectOps(SetVector<Operation *> &ops) {
       auto ptr = loadOp.getPtr();
       unsigned vec = axisInfoAnalysis.getPtrContiguity(ptr);
 
-      if (auto mask = loadOp.getMask())
+      // Partially masked vectors of bounds checks are copied whole, filling
+      // their tail with zeros
+      auto mask = loadOp.getMask();
+      if (mask && !axisInfoAnalysis.isPrefixMask(mask, vec))
         vec = std::min<unsigned>(vec, axisInfoAnalysis.getMaskAlignment(mask));
 
       auto tensorTy = ptr.getType().dyn_cast<RankedTensorType>();
@@ -322,6 +354,8 @@ LogicalResult LoopPipeliner::checkOpUses(SetVector<Operation *> &ops) {
   // Collect all ops' dependencies
   MapVector<Operation *, SetVector<Value>> opDeps;
   collectDeps(ops, opDeps);
+  // Loads that do not feed a dot, pipelined if their buffers fit
+  SmallVector<triton::LoadOp> distributedCandidates;
 
   for (Operation *op : ops) {
     if (auto loadOp = dyn_cast<triton::LoadOp>(op)) {
@@ -336,10 +370,13 @@ LogicalResult LoopPipeliner::checkOpUses(SetVector<Operation *> &ops) {
             isCandidate = false;
             break;
           }
-      // We only pipeline loads that have one covert_layout (to dot_op) use
-      // TODO: lift this constraint in the future
-      if (isCandidate && loadOp.getResult().hasOneUse()) {
-        isCandidate = false;
+      if (!isCandidate) {
+        invalidOps.insert(loadOp);
+        continue;
+      }
+      // Loads that have one covert_layout (to dot_op) use are converted from
+      // their buffer to the dot operand layout
+      if (loadOp.getResult().hasOneUse()) {
         Operation *use = *loadOp.getResult().getUsers().begin();
 
         // Advance to the first conversion as long as the use resides in shared
@@ -360,28 +397,72 @@ LogicalResult LoopPipeliner::checkOpUses(SetVector<Operation *> &ops) {
                                     .dyn_cast<RankedTensorType>())
             if (auto dotOpEnc = tensorType.getEncoding()
                                     .dyn_cast<ttg::DotOperandEncodingAttr>()) {
-              isCandidate = true;
               loadsMapping[loadOp] = convertLayout;
+              continue;
             }
-      } else
-        isCandidate = false;
-
-      if (!isCandidate)
-        invalidOps.insert(loadOp);
+      }
+      // Other loads are converted back to their layout, which the lowering of
+      // async copies requires to be blocked
+      if (loadOp.getType()
+              .cast<RankedTensorType>()
+              .getEncoding()
+              .isa<ttg::BlockedEncodingAttr>())
+        distributedCandidates.push_back(loadOp);
       else
-        validLoads.insert(loadOp);
+        invalidOps.insert(loadOp);
+    }
+  }
+
+  // Loads of dot operands are pipelined whatever the shared memory they use,
+  // the others only while all the buffers fit in the budget
+  for (auto &loadCvt : loadsMapping)
+    sharedMemorySize +=
+        getBufferSize(loadCvt.first.getDefiningOp<triton::LoadOp>());
+  for (triton::LoadOp loadOp : distributedCandidates) {
+    int64_t bufferSize = getBufferSize(loadOp);
+    if (sharedMemorySize + bufferSize > sharedMemoryBudget) {
+      invalidOps.insert(loadOp);
+      continue;
     }
+    sharedMemorySize += bufferSize;
+    loadsMapping[loadOp] = loadOp.getResult();
+    distributedLoads.insert(loadOp);
   }
 
   for (Operation *op : invalidOps)
     ops.remove(op);
 
+  // Loads are kept in program order, which the prefetching relies on
+  for (Operation *op : ops)
+    if (auto loadOp = dyn_cast<triton::LoadOp>(op))
+      validLoads.insert(loadOp);
+
   if (ops.empty())
     return failure();
   else
     return success();
 }
 
+int64_t LoopPipeliner::getBufferSize(triton::LoadOp loadOp) {
+  auto ty = loadOp.getType().cast<RankedTensorType>();
+  return numStages * ty.getNumElements() *
+         ty.getElementType().getIntOrFloatBitWidth() / 8;
+}
+
+LogicalResult LoopPipeliner::checkRegisterPressure() {
+  unsigned budget = RegisterPressureAnalysis::getRegisterBudget(
+      forOp->getParentOfType<ModuleOp>());
+  RegisterPressureAnalysis pressure(
+      forOp->getParentOfType<FunctionOpInterface>(), &axisInfoAnalysis);
+  // The values the loads depend on are carried both for the current
+  // iteration and for the one of the last stage
+  unsigned extra = 0;
+  for (BlockArgument arg : depArgs)
+    extra += RegisterPressureAnalysis::getNumRegisters(
+        arg.getType(), axisInfoAnalysis.getAxisInfo(arg));
+  return success(pressure.getPressure(forOp) + extra <= budget);
+}
+
 void LoopPipeliner::checkOpDeps(SetVector<Operation *> &ops) {
   SetVector<BlockArgument> nonImmediateDepArgs;
   SetVector<Operation *> nonImmediateOps;
@@ -485,18 +566,26 @@ void LoopPipeliner::createBufferTypes() {
   for (auto loadCvt : loadsMapping) {
     auto loadOp = loadCvt.first;
     Value cvt = loadCvt.second;
-    auto dotOpEnc = cvt.getType()
-                        .cast<RankedTensorType>()
-                        .getEncoding()
-                        .cast<ttg::DotOperandEncodingAttr>();
     auto ty = loadOp.getType().cast<RankedTensorType>();
     SmallVector<int64_t> bufferShape(ty.getShape().begin(),
                                      ty.getShape().end());
     bufferShape.insert(bufferShape.begin(), numStages);
-    unsigned bitWidth = ty.getElementType().getIntOrFloatBitWidth();
-    auto sharedEnc =
-        ttg::SharedEncodingAttr::get(ty.getContext(), dotOpEnc, ty.getShape(),
-                                     ttg::getOrder(ty.getEncoding()), bitWidth);
+    auto order = ttg::getOrder(ty.getEncoding());
+    ttg::SharedEncodingAttr sharedEnc;
+    if (distributedLoads.contains(loadOp)) {
+      // Read back by the threads that wrote it: no need to swizzle
+      unsigned vec = ttg::getContigPerThread(ty.getEncoding())[order[0]];
+      sharedEnc =
+          ttg::SharedEncodingAttr::get(ty.getContext(), vec, 1, 1, order);
+    } else {
+      auto dotOpEnc = cvt.getType()
+                          .cast<RankedTensorType>()
+                          .getEncoding()
+                          .cast<ttg::DotOperandEncodingAttr>();
+      unsigned bitWidth = ty.getElementType().getIntOrFloatBitWidth();
+      sharedEnc = ttg::SharedEncodingAttr::get(
+          ty.getContext(), dotOpEnc, ty.getShape(), order, bitWidth);
+    }
     loadsBufferType[loadOp] =
         RankedTensorType::get(bufferShape, ty.getElementType(), sharedEnc);
   }
@@ -548,6 +637,9 @@ LogicalResult LoopPipeliner::initialize() {
 
   checkOpDeps(ops);
 
+  if (checkRegisterPressure().failed())
+    return failure();
+
   createBufferTypes();
 
   createOrderedDeps();
@@ -616,7 +708,8 @@ void LoopPipeliner::emitPrologue() {
               lookupOrDefault(loadOp.getPtr(), stage),
               loadStageBuffer[loadOp][stage], pipelineIterIdx, newMask,
               lookupOrDefault(loadOp.getOther(), stage), loadOp.getCache(),
-              loadOp.getEvict(), loadOp.getIsVolatile(), /*axis*/ 0);
+              loadOp.getEvict(), loadOp.getIsVolatile(), /*axis*/ 0,
+              loadOp.getL2Evict());
           builder.create<ttg::AsyncCommitGroupOp>(op->getLoc());
           loadStageBuffer[loadOp].push_back(newOp->getResult(0));
         } else
@@ -631,7 +724,8 @@ void LoopPipeliner::emitPrologue() {
               lookupOrDefault(loadOp.getPtr(), stage), newMask,
               lookupOrDefault(loadOp.getOther(), stage),
               loadOp.getBoundaryCheckAttr(), loadOp.getPaddingAttr(),
-              loadOp.getCache(), loadOp.getEvict(), loadOp.getIsVolatile());
+              loadOp.getCache(), loadOp.getEvict(), loadOp.getIsVolatile(),
+              loadOp.getL2Evict());
           addNamedAttrs(newOp, op->getDiscardableAttrDictionary());
         } else
           newOp = builder.clone(*op);
@@ -763,14 +857,27 @@ scf::ForOp LoopPipeliner::cloneForOp(ArrayRef<Value> newLoopArgs,
   // We want to find cvt ops that match the following pattern:
   // %0 = load %ptr
   // %1 (dotOperand) = cvt %0
+  // Loads that do not feed a dot are themselves replaced with a cvt of their
+  // buffer to their layout.
   for (Operation &op : forOp.getBody()->without_terminator()) {
+    if (auto loadOp = dyn_cast<triton::LoadOp>(op)) {
+      if (distributedLoads.contains(loadOp)) {
+        auto it = std::find(validLoads.begin(), validLoads.end(), loadOp);
+        auto loadArgIdx = std::distance(validLoads.begin(), it);
+        auto cvt = builder.create<ttg::ConvertLayoutOp>(
+            loadOp.getLoc(), loadOp.getType(),
+            newForOp.getRegionIterArgs()[loadIdx + loadArgIdx]);
+        mapping.map(loadOp.getResult(), cvt.getResult());
+        continue;
+      }
+    }
     if (auto cvtOp = dyn_cast<triton::gpu::ConvertLayoutOp>(op)) {
       auto result = op.getResult(0);
       auto cvtDstTy = result.getType().cast<RankedTensorType>();
       if (cvtDstTy.getEncoding().isa<ttg::DotOperandEncodingAttr>()) {
         auto it =
             std::find(validLoads.begin(), validLoads.end(), op.getOperand(0));
-        if (it != validLoads.end()) {
+        if (it != validLoads.end() && !distributedLoads.contains(*it)) {
           // We replace the use new load use with a convert layout
           auto loadArgIdx = std::distance(validLoads.begin(), it);
           auto cvt = builder.create<ttg::ConvertLayoutOp>(
@@ -787,6 +894,36 @@ scf::ForOp LoopPipeliner::cloneForOp(ArrayRef<Value> newLoopArgs,
   return newForOp;
 }
 
+void LoopPipeliner::emitAsyncWaits(scf::ForOp newForOp, OpBuilder &builder) {
+  OpBuilder::InsertionGuard g(builder);
+  Block *body = newForOp.getBody();
+  int numLoads = validLoads.size();
+  // One group is committed per load, in the order of `orderedDeps`
+  int commitIdx = 0;
+  for (Operation *op : orderedDeps) {
+    Value loadOp = op->getResult(0);
+    if (!validLoads.contains(loadOp))
+      continue;
+    auto it = std::find(validLoads.begin(), validLoads.end(), loadOp);
+    auto loadArgIdx = std::distance(validLoads.begin(), it);
+    Value slice = newForOp.getRegionIterArgs()[loadIdx + loadArgIdx];
+    Operation *firstUser = nullptr;
+    for (Operation *user : slice.getUsers()) {
+      Operation *ancestor = body->findAncestorOpInBlock(*user);
+      if (ancestor && (!firstUser || ancestor->isBeforeInBlock(firstUser)))
+        firstUser = ancestor;
+    }
+    // The groups committed after the one of this load are those of the later
+    // loads of its stage, and of the numStages - 2 stages issued after it
+    int num = numLoads * (numStages - 2) + (numLoads - 1 - commitIdx);
+    ++commitIdx;
+    if (!firstUser)
+      continue;
+    builder.setInsertionPoint(firstUser);
+    builder.create<ttg::AsyncWaitOp>(loadOp.getLoc(), num);
+  }
+}
+
 void LoopPipeliner::prefetchNextIteration(scf::ForOp newForOp,
                                           OpBuilder &builder) {
   // Map the dep args of the next iteration to the dep args of the current
@@ -850,7 +987,8 @@ void LoopPipeliner::prefetchNextIteration(scf::ForOp newForOp,
             curMapping.lookupOrDefault(loadOp.getPtr()), newMask,
             curMapping.lookupOrDefault(loadOp.getOther()),
             loadOp.getBoundaryCheckAttr(), loadOp.getPaddingAttr(),
-            loadOp.getCache(), loadOp.getEvict(), loadOp.getIsVolatile());
+            loadOp.getCache(), loadOp.getEvict(), loadOp.getIsVolatile(),
+            loadOp.getL2Evict());
         addNamedAttrs(nextOp, op->getDiscardableAttrDictionary());
         curMapping.map(loadOp.getResult(), nextOp->getResult(0));
         nextMapping.map(loadOp.getResult(), nextOp->getResult(0));
@@ -888,7 +1026,8 @@ void LoopPipeliner::prefetchNextIteration(scf::ForOp newForOp,
           newForOp.getRegionIterArgs()[bufferIdx + nextBuffers.size()],
           insertSliceIndex, newMask,
           nextMapping.lookupOrDefault(loadOp.getOther()), loadOp.getCache(),
-          loadOp.getEvict(), loadOp.getIsVolatile(), /*axis*/ 0);
+          loadOp.getEvict(), loadOp.getIsVolatile(), /*axis*/ 0,
+          loadOp.getL2Evict());
       builder.create<ttg::AsyncCommitGroupOp>(op->getLoc());
       nextBuffers.push_back(insertAsyncOp);
       // Extract slice
@@ -922,13 +1061,9 @@ void LoopPipeliner::prefetchNextIteration(scf::ForOp newForOp,
     setValueMappingYield(newForOp, arg,
                          newForOp.getRegionIterArgs()[depArgsIdx[arg]]);
 
-  // async.wait & extract_slice
-  Operation *asyncWait = builder.create<ttg::AsyncWaitOp>(
-      validLoads[0].getLoc(), validLoads.size() * (numStages - 2));
-  for (auto it = extractSlices.rbegin(); it != extractSlices.rend(); ++it) {
-    // move extract_slice after asyncWait
-    it->getDefiningOp()->moveAfter(asyncWait);
-  }
+  // The slices of the next iteration are waited for before their first use
+  // there, see emitAsyncWaits, so that compute on the slices of the earlier
+  // loads of a stage starts while the later ones are still in flight
 
   // Bump iteration count
   pipelineIterIdx = builder.create<arith::AddIOp>(
@@ -965,6 +1100,7 @@ scf::ForOp LoopPipeliner::createNewForOp() {
   OpBuilder builder(forOp);
   auto newLoopArgs = collectNewLoopArgs();
   auto newForOp = cloneForOp(newLoopArgs, builder);
+  emitAsyncWaits(newForOp, builder);
   prefetchNextIteration(newForOp, builder);
   finalizeYield(newForOp, builder);
   return newForOp;
@@ -972,13 +1108,20 @@ scf::ForOp LoopPipeliner::createNewForOp() {
 
 // ref: mlir/lib/Dialect/SCF/Transforms/LoopPipelining.cpp
 struct PipelinePass : public TritonGPUPipelineBase<PipelinePass> {
+  /// Largest number of stages tried when they are selected automatically
+  static constexpr int kMaxAutoNumStages = 8;
+
   PipelinePass() = default;
-  PipelinePass(int numStages) { this->numStages = numStages; }
+  PipelinePass(int numStages, int64_t sharedMemoryBudget) {
+    this->numStages = numStages;
+    this->sharedMemoryBudget = sharedMemoryBudget;
+  }
 
   void runOnOperation() override {
     int numStages = this->numStages;
+    bool autoNumStages = numStages == 0;
 
-    if (numStages <= 1)
+    if (numStages <= 1 && !autoNumStages)
       return;
 
     // Pre-processing
@@ -991,26 +1134,72 @@ struct PipelinePass : public TritonGPUPipelineBase<PipelinePass> {
     // auto didPreprocess =
     //     applyPatternsAndFoldGreedily(getOperation(), std::move(patterns));
 
+    // The axis info is computed once for all the loops, and only recomputed
+    // after a loop has been pipelined: the values of the erased loop may be
+    // reallocated to new ops
+    ModuleAxisInfoAnalysis *axisInfoAnalysis =
+        &getAnalysis<ModuleAxisInfoAnalysis>();
+    std::optional<ModuleAxisInfoAnalysis> updatedAxisInfoAnalysis;
+    bool changed = false;
+
+    // With automatic stages, the buffers of each loop share the budget with
+    // the shared memory the kernel already uses: buffers of different loops
+    // are not live at the same time
+    int64_t loopBudget = sharedMemoryBudget;
+    if (autoNumStages)
+      loopBudget -= getAnalysis<ModuleAllocation>().getSharedMemorySize();
+    int maxNumStages = 0;
+
     // Do the pipelining
     getOperation()->walk([&](scf::ForOp forOp) -> void {
-      LoopPipeliner pipeliner(forOp, numStages);
-
-      if (pipeliner.initialize().failed())
-        return;
+      if (!axisInfoAnalysis)
+        axisInfoAnalysis = &updatedAxisInfoAnalysis.emplace(getOperation());
+      std::optional<LoopPipeliner> pipeliner;
+      if (autoNumStages) {
+        // The largest number of stages whose buffers fit in the budget
+        int loopNumStages = kMaxAutoNumStages;
+        for (; loopNumStages > 1; --loopNumStages) {
+          pipeliner.emplace(forOp, loopNumStages, loopBudget,
+                            *axisInfoAnalysis);
+          if (pipeliner->initialize().succeeded() &&
+              pipeliner->getSharedMemorySize() <= loopBudget)
+            break;
+        }
+        if (loopNumStages <= 1)
+          return;
+        maxNumStages = std::max(maxNumStages, loopNumStages);
+      } else {
+        pipeliner.emplace(forOp, numStages, sharedMemoryBudget,
+                          *axisInfoAnalysis);
+        if (pipeliner->initialize().failed())
+          return;
+      }
+      axisInfoAnalysis = nullptr;
+      changed = true;
 
-      pipeliner.emitPrologue();
-      scf::ForOp newForOp = pipeliner.createNewForOp();
-      pipeliner.emitEpilogue();
+      pipeliner->emitPrologue();
+      scf::ForOp newForOp = pipeliner->createNewForOp();
+      pipeliner->emitEpilogue();
 
       // Replace the original loop
       for (unsigned i = 0; i < forOp->getNumResults(); ++i)
         forOp->getResult(i).replaceAllUsesWith(newForOp->getResult(i));
       forOp->erase();
     });
+
+    // Record the stages selected, for the runtime to report them
+    if (autoNumStages && maxNumStages > 0)
+      getOperation()->setAttr(
+          "triton_gpu.num-stages",
+          IntegerAttr::get(IntegerType::get(&getContext(), 32), maxNumStages));
+
+    if (!changed)
+      markAllAnalysesPreserved();
   }
 };
 } // anonymous namespace
 
-std::unique_ptr<Pass> mlir::createTritonGPUPipelinePass(int numStages) {
-  return std::make_unique<PipelinePass>(numStages);
+std::unique_ptr<Pass>
+mlir::createTritonGPUPipelinePass(int numStages, int64_t sharedMemoryBudget) {
+  return std::make_unique<PipelinePass>(numStages, sharedMemoryBudget);
 }
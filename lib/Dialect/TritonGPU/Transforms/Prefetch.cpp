@@ -24,9 +24,19 @@
 //   ...
 //   scf.yield %next_a, ..., %a_prefetch_next
 // }
+//
+// Up to `prefetch-depth` K slices are prefetched that way, as many as fit in
+// the registers left by the loop when the option is 0.
+//
+// Other conversions of a loop-carried shared buffer to registers, feeding
+// reductions or elementwise ops, are prefetched whole: the converted tensor
+// of the next iteration is loaded at the end of the previous one and carried
+// as an extra loop argument.
 //===----------------------------------------------------------------------===//
 
 #include "mlir/IR/IRMapping.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/RegisterPressure.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 
@@ -42,9 +52,18 @@ class Prefetcher {
   scf::ForOp forOp;
   /// cache the YieldOp of this ForOp
   scf::YieldOp yieldOp;
+  /// axis info of the module, shared by the prefetchers of all its loops
+  ModuleAxisInfoAnalysis &axisInfoAnalysis;
+  /// K slices to prefetch, 0 to pick them against the register budget
+  unsigned requestedDepth;
+  /// deepest prefetch picked against the register budget
+  static constexpr unsigned kMaxAutoDepth = 2;
   ///
   // TODO: add a hook to infer prefetchWidth
   unsigned prefetchWidth = 32;
+  unsigned prefetchDepth = 1;
+  /// registers left in the loop by the prefetches selected so far
+  unsigned freeRegisters = 0;
 
   /// dots to be prefetched
   SetVector<Value> dots;
@@ -57,11 +76,24 @@ class Prefetcher {
   DenseMap<Value, Value> dot2bYield;
   DenseMap<Value, SmallVector<Value>> dot2aVals;
   DenseMap<Value, SmallVector<Value>> dot2bVals;
-  /// operand => defining
-  DenseMap<Value, Value> operand2headPrefetch;
+  /// operand => slices prefetched before the loop
+  DenseMap<Value, SmallVector<Value>> operand2headPrefetch;
+
+  /// shared -> distributed conversions prefetched whole
+  SetVector<Operation *> cvts;
+  DenseMap<Operation *, Value> cvt2HeaderDef;
+  DenseMap<Operation *, Value> cvt2Yield;
+  DenseMap<Operation *, Value> cvt2headPrefetch;
 
   LogicalResult isForOpOperand(Value v);
 
+  /// Registers held by one K slice of each operand of `dot`
+  unsigned getSliceRegisters(triton::DotOp dot);
+
+  /// Async copy groups left in flight by the waits preceding the first use
+  /// of the loop argument `arg` in the loop, if any
+  std::optional<int> getAsyncWaitNum(Value arg);
+
   Value generatePrefetch(Value v, unsigned opIdx, bool isPrologue,
                          Attribute dotEncoding, OpBuilder &builder,
                          std::optional<int64_t> offsetK = std::nullopt,
@@ -73,7 +105,10 @@ class Prefetcher {
 public:
   Prefetcher() = delete;
 
-  Prefetcher(scf::ForOp forOp) : forOp(forOp) {
+  Prefetcher(scf::ForOp forOp, ModuleAxisInfoAnalysis &axisInfoAnalysis,
+             unsigned requestedDepth)
+      : forOp(forOp), axisInfoAnalysis(axisInfoAnalysis),
+        requestedDepth(requestedDepth) {
     yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
   }
 
@@ -102,6 +137,38 @@ void Prefetcher::cloneElementwiseOps(Value &ret, const SmallVector<Value> &vals,
     ret = mapping.lookup(vals.back());
 }
 
+unsigned Prefetcher::getSliceRegisters(triton::DotOp dot) {
+  auto aType = dot.getA().getType().cast<RankedTensorType>();
+  auto bType = dot.getB().getType().cast<RankedTensorType>();
+  int64_t width = prefetchWidth;
+  auto aSliceType = RankedTensorType::get({aType.getShape()[0], width},
+                                          aType.getElementType(),
+                                          aType.getEncoding());
+  auto bSliceType = RankedTensorType::get({width, bType.getShape()[1]},
+                                          bType.getElementType(),
+                                          bType.getEncoding());
+  return RegisterPressureAnalysis::getNumRegisters(aSliceType) +
+         RegisterPressureAnalysis::getNumRegisters(bSliceType);
+}
+
+std::optional<int> Prefetcher::getAsyncWaitNum(Value arg) {
+  Block *body = forOp.getBody();
+  Operation *firstUser = nullptr;
+  for (Operation *user : arg.getUsers()) {
+    Operation *ancestor = body->findAncestorOpInBlock(*user);
+    if (ancestor && (!firstUser || ancestor->isBeforeInBlock(firstUser)))
+      firstUser = ancestor;
+  }
+  std::optional<int> num;
+  for (Operation &op : *body) {
+    if (&op == firstUser)
+      break;
+    if (auto wait = dyn_cast<triton::gpu::AsyncWaitOp>(op))
+      num = std::min<int>(num.value_or(wait.getNum()), wait.getNum());
+  }
+  return num;
+}
+
 Value Prefetcher::generatePrefetch(Value v, unsigned opIdx, bool isPrologue,
                                    Attribute dotEncoding, OpBuilder &builder,
                                    std::optional<int64_t> offsetK,
@@ -148,15 +215,24 @@ LogicalResult Prefetcher::initialize() {
     if (auto dotOp = dyn_cast<triton::DotOp>(op))
       dotsInFor.push_back(dotOp);
 
-  if (dotsInFor.empty())
-    return failure();
-
   // TODO: segfault (original for still has uses)
   // when used in flash attention that has 2 dots in the loop
   if (dotsInFor.size() > 1)
-    return failure();
-
-  // returns source of cvt
+    dotsInFor.clear();
+
+  // MMAv3 reads its operands from shared memory: there is nothing to
+  // prefetch into registers
+  if (!dotsInFor.empty() &&
+      triton::gpu::isMmaV3DotOperand(
+          dotsInFor[0].getA().getType().cast<RankedTensorType>().getEncoding()))
+    dotsInFor.clear();
+
+  RegisterPressureAnalysis pressure(
+      forOp->getParentOfType<FunctionOpInterface>(), &axisInfoAnalysis);
+  unsigned budget = RegisterPressureAnalysis::getRegisterBudget(
+      forOp->getParentOfType<ModuleOp>());
+  unsigned used = pressure.getPressure(forOp);
+  freeRegisters = used < budget ? budget - used : 0;
 
   // returns source of cvt
   auto getPrefetchSrc = [](Value v) -> SmallVector<Value> {
@@ -219,6 +295,22 @@ LogicalResult Prefetcher::initialize() {
     // Skip prefetching if kSize is less than prefetchWidth
     if (kSize < prefetchWidth)
       continue;
+    // The depth is clamped to the slices of the K tile, as the prefetched
+    // slices are carved out of the shared buffer of the current iteration.
+    // Picked against the register budget, it is also kept below numSlices
+    // when there are several, so that a slice is still loaded next to the
+    // dots and the loop body has loads to overlap, and at kMaxAutoDepth,
+    // past which the extra registers hide little more latency. In both
+    // cases it is then lowered until the slices fit in the registers left.
+    unsigned numSlices = kSize / prefetchWidth;
+    unsigned depth = requestedDepth
+                         ? std::min(requestedDepth, numSlices)
+                         : std::min(kMaxAutoDepth, std::max(numSlices - 1, 1u));
+    unsigned sliceRegisters = getSliceRegisters(dot);
+    while (depth > 0 && depth * sliceRegisters > freeRegisters)
+      --depth;
+    if (depth == 0)
+      continue;
     auto aVals = getPrefetchSrc(dot.getA());
     auto bVals = getPrefetchSrc(dot.getB());
 
@@ -229,6 +321,9 @@ LogicalResult Prefetcher::initialize() {
       Value bHeaderDef = getIncomingOp(bSmem);
       // Only prefetch loop arg
       if (aHeaderDef && bHeaderDef) {
+        // all the dots of the loop share one depth, which must fit each
+        prefetchDepth = dots.empty() ? depth : std::min(prefetchDepth, depth);
+        freeRegisters -= depth * sliceRegisters;
         dots.insert(dot);
         dot2aVals[dot] = aVals;
         dot2bVals[dot] = bVals;
@@ -242,7 +337,34 @@ LogicalResult Prefetcher::initialize() {
     }
   }
 
-  return success();
+  // Conversions of loop-carried shared buffers not feeding a prefetched dot
+  DenseSet<Operation *> dotPrefetchOps;
+  for (Value dot : dots)
+    for (Value v : llvm::concat<Value>(dot2aVals[dot], dot2bVals[dot]))
+      if (Operation *op = v.getDefiningOp())
+        dotPrefetchOps.insert(op);
+  for (Operation &op : *loop) {
+    auto cvt = dyn_cast<triton::gpu::ConvertLayoutOp>(op);
+    if (!cvt || dotPrefetchOps.contains(cvt))
+      continue;
+    if (!triton::gpu::isSharedEncoding(cvt.getOperand()) ||
+        triton::gpu::isSharedEncoding(cvt.getResult()))
+      continue;
+    Value headerDef = getIncomingOp(cvt.getOperand());
+    if (!headerDef)
+      continue;
+    // the tensor of the next iteration is live with the current one
+    unsigned registers =
+        RegisterPressureAnalysis::getNumRegisters(cvt.getType());
+    if (registers > freeRegisters)
+      continue;
+    freeRegisters -= registers;
+    cvts.insert(cvt);
+    cvt2HeaderDef[cvt] = headerDef;
+    cvt2Yield[cvt] = getYieldOp(cvt.getOperand());
+  }
+
+  return success(!dots.empty() || !cvts.empty());
 }
 
 void Prefetcher::emitPrologue() {
@@ -251,18 +373,23 @@ void Prefetcher::emitPrologue() {
   for (Value dot : dots) {
     Attribute dotEncoding =
         dot.getType().cast<RankedTensorType>().getEncoding();
-    Value aPrefetched =
-        generatePrefetch(dot2aHeaderDef[dot], 0, true, dotEncoding, builder);
-    cloneElementwiseOps(aPrefetched, dot2aVals[dot], builder);
-    Value bPrefetched =
-        generatePrefetch(dot2bHeaderDef[dot], 1, true, dotEncoding, builder);
-    cloneElementwiseOps(bPrefetched, dot2bVals[dot], builder);
-
-    operand2headPrefetch[dot.getDefiningOp<triton::DotOp>().getA()] =
-        aPrefetched;
-    operand2headPrefetch[dot.getDefiningOp<triton::DotOp>().getB()] =
-        bPrefetched;
+    auto dotOp = dot.getDefiningOp<triton::DotOp>();
+    for (unsigned i = 0; i < prefetchDepth; ++i) {
+      int64_t kOff = i * prefetchWidth;
+      Value aPrefetched = generatePrefetch(dot2aHeaderDef[dot], 0, true,
+                                           dotEncoding, builder, kOff);
+      cloneElementwiseOps(aPrefetched, dot2aVals[dot], builder);
+      Value bPrefetched = generatePrefetch(dot2bHeaderDef[dot], 1, true,
+                                           dotEncoding, builder, kOff);
+      cloneElementwiseOps(bPrefetched, dot2bVals[dot], builder);
+      operand2headPrefetch[dotOp.getA()].push_back(aPrefetched);
+      operand2headPrefetch[dotOp.getB()].push_back(bPrefetched);
+    }
   }
+
+  for (Operation *cvt : cvts)
+    cvt2headPrefetch[cvt] = builder.create<triton::gpu::ConvertLayoutOp>(
+        cvt->getLoc(), cvt->getResult(0).getType(), cvt2HeaderDef[cvt]);
 }
 
 scf::ForOp Prefetcher::createNewForOp() {
@@ -271,44 +398,58 @@ scf::ForOp Prefetcher::createNewForOp() {
   SmallVector<Value> loopArgs;
   for (auto v : forOp.getIterOperands())
     loopArgs.push_back(v);
+  // index of the first prefetched loop argument of each dot and conversion
+  DenseMap<Value, unsigned> dot2ArgIdx;
+  DenseMap<Operation *, unsigned> cvt2ArgIdx;
   for (Value dot : dots) {
-    loopArgs.push_back(
-        operand2headPrefetch[dot.getDefiningOp<triton::DotOp>().getA()]);
-    loopArgs.push_back(
-        operand2headPrefetch[dot.getDefiningOp<triton::DotOp>().getB()]);
+    auto dotOp = dot.getDefiningOp<triton::DotOp>();
+    dot2ArgIdx[dot] = loopArgs.size();
+    llvm::append_range(loopArgs, operand2headPrefetch[dotOp.getA()]);
+    llvm::append_range(loopArgs, operand2headPrefetch[dotOp.getB()]);
+  }
+  for (Operation *cvt : cvts) {
+    cvt2ArgIdx[cvt] = loopArgs.size();
+    loopArgs.push_back(cvt2headPrefetch[cvt]);
   }
 
   auto newForOp = builder.create<scf::ForOp>(
       forOp.getLoc(), forOp.getLowerBound(), forOp.getUpperBound(),
       forOp.getStep(), loopArgs);
+  auto iterArgs = newForOp.getRegionIterArgs();
 
   builder.setInsertionPointToStart(newForOp.getBody());
   IRMapping mapping;
   for (const auto &arg : llvm::enumerate(forOp.getRegionIterArgs()))
-    mapping.map(arg.value(), newForOp.getRegionIterArgs()[arg.index()]);
+    mapping.map(arg.value(), iterArgs[arg.index()]);
   mapping.map(forOp.getInductionVar(), newForOp.getInductionVar());
 
   for (Operation &op : forOp.getBody()->without_terminator()) {
-    Operation *newOp = builder.clone(op, mapping);
+    // prefetched conversion
+    if (cvts.contains(&op)) {
+      mapping.map(op.getResult(0), iterArgs[cvt2ArgIdx[&op]]);
+      continue;
+    }
+    Operation *newOp = nullptr;
     auto dot = dyn_cast<triton::DotOp>(&op);
     if (dot && dots.contains(dot)) {
       Attribute dotEncoding =
           dot.getType().cast<RankedTensorType>().getEncoding();
-      // prefetched dot
-      Operation *firstDot = builder.clone(*dot, mapping);
-      if (Value a = operand2headPrefetch.lookup(dot.getA()))
-        firstDot->setOperand(
-            0, newForOp.getRegionIterArgForOpOperand(*a.use_begin()));
-      if (Value b = operand2headPrefetch.lookup(dot.getB()))
-        firstDot->setOperand(
-            1, newForOp.getRegionIterArgForOpOperand(*b.use_begin()));
+      // prefetched dots
+      unsigned argIdx = dot2ArgIdx[dot];
+      Operation *prevDot = nullptr;
+      for (unsigned i = 0; i < prefetchDepth; ++i) {
+        Operation *slicedDot = builder.clone(*dot, mapping);
+        slicedDot->setOperand(0, iterArgs[argIdx + i]);
+        slicedDot->setOperand(1, iterArgs[argIdx + prefetchDepth + i]);
+        if (prevDot)
+          slicedDot->setOperand(2, prevDot->getResult(0));
+        prevDot = slicedDot;
+      }
 
       // remaining part
-      int64_t kOff = prefetchWidth;
+      int64_t kOff = prefetchDepth * prefetchWidth;
       int64_t kRem =
-          dot.getA().getType().cast<RankedTensorType>().getShape()[1] -
-          prefetchWidth;
-      Operation *prevDot = firstDot;
+          dot.getA().getType().cast<RankedTensorType>().getShape()[1] - kOff;
       while (kRem != 0) {
         // int64_t kShape = largestPow2(kRem);
         int64_t kShape = prefetchWidth;
@@ -323,14 +464,17 @@ scf::ForOp Prefetcher::createNewForOp() {
                              dotEncoding, builder, kOff, kShape);
         cloneElementwiseOps(bRem, dot2bVals[dot], builder);
         builder.restoreInsertionPoint(insertionPoint);
-        newOp = builder.clone(*dot, mapping);
-        newOp->setOperand(0, aRem);
-        newOp->setOperand(1, bRem);
-        newOp->setOperand(2, prevDot->getResult(0));
-        prevDot = newOp;
+        Operation *remDot = builder.clone(*dot, mapping);
+        remDot->setOperand(0, aRem);
+        remDot->setOperand(1, bRem);
+        remDot->setOperand(2, prevDot->getResult(0));
+        prevDot = remDot;
         kOff += kShape;
         kRem -= kShape;
       }
+      newOp = prevDot;
+    } else {
+      newOp = builder.clone(op, mapping);
     }
     // update mapping of results
     for (unsigned dstIdx : llvm::seq(unsigned(0), op.getNumResults()))
@@ -341,19 +485,43 @@ scf::ForOp Prefetcher::createNewForOp() {
   SmallVector<Value> yieldValues;
   for (Value v : forOp.getBody()->getTerminator()->getOperands())
     yieldValues.push_back(mapping.lookup(v));
+  // The pipeliner waits for the async copies of a buffer right before its
+  // first use in the loop: wait as much before reading it ahead of time
+  std::optional<int> waitNum;
+  auto addWait = [&](Value arg) {
+    if (std::optional<int> num = getAsyncWaitNum(arg))
+      waitNum = std::min(waitNum.value_or(*num), *num);
+  };
+  for (Value dot : dots) {
+    addWait(dot2aLoopArg[dot]);
+    addWait(dot2bLoopArg[dot]);
+  }
+  for (Operation *cvt : cvts)
+    addWait(cvt->getOperand(0));
+  if (waitNum)
+    builder.create<triton::gpu::AsyncWaitOp>(yieldOp.getLoc(), *waitNum);
   for (Value dot : dots) {
     Attribute dotEncoding =
         dot.getType().cast<RankedTensorType>().getEncoding();
-    Value aToYield = generatePrefetch(mapping.lookup(dot2aYield[dot]), 0, true,
-                                      dotEncoding, builder);
-    cloneElementwiseOps(aToYield, dot2aVals[dot], builder);
-    yieldValues.push_back(aToYield);
-    // bToYield
-    Value bToYield = generatePrefetch(mapping.lookup(dot2bYield[dot]), 1, true,
-                                      dotEncoding, builder);
-    cloneElementwiseOps(bToYield, dot2bVals[dot], builder);
-    yieldValues.push_back(bToYield);
+    SmallVector<Value> aToYield, bToYield;
+    for (unsigned i = 0; i < prefetchDepth; ++i) {
+      int64_t kOff = i * prefetchWidth;
+      Value aPrefetched = generatePrefetch(mapping.lookup(dot2aYield[dot]), 0,
+                                           true, dotEncoding, builder, kOff);
+      cloneElementwiseOps(aPrefetched, dot2aVals[dot], builder);
+      aToYield.push_back(aPrefetched);
+      Value bPrefetched = generatePrefetch(mapping.lookup(dot2bYield[dot]), 1,
+                                           true, dotEncoding, builder, kOff);
+      cloneElementwiseOps(bPrefetched, dot2bVals[dot], builder);
+      bToYield.push_back(bPrefetched);
+    }
+    llvm::append_range(yieldValues, aToYield);
+    llvm::append_range(yieldValues, bToYield);
   }
+  for (Operation *cvt : cvts)
+    yieldValues.push_back(builder.create<triton::gpu::ConvertLayoutOp>(
+        cvt->getLoc(), cvt->getResult(0).getType(),
+        mapping.lookup(cvt2Yield[cvt])));
   // Update ops of yield
   if (!yieldValues.empty())
     builder.create<scf::YieldOp>(yieldOp.getLoc(), yieldValues);
@@ -362,11 +530,22 @@ scf::ForOp Prefetcher::createNewForOp() {
 
 struct PrefetchPass : public TritonGPUPrefetchBase<PrefetchPass> {
   void runOnOperation() override {
+    // As in the pipeliner, the axis info is only recomputed after a loop has
+    // been rewritten
+    ModuleAxisInfoAnalysis *axisInfoAnalysis =
+        &getAnalysis<ModuleAxisInfoAnalysis>();
+    std::optional<ModuleAxisInfoAnalysis> updatedAxisInfoAnalysis;
+    bool changed = false;
+
     getOperation()->walk([&](scf::ForOp forOp) {
-      Prefetcher prefetcher(forOp);
+      if (!axisInfoAnalysis)
+        axisInfoAnalysis = &updatedAxisInfoAnalysis.emplace(getOperation());
+      Prefetcher prefetcher(forOp, *axisInfoAnalysis, prefetchDepth);
 
       if (prefetcher.initialize().failed())
         return;
+      axisInfoAnalysis = nullptr;
+      changed = true;
 
       prefetcher.emitPrologue();
 
@@ -377,6 +556,9 @@ struct PrefetchPass : public TritonGPUPrefetchBase<PrefetchPass> {
         forOp->getResult(i).replaceAllUsesWith(newForOp->getResult(i));
       forOp->erase();
     });
+
+    if (!changed)
+      markAllAnalysesPreserved();
   }
 };
 
@@ -0,0 +1,157 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Interfaces/FunctionInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/RegisterPressure.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "llvm/ADT/SetVector.h"
+
+//===----------------------------------------------------------------------===//
+// This file shortens the live ranges of tensors that are cheap to compute
+// again, such as the offsets and pointers built from `make_range`, `splat`
+// and broadcasts of the program id, when the register pressure estimated for
+// a function exceeds the register budget of its threads.
+//
+// A tensor is rematerialized when its live range spans an op, e.g. a loop,
+// at which the pressure is over budget, and when it is computed from scalars
+// and constants by at most `kMaxRematerializedOps` cheap ops without side
+// effects. Each of its uses then gets its own copy of these ops, right before
+// it, and the original ops are erased once unused.
+//===----------------------------------------------------------------------===//
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+// Ops of the largest expression rematerialized at each use
+constexpr unsigned kMaxRematerializedOps = 8;
+
+bool isCheap(Operation *op) {
+  return isa<triton::MakeRangeOp, triton::SplatOp, triton::BroadcastOp,
+             triton::ExpandDimsOp, triton::AddPtrOp, arith::ConstantOp,
+             arith::AddIOp, arith::SubIOp, arith::MulIOp, arith::AndIOp,
+             arith::OrIOp, arith::ExtSIOp, arith::ExtUIOp, arith::TruncIOp,
+             arith::IndexCastOp, arith::CmpIOp, triton::gpu::CmpIOp>(op);
+}
+
+bool isDistributedTensor(Type type) {
+  auto tensorTy = type.dyn_cast<RankedTensorType>();
+  return tensorTy && tensorTy.getEncoding() &&
+         !tensorTy.getEncoding().isa<triton::gpu::SharedEncodingAttr>();
+}
+
+// Collects the ops computing `value` from scalars and constants, operands
+// first; fails if one of them is not cheap, or if there are too many
+LogicalResult collectExpression(Value value, SetVector<Operation *> &ops) {
+  Operation *op = value.getDefiningOp();
+  if (!op || !isCheap(op) || op->getNumResults() != 1)
+    return failure();
+  if (ops.contains(op))
+    return success();
+  for (Value operand : op->getOperands())
+    if (operand.getType().isa<RankedTensorType>() &&
+        failed(collectExpression(operand, ops)))
+      return failure();
+  ops.insert(op);
+  return success(ops.size() <= kMaxRematerializedOps);
+}
+
+class Rematerializer {
+public:
+  Rematerializer(FunctionOpInterface funcOp,
+                 ModuleAxisInfoAnalysis &axisInfoAnalysis, unsigned budget)
+      : funcOp(funcOp), pressure(funcOp, &axisInfoAnalysis), budget(budget) {}
+
+  void run() {
+    if (pressure.getMaxPressure() <= budget)
+      return;
+    SmallVector<Value> values;
+    funcOp.walk([&](Operation *op) {
+      if (op->getNumResults() == 1 &&
+          isDistributedTensor(op->getResult(0).getType()) &&
+          spansOverBudgetOp(op->getResult(0)))
+        values.push_back(op->getResult(0));
+    });
+    for (Value value : values) {
+      SetVector<Operation *> ops;
+      if (failed(collectExpression(value, ops)))
+        continue;
+      rematerialize(value, ops);
+    }
+  }
+
+private:
+  // Whether an op over budget runs while `value` is live in the block of
+  // its definition
+  bool spansOverBudgetOp(Value value) {
+    Operation *def = value.getDefiningOp();
+    Block *block = def->getBlock();
+    Operation *lastUse = nullptr;
+    for (Operation *user : value.getUsers()) {
+      Operation *ancestor = block->findAncestorOpInBlock(*user);
+      if (ancestor && (!lastUse || lastUse->isBeforeInBlock(ancestor)))
+        lastUse = ancestor;
+    }
+    if (!lastUse)
+      return false;
+    for (Operation *op = def->getNextNode(); op; op = op->getNextNode()) {
+      if (pressure.getPressure(op) > budget)
+        return true;
+      if (op == lastUse)
+        break;
+    }
+    return false;
+  }
+
+  // Computes `value` from the ops of `ops` right before each of its users
+  void rematerialize(Value value, const SetVector<Operation *> &ops) {
+    SmallVector<OpOperand *> uses;
+    for (OpOperand &use : value.getUses())
+      uses.push_back(&use);
+    for (OpOperand *use : uses) {
+      Operation *user = use->getOwner();
+      OpBuilder builder(user);
+      IRMapping mapping;
+      for (Operation *op : ops)
+        builder.clone(*op, mapping);
+      use->set(mapping.lookup(value));
+    }
+    for (Operation *op : llvm::reverse(ops))
+      if (op->use_empty())
+        op->erase();
+  }
+
+  FunctionOpInterface funcOp;
+  RegisterPressureAnalysis pressure;
+  unsigned budget;
+};
+
+} // namespace
+
+class TritonGPURematerializePass
+    : public TritonGPURematerializeBase<TritonGPURematerializePass> {
+public:
+  TritonGPURematerializePass() = default;
+
+  void runOnOperation() override {
+    ModuleOp m = getOperation();
+    unsigned budget = registerBudget > 0
+                          ? registerBudget
+                          : RegisterPressureAnalysis::getRegisterBudget(m);
+    ModuleAxisInfoAnalysis axisInfoAnalysis(m);
+    SmallVector<FunctionOpInterface> funcOps;
+    m.walk([&](FunctionOpInterface funcOp) { funcOps.push_back(funcOp); });
+    for (FunctionOpInterface funcOp : funcOps)
+      Rematerializer(funcOp, axisInfoAnalysis, budget).run();
+  }
+};
+
+std::unique_ptr<Pass> mlir::createTritonGPURematerializePass() {
+  return std::make_unique<TritonGPURematerializePass>();
+}
@@ -1,4 +1,5 @@
 #include "mlir/Analysis/SliceAnalysis.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/Dominance.h"
@@ -7,16 +8,24 @@
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/Verifier.h"
 #include "mlir/Interfaces/InferTypeOpInterface.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "mlir/Transforms/Passes.h"
 #include "mlir/Transforms/RegionUtils.h"
+#include "triton/Analysis/RegisterPressure.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 #include "triton/Dialect/TritonGPU/Transforms/TritonGPUConversion.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SetVector.h"
+
+#include <numeric>
+#include <optional>
+
 #define GEN_PASS_CLASSES
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
 
@@ -35,6 +44,283 @@ willIncreaseRegisterPressure(triton::gpu::ConvertLayoutOp op) {
   return false;
 }
 
+// Estimated cycles between the issue of `op` and the availability of its
+// results
+static unsigned getLatency(Operation *op) {
+  if (auto cvt = dyn_cast<triton::gpu::ConvertLayoutOp>(op)) {
+    auto srcType = cvt.getOperand().getType().cast<RankedTensorType>();
+    // Loads from shared memory, e.g. ldmatrix
+    if (srcType.getEncoding().isa<triton::gpu::SharedEncodingAttr>())
+      return 32;
+    // Round trip through shared memory, with a barrier
+    return 64;
+  }
+  if (isa<triton::DotOp>(op))
+    return 64;
+  if (isa<triton::LoadOp, triton::AtomicRMWOp, triton::AtomicCASOp>(op))
+    return 400;
+  if (isa<triton::gpu::InsertSliceAsyncOp>(op))
+    return 8;
+  // Multi-function unit, e.g. exp
+  if (op->getDialect() && op->getDialect()->getNamespace() == "math")
+    return 16;
+  return 4;
+}
+
+static bool hasSharedEncoding(Type type) {
+  auto tensorType = type.dyn_cast<RankedTensorType>();
+  return tensorType && tensorType.getEncoding() &&
+         tensorType.getEncoding().isa<triton::gpu::SharedEncodingAttr>();
+}
+
+// Whether `op` must keep its position relative to the other such ops of its
+// block: ops with side effects or regions, and those accessing shared
+// memory, whose dependencies on barriers are not carried by values
+static bool isOrdered(Operation *op) {
+  if (op->getNumRegions() > 0 || !isMemoryEffectFree(op))
+    return true;
+  return llvm::any_of(op->getOperandTypes(), hasSharedEncoding) ||
+         llvm::any_of(op->getResultTypes(), hasSharedEncoding);
+}
+
+// Registers a thread holds for `value`; splat constants are materialized as
+// immediates
+static unsigned getNumRegisters(Value value) {
+  if (auto constOp = value.getDefiningOp<arith::ConstantOp>()) {
+    auto denseAttr = constOp.getValue().dyn_cast<DenseElementsAttr>();
+    if (!denseAttr || denseAttr.isSplat())
+      return 0;
+  }
+  return RegisterPressureAnalysis::getNumRegisters(value.getType());
+}
+
+// List scheduler of the ops of a loop body. Ops are issued one per cycle,
+// each once its operands are available, the ready op with the longest
+// latency-weighted path to the end of the body going first, so that loads
+// from shared memory and MMAs of independent tiles overlap. An op that would
+// raise the pressure above `ceiling` is only issued if none of the ready ops
+// fits, in which case the one adding the fewest registers goes first.
+class LoopBodyScheduler {
+public:
+  LoopBodyScheduler(Block *body, unsigned ceiling)
+      : body(body), ceiling(ceiling) {}
+
+  void run() {
+    buildGraph();
+    if (ops.size() < 2)
+      return;
+    SmallVector<unsigned> order(ops.size());
+    std::iota(order.begin(), order.end(), 0);
+    unsigned originalPeak = getPeakPressure(order);
+    SmallVector<unsigned> schedule = computeSchedule();
+    if (schedule == order)
+      return;
+    // Keep the original order if the scheduled one spills more
+    if (getPeakPressure(schedule) > std::max(ceiling, originalPeak))
+      return;
+    Operation *terminator = body->getTerminator();
+    for (unsigned i : schedule)
+      ops[i]->moveBefore(terminator);
+  }
+
+private:
+  void buildGraph() {
+    for (Operation &op : body->without_terminator()) {
+      index[&op] = ops.size();
+      ops.push_back(&op);
+    }
+    preds.resize(ops.size());
+    succs.resize(ops.size());
+    auto addEdge = [&](unsigned from, unsigned to, bool isData) {
+      if (from == to)
+        return;
+      if (isData)
+        dataEdges.insert({from, to});
+      if (llvm::is_contained(preds[to], from))
+        return;
+      preds[to].push_back(from);
+      succs[from].push_back(to);
+    };
+    usedValues.resize(ops.size());
+    std::optional<unsigned> lastOrdered;
+    for (auto en : llvm::enumerate(ops)) {
+      unsigned i = en.index();
+      en.value()->walk([&](Operation *nested) {
+        for (Value operand : nested->getOperands())
+          // Values of the regions of the op are not live around it
+          if (!en.value()->isAncestor(operand.getParentBlock()->getParentOp()))
+            usedValues[i].insert(operand);
+      });
+      for (Value value : usedValues[i]) {
+        Operation *def = value.getDefiningOp();
+        if (def && def->getBlock() == body)
+          addEdge(index[def], i, /*isData=*/true);
+      }
+      if (isOrdered(en.value())) {
+        if (lastOrdered)
+          addEdge(*lastOrdered, i, /*isData=*/false);
+        lastOrdered = i;
+      }
+    }
+    // Longest latency-weighted path to the end of the body
+    priority.assign(ops.size(), 0);
+    for (unsigned i = ops.size(); i-- > 0;) {
+      unsigned tail = 0;
+      for (unsigned succ : succs[i])
+        tail = std::max(tail, priority[succ]);
+      priority[i] = getLatency(ops[i]) + tail;
+    }
+  }
+
+  // Registers held by the values used in the body before its first op, and
+  // the number of ops using each value that can die in it
+  unsigned initLiveness(DenseMap<Value, unsigned> &numUses) {
+    unsigned live = 0;
+    SetVector<Value> outside;
+    for (unsigned i = 0; i < ops.size(); ++i)
+      for (Value value : usedValues[i]) {
+        ++numUses[value];
+        if (value.getParentBlock() != body)
+          outside.insert(value);
+      }
+    // Values of the enclosing regions stay live over the whole body, and so
+    // do the values used by the terminator
+    for (Value value : outside) {
+      live += getNumRegisters(value);
+      numUses.erase(value);
+    }
+    for (Value value : body->getTerminator()->getOperands())
+      if (value.getParentBlock() == body)
+        numUses[value] += 1;
+    for (BlockArgument arg : body->getArguments())
+      if (numUses.count(arg))
+        live += getNumRegisters(arg);
+    return live;
+  }
+
+  // Registers the i-th op adds, and those it frees, given the remaining uses
+  // `numUses`
+  std::pair<unsigned, unsigned>
+  getPressureDelta(unsigned i, const DenseMap<Value, unsigned> &numUses) {
+    unsigned added = 0, freed = 0;
+    for (Value result : ops[i]->getResults())
+      if (numUses.count(result))
+        added += getNumRegisters(result);
+    for (Value value : usedValues[i]) {
+      auto it = numUses.find(value);
+      if (it != numUses.end() && it->second == 1)
+        freed += getNumRegisters(value);
+    }
+    return {added, freed};
+  }
+
+  // Peak pressure of the body when its ops are issued in `order`
+  unsigned getPeakPressure(ArrayRef<unsigned> order) {
+    DenseMap<Value, unsigned> numUses;
+    unsigned live = initLiveness(numUses);
+    unsigned peak = live;
+    for (unsigned i : order) {
+      auto [added, freed] = getPressureDelta(i, numUses);
+      peak = std::max(peak, live + added);
+      live = live + added - freed;
+      for (Value value : usedValues[i]) {
+        auto it = numUses.find(value);
+        if (it != numUses.end() && --it->second == 0)
+          numUses.erase(it);
+      }
+    }
+    return peak;
+  }
+
+  SmallVector<unsigned> computeSchedule() {
+    DenseMap<Value, unsigned> numUses;
+    unsigned live = initLiveness(numUses);
+    SmallVector<unsigned> numPreds(ops.size());
+    SmallVector<unsigned> readyCycle(ops.size(), 0);
+    SmallVector<unsigned> ready;
+    for (unsigned i = 0; i < ops.size(); ++i) {
+      numPreds[i] = preds[i].size();
+      if (numPreds[i] == 0)
+        ready.push_back(i);
+    }
+    SmallVector<unsigned> schedule;
+    unsigned cycle = 0;
+    while (!ready.empty()) {
+      // Among the ops available at this cycle that fit under the ceiling,
+      // the most critical one; otherwise the ready op adding the fewest
+      // registers, waiting for it if needed
+      std::optional<unsigned> best;
+      for (unsigned i : ready) {
+        if (readyCycle[i] > cycle)
+          continue;
+        auto [added, freed] = getPressureDelta(i, numUses);
+        if (live + added > ceiling)
+          continue;
+        if (!best || priority[i] > priority[*best] ||
+            (priority[i] == priority[*best] && i < *best))
+          best = i;
+      }
+      if (!best) {
+        std::optional<unsigned> minCycle;
+        for (unsigned i : ready) {
+          auto [added, freed] = getPressureDelta(i, numUses);
+          if (live + added <= ceiling &&
+              (!minCycle || readyCycle[i] < *minCycle))
+            minCycle = readyCycle[i];
+        }
+        if (minCycle) {
+          // An op fitting under the ceiling is only waiting for its operands
+          cycle = *minCycle;
+          continue;
+        }
+        int bestDelta = 0;
+        for (unsigned i : ready) {
+          auto [added, freed] = getPressureDelta(i, numUses);
+          int delta = int(added) - int(freed);
+          if (!best || delta < bestDelta ||
+              (delta == bestDelta && readyCycle[i] < readyCycle[*best]) ||
+              (delta == bestDelta && readyCycle[i] == readyCycle[*best] &&
+               i < *best)) {
+            best = i;
+            bestDelta = delta;
+          }
+        }
+        cycle = std::max(cycle, readyCycle[*best]);
+      }
+      unsigned i = *best;
+      auto [added, freed] = getPressureDelta(i, numUses);
+      live = live + added - freed;
+      for (Value value : usedValues[i]) {
+        auto it = numUses.find(value);
+        if (it != numUses.end() && --it->second == 0)
+          numUses.erase(it);
+      }
+      llvm::erase_value(ready, i);
+      schedule.push_back(i);
+      for (unsigned succ : succs[i]) {
+        // Ordering edges only constrain the issue order
+        unsigned latency =
+            dataEdges.contains({i, succ}) ? getLatency(ops[i]) : 0;
+        readyCycle[succ] = std::max(readyCycle[succ], cycle + latency);
+        if (--numPreds[succ] == 0)
+          ready.push_back(succ);
+      }
+      ++cycle;
+    }
+    return schedule;
+  }
+
+  Block *body;
+  unsigned ceiling;
+  SmallVector<Operation *> ops;
+  DenseMap<Operation *, unsigned> index;
+  SmallVector<SmallVector<unsigned>> preds;
+  SmallVector<SmallVector<unsigned>> succs;
+  SmallVector<unsigned> priority;
+  DenseSet<std::pair<unsigned, unsigned>> dataEdges;
+  SmallVector<SetVector<Value>> usedValues;
+};
+
 class TritonGPUReorderInstructionsPass
     : public TritonGPUReorderInstructionsBase<
           TritonGPUReorderInstructionsPass> {
@@ -106,6 +392,16 @@ public:
         return;
       op->moveAfter(AOp);
     });
+    // Interleave loads from shared memory, MMAs and their epilogues in the
+    // bodies of the loops computing dots
+    unsigned ceiling = RegisterPressureAnalysis::getRegisterBudget(m);
+    m.walk([&](scf::ForOp forOp) {
+      Block *body = forOp.getBody();
+      if (llvm::none_of(body->getOperations(),
+                        [](Operation &op) { return isa<triton::DotOp>(op); }))
+        return;
+      LoopBodyScheduler(body, ceiling).run();
+    });
     return;
   }
 };
@@ -12,8 +12,10 @@ using namespace mlir::triton::gpu;
 // TypeConverter
 //
 TritonGPUTypeConverter::TritonGPUTypeConverter(MLIRContext *context,
-                                               int numWarps, int threadsPerWarp)
-    : context(context), numWarps(numWarps), threadsPerWarp(threadsPerWarp) {
+                                               int numWarps, int threadsPerWarp,
+                                               int elemBitwidth)
+    : context(context), numWarps(numWarps), threadsPerWarp(threadsPerWarp),
+      elemBitwidth(elemBitwidth) {
   addConversion([](Type type) { return type; });
   addConversion([this](RankedTensorType tensorType) -> RankedTensorType {
     // types with encoding are already in the right format
@@ -28,6 +30,15 @@ TritonGPUTypeConverter::TritonGPUTypeConverter(MLIRContext *context,
     llvm::SmallVector<unsigned> order(rank);
     std::iota(order.begin(), order.end(), 0);
     llvm::SmallVector<unsigned> sizePerThread(rank, 1);
+    // A thread holds up to 128 bits of consecutive elements of a 1-D tensor,
+    // as long as there are enough of them for all the threads. The size only
+    // depends on the shape, so that the operands of elementwise ops of
+    // different element types keep sharing their layout.
+    if (rank == 1) {
+      int64_t perThread = shape[0] / (this->numWarps * this->threadsPerWarp);
+      int64_t vec = 128 / std::max(this->elemBitwidth, 8);
+      sizePerThread[0] = std::clamp<int64_t>(perThread, 1, vec);
+    }
     Attribute encoding = triton::gpu::BlockedEncodingAttr::get(
         this->context, shape, sizePerThread, order, this->numWarps,
         this->threadsPerWarp);
@@ -97,14 +108,17 @@ TritonGPUConversionTarget::TritonGPUConversionTarget(
   });
 
   // We have requirements for the data layouts
-  addDynamicallyLegalOp<triton::DotOp>([](triton::DotOp dotOp) -> bool {
-    Attribute aEncoding =
-        dotOp.getA().getType().cast<RankedTensorType>().getEncoding();
-    Attribute bEncoding =
-        dotOp.getB().getType().cast<RankedTensorType>().getEncoding();
-    if (aEncoding && aEncoding.isa<triton::gpu::DotOperandEncodingAttr>() &&
-        bEncoding && bEncoding.isa<triton::gpu::DotOperandEncodingAttr>())
-      return true;
-    return false;
+  auto hasDotOperandEncodings = [](Value a, Value b) -> bool {
+    Attribute aEncoding = a.getType().cast<RankedTensorType>().getEncoding();
+    Attribute bEncoding = b.getType().cast<RankedTensorType>().getEncoding();
+    return aEncoding && aEncoding.isa<triton::gpu::DotOperandEncodingAttr>() &&
+           bEncoding && bEncoding.isa<triton::gpu::DotOperandEncodingAttr>();
+  };
+  addDynamicallyLegalOp<triton::DotOp>([=](triton::DotOp dotOp) -> bool {
+    return hasDotOperandEncodings(dotOp.getA(), dotOp.getB());
   });
+  addDynamicallyLegalOp<triton::SparseDotOp>(
+      [=](triton::SparseDotOp dotOp) -> bool {
+        return hasDotOperandEncodings(dotOp.getA(), dotOp.getB());
+      });
 }
@@ -0,0 +1,276 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/RegisterPressure.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+//===----------------------------------------------------------------------===//
+// This file unrolls innermost loops with a small constant trip count, and
+// interleaves the copies of their body so that the loads of an iteration are
+// issued before the computations of the previous one:
+//
+// scf.for %i = 0 to 2 step 1 iter_args(%acc = %init) {
+//   %x = tt.load %ptr(%i)
+//   %next = compute(%acc, %x)
+//   scf.yield %next
+// }
+//
+// becomes
+//
+// %x0 = tt.load %ptr(0)
+// %x1 = tt.load %ptr(1)
+// %acc1 = compute(%init, %x0)
+// %acc2 = compute(%acc1, %x1)
+//
+// The loads of a copy, with the side-effect free ops computing their
+// operands, move before the first op of the previous copy that depends on
+// one of its loads, unless that op writes memory before them. Loops are
+// fully unrolled when the registers of the loads kept in flight fit in the
+// register budget along with the pressure of the loop, and otherwise
+// unrolled by the largest divisor of their trip count that fits, if any.
+//===----------------------------------------------------------------------===//
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+Value createConstant(OpBuilder &builder, Location loc, Type type,
+                     int64_t value) {
+  return builder.create<arith::ConstantOp>(
+      loc, type, builder.getIntegerAttr(type, value));
+}
+
+// Number of iterations of `forOp`, if its bounds are constants
+std::optional<int64_t> getConstantTripCount(scf::ForOp forOp) {
+  auto lb = getConstantIntValue(forOp.getLowerBound());
+  auto ub = getConstantIntValue(forOp.getUpperBound());
+  auto step = getConstantIntValue(forOp.getStep());
+  if (!lb || !ub || !step || *step <= 0)
+    return std::nullopt;
+  return std::max<int64_t>(0, (*ub - *lb + *step - 1) / *step);
+}
+
+bool isPureOp(Operation *op) {
+  return op->getNumRegions() == 0 && isMemoryEffectFree(op);
+}
+
+class LoopUnroller {
+  scf::ForOp forOp;
+  int64_t tripCount;
+  /// Ops of each copy of the body, in order
+  SmallVector<SmallVector<Operation *>> copies;
+
+  /// Clone the body `factor` times at the insertion point of `builder`, the
+  /// first copy at induction variable `iv` and with `iterArgs`, and return
+  /// the values yielded by the last one
+  SmallVector<Value> cloneBody(OpBuilder &builder, Value iv,
+                               ValueRange iterArgs, unsigned factor);
+
+  /// Move the loads of each copy before the computations of the previous one
+  void interleave();
+
+  /// Move `load`, and the ops it depends on from `insertPt` on, before
+  /// `insertPt`, if those ops are free of side effects, none of them is one
+  /// of `loadUsers` (the computations of the previous copy, from `insertPt`
+  /// on), and none writes memory between `insertPt` and `load`
+  static void hoistLoad(triton::LoadOp load, Operation *insertPt,
+                        const DenseSet<Operation *> &loadUsers);
+
+public:
+  LoopUnroller(scf::ForOp forOp, int64_t tripCount)
+      : forOp(forOp), tripCount(tripCount) {}
+
+  /// Unroll the loop `factor` times, with `factor` dividing its trip count
+  void unroll(unsigned factor);
+};
+
+SmallVector<Value> LoopUnroller::cloneBody(OpBuilder &builder, Value iv,
+                                           ValueRange iterArgs,
+                                           unsigned factor) {
+  Location loc = forOp.getLoc();
+  Block *body = forOp.getBody();
+  SmallVector<Value> args(iterArgs);
+  for (unsigned i = 0; i < factor; ++i) {
+    IRMapping mapping;
+    Value copyIV = iv;
+    if (i > 0)
+      copyIV = builder.create<arith::AddIOp>(
+          loc, iv,
+          builder.create<arith::MulIOp>(
+              loc, forOp.getStep(),
+              createConstant(builder, loc, iv.getType(), i)));
+    mapping.map(forOp.getInductionVar(), copyIV);
+    mapping.map(forOp.getRegionIterArgs(), args);
+    SmallVector<Operation *> &ops = copies.emplace_back();
+    for (Operation &op : body->without_terminator())
+      ops.push_back(builder.clone(op, mapping));
+    args.clear();
+    for (Value v : body->getTerminator()->getOperands())
+      args.push_back(mapping.lookupOrDefault(v));
+  }
+  return args;
+}
+
+void LoopUnroller::hoistLoad(triton::LoadOp load, Operation *insertPt,
+                             const DenseSet<Operation *> &loadUsers) {
+  Block *block = insertPt->getBlock();
+  SetVector<Operation *> slice;
+  SmallVector<Operation *> worklist{load};
+  while (!worklist.empty()) {
+    Operation *op = worklist.pop_back_val();
+    if (!slice.insert(op))
+      continue;
+    // The address of the load depends on the loads of the previous copy
+    if (op == insertPt || loadUsers.contains(op))
+      return;
+    if (op != load && !isPureOp(op))
+      return;
+    for (Value operand : op->getOperands()) {
+      Operation *def = operand.getDefiningOp();
+      if (def && def->getBlock() == block && !def->isBeforeInBlock(insertPt))
+        worklist.push_back(def);
+    }
+  }
+  for (Operation *op = insertPt; op != load; op = op->getNextNode())
+    if (!slice.contains(op) && !isMemoryEffectFree(op) &&
+        !isa<triton::LoadOp>(op))
+      return;
+  SmallVector<Operation *> ops(slice.begin(), slice.end());
+  llvm::sort(ops, [](Operation *a, Operation *b) {
+    return a->isBeforeInBlock(b);
+  });
+  for (Operation *op : ops)
+    op->moveBefore(insertPt);
+}
+
+void LoopUnroller::interleave() {
+  for (size_t i = 1; i < copies.size(); ++i) {
+    // The computations of the previous copy start at its first op depending
+    // on one of its loads
+    DenseSet<Operation *> loads, loadUsers;
+    for (Operation *op : copies[i - 1])
+      if (isa<triton::LoadOp>(op))
+        loads.insert(op);
+    Operation *insertPt = nullptr;
+    for (Operation *op : copies[i - 1]) {
+      bool dependsOnLoad = llvm::any_of(op->getOperands(), [&](Value v) {
+        Operation *def = v.getDefiningOp();
+        return def && (loads.contains(def) || loadUsers.contains(def));
+      });
+      if (!dependsOnLoad)
+        continue;
+      loadUsers.insert(op);
+      if (!insertPt || op->isBeforeInBlock(insertPt))
+        insertPt = op;
+    }
+    if (!insertPt)
+      continue;
+    for (Operation *op : copies[i])
+      if (auto load = dyn_cast<triton::LoadOp>(op))
+        hoistLoad(load, insertPt, loadUsers);
+  }
+}
+
+void LoopUnroller::unroll(unsigned factor) {
+  Location loc = forOp.getLoc();
+  OpBuilder builder(forOp);
+  if (factor == tripCount) {
+    // A single iteration is left: the body replaces the loop
+    SmallVector<Value> results = cloneBody(
+        builder, forOp.getLowerBound(), forOp.getInitArgs(), factor);
+    forOp.replaceAllUsesWith(results);
+    forOp.erase();
+  } else {
+    Value step = builder.create<arith::MulIOp>(
+        loc, forOp.getStep(),
+        createConstant(builder, loc, forOp.getStep().getType(), factor));
+    auto newForOp =
+        builder.create<scf::ForOp>(loc, forOp.getLowerBound(),
+                                   forOp.getUpperBound(), step,
+                                   forOp.getInitArgs());
+    OpBuilder bodyBuilder = OpBuilder::atBlockBegin(newForOp.getBody());
+    SmallVector<Value> yields =
+        cloneBody(bodyBuilder, newForOp.getInductionVar(),
+                  newForOp.getRegionIterArgs(), factor);
+    // Loops without results are built with their yield
+    if (!yields.empty())
+      bodyBuilder.create<scf::YieldOp>(loc, yields);
+    forOp.replaceAllUsesWith(newForOp.getResults());
+    forOp.erase();
+  }
+  interleave();
+}
+
+struct UnrollLoopsPass : public TritonGPUUnrollLoopsBase<UnrollLoopsPass> {
+  UnrollLoopsPass() = default;
+
+  // Unroll factor of `forOp`, 1 to leave it as is
+  unsigned getUnrollFactor(scf::ForOp forOp, int64_t tripCount,
+                           const RegisterPressureAnalysis &pressure,
+                           ModuleAxisInfoAnalysis &axisInfoAnalysis,
+                           unsigned budget) {
+    if (tripCount < 2 || tripCount > maxTripCount)
+      return 1;
+    // Innermost loops with loads to interleave
+    unsigned loadRegisters = 0;
+    WalkResult hasLoops = forOp.getBody()->walk([&](Operation *op) {
+      if (isa<scf::ForOp, scf::WhileOp>(op))
+        return WalkResult::interrupt();
+      if (auto load = dyn_cast<triton::LoadOp>(op))
+        loadRegisters += RegisterPressureAnalysis::getNumRegisters(
+            load.getType(), axisInfoAnalysis.getAxisInfo(load));
+      return WalkResult::advance();
+    });
+    if (hasLoops.wasInterrupted() || loadRegisters == 0)
+      return 1;
+    // Each copy keeps the results of its loads in flight during the
+    // computations of the previous one
+    for (int64_t factor = tripCount; factor > 1; --factor)
+      if (tripCount % factor == 0 &&
+          pressure.getPressure(forOp) + (factor - 1) * loadRegisters <= budget)
+        return factor;
+    return 1;
+  }
+
+  void runOnOperation() override {
+    ModuleOp m = getOperation();
+    unsigned budget = registerBudget > 0
+                          ? registerBudget
+                          : RegisterPressureAnalysis::getRegisterBudget(m);
+    ModuleAxisInfoAnalysis axisInfoAnalysis(m);
+    SmallVector<std::pair<scf::ForOp, unsigned>> loops;
+    m.walk([&](FunctionOpInterface funcOp) {
+      RegisterPressureAnalysis pressure(funcOp, &axisInfoAnalysis);
+      funcOp.walk([&](scf::ForOp forOp) {
+        auto tripCount = getConstantTripCount(forOp);
+        if (!tripCount)
+          return;
+        unsigned factor = getUnrollFactor(forOp, *tripCount, pressure,
+                                          axisInfoAnalysis, budget);
+        if (factor > 1)
+          loops.push_back({forOp, factor});
+      });
+    });
+    if (loops.empty()) {
+      markAllAnalysesPreserved();
+      return;
+    }
+    for (auto [forOp, factor] : loops)
+      LoopUnroller(forOp, *getConstantTripCount(forOp)).unroll(factor);
+  }
+};
+
+} // anonymous namespace
+
+std::unique_ptr<Pass> mlir::createTritonGPUUnrollLoopsPass() {
+  return std::make_unique<UnrollLoopsPass>();
+}
@@ -82,8 +82,32 @@ LogicalResult invertEncoding(Attribute targetEncoding, Operation *op,
       return failure();
     ret = sliceEncoding.getParent();
   }
+  if (isa<triton::TransOp>(op)) {
+    // The transposition of a blocked encoding is its own inverse
+    Dialect &dialect = targetEncoding.getDialect();
+    auto inferLayoutInterface = cast<DialectInferLayoutInterface>(&dialect);
+    if (!targetEncoding.isa<triton::gpu::BlockedEncodingAttr>() ||
+        failed(inferLayoutInterface->inferTransOpEncoding(targetEncoding, ret)))
+      return failure();
+  }
   if (isa<triton::ViewOp, triton::CatOp>(op)) {
-    return failure();
+    // The operands take the encoding from which the result is computed by
+    // renaming registers, provided that it leads back to `targetEncoding`
+    auto srcTy = op->getOperand(0).getType().cast<RankedTensorType>();
+    auto dstTy = op->getResult(0).getType().cast<RankedTensorType>();
+    if (llvm::any_of(op->getOperandTypes(),
+                     [&](Type type) { return type != srcTy; }))
+      return failure();
+    ret = triton::gpu::getRenamingEncoding(
+        RankedTensorType::get(dstTy.getShape(), dstTy.getElementType(),
+                              targetEncoding),
+        srcTy.getShape());
+    if (!ret ||
+        triton::gpu::getRenamingEncoding(
+            RankedTensorType::get(srcTy.getShape(), srcTy.getElementType(),
+                                  ret),
+            dstTy.getShape()) != targetEncoding)
+      return failure();
   }
   return success();
 }
@@ -113,7 +137,8 @@ bool isExpensiveToRemat(Operation *op, Attribute &targetEncoding) {
     return triton::gpu::isExpensiveCat(cast<triton::CatOp>(op), targetEncoding);
   if (isa<tensor::ExtractSliceOp, triton::gpu::AllocTensorOp,
           triton::gpu::InsertSliceAsyncOp, triton::AtomicRMWOp,
-          triton::AtomicCASOp, triton::DotOp>(op))
+          triton::AtomicCASOp, triton::DotOp, triton::SparseDotOp,
+          triton::BlockLoadOp, triton::TMALoadOp>(op))
     return true;
   if (isa<scf::YieldOp, scf::ForOp, scf::IfOp, scf::WhileOp, scf::ConditionOp>(
           op))
@@ -125,8 +150,10 @@ bool canFoldConversion(Operation *op, Attribute &targetEncoding) {
   if (isa<triton::CatOp>(op))
     return !triton::gpu::isExpensiveCat(cast<triton::CatOp>(op),
                                         targetEncoding);
+  if (auto view = dyn_cast<triton::ViewOp>(op))
+    return !triton::gpu::isExpensiveView(view, targetEncoding);
   return isa<triton::gpu::ConvertLayoutOp, arith::ConstantOp,
-             triton::MakeRangeOp, triton::SplatOp, triton::ViewOp>(op);
+             triton::MakeRangeOp, triton::SplatOp>(op);
 }
 
 int simulateBackwardRematerialization(
@@ -208,6 +235,13 @@ Operation *cloneWithInferType(mlir::OpBuilder &rewriter, Operation *op,
     return newOp;
   auto newType = RankedTensorType::get(
       origType.getShape(), origType.getElementType(), argType.getEncoding());
+  // views and concatenations rename the registers of their operands into a
+  // tensor of another shape
+  if (isa<triton::ViewOp, triton::CatOp>(newOp))
+    if (Attribute encoding =
+            triton::gpu::getRenamingEncoding(argType, origType.getShape()))
+      newType = RankedTensorType::get(origType.getShape(),
+                                      origType.getElementType(), encoding);
   newOp->getResult(0).setType(newType);
   auto typeInfer = dyn_cast<InferTypeOpInterface>(newOp);
   if (typeInfer) {
@@ -0,0 +1,444 @@
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+//===----------------------------------------------------------------------===//
+// This file splits the warps of kernels into a consumer group, which runs the
+// kernel, and a producer group, which streams the dot operands loaded by one
+// of its top-level loops into shared memory:
+//
+// %group = triton_gpu.get_warp_group_id
+// %a_buffer = triton_gpu.alloc_tensor  (numStages x tile)
+// (ops both groups need, free of side effects)
+// scf.if %group == 1 {
+//   scf.for %i ... {
+//     (wait for the consumer to release slot %i % numStages)
+//     (pointer computations of the loop)
+//     %a_buffer' = insert_slice_async %a_ptr, %a_buffer, %i % numStages
+//     async_commit_group
+//     async_wait {num = numStages - 1}
+//     (signal that slot (%i - numStages + 1) % numStages is full)
+//   }
+//   (signal the last slots, and consume the last releases)
+// } else {
+//   (original kernel, with the loop reading the slots)
+//   scf.for %i ... {
+//     (wait for slot %i % numStages to be full)
+//     %a = extract_slice %a_buffer[%i % numStages]
+//     (loads replaced by %a)
+//     (release slot %i % numStages)
+//   }
+// }
+//
+// The groups synchronize through named barriers, a full and an empty one per
+// slot, so that the MMA warps neither issue the copies nor hold the registers
+// of their addresses. Both groups have `num-warps` warps and see the thread
+// ids of a CTA of their own (see `triton_gpu.get_warp_group_id`), so that the
+// layouts of the kernel apply to the producer too.
+//===----------------------------------------------------------------------===//
+
+using namespace mlir;
+namespace ttg = triton::gpu;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+#define int_attr(num) builder.getI64IntegerAttr(num)
+
+namespace {
+
+constexpr int kNumWarpGroups = 2;
+constexpr int kProducerGroup = 1;
+// First of the barriers left to the full and empty barriers of the slots
+constexpr int kFirstSlotBarrier = kNumWarpGroups + 1;
+constexpr int kMaxNumStages =
+    (ttg::NamedBarrierArriveOp::kMaxNumBarriers - kFirstSlotBarrier) / 2;
+
+bool isPureOp(Operation *op) {
+  return op->getNumRegions() == 0 && isMemoryEffectFree(op);
+}
+
+Value createI32(OpBuilder &builder, Location loc, int64_t value) {
+  return builder.create<arith::ConstantIntOp>(loc, value, 32);
+}
+
+class WarpSpecializer {
+  triton::FuncOp funcOp;
+  scf::ForOp forOp;
+  int numStages;
+  /// Threads of both groups, which all take part in the slot barriers
+  int numThreads;
+  ModuleAxisInfoAnalysis &axisInfoAnalysis;
+
+  /// Loads of dot operands, streamed by the producer
+  SmallVector<triton::LoadOp> loads;
+  /// Loop ops computing the operands of the loads
+  DenseSet<Operation *> producerOps;
+  /// Loop-carried values they depend on
+  SmallVector<unsigned> producerArgs;
+  /// Ops outside of the loop the producer depends on, run by both groups
+  DenseSet<Operation *> sharedOps;
+
+  /// Add the ops `values` depend on to `producerOps` and `sharedOps`
+  LogicalResult collectDeps(SmallVector<Value> values);
+
+  RankedTensorType getBufferType(triton::LoadOp loadOp);
+
+  Value getBarrier(OpBuilder &builder, Location loc, Value slot, bool full);
+
+  /// Build `for j = max(numIters - count, 0) to numIters: fn(j % numStages)`
+  void createTailLoop(OpBuilder &builder, Location loc, Value numIters,
+                      int count,
+                      function_ref<void(OpBuilder &, Value)> fn);
+
+  void createProducer(OpBuilder &builder, ArrayRef<Value> buffers);
+
+  void rewriteConsumer(ArrayRef<Value> buffers);
+
+public:
+  WarpSpecializer(triton::FuncOp funcOp, scf::ForOp forOp, int numStages,
+                  int numThreads, ModuleAxisInfoAnalysis &axisInfoAnalysis)
+      : funcOp(funcOp), forOp(forOp), numStages(numStages),
+        numThreads(numThreads), axisInfoAnalysis(axisInfoAnalysis) {}
+
+  /// Collect the loads to stream. Return success if the kernel can be
+  /// specialized on this loop
+  LogicalResult initialize();
+
+  void specialize();
+};
+
+LogicalResult WarpSpecializer::collectDeps(SmallVector<Value> values) {
+  DenseSet<unsigned> visitedArgs;
+  while (!values.empty()) {
+    Value v = values.pop_back_val();
+    if (!v)
+      continue;
+    Operation *def = v.getDefiningOp();
+    if (auto arg = v.dyn_cast<BlockArgument>()) {
+      // Function arguments, or the induction variable
+      if (arg.getOwner() != forOp.getBody() || arg.getArgNumber() == 0)
+        continue;
+      unsigned idx = arg.getArgNumber() - 1;
+      if (visitedArgs.insert(idx).second) {
+        producerArgs.push_back(idx);
+        values.push_back(forOp.getBody()->getTerminator()->getOperand(idx));
+        values.push_back(forOp.getInitArgs()[idx]);
+      }
+      continue;
+    }
+    // Both groups run these ops, or the producer recomputes them
+    if (!isPureOp(def))
+      return failure();
+    DenseSet<Operation *> &ops =
+        forOp->isAncestor(def) ? producerOps : sharedOps;
+    if (ops.insert(def).second)
+      values.append(def->operand_begin(), def->operand_end());
+  }
+  llvm::sort(producerArgs);
+  return success();
+}
+
+LogicalResult WarpSpecializer::initialize() {
+  if (numStages < 2)
+    return failure();
+  // The consumer group takes the whole body of the kernel
+  if (!funcOp.isPublic() || !funcOp.getBody().hasOneBlock() ||
+      funcOp.getNumResults() != 0 ||
+      forOp->getBlock() != &funcOp.getBody().front())
+    return failure();
+
+  for (Operation &op : forOp.getBody()->without_terminator()) {
+    auto loadOp = dyn_cast<triton::LoadOp>(op);
+    if (!loadOp || !loadOp->hasOneUse())
+      continue;
+    auto cvt = dyn_cast<ttg::ConvertLayoutOp>(*loadOp->getUsers().begin());
+    if (!cvt || !cvt.getType()
+                     .cast<RankedTensorType>()
+                     .getEncoding()
+                     .isa<ttg::DotOperandEncodingAttr>())
+      continue;
+    auto ty = loadOp.getType().dyn_cast<RankedTensorType>();
+    if (!ty || ty.getRank() != 2 ||
+        !ty.getEncoding().isa<ttg::BlockedEncodingAttr>())
+      continue;
+    // Copies of less than 4 bytes can't be asynchronous
+    unsigned vec = axisInfoAnalysis.getPtrContiguity(loadOp.getPtr());
+    if (auto mask = loadOp.getMask())
+      vec = std::min<unsigned>(vec, axisInfoAnalysis.getMaskAlignment(mask));
+    if (vec * ty.getElementType().getIntOrFloatBitWidth() < 32)
+      continue;
+    loads.push_back(loadOp);
+  }
+  if (loads.empty())
+    return failure();
+
+  SmallVector<Value> values = {forOp.getLowerBound(), forOp.getUpperBound(),
+                               forOp.getStep()};
+  for (triton::LoadOp loadOp : loads)
+    values.append({loadOp.getPtr(), loadOp.getMask(), loadOp.getOther()});
+  return collectDeps(values);
+}
+
+RankedTensorType WarpSpecializer::getBufferType(triton::LoadOp loadOp) {
+  auto ty = loadOp.getType().cast<RankedTensorType>();
+  auto cvt = cast<ttg::ConvertLayoutOp>(*loadOp->getUsers().begin());
+  auto dotOpEnc = cvt.getType()
+                      .cast<RankedTensorType>()
+                      .getEncoding()
+                      .cast<ttg::DotOperandEncodingAttr>();
+  unsigned bitWidth = ty.getElementType().getIntOrFloatBitWidth();
+  auto sharedEnc =
+      ttg::SharedEncodingAttr::get(ty.getContext(), dotOpEnc, ty.getShape(),
+                                   ttg::getOrder(ty.getEncoding()), bitWidth);
+  SmallVector<int64_t> bufferShape(ty.getShape().begin(), ty.getShape().end());
+  bufferShape.insert(bufferShape.begin(), numStages);
+  return RankedTensorType::get(bufferShape, ty.getElementType(), sharedEnc);
+}
+
+Value WarpSpecializer::getBarrier(OpBuilder &builder, Location loc, Value slot,
+                                  bool full) {
+  int first = kFirstSlotBarrier + (full ? 0 : numStages);
+  return builder.create<arith::AddIOp>(loc, slot,
+                                       createI32(builder, loc, first));
+}
+
+void WarpSpecializer::createTailLoop(
+    OpBuilder &builder, Location loc, Value numIters, int count,
+    function_ref<void(OpBuilder &, Value)> fn) {
+  Value lb = builder.create<arith::MaxSIOp>(
+      loc,
+      builder.create<arith::SubIOp>(loc, numIters,
+                                    createI32(builder, loc, count)),
+      createI32(builder, loc, 0));
+  auto loop = builder.create<scf::ForOp>(loc, lb, numIters,
+                                         createI32(builder, loc, 1));
+  OpBuilder bodyBuilder = OpBuilder::atBlockTerminator(loop.getBody());
+  fn(bodyBuilder,
+     bodyBuilder.create<arith::RemUIOp>(
+         loc, loop.getInductionVar(), createI32(bodyBuilder, loc, numStages)));
+}
+
+void WarpSpecializer::createProducer(OpBuilder &builder,
+                                     ArrayRef<Value> buffers) {
+  Location loc = forOp.getLoc();
+  // Order of args:
+  //   (loop-carried values the loads depend on)
+  //   (buffer) for each load
+  //   (iteration index)
+  SmallVector<Value> initArgs;
+  for (unsigned idx : producerArgs)
+    initArgs.push_back(forOp.getInitArgs()[idx]);
+  initArgs.append(buffers.begin(), buffers.end());
+  initArgs.push_back(createI32(builder, loc, 0));
+  auto loop = builder.create<scf::ForOp>(loc, forOp.getLowerBound(),
+                                         forOp.getUpperBound(),
+                                         forOp.getStep(), initArgs);
+  auto loopArgs = loop.getRegionIterArgs();
+  IRMapping mapping;
+  mapping.map(forOp.getInductionVar(), loop.getInductionVar());
+  for (size_t i = 0; i < producerArgs.size(); ++i)
+    mapping.map(forOp.getRegionIterArgs()[producerArgs[i]], loopArgs[i]);
+
+  OpBuilder bodyBuilder = OpBuilder::atBlockBegin(loop.getBody());
+  Value iter = loopArgs.back();
+  Value stages = createI32(bodyBuilder, loc, numStages);
+  Value slot = bodyBuilder.create<arith::RemUIOp>(loc, iter, stages);
+  // Once every slot has been filled, wait for the consumer to release them
+  Value isReused = bodyBuilder.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::uge, iter, stages);
+  auto waitIf = bodyBuilder.create<scf::IfOp>(loc, isReused,
+                                              /*withElseRegion=*/false);
+  OpBuilder waitBuilder = waitIf.getThenBodyBuilder();
+  waitBuilder.create<ttg::NamedBarrierWaitOp>(
+      loc, getBarrier(waitBuilder, loc, slot, /*full=*/false), numThreads);
+
+  for (Operation &op : forOp.getBody()->without_terminator())
+    if (producerOps.contains(&op))
+      bodyBuilder.clone(op, mapping);
+  SmallVector<Value> nextBuffers;
+  for (size_t i = 0; i < loads.size(); ++i) {
+    triton::LoadOp loadOp = loads[i];
+    nextBuffers.push_back(bodyBuilder.create<ttg::InsertSliceAsyncOp>(
+        loadOp.getLoc(), buffers[i].getType(),
+        mapping.lookupOrDefault(loadOp.getPtr()),
+        loopArgs[producerArgs.size() + i], slot,
+        mapping.lookupOrDefault(loadOp.getMask()),
+        mapping.lookupOrDefault(loadOp.getOther()), loadOp.getCache(),
+        loadOp.getEvict(), loadOp.getIsVolatile(), /*axis*/ 0,
+        loadOp.getL2Evict()));
+  }
+  bodyBuilder.create<ttg::AsyncCommitGroupOp>(loc);
+
+  // Keep the copies of `numStages - 1` iterations in flight, and signal the
+  // slot of the oldest one once it has landed
+  int lag = numStages - 1;
+  bodyBuilder.create<ttg::AsyncWaitOp>(loc, lag);
+  Value lagVal = createI32(bodyBuilder, loc, lag);
+  Value hasLanded = bodyBuilder.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::uge, iter, lagVal);
+  auto arriveIf = bodyBuilder.create<scf::IfOp>(loc, hasLanded,
+                                                /*withElseRegion=*/false);
+  OpBuilder arriveBuilder = arriveIf.getThenBodyBuilder();
+  Value landedSlot = arriveBuilder.create<arith::RemUIOp>(
+      loc, arriveBuilder.create<arith::SubIOp>(loc, iter, lagVal), stages);
+  arriveBuilder.create<ttg::NamedBarrierArriveOp>(
+      loc, getBarrier(arriveBuilder, loc, landedSlot, /*full=*/true),
+      numThreads);
+
+  SmallVector<Value> yieldValues;
+  Operation *yieldOp = forOp.getBody()->getTerminator();
+  for (unsigned idx : producerArgs)
+    yieldValues.push_back(mapping.lookupOrDefault(yieldOp->getOperand(idx)));
+  yieldValues.append(nextBuffers);
+  yieldValues.push_back(bodyBuilder.create<arith::AddIOp>(
+      loc, iter, createI32(bodyBuilder, loc, 1)));
+  bodyBuilder.create<scf::YieldOp>(loc, yieldValues);
+
+  // Signal the slots of the copies still in flight, then consume the
+  // releases of the last slots so that every barrier completes
+  Value numIters = loop.getResults().back();
+  builder.create<ttg::AsyncWaitOp>(loc, 0);
+  createTailLoop(builder, loc, numIters, lag, [&](OpBuilder &b, Value slot) {
+    b.create<ttg::NamedBarrierArriveOp>(
+        loc, getBarrier(b, loc, slot, /*full=*/true), numThreads);
+  });
+  createTailLoop(builder, loc, numIters, numStages,
+                 [&](OpBuilder &b, Value slot) {
+                   b.create<ttg::NamedBarrierWaitOp>(
+                       loc, getBarrier(b, loc, slot, /*full=*/false),
+                       numThreads);
+                 });
+}
+
+void WarpSpecializer::rewriteConsumer(ArrayRef<Value> buffers) {
+  Location loc = forOp.getLoc();
+  OpBuilder builder = OpBuilder::atBlockBegin(forOp.getBody());
+  // Index of the iteration, as an i32
+  Value iter = builder.create<arith::DivUIOp>(
+      loc,
+      builder.create<arith::SubIOp>(loc, forOp.getInductionVar(),
+                                    forOp.getLowerBound()),
+      forOp.getStep());
+  Type i32Ty = builder.getI32Type();
+  if (iter.getType().isIndex())
+    iter = builder.create<arith::IndexCastOp>(loc, i32Ty, iter);
+  else if (iter.getType().getIntOrFloatBitWidth() > 32)
+    iter = builder.create<arith::TruncIOp>(loc, i32Ty, iter);
+  else if (iter.getType().getIntOrFloatBitWidth() < 32)
+    iter = builder.create<arith::ExtUIOp>(loc, i32Ty, iter);
+  Value slot = builder.create<arith::RemUIOp>(
+      loc, iter, createI32(builder, loc, numStages));
+  builder.create<ttg::NamedBarrierWaitOp>(
+      loc, getBarrier(builder, loc, slot, /*full=*/true), numThreads);
+
+  for (size_t i = 0; i < loads.size(); ++i) {
+    triton::LoadOp loadOp = loads[i];
+    auto bufferType = buffers[i].getType().cast<RankedTensorType>();
+    auto bufferShape = bufferType.getShape();
+    auto sliceType = RankedTensorType::get({bufferShape[1], bufferShape[2]},
+                                           bufferType.getElementType(),
+                                           bufferType.getEncoding());
+    Value extractSlice = builder.create<ttg::ExtractSliceOp>(
+        loadOp.getLoc(), sliceType, buffers[i],
+        SmallVector<OpFoldResult>{slot, int_attr(0), int_attr(0)},
+        SmallVector<OpFoldResult>{int_attr(1),
+                                  int_attr(sliceType.getShape()[0]),
+                                  int_attr(sliceType.getShape()[1])},
+        SmallVector<OpFoldResult>{int_attr(1), int_attr(1), int_attr(1)});
+    // The dot operand is read from the slot instead
+    loadOp.getResult().replaceAllUsesWith(extractSlice);
+    loadOp.erase();
+  }
+
+  // The slot is released once the dot operands have been read from it
+  builder.setInsertionPoint(forOp.getBody()->getTerminator());
+  builder.create<ttg::NamedBarrierArriveOp>(
+      loc, getBarrier(builder, loc, slot, /*full=*/false), numThreads);
+}
+
+void WarpSpecializer::specialize() {
+  Block &entry = funcOp.getBody().front();
+  SmallVector<Operation *> consumerOps;
+  for (Operation &op : entry.without_terminator())
+    if (!sharedOps.contains(&op))
+      consumerOps.push_back(&op);
+
+  Location loc = forOp.getLoc();
+  OpBuilder builder = OpBuilder::atBlockBegin(&entry);
+  Value groupId =
+      builder.create<ttg::GetWarpGroupIdOp>(loc, builder.getI32Type());
+  SmallVector<Value> buffers;
+  for (triton::LoadOp loadOp : loads)
+    buffers.push_back(
+        builder.create<ttg::AllocTensorOp>(loadOp.getLoc(),
+                                           getBufferType(loadOp)));
+
+  builder.setInsertionPoint(entry.getTerminator());
+  Value isProducer = builder.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::eq, groupId,
+      createI32(builder, loc, kProducerGroup));
+  auto ifOp = builder.create<scf::IfOp>(loc, isProducer,
+                                        /*withElseRegion=*/true);
+  OpBuilder thenBuilder = ifOp.getThenBodyBuilder();
+  createProducer(thenBuilder, buffers);
+  Operation *elseYield = ifOp.elseBlock()->getTerminator();
+  for (Operation *op : consumerOps)
+    op->moveBefore(elseYield);
+  rewriteConsumer(buffers);
+}
+
+struct WarpSpecializePass
+    : public TritonGPUWarpSpecializeBase<WarpSpecializePass> {
+  WarpSpecializePass() = default;
+  WarpSpecializePass(int numStages) { this->numStages = numStages; }
+
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    if (ttg::TritonGPUDialect::getNumWarpGroups(mod) > 1) {
+      markAllAnalysesPreserved();
+      return;
+    }
+    // Both groups take part in the barriers of the slots
+    int numThreads = kNumWarpGroups * ttg::TritonGPUDialect::getNumWarps(mod) *
+                     ttg::TritonGPUDialect::getThreadsPerWarp(mod);
+    int stages = std::min<int>(numStages, kMaxNumStages);
+    ModuleAxisInfoAnalysis &axisInfoAnalysis =
+        getAnalysis<ModuleAxisInfoAnalysis>();
+
+    SmallVector<WarpSpecializer> specializers;
+    mod.walk([&](triton::FuncOp funcOp) {
+      if (funcOp.getBody().empty())
+        return;
+      for (auto forOp : funcOp.getBody().front().getOps<scf::ForOp>()) {
+        WarpSpecializer specializer(funcOp, forOp, stages, numThreads,
+                                    axisInfoAnalysis);
+        if (specializer.initialize().succeeded()) {
+          specializers.push_back(std::move(specializer));
+          break;
+        }
+      }
+    });
+    if (specializers.empty()) {
+      markAllAnalysesPreserved();
+      return;
+    }
+    for (WarpSpecializer &specializer : specializers)
+      specializer.specialize();
+    mod->setAttr(ttg::TritonGPUDialect::getNumWarpGroupsAttrName(),
+                 IntegerAttr::get(IntegerType::get(mod.getContext(), 32),
+                                  kNumWarpGroups));
+  }
+};
+
+} // anonymous namespace
+
+std::unique_ptr<Pass> mlir::createTritonGPUWarpSpecializePass(int numStages) {
+  return std::make_unique<WarpSpecializePass>(numStages);
+}
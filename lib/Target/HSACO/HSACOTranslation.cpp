@@ -23,6 +23,10 @@
 #include "llvm/MC/TargetRegistry.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_ostream.h"
@@ -30,10 +34,17 @@
 #include "llvm/Target/TargetOptions.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Utils/Cloning.h"
-#include <filesystem>
 #include <iostream>
 #include <memory>
-#include <random>
+#include <mutex>
+
+#ifdef TRITON_USE_LLD
+#include "lld/Common/CommonLinkerContext.h"
+#include "lld/Common/Driver.h"
+#ifdef LLD_HAS_DRIVER
+LLD_HAS_DRIVER(elf)
+#endif
+#endif
 
 namespace {
 
@@ -97,58 +108,106 @@ std::string generate_amdgcn_assembly(llvm::Module *module,
   return amdgcn;
 }
 
+// Links the ISA object at `isabin_path` into the shared object at
+// `hsaco_path` with the lld library, without spawning a process.
+bool link_hsaco_in_process(const std::string &isabin_path,
+                           const std::string &hsaco_path,
+                           std::string &error_message) {
+#ifdef TRITON_USE_LLD
+  std::string log;
+  llvm::raw_string_ostream log_os(log);
+  const char *args[] = {"ld.lld", "-shared", "-o", hsaco_path.c_str(),
+                        isabin_path.c_str()};
+  // The lld driver is not reentrant.
+  static std::mutex lld_mutex;
+  std::lock_guard<std::mutex> guard(lld_mutex);
+  bool ok = lld::elf::link(args, log_os, log_os, /*exitEarly=*/false,
+                           /*disableOutput=*/false);
+  lld::CommonLinkerContext::destroy();
+  error_message = log_os.str();
+  return ok;
+#else
+  error_message = "triton was built without TRITON_USE_LLD";
+  return false;
+#endif
+}
+
+// Links with the external ld.lld, TRITON_HIP_LLD_PATH or the one of ROCm.
+bool link_hsaco_with_binary(const std::string &isabin_path,
+                            const std::string &hsaco_path,
+                            std::string &error_message) {
+  std::string lld_path = ::triton::tools::getenv("TRITON_HIP_LLD_PATH");
+  if (lld_path.empty())
+    lld_path = "/opt/rocm/llvm/bin/ld.lld";
+  int lld_result = llvm::sys::ExecuteAndWait(
+      lld_path,
+      {lld_path, "-flavor", "gnu", "-shared", "-o", hsaco_path, isabin_path},
+      std::nullopt, {}, 0, 0, &error_message);
+  return lld_result == 0;
+}
+
 std::string generate_hsaco(llvm::Module *module, const std::string &triple,
                            const std::string &proc,
                            const std::string &features) {
   auto machine = initialize_module(module, triple, proc, features);
 
-  // create unique dir for kernel's binary and hsaco
-  std::error_code ec;
-  std::string kernel_name_base = "amd_triton_kernel";
-  std::filesystem::path tmp = std::filesystem::temp_directory_path();
-  std::filesystem::path kernel_dir_base(kernel_name_base);
-  llvm::SmallString<256> unique_dir;
-  ec = llvm::sys::fs::createUniqueDirectory((tmp / kernel_dir_base).string(),
-                                            unique_dir);
-  if (ec) {
-    std::cerr << "Directory for " << kernel_name_base
-              << " was not created. error code: " << ec << std::endl;
-  }
-  std::filesystem::path kernel_dir(unique_dir.data());
-  std::string kernel_name = kernel_dir.stem();
-
-  // Save GCN ISA binary.
-  std::filesystem::path isa_binary(kernel_name + ".o");
-  std::string isabin_path = (kernel_dir / isa_binary).string();
-  std::unique_ptr<llvm::raw_fd_ostream> isabin_fs(
-      new llvm::raw_fd_ostream(isabin_path, ec, llvm::sys::fs::OF_Text));
-  if (ec) {
-    std::cerr << isabin_path << " was not created. error code: " << ec
-              << std::endl;
+  // emit the GCN ISA object in memory
+  llvm::SmallVector<char, 0> isabin;
+  {
+    llvm::raw_svector_ostream stream(isabin);
+    llvm::legacy::PassManager pass;
+    machine->addPassesToEmitFile(pass, stream, nullptr,
+                                 llvm::CGFT_ObjectFile);
+    pass.run(*module);
   }
 
-  // emit
-  llvm::legacy::PassManager pass;
-  machine->addPassesToEmitFile(pass, *isabin_fs, nullptr,
-                               llvm::CGFT_ObjectFile);
-  pass.run(*module);
+  // The lld driver reads its inputs and writes its output by path, so the
+  // object goes through a scratch directory, removed once linked.
+  llvm::SmallString<256> kernel_dir_base;
+  llvm::sys::path::system_temp_directory(/*erasedOnReboot=*/true,
+                                         kernel_dir_base);
+  llvm::sys::path::append(kernel_dir_base, "amd_triton_kernel");
+  llvm::SmallString<256> kernel_dir;
+  if (std::error_code ec =
+          llvm::sys::fs::createUniqueDirectory(kernel_dir_base, kernel_dir))
+    llvm::report_fatal_error("Directory for the HSACO was not created: " +
+                             ec.message());
+  llvm::SmallString<256> isabin_path(kernel_dir);
+  llvm::sys::path::append(isabin_path, "kernel.o");
+  llvm::SmallString<256> hsaco_path(kernel_dir);
+  llvm::sys::path::append(hsaco_path, "kernel.hsaco");
+  {
+    std::error_code ec;
+    llvm::raw_fd_ostream isabin_fs(isabin_path, ec, llvm::sys::fs::OF_None);
+    if (ec)
+      llvm::report_fatal_error(llvm::Twine(isabin_path) +
+                               " was not created: " + ec.message());
+    isabin_fs << llvm::StringRef(isabin.data(), isabin.size());
+  }
 
-  // generate HASCO file
-  std::filesystem::path hsaco(kernel_name + ".hsaco");
-  std::string hsaco_path = (kernel_dir / hsaco).string();
   std::string error_message;
-  std::string lld_path = "/opt/rocm/llvm/bin/ld.lld";
-  int lld_result = llvm::sys::ExecuteAndWait(
-      lld_path,
-      {lld_path, "-flavor", "gnu", "-shared", "-o", hsaco_path, isabin_path},
-      std::nullopt, {}, 0, 0, &error_message);
-  if (lld_result) {
-    std::cout << "ld.lld execute fail: " << std::endl;
-    std::cout << error_message << std::endl;
-    std::cout << lld_result << std::endl;
+  bool linked = link_hsaco_in_process(isabin_path.str().str(),
+                                      hsaco_path.str().str(), error_message);
+  if (!linked) {
+    std::string in_process_error = error_message;
+    linked = link_hsaco_with_binary(isabin_path.str().str(),
+                                    hsaco_path.str().str(), error_message);
+    if (!linked)
+      error_message = in_process_error + "\n" + error_message;
   }
 
-  return hsaco_path;
+  std::string hsaco;
+  if (linked) {
+    auto buffer = llvm::MemoryBuffer::getFile(hsaco_path);
+    if (buffer)
+      hsaco = (*buffer)->getBuffer().str();
+    else
+      error_message = buffer.getError().message();
+  }
+  llvm::sys::fs::remove_directories(kernel_dir);
+  if (hsaco.empty())
+    llvm::report_fatal_error("Failed to link the HSACO: " + error_message);
+  return hsaco;
 }
 
 std::tuple<std::string, std::string>
@@ -161,10 +220,10 @@ llir_to_amdgcn_and_hsaco(llvm::Module *module, std::string gfx_arch,
   auto module_obj = llvm::CloneModule(*module);
   auto amdgcn =
       generate_amdgcn_assembly(module, gfx_triple, gfx_arch, gfx_features);
-  auto hsaco_path =
+  auto hsaco =
       generate_hsaco(module_obj.get(), gfx_triple, gfx_arch, gfx_features);
 
-  return std::make_tuple(amdgcn, hsaco_path);
+  return std::make_tuple(amdgcn, hsaco);
 }
 
 } // namespace
@@ -22,10 +22,15 @@
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/IR/CallingConv.h"
 #include "llvm/IR/Constants.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Operator.h"
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Linker/Linker.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -33,8 +38,10 @@
 #else
 #include <dlfcn.h>
 #endif
+#include <chrono>
 #include <filesystem>
 #include <iterator>
+#include <mutex>
 
 namespace fs = std::filesystem;
 
@@ -45,6 +52,9 @@ namespace triton {
 // information from mlir module.
 struct NVVMMetadata {
   SmallVector<int, 3> maxntid;
+  // 0 when not bounded
+  int maxnreg{};
+  int minctasm{};
   bool isKernel{};
   // Free to extend with other information.
 };
@@ -80,6 +90,20 @@ static void amendLLVMFunc(llvm::Function *func, const NVVMMetadata &metadata,
         ->addOperand(llvm::MDNode::get(ctx, md_args));
   }
 
+  auto addAnnotation = [&](StringRef name, int value) {
+    llvm::Metadata *mdArgs[] = {
+        llvm::ValueAsMetadata::get(func), llvm::MDString::get(ctx, name),
+        llvm::ValueAsMetadata::get(
+            llvm::ConstantInt::get(llvm::Type::getInt32Ty(ctx), value))};
+    module->getOrInsertNamedMetadata("nvvm.annotations")
+        ->addOperand(llvm::MDNode::get(ctx, mdArgs));
+  };
+  // Become the .maxnreg and .minnctapersm directives of the PTX kernel
+  if (!isROCM && metadata.maxnreg > 0)
+    addAnnotation("maxnreg", metadata.maxnreg);
+  if (!isROCM && metadata.minctasm > 0)
+    addAnnotation("minctasm", metadata.minctasm);
+
   if (metadata.isKernel) {
     if (isROCM) {
       func->setCallingConv(llvm::CallingConv::AMDGPU_KERNEL);
@@ -111,6 +135,16 @@ extractNVVMMetadata(mlir::ModuleOp module,
       hasMetadata = true;
     }
 
+    // launch bounds
+    if (auto attr = op->getAttrOfType<IntegerAttr>("nvvm.maxnreg")) {
+      meta.maxnreg = attr.getInt();
+      hasMetadata = true;
+    }
+    if (auto attr = op->getAttrOfType<IntegerAttr>("nvvm.minctasm")) {
+      meta.minctasm = attr.getInt();
+      hasMetadata = true;
+    }
+
     // kernel
     if (op->hasAttr("nvvm.kernel")) {
       meta.isKernel = true;
@@ -235,12 +269,70 @@ static void linkLibdevice(llvm::Module &module) {
   module.addModuleFlag(reflect);
 }
 
+// Relaxes the floating-point semantics of `module` like nvcc's
+// --use_fast_math: denormals are flushed to zero, and operations may be
+// approximated, reassociated, contracted and turned into reciprocals. NaNs
+// and infinities keep their semantics.
+static void setFastMath(llvm::Module &module) {
+  for (llvm::Function &func : module) {
+    if (func.isDeclaration())
+      continue;
+    func.addFnAttr("unsafe-fp-math", "true");
+    func.addFnAttr("denormal-fp-math-f32", "preserve-sign,preserve-sign");
+    for (llvm::Instruction &inst : llvm::instructions(func)) {
+      if (!isa<llvm::FPMathOperator>(inst))
+        continue;
+      inst.setHasAllowReassoc(true);
+      inst.setHasAllowReciprocal(true);
+      inst.setHasAllowContract(true);
+      inst.setHasApproxFunc(true);
+    }
+  }
+}
+
+// Loads the external library at `path` into `ctx`.
+// The file is read from disk once per process and kept in memory. Bitcode
+// modules are loaded lazily, so that linking with LinkOnlyNeeded only
+// materializes the functions the kernel actually references instead of
+// parsing the whole library (libdevice has hundreds of functions) for every
+// kernel.
+static std::unique_ptr<llvm::Module> loadExternLib(llvm::StringRef path,
+                                                   llvm::LLVMContext &ctx) {
+  static std::mutex mutex;
+  static llvm::StringMap<std::unique_ptr<llvm::MemoryBuffer>> buffers;
+  llvm::MemoryBufferRef buffer;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &cached = buffers[path];
+    if (!cached) {
+      auto fileOrErr = llvm::MemoryBuffer::getFile(path);
+      if (!fileOrErr)
+        return nullptr;
+      cached = std::move(*fileOrErr);
+    }
+    buffer = cached->getMemBufferRef();
+  }
+
+  if (llvm::isBitcode(
+          reinterpret_cast<const unsigned char *>(buffer.getBufferStart()),
+          reinterpret_cast<const unsigned char *>(buffer.getBufferEnd()))) {
+    auto moduleOrErr = llvm::getLazyBitcodeModule(buffer, ctx);
+    if (!moduleOrErr) {
+      llvm::consumeError(moduleOrErr.takeError());
+      return nullptr;
+    }
+    return std::move(*moduleOrErr);
+  }
+  // textual IR can't be loaded lazily
+  llvm::SMDiagnostic err;
+  return llvm::parseIR(buffer, err, ctx);
+}
+
 static bool linkExternLib(llvm::Module &module, llvm::StringRef name,
                           llvm::StringRef path, bool isROCM) {
-  llvm::SMDiagnostic err;
   auto &ctx = module.getContext();
 
-  auto extMod = llvm::parseIRFile(path, err, ctx);
+  auto extMod = loadExternLib(path, ctx);
   if (!extMod) {
     llvm::errs() << "Failed to load " << path;
     return true;
@@ -268,9 +360,17 @@ static bool linkExternLib(llvm::Module &module, llvm::StringRef name,
   return false;
 }
 
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
 std::unique_ptr<llvm::Module>
 translateLLVMToLLVMIR(llvm::LLVMContext *llvmContext, mlir::ModuleOp module,
-                      bool isROCM) {
+                      bool isROCM, bool fastMath, int optLevel,
+                      TranslationTimings *timings) {
+  auto start = std::chrono::steady_clock::now();
   DialectRegistry registry;
   mlir::registerBuiltinDialectTranslation(registry);
   mlir::registerLLVMDialectTranslation(registry);
@@ -300,15 +400,24 @@ translateLLVMToLLVMIR(llvm::LLVMContext *llvmContext, mlir::ModuleOp module,
     if (linkExternLib(*llvmModule, lib.first, lib.second, isROCM))
       return nullptr;
   }
+  // After linking, so that the library functions are relaxed too
+  if (fastMath)
+    setFastMath(*llvmModule);
+
+  if (timings)
+    timings->translation += secondsSince(start);
 
+  start = std::chrono::steady_clock::now();
   auto optPipeline = mlir::makeOptimizingTransformer(
-      /*optLevel=*/3, /*sizeLevel=*/0,
+      optLevel, /*sizeLevel=*/0,
       /*targetMachine=*/nullptr);
 
   if (auto err = optPipeline(llvmModule.get())) {
     llvm::errs() << "Failed to optimize LLVM IR " << err << "\n";
     return nullptr;
   }
+  if (timings)
+    timings->optimization += secondsSince(start);
 
   for (auto &func : llvmModule->functions()) {
     auto it = nvvmMetadata.find(func.getName());
@@ -322,7 +431,9 @@ translateLLVMToLLVMIR(llvm::LLVMContext *llvmContext, mlir::ModuleOp module,
 std::unique_ptr<llvm::Module>
 translateTritonGPUToLLVMIR(llvm::LLVMContext *llvmContext,
                            mlir::ModuleOp module, int computeCapability,
-                           bool isROCM) {
+                           bool isROCM, bool fastMath, bool printBuffer,
+                           int optLevel, TranslationTimings *timings) {
+  auto start = std::chrono::steady_clock::now();
   mlir::PassManager pm(module->getContext());
   mlir::registerPassManagerCLOptions();
   if (failed(applyPassManagerCLOptions(pm))) {
@@ -344,7 +455,8 @@ translateTritonGPUToLLVMIR(llvm::LLVMContext *llvmContext,
 
   pm.addPass(mlir::createConvertSCFToCFPass());
   pm.addPass(mlir::createConvertIndexToLLVMPass());
-  pm.addPass(createConvertTritonGPUToLLVMPass(computeCapability, isROCM));
+  pm.addPass(createConvertTritonGPUToLLVMPass(computeCapability, isROCM,
+                                              fastMath, printBuffer));
   pm.addPass(mlir::createArithToLLVMConversionPass());
   pm.addPass(mlir::createCanonicalizerPass());
   // Simplify the IR
@@ -357,8 +469,11 @@ translateTritonGPUToLLVMIR(llvm::LLVMContext *llvmContext,
     llvm::errs() << "Pass execution failed";
     return nullptr;
   }
+  if (timings)
+    timings->lowering += secondsSince(start);
 
-  auto llvmIR = translateLLVMToLLVMIR(llvmContext, module, isROCM);
+  auto llvmIR = translateLLVMToLLVMIR(llvmContext, module, isROCM, fastMath,
+                                      optLevel, timings);
   if (!llvmIR) {
     llvm::errs() << "Translate to LLVM IR failed";
     return nullptr;
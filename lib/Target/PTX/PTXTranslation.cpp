@@ -11,8 +11,12 @@
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 
+#include <map>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <tuple>
+#include <vector>
 
 namespace triton {
 
@@ -23,9 +27,78 @@ static void initLLVM() {
     LLVMInitializeNVPTXTarget();
     LLVMInitializeNVPTXTargetMC();
     LLVMInitializeNVPTXAsmPrinter();
+    // This is a process-wide option read when a TargetMachine is created.
+    // Set it once, here, so that concurrent translations never write it.
+    auto options = llvm::cl::getRegisteredOptions();
+    auto *shortPtr =
+        static_cast<llvm::cl::opt<bool> *>(options["nvptx-short-ptr"]);
+    assert(shortPtr);
+    shortPtr->setValue(true);
   });
 }
 
+static llvm::CodeGenOpt::Level getCodeGenOptLevel(int optLevel) {
+  switch (optLevel) {
+  case 0:
+    return llvm::CodeGenOpt::None;
+  case 1:
+    return llvm::CodeGenOpt::Less;
+  case 2:
+    return llvm::CodeGenOpt::Default;
+  default:
+    return llvm::CodeGenOpt::Aggressive;
+  }
+}
+
+// Creating a TargetMachine is expensive, so we keep the ones we created for
+// reuse. A TargetMachine must not be used by several threads at once though,
+// so each configuration has a pool of machines and every translation checks
+// one out for its exclusive use.
+class TargetMachinePool {
+public:
+  // (triple, processor, features, optimization level)
+  using Key = std::tuple<std::string, std::string, std::string, int>;
+
+  std::unique_ptr<llvm::TargetMachine> acquire(const Key &key) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto &machines = idle[key];
+      if (!machines.empty()) {
+        auto machine = std::move(machines.back());
+        machines.pop_back();
+        return machine;
+      }
+    }
+    auto &[triple, proc, features, optLevel] = key;
+    std::string error;
+    auto target = llvm::TargetRegistry::lookupTarget(triple, error);
+    if (!target)
+      return nullptr;
+    llvm::TargetOptions opt;
+    opt.AllowFPOpFusion = llvm::FPOpFusion::Fast;
+    opt.UnsafeFPMath = false;
+    opt.NoInfsFPMath = false;
+    opt.NoNaNsFPMath = true;
+    return std::unique_ptr<llvm::TargetMachine>(target->createTargetMachine(
+        triple, proc, features, opt, llvm::Reloc::PIC_, std::nullopt,
+        getCodeGenOptLevel(optLevel)));
+  }
+
+  void release(const Key &key, std::unique_ptr<llvm::TargetMachine> machine) {
+    std::lock_guard<std::mutex> lock(mutex);
+    idle[key].push_back(std::move(machine));
+  }
+
+private:
+  std::mutex mutex;
+  std::map<Key, std::vector<std::unique_ptr<llvm::TargetMachine>>> idle;
+};
+
+static TargetMachinePool &getTargetMachinePool() {
+  static TargetMachinePool pool;
+  return pool;
+}
+
 static bool findAndReplace(std::string &str, const std::string &begin,
                            const std::string &end, const std::string &target) {
   size_t startReplace = str.find(begin);
@@ -38,18 +111,13 @@ static bool findAndReplace(std::string &str, const std::string &begin,
   return true;
 }
 
-std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version) {
+std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version,
+                                 int optLevel) {
   // LLVM version in use may not officially support target hardware.
   // Supported versions for LLVM 14 are here:
   // https://github.com/llvm/llvm-project/blob/f28c006a5895fc0e329fe15fead81e37457cb1d1/clang/include/clang/Basic/BuiltinsNVPTX.def
   int maxPTX = std::min(82, version);
   int maxCC = std::min(90, cc);
-  // options
-  auto options = llvm::cl::getRegisteredOptions();
-  auto *shortPtr =
-      static_cast<llvm::cl::opt<bool> *>(options["nvptx-short-ptr"]);
-  assert(shortPtr);
-  shortPtr->setValue(true);
   std::string sm = cc == 90 ? "sm_90a" : "sm_" + std::to_string(cc);
   // max PTX version
   int ptxMajor = maxPTX / 10;
@@ -69,17 +137,11 @@ std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version) {
 
   // create machine
   module.setTargetTriple(triple);
-  std::string error;
-  auto target =
-      llvm::TargetRegistry::lookupTarget(module.getTargetTriple(), error);
-  llvm::TargetOptions opt;
-  opt.AllowFPOpFusion = llvm::FPOpFusion::Fast;
-  opt.UnsafeFPMath = false;
-  opt.NoInfsFPMath = false;
-  opt.NoNaNsFPMath = true;
-  llvm::TargetMachine *machine = target->createTargetMachine(
-      module.getTargetTriple(), proc, features, opt, llvm::Reloc::PIC_,
-      std::nullopt, llvm::CodeGenOpt::Aggressive);
+  TargetMachinePool::Key key{triple, proc, features, optLevel};
+  auto machine = getTargetMachinePool().acquire(key);
+  if (!machine)
+    llvm::report_fatal_error("failed to create NVPTX target machine for " +
+                             llvm::Twine(proc));
   // set data layout
   if (layout.empty())
     module.setDataLayout(machine->createDataLayout());
@@ -98,6 +160,7 @@ std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version) {
                                  llvm::CodeGenFileType::CGFT_AssemblyFile);
     pass.run(module);
   }
+  getTargetMachinePool().release(key, std::move(machine));
   // post-process
   findAndReplace(result, ".version", "\n",
                  ".version " + std::to_string(ptxMajor) + "." +
@@ -224,6 +224,7 @@ class CMakeBuild(build_ext):
             "-DPython3_EXECUTABLE:FILEPATH=" + sys.executable,
             "-DCMAKE_VERBOSE_MAKEFILE:BOOL=ON",
             "-DPYTHON_INCLUDE_DIRS=" + python_include_dir,
+            "-DPYTHON_EXT_SUFFIX=" + sysconfig.get_config_var("EXT_SUFFIX"),
         ]
         if lit_dir is not None:
             cmake_args.append("-DLLVM_EXTERNAL_LIT=" + lit_dir)
@@ -248,6 +249,12 @@ class CMakeBuild(build_ext):
             max_jobs = os.getenv("MAX_JOBS", str(2 * os.cpu_count()))
             build_args += ['-j' + max_jobs]
 
+        if check_env_flag("TRITON_USE_NVPTXCOMPILER"):
+            cmake_args += ["-DTRITON_USE_NVPTXCOMPILER=ON"]
+
+        if check_env_flag("TRITON_USE_LLD"):
+            cmake_args += ["-DTRITON_USE_LLD=ON"]
+
         if check_env_flag("TRITON_BUILD_WITH_CLANG_LLD"):
             cmake_args += ["-DCMAKE_C_COMPILER=clang",
                            "-DCMAKE_CXX_COMPILER=clang++",
@@ -19,6 +19,8 @@
 #include "mlir/Dialect/Index/IR/IndexOps.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "triton/Analysis/Allocation.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/RegisterPressure.h"
 #include "triton/Conversion/TritonGPUToLLVM/TritonGPUToLLVMPass.h"
 #include "triton/Conversion/TritonToTritonGPU/TritonToTritonGPUPass.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
@@ -42,7 +44,11 @@
 
 #include <Python.h>
 #include <cctype>
+#include <chrono>
+#include <cstring>
 #include <fstream>
+#include <map>
+#include <mutex>
 #include <optional>
 #include <pybind11/buffer_info.h>
 #include <pybind11/functional.h>
@@ -55,6 +61,10 @@
 #include <stdexcept>
 #include <string>
 
+#ifdef TRITON_USE_NVPTXCOMPILER
+#include <nvPTXCompiler.h>
+#endif
+
 namespace py = pybind11;
 
 enum backend_t {
@@ -63,6 +73,70 @@ enum backend_t {
   ROCM,
 };
 
+// Key of one launch argument for the launcher's fast path: tensors map to
+// (dtype, device, data_ptr % 16 == 0), integers to (type, x % 16 == 0,
+// x == 1), bools and floats to their type and constexprs to their value.
+// This is at least as discriminating as the key built by the Python launcher.
+// Returns nullptr, with no Python error set, for anything it can't key.
+static PyObject *launchArgKey(PyObject *arg, bool isConstexpr) {
+  static PyObject *i1 = PyUnicode_InternFromString("i1");
+  static PyObject *i32 = PyUnicode_InternFromString("i32");
+  static PyObject *i64 = PyUnicode_InternFromString("i64");
+  static PyObject *u64 = PyUnicode_InternFromString("u64");
+  static PyObject *fp32 = PyUnicode_InternFromString("fp32");
+  auto pyBool = [](bool b) { return b ? Py_True : Py_False; };
+
+  if (isConstexpr || arg == Py_None) {
+    if (PyObject_Hash(arg) == -1) {
+      PyErr_Clear();
+      return nullptr;
+    }
+    Py_INCREF(arg);
+    return arg;
+  }
+  if (PyBool_Check(arg)) {
+    Py_INCREF(i1);
+    return i1;
+  }
+  if (PyLong_Check(arg)) {
+    int overflow;
+    long long value = PyLong_AsLongLongAndOverflow(arg, &overflow);
+    if (overflow == 0) {
+      bool isI32 = value >= INT32_MIN && value <= INT32_MAX;
+      return Py_BuildValue("(OOO)", isI32 ? i32 : i64, pyBool(value % 16 == 0),
+                           pyBool(value == 1));
+    }
+    if (overflow > 0) {
+      unsigned long long uvalue = PyLong_AsUnsignedLongLong(arg);
+      if (!PyErr_Occurred())
+        return Py_BuildValue("(OOO)", u64, pyBool(uvalue % 16 == 0), Py_False);
+      PyErr_Clear();
+    }
+    return nullptr;
+  }
+  if (PyFloat_Check(arg)) {
+    Py_INCREF(fp32);
+    return fp32;
+  }
+  PyObject *ptr = PyObject_CallMethod(arg, "data_ptr", nullptr);
+  if (!ptr) {
+    PyErr_Clear();
+    return nullptr;
+  }
+  unsigned long long address = PyLong_AsUnsignedLongLong(ptr);
+  Py_DECREF(ptr);
+  PyObject *dtype = PyObject_GetAttrString(arg, "dtype");
+  PyObject *device = dtype ? PyObject_GetAttrString(arg, "device") : nullptr;
+  PyObject *key = nullptr;
+  if (device && !PyErr_Occurred())
+    key = Py_BuildValue("(OOO)", dtype, device, pyBool(address % 16 == 0));
+  Py_XDECREF(dtype);
+  Py_XDECREF(device);
+  if (!key)
+    PyErr_Clear();
+  return key;
+}
+
 void init_triton_runtime(py::module &&m) {
   // wrap backend_t
   py::enum_<backend_t>(m, "backend", py::module_local())
@@ -70,6 +144,33 @@ void init_triton_runtime(py::module &&m) {
       .value("CUDA", CUDA)
       .value("ROCM", ROCM)
       .export_values();
+
+  // Builds the key the generated launcher uses to find an already compiled
+  // kernel without going through the Python key construction; `constexprs`
+  // flags the arguments whose value is part of the key. Returns None when
+  // some argument can't be keyed natively. `numWarps` and `numStages` may be
+  // "auto".
+  m.def("launch_key", [](const py::tuple &args, const py::tuple &constexprs,
+                         const py::object &numWarps,
+                         const py::object &numStages) -> py::object {
+    size_t n = args.size();
+    PyObject *key = PyTuple_New(n + 2);
+    if (!key)
+      throw py::error_already_set();
+    for (size_t i = 0; i < n; i++) {
+      bool isConstexpr = i < constexprs.size() &&
+                         PyObject_IsTrue(constexprs[i].ptr()) == 1;
+      PyObject *item = launchArgKey(args[i].ptr(), isConstexpr);
+      if (!item) {
+        Py_DECREF(key);
+        return py::none();
+      }
+      PyTuple_SET_ITEM(key, i, item);
+    }
+    PyTuple_SET_ITEM(key, n, numWarps.inc_ref().ptr());
+    PyTuple_SET_ITEM(key, n + 1, numStages.inc_ref().ptr());
+    return py::reinterpret_steal<py::object>(key);
+  });
 }
 
 // A custom op builder that keeps track of the last location
@@ -156,6 +257,89 @@ private:
   bool lineInfoEnabled = !triton::tools::getBoolEnv("TRITON_DISABLE_LINE_INFO");
 };
 
+/*****************************************************************************/
+/* Compile-time statistics                                                   */
+/*****************************************************************************/
+
+// Wall time and IR size of every pass run by an instrumented PassManager, plus
+// named timings of the non-MLIR compilation steps.
+struct CompileStatistics {
+  struct PassRecord {
+    std::string name;
+    double seconds;
+    int64_t opsBefore;
+    int64_t opsAfter;
+  };
+
+  std::mutex mutex;
+  std::vector<PassRecord> passes;
+  std::map<std::string, double> timings;
+};
+
+class CompileStatisticsInstrumentation : public mlir::PassInstrumentation {
+public:
+  explicit CompileStatisticsInstrumentation(
+      std::shared_ptr<CompileStatistics> stats)
+      : stats(std::move(stats)) {}
+
+  void runBeforePass(mlir::Pass *pass, mlir::Operation *op) override {
+    int64_t numOps = countOps(op);
+    std::lock_guard<std::mutex> lock(stats->mutex);
+    pending[pass] = {std::chrono::steady_clock::now(), numOps};
+  }
+
+  void runAfterPass(mlir::Pass *pass, mlir::Operation *op) override {
+    record(pass, op);
+  }
+
+  void runAfterPassFailed(mlir::Pass *pass, mlir::Operation *op) override {
+    record(pass, op);
+  }
+
+private:
+  static int64_t countOps(mlir::Operation *op) {
+    int64_t numOps = 0;
+    op->walk([&](mlir::Operation *) { ++numOps; });
+    return numOps;
+  }
+
+  void record(mlir::Pass *pass, mlir::Operation *op) {
+    auto end = std::chrono::steady_clock::now();
+    int64_t numOps = countOps(op);
+    std::lock_guard<std::mutex> lock(stats->mutex);
+    auto it = pending.find(pass);
+    if (it == pending.end())
+      return;
+    auto [start, opsBefore] = it->second;
+    pending.erase(it);
+    std::string name = pass->getArgument().empty() ? pass->getName().str()
+                                                   : pass->getArgument().str();
+    stats->passes.push_back(
+        {name, std::chrono::duration<double>(end - start).count(), opsBefore,
+         numOps});
+  }
+
+  std::shared_ptr<CompileStatistics> stats;
+  // Nested pipelines run on several threads, but every thread works on its
+  // own clone of the pass, so the pass pointer identifies one execution
+  llvm::DenseMap<mlir::Pass *,
+                 std::pair<std::chrono::steady_clock::time_point, int64_t>>
+      pending;
+};
+
+// Loads every dialect a Triton/TritonGPU module may contain.
+// note: we initialize llvm for undef
+static void loadTritonIRDialects(mlir::MLIRContext &context) {
+  mlir::DialectRegistry registry;
+  registry.insert<mlir::triton::TritonDialect,
+                  mlir::triton::gpu::TritonGPUDialect, mlir::math::MathDialect,
+                  mlir::arith::ArithDialect, mlir::index::IndexDialect,
+                  mlir::scf::SCFDialect, mlir::cf::ControlFlowDialect,
+                  mlir::gpu::GPUDialect, mlir::LLVM::LLVMDialect>();
+  context.appendDialectRegistry(registry);
+  context.loadAllAvailableDialects();
+}
+
 /*****************************************************************************/
 /* Python bindings for triton::ir                                            */
 /*****************************************************************************/
@@ -187,6 +371,12 @@ void init_triton_ir(py::module &&m) {
       .value("RELAXED", mlir::triton::MemSemantic::RELAXED)
       .export_values();
 
+  py::enum_<mlir::triton::MemSyncScope>(m, "MEM_SYNC_SCOPE", py::module_local())
+      .value("GPU", mlir::triton::MemSyncScope::GPU)
+      .value("CTA", mlir::triton::MemSyncScope::CTA)
+      .value("SYSTEM", mlir::triton::MemSyncScope::SYSTEM)
+      .export_values();
+
   py::enum_<mlir::triton::EvictionPolicy>(m, "EVICTION_POLICY",
                                           py::module_local())
       .value("NORMAL", mlir::triton::EvictionPolicy::NORMAL)
@@ -208,6 +398,7 @@ void init_triton_ir(py::module &&m) {
 
   py::class_<mlir::MLIRContext>(m, "context", py::module_local())
       .def(py::init<>())
+      .def("load_all_dialects", &loadTritonIRDialects)
       .def("load_triton", [](mlir::MLIRContext &self) {
         self.getOrLoadDialect<mlir::triton::TritonDialect>();
         self.getOrLoadDialect<mlir::index::IndexDialect>();
@@ -470,10 +661,22 @@ void init_triton_ir(py::module &&m) {
                throw std::runtime_error("Failed to write module bytecode");
              return py::bytearray(bytecode);
            })
+      .def("set_int_attr",
+           [](mlir::ModuleOp &self, std::string &name, int value) -> void {
+             auto i32Ty = mlir::IntegerType::get(self.getContext(), 32);
+             self->setAttr(name, mlir::IntegerAttr::get(i32Ty, value));
+           })
       .def("push_back",
            [](mlir::ModuleOp &self, mlir::triton::FuncOp &funcOp) -> void {
              self.push_back(funcOp);
            })
+      .def("merge",
+           [](mlir::ModuleOp &self, mlir::ModuleOp &other) -> void {
+             // clone the functions of `other` that `self` doesn't define
+             for (auto funcOp : other.getOps<mlir::triton::FuncOp>())
+               if (!self.lookupSymbol(funcOp.getName()))
+                 self.push_back(funcOp.clone());
+           })
       .def("has_function",
            [](mlir::ModuleOp &self, std::string &funcName) -> bool {
              if (self.lookupSymbol(funcName))
@@ -508,16 +711,7 @@ void init_triton_ir(py::module &&m) {
   m.def(
       "parse_mlir_module",
       [](const std::string &inputFilename, mlir::MLIRContext &context) {
-        // initialize registry
-        // note: we initialize llvm for undef
-        mlir::DialectRegistry registry;
-        registry.insert<
-            mlir::triton::TritonDialect, mlir::triton::gpu::TritonGPUDialect,
-            mlir::math::MathDialect, mlir::arith::ArithDialect,
-            mlir::index::IndexDialect, mlir::scf::SCFDialect,
-            mlir::cf::ControlFlowDialect, mlir::LLVM::LLVMDialect>();
-        context.appendDialectRegistry(registry);
-        context.loadAllAvailableDialects();
+        loadTritonIRDialects(context);
 
         // parse module
         mlir::OwningOpRef<mlir::ModuleOp> module =
@@ -533,6 +727,21 @@ void init_triton_ir(py::module &&m) {
       },
       ret::take_ownership);
 
+  m.def(
+      "parse_mlir_bytecode",
+      [](const py::bytes &bytecode, mlir::MLIRContext &context) {
+        loadTritonIRDialects(context);
+        // unlike parse_mlir_module, locations are kept: the bytecode is
+        // produced in-process from modules that still carry line info
+        std::string data = bytecode;
+        mlir::OwningOpRef<mlir::ModuleOp> module =
+            mlir::parseSourceString<mlir::ModuleOp>(data, &context);
+        if (!module)
+          throw std::runtime_error("Parse MLIR bytecode failed.");
+        return module->clone();
+      },
+      ret::take_ownership);
+
   py::class_<mlir::triton::FuncOp, mlir::OpState>(m, "function",
                                                   py::module_local())
       // .def_property_readonly("attrs", &ir::function::attrs)
@@ -904,9 +1113,10 @@ void init_triton_ir(py::module &&m) {
       // Cast instructions
       // Conversions for custom FP types (FP8)
       .def("create_fp_to_fp",
-           [](TritonOpBuilder &self, mlir::Value &src,
-              mlir::Type &dstType) -> mlir::Value {
-             return self.create<mlir::triton::FpToFpOp>(dstType, src);
+           [](TritonOpBuilder &self, mlir::Value &src, mlir::Type &dstType,
+              bool saturate) -> mlir::Value {
+             return self.create<mlir::triton::FpToFpOp>(dstType, src,
+                                                        saturate);
            })
       // Conversions for standard LLVM builtin types
       .def("create_bitcast",
@@ -1215,16 +1425,20 @@ void init_triton_ir(py::module &&m) {
            [](TritonOpBuilder &self, mlir::Value &ptrs,
               mlir::triton::CacheModifier cacheModifier,
               mlir::triton::EvictionPolicy evictionPolicy,
-              bool isVolatile) -> mlir::Value {
+              bool isVolatile,
+              mlir::triton::EvictionPolicy l2EvictionPolicy) -> mlir::Value {
              return self.create<mlir::triton::LoadOp>(
-                 ptrs, cacheModifier, evictionPolicy, isVolatile);
+                 ptrs, cacheModifier, evictionPolicy, isVolatile,
+                 l2EvictionPolicy);
            })
       .def("create_store",
            [](TritonOpBuilder &self, mlir::Value &ptrs, mlir::Value &value,
               mlir::triton::CacheModifier cacheModifier,
-              mlir::triton::EvictionPolicy evictionPolicy) -> void {
+              mlir::triton::EvictionPolicy evictionPolicy,
+              mlir::triton::EvictionPolicy l2EvictionPolicy) -> void {
              self.create<mlir::triton::StoreOp>(ptrs, value, cacheModifier,
-                                                evictionPolicy);
+                                                evictionPolicy,
+                                                l2EvictionPolicy);
            })
       .def("create_tensor_pointer_load",
            [](TritonOpBuilder &self, mlir::Value &ptr,
@@ -1232,35 +1446,41 @@ void init_triton_ir(py::module &&m) {
               std::optional<mlir::triton::PaddingOption> paddingOption,
               mlir::triton::CacheModifier cacheModifier,
               mlir::triton::EvictionPolicy evictionPolicy,
-              bool isVolatile) -> mlir::Value {
+              bool isVolatile,
+              mlir::triton::EvictionPolicy l2EvictionPolicy) -> mlir::Value {
              return self.create<mlir::triton::LoadOp>(
                  ptr, boundaryCheck, paddingOption, cacheModifier,
-                 evictionPolicy, isVolatile);
+                 evictionPolicy, isVolatile, l2EvictionPolicy);
            })
       .def("create_tensor_pointer_store",
            [](TritonOpBuilder &self, mlir::Value &ptr, mlir::Value &val,
               std::vector<int32_t> &boundaryCheck,
               mlir::triton::CacheModifier cacheModifier,
-              mlir::triton::EvictionPolicy evictionPolicy) -> void {
+              mlir::triton::EvictionPolicy evictionPolicy,
+              mlir::triton::EvictionPolicy l2EvictionPolicy) -> void {
              self.create<mlir::triton::StoreOp>(ptr, val, boundaryCheck,
-                                                cacheModifier, evictionPolicy);
+                                                cacheModifier, evictionPolicy,
+                                                l2EvictionPolicy);
            })
       .def("create_masked_load",
            [](TritonOpBuilder &self, mlir::Value &ptrs, mlir::Value &mask,
               std::optional<mlir::Value> &other,
               mlir::triton::CacheModifier cacheModifier,
               mlir::triton::EvictionPolicy evictionPolicy,
-              bool isVolatile) -> mlir::Value {
+              bool isVolatile,
+              mlir::triton::EvictionPolicy l2EvictionPolicy) -> mlir::Value {
              return self.create<mlir::triton::LoadOp>(
                  ptrs, mask, other.value_or(mlir::Value()), cacheModifier,
-                 evictionPolicy, isVolatile);
+                 evictionPolicy, isVolatile, l2EvictionPolicy);
            })
       .def("create_masked_store",
            [](TritonOpBuilder &self, mlir::Value &ptrs, mlir::Value &val,
               mlir::Value &mask, mlir::triton::CacheModifier cacheModifier,
-              mlir::triton::EvictionPolicy evictionPolicy) -> void {
+              mlir::triton::EvictionPolicy evictionPolicy,
+              mlir::triton::EvictionPolicy l2EvictionPolicy) -> void {
              self.create<mlir::triton::StoreOp>(ptrs, val, mask, cacheModifier,
-                                                evictionPolicy);
+                                                evictionPolicy,
+                                                l2EvictionPolicy);
            })
       .def("create_view",
            [](TritonOpBuilder &self, mlir::Value &arg,
@@ -1327,7 +1547,8 @@ void init_triton_ir(py::module &&m) {
       // // atomic
       .def("create_atomic_cas",
            [](TritonOpBuilder &self, mlir::Value &ptr, mlir::Value &cmp,
-              mlir::Value &val, mlir::triton::MemSemantic sem) -> mlir::Value {
+              mlir::Value &val, mlir::triton::MemSemantic sem,
+              mlir::triton::MemSyncScope scope) -> mlir::Value {
              mlir::Type dstType;
              if (auto srcTensorType =
                      ptr.getType().dyn_cast<mlir::RankedTensorType>()) {
@@ -1342,12 +1563,15 @@ void init_triton_ir(py::module &&m) {
                dstType = ptrType.getPointeeType();
              }
              return self.create<mlir::triton::AtomicCASOp>(dstType, ptr, cmp,
-                                                           val, sem);
-           })
+                                                           val, sem, scope);
+           },
+           py::arg("ptr"), py::arg("cmp"), py::arg("val"), py::arg("sem"),
+           py::arg("scope") = mlir::triton::MemSyncScope::GPU)
       .def("create_atomic_rmw",
            [](TritonOpBuilder &self, mlir::triton::RMWOp rmwOp,
               mlir::Value &ptr, mlir::Value &val, mlir::Value &mask,
-              mlir::triton::MemSemantic sem) -> mlir::Value {
+              mlir::triton::MemSemantic sem, bool aggregate,
+              mlir::triton::MemSyncScope scope) -> mlir::Value {
              mlir::Type dstType;
              if (auto srcTensorType =
                      ptr.getType().dyn_cast<mlir::RankedTensorType>()) {
@@ -1361,9 +1585,12 @@ void init_triton_ir(py::module &&m) {
                                   .cast<mlir::triton::PointerType>();
                dstType = ptrType.getPointeeType();
              }
-             return self.create<mlir::triton::AtomicRMWOp>(dstType, rmwOp, ptr,
-                                                           val, mask, sem);
-           })
+             return self.create<mlir::triton::AtomicRMWOp>(
+                 dstType, rmwOp, ptr, val, mask, sem, aggregate, scope);
+           },
+           py::arg("rmwOp"), py::arg("ptr"), py::arg("val"), py::arg("mask"),
+           py::arg("sem"), py::arg("aggregate") = false,
+           py::arg("scope") = mlir::triton::MemSyncScope::GPU)
       // External
       .def("create_extern_elementwise",
            [](TritonOpBuilder &self, const std::string &libName,
@@ -1394,12 +1621,32 @@ void init_triton_ir(py::module &&m) {
                  self.getBuilder().getI32Type(),
                  self.getBuilder().getI32IntegerAttr(axis));
            })
+      .def("create_get_cluster_cta_rank",
+           [](TritonOpBuilder &self) -> mlir::Value {
+             return self.create<mlir::triton::GetClusterCTARankOp>(
+                 self.getBuilder().getI32Type());
+           })
+      .def("create_get_cluster_num_ctas",
+           [](TritonOpBuilder &self) -> mlir::Value {
+             return self.create<mlir::triton::GetClusterNumCTAsOp>(
+                 self.getBuilder().getI32Type());
+           })
+      .def("create_cluster_barrier",
+           [](TritonOpBuilder &self) {
+             self.create<mlir::triton::ClusterBarrierOp>();
+           })
       .def("create_dot",
            [](TritonOpBuilder &self, mlir::Value &a, mlir::Value &b,
               mlir::Value &c, bool allowTF32) -> mlir::Value {
              return self.create<mlir::triton::DotOp>(c.getType(), a, b, c,
                                                      allowTF32);
            })
+      .def("create_sparse_dot",
+           [](TritonOpBuilder &self, mlir::Value &a, mlir::Value &b,
+              mlir::Value &c, mlir::Value &aMeta) -> mlir::Value {
+             return self.create<mlir::triton::SparseDotOp>(c.getType(), a, b,
+                                                           c, aMeta);
+           })
       .def("create_exp",
            [](TritonOpBuilder &self, mlir::Value &val) -> mlir::Value {
              return self.create<mlir::math::ExpOp>(val);
@@ -1493,6 +1740,14 @@ void init_triton_ir(py::module &&m) {
                                                  fileNameAttr, funcNameAttr,
                                                  lineNoAttr);
            })
+      .def("create_profile_region",
+           [](TritonOpBuilder &self, const std::string &name,
+              bool end) -> void {
+             self.create<mlir::triton::ProfileRegionOp>(
+                 mlir::StringAttr::get(self.getBuilder().getContext(),
+                                       llvm::StringRef(name)),
+                 end);
+           })
       // Undef
       .def("create_undef",
            [](TritonOpBuilder &self, mlir::Type &type) -> mlir::Value {
@@ -1520,8 +1775,40 @@ void init_triton_ir(py::module &&m) {
                                                          offsets);
            });
 
+  py::class_<CompileStatistics, std::shared_ptr<CompileStatistics>>(
+      m, "compile_statistics", py::module_local())
+      .def(py::init<>())
+      .def_property_readonly("passes",
+                             [](CompileStatistics &self) {
+                               std::lock_guard<std::mutex> lock(self.mutex);
+                               py::list ret;
+                               for (const auto &record : self.passes)
+                                 ret.append(py::dict(
+                                     "name"_a = record.name,
+                                     "seconds"_a = record.seconds,
+                                     "ops_before"_a = record.opsBefore,
+                                     "ops_after"_a = record.opsAfter));
+                               return ret;
+                             })
+      .def_property_readonly("timings",
+                             [](CompileStatistics &self) {
+                               std::lock_guard<std::mutex> lock(self.mutex);
+                               return self.timings;
+                             })
+      .def("add_timing", [](CompileStatistics &self, const std::string &name,
+                            double seconds) {
+        std::lock_guard<std::mutex> lock(self.mutex);
+        self.timings[name] += seconds;
+      });
+
   py::class_<mlir::PassManager>(m, "pass_manager", py::module_local())
       .def(py::init<mlir::MLIRContext *>())
+      .def("enable_statistics",
+           [](mlir::PassManager &self,
+              std::shared_ptr<CompileStatistics> stats) {
+             self.addInstrumentation(
+                 std::make_unique<CompileStatisticsInstrumentation>(stats));
+           })
       .def("enable_debug",
            [](mlir::PassManager &self) {
              if (!::triton::tools::getBoolEnv("MLIR_ENABLE_DUMP"))
@@ -1542,6 +1829,9 @@ void init_triton_ir(py::module &&m) {
            })
       .def("run",
            [](mlir::PassManager &self, mlir::ModuleOp &mod) {
+             // Passes never call back into Python, so let other threads
+             // (e.g. parallel autotuner compiles) make progress meanwhile
+             py::gil_scoped_release allow_threads;
              // TODO: maybe dump module to file and print error for better
              // diagnostics
              if (mlir::failed(self.run(mod.getOperation())))
@@ -1580,11 +1870,27 @@ void init_triton_ir(py::module &&m) {
            [](mlir::PassManager &self) {
              self.addPass(mlir::triton::createReorderBroadcastPass());
            })
-      .def("add_rewrite_tensor_pointer_pass",
-           [](mlir::PassManager &self, int computeCapability) {
-             self.addPass(mlir::triton::createRewriteTensorPointerPass(
-                 computeCapability));
+      .def("add_narrow_offsets_pass",
+           [](mlir::PassManager &self, bool assumeSmallTensors) {
+             self.addPass(
+                 mlir::triton::createNarrowOffsetsPass(assumeSmallTensors));
+           })
+      .def("add_swizzle_program_ids_pass",
+           [](mlir::PassManager &self, int groupSize) {
+             self.addPass(
+                 mlir::triton::createSwizzleProgramIdsPass(groupSize));
+           })
+      .def("add_linearize_program_ids_pass",
+           [](mlir::PassManager &self) {
+             self.addPass(mlir::triton::createLinearizeProgramIdsPass());
            })
+      .def(
+          "add_rewrite_tensor_pointer_pass",
+          [](mlir::PassManager &self, int computeCapability, bool enableTMA) {
+            self.addPass(mlir::triton::createRewriteTensorPointerPass(
+                computeCapability, enableTMA));
+          },
+          py::arg("computeCapability"), py::arg("enableTMA") = false)
       .def(
           "add_convert_triton_to_tritongpu_pass",
           [](mlir::PassManager &self, int numWarps, int threadsPerWarp) {
@@ -1592,23 +1898,49 @@ void init_triton_ir(py::module &&m) {
                 numWarps, threadsPerWarp));
           },
           py::arg("numWarps") = 4, py::arg("threadsPerWarp") = 32)
-      .def("add_tritongpu_pipeline_pass",
-           [](mlir::PassManager &self, int numStages) {
-             self.addPass(mlir::createTritonGPUPipelinePass(numStages));
+      .def(
+          "add_tritongpu_pipeline_pass",
+          [](mlir::PassManager &self, int numStages,
+             int64_t sharedMemoryBudget) {
+            self.addPass(mlir::createTritonGPUPipelinePass(
+                numStages, sharedMemoryBudget));
+          },
+          py::arg("numStages"), py::arg("sharedMemoryBudget") = 48 * 1024)
+      .def("add_tritongpu_flatten_loops_pass",
+           [](mlir::PassManager &self) {
+             self.addPass(mlir::createTritonGPUFlattenLoopsPass());
            })
+      .def("add_tritongpu_unroll_loops_pass",
+           [](mlir::PassManager &self) {
+             self.addPass(mlir::createTritonGPUUnrollLoopsPass());
+           })
+      .def(
+          "add_tritongpu_warp_specialize_pass",
+          [](mlir::PassManager &self, int numStages) {
+            self.addPass(mlir::createTritonGPUWarpSpecializePass(numStages));
+          },
+          py::arg("numStages") = 3)
       .def("add_tritongpu_prefetch_pass",
            [](mlir::PassManager &self) {
              self.addPass(mlir::createTritonGPUPrefetchPass());
            })
-      .def("add_tritongpu_accelerate_matmul_pass",
-           [](mlir::PassManager &self, int computeCapability) {
-             self.addPass(
-                 mlir::createTritonGPUAccelerateMatmulPass(computeCapability));
-           })
+      .def(
+          "add_tritongpu_accelerate_matmul_pass",
+          [](mlir::PassManager &self, int computeCapability, int mfmaVersion,
+             int ptxVersion) {
+            self.addPass(mlir::createTritonGPUAccelerateMatmulPass(
+                computeCapability, mfmaVersion, ptxVersion));
+          },
+          py::arg("computeCapability"), py::arg("mfmaVersion") = 0,
+          py::arg("ptxVersion") = 80)
       .def("add_tritongpu_optimize_dot_operands_pass",
            [](mlir::PassManager &self) {
              self.addPass(mlir::createTritonGPUOptimizeDotOperandsPass());
            })
+      .def("add_tritongpu_assign_layouts_pass",
+           [](mlir::PassManager &self) {
+             self.addPass(mlir::createTritonGPUAssignLayoutsPass());
+           })
       .def("add_tritongpu_remove_layout_conversions_pass",
            [](mlir::PassManager &self) {
              self.addPass(mlir::createTritonGPURemoveLayoutConversionsPass());
@@ -1617,6 +1949,10 @@ void init_triton_ir(py::module &&m) {
            [](mlir::PassManager &self) {
              self.addPass(mlir::createTritonGPUReorderInstructionsPass());
            })
+      .def("add_tritongpu_rematerialize_pass",
+           [](mlir::PassManager &self) {
+             self.addPass(mlir::createTritonGPURematerializePass());
+           })
       .def("add_tritongpu_decompose_conversions_pass",
            [](mlir::PassManager &self) {
              self.addPass(mlir::createTritonGPUDecomposeConversionsPass());
@@ -1630,6 +1966,128 @@ void init_triton_ir(py::module &&m) {
       });
 }
 
+// Extracts the resource usage that ptxas prints with `-v`, e.g.
+//   ptxas info    : Used 40 registers, 16384 bytes smem, 400 bytes cmem[0]
+//   ptxas info    : 0 bytes stack frame, 0 bytes spill stores, 0 bytes spill
+//   loads
+// The in-process assembler writes the exact same report to its info log.
+static std::map<std::string, int>
+parsePtxasResourceUsage(const std::string &log) {
+  static const std::pair<const char *, const char *> fields[] = {
+      {"registers", R"(Used (\d+) registers)"},
+      {"shared", R"((\d+) bytes smem)"},
+      {"constant", R"((\d+) bytes cmem\[0\])"},
+      {"stack_frame", R"((\d+) bytes stack frame)"},
+      {"spill_stores", R"((\d+) bytes spill stores)"},
+      {"spill_loads", R"((\d+) bytes spill loads)"},
+  };
+  std::map<std::string, int> usage;
+  for (const auto &[name, pattern] : fields) {
+    std::smatch match;
+    if (std::regex_search(log, match, std::regex(pattern)))
+      usage[name] = std::stoi(match[1].str());
+  }
+  return usage;
+}
+
+// Assembles `ptxCode` by running the ptxas binary at `ptxasPath` on a
+// temporary file. Throws on failure.
+static void compilePtxWithPtxas(const std::string &ptxCode,
+                                const std::string &ptxasPath,
+                                const std::vector<std::string> &options,
+                                std::string &cubin, std::string &log) {
+  llvm::SmallString<64> fsrc;
+  llvm::SmallString<64> flog;
+  llvm::sys::fs::createTemporaryFile("compile-ptx-src", "", fsrc);
+  llvm::sys::fs::createTemporaryFile("compile-ptx-log", "", flog);
+  std::string fbin = std::string(fsrc) + ".o";
+  llvm::FileRemover logRemover(flog);
+  llvm::FileRemover binRemover(fbin);
+  const char *_fsrc = fsrc.c_str();
+  const char *_flog = flog.c_str();
+  const char *_fbin = fbin.c_str();
+  std::ofstream ofs(_fsrc);
+  ofs << ptxCode << std::endl;
+  ofs.close();
+
+  std::string cmd = ptxasPath;
+  for (const auto &option : options)
+    cmd += " " + option;
+  cmd += " " + std::string(_fsrc) + " -o " + fbin + " 2> " + std::string(_flog);
+
+  int err = system(cmd.c_str());
+  std::ifstream _log(_flog);
+  log = std::string(std::istreambuf_iterator<char>(_log), {});
+  if (err != 0) {
+    err >>= 8;
+    if (err == 255) {
+      throw std::runtime_error("Internal Triton PTX codegen error: \n" + log);
+    } else if (err == 128 + SIGSEGV) {
+      throw std::runtime_error("Please run `ptxas " + fsrc.str().str() +
+                               "` to confirm that this is a "
+                               "bug in `ptxas`\n" +
+                               log);
+    } else {
+      throw std::runtime_error("`ptxas` failed with error code " +
+                               std::to_string(err) + ": \n" + log);
+    }
+  }
+  llvm::FileRemover srcRemover(fsrc);
+  std::ifstream _cubin(_fbin, std::ios::binary);
+  cubin = std::string(std::istreambuf_iterator<char>(_cubin), {});
+}
+
+#ifdef TRITON_USE_NVPTXCOMPILER
+// Assembles `ptxCode` in memory through the nvPTXCompiler library, which
+// avoids forking ptxas and the temporary-file round trips. Returns false if
+// the library cannot handle this PTX (typically because the PTX ISA version
+// was picked for a newer ptxas than the library was shipped with) so the
+// caller can fall back to the ptxas binary. Throws on genuine errors.
+static bool compilePtxInProcess(const std::string &ptxCode,
+                                const std::vector<std::string> &options,
+                                std::string &cubin, std::string &log) {
+  nvPTXCompilerHandle compiler;
+  if (nvPTXCompilerCreate(&compiler, ptxCode.size(), ptxCode.c_str()) !=
+      NVPTXCOMPILE_SUCCESS)
+    return false;
+  auto getLog = [&](auto getSize, auto get) {
+    size_t size = 0;
+    if (getSize(compiler, &size) != NVPTXCOMPILE_SUCCESS || size == 0)
+      return std::string();
+    std::string text(size, '\0');
+    get(compiler, text.data());
+    // Drop the trailing null terminator
+    text.resize(strnlen(text.data(), size));
+    return text;
+  };
+
+  std::vector<const char *> argv;
+  for (const auto &option : options)
+    argv.push_back(option.c_str());
+  nvPTXCompileResult status =
+      nvPTXCompilerCompile(compiler, argv.size(), argv.data());
+  if (status == NVPTXCOMPILE_ERROR_UNSUPPORTED_PTX_VERSION) {
+    nvPTXCompilerDestroy(&compiler);
+    return false;
+  }
+  if (status != NVPTXCOMPILE_SUCCESS) {
+    std::string error =
+        getLog(nvPTXCompilerGetErrorLogSize, nvPTXCompilerGetErrorLog);
+    nvPTXCompilerDestroy(&compiler);
+    throw std::runtime_error("`nvPTXCompiler` failed with error code " +
+                             std::to_string(status) + ": \n" + error);
+  }
+
+  size_t size = 0;
+  nvPTXCompilerGetCompiledProgramSize(compiler, &size);
+  cubin.resize(size);
+  nvPTXCompilerGetCompiledProgram(compiler, cubin.data());
+  log = getLog(nvPTXCompilerGetInfoLogSize, nvPTXCompilerGetInfoLog);
+  nvPTXCompilerDestroy(&compiler);
+  return true;
+}
+#endif
+
 void init_triton_translation(py::module &m) {
   using ret = py::return_value_policy;
 
@@ -1638,15 +2096,146 @@ void init_triton_translation(py::module &m) {
     return shared.getInt();
   });
 
+  m.def("get_shared_memory_lower_bound", [](mlir::ModuleOp mod) {
+    auto bound =
+        mod->getAttrOfType<mlir::IntegerAttr>("triton_gpu.shared_lower_bound");
+    if (!bound)
+      bound = mod->getAttrOfType<mlir::IntegerAttr>("triton_gpu.shared");
+    return bound.getInt();
+  });
+
+  m.def("get_num_stages", [](mlir::ModuleOp mod) {
+    auto numStages =
+        mod->getAttrOfType<mlir::IntegerAttr>("triton_gpu.num-stages");
+    return numStages ? numStages.getInt() : 1;
+  });
+
+  m.def("get_num_warp_groups", [](mlir::ModuleOp mod) {
+    return mlir::triton::gpu::TritonGPUDialect::getNumWarpGroups(mod);
+  });
+
+  m.def("get_num_warps", [](mlir::ModuleOp mod) {
+    return mlir::triton::gpu::TritonGPUDialect::getNumWarps(mod);
+  });
+
+  // The largest tensor and the largest dot of a TTIR module, from which
+  // num_warps="auto" is picked
+  m.def("get_tensor_footprint", [](mlir::ModuleOp mod) {
+    int64_t numel = 0, bitwidth = 0;
+    py::object dot = py::none();
+    int64_t dotSize = 0;
+    mod.walk([&](mlir::Operation *op) {
+      for (mlir::Type type : op->getResultTypes()) {
+        auto tensorTy = type.dyn_cast<mlir::RankedTensorType>();
+        if (!tensorTy || !tensorTy.getElementType().isIntOrFloat())
+          continue;
+        int64_t elemBits = tensorTy.getElementType().getIntOrFloatBitWidth();
+        if (tensorTy.getNumElements() * elemBits > numel * bitwidth) {
+          numel = tensorTy.getNumElements();
+          bitwidth = elemBits;
+        }
+      }
+      if (auto dotOp = llvm::dyn_cast<mlir::triton::DotOp>(op)) {
+        auto aTy = dotOp.getA().getType().cast<mlir::RankedTensorType>();
+        auto dShape =
+            dotOp.getD().getType().cast<mlir::RankedTensorType>().getShape();
+        if (dShape[0] * dShape[1] > dotSize) {
+          dotSize = dShape[0] * dShape[1];
+          dot = py::make_tuple(dShape[0], dShape[1], aTy.getShape()[1],
+                               aTy.getElementType().getIntOrFloatBitWidth());
+        }
+      }
+    });
+    py::dict info;
+    info["numel"] = numel;
+    info["bitwidth"] = bitwidth;
+    info["dot"] = dot;
+    return info;
+  });
+
+  // What the launcher builds each tensor map passed to the kernel from
+  m.def("get_tensor_maps", [](mlir::ModuleOp mod) {
+    py::list tensorMaps;
+    auto attr = mod->getAttrOfType<mlir::ArrayAttr>("tt.tensor_maps");
+    if (!attr)
+      return tensorMaps;
+    for (auto tensorMap : attr.getAsRange<mlir::DictionaryAttr>()) {
+      py::dict info;
+      for (auto name : {"base", "elem_bytes"})
+        info[name] = tensorMap.getAs<mlir::IntegerAttr>(name).getInt();
+      for (auto name : {"box", "dims", "strides"})
+        info[name] = py::cast(
+            tensorMap.getAs<mlir::DenseI64ArrayAttr>(name).asArrayRef().vec());
+      for (auto name : {"dim_args", "stride_args"})
+        info[name] = py::cast(
+            tensorMap.getAs<mlir::DenseI32ArrayAttr>(name).asArrayRef().vec());
+      tensorMaps.append(info);
+    }
+    return tensorMaps;
+  });
+
+  // The prefix and the element types and counts of the arguments of each
+  // tt.print, in the order their buffered records are identified by
+  m.def("get_print_records", [](mlir::ModuleOp mod) {
+    py::list records;
+    mod.walk([&](mlir::triton::PrintOp op) {
+      py::list args;
+      for (mlir::Value arg : op.getArgs()) {
+        mlir::Type type = arg.getType();
+        std::string elemTy;
+        llvm::raw_string_ostream os(elemTy);
+        os << mlir::getElementTypeOrSelf(type);
+        args.append(py::make_tuple(
+            os.str(), mlir::triton::gpu::getTotalElemsPerThread(type)));
+      }
+      py::dict record;
+      record["prefix"] = op.getPrefix().str();
+      record["args"] = args;
+      records.append(record);
+    });
+    return records;
+  });
+
+  // The names of the profiled regions, in the order their counters are laid
+  // out in
+  m.def("get_profile_regions", [](mlir::ModuleOp mod) {
+    std::vector<std::string> regions;
+    mod.walk([&](mlir::triton::ProfileRegionOp op) {
+      if (!llvm::is_contained(regions, op.getName()))
+        regions.push_back(op.getName().str());
+    });
+    return regions;
+  });
+
+  m.def("get_register_pressure", [](mlir::ModuleOp mod) {
+    mlir::ModuleAxisInfoAnalysis axisInfoAnalysis(mod);
+    return mlir::RegisterPressureAnalysis(mod, &axisInfoAnalysis)
+        .getMaxPressure();
+  });
+
+  m.def("get_register_budget", [](mlir::ModuleOp mod) {
+    return mlir::RegisterPressureAnalysis::getRegisterBudget(mod);
+  });
+
   m.def(
       "translate_triton_gpu_to_llvmir",
-      [](mlir::ModuleOp op, int computeCapability, bool isROCM) {
+      [](mlir::ModuleOp op, int computeCapability, bool isROCM, bool fastMath,
+         std::shared_ptr<CompileStatistics> stats, bool printBuffer,
+         int optLevel) {
         py::gil_scoped_release allow_threads;
         llvm::LLVMContext llvmContext;
+        mlir::triton::TranslationTimings timings;
         auto llvmModule = ::mlir::triton::translateTritonGPUToLLVMIR(
-            &llvmContext, op, computeCapability, isROCM);
+            &llvmContext, op, computeCapability, isROCM, fastMath, printBuffer,
+            optLevel, &timings);
         if (!llvmModule)
           llvm::report_fatal_error("Failed to translate TritonGPU to LLVM IR.");
+        if (stats) {
+          std::lock_guard<std::mutex> lock(stats->mutex);
+          stats->timings["llvm_lowering"] += timings.lowering;
+          stats->timings["llvm_translation"] += timings.translation;
+          stats->timings["llvm_optimize"] += timings.optimization;
+        }
 
         std::string str;
         llvm::raw_string_ostream os(str);
@@ -1654,11 +2243,15 @@ void init_triton_translation(py::module &m) {
         os.flush();
         return str;
       },
+      py::arg("mod"), py::arg("computeCapability"), py::arg("isROCM"),
+      py::arg("fastMath") = false, py::arg("stats") = nullptr,
+      py::arg("printBuffer") = false, py::arg("optLevel") = 3,
       ret::take_ownership);
 
   m.def(
       "translate_llvmir_to_ptx",
-      [](const std::string llvmIR, int capability, int version) -> std::string {
+      [](const std::string llvmIR, int capability, int version,
+         int optLevel) -> std::string {
         py::gil_scoped_release allow_threads;
         // create LLVM module from C++
         llvm::LLVMContext context;
@@ -1673,75 +2266,48 @@ void init_triton_translation(py::module &m) {
               "lineno: " + std::to_string(error.getLineNo()));
         }
         // translate module to PTX
-        auto ptxCode =
-            triton::translateLLVMIRToPTX(*module, capability, version);
+        auto ptxCode = triton::translateLLVMIRToPTX(*module, capability,
+                                                    version, optLevel);
         return ptxCode;
       },
-      ret::take_ownership);
+      py::arg("llvmIR"), py::arg("capability"), py::arg("version"),
+      py::arg("optLevel") = 3, ret::take_ownership);
 
   m.def(
       "compile_ptx_to_cubin",
       [](const std::string &ptxCode, const std::string &ptxasPath,
-         int capability) -> py::object {
+         int capability, int optLevel, int maxNReg) -> py::tuple {
         std::string cubin;
+        std::string log;
         {
           py::gil_scoped_release allow_threads;
 
-          // compile ptx with ptxas
-          llvm::SmallString<64> fsrc;
-          llvm::SmallString<64> flog;
-          llvm::sys::fs::createTemporaryFile("compile-ptx-src", "", fsrc);
-          llvm::sys::fs::createTemporaryFile("compile-ptx-log", "", flog);
-          std::string fbin = std::string(fsrc) + ".o";
-          llvm::FileRemover logRemover(flog);
-          llvm::FileRemover binRemover(fbin);
-          const char *_fsrc = fsrc.c_str();
-          const char *_flog = flog.c_str();
-          const char *_fbin = fbin.c_str();
-          std::ofstream ofs(_fsrc);
-          ofs << ptxCode << std::endl;
-          ofs.close();
-
-          auto lineInfoOption =
-              triton::tools::getBoolEnv("TRITON_DISABLE_LINE_INFO")
-                  ? ""
-                  : " -lineinfo";
-          auto capabilitySuffix = (capability == 90) ? "a " : " ";
-          auto outputFileName = std::string(_fsrc) + ".o";
-          auto logRedirect = " 2> " + std::string(_flog);
-          std::string cmd = ptxasPath + lineInfoOption + " -v --gpu-name=sm_" +
-                            std::to_string(capability) + capabilitySuffix +
-                            _fsrc + " -o " + outputFileName + logRedirect;
-
-          int err = system(cmd.c_str());
-          if (err != 0) {
-            err >>= 8;
-            std::ifstream _log(_flog);
-            std::string log(std::istreambuf_iterator<char>(_log), {});
-            if (err == 255) {
-              throw std::runtime_error("Internal Triton PTX codegen error: \n" +
-                                       log);
-            } else if (err == 128 + SIGSEGV) {
-              throw std::runtime_error("Please run `ptxas " + fsrc.str().str() +
-                                       "` to confirm that this is a "
-                                       "bug in `ptxas`\n" +
-                                       log);
-            } else {
-              throw std::runtime_error("`ptxas` failed with error code " +
-                                       std::to_string(err) + ": \n" + log);
-            }
-            return {};
-          } else {
-            llvm::FileRemover srcRemover(fsrc);
-            std::ifstream _cubin(_fbin, std::ios::binary);
-            cubin = std::string(std::istreambuf_iterator<char>(_cubin), {});
-            _cubin.close();
-            // Do not return here, exit the gil scope and return below
-          }
+          std::vector<std::string> options;
+          if (!triton::tools::getBoolEnv("TRITON_DISABLE_LINE_INFO"))
+            options.push_back("-lineinfo");
+          options.push_back("-v");
+          options.push_back("-O" + std::to_string(optLevel));
+          if (maxNReg > 0)
+            options.push_back("--maxrregcount=" + std::to_string(maxNReg));
+          options.push_back("--gpu-name=sm_" + std::to_string(capability) +
+                            (capability == 90 ? "a" : ""));
+
+          bool assembled = false;
+#ifdef TRITON_USE_NVPTXCOMPILER
+          if (!triton::tools::getBoolEnv("TRITON_DISABLE_NVPTXCOMPILER"))
+            assembled = compilePtxInProcess(ptxCode, options, cubin, log);
+#endif
+          if (!assembled)
+            compilePtxWithPtxas(ptxCode, ptxasPath, options, cubin, log);
+          // Do not return here, exit the gil scope and return below
         }
-        py::bytes bytes(cubin);
-        return std::move(bytes);
-      });
+        py::dict resourceUsage;
+        for (const auto &[name, value] : parsePtxasResourceUsage(log))
+          resourceUsage[py::str(name)] = value;
+        return py::make_tuple(py::bytes(cubin), resourceUsage);
+      },
+      py::arg("ptxCode"), py::arg("ptxasPath"), py::arg("capability"),
+      py::arg("optLevel") = 3, py::arg("maxNReg") = 0);
 
   m.def("add_external_libs",
         [](mlir::ModuleOp &op, const std::vector<std::string> &names,
@@ -1752,7 +2318,7 @@ void init_triton_translation(py::module &m) {
   m.def(
       "translate_llvmir_to_hsaco",
       [](const std::string llvmIR, std::string gfx_arch, std::string gfx_triple,
-         std::string gfx_features) -> std::tuple<std::string, std::string> {
+         std::string gfx_features) -> py::tuple {
         // create LLVM module from C++
         llvm::LLVMContext context;
         std::unique_ptr<llvm::MemoryBuffer> buffer =
@@ -1761,9 +2327,9 @@ void init_triton_translation(py::module &m) {
         std::unique_ptr<llvm::Module> module =
             llvm::parseIR(buffer->getMemBufferRef(), error, context);
         // translate module to HSACO
-        auto hsacoCode = triton::translateLLVMIRToHSACO(
+        auto [amdgcn, hsaco] = triton::translateLLVMIRToHSACO(
             *module, gfx_arch, gfx_triple, gfx_features);
-        return hsacoCode;
+        return py::make_tuple(amdgcn, py::bytes(hsaco));
       },
       ret::take_ownership);
 }
@@ -0,0 +1,257 @@
+"""
+Compile-latency benchmark.
+
+Compiles a set of kernels from scratch, repeatedly, and reports the wall
+time and peak RSS of every stage of the pipeline:
+
+    ast->ttir        code generation and TTIR optimization
+    optimize_ttgir   conversion to TritonGPU and its optimization passes
+    ttgir_to_llir    lowering to LLVM IR
+    llir_to_ptx      LLVM codegen
+    ptx_to_cubin     ptxas
+
+Kernels are the `triton.ops` kernels, compiled from their AST, and, given
+`--cache-dir` (a Triton cache filled by a test run, as archived by CI), the
+kernels listed in `test/kernel_comparison/kernels.yml`, recompiled from the
+TTIR found in that cache (their `ast->ttir` stage is not measured). Stages
+are driven directly, bypassing the on-disk and in-memory caches, so every
+iteration does the full work.
+
+    python bench_compile.py --out compile.json [--iters 10] [--baseline old.json]
+
+With `--baseline`, stages whose median time grew by more than `--rtol` are
+reported, and the script exits with status 1.
+"""
+import argparse
+import glob
+import importlib
+import json
+import os
+import resource
+import statistics
+import sys
+import time
+
+import yaml
+
+import triton
+import triton.language as tl
+from triton.compiler.compiler import (context_pool, get_architecture_descriptor, instance_descriptor,
+                                      llir_to_ptx, optimize_ttgir, optimize_ttir, parse_mlir_module,
+                                      ptx_to_cubin, ttgir_to_llir, ttir_to_ttgir)
+from triton.compiler.code_generator import ast_to_ttir
+from triton.runtime.jit import JITFunction
+
+STAGES = ['ast->ttir', 'optimize_ttgir', 'ttgir_to_llir', 'llir_to_ptx', 'ptx_to_cubin']
+
+#######################
+# Kernels
+#######################
+
+
+def _constexpr(s):
+    if s.startswith('tl.'):
+        return getattr(tl, s[3:])
+    for ty in (int, float):
+        try:
+            return ty(s)
+        except ValueError:
+            pass
+    return None
+
+
+def parse_signature(signature):
+    """ parses a `compile.py --signature` string into (signature, constants, config) """
+    signature = [s.strip() for s in signature.split(',')]
+    hints = {i: int(s.split(':')[1]) for i, s in enumerate(signature) if ':' in s}
+    constants = {i: _constexpr(s) for i, s in enumerate(signature)}
+    constants = {k: v for k, v in constants.items() if v is not None}
+    types = {i: s.split(':')[0] for i, s in enumerate(signature) if i not in constants}
+    equal_to_1 = [i for i, h in hints.items() if h == 1]
+    constants.update({i: 1 for i in equal_to_1})
+    config = instance_descriptor(divisible_by_16=[i for i, h in hints.items() if h == 16], equal_to_1=equal_to_1)
+    return types, constants, config
+
+
+def _strides(n):
+    return ', '.join(['i32:16'] * (n - 1) + ['1'])
+
+
+def _ops_kernel(module, name):
+    # `triton.ops` re-exports functions named like some of its modules
+    return getattr(importlib.import_module(f'triton.ops.{module}'), name)
+
+
+# name: (kernel, signature in the `compile.py` format, num_warps, num_stages)
+OPS_KERNELS = {
+    'matmul': (_ops_kernel('matmul', '_kernel'),
+               '*fp16:16, *fp16:16, *fp16:16, i32:16, i32:16, i32:16, i32:16, 1, i32:16, 1, i32:16, 1, '
+               'tl.float32, 128, 128, 32, 8, 1, 1', 4, 3),
+    'attention_fwd': (_ops_kernel('flash_attention', '_fwd_kernel'),
+                      f'*fp16:16, *fp16:16, *fp16:16, fp32, *fp32:16, *fp16:16, '
+                      f'{_strides(4)}, {_strides(4)}, {_strides(4)}, {_strides(4)}, i32, i32, i32:16, '
+                      f'128, 64, 64, 1', 4, 4),
+    'attention_bwd_preprocess': (_ops_kernel('flash_attention', '_bwd_preprocess'),
+                                 '*fp16:16, *fp16:16, *fp32:16, 128, 64', 4, 3),
+    'attention_bwd': (_ops_kernel('flash_attention', '_bwd_kernel'),
+                      f'*fp16:16, *fp16:16, *fp16:16, fp32, *fp16:16, *fp16:16, *fp32:16, *fp16:16, *fp16:16, '
+                      f'*fp32:16, *fp32:16, i32:16, {_strides(4)}, {_strides(4)}, {_strides(4)}, i32, i32, i32:16, '
+                      f'128, 64, 128, 0, 1', 8, 1),
+    'cross_entropy_fwd': (_ops_kernel('cross_entropy', '_forward'), '*fp32:16, *fp32:16, *i64:16, *fp32:16, i32, 1024',
+                          4, 3),
+    'cross_entropy_bwd': (_ops_kernel('cross_entropy', '_backward'), '*fp32:16, *i64:16, *fp32:16, i32, 1024', 4, 3),
+}
+
+
+def _jit_function(fn):
+    while not isinstance(fn, JITFunction):
+        fn = fn.fn
+    return fn
+
+
+def cached_ttir_kernels(cache_dir, kernels_yml):
+    """ (name, ttir path, num_warps, num_stages) of the listed kernels found in `cache_dir` """
+    with open(kernels_yml) as f:
+        wanted = {k['name'] for k in yaml.safe_load(f)['name_and_extension']}
+    found = dict()
+    for metadata_path in glob.glob(os.path.join(cache_dir, '*', '*.json')):
+        if '__grp__' in metadata_path:
+            continue
+        with open(metadata_path) as f:
+            try:
+                metadata = json.load(f)
+            except ValueError:
+                continue
+        name = metadata.get('name') if isinstance(metadata, dict) else None
+        ttir_path = metadata_path[:-len('.json')] + '.ttir'
+        if name in wanted and name not in found and os.path.exists(ttir_path):
+            found[name] = (ttir_path, metadata['num_warps'], metadata['num_stages'])
+    missing = wanted - found.keys()
+    if missing:
+        print(f'{len(missing)} kernels of {kernels_yml} not found in {cache_dir}', file=sys.stderr)
+    return [(name, *found[name]) for name in sorted(found)]
+
+
+#######################
+# Measurement
+#######################
+
+
+def _reset_peak_rss():
+    """ resets the peak RSS of this process; returns False if the kernel doesn't allow it """
+    try:
+        with open('/proc/self/clear_refs', 'w') as f:
+            f.write('5')
+        return True
+    except OSError:
+        return False
+
+
+def _peak_rss_mb(reset_ok):
+    if reset_ok:
+        with open('/proc/self/status') as f:
+            for line in f:
+                if line.startswith('VmHWM:'):
+                    return int(line.split()[1]) / 1024
+    # peak of the whole process so far
+    return resource.getrusage(resource.RUSAGE_SELF).ru_maxrss / 1024
+
+
+def compile_stages(src, arch, num_warps, num_stages):
+    """
+    compiles `src` (a (JITFunction, signature) pair or the path of a TTIR
+    file) to cubin and returns {stage: (seconds, peak RSS in MB)}
+    """
+    context = context_pool.acquire()
+    results = dict()
+
+    def run(stage, fn, *args):
+        reset_ok = _reset_peak_rss()
+        start = time.perf_counter()
+        ret = fn(*args)
+        results[stage] = (time.perf_counter() - start, _peak_rss_mb(reset_ok))
+        return ret
+
+    try:
+        if isinstance(src, str):
+            module = parse_mlir_module(src, context)
+        else:
+            fn, signature = src
+            types, constants, config = parse_signature(signature)
+            module = run('ast->ttir', lambda: optimize_ttir(ast_to_ttir(fn, types, config, constants, debug=False,
+                                                                         arch=arch, context=context), arch))
+        module = run('optimize_ttgir', lambda: optimize_ttgir(ttir_to_ttgir(module, num_warps), num_stages, arch))
+        llir = run('ttgir_to_llir', ttgir_to_llir, module, dict(), arch)
+        ptx = run('llir_to_ptx', llir_to_ptx, llir, arch)
+        run('ptx_to_cubin', ptx_to_cubin, ptx, arch)
+    finally:
+        context_pool.release(context)
+    return results
+
+
+def summarize(samples):
+    times = [t for t, _ in samples]
+    return {'median_ms': statistics.median(times) * 1e3,
+            'min_ms': min(times) * 1e3,
+            'mean_ms': statistics.mean(times) * 1e3,
+            'peak_rss_mb': max(rss for _, rss in samples),
+            'samples_ms': [t * 1e3 for t in times]}
+
+
+def bench(kernels, arch, iters, warmup=1):
+    """ {kernel: {stage: summary}} for `kernels`, a list of (name, src, num_warps, num_stages) """
+    report = dict()
+    for name, src, num_warps, num_stages in kernels:
+        for _ in range(warmup):
+            compile_stages(src, arch, num_warps, num_stages)
+        samples = dict()
+        for _ in range(iters):
+            for stage, sample in compile_stages(src, arch, num_warps, num_stages).items():
+                samples.setdefault(stage, []).append(sample)
+        report[name] = {stage: summarize(samples[stage]) for stage in STAGES if stage in samples}
+        total = sum(s['median_ms'] for s in report[name].values())
+        print(f'{name:<72} ' + '  '.join(f"{stage} {s['median_ms']:8.2f}" for stage, s in report[name].items()) +
+              f'  total {total:8.2f} ms')
+    return report
+
+
+def compare(report, baseline, rtol):
+    regressions = []
+    for name, stages in report.items():
+        for stage, summary in stages.items():
+            base = baseline.get(name, {}).get(stage)
+            if base is not None and summary['median_ms'] > base['median_ms'] * (1 + rtol):
+                regressions.append(f"{name} {stage}: {summary['median_ms']:.2f} ms vs. baseline "
+                                   f"{base['median_ms']:.2f} ms ({summary['median_ms'] / base['median_ms'] - 1:+.1%})")
+    return regressions
+
+
+if __name__ == '__main__':
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description='Triton compile-latency benchmark')
+    parser.add_argument('--out', type=str, default='compile.json', help='JSON file to write results to')
+    parser.add_argument('--iters', type=int, default=10, help='compilations per kernel')
+    parser.add_argument('--cc', type=int, default=None, help='compute capability to compile for')
+    parser.add_argument('--cache-dir', type=str, default=None, help='Triton cache holding the TTIR of kernels.yml')
+    parser.add_argument('--kernels', type=str, default=os.path.join(here, '..', 'kernel_comparison', 'kernels.yml'))
+    parser.add_argument('--filter', type=str, default='', help='only compile kernels whose name contains this string')
+    parser.add_argument('--baseline', type=str, default=None, help='results of a previous run to compare against')
+    parser.add_argument('--rtol', type=float, default=0.1, help='relative slowdown of a stage tolerated')
+    args = parser.parse_args()
+
+    arch = get_architecture_descriptor(args.cc)
+    kernels = [(name, (_jit_function(fn), signature), num_warps, num_stages)
+               for name, (fn, signature, num_warps, num_stages) in OPS_KERNELS.items()]
+    if args.cache_dir:
+        kernels += cached_ttir_kernels(args.cache_dir, args.kernels)
+    kernels = [k for k in kernels if args.filter in k[0]]
+    report = bench(kernels, arch, args.iters)
+    with open(args.out, 'w') as f:
+        json.dump({'arch': arch, 'iters': args.iters, 'triton': triton.__version__, 'kernels': report}, f, indent=2)
+    if args.baseline:
+        with open(args.baseline) as f:
+            regressions = compare(report, json.load(f)['kernels'], args.rtol)
+        if regressions:
+            print(f'{len(regressions)} compile-time regressions:')
+            print('\n'.join(regressions))
+            sys.exit(1)
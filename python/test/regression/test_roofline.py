@@ -0,0 +1,337 @@
+"""
+Roofline regression suite.
+
+Benchmarks production-style kernels (matmul, flash attention, softmax,
+layernorm, scan, reductions, atomics) over dtypes and shapes and reports the
+fraction of the roofline each one achieves: achieved throughput divided by
+min(peak compute, arithmetic intensity * DRAM bandwidth), with peak compute
+taken from the tensor cores for `tl.dot` kernels and from the SIMD units
+otherwise.
+
+Run directly to write results, optionally comparing them to a baseline
+written by a previous run:
+
+    python test_roofline.py --out results.json [--baseline baseline.json] [--filter softmax]
+
+Under pytest, every case is compared to the baseline named by
+`TRITON_ROOFLINE_BASELINE` (cases are skipped without one). A case regresses
+when its mean utilization drops by more than `rtol` of the baseline *and*
+the drop is statistically significant given the spread of both runs.
+"""
+import argparse
+import json
+import math
+import os
+import statistics
+import sys
+
+import pytest
+import torch
+
+import triton
+import triton.language as tl
+import triton.ops
+from triton.testing import get_dram_gbps, get_max_simd_tflops, get_max_tensorcore_tflops
+
+DTYPES = {'float16': torch.float16, 'bfloat16': torch.bfloat16, 'float32': torch.float32}
+
+#######################
+# Kernels
+#######################
+
+
+@triton.jit
+def _softmax(Y, X, stride, N, BLOCK_N: tl.constexpr):
+    row = tl.program_id(0)
+    offs = tl.arange(0, BLOCK_N)
+    x = tl.load(X + row * stride + offs, mask=offs < N, other=-float('inf')).to(tl.float32)
+    x = x - tl.max(x, axis=0)
+    num = tl.exp(x)
+    y = num / tl.sum(num, axis=0)
+    tl.store(Y + row * stride + offs, y.to(Y.dtype.element_ty), mask=offs < N)
+
+
+@triton.jit
+def _layernorm(Y, X, W, B, stride, N, eps, BLOCK_N: tl.constexpr):
+    row = tl.program_id(0)
+    offs = tl.arange(0, BLOCK_N)
+    mask = offs < N
+    x = tl.load(X + row * stride + offs, mask=mask, other=0.).to(tl.float32)
+    mean = tl.sum(x, axis=0) / N
+    xc = tl.where(mask, x - mean, 0.)
+    rstd = 1 / tl.sqrt(tl.sum(xc * xc, axis=0) / N + eps)
+    w = tl.load(W + offs, mask=mask)
+    b = tl.load(B + offs, mask=mask)
+    y = xc * rstd * w + b
+    tl.store(Y + row * stride + offs, y.to(Y.dtype.element_ty), mask=mask)
+
+
+@triton.jit
+def _cumsum(Y, X, stride, N, BLOCK_N: tl.constexpr):
+    row = tl.program_id(0)
+    offs = tl.arange(0, BLOCK_N)
+    x = tl.load(X + row * stride + offs, mask=offs < N, other=0.).to(tl.float32)
+    y = tl.cumsum(x, axis=0)
+    tl.store(Y + row * stride + offs, y.to(Y.dtype.element_ty), mask=offs < N)
+
+
+@triton.jit
+def _row_sum(Y, X, stride, N, BLOCK_N: tl.constexpr):
+    row = tl.program_id(0)
+    acc = tl.zeros([BLOCK_N], dtype=tl.float32)
+    for start in range(0, N, BLOCK_N):
+        offs = start + tl.arange(0, BLOCK_N)
+        acc += tl.load(X + row * stride + offs, mask=offs < N, other=0.).to(tl.float32)
+    tl.store(Y + row, tl.sum(acc, axis=0))
+
+
+@triton.jit
+def _histogram(Out, X, N, NUM_BINS: tl.constexpr, BLOCK: tl.constexpr):
+    offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+    mask = offs < N
+    x = tl.load(X + offs, mask=mask, other=0)
+    tl.atomic_add(Out + x % NUM_BINS, 1, mask=mask)
+
+
+#######################
+# Cases
+#######################
+
+
+class Case:
+    """
+    A benchmark: `setup` returns a zero-argument callable running the kernel,
+    `flops` and `bytes` the work it does, `tensor_cores` whether its peak is
+    that of the tensor cores.
+    """
+
+    def __init__(self, name, params, dtype, setup, flops, bytes, tensor_cores=False):
+        self.name = name
+        self.params = params
+        self.dtype = dtype
+        self.setup = setup
+        self.flops = flops
+        self.bytes = bytes
+        self.tensor_cores = tensor_cores
+
+    @property
+    def id(self):
+        params = '-'.join(f'{k}{v}' for k, v in self.params.items())
+        return f'{self.name}-{params}-{self.dtype}'
+
+
+def _matmul_case(M, N, K, dtype):
+    def setup():
+        a = torch.randn((M, K), dtype=DTYPES[dtype], device='cuda')
+        b = torch.randn((K, N), dtype=DTYPES[dtype], device='cuda')
+        return lambda: triton.ops.matmul(a, b)
+    size = torch.finfo(DTYPES[dtype]).bits // 8
+    return Case('matmul', dict(M=M, N=N, K=K), dtype, setup, 2. * M * N * K,
+                size * (M * K + K * N + M * N), tensor_cores=True)
+
+
+def _attention_case(Z, H, N_CTX, D_HEAD, causal, dtype):
+    def setup():
+        shape = (Z, H, N_CTX, D_HEAD)
+        q, k, v = (torch.randn(shape, dtype=DTYPES[dtype], device='cuda') for _ in range(3))
+        return lambda: triton.ops.attention(q, k, v, causal, 0.2)
+    flops = 4. * Z * H * N_CTX * N_CTX * D_HEAD * (0.5 if causal else 1.)
+    size = torch.finfo(DTYPES[dtype]).bits // 8
+    return Case('attention', dict(Z=Z, H=H, N_CTX=N_CTX, D_HEAD=D_HEAD, causal=int(causal)), dtype, setup,
+                flops, size * 4 * Z * H * N_CTX * D_HEAD, tensor_cores=True)
+
+
+def _row_case(name, kernel, M, N, dtype, flops_per_elem, extra_args=()):
+    def setup():
+        x = torch.randn((M, N), dtype=DTYPES[dtype], device='cuda')
+        y = torch.empty_like(x)
+        args = [arg(N) if callable(arg) else arg for arg in extra_args]
+        BLOCK_N = triton.next_power_of_2(N)
+        num_warps = min(max(BLOCK_N // 256, 1), 16)
+        return lambda: kernel[(M,)](y, x, *args, x.stride(0), N, BLOCK_N=BLOCK_N, num_warps=num_warps)
+    size = torch.finfo(DTYPES[dtype]).bits // 8
+    return Case(name, dict(M=M, N=N), dtype, setup, flops_per_elem * M * N, 2 * size * M * N)
+
+
+def _layernorm_case(M, N, dtype):
+    def setup():
+        x = torch.randn((M, N), dtype=DTYPES[dtype], device='cuda')
+        y = torch.empty_like(x)
+        w = torch.rand((N,), dtype=DTYPES[dtype], device='cuda')
+        b = torch.rand((N,), dtype=DTYPES[dtype], device='cuda')
+        BLOCK_N = triton.next_power_of_2(N)
+        num_warps = min(max(BLOCK_N // 256, 1), 16)
+        return lambda: _layernorm[(M,)](y, x, w, b, x.stride(0), N, 1e-5, BLOCK_N=BLOCK_N, num_warps=num_warps)
+    size = torch.finfo(DTYPES[dtype]).bits // 8
+    return Case('layernorm', dict(M=M, N=N), dtype, setup, 8. * M * N, size * (2 * M * N + 2 * N))
+
+
+def _reduction_case(M, N, dtype):
+    def setup():
+        x = torch.randn((M, N), dtype=DTYPES[dtype], device='cuda')
+        y = torch.empty((M,), dtype=torch.float32, device='cuda')
+        return lambda: _row_sum[(M,)](y, x, x.stride(0), N, BLOCK_N=1024, num_warps=4)
+    size = torch.finfo(DTYPES[dtype]).bits // 8
+    return Case('reduction', dict(M=M, N=N), dtype, setup, 1. * M * N, size * M * N + 4 * M)
+
+
+def _atomics_case(N, num_bins):
+    def setup():
+        x = torch.randint(0, 1 << 20, (N,), dtype=torch.int32, device='cuda')
+        out = torch.zeros((num_bins,), dtype=torch.int32, device='cuda')
+        return lambda: _histogram[(triton.cdiv(N, 1024),)](out, x, N, NUM_BINS=num_bins, BLOCK=1024)
+    # every element is one read and one read-modify-write of a (cached) bin
+    return Case('atomics', dict(N=N, bins=num_bins), 'int32', setup, 1. * N, 4. * N)
+
+
+def make_cases():
+    cases = []
+    for dtype in ['float16', 'bfloat16', 'float32']:
+        for M, N, K in [(1024, 1024, 1024), (4096, 4096, 4096), (8192, 8192, 8192), (16, 8192, 8192),
+                        (8192, 64, 8192)]:
+            cases.append(_matmul_case(M, N, K, dtype))
+        for N_CTX, D_HEAD in [(1024, 64), (4096, 64), (4096, 128)]:
+            for causal in [False, True]:
+                if dtype == 'float32' and D_HEAD > 64:
+                    continue
+                cases.append(_attention_case(4, 48, N_CTX, D_HEAD, causal, dtype))
+        for M, N in [(4096, 1024), (4096, 4096), (2048, 16384)]:
+            cases.append(_row_case('softmax', _softmax, M, N, dtype, 5.))
+            cases.append(_row_case('scan', _cumsum, M, N, dtype, 1.))
+            cases.append(_layernorm_case(M, N, dtype))
+        for M, N in [(4096, 4096), (64, 1 << 20)]:
+            cases.append(_reduction_case(M, N, dtype))
+    for N in [1 << 20, 1 << 26]:
+        for num_bins in [256, 1 << 16]:
+            cases.append(_atomics_case(N, num_bins))
+    return cases
+
+
+#######################
+# Measurement
+#######################
+
+
+def peak_tflops(case):
+    capability = torch.cuda.get_device_capability()
+    dtype = DTYPES.get(case.dtype, torch.float32)
+    if case.tensor_cores and (capability[0] >= 8 or dtype == torch.float16):
+        return get_max_tensorcore_tflops(dtype)
+    if dtype == torch.bfloat16 and capability[0] < 8:
+        dtype = torch.float16
+    return get_max_simd_tflops(dtype if dtype != torch.int32 else torch.float32)
+
+
+def run_case(case, samples=5, rep=100):
+    """ benchmarks `case` `samples` times and returns its JSON record """
+    capability = torch.cuda.get_device_capability()
+    if case.dtype == 'bfloat16' and capability[0] < 8:
+        return None
+    torch.manual_seed(0)
+    fn = case.setup()
+    attainable_tflops = min(peak_tflops(case), case.flops / case.bytes * get_dram_gbps() * 1e-3)
+    times = [triton.testing.do_bench(fn, rep=rep, return_mode='median') for _ in range(samples)]
+    utils = [case.flops / ms * 1e-9 / attainable_tflops for ms in times]
+    return {
+        'id': case.id,
+        'kernel': case.name,
+        'params': case.params,
+        'dtype': case.dtype,
+        'bound': 'compute' if attainable_tflops == peak_tflops(case) else 'dram',
+        'ms': times,
+        'tflops': case.flops / statistics.median(times) * 1e-9,
+        'gbps': case.bytes / statistics.median(times) * 1e-6,
+        'utilization': utils,
+        'utilization_mean': statistics.mean(utils),
+        'utilization_std': statistics.stdev(utils) if len(utils) > 1 else 0.,
+    }
+
+
+def compare(result, base, rtol=0.02, z=3.):
+    """
+    returns a description of the regression of `result` against `base`, or
+    None: the drop in mean utilization must exceed `rtol` of the baseline and
+    `z` standard errors of the difference between the two means
+    """
+    cur, ref = result['utilization_mean'], base['utilization_mean']
+    n_cur, n_ref = len(result['utilization']), len(base['utilization'])
+    stderr = math.sqrt(result['utilization_std'] ** 2 / n_cur + base['utilization_std'] ** 2 / n_ref)
+    drop = ref - cur
+    if drop > rtol * ref and drop > z * stderr:
+        return f"{result['id']}: utilization {cur:.3f} vs. baseline {ref:.3f} ({-drop / ref:+.1%})"
+    return None
+
+
+def device_info():
+    props = torch.cuda.get_device_properties(torch.cuda.current_device())
+    return {'name': props.name, 'capability': list(torch.cuda.get_device_capability()),
+            'dram_gbps': get_dram_gbps(), 'triton': triton.__version__}
+
+
+#######################
+# Pytest entry point
+#######################
+
+
+def _load_baseline():
+    path = os.environ.get('TRITON_ROOFLINE_BASELINE')
+    if not path:
+        return None
+    with open(path) as f:
+        return {r['id']: r for r in json.load(f)['results']}
+
+
+_cases = make_cases() if torch.cuda.is_available() else []
+
+
+@pytest.mark.parametrize('case', _cases, ids=[case.id for case in _cases])
+def test_roofline(case):
+    baseline = _load_baseline()
+    if baseline is None or case.id not in baseline:
+        pytest.skip('no baseline for this case (set TRITON_ROOFLINE_BASELINE)')
+    stream = torch.cuda.Stream()
+    torch.cuda.set_stream(stream)
+    result = run_case(case)
+    if result is None:
+        pytest.skip('dtype not supported on this device')
+    regression = compare(result, baseline[case.id])
+    assert regression is None, regression
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Triton roofline regression suite')
+    parser.add_argument('--out', type=str, default='roofline.json', help='JSON file to write results to')
+    parser.add_argument('--baseline', type=str, default=None, help='results of a previous run to compare against')
+    parser.add_argument('--filter', type=str, default='', help='only run cases whose id contains this string')
+    parser.add_argument('--samples', type=int, default=5, help='number of measurements per case')
+    parser.add_argument('--rtol', type=float, default=0.02, help='relative utilization drop tolerated')
+    parser.add_argument('--z', type=float, default=3., help='standard errors a drop must exceed to count')
+    args = parser.parse_args()
+
+    baseline = None
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = {r['id']: r for r in json.load(f)['results']}
+    results, regressions = [], []
+    for case in make_cases():
+        if args.filter not in case.id:
+            continue
+        result = run_case(case, samples=args.samples)
+        if result is None:
+            continue
+        results.append(result)
+        line = f"{case.id:<60} {statistics.median(result['ms']):8.3f} ms  " \
+               f"{result['utilization_mean']:.3f} of {result['bound']} roofline"
+        if baseline is not None and case.id in baseline:
+            regression = compare(result, baseline[case.id], rtol=args.rtol, z=args.z)
+            line += f"  (baseline {baseline[case.id]['utilization_mean']:.3f})"
+            if regression is not None:
+                regressions.append(regression)
+                line += '  REGRESSION'
+        print(line)
+    with open(args.out, 'w') as f:
+        json.dump({'device': device_info(), 'results': results}, f, indent=2)
+    if regressions:
+        print(f'{len(regressions)} regressions:')
+        print('\n'.join(regressions))
+        sys.exit(1)
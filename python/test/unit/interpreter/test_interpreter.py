@@ -67,3 +67,24 @@ def test_atomic():
 
     atomic[(nb_dim, )](a)
     assert torch.allclose(a, torch.full_like(a, 2))
+
+
+def test_batched_grid(monkeypatch):
+    # batches span several rows of the grid, some of them diverging
+    monkeypatch.setenv("TRITON_INTERPRETER_BATCH_SIZE", "5")
+
+    @triton.jit(interpret=True)
+    def kernel(x_ptr, N: tl.constexpr):
+        pid_m = tl.program_id(axis=0)
+        pid_n = tl.program_id(axis=1)
+        offsets = (pid_m * 3 + pid_n) * N + tl.arange(0, N)
+        if pid_m == 0:
+            tl.store(x_ptr + offsets, -1)
+        else:
+            tl.store(x_ptr + offsets, pid_m * 10 + pid_n + tl.zeros([N], dtype=tl.int32))
+
+    a = torch.zeros((4 * 3, 8), dtype=torch.int32, device="cuda")
+    kernel[(4, 3)](a, N=8)
+    expected = torch.tensor([-1 if m == 0 else m * 10 + n for m in range(4) for n in range(3)],
+                            dtype=torch.int32, device="cuda")
+    assert torch.equal(a, expected[:, None].expand(-1, 8))
@@ -14,6 +14,13 @@ def kernel_device_print(X, Y, BLOCK: tl.constexpr):
     tl.store(Y + tl.arange(0, BLOCK), x)
 
 
+@triton.jit(print_buffer=True)
+def kernel_buffered_print(X, Y, BLOCK: tl.constexpr):
+    x = tl.load(X + tl.arange(0, BLOCK))
+    tl.device_print("", x)
+    tl.store(Y + tl.arange(0, BLOCK), x)
+
+
 @triton.jit
 def kernel_print(X, Y, BLOCK: tl.constexpr):
     x = tl.load(X + tl.arange(0, BLOCK))
@@ -35,6 +42,9 @@ def test_print(func: str, data_type: str):
     y = torch.zeros(shape, dtype=x.dtype, device="cuda")
     if func == "device_print":
         kernel_device_print[(1,)](x, y, BLOCK=shape[0])
+    elif func == "buffered_print":
+        kernel_buffered_print[(1,)](x, y, BLOCK=shape[0])
+        triton.runtime.flush_print_buffer()
     elif func == "print":
         kernel_print[(1,)](x, y, BLOCK=shape[0])
     elif func == "static_print":
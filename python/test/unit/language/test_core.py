@@ -12,6 +12,7 @@ from numpy.random import RandomState
 import triton
 import triton._C.libtriton.triton as _triton
 import triton.language as tl
+from triton.common.backend import get_ptx_version
 from triton.runtime.jit import JITFunction, TensorWrapper, reinterpret
 
 int_dtypes = ['int8', 'int16', 'int32', 'int64']
@@ -914,6 +915,32 @@ def noinline_multi_values_fn(x, y, Z):
     tl.store(Z, z)
 
 
+@triton.jit(noinline=True)
+def noinline_tensor_args_fn(x, y):
+    return tl.dot(x, y), x + 1
+
+
+@pytest.mark.parametrize("num_warps", [1, 4])
+def test_noinline_tensor_args(num_warps, device):
+    @triton.jit
+    def kernel(X, Y, Z, W):
+        offs = tl.arange(0, 16)[:, None] * 16 + tl.arange(0, 16)[None, :]
+        x = tl.load(X + offs)
+        y = tl.load(Y + offs)
+        z, w = noinline_tensor_args_fn(x, y)
+        tl.store(Z + offs, z)
+        tl.store(W + offs, w)
+
+    x = torch.randn((16, 16), device=device, dtype=torch.float16)
+    y = torch.randn((16, 16), device=device, dtype=torch.float16)
+    z = torch.empty((16, 16), device=device, dtype=torch.float32)
+    w = torch.empty_like(x)
+    h = kernel[(1,)](x, y, z, w, num_warps=num_warps)
+    torch.testing.assert_close(z, torch.matmul(x.float(), y.float()), atol=1e-2, rtol=0)
+    torch.testing.assert_close(w, x + 1)
+    assert "call" in h.asm["ptx"]
+
+
 @pytest.mark.parametrize("mode", ["simple", "call_graph", "shared", "dynamic", "multi_values"])
 def test_noinline(mode, device):
     @triton.jit
@@ -1059,6 +1086,34 @@ def test_tensor_atomic_rmw_block(device):
     assert torch.min(x).item() == 0.0
 
 
+@pytest.mark.parametrize("dtype_str, aggregate",
+                         [(dtype_str, aggregate) for dtype_str in ['int32', 'float32', 'float16']
+                          for aggregate in [False, True]])
+def test_tensor_atomic_add_scatter(dtype_str, aggregate, device):
+    check_cuda_only(device)
+    N = 1024
+
+    @triton.jit
+    def kernel(Z, X, IDX, AGGREGATE: tl.constexpr, N: tl.constexpr):
+        off = tl.arange(0, N)
+        x = tl.load(X + off)
+        idx = tl.load(IDX + off)
+        tl.atomic_add(Z + idx, x, mask=off % 7 != 0, aggregate=AGGREGATE)
+
+    rs = RandomState(17)
+    x = numpy_random((N, ), dtype_str=dtype_str, rs=rs)
+    if dtype_str == 'float16':
+        x = np.round(x)
+    # few distinct indices, so that many lanes of a warp collide
+    idx = rs.randint(0, 8, size=(N, )).astype(np.int32)
+    mask = np.arange(N) % 7 != 0
+    z_ref = np.zeros(8, dtype=getattr(np, dtype_str))
+    np.add.at(z_ref, idx[mask], x[mask])
+    z_tri = to_triton(np.zeros(8, dtype=getattr(np, dtype_str)), device=device)
+    kernel[(1,)](z_tri, to_triton(x, device=device), to_triton(idx, device=device), aggregate, N)
+    np.testing.assert_allclose(z_ref, to_numpy(z_tri), rtol=1e-2)
+
+
 @pytest.mark.parametrize("sem", [None, 'acquire', 'release', 'acq_rel', 'relaxed'])
 def test_atomic_cas(sem, device):
     # 1. make sure that atomic_cas changes the original value (Lock)
@@ -1089,7 +1144,35 @@ def test_atomic_cas(sem, device):
     h = serialized_add[(64,)](data, Lock, SEM=sem)
     sem_str = "acq_rel" if sem is None else sem
     np.testing.assert_allclose(to_numpy(data), to_numpy(ref))
-    assert f"atom.global.{sem_str}" in h.asm["ptx"]
+    assert f"atom.global.gpu.{sem_str}" in h.asm["ptx"]
+
+
+@pytest.mark.parametrize("scope", [None, 'cta', 'gpu', 'sys'])
+def test_atomic_scope(scope, device):
+    check_cuda_only(device)
+
+    @triton.jit
+    def kernel(Z, Old, SCOPE: tl.constexpr):
+        off = tl.arange(0, 128)
+        tl.atomic_add(Z + off % 4, 1, sem="relaxed", scope=SCOPE)
+        tl.atomic_add(Z + 4 + off % 4, 1, scope=SCOPE)
+        old = tl.atomic_max(Z + 8 + off % 4, off, scope=SCOPE)
+        tl.store(Old + off, old)
+        tl.atomic_xchg(Z + 12 + off % 4, 1, sem="release", scope=SCOPE)
+
+    z = torch.zeros((16,), device=device, dtype=torch.int32)
+    old = torch.zeros((128,), device=device, dtype=torch.int32)
+    h = kernel[(1,)](z, old, SCOPE=scope)
+    scope_str = "gpu" if scope is None else scope
+    assert torch.all(z[:8] == 32)
+    assert torch.all(z[8:12] == torch.arange(124, 128, device=device, dtype=torch.int32))
+    assert torch.all(z[12:] == 1)
+    # the result of the relaxed add is unused, so it is a reduction
+    assert f"red.global.{scope_str}.relaxed.add.s32" in h.asm["ptx"]
+    # red has no acq_rel semantics and no exchange
+    assert f"atom.global.{scope_str}.acq_rel.add.s32" in h.asm["ptx"]
+    assert f"atom.global.{scope_str}.release.exch.b32" in h.asm["ptx"]
+    assert f"atom.global.{scope_str}.acq_rel.max.s32" in h.asm["ptx"]
 
 
 # ---------------
@@ -1338,6 +1421,43 @@ def test_fp8_fpN_roundtrip(in_dtype, out_dtype, device):
     copy_kernel[(1,)](tri_fp16, triton.reinterpret(ref_fp8, in_dtype), tri_fp16.shape[0], BLOCK_SIZE=1024)
     assert torch.all(tri_fp8 == ref_fp8)
 
+
+@pytest.mark.parametrize("out_dtype", [tl.float8e4, tl.float8e5])
+def test_quantized_store(out_dtype, device):
+    check_cuda_only(device)
+    capability = torch.cuda.get_device_capability()
+    if capability < (8, 9):
+        pytest.skip("Saturating fp8 conversions need sm_89+")
+
+    @triton.jit
+    def kernel(X, Y, Scale, Amax, N, BLOCK: tl.constexpr):
+        offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        mask = offs < N
+        x = tl.load(X + offs, mask=mask)
+        tl.store(Y + offs, x, mask=mask, quantize=Y.dtype.element_ty, scale_ptr=Scale, amax_ptr=Amax)
+
+    N = 1000
+    x = torch.randn(N, dtype=torch.float32, device=device) * 1000
+    scale = torch.tensor([0.5], dtype=torch.float32, device=device)
+    amax = torch.zeros(1, dtype=torch.float32, device=device)
+    y = torch.empty(N, dtype=torch.int8, device=device)
+    kernel[(triton.cdiv(N, 128),)](x, triton.reinterpret(y, out_dtype), scale, amax, N, BLOCK=128)
+    assert amax.item() == x.abs().max().item()
+
+    @triton.jit
+    def dequantize(X, Y, N, BLOCK: tl.constexpr):
+        offs = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        mask = offs < N
+        tl.store(Y + offs, tl.load(X + offs, mask=mask).to(tl.float32), mask=mask)
+
+    z = torch.empty(N, dtype=torch.float32, device=device)
+    dequantize[(triton.cdiv(N, 128),)](triton.reinterpret(y, out_dtype), z, N, BLOCK=128)
+    max_finite = 448. if out_dtype == tl.float8e4 else 57344.
+    ref = torch.clamp(x * scale, -max_finite, max_finite)
+    # out of range values saturate instead of overflowing to inf or NaN
+    assert torch.all(torch.isfinite(z))
+    torch.testing.assert_close(z, ref, rtol=0.125, atol=2**-6)
+
 # ---------------
 # test reduce
 # ---------------
@@ -1905,6 +2025,50 @@ def test_generic_reduction(device):
     torch.testing.assert_close(out_var, expect_var)
 
 
+@pytest.mark.parametrize("axis", [(0, 1), (1, 2), (0, 2), (-1, 0), (0, 1, 2)])
+def test_reduce_multi_axis(axis, device):
+    @triton.jit
+    def kernel(X, Z, A: tl.constexpr, B: tl.constexpr, C: tl.constexpr, AXIS: tl.constexpr, N: tl.constexpr):
+        ra = tl.arange(0, A)[:, None, None]
+        rb = tl.arange(0, B)[None, :, None]
+        rc = tl.arange(0, C)[None, None, :]
+        x = tl.load(X + ra * B * C + rb * C + rc)
+        z = tl.sum(x, axis=AXIS)
+        if N == 1:
+            tl.store(Z, z)
+        else:
+            tl.store(Z + tl.arange(0, N), z)
+
+    shape = (4, 8, 16)
+    x = torch.rand(shape, device=device)
+    z_ref = torch.sum(x, dim=axis)
+    z = torch.empty(z_ref.numel(), device=device)
+    kernel[(1,)](x, z, *shape, AXIS=axis, N=z_ref.numel())
+    torch.testing.assert_close(z, z_ref.flatten())
+
+
+def test_sibling_reductions(device):
+    @triton.jit
+    def kernel(X, Y, OUT_MAX, OUT_SUM, M: tl.constexpr, N: tl.constexpr):
+        rm = tl.arange(0, M)
+        rn = tl.arange(0, N)
+        x = tl.load(X + rm[:, None] * N + rn[None, :])
+        y = tl.load(Y + rm[:, None] * N + rn[None, :])
+        tl.store(OUT_MAX + rm, tl.max(x, axis=1))
+        tl.store(OUT_SUM + rm, tl.sum(y * y, axis=1))
+
+    M, N = 32, 64
+    x = torch.randn((M, N), device=device)
+    y = torch.randn((M, N), device=device)
+    out_max = torch.empty(M, device=device)
+    out_sum = torch.empty(M, device=device)
+    pgm = kernel[(1,)](x, y, out_max, out_sum, M=M, N=N)
+    # both reductions share a single tt.reduce
+    assert pgm.asm['ttir'].count('tt.reduce"') == 1
+    torch.testing.assert_close(out_max, x.max(dim=1)[0])
+    torch.testing.assert_close(out_sum, (y * y).sum(dim=1))
+
+
 # ---------------
 # test permute
 # ---------------
@@ -2160,6 +2324,50 @@ def test_dot(M, N, K, num_warps, col_a, col_b, epilogue, allow_tf32, in_dtype, o
         assert 'mma.sync.aligned.m16n8k16.row.col.f16.f16.f16.f16' in ptx
 
 
+@pytest.mark.parametrize("a_dtype, b_dtype",
+                         [(a, b) for a in ['float8e4', 'float8e5'] for b in ['float8e4', 'float8e5']])
+def test_dot_fp8(a_dtype, b_dtype, device):
+    check_cuda_only(device)
+    M, N, K = 64, 64, 64
+
+    @triton.jit
+    def upcast(X, Y, N: tl.constexpr):
+        off = tl.arange(0, N)
+        tl.store(Y + off, tl.load(X + off).to(tl.float16))
+
+    @triton.jit
+    def kernel(X, Y, Z, M: tl.constexpr, N: tl.constexpr, K: tl.constexpr):
+        off_m = tl.arange(0, M)
+        off_n = tl.arange(0, N)
+        off_k = tl.arange(0, K)
+        x = tl.load(X + off_m[:, None] * K + off_k[None, :])
+        y = tl.load(Y + off_k[:, None] + off_n[None, :] * K)
+        tl.store(Z + off_m[:, None] * N + off_n[None, :], tl.dot(x, y))
+
+    def random_fp8(shape, dtype):
+        # finite values only: all exponent bits set is nan or inf
+        bits = torch.randint(0, 256, shape, dtype=torch.int16, device=device).to(torch.int8)
+        exp_mask = 0b01111000 if dtype == 'float8e4' else 0b01111100
+        bits[(bits & exp_mask) == exp_mask] = 0
+        fp8 = triton.reinterpret(bits, getattr(tl, dtype))
+        fp16 = torch.empty(shape, dtype=torch.float16, device=device)
+        upcast[(1,)](fp8, fp16, bits.numel())
+        return fp8, fp16
+
+    torch.manual_seed(17)
+    x, x_ref = random_fp8((M, K), a_dtype)
+    y, y_ref = random_fp8((N, K), b_dtype)
+    z = torch.empty((M, N), dtype=torch.float32, device=device)
+    h = kernel[(1,)](x, y, z, M, N, K)
+    z_ref = torch.matmul(x_ref.float(), y_ref.float().t())
+    torch.testing.assert_close(z, z_ref, rtol=1e-2, atol=1e-2)
+    capability = torch.cuda.get_device_capability()
+    if capability[0] * 10 + capability[1] >= 89 and get_ptx_version() >= 84:
+        assert "cvt.rn.f16x2.e" not in h.asm["ptx"]
+        fp8_names = {'float8e4': 'e4m3', 'float8e5': 'e5m2'}
+        assert f"{fp8_names[a_dtype]}.{fp8_names[b_dtype]}" in h.asm["ptx"]
+
+
 @pytest.mark.parametrize('in_dtype', ['float32'])
 def test_dot_mulbroadcastred(in_dtype, device):
     @triton.jit
@@ -3173,6 +3381,31 @@ def test_smid(device):
     assert out.sort()[0].unique().shape[0] > 0
     assert h.asm["ptx"].count("%smid") == 2
 
+
+def test_profile_region(device):
+    check_cuda_only(device)
+
+    @triton.jit
+    def kernel(Out):
+        off = tl.arange(0, 128)
+        tl.profile_region_begin("outer")
+        for i in range(100):
+            tl.profile_region_begin("inner")
+            tl.store(Out + off, tl.load(Out + off) + 1)
+            tl.profile_region_end("inner")
+        tl.profile_region_end("outer")
+
+    out = to_triton(np.zeros((128,), dtype=np.int64), device=device)
+    h = kernel[(2,)](out, num_warps=4)
+    regions = h.profile()
+    assert list(regions) == ["outer", "inner"]
+    # every warp of every program goes through the regions
+    assert regions["outer"]["count"] == 2 * 4
+    assert regions["inner"]["count"] == 2 * 4 * 100
+    assert 0 < regions["inner"]["cycles"] < regions["outer"]["cycles"]
+    h.reset_profile()
+    assert h.profile()["outer"]["count"] == 0
+
 # -----------------------
 # test layout conversions
 # -----------------------
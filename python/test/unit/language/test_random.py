@@ -134,6 +134,62 @@ def test_randint(size, seed, device):
     out_ref = [gen.random_raw()[0] for _ in out_tri]
     assert out_tri == out_ref
 
+# test generation of random uint32, four per Philox evaluation
+
+
+@pytest.mark.parametrize('size, seed',
+                         [(size, seed) for size in [10, 10000]
+                          for seed in [0, 42, 0xdeadbeefcafeb0ba]]
+                         )
+def test_randint4x_contiguous(size, seed, device):
+    @triton.jit
+    def kernel(X, N, seed):
+        counter = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        rand = tl.randint4x_contiguous(seed, counter)
+        offset = counter[:, None] * 4 + tl.arange(0, 4)[None, :]
+        tl.store(X + offset, rand, mask=offset < N)
+    # triton result
+    x = torch.empty(size, dtype=torch.int32, device=device)
+    N = x.numel()
+    grid = (triton.cdiv(N, 4 * BLOCK),)
+    kernel[grid](x, N, seed)
+    out_tri = x.cpu().numpy().astype(np.uint32).flatten().tolist()
+    # reference result: all four numbers of each evaluation, in order
+    gen = CustomPhilox(seed, config=PHILOX_32)
+    out_ref = [gen.random_raw() for _ in out_tri]
+    assert out_tri == out_ref
+
+
+@pytest.mark.parametrize('p', [0.1, 0.5])
+def test_dropout_mask_bits(p, device):
+    @triton.jit
+    def bits_kernel(BITS, W, seed, p):
+        offset = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        tl.store(BITS + offset, tl.dropout_mask_bits(seed, offset, p), mask=offset < W)
+
+    @triton.jit
+    def keep_kernel(BITS, KEEP, N):
+        offset = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        words = tl.load(BITS + offset // 32, mask=offset < N)
+        tl.store(KEEP + offset, tl.dropout_mask_from_bits(words, offset), mask=offset < N)
+
+    @triton.jit
+    def rand_kernel(X, N, seed):
+        counter = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        offset = counter[:, None] * 4 + tl.arange(0, 4)[None, :]
+        tl.store(X + offset, tl.rand4x_contiguous(seed, counter), mask=offset < N)
+
+    N, seed = 100000, 42
+    W = triton.cdiv(N, 32)
+    bits = torch.empty(W, dtype=torch.int32, device=device)
+    bits_kernel[(triton.cdiv(W, BLOCK),)](bits, W, seed, p)
+    keep = torch.empty(N, dtype=torch.bool, device=device)
+    keep_kernel[(triton.cdiv(N, BLOCK),)](bits, keep, N)
+    x = torch.empty(N, dtype=torch.float32, device=device)
+    rand_kernel[(triton.cdiv(N, 4 * BLOCK),)](x, N, seed)
+    assert torch.equal(keep, x > p)
+    assert abs(keep.float().mean().item() - (1 - p)) < 1e-2
+
 # test uniform PRNG
 
 
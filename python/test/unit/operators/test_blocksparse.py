@@ -142,6 +142,21 @@ def test_softmax(BLOCK, WIDTH, is_dense, Z=2, H=2, is_causal=True, scale=0.4):
     torch.testing.assert_allclose(da_tri, da_ref)
 
 
+@pytest.mark.parametrize("trans", [False, True])
+def test_lut_compact(trans, H=3, M=17, N=45):
+    from triton.ops.blocksparse.lut import compact
+    layout = torch.randint(2, (H, M, N), dtype=torch.int64, device="cuda")
+    layout = layout.transpose(1, 2) if trans else layout
+    sizes, offsets, nnz, rank = compact(layout)
+    ref_nnz = layout.nonzero(as_tuple=False)
+    ref_sizes = layout.sum(-1).flatten()
+    torch.testing.assert_close(nnz, ref_nnz)
+    torch.testing.assert_close(sizes, ref_sizes)
+    torch.testing.assert_close(offsets[1:], torch.cumsum(ref_sizes, 0)[:-1])
+    torch.testing.assert_close(rank[ref_nnz[:, 0], ref_nnz[:, 1], ref_nnz[:, 2]],
+                               torch.arange(ref_nnz.shape[0], device="cuda"))
+
+
 @pytest.mark.parametrize("block", [16, 32, 64])
 @pytest.mark.parametrize("dtype", [torch.float16, torch.float32])
 def test_attention_fwd_bwd(
@@ -11,6 +11,12 @@ import triton.ops
                              for N in [512, 857, 1871, 2089, 8573, 31000]
                              for dtype in ['float16', 'float32']
                              for mode in ['forward', 'backward']
+                         ] + [
+                             # large vocabularies are streamed in several chunks
+                             (M, N, dtype, mode) for M in [64]
+                             for N in [128256, 256000]
+                             for dtype in ['float16', 'float32']
+                             for mode in ['forward', 'backward']
                          ]
                          )
 def test_op(M, N, dtype, mode):
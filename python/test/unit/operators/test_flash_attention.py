@@ -48,3 +48,47 @@ def test_op(Z, H, N_CTX, D_HEAD, dtype, causal, seq_par):
     torch.testing.assert_allclose(ref_dv, tri_dv, atol=atol, rtol=0)
     torch.testing.assert_allclose(ref_dk, tri_dk, atol=atol, rtol=0)
     torch.testing.assert_allclose(ref_dq, tri_dq, atol=atol, rtol=0)
+
+
+@pytest.mark.parametrize('seqlens_q, seqlens_k', [([1, 1, 1, 1], [1, 17, 250, 1024]),
+                                                  ([1, 37, 128, 200], [16, 37, 300, 200])])
+@pytest.mark.parametrize('H, D_HEAD', [(4, 64), (2, 128)])
+@pytest.mark.parametrize('page_size', [16, 64])
+@pytest.mark.parametrize('causal', [True, False])
+def test_paged_op(seqlens_q, seqlens_k, H, D_HEAD, page_size, causal):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8:
+        pytest.skip("Flash attention only supported for compute capability < 80")
+    torch.manual_seed(20)
+    dtype = torch.float16
+    sm_scale = 0.5
+    Z = len(seqlens_q)
+    # scatter every sequence over randomly permuted pages of the cache
+    pages_per_seq = [triton.cdiv(n, page_size) for n in seqlens_k]
+    max_pages = max(pages_per_seq)
+    perm = torch.randperm(Z * max_pages, device="cuda").to(torch.int32)
+    block_table = perm.view(Z, max_pages)
+    k_cache = torch.empty((Z * max_pages, page_size, H, D_HEAD), dtype=dtype, device="cuda").normal_(mean=0., std=0.5)
+    v_cache = torch.empty_like(k_cache).normal_(mean=0., std=0.5)
+    q = torch.empty((sum(seqlens_q), H, D_HEAD), dtype=dtype, device="cuda").normal_(mean=0., std=0.5)
+    cu_seqlens_q = torch.tensor([0] + seqlens_q, dtype=torch.int32, device="cuda").cumsum(0).to(torch.int32)
+    seqlens_k_t = torch.tensor(seqlens_k, dtype=torch.int32, device="cuda")
+    # reference implementation, one sequence at a time
+    ref_out = torch.empty_like(q)
+    for z in range(Z):
+        n_q, n_k = seqlens_q[z], seqlens_k[z]
+        pages = block_table[z, :pages_per_seq[z]].long()
+        k = k_cache[pages].reshape(-1, H, D_HEAD)[:n_k].transpose(0, 1)
+        v = v_cache[pages].reshape(-1, H, D_HEAD)[:n_k].transpose(0, 1)
+        qz = q[cu_seqlens_q[z]:cu_seqlens_q[z + 1]].transpose(0, 1)
+        p = torch.matmul(qz, k.transpose(1, 2)) * sm_scale
+        if causal:
+            pos_q = torch.arange(n_k - n_q, n_k, device="cuda")
+            pos_k = torch.arange(n_k, device="cuda")
+            p[:, pos_q[:, None] < pos_k[None, :]] = float("-inf")
+        p = torch.softmax(p.float(), dim=-1).to(dtype)
+        ref_out[cu_seqlens_q[z]:cu_seqlens_q[z + 1]] = torch.matmul(p, v).transpose(0, 1)
+    # triton implementation
+    tri_out = triton.ops.paged_attention(q, k_cache, v_cache, cu_seqlens_q, seqlens_k_t, block_table,
+                                         sm_scale, causal, max_seqlen_q=max(seqlens_q))
+    torch.testing.assert_allclose(ref_out, tri_out, atol=1e-2, rtol=0)
@@ -160,10 +160,116 @@ def test_op(BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K, NWARP, NSTAGE, M, N, K, AT, BT,
             a = triton.reinterpret(a, getattr(tl, ADTYPE))
         if b_fp8:
             b = triton.reinterpret(b, getattr(tl, BDTYPE))
-        tt_c = triton.ops.matmul(a, b)
+        # data-parallel or split-K, as configured above
+        tt_c = triton.ops.matmul(a, b, None, False)
         atol, rtol = 1e-2, 0
         if ADTYPE == torch.bfloat16 or BDTYPE == torch.bfloat16:
             atol, rtol = 3.5e-2, 0
         torch.testing.assert_allclose(th_c, tt_c, atol=atol, rtol=rtol)
     except triton.OutOfResources as e:
         pytest.skip(str(e))
+
+
+@pytest.mark.parametrize(
+    "BLOCK_M, BLOCK_N, BLOCK_K, NWARP, NSTAGE, M, N, K",
+    [
+        # a single tile split between programs
+        (64, 64, 32, 4, 2, 64, 64, 4096),
+        # more tiles than SMs, ending within tiles
+        (64, 64, 32, 4, 3, 1000, 1000, 392),
+        (128, 64, 32, 4, 3, 512, 768, 1024),
+    ],
+)
+def test_stream_k(BLOCK_M, BLOCK_N, BLOCK_K, NWARP, NSTAGE, M, N, K):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 7:
+        pytest.skip("Only test tl.dot() on devices with sm >= 70")
+    torch.manual_seed(0)
+    kwargs = {'BLOCK_M': BLOCK_M, 'BLOCK_N': BLOCK_N, 'BLOCK_K': BLOCK_K}
+    kernel = triton.ops._matmul.kernel_stream_k
+    kernel.configs = [triton.Config(kwargs=kwargs, num_warps=NWARP, num_stages=NSTAGE)]
+    a = .1 * torch.randn((M, K), device="cuda", dtype=torch.float16)
+    b = .1 * torch.randn((K, N), device="cuda", dtype=torch.float16)
+    th_c = torch.matmul(a.to(torch.float32), b.to(torch.float32))
+    tt_c = triton.ops.matmul(a, b, None, True)
+    torch.testing.assert_allclose(th_c, tt_c, atol=1e-2, rtol=0)
+    # partial tiles are always added in the same order
+    assert torch.equal(tt_c, triton.ops.matmul(a, b, None, True))
+
+
+@pytest.mark.parametrize(
+    "EPILOGUE, BIAS_SHAPE, RESIDUAL, ALPHA, STREAM_K",
+    [
+        (epilogue, bias_shape, residual, alpha, stream_k)
+        for epilogue in ["linear", "gelu", "silu"]
+        for bias_shape in [None, (384,), (256, 1)]
+        for residual in [False, True]
+        for alpha in [None, 0.5]
+        for stream_k in [False, True]
+    ],
+)
+def test_epilogue(EPILOGUE, BIAS_SHAPE, RESIDUAL, ALPHA, STREAM_K):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 7:
+        pytest.skip("Only test tl.dot() on devices with sm >= 70")
+    torch.manual_seed(0)
+    M, N, K = 256, 384, 512
+    kwargs = {'BLOCK_M': 64, 'BLOCK_N': 64, 'BLOCK_K': 32}
+    # split-K applies the epilogue to partial sums, and must be pruned
+    triton.ops._matmul.kernel.configs = [
+        triton.Config(kwargs={**kwargs, 'SPLIT_K': 1}, num_warps=4, num_stages=3),
+        triton.Config(kwargs={**kwargs, 'SPLIT_K': 2}, num_warps=4, num_stages=3,
+                      pre_hook=lambda nargs: nargs['C'].zero_()),
+    ]
+    triton.ops._matmul.kernel_stream_k.configs = [triton.Config(kwargs=kwargs, num_warps=4, num_stages=3)]
+    a = .1 * torch.randn((M, K), device="cuda", dtype=torch.float16)
+    b = .1 * torch.randn((K, N), device="cuda", dtype=torch.float16)
+    bias = None if BIAS_SHAPE is None else torch.randn(BIAS_SHAPE, device="cuda", dtype=torch.float16)
+    residual = torch.randn((M, N), device="cuda", dtype=torch.float16) if RESIDUAL else None
+    th_c = torch.matmul(a.to(torch.float32), b.to(torch.float32))
+    if ALPHA is not None:
+        th_c = ALPHA * th_c
+    if bias is not None:
+        th_c = th_c + bias.to(torch.float32)
+    if EPILOGUE == "gelu":
+        th_c = torch.nn.functional.gelu(th_c)
+    elif EPILOGUE == "silu":
+        th_c = torch.nn.functional.silu(th_c)
+    if residual is not None:
+        th_c = th_c + residual.to(torch.float32)
+    epilogue = {"linear": None, "gelu": triton.ops.gelu_epilogue, "silu": triton.ops.silu_epilogue}[EPILOGUE]
+    tt_c = triton.ops.matmul(a, b, stream_k=STREAM_K, epilogue=epilogue, bias=bias, residual=residual, alpha=ALPHA)
+    torch.testing.assert_allclose(th_c, tt_c.to(torch.float32), atol=1e-2, rtol=1e-2)
+
+
+@pytest.mark.parametrize(
+    "SIZES, DTYPE",
+    [
+        # experts of a mixture-of-experts layer: same N and K, rows routed unevenly
+        ([(M, 512, 256) for M in [0, 7, 130, 1, 64, 999]], "float16"),
+        ([(M, 512, 256) for M in [0, 7, 130, 1, 64, 999]], "bfloat16"),
+        # unrelated problems, K not a multiple of the blocks
+        ([(33, 65, 129), (256, 128, 64), (1, 300, 17)], "float16"),
+        ([(33, 65, 129), (256, 128, 64), (1, 300, 17)], "float32"),
+    ],
+)
+def test_grouped_matmul(SIZES, DTYPE):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 7:
+        pytest.skip("Only test tl.dot() on devices with sm >= 70")
+    if capability[0] < 8 and DTYPE == "bfloat16":
+        pytest.skip("Only test bfloat16 on devices with sm >= 80")
+    torch.manual_seed(0)
+    dtype = getattr(torch, DTYPE)
+    triton.ops._matmul.kernel_grouped.configs = [
+        triton.Config(kwargs={'BLOCK_M': 64, 'BLOCK_N': 64, 'BLOCK_K': 32}, num_warps=4, num_stages=3),
+        triton.Config(kwargs={'BLOCK_M': 32, 'BLOCK_N': 64, 'BLOCK_K': 64}, num_warps=4, num_stages=3),
+    ]
+    a = [.1 * torch.randn((M, K), device="cuda", dtype=dtype) for M, N, K in SIZES]
+    # transposed operands are walked through their strides
+    b = [.1 * torch.randn((N, K), device="cuda", dtype=dtype).t() for M, N, K in SIZES]
+    tt_c = triton.ops.grouped_matmul(a, b)
+    assert len(tt_c) == len(SIZES)
+    for x, y, c in zip(a, b, tt_c):
+        th_c = torch.matmul(x.to(torch.float32), y.to(torch.float32))
+        torch.testing.assert_allclose(th_c, c.to(torch.float32), atol=1e-2, rtol=1e-2)
@@ -0,0 +1,98 @@
+import pytest
+import torch
+
+import triton
+import triton.language as tl
+import triton.ops
+
+
+def torch_norm(x, weight, bias, eps, is_rms):
+    x = x.float()
+    if is_rms:
+        y = x * torch.rsqrt(x.pow(2).mean(-1, keepdim=True) + eps) * weight.float()
+    else:
+        y = torch.nn.functional.layer_norm(x, (x.shape[-1], ), weight.float(), bias.float(), eps)
+    return y
+
+
+@pytest.mark.parametrize("M, N, dtype, is_rms, has_residual",
+                         [
+                             (M, N, dtype, is_rms, has_residual) for M in [1, 151, 1823]
+                             for N in [512, 1151, 4096]
+                             for dtype in ['float16', 'float32']
+                             for is_rms in [False, True]
+                             for has_residual in [False, True]
+                         ] + [
+                             # wide rows are streamed in several chunks
+                             (M, N, dtype, is_rms, has_residual) for M in [64]
+                             for N in [20000, 65536]
+                             for dtype in ['float16']
+                             for is_rms in [False, True]
+                             for has_residual in [False, True]
+                         ]
+                         )
+def test_op(M, N, dtype, is_rms, has_residual):
+    dtype = {'float16': torch.float16, 'float32': torch.float32}[dtype]
+    eps = 1e-5
+    x = torch.randn(M, N, dtype=dtype, device='cuda', requires_grad=True)
+    weight = torch.rand(N, dtype=dtype, device='cuda', requires_grad=True)
+    bias = None if is_rms else torch.randn(N, dtype=dtype, device='cuda', requires_grad=True)
+    residual = torch.randn(M, N, dtype=dtype, device='cuda', requires_grad=True) if has_residual else None
+    dy = 0.1 * torch.randn(M, N, dtype=dtype, device='cuda')
+    params = [x, weight] + ([bias] if bias is not None else []) + ([residual] if residual is not None else [])
+    # triton
+    if is_rms:
+        tt_y = triton.ops.rms_norm(x, weight, eps=eps, residual=residual)
+    else:
+        tt_y = triton.ops.layer_norm(x, weight, bias, eps=eps, residual=residual)
+    if has_residual:
+        tt_y, tt_h = tt_y
+        torch.testing.assert_close(tt_h, x + residual)
+    tt_y.backward(dy)
+    tt_grads = [p.grad.clone() for p in params]
+    for p in params:
+        p.grad = None
+    # torch
+    h = x + residual if has_residual else x
+    th_y = torch_norm(h, weight, bias, eps, is_rms)
+    th_y.backward(dy.float())
+    th_grads = [p.grad.clone() for p in params]
+    atol = 1e-2 if dtype == torch.float16 else 1e-4
+    torch.testing.assert_close(tt_y.float(), th_y, atol=atol, rtol=0)
+    for tt_g, th_g in zip(tt_grads, th_grads):
+        torch.testing.assert_close(tt_g.float(), th_g.float(), atol=atol * 10, rtol=atol)
+
+
+@pytest.mark.parametrize("N", [1024, 20000])
+def test_deterministic_backward(N):
+    M = 4096
+    x = torch.randn(M, N, dtype=torch.float16, device='cuda', requires_grad=True)
+    weight = torch.rand(N, dtype=torch.float16, device='cuda', requires_grad=True)
+    bias = torch.randn(N, dtype=torch.float16, device='cuda', requires_grad=True)
+    dy = torch.randn(M, N, dtype=torch.float16, device='cuda')
+    grads = []
+    for _ in range(2):
+        triton.ops.layer_norm(x, weight, bias).backward(dy)
+        grads.append((weight.grad.clone(), bias.grad.clone()))
+        weight.grad = bias.grad = None
+    assert torch.equal(grads[0][0], grads[1][0])
+    assert torch.equal(grads[0][1], grads[1][1])
+
+
+def test_fp8_output():
+    M, N = 256, 1024
+    x = torch.randn(M, N, dtype=torch.float16, device='cuda')
+    weight = torch.rand(N, dtype=torch.float16, device='cuda')
+    scale = 4.
+
+    @triton.jit
+    def f8_to_f16(Y, X, N, BLOCK_SIZE: tl.constexpr):
+        offs = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        tl.store(Y + offs, tl.load(X + offs, mask=offs < N), mask=offs < N)
+
+    y = triton.ops.rms_norm(x, weight, out_dtype=tl.float8e5, out_scale=scale)
+    out = torch.empty((M, N), dtype=torch.float16, device='cuda')
+    f8_to_f16[(triton.cdiv(M * N, 1024), )](out, y, M * N, BLOCK_SIZE=1024)
+    ref = torch_norm(x, weight, None, 1e-6, True) * scale
+    # e5m2 keeps 2 bits of mantissa
+    torch.testing.assert_close(out.float(), ref, atol=1e-1, rtol=0.125)
@@ -0,0 +1,38 @@
+import pytest
+import torch
+
+import triton
+import triton.ops
+
+
+@pytest.mark.parametrize("N, dtype, op",
+                         [
+                             (N, dtype, op) for N in [1, 1000, 100003, 3000000]
+                             for dtype in ['int32', 'float32', 'float16', 'float64']
+                             for op in ['sum', 'max', 'min']
+                         ]
+                         )
+def test_op(N, dtype, op):
+    torch.manual_seed(0)
+    dtype = {'int32': torch.int32, 'float16': torch.float16, 'float32': torch.float32,
+             'float64': torch.float64}[dtype]
+    if dtype.is_floating_point:
+        x = torch.randn(N, dtype=dtype, device='cuda')
+    else:
+        x = torch.randint(-100, 100, (N, ), dtype=dtype, device='cuda')
+    tt_y = triton.ops.global_reduce(x, op)
+    th_y = getattr(torch, {'sum': 'sum', 'max': 'amax', 'min': 'amin'}[op])(x.to(torch.float64 if dtype.is_floating_point else torch.int64))
+    if dtype.is_floating_point:
+        assert tt_y.dtype == dtype
+        atol = {torch.float16: 1e-2, torch.float32: 1e-4, torch.float64: 1e-10}[dtype] * (N ** 0.5)
+        torch.testing.assert_close(tt_y.to(torch.float64), th_y, atol=atol, rtol=1e-2)
+    else:
+        torch.testing.assert_close(tt_y, th_y.to(tt_y.dtype))
+
+
+def test_deterministic():
+    torch.manual_seed(0)
+    x = torch.randn(10000019, dtype=torch.float32, device='cuda')
+    ref = triton.ops.global_reduce(x)
+    for _ in range(10):
+        assert torch.equal(triton.ops.global_reduce(x), ref)
@@ -0,0 +1,31 @@
+import pytest
+import torch
+
+import triton
+import triton.ops
+
+
+@pytest.mark.parametrize("N, dtype, block",
+                         [
+                             (N, dtype, block) for N in [1, 1000, 4096, 100003, 3000000]
+                             for dtype in ['int32', 'float32', 'float16', 'float64']
+                             for block in [256, 1024]
+                         ]
+                         )
+def test_op(N, dtype, block):
+    torch.manual_seed(0)
+    dtype = {'int32': torch.int32, 'float16': torch.float16, 'float32': torch.float32,
+             'float64': torch.float64}[dtype]
+    if dtype.is_floating_point:
+        x = torch.randn(N, dtype=dtype, device='cuda')
+    else:
+        x = torch.randint(-100, 100, (N, ), dtype=dtype, device='cuda')
+    tt_y = triton.ops.cumsum(x, block=block)
+    th_y = torch.cumsum(x.to(torch.float64 if dtype.is_floating_point else torch.int64), 0)
+    assert tt_y.dtype == dtype
+    if dtype.is_floating_point:
+        # the error of the sums grows with their number of terms
+        atol = {torch.float16: 1e-2, torch.float32: 1e-4, torch.float64: 1e-10}[dtype] * (N ** 0.5)
+        torch.testing.assert_close(tt_y.to(torch.float64), th_y, atol=atol, rtol=1e-2)
+    else:
+        torch.testing.assert_close(tt_y, th_y.to(dtype))
@@ -0,0 +1,28 @@
+import pytest
+import torch
+
+import triton
+import triton.ops
+
+
+@pytest.mark.parametrize("M, N, K, dtype",
+                         [
+                             (M, N, K, dtype) for M, N, K in [(128, 128, 128), (256, 512, 1024), (100, 300, 272)]
+                             for dtype in ['float16', 'bfloat16']
+                         ]
+                         )
+def test_op(M, N, K, dtype):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8:
+        pytest.skip("Only test sparse_matmul on compute capability >= 80")
+    torch.manual_seed(0)
+    dtype = {'float16': torch.float16, 'bfloat16': torch.bfloat16}[dtype]
+    a = torch.randn((M, K), device='cuda', dtype=dtype)
+    b = torch.randn((K, N), device='cuda', dtype=dtype)
+    values, meta = triton.ops.compress_2_4(a)
+    a_pruned = triton.ops.decompress_2_4(values, meta)
+    # two of every four elements are kept
+    assert (a_pruned.view(M, K // 4, 4) != 0).sum(-1).max() <= 2
+    tt_c = triton.ops.sparse_matmul(values, meta, b)
+    th_c = torch.matmul(a_pruned.float(), b.float())
+    torch.testing.assert_close(tt_c.float(), th_c, atol=1e-1, rtol=1e-2)
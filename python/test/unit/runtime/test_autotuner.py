@@ -1,3 +1,4 @@
+import pytest
 import torch
 
 import triton
@@ -20,3 +21,244 @@ def test_kwargs():
     grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']),)
     _kernel[grid](dst, src, N)
     _kernel[grid](dst=dst, src=src, N=N)
+
+
+def test_parallel_compile():
+    N = 1024
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 32}), triton.Config(kwargs={'BLOCK_SIZE': 128}),
+               triton.Config(kwargs={'BLOCK_SIZE': 128}, num_warps=8)]
+
+    @triton.autotune(configs=configs, key=['N'], parallel_compile=True)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']),)
+    _kernel[grid](dst, src, N)
+    assert len(_kernel.fn.cache[torch.cuda.current_device()]) == len(configs)
+    assert torch.equal(dst, src)
+
+
+def test_persistent(tmp_path, monkeypatch):
+    monkeypatch.setenv("TRITON_AUTOTUNE_DIR", str(tmp_path))
+    N = 1024
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 32}), triton.Config(kwargs={'BLOCK_SIZE': 128})]
+
+    def make_kernel():
+        @triton.autotune(configs=configs, key=['N'], persistent=True)
+        @triton.jit
+        def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+            offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+            x = tl.load(src + offsets, mask=offsets < N)
+            tl.store(dst + offsets, x, mask=offsets < N)
+        return _kernel
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']),)
+    kernel = make_kernel()
+    kernel[grid](dst, src, N)
+    assert len(list(tmp_path.iterdir())) == 1
+    # a fresh autotuner (e.g. in another process) reuses the stored winner without benchmarking
+    kernel = make_kernel()
+    kernel[grid](dst, src, N)
+    assert not hasattr(kernel, "bench_time")
+    assert torch.equal(dst, src)
+
+
+def test_search_strategies():
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 2 ** i}) for i in range(5, 11)]
+    runtimes = {config: abs(config.kwargs['BLOCK_SIZE'] - 256) for config in configs}
+    benched = []
+
+    class Bench:
+        def __call__(self, config, rep=None):
+            benched.append((config, rep))
+            return [runtimes[config]] * 3
+
+        def map(self, configs, rep=None):
+            return {config: self(config, rep) for config in configs}
+    bench = Bench()
+
+    # successive halving: everything briefly, survivors for longer, the winner among the last round
+    timings = triton.runtime.SuccessiveHalving(min_rep=5, eta=2).search(configs, bench, {}, 100)
+    assert min(timings, key=timings.get).kwargs['BLOCK_SIZE'] == 256
+    assert [rep for _, rep in benched] == [5] * 6 + [10] * 3 + [20] * 2 + [None]
+    # cost model: only the top-k estimates are benchmarked
+    benched.clear()
+    strategy = triton.runtime.CostModelTopK(lambda N, BLOCK_SIZE, num_warps, num_stages: -BLOCK_SIZE, top_k=2)
+    timings = strategy.search(configs, bench, {'N': 1024}, 100)
+    assert sorted(config.kwargs['BLOCK_SIZE'] for config in timings) == [512, 1024]
+    assert len(benched) == 2
+
+    N = 1024
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+
+    @triton.autotune(configs=configs, key=['N'], search=triton.runtime.SuccessiveHalving())
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']),)
+    _kernel[grid](dst, src, N)
+    assert len(_kernel.configs_timings) < len(configs)
+    assert torch.equal(dst, src)
+
+
+def test_multi_device():
+    N = 1024
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 2 ** i}) for i in range(5, 11)]
+
+    @triton.autotune(configs=configs, key=['N'], multi_device=True)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']),)
+    _kernel[grid](dst, src, N)
+    assert set(_kernel.configs_timings) == set(configs)
+    assert torch.equal(dst, src)
+
+
+def test_prune_spilling():
+    N = 1024
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+
+    # a single warp holding 64K floats spills whatever the compiler does
+    spilling = triton.Config(kwargs={'BLOCK_SIZE': 65536}, num_warps=1)
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 128}), spilling]
+
+    @triton.autotune(configs=configs, key=['N'], prune_spilling=True)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']),)
+    _kernel[grid](dst, src, N)
+    assert _kernel.best_config is configs[0]
+    assert _kernel.configs_timings[spilling][0] == float('inf')
+    # the spilling config was never fully compiled
+    assert len(_kernel.fn.cache[torch.cuda.current_device()]) == 1
+    assert torch.equal(dst, src)
+
+
+def test_prune_occupancy():
+    N = 1024
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 128}), triton.Config(kwargs={'BLOCK_SIZE': 65536}, num_warps=1)]
+
+    @triton.autotune(configs=configs, key=['N'], prune_occupancy=True, max_spills=0)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']),)
+    _kernel[grid](dst, src, N)
+    assert _kernel.best_config is configs[0]
+    assert _kernel.configs_timings[configs[1]][0] == float('inf')
+    assert torch.equal(dst, src)
+    bin = _kernel.fn.warmup(dst, src, N, BLOCK_SIZE=128, grid=(1,))
+    report = bin.resource_report()
+    assert report["occupancy"]["ctas_per_sm"] > 0
+    assert report["occupancy"]["limit"] in ("warps", "blocks", "registers", "shared")
+    assert report["instruction_mix"]["global_load"] > 0
+    assert report["instruction_mix"]["global_store"] > 0
+    sass_report = bin.get_sass_report()
+    assert sass_report["instruction_mix"]["global_load"] > 0
+    assert sass_report["spills"] == {"loads": 0, "stores": 0}
+    assert sass_report["loops"] == []
+
+
+def test_early_stop():
+    N = 1 << 20
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda')
+
+    # the flush buffer is allocated once per device and sized from its L2
+    ctx = triton.testing.get_bench_context()
+    assert triton.testing.get_bench_context() is ctx
+    l2_size = triton.runtime.driver.utils.get_device_properties(torch.cuda.current_device())["l2_size"]
+    assert ctx.cache.numel() * ctx.cache.element_size() == 2 * l2_size
+    fn = lambda: dst.copy_(src)
+    stats = triton.testing.do_bench(fn, return_mode="stats", quantiles=(0.5,), reject_outliers=True)
+    assert stats.ci_low <= stats.median <= stats.ci_high
+    graph_stats = triton.testing.do_bench(fn, return_mode="stats", use_cuda_graph=True)
+    assert graph_stats.median > 0
+    # a benchmark stops once the runtime is certainly above `stop_above`
+    stopped = triton.testing.do_bench(fn, return_mode="stats", stop_above=stats.median / 100)
+    assert stopped.samples < stats.samples
+
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 2 ** i}) for i in range(7, 11)]
+
+    @triton.autotune(configs=configs, key=['N'], early_stop=True)
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+    grid = lambda META: (triton.cdiv(N, META['BLOCK_SIZE']),)
+    _kernel[grid](dst, src, N)
+    assert set(_kernel.configs_timings) == set(configs)
+    assert torch.equal(dst, src)
+
+
+def test_key_buckets():
+    configs = [triton.Config(kwargs={'BLOCK_SIZE': 32}), triton.Config(kwargs={'BLOCK_SIZE': 128})]
+
+    @triton.jit
+    def _copy(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        x = tl.load(src + offsets, mask=offsets < N)
+        tl.store(dst + offsets, x, mask=offsets < N)
+    grid = lambda META: (triton.cdiv(META['N'], META['BLOCK_SIZE']),)
+
+    pow2 = triton.autotune(configs=configs, key=['N'], key_buckets="pow2")(_copy)
+    ranges = triton.autotune(configs=configs, key=['N'], key_buckets={'N': [1024, 4096]})(_copy)
+    for N in [1000, 1024, 1500, 3000, 5000]:
+        src = torch.randn(N, device='cuda')
+        dst = torch.empty(N, device='cuda')
+        pow2[grid](dst, src, N)
+        assert torch.equal(dst, src)
+        ranges[grid](dst, src, N)
+        assert torch.equal(dst, src)
+    assert set(pow2.cache) == {(1024,), (2048,), (4096,), (8192,)}
+    assert set(ranges.cache) == {(1024,), (4096,), (float('inf'),)}
+
+    # new buckets are served by the nearest tuned one while they are tuned
+    background = triton.autotune(configs=configs, key=['N'], key_buckets="pow2", tune_in_background=True)(_copy)
+    for N in [1024, 65536]:
+        src = torch.randn(N, device='cuda')
+        dst = torch.empty(N, device='cuda')
+        background[grid](dst, src, N)
+        assert torch.equal(dst, src)
+    assert background.best_config is background.cache[(1024,)]
+    background.wait_for_tuning()
+    assert set(background.cache) == {(1024,), (65536,)}
+
+    # the exceptions of background tunings are raised, not dropped
+    class Failing:
+        def search(self, configs, bench, nargs, rep):
+            raise RuntimeError("tuning failed")
+    background.search = Failing()
+    src = torch.randn(4096, device='cuda')
+    dst = torch.empty(4096, device='cuda')
+    background[grid](dst, src, 4096)
+    assert torch.equal(dst, src)
+    with pytest.raises(RuntimeError, match="tuning failed"):
+        background.wait_for_tuning()
+    assert (4096,) not in background.cache
@@ -1,5 +1,6 @@
 import os
 import shutil
+import subprocess
 
 import pytest
 import torch
@@ -49,6 +50,33 @@ def apply_src_change(target, old, new):
     return ret
 
 
+def test_hash_independent_of_order():
+    kernel.hash = function_1.hash = function_2.hash = None
+    callee_key = function_1.cache_key
+    caller_key = kernel.cache_key
+    kernel.hash = function_1.hash = function_2.hash = None
+    # the callee is now hashed while hashing its caller
+    assert kernel.cache_key == caller_key
+    assert function_1.cache_key == callee_key
+
+
+def test_ptxas_version_memoized(monkeypatch):
+    from triton.common.backend import _get_ptxas_version_output, get_ptxas_version_output, path_to_ptxas
+
+    reset_tmp_dir()
+    ptxas = path_to_ptxas()[0].split(" ")[0]
+    _get_ptxas_version_output.cache_clear()
+    output = get_ptxas_version_output(ptxas)
+    assert "release" in output
+    _get_ptxas_version_output.cache_clear()
+
+    # later processes read it from the cache instead of running ptxas
+    def fail(*args, **kwargs):
+        raise AssertionError("ptxas was run")
+    monkeypatch.setattr(subprocess, "check_output", fail)
+    assert get_ptxas_version_output(ptxas) == output
+
+
 def test_nochange():
     baseline = kernel.cache_key
     updated = apply_src_change(kernel, 'i + 1', 'i + 1')
@@ -104,6 +132,62 @@ def test_specialize(mode):
     assert counter == target
 
 
+def test_concurrent_compile_once():
+    import threading
+    counter = 0
+
+    def inc_counter(*args, **kwargs):
+        nonlocal counter
+        counter += 1
+    JITFunction.cache_hook = inc_counter
+    reset_tmp_dir()
+    device = torch.cuda.current_device()
+    kernel.cache[device].clear()
+    x = torch.empty(1, dtype=torch.int32, device='cuda')
+    barrier = threading.Barrier(8)
+
+    def launch():
+        barrier.wait()
+        kernel[(1,)](x, 1, BLOCK=1024)
+    threads = [threading.Thread(target=launch) for _ in range(8)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    assert counter == 1
+    assert len(kernel.cache[device]) == 1
+
+
+def test_launch_fast_path():
+    reset_tmp_dir()
+    device = torch.cuda.current_device()
+    x = torch.empty(1, dtype=torch.int32, device='cuda')
+    kernel.cache[device].clear()
+    for i in range(3):
+        kernel[(1,)](x, 1, BLOCK=1024)
+    assert len(kernel.cache[device]) == 1
+    assert len(kernel.cache[device].launches) == 1
+    # a different specialization misses the fast path and gets its own entry
+    kernel[(1,)](x, 16, BLOCK=1024)
+    assert len(kernel.cache[device]) == 2
+    kernel[(1,)](x, 16, BLOCK=1024)
+    assert len(kernel.cache[device].launches) == 1
+    kernel.cache[device].clear()
+    assert len(kernel.cache[device].launches) == 0
+
+
+def test_launch_key():
+    from triton._C.libtriton.triton import runtime
+    x = torch.empty(4, dtype=torch.float16, device='cuda')
+    # BLOCK is a constexpr and is keyed by value
+    key = runtime.launch_key((x, 17, 1 << 40, 2.0, True, None, 128), (False,) * 6 + (True,), 4, 3)
+    assert key == ((torch.float16, x.device, True), ("i32", False, False), ("i64", True, False),
+                   "fp32", "i1", None, 128, 4, 3)
+    assert runtime.launch_key((x[1:],), (False,), 4, 3)[0][2] is False
+    # anything that can't be keyed natively defers to the Python launcher
+    assert runtime.launch_key((object(),), (False,), 4, 3) is None
+
+
 def test_constexpr_not_callable() -> None:
     @triton.jit
     def kernel(X, c: tl.constexpr):
@@ -168,6 +252,68 @@ def test_jit_debug() -> None:
     assert bins[2].asm['ttir'] != bins[1].asm['ttir']
 
 
+def test_jit_opt_level() -> None:
+    @triton.jit(opt_level=0)
+    def kernel_add(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx,
+                 tl.load(a + idx) + tl.load(b + idx))
+
+    device = torch.cuda.current_device()
+    kernel_add.warmup(torch.float32, torch.float32, torch.float32, 32, grid=(1,))
+    assert len(kernel_add.cache[device]) == 1
+    kernel_add.opt_level = 3
+    kernel_add.warmup(torch.float32, torch.float32, torch.float32, 32, grid=(1,))
+    assert len(kernel_add.cache[device]) == 2
+    bins = list(kernel_add.cache[device].values())
+    assert bins[0].asm['llir'] != bins[1].asm['llir']
+    a = torch.randn(32, device="cuda")
+    b = torch.randn(32, device="cuda")
+    o = torch.empty(32, device="cuda")
+    kernel_add.opt_level = 0
+    kernel_add[(1,)](a, b, o, 32)
+    torch.testing.assert_close(o, a + b)
+
+
+def test_option_change_after_launch() -> None:
+    @triton.jit
+    def kernel_add(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx,
+                 tl.load(a + idx) + tl.load(b + idx))
+
+    device = torch.cuda.current_device()
+    a = torch.randn(32, device="cuda")
+    b = torch.randn(32, device="cuda")
+    o = torch.empty(32, device="cuda")
+    kernel_add[(1,)](a, b, o, 32)
+    kernel_add[(1,)](a, b, o, 32)
+    assert len(kernel_add.cache[device]) == 1
+    # launches after an option changes don't reuse the kernel of the fast path
+    kernel_add.opt_level = 0
+    kernel_add[(1,)](a, b, o, 32)
+    assert len(kernel_add.cache[device]) == 2
+    torch.testing.assert_close(o, a + b)
+
+
+def test_compile_stats() -> None:
+    @triton.jit
+    def kernel_add(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx,
+                 tl.load(a + idx) + tl.load(b + idx))
+
+    reset_tmp_dir()
+    bin = kernel_add.warmup(torch.float32, torch.float32, torch.float32, 32, grid=(1,))
+    stats = bin.compile_stats
+    assert set(stats["stages"].keys()) == {"ttir", "ttgir", "llir", "ptx", "cubin"}
+    assert {"llvm_lowering", "llvm_translation", "llvm_optimize"} <= set(stats["timings"].keys())
+    passes = {p["name"] for p in stats["passes"]}
+    assert "tritongpu-coalesce" in passes
+    assert all(p["ops_before"] > 0 and p["ops_after"] > 0 for p in stats["passes"])
+    assert bin.metadata["resource_usage"]["registers"] > 0
+
+
 @triton.jit
 def add_fn(a, b, o, N: tl.constexpr):
     idx = tl.arange(0, N)
@@ -196,6 +342,75 @@ def test_jit_noinline() -> None:
     assert inline_ttir != noinline_ttir
 
 
+def test_auto_num_stages() -> None:
+    @triton.jit
+    def kernel_sum(x, o, K, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr):
+        offs = tl.arange(0, BLOCK_M)[:, None] * BLOCK_N + tl.arange(0, BLOCK_N)[None, :]
+        acc = tl.zeros((BLOCK_M, BLOCK_N), dtype=tl.float32)
+        for k in range(0, K):
+            acc += tl.load(x + k * BLOCK_M * BLOCK_N + offs)
+        tl.store(o + offs, acc)
+
+    reset_tmp_dir()
+    x = torch.randn((16, 32, 64), dtype=torch.float32, device="cuda")
+    o = torch.empty((32, 64), dtype=torch.float32, device="cuda")
+    bin = kernel_sum[(1,)](x, o, 16, BLOCK_M=32, BLOCK_N=64, num_stages="auto")
+    # the stages selected are recorded, and their buffers fit in shared memory
+    assert isinstance(bin.num_stages, int) and bin.num_stages > 1
+    device = torch.cuda.current_device()
+    assert bin.shared <= triton.runtime.driver.utils.get_device_properties(device)["max_shared_mem"]
+    torch.testing.assert_close(o, x.sum(0))
+
+
+def test_auto_num_warps() -> None:
+    @triton.jit
+    def kernel_copy(x, o, BLOCK: tl.constexpr):
+        offs = tl.arange(0, BLOCK)
+        tl.store(o + offs, tl.load(x + offs))
+
+    reset_tmp_dir()
+    x = torch.randn(4096, dtype=torch.float32, device="cuda")
+    o = torch.empty_like(x)
+    # 32 bytes of the largest tensor per thread
+    bin = kernel_copy[(1,)](x, o, BLOCK=1024, num_warps="auto")
+    assert bin.num_warps == 4
+    torch.testing.assert_close(o[:1024], x[:1024])
+    bin = kernel_copy[(1,)](x, o, BLOCK=256, num_warps="auto")
+    assert bin.num_warps == 1
+    bin = kernel_copy[(1,)](x, o, BLOCK=4096, num_warps="auto")
+    assert bin.num_warps == 8
+    torch.testing.assert_close(o, x)
+
+
+def test_warp_specialize() -> None:
+    if torch.cuda.get_device_capability()[0] < 8:
+        pytest.skip("warp specialization requires sm80")
+
+    @triton.jit(warp_specialize=True)
+    def kernel_matmul(a, b, c, K, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr):
+        offs_m = tl.arange(0, BLOCK_M)
+        offs_n = tl.arange(0, BLOCK_N)
+        offs_k = tl.arange(0, BLOCK_K)
+        a_ptrs = a + offs_m[:, None] * K + offs_k[None, :]
+        b_ptrs = b + offs_k[:, None] * BLOCK_N + offs_n[None, :]
+        acc = tl.zeros((BLOCK_M, BLOCK_N), dtype=tl.float32)
+        for k in range(0, K, BLOCK_K):
+            acc += tl.dot(tl.load(a_ptrs), tl.load(b_ptrs))
+            a_ptrs += BLOCK_K
+            b_ptrs += BLOCK_K * BLOCK_N
+        tl.store(c + offs_m[:, None] * BLOCK_N + offs_n[None, :], acc)
+
+    reset_tmp_dir()
+    a = torch.randn((64, 256), dtype=torch.float16, device="cuda")
+    b = torch.randn((256, 64), dtype=torch.float16, device="cuda")
+    c = torch.empty((64, 64), dtype=torch.float32, device="cuda")
+    bin = kernel_matmul[(1,)](a, b, c, 256, BLOCK_M=64, BLOCK_N=64, BLOCK_K=32, num_warps=4)
+    # the producer group is launched along with the 4 warps of the kernel
+    assert bin.metadata["num_warp_groups"] == 2
+    assert bin.num_warps == 8
+    torch.testing.assert_close(c, torch.matmul(a.float(), b.float()), rtol=1e-2, atol=1e-2)
+
+
 def test_memory_leak() -> None:
     @triton.jit
     def kernel(in_ptr0, out_ptr0, xnumel, XBLOCK: tl.constexpr):
@@ -206,3 +421,279 @@ def test_memory_leak() -> None:
         x0 = xindex
         tmp0 = tl.load(in_ptr0 + (x0), xmask)
         tl.store(out_ptr0 + (x0 + tl.zeros([XBLOCK], tl.int32)), tmp0, xmask)
+
+
+def test_context_pool() -> None:
+    from triton.compiler.compiler import ContextPool
+    pool = ContextPool(max_idle=1, max_uses=2)
+    ctx = pool.acquire()
+    pool.release(ctx)
+    # reused while under the use limit
+    assert pool.acquire() is ctx
+    other = pool.acquire()
+    assert other is not ctx
+    pool.release(ctx)
+    # retired after `max_uses` compilations, and the pool is bounded
+    assert pool.acquire() is not ctx
+    pool.release(other)
+    pool.release(pool.acquire())
+    assert len(pool._idle) <= 1
+
+
+def test_bytecode_cache() -> None:
+    @triton.jit
+    def kernel_add(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx,
+                 tl.load(a + idx) + tl.load(b + idx))
+
+    reset_tmp_dir()
+    device = torch.cuda.current_device()
+    bin = kernel_add.warmup(torch.float32, torch.float32, torch.float32, 32, grid=(1,))
+    cache_files = [f for _, _, files in os.walk(tmpdir) for f in files]
+    assert any(f.endswith(".ttirbc") for f in cache_files)
+    assert any(f.endswith(".ttgirbc") for f in cache_files)
+    # warm-cache reload
+    kernel_add.cache[device].clear()
+    reloaded = kernel_add.warmup(torch.float32, torch.float32, torch.float32, 32, grid=(1,))
+    assert reloaded.asm["ttir"] == bin.asm["ttir"]
+    assert reloaded.asm["ttgir"] == bin.asm["ttgir"]
+
+
+def test_shared_ttir() -> None:
+    from triton.compiler.compiler import ttir_cache
+
+    @triton.jit
+    def kernel_add(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx,
+                 tl.load(a + idx) + tl.load(b + idx))
+
+    reset_tmp_dir()
+    ttir_cache.clear()
+    bins = [kernel_add.warmup(torch.float32, torch.float32, torch.float32, 32, grid=(1,),
+                              num_warps=num_warps, num_stages=num_stages)
+            for num_warps, num_stages in [(4, 2), (8, 2), (4, 3)]]
+    # a single frontend run served all three variants
+    assert len(ttir_cache._entries) == 1
+    assert all(b.asm["ttir"] == bins[0].asm["ttir"] for b in bins)
+    assert bins[0].asm["ttgir"] != bins[1].asm["ttgir"]
+
+
+def test_shared_jit_function() -> None:
+    from triton.compiler.code_generator import jit_function_cache
+    from triton.compiler.compiler import ttir_cache
+
+    @triton.jit
+    def scale(x, S: tl.constexpr):
+        return x * S
+
+    @triton.jit
+    def kernel_scale(a, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx, scale(tl.load(a + idx), 2))
+
+    @triton.jit
+    def kernel_scale_add(a, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx, scale(tl.load(a + idx), 2) + 1)
+
+    reset_tmp_dir()
+    ttir_cache.clear()
+    jit_function_cache.clear()
+    a = torch.rand(32, device="cuda")
+    o = torch.empty_like(a)
+    kernel_scale[(1,)](a, o, 32)
+    kernel_scale_add[(1,)](a, o, 32)
+    # the helper was generated once, for both kernels
+    assert len(jit_function_cache._entries) == 1
+    assert torch.allclose(o, a * 2 + 1)
+    # each specialization of the helper has its own entry
+    kernel_scale[(1,)](a.half(), o.half(), 32)
+    assert len(jit_function_cache._entries) == 2
+
+
+def test_packed_cache_manager(tmp_path, monkeypatch) -> None:
+    from triton.runtime.cache import PackedCacheManager
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path / "cache"))
+    monkeypatch.setenv("TRITON_PACKED_CACHE_SCRATCH", str(tmp_path / "scratch"))
+    monkeypatch.setenv("TRITON_CACHE_MAX_BYTES", "4096")
+    manager = PackedCacheManager("key")
+    assert manager.get_file("kernel.ttir") is None
+    ttir = manager.put("module {}", "kernel.ttir", binary=False)
+    cubin = manager.put(b"\x7fELF", "kernel.cubin")
+    manager.put_group("kernel.json", {"kernel.ttir": ttir, "kernel.cubin": cubin})
+    mtime = os.stat(cubin).st_mtime_ns
+    group = PackedCacheManager("key").get_group("kernel.json")
+    # lookups do not rewrite the entries already materialized
+    assert os.stat(group["kernel.cubin"]).st_mtime_ns == mtime
+    assert open(group["kernel.ttir"]).read() == "module {}"
+    assert open(group["kernel.cubin"], "rb").read() == b"\x7fELF"
+    # everything lives in a single archive
+    assert os.listdir(tmp_path / "cache") == ["packed.bin"]
+    # the archive is kept within the budget, oldest entries first
+    for i in range(64):
+        PackedCacheManager(f"key{i}").put(b"x" * 256, "kernel.cubin")
+    assert os.path.getsize(tmp_path / "cache" / "packed.bin") < 3 * 4096
+    assert PackedCacheManager("key63").get_file("kernel.cubin") is not None
+    assert PackedCacheManager("key0").get_file("kernel.cubin") is None
+
+
+def test_remote_cache_manager(tmp_path, monkeypatch) -> None:
+    from triton.runtime import cache
+
+    class DictBackend(cache.RemoteCacheBackend):
+        store = dict()
+
+        def __init__(self, url, timeout):
+            pass
+
+        def get(self, key):
+            return self.store.get(key)
+
+        def put(self, key, data):
+            self.store[key] = data
+
+    monkeypatch.setattr(cache, "_make_remote_backend", DictBackend)
+    monkeypatch.setattr(cache.RemoteCacheManager, "_backend_url", None)
+    monkeypatch.setenv("TRITON_REMOTE_CACHE_URL", "http://cache.invalid")
+    # a first host compiles and publishes
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path / "host0"))
+    manager = cache.get_cache_manager("key")
+    assert isinstance(manager, cache.RemoteCacheManager)
+    group = {"kernel.cubin": manager.put(b"\x7fELF", "kernel.cubin"),
+             "kernel.json": manager.put("{}", "kernel.json", binary=False)}
+    manager.put_group("kernel.json", group)
+    assert list(DictBackend.store) == ["key/kernel.json"]
+    # a second host pulls the kernel instead of compiling it
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path / "host1"))
+    group = cache.get_cache_manager("key").get_group("kernel.json")
+    assert open(group["kernel.cubin"], "rb").read() == b"\x7fELF"
+    assert group["kernel.cubin"].startswith(str(tmp_path / "host1"))
+    assert cache.get_cache_manager("other").get_group("kernel.json") is None
+
+
+def test_warmup_from_manifest(tmp_path, monkeypatch) -> None:
+    manifest = tmp_path / "manifest.jsonl"
+    monkeypatch.setenv("TRITON_KERNEL_MANIFEST", str(manifest))
+    JITFunction.cache_hook = None
+    reset_tmp_dir()
+    device = torch.cuda.current_device()
+    kernel.cache[device].clear()
+    x = torch.empty(1, dtype=torch.int32, device='cuda')
+    kernel[(1,)](x, 1, BLOCK=1024)
+    kernel[(1,)](x, 17, BLOCK=1024)
+    assert len(manifest.read_text().splitlines()) == 2
+    # a fresh process starts with an empty in-memory cache
+    monkeypatch.delenv("TRITON_KERNEL_MANIFEST")
+    kernel.cache[device].clear()
+    assert triton.warmup_from_manifest(str(manifest)) == 2
+    assert len(kernel.cache[device]) == 2
+    counter = 0
+
+    def inc_counter(*args, **kwargs):
+        nonlocal counter
+        counter += 1
+    JITFunction.cache_hook = inc_counter
+    kernel[(1,)](x, 1, BLOCK=1024)
+    kernel[(1,)](x, 17, BLOCK=1024)
+    assert counter == 0
+
+
+def test_compile_workers() -> None:
+    from triton.compiler.compile_workers import get_compile_worker_pool, set_compile_workers
+
+    reset_tmp_dir()
+    device = torch.cuda.current_device()
+    kernel.cache[device].clear()
+    set_compile_workers(1, max_compiles=1)
+    try:
+        x = torch.empty(1, dtype=torch.int32, device='cuda')
+        kernel[(1,)](x, 1, BLOCK=1024)
+        assert x.item() == 4
+        kernel[(1,)](x, 17, BLOCK=1024)
+        assert x.item() == 20
+        pool = get_compile_worker_pool()
+        assert pool.num_compiled == 2
+        # each worker is recycled after a single compile
+        assert pool.num_started == 2
+
+        # kernels that are not importable are compiled in process
+        @triton.jit
+        def local_kernel(X):
+            tl.store(X, 3)
+        local_kernel[(1,)](x)
+        assert x.item() == 3
+        assert pool.num_compiled == 2
+    finally:
+        set_compile_workers(0)
+
+
+def test_compile_worker_crash(tmp_path, monkeypatch) -> None:
+    from triton.compiler.compile_workers import CompileWorkerError, CompileWorkerPool
+
+    # the workers exit when they import the kernel
+    (tmp_path / "crashing_module.py").write_text("import os\nos._exit(1)\n")
+    monkeypatch.syspath_prepend(str(tmp_path))
+    pool = CompileWorkerPool(1, 4)
+    with pytest.raises(CompileWorkerError):
+        pool.compile("crashing_module", "kernel", dict())
+    # the kernel is compiled once more in a new worker
+    assert pool.num_started == 2
+    assert pool.num_compiled == 0
+    pool.shutdown()
+
+
+@triton.jit(tiered=True)
+def kernel_tiered(X, i, BLOCK: tl.constexpr):
+    i = i + 1
+    i = function_1(i)
+    tl.store(X, i)
+
+
+def test_tiered_compilation() -> None:
+    reset_tmp_dir()
+    device = torch.cuda.current_device()
+    cache = kernel_tiered.cache[device]
+    cache.clear()
+    x = torch.empty(1, dtype=torch.int32, device='cuda')
+    # the first launch compiles its specialization, the generic variant
+    # follows in the background
+    kernel_tiered[(1,)](x, 16, BLOCK=1024)
+    assert x.item() == 19
+    cache.wait()
+    assert len(cache) == 2
+    # a new specialization launches the generic variant meanwhile
+    generic = kernel_tiered[(1,)](x, 1, BLOCK=1024)
+    assert x.item() == 4
+    cache.wait()
+    assert len(cache) == 3
+    specialized = kernel_tiered[(1,)](x, 1, BLOCK=1024)
+    assert x.item() == 4
+    assert specialized is not generic
+    assert kernel_tiered[(1,)](x, 17, BLOCK=1024) is generic
+    assert x.item() == 20
+
+
+@pytest.mark.skipif(torch.cuda.device_count() < 2, reason="requires two devices")
+def test_multi_device_kernel() -> None:
+    counter = 0
+
+    def inc_counter(*args, **kwargs):
+        nonlocal counter
+        counter += 1
+    JITFunction.cache_hook = inc_counter
+    reset_tmp_dir()
+    for device in range(2):
+        kernel.cache[device].clear()
+    bins = []
+    for device in range(2):
+        with torch.cuda.device(device):
+            x = torch.empty(1, dtype=torch.int32, device='cuda')
+            bins.append(kernel[(1,)](x, 1, BLOCK=1024))
+            assert x.item() == 4
+    # a single compilation, loaded on each device on its first launch there
+    assert counter == 1
+    assert bins[0] is bins[1]
+    assert set(bins[0].handles) == {0, 1}
+    assert bins[0].get_function(0) != bins[0].get_function(1)
@@ -7,6 +7,7 @@ import gc
 # import time
 import tracemalloc
 
+import pytest
 import torch
 
 import triton
@@ -104,3 +105,139 @@ def test_memory_leak() -> None:
 
 #     # Run empty, which would run empty_kernel internally
 #     empty(*kernel_args)
+
+
+def test_kernel_graph() -> None:
+
+    @triton.jit
+    def add_kernel(x_ptr, out_ptr, value, N: tl.constexpr):
+        offsets = tl.arange(0, N)
+        tl.store(out_ptr + offsets, tl.load(x_ptr + offsets) + value)
+
+    x = torch.zeros(128, device='cuda')
+    y = torch.zeros_like(x)
+    z = torch.zeros_like(x)
+    graph = triton.runtime.KernelGraph()
+    with graph.record():
+        add_kernel[(1,)](x, y, 1.0, N=128)
+        add_kernel[(1,)](y, z, 2.0, N=128)
+    # nothing runs until the graph is launched
+    torch.cuda.synchronize()
+    assert torch.all(z == 0.0)
+    graph.launch()
+    torch.cuda.synchronize()
+    assert torch.all(z == 3.0)
+    # rebind the scalar of the second launch
+    graph.update(1, y, z, 5.0)
+    graph.launch()
+    torch.cuda.synchronize()
+    assert torch.all(z == 6.0)
+    # arguments given as callables are re-evaluated at every launch
+    out = [y]
+    graph.update(1, y, lambda: out[0], 1.0)
+    out[0] = torch.empty_like(x)
+    graph.launch()
+    torch.cuda.synchronize()
+    assert torch.all(out[0] == 2.0)
+
+
+def test_launch_tracing(tmp_path) -> None:
+    import json
+
+    @triton.jit
+    def traced_kernel(x_ptr, N: tl.constexpr):
+        offsets = tl.arange(0, N)
+        tl.store(x_ptr + offsets, tl.load(x_ptr + offsets) + 1.0)
+
+    x = torch.zeros(128, device='cuda')
+    traced_kernel[(1,)](x, N=128)
+    tracing = triton.runtime.tracing
+    tracing.collect()
+    tracing.start()
+    for _ in range(3):
+        traced_kernel[(2, 1, 1)](x, N=128)
+    tracing.stop()
+    # launches after `stop` are not recorded
+    traced_kernel[(1,)](x, N=128)
+    launches = tracing.collect()
+    assert len(launches) == 3
+    # collecting after `stop` ends the trace
+    assert tracing.collect() == []
+    for launch in launches:
+        assert launch["name"].startswith("traced_kernel")
+        assert launch["grid"] == (2, 1, 1)
+        assert launch["host_begin"] <= launch["host_end"]
+        assert launch["gpu_begin"] is not None and launch["gpu_begin"] <= launch["gpu_end"]
+    path = tmp_path / "trace.json"
+    tracing.export_chrome_trace(path, launches)
+    events = json.loads(path.read_text())["traceEvents"]
+    assert {event["cat"] for event in events} == {"launch", "kernel"}
+    assert len(events) == 6
+
+
+def test_prebuilt_launcher() -> None:
+    @triton.jit
+    def scalars_kernel(out, a, b, c, d, e, N: tl.constexpr):
+        offs = tl.arange(0, N)
+        tl.store(out + offs, a + b + c + d + tl.load(e + offs))
+
+    out = torch.empty(16, device='cuda')
+    e = torch.ones(16, device='cuda')
+    # i32, i64, fp32 and an integer equal to 1, specialized away
+    bin = scalars_kernel[(1,)](out, 3, 2**40, 0.5, 1, e, N=16)
+    # no launcher is compiled for the signature
+    assert type(bin.c_wrapper).__name__ == "Launcher"
+    torch.testing.assert_close(out, torch.full_like(out, 3 + 2**40 + 0.5 + 1 + 1))
+
+
+def test_cluster_launch() -> None:
+    if torch.cuda.get_device_capability()[0] < 9:
+        pytest.skip("thread block clusters require sm90")
+
+    @triton.jit(num_ctas=2)
+    def cluster_kernel(out):
+        pid = tl.program_id(0)
+        tl.cluster_barrier()
+        tl.store(out + 2 * pid, tl.cluster_cta_rank())
+        tl.store(out + 2 * pid + 1, tl.num_cluster_ctas())
+
+    out = torch.empty(8, dtype=torch.int32, device='cuda')
+    bin = cluster_kernel[(4,)](out)
+    assert bin.cluster_dims == (2, 1, 1)
+    ranks = torch.tensor([0, 2, 1, 2, 0, 2, 1, 2], dtype=torch.int32, device='cuda')
+    assert torch.equal(out, ranks)
+
+
+def test_cluster_ops_need_sm90() -> None:
+
+    @triton.jit
+    def cluster_kernel(out):
+        tl.store(out, tl.cluster_cta_rank())
+
+    with pytest.raises(triton.CompilationError, match="compute capability 9.0"):
+        triton.compile(fn=cluster_kernel, signature={0: "*i32"}, device=0, warm_cache_only=True, cc=80)
+
+
+def test_large_grid_launch() -> None:
+
+    @triton.jit
+    def grid_kernel(out):
+        x = tl.program_id(0)
+        y = tl.program_id(1)
+        z = tl.program_id(2)
+        pid = (z * tl.num_programs(1) + y) * tl.num_programs(0) + x
+        tl.store(out + 3 * pid, x)
+        tl.store(out + 3 * pid + 1, y)
+        tl.store(out + 3 * pid + 2, z)
+
+    # more programs along axis 1 than the hardware launches
+    grid = (2, 70000, 3)
+    out = torch.empty(3 * grid[0] * grid[1] * grid[2], dtype=torch.int32, device='cuda')
+    bin = grid_kernel[grid](out)
+    assert bin.large_grid
+    z, y, x = torch.meshgrid(*[torch.arange(n, dtype=torch.int32, device='cuda') for n in reversed(grid)],
+                             indexing='ij')
+    expected = torch.stack([x.flatten(), y.flatten(), z.flatten()], dim=1).flatten()
+    assert torch.equal(out, expected)
+    # grids that fit are launched as is, by another variant of the kernel
+    assert not grid_kernel[(2, 3, 1)](out).large_grid
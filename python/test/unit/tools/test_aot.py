@@ -140,7 +140,7 @@ int main(int argc, char **argv) {{
                                         "-o", "test"], check=True, cwd=dir)
 
 
-def generate_matmul_launcher(dir, dtype, BM, BN, BK, ha_hb_hints):
+def generate_matmul_launcher(dir, dtype, BM, BN, BK, ha_hb_hints, targets=None):
     kernel_path = os.path.join(dir, "kernel.py")
     with open(kernel_path, "w") as file:
         file.write(kernel_src)
@@ -157,7 +157,8 @@ def generate_matmul_launcher(dir, dtype, BM, BN, BK, ha_hb_hints):
         for hb in ha_hb_hints:
             sig = f'*fp32:16, *{dtype}:16, *{dtype}:16, i32{ha}, i32:1, i32{hb}, i32:1, i32:16, i32:1, {BM}, {BN}, {BK}'
             name = f"matmul_{dtype}x{dtype}_{BM}x{BN}x{BK}"
-            subprocess.run([sys.executable, compiler_path, "-n", "kernel", "--signature", sig, "--out-name", name, "-o", name, "-w", "1", kernel_path], check=True, cwd=dir)
+            target_args = ["--target", ",".join(map(str, targets))] if targets else []
+            subprocess.run([sys.executable, compiler_path, "-n", "kernel", "--signature", sig, "--out-name", name, "-o", name, "-w", "1"] + target_args + [kernel_path], check=True, cwd=dir)
 
     # link all desired configs
     h_files = glob.glob(os.path.join(dir, "*.h"))
@@ -202,6 +203,32 @@ def test_compile_link_matmul():
         np.testing.assert_allclose(c_tri, c_ref * c_ref, atol=1e-4, rtol=0.)
 
 
+def test_compile_link_matmul_multi_arch():
+    np.random.seed(3)
+    import torch
+    major, minor = torch.cuda.get_device_capability()
+    cc = major * 10 + minor
+    # an image for another major version must be skipped at load time
+    other_cc = 70 if major != 7 else 80
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        dtype = "fp16"
+        BM, BN, BK = 16, 16, 16
+
+        generate_matmul_launcher(tmp_dir, dtype, BM, BN, BK, ha_hb_hints=["", ":16"], targets=[other_cc, cc])
+        assert any(f"_cubin_sm{other_cc}[" in open(f).read() for f in glob.glob(os.path.join(tmp_dir, "*.c")))
+
+        M, N, K = 16, 16, 16
+        gen_test_bin(tmp_dir, M, N, K, BM, BN, BK)
+        a, b, a_path, b_path, c_path = generate_matmul_test_data(tmp_dir, M, N, K)
+        subprocess.run(["./test", a_path, b_path, c_path], check=True, cwd=tmp_dir)
+
+        c = np.genfromtxt(c_path, delimiter=",", dtype=np.int32)
+        c_tri = c.reshape((M, N)).view(np.float32)
+        c_ref = np.matmul(a.astype(np.float32), b.astype(np.float32))
+        np.testing.assert_allclose(c_tri, c_ref * c_ref, atol=1e-4, rtol=0.)
+
+
 def test_launcher_has_no_available_kernel():
     np.random.seed(3)
 
@@ -242,3 +269,19 @@ module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-war
         ptx = k.asm["ptx"]
         assert ".target sm_80" in ptx
         assert ".address_size 64" in ptx
+
+
+def test_dispatch_table():
+    from triton.tools.link import HeaderParser, make_dispatch_table, make_predicates
+
+    parser = HeaderParser()
+    sig = "CUdeviceptr C, CUdeviceptr A, int32_t M"
+    parser.extract_linker_meta("\n".join(f"// tt-linker: k_abcd1234_{suffix}:{sig}" for suffix in ["012", "0d12", "0d1d2c"]))
+    metas = sorted(parser.kernels["k"], key=lambda m: -m.num_specs)
+    preds = make_predicates(metas)
+    assert preds == [(0, 16), (1, 16), (2, 1)]
+    table = make_dispatch_table(metas, preds)
+    # bits are C % 16 == 0, A % 16 == 0, M == 1
+    assert table[0b111] == 0
+    assert table[0b001] == table[0b011] == table[0b101] == 1
+    assert table[0b000] == table[0b010] == 2
@@ -15,6 +15,7 @@ from .runtime import (
     TensorWrapper,
     OutOfResources,
     MockTensor,
+    warmup_from_manifest,
 )
 from .runtime.jit import jit
 from .compiler import compile, CompilationError
@@ -43,6 +44,7 @@ __all__ = [
     "TensorWrapper",
     "testing",
     "tools",
+    "warmup_from_manifest",
 ]
 
 
@@ -1,10 +1,12 @@
 
 import functools
+import hashlib
 import importlib
 import importlib.util
 import os
 import re
 import subprocess
+from pathlib import Path
 from typing import Dict
 
 from ..runtime.driver import DriverBase
@@ -100,6 +102,28 @@ def get_backend(device_type: str):
     return _backends[device_type] if device_type in _backends else None
 
 
+@functools.lru_cache()
+def _get_ptxas_version_output(path, mtime_ns, size):
+    from ..runtime.cache import get_cache_manager
+    key = hashlib.md5(f"{path}-{mtime_ns}-{size}".encode("utf-8")).hexdigest()
+    cache = get_cache_manager(key)
+    cached = cache.get_file("ptxas_version.txt")
+    if cached is not None:
+        return Path(cached).read_text()
+    output = subprocess.check_output([path, "--version"], stderr=subprocess.STDOUT).decode("utf-8")
+    cache.put(output, "ptxas_version.txt", binary=False)
+    return output
+
+
+def get_ptxas_version_output(path):
+    """
+    output of `ptxas --version` for the ptxas at `path`, memoized in the cache
+    by the path, modification time and size of the binary
+    """
+    stat = os.stat(path)
+    return _get_ptxas_version_output(os.path.realpath(path), stat.st_mtime_ns, stat.st_size)
+
+
 @functools.lru_cache()
 def path_to_ptxas():
     base_dir = os.path.join(os.path.dirname(__file__), os.pardir)
@@ -111,9 +135,33 @@ def path_to_ptxas():
     for ptxas in paths:
         ptxas_bin = ptxas.split(" ")[0]
         if os.path.exists(ptxas_bin) and os.path.isfile(ptxas_bin):
-            result = subprocess.check_output([ptxas_bin, "--version"], stderr=subprocess.STDOUT)
+            result = get_ptxas_version_output(ptxas_bin)
             if result is not None:
-                version = re.search(r".*release (\d+\.\d+).*", result.decode("utf-8"), flags=re.MULTILINE)
+                version = re.search(r".*release (\d+\.\d+).*", result, flags=re.MULTILINE)
                 if version is not None:
                     return ptxas, version.group(1)
     raise RuntimeError("Cannot find ptxas")
+
+
+@functools.lru_cache()
+def ptx_get_version(cuda_version) -> int:
+    '''
+    Get the highest PTX version supported by the current CUDA driver.
+    '''
+    assert isinstance(cuda_version, str)
+    major, minor = map(int, cuda_version.split('.'))
+    if major == 12:
+        return 80 + minor
+    if major == 11:
+        return 70 + minor
+    if major == 10:
+        return 63 + minor
+    raise RuntimeError("Triton only support CUDA 10.0 or higher")
+
+
+def get_ptx_version() -> int:
+    '''
+    The PTX version kernels are compiled to, the highest one ptxas supports.
+    '''
+    _, cuda_version = path_to_ptxas()
+    return ptx_get_version(cuda_version)
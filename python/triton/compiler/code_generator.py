@@ -1,8 +1,11 @@
 import ast
 import inspect
+import os
 import re
 import sys
+import threading
 import warnings
+from collections import OrderedDict
 from typing import Any, Callable, Dict, Optional, Tuple, Type, Union
 
 from .. import language
@@ -46,12 +49,56 @@ def mangle_fn(name, arg_tys, constants):
     mangled_constants = '_'.join([f'{i}c{repr(constants[i])}' for i in sorted(constants)])
     mangled_constants = mangled_constants.replace('.', '_d_')
     mangled_constants = mangled_constants.replace("'", '_sq_')
-    # [ and ] are not allowed in LLVM identifiers
+    # [, ], ( and ) are not allowed in LLVM identifiers
     mangled_constants = mangled_constants.replace('[', '_').replace(']', '_')
+    mangled_constants = mangled_constants.replace('(', '_').replace(')', '_')
     ret = f'{name}__{mangled_arg_names}__{mangled_constants}'
     return ret
 
 
+class JITFunctionCache:
+    """
+    An in-memory LRU of the TTIR of `@triton.jit` helpers, stored as MLIR
+    bytecode along with the return types of the functions it defines.
+
+    Kernel libraries call the same helpers from many kernels, and each kernel
+    is compiled for many specializations: the helpers are generated from
+    their AST once per (helper, argument types, constexprs) and cloned into
+    the modules of their later callers. At most `max_entries` helpers are
+    kept (0 disables the cache).
+    """
+
+    def __init__(self, max_entries=None):
+        if max_entries is None:
+            max_entries = int(os.environ.get("TRITON_JIT_FUNCTION_CACHE_SIZE", "1024"))
+        self.max_entries = max_entries
+        self._lock = threading.Lock()
+        self._entries = OrderedDict()
+
+    def get(self, key):
+        with self._lock:
+            entry = self._entries.get(key)
+            if entry is not None:
+                self._entries.move_to_end(key)
+            return entry
+
+    def put(self, key, bytecode, ret_types):
+        if self.max_entries <= 0:
+            return
+        with self._lock:
+            self._entries[key] = (bytecode, ret_types)
+            self._entries.move_to_end(key)
+            while len(self._entries) > self.max_entries:
+                self._entries.popitem(last=False)
+
+    def clear(self):
+        with self._lock:
+            self._entries.clear()
+
+
+jit_function_cache = JITFunctionCache()
+
+
 def _is_triton_tensor(o: Any) -> bool:
     return isinstance(o, tensor)
 
@@ -60,19 +107,17 @@ def _is_constexpr(o: Any) -> bool:
     return isinstance(o, constexpr)
 
 
-def _is_triton_scalar(o: Any) -> bool:
-    return _is_triton_tensor(o) and (not o.type.is_block() or o.type.numel == 1)
-
-
 def _unwrap_if_constexpr(o: Any):
     return o.value if isinstance(o, constexpr) else o
 
 
 def _check_fn_args(node, fn, args):
+    # Tensors, scalar or not, are passed to noinline functions in the registers
+    # of their layout
     if fn.noinline:
         for idx, arg in enumerate(args):
-            if not _is_constexpr(arg) and not _is_triton_scalar(arg):
-                raise UnsupportedLanguageConstruct(fn.src, node, f'Function {fn.__name__} is marked noinline, but was called with non-scalar argument {fn.arg_names[idx]}:{arg}')
+            if not _is_constexpr(arg) and not _is_triton_tensor(arg):
+                raise UnsupportedLanguageConstruct(fn.src, node, f'Function {fn.__name__} is marked noinline, but was called with non-tensor argument {fn.arg_names[idx]}:{arg}')
 
 
 def _get_fn_file_line(fn):
@@ -881,6 +926,30 @@ class CodeGenerator(ast.NodeVisitor):
         # Convert assert to triton's device_assert which happens on the device
         return language.core.device_assert(test, msg, _builder=self.builder)
 
+    def define_JitFunction(self, fn: JITFunction, fn_name, arg_types, attributes, constants, debug):
+        # The helper and its own callees are generated in a module of their
+        # own, whose bytecode is cached and merged into the callers' modules
+        key = f"{fn.cache_key}-{fn_name}-{debug}-{self.builder.arch}"
+        entry = jit_function_cache.get(key)
+        if entry is not None:
+            bytecode, ret_types = entry
+            module = ir.parse_mlir_bytecode(bytecode, self.context)
+        else:
+            prototype = language.function_type([], arg_types)
+            gscope = sys.modules[fn.fn.__module__].__dict__
+            file_name, begin_line = _get_fn_file_line(fn)
+            ret_types = {}
+            generator = CodeGenerator(self.context, prototype, gscope, attributes, constants,
+                                      function_name=fn_name, function_types=ret_types, debug=debug, noinline=fn.noinline,
+                                      file_name=file_name, begin_line=begin_line, arch=self.builder.arch)
+            generator.visit(fn.parse())
+            ret_types[fn_name] = generator.last_ret_type
+            module = generator.module
+            jit_function_cache.put(key, bytes(module.bytecode()), ret_types)
+        self.module.merge(module)
+        for name, ret_type in ret_types.items():
+            self.function_ret_types.setdefault(name, ret_type)
+
     def call_JitFunction(self, fn: JITFunction, args, kwargs):
         args = inspect.getcallargs(fn.fn, *args, **kwargs)
         args = [args[name] for name in fn.arg_names]
@@ -897,19 +966,10 @@ class CodeGenerator(ast.NodeVisitor):
         fn_name = mangle_fn(fn.__name__, arg_types, constants)
         # generate function def if necessary
         if not self.module.has_function(fn_name):
-            prototype = language.function_type([], arg_types)
-            gscope = sys.modules[fn.fn.__module__].__dict__
             # If the callee is not set, we use the same debug setting as the caller
             debug = self.debug if fn.debug is None else fn.debug
-            file_name, begin_line = _get_fn_file_line(fn)
-            generator = CodeGenerator(self.context, prototype, gscope, attributes, constants, module=self.module,
-                                      function_name=fn_name, function_types=self.function_ret_types, debug=debug, noinline=fn.noinline,
-                                      file_name=file_name, begin_line=begin_line, arch=self.builder.arch)
-            generator.visit(fn.parse())
-            callee_ret_type = generator.last_ret_type
-            self.function_ret_types[fn_name] = callee_ret_type
-        else:
-            callee_ret_type = self.function_ret_types[fn_name]
+            self.define_JitFunction(fn, fn_name, arg_types, attributes, constants, debug)
+        callee_ret_type = self.function_ret_types[fn_name]
         symbol = self.module.get_function(fn_name)
         call_op = self.builder.call(symbol, arg_vals)
         if call_op.get_num_results() == 0 or callee_ret_type is None:
@@ -1095,11 +1155,12 @@ def kernel_suffix(signature, specialization):
     return suffix
 
 
-def ast_to_ttir(fn, signature, specialization, constants, debug, arch):
+def ast_to_ttir(fn, signature, specialization, constants, debug, arch, context=None):
     # canonicalize signature
     if isinstance(signature, str):
         signature = {k: v.strip() for k, v in enumerate(signature.split(","))}
-    context = ir.context()
+    if context is None:
+        context = ir.context()
     context.load_triton()
     # create kernel prototype
     cst_key = lambda i: fn.arg_names.index(i) if isinstance(i, str) else i
@@ -0,0 +1,213 @@
+"""
+Compile-server mode: `compile` hands the JIT functions whose binaries are not
+cached yet to a pool of long-lived worker processes, which compile them into
+the shared on-disk cache; the calling process then only loads the stages and
+the launcher from the cache. The memory LLVM and MLIR hold on to stays in the
+workers, which are replaced after a fixed number of compiles.
+
+The mode is enabled by `TRITON_COMPILE_WORKERS` (the number of workers, 0 by
+default) or `set_compile_workers`. `TRITON_COMPILE_WORKER_MAX_COMPILES` (32 by
+default) is the number of kernels a worker compiles before it is recycled.
+
+Kernels are looked up by module and name in the workers, so only kernels
+defined at the top level of an importable module, specialized on plain
+constants, are compiled out of process. The others, and those a worker fails
+to compile, are compiled by the calling process, which also reports their
+errors. A kernel whose worker dies is compiled once more in a new worker; if
+that one dies too, `CompileWorkerError` is raised rather than loading the
+compiler into the calling process.
+"""
+import atexit
+import importlib
+import os
+import subprocess
+import sys
+import threading
+from multiprocessing import Pipe
+from multiprocessing.connection import Connection
+
+from ..runtime.jit import JITFunction
+
+# constants of these types are passed to the workers
+_plain_constant_types = (bool, int, float, str, type(None))
+
+
+class CompileWorkerError(RuntimeError):
+    """
+    Raised when the workers compiling a kernel died.
+    """
+    pass
+
+
+class CompileWorkerPool:
+    """
+    At most `num_workers` worker processes, each compiling `max_compiles`
+    kernels before it exits and is replaced on demand.
+    """
+
+    def __init__(self, num_workers, max_compiles):
+        self.num_workers = num_workers
+        self.max_compiles = max_compiles
+        # number of workers started and of kernels they compiled
+        self.num_started = 0
+        self.num_compiled = 0
+        self._slots = threading.Semaphore(num_workers)
+        self._lock = threading.Lock()
+        self._idle = []
+
+    def _start(self):
+        conn, child_conn = Pipe()
+        env = dict(os.environ,
+                   TRITON_COMPILE_WORKERS="0",
+                   PYTHONPATH=os.pathsep.join(p for p in sys.path if p))
+        fd = child_conn.fileno()
+        process = subprocess.Popen([sys.executable, "-m", __name__, str(fd), str(self.max_compiles)],
+                                   pass_fds=(fd,), env=env)
+        child_conn.close()
+        with self._lock:
+            self.num_started += 1
+        return [process, conn, self.max_compiles]
+
+    def _close(self, worker):
+        process, conn, _ = worker
+        conn.close()
+        process.wait()
+
+    def compile(self, module, name, kwargs):
+        """
+        Compiles `name` of `module` with `kwargs` in a worker.
+
+        :return: whether the worker compiled it
+        :raises CompileWorkerError: when the worker died, and so did the new
+            one the kernel was compiled in again
+        """
+        with self._slots:
+            for attempt in range(2):
+                with self._lock:
+                    worker = self._idle.pop() if self._idle and attempt == 0 else None
+                if worker is None:
+                    worker = self._start()
+                try:
+                    worker[1].send((module, name, kwargs))
+                    worker[2] -= 1
+                    ok = worker[1].recv()
+                    break
+                except (EOFError, OSError):
+                    self._close(worker)
+            else:
+                raise CompileWorkerError(f"compile workers died while compiling {module}.{name}")
+            if worker[2] > 0:
+                with self._lock:
+                    self._idle.append(worker)
+            else:
+                self._close(worker)
+            if ok:
+                with self._lock:
+                    self.num_compiled += 1
+            return ok
+
+    def shutdown(self):
+        with self._lock:
+            idle, self._idle = self._idle, []
+        for worker in idle:
+            self._close(worker)
+
+
+_pool = None
+_pool_lock = threading.Lock()
+
+
+def _make_pool(num_workers, max_compiles=None):
+    if num_workers <= 0:
+        return None
+    if max_compiles is None:
+        max_compiles = int(os.environ.get("TRITON_COMPILE_WORKER_MAX_COMPILES", "32"))
+    return CompileWorkerPool(num_workers, max(max_compiles, 1))
+
+
+def set_compile_workers(num_workers, max_compiles=None):
+    """
+    Compiles kernels in `num_workers` worker processes (in the calling
+    process when 0), each recycled after `max_compiles` compiles.
+    """
+    global _pool
+    with _pool_lock:
+        if _pool is not None:
+            _pool.shutdown()
+        _pool = _make_pool(num_workers, max_compiles)
+
+
+def get_compile_worker_pool():
+    """
+    The worker pool `compile` uses, None when kernels are compiled in process.
+    """
+    global _pool
+    with _pool_lock:
+        if _pool is None:
+            _pool = _make_pool(int(os.environ.get("TRITON_COMPILE_WORKERS", "0")))
+        return _pool
+
+
+def _is_importable(fn):
+    module = sys.modules.get(fn.module)
+    if fn.module == "__main__" or module is None:
+        return False
+    found = getattr(module, fn.__name__, None)
+    # unwrap autotuners and heuristics
+    while found is not None and not isinstance(found, JITFunction):
+        found = getattr(found, "fn", None)
+    return found is fn
+
+
+def compile_in_worker(fn, kwargs):
+    """
+    Compiles the JIT function `fn` with the keyword arguments of `compile` in
+    a worker, which writes it to the cache.
+
+    :return: whether it was compiled; False when the mode is disabled or
+        `fn` cannot be compiled out of process
+    :raises CompileWorkerError: when the workers compiling `fn` died
+    """
+    pool = get_compile_worker_pool()
+    if pool is None or not _is_importable(fn):
+        return False
+    constants = kwargs.get("constants", dict())
+    if not all(isinstance(value, _plain_constant_types) for value in constants.values()):
+        return False
+    kwargs = dict(kwargs)
+    # the instance descriptors of the JIT are not picklable; without them,
+    # `compile` uses its default one in the worker too
+    if kwargs.get("configs") is not None:
+        kwargs["configs"] = [(tuple(conf.divisible_by_16), tuple(conf.equal_to_1))
+                             for conf in kwargs["configs"]]
+    return pool.compile(fn.module, fn.__name__, kwargs)
+
+
+atexit.register(lambda: _pool is not None and _pool.shutdown())
+
+
+def _serve(fd, max_compiles):
+    from .compiler import compile, instance_descriptor
+    conn = Connection(fd)
+    for _ in range(max_compiles):
+        try:
+            module, name, kwargs = conn.recv()
+        except EOFError:
+            break
+        try:
+            fn = getattr(importlib.import_module(module), name)
+            while not isinstance(fn, JITFunction):
+                fn = fn.fn
+            if kwargs.get("configs") is not None:
+                kwargs["configs"] = [instance_descriptor(*conf) for conf in kwargs["configs"]]
+            compile(fn, **kwargs)
+            ok = True
+        except Exception:
+            # the calling process compiles it again and reports the error
+            ok = False
+        conn.send(ok)
+    conn.close()
+
+
+if __name__ == "__main__":
+    _serve(int(sys.argv[1]), int(sys.argv[2]))
@@ -1,61 +1,85 @@
 from __future__ import annotations
 
+import contextvars
 import functools
 import hashlib
 import json
 import os
 import re
+import struct
 import subprocess
 import tempfile
-from collections import namedtuple
+import threading
+import time
+from collections import OrderedDict, namedtuple
 from pathlib import Path
 from typing import Any, Tuple
 
-from .._C.libtriton.triton import (add_external_libs, compile_ptx_to_cubin,
-                                   get_shared_memory_size, ir,
+from .._C.libtriton.triton import (add_external_libs, compile_ptx_to_cubin, get_num_stages, get_num_warp_groups, get_num_warps,
+                                   get_print_records, get_profile_regions, get_register_budget, get_register_pressure, get_shared_memory_lower_bound,
+                                   get_shared_memory_size, get_tensor_footprint, get_tensor_maps, ir,
                                    translate_llvmir_to_hsaco, translate_llvmir_to_ptx,
                                    translate_triton_gpu_to_llvmir)
-from ..common.backend import get_backend, path_to_ptxas
+from ..common.backend import get_backend, get_ptx_version, path_to_ptxas
 # from ..runtime import driver, jit, JITFunction
 # TODO: runtime.errors
-from ..runtime.autotuner import OutOfResources
+from ..runtime.autotuner import OutOfResources, prune_spilling
 from ..runtime.cache import get_cache_manager
 from ..runtime.driver import driver
 from ..runtime.jit import (JITFunction, get_cuda_stream, get_current_device,
                            get_device_capability, version_key)
-from ..tools.disasm import extract
+from ..runtime.occupancy import get_occupancy
+from ..runtime.print_buffer import get_print_buffer
+from ..tools.disasm import extract, report_cubin
 from .code_generator import ast_to_ttir
-from .make_launcher import make_stub
+from .compile_workers import compile_in_worker
+from .make_launcher import make_launcher_descriptor, make_stub
 
 
-def inline_triton_ir(mod):
-    pm = ir.pass_manager(mod.context)
+# statistics of the compilation running in the current thread, if any
+_compile_stats = contextvars.ContextVar("compile_stats", default=None)
+
+
+def make_pass_manager(context):
+    pm = ir.pass_manager(context)
     pm.enable_debug()
+    stats = _compile_stats.get()
+    if stats is not None:
+        pm.enable_statistics(stats)
+    return pm
+
+
+def inline_triton_ir(mod):
+    pm = make_pass_manager(mod.context)
     pm.add_inliner_pass()
     pm.run(mod)
     return mod
 
 
-def ttir_compute_capability_rewrite(mod, arch):
+def ttir_compute_capability_rewrite(mod, arch, enable_tma=False):
     # For hardware without support, we must rewrite all load/store
-    # with block (tensor) pointers into tensors of pointers
-    pm = ir.pass_manager(mod.context)
-    pm.enable_debug()
+    # with block (tensor) pointers into tensors of pointers; with `enable_tma`,
+    # sm90 loads them with the Tensor Memory Accelerator where it can
+    pm = make_pass_manager(mod.context)
     if _is_cuda(arch):
-        pm.add_rewrite_tensor_pointer_pass(arch)
+        pm.add_rewrite_tensor_pointer_pass(arch, enable_tma)
     pm.run(mod)
     return mod
 
 
-def optimize_ttir(mod, arch):
+def optimize_ttir(mod, arch, i32_offsets=False, enable_tma=False, swizzle_pids=0, large_grid=False):
     mod = inline_triton_ir(mod)
-    mod = ttir_compute_capability_rewrite(mod, arch)
-    pm = ir.pass_manager(mod.context)
-    pm.enable_debug()
+    mod = ttir_compute_capability_rewrite(mod, arch, enable_tma)
+    pm = make_pass_manager(mod.context)
     pm.add_inliner_pass()
+    if swizzle_pids > 1:
+        pm.add_swizzle_program_ids_pass(swizzle_pids)
+    if large_grid:
+        pm.add_linearize_program_ids_pass()
     pm.add_triton_combine_pass()
     pm.add_canonicalizer_pass()
     pm.add_reorder_broadcast_pass()
+    pm.add_narrow_offsets_pass(i32_offsets)
     pm.add_cse_pass()
     pm.add_licm_pass()
     pm.add_symbol_dce_pass()
@@ -63,30 +87,53 @@ def optimize_ttir(mod, arch):
     return mod
 
 
-def ttir_to_ttgir(mod, num_warps):
-    pm = ir.pass_manager(mod.context)
-    pm.enable_debug()
+def ttir_to_ttgir(mod, num_warps, maxnreg=0, min_blocks_per_sm=0):
+    pm = make_pass_manager(mod.context)
     pm.add_convert_triton_to_tritongpu_pass(num_warps)
     pm.run(mod)
+    # launch bounds of the kernel, lowered to its nvvm annotations
+    if maxnreg:
+        mod.set_int_attr("triton_gpu.maxnreg", maxnreg)
+    if min_blocks_per_sm:
+        mod.set_int_attr("triton_gpu.min-blocks-per-sm", min_blocks_per_sm)
     return mod
 
 
-def optimize_ttgir(mod, num_stages, arch):
-    pm = ir.pass_manager(mod.context)
-    pm.enable_debug()
+def optimize_ttgir(mod, num_stages, arch, shared_budget=None, warp_specialize=False):
+    pm = make_pass_manager(mod.context)
     pm.add_tritongpu_coalesce_pass()
     pm.add_tritongpu_remove_layout_conversions_pass()
     if isinstance(arch, int):
-        pm.add_tritongpu_accelerate_matmul_pass(arch)
+        pm.add_tritongpu_accelerate_matmul_pass(arch, ptxVersion=get_ptx_version())
+    elif get_mfma_version(arch) > 0:
+        pm.add_tritongpu_accelerate_matmul_pass(0, get_mfma_version(arch))
+    # global layout assignment first, the greedy patterns clean up after it
+    pm.add_tritongpu_assign_layouts_pass()
     pm.add_tritongpu_remove_layout_conversions_pass()
     pm.add_tritongpu_optimize_dot_operands_pass()
-    pm.add_tritongpu_pipeline_pass(num_stages)
+    # short loops interleave their iterations instead of being pipelined
+    pm.add_tritongpu_unroll_loops_pass()
+    if num_stages == "auto" or num_stages > 1:
+        # lets the pipeliner prefetch across the tiles of persistent kernels
+        pm.add_tritongpu_flatten_loops_pass()
+    if warp_specialize and isinstance(arch, int) and arch >= 80:
+        # the buffers of the streamed operands take the place of the stages
+        pm.add_tritongpu_warp_specialize_pass(3 if num_stages == "auto" else max(num_stages, 2))
+    if num_stages == "auto":
+        # every loop gets the most stages whose buffers fit in `shared_budget`
+        pm.add_tritongpu_pipeline_pass(0, shared_budget)
+    else:
+        pm.add_tritongpu_pipeline_pass(num_stages)
     pm.add_tritongpu_prefetch_pass()
     pm.add_tritongpu_optimize_dot_operands_pass()
+    pm.add_tritongpu_assign_layouts_pass()
     pm.add_tritongpu_remove_layout_conversions_pass()
     pm.add_tritongpu_decompose_conversions_pass()
     pm.add_tritongpu_reorder_instructions_pass()
     pm.add_cse_pass()
+    # shortens the live ranges the pipeliner and the reordering stretched;
+    # after the last CSE, which would merge the copies back
+    pm.add_tritongpu_rematerialize_pass()
     pm.add_symbol_dce_pass()
     pm.run(mod)
     return mod
@@ -99,55 +146,94 @@ def _add_external_libs(mod, libs):
     add_external_libs(mod, list(libs.keys()), list(libs.values()))
 
 
-def ttgir_to_llir(mod, extern_libs, arch):
+def ttgir_to_llir(mod, extern_libs, arch, fast_math=False, print_buffer=False, opt_level=3):
     if extern_libs:
         _add_external_libs(mod, extern_libs)
     # TODO: separate tritongpu_to_llvmir for different backends
+    stats = _compile_stats.get()
     if _is_cuda(arch):
-        return translate_triton_gpu_to_llvmir(mod, arch, False)
+        return translate_triton_gpu_to_llvmir(mod, arch, False, fast_math, stats, print_buffer, opt_level)
     else:
-        return translate_triton_gpu_to_llvmir(mod, 0, True)
+        # the lowering of some ops depends on the generation of the AMD GPU
+        mod.set_int_attr("triton_gpu.gfx-major", get_gfx_major(arch))
+        return translate_triton_gpu_to_llvmir(mod, 0, True, False, stats, False, opt_level)
 
 
 # PTX translation
 
-@functools.lru_cache()
-def ptx_get_version(cuda_version) -> int:
-    '''
-    Get the highest PTX version supported by the current CUDA driver.
-    '''
-    assert isinstance(cuda_version, str)
-    major, minor = map(int, cuda_version.split('.'))
-    if major == 12:
-        return 80 + minor
-    if major == 11:
-        return 70 + minor
-    if major == 10:
-        return 63 + minor
-    raise RuntimeError("Triton only support CUDA 10.0 or higher")
-
-
-def llir_to_ptx(mod: Any, arch: int, ptx_version: int = None) -> str:
+def llir_to_ptx(mod: Any, arch: int, ptx_version: int = None, opt_level: int = 3) -> str:
     '''
     Translate TritonGPU module to PTX code.
     :param mod: a TritonGPU dialect module
+    :param opt_level: optimization level (0-3) of the NVPTX backend
     :return: PTX code
     '''
     if ptx_version is None:
-        _, cuda_version = path_to_ptxas()
-        ptx_version = ptx_get_version(cuda_version)
-    return translate_llvmir_to_ptx(mod, arch, ptx_version)
+        ptx_version = get_ptx_version()
+    return translate_llvmir_to_ptx(mod, arch, ptx_version, opt_level)
+
+
+# classes of the static instruction mix, by opcode prefix; the first match wins
+_instruction_classes = [
+    ("mma", ("mma", "wgmma", "wmma")),
+    ("global_load", ("ld.global", "ldu.global")),
+    ("global_store", ("st.global",)),
+    ("atomic", ("atom", "red")),
+    ("async_copy", ("cp.async",)),
+    ("shared_load", ("ld.shared", "ldmatrix")),
+    ("shared_store", ("st.shared", "stmatrix")),
+    ("barrier", ("bar", "barrier", "mbarrier", "fence", "membar")),
+    ("branch", ("bra", "ret", "call")),
+    ("convert", ("cvt", "mov", "shfl", "prmt")),
+]
+
+
+def get_instruction_mix(ptx: str) -> dict:
+    '''
+    Count the instructions of a PTX kernel by class.
+    :param ptx: ptx code
+    :return: the number of instructions of each class of `_instruction_classes`,
+        floating-point arithmetic as "float", the rest as "other", and the
+        overall "total"
+    '''
+    mix = {name: 0 for name, _ in _instruction_classes}
+    mix.update(float=0, other=0, total=0)
+    for line in ptx.splitlines():
+        line = line.strip()
+        if not line or line.startswith(("//", ".", "{", "}", "$")) or line.endswith(":"):
+            continue
+        if line.startswith("@"):
+            line = line.split(None, 1)[-1]
+        opcode = line.split(None, 1)[0].rstrip(";")
+        mix["total"] += 1
+        for name, prefixes in _instruction_classes:
+            if any(opcode == p or opcode.startswith(p + ".") for p in prefixes):
+                mix[name] += 1
+                break
+        else:
+            is_float = opcode.startswith(("fma.", "ex2.", "lg2.", "rcp.", "sqrt.", "rsqrt.")) or \
+                any(t in opcode.split(".") for t in ("f16", "f16x2", "bf16", "bf16x2", "f32", "f64"))
+            mix["float" if is_float else "other"] += 1
+    return mix
 
 
-def ptx_to_cubin(ptx: str, arch: int):
+def ptx_to_cubin(ptx: str, arch: int, resource_usage: dict = None, opt_level: int = 3, maxnreg: int = 0):
     '''
     Compile TritonGPU module to cubin.
     :param ptx: ptx code
     :param compute_capability: compute capability
+    :param resource_usage: if provided, filled with the register, shared memory
+        and spill counts reported by the assembler
+    :param opt_level: optimization level (0-3) passed to ptxas as `-O`
+    :param maxnreg: if not 0, the registers a thread may use, passed to ptxas
+        as `--maxrregcount`
     :return: str
     '''
     ptxas, _ = path_to_ptxas()
-    return compile_ptx_to_cubin(ptx, ptxas, arch)
+    cubin, usage = compile_ptx_to_cubin(ptx, ptxas, arch, opt_level, maxnreg)
+    if resource_usage is not None:
+        resource_usage.update(usage)
+    return cubin
 
 
 # AMDGCN translation
@@ -205,13 +291,13 @@ def get_amdgpu_arch_fulldetails():
         return None
 
 
-def llir_to_amdgcn_and_hsaco(mod: Any, gfx_arch: str, gfx_triple: str, gfx_features: str) -> Tuple[str, str]:
+def llir_to_amdgcn_and_hsaco(mod: Any, gfx_arch: str, gfx_triple: str, gfx_features: str) -> Tuple[str, bytes]:
     '''
     Translate TritonGPU module to HSACO code based on full details of gpu architecture.
     :param mod: a TritonGPU dialect module
     :return:
         - AMDGCN code
-        - Path to HSACO object
+        - HSACO binary
     '''
     return translate_llvmir_to_hsaco(mod, gfx_arch, gfx_triple, gfx_features)
 
@@ -239,21 +325,47 @@ def convert_type_repr(x):
     return x
 
 
+def make_ttir_key(fn, arch, signature, configs, constants, debug, i32_offsets=False, enable_tma=False,
+                  swizzle_pids=0, large_grid=False):
+    # everything the frontend and the TTIR optimizer depend on; num_warps and
+    # num_stages only come into play from ttir_to_ttgir onward
+    get_conf_key = lambda conf: (sorted(conf.divisible_by_16), sorted(conf.equal_to_1))
+    configs_key = [get_conf_key(conf) for conf in configs]
+    return f"{fn.cache_key}-{''.join(signature.values())}-{configs_key}-{constants}-{debug}-{i32_offsets}-{enable_tma}-{swizzle_pids}-{large_grid}-{arch}"
+
+
 def make_hash(fn, arch, **kwargs):
     if isinstance(fn, JITFunction):
         configs = kwargs["configs"]
         signature = kwargs["signature"]
         constants = kwargs.get("constants", dict())
+        # JIT functions passed as constexprs change the code along with their source
+        constants = {key: value.cache_key if isinstance(value, JITFunction) else value
+                     for key, value in constants.items()}
         num_warps = kwargs.get("num_warps", 4)
         num_stages = kwargs.get("num_stages", 3)
+        if num_stages == "auto":
+            num_stages = f"auto{kwargs['shared_budget']}"
         debug = kwargs.get("debug", False)
+        i32_offsets = kwargs.get("i32_offsets", False)
+        warp_specialize = kwargs.get("warp_specialize", False)
+        enable_tma = kwargs.get("enable_tma", False)
+        swizzle_pids = kwargs.get("swizzle_pids", 0)
+        large_grid = kwargs.get("large_grid", False)
+        fast_math = kwargs.get("fast_math", False)
+        print_buffer = kwargs.get("print_buffer", False)
+        opt_level = kwargs.get("opt_level", 3)
+        maxnreg = kwargs.get("maxnreg", 0)
+        min_blocks_per_sm = kwargs.get("min_blocks_per_sm", 0)
+        num_ctas = kwargs.get("num_ctas", 1)
         # Get unique key for the compiled code
         get_conf_key = lambda conf: (sorted(conf.divisible_by_16), sorted(conf.equal_to_1))
         configs_key = [get_conf_key(conf) for conf in configs]
-        key = f"{fn.cache_key}-{''.join(signature.values())}-{configs_key}-{constants}-{num_warps}-{num_stages}-{debug}-{arch}"
+        key = f"{fn.cache_key}-{''.join(signature.values())}-{configs_key}-{constants}-{num_warps}-{num_stages}-{debug}-{i32_offsets}-{warp_specialize}-{enable_tma}-{swizzle_pids}-{large_grid}-{fast_math}-{print_buffer}-{opt_level}-{maxnreg}-{min_blocks_per_sm}-{num_ctas}-{arch}"
         return hashlib.md5(key.encode("utf-8")).hexdigest()
     assert isinstance(fn, str)
-    return hashlib.md5((Path(fn).read_text() + version_key()).encode("utf-8")).hexdigest()
+    opt_level = kwargs.get("opt_level", 3)
+    return hashlib.md5((Path(fn).read_text() + version_key() + f"-{opt_level}").encode("utf-8")).hexdigest()
 
 
 # - ^\s*tt\.func\s+ : match the start of the string, any leading whitespace, the keyword func,
@@ -296,6 +408,47 @@ def _get_jsonable_constants(constants):
     return serialized_constants
 
 
+class ContextPool:
+    """
+    A thread-safe pool of MLIR contexts that already have all the Triton
+    dialects loaded, so that back-to-back compilations don't pay for context
+    creation and dialect registration.
+
+    A context keeps every type and attribute it has ever uniqued, so it is
+    dropped after `max_uses` compilations, and at most `max_idle` contexts
+    are kept around between compilations (0 disables pooling).
+    """
+
+    def __init__(self, max_idle=None, max_uses=None):
+        if max_idle is None:
+            max_idle = int(os.environ.get("TRITON_CONTEXT_POOL_SIZE", "4"))
+        if max_uses is None:
+            max_uses = int(os.environ.get("TRITON_CONTEXT_POOL_MAX_USES", "64"))
+        self.max_idle = max_idle
+        self.max_uses = max_uses
+        self._lock = threading.Lock()
+        self._idle = []
+        self._uses = dict()
+
+    def acquire(self):
+        with self._lock:
+            if self._idle:
+                return self._idle.pop()
+        context = ir.context()
+        context.load_all_dialects()
+        return context
+
+    def release(self, context):
+        with self._lock:
+            uses = self._uses.pop(context, 0) + 1
+            if uses < self.max_uses and len(self._idle) < self.max_idle:
+                self._uses[context] = uses
+                self._idle.append(context)
+
+
+context_pool = ContextPool()
+
+
 def parse_mlir_module(path, context):
     module = ir.parse_mlir_module(path, context)
     # module takes ownership of the context
@@ -303,6 +456,64 @@ def parse_mlir_module(path, context):
     return module
 
 
+class TTIRCache:
+    """
+    An in-memory LRU of optimized TTIR, stored as MLIR bytecode.
+
+    Autotuning sweeps compile the same kernel for many (num_warps, num_stages)
+    pairs, and the whole frontend (AST walk, TTIR optimization) is identical
+    for all of them. Entries are keyed by `make_ttir_key` and re-parsed into
+    the caller's context, since ttir_to_ttgir rewrites its input in place.
+    At most `max_entries` modules are kept (0 disables the cache).
+    """
+
+    def __init__(self, max_entries=None):
+        if max_entries is None:
+            max_entries = int(os.environ.get("TRITON_TTIR_CACHE_SIZE", "256"))
+        self.max_entries = max_entries
+        self._lock = threading.Lock()
+        self._entries = OrderedDict()
+
+    def get(self, key):
+        with self._lock:
+            bytecode = self._entries.get(key)
+            if bytecode is not None:
+                self._entries.move_to_end(key)
+            return bytecode
+
+    def put(self, key, bytecode):
+        if self.max_entries <= 0:
+            return
+        with self._lock:
+            self._entries[key] = bytecode
+            self._entries.move_to_end(key)
+            while len(self._entries) > self.max_entries:
+                self._entries.popitem(last=False)
+
+    def clear(self):
+        with self._lock:
+            self._entries.clear()
+
+
+ttir_cache = TTIRCache()
+
+
+def ast_to_optimized_ttir(fn, signature, configs, constants, debug, arch, context, i32_offsets=False,
+                          enable_tma=False, swizzle_pids=0, large_grid=False):
+    key = make_ttir_key(fn, arch, signature, configs, constants, debug, i32_offsets, enable_tma, swizzle_pids,
+                        large_grid)
+    bytecode = ttir_cache.get(key)
+    if bytecode is not None:
+        module = ir.parse_mlir_bytecode(bytecode, context)
+        module.context = context
+        return module
+    module = optimize_ttir(ast_to_ttir(fn, signature, configs[0], constants, debug=debug, arch=arch,
+                                       context=context), arch, i32_offsets, enable_tma, swizzle_pids,
+                           large_grid)
+    ttir_cache.put(key, bytes(module.bytecode()))
+    return module
+
+
 instance_descriptor = namedtuple("instance_descriptor", ["divisible_by_16", "equal_to_1"], defaults=[set(), set()])
 
 
@@ -326,6 +537,32 @@ def get_architecture_descriptor(capability):
     return capability
 
 
+def get_mfma_version(arch):
+    """
+    generation of the matrix cores of the AMD GPU `arch` (the details of
+    `get_amdgpu_arch_fulldetails`) that dots run on, or 0 to run them on FMAs
+    """
+    if not isinstance(arch, list):
+        return 0
+    gfx_arch = os.environ.get('MI_GPU_ARCH', arch[1])
+    if gfx_arch == 'gfx90a':
+        return 2
+    if gfx_arch in ['gfx940', 'gfx941', 'gfx942']:
+        return 3
+    return 0
+
+
+def get_gfx_major(arch):
+    """
+    major version of the gfx architecture of the AMD GPU `arch` (the details
+    of `get_amdgpu_arch_fulldetails`): 9 for gfx90a, 11 for gfx1100, or 0
+    when unknown
+    """
+    gfx_arch = os.environ.get('MI_GPU_ARCH', arch[1]) if isinstance(arch, list) else None
+    match = re.fullmatch('gfx(\\d+)[0-9a-f]{2}', gfx_arch or "")
+    return int(match.group(1)) if match else 0
+
+
 def add_rocm_stages(arch, extern_libs, stages):
     extern_libs.update(get_amdgcn_bitcode_paths(arch))
 
@@ -343,12 +580,77 @@ def add_rocm_stages(arch, extern_libs, stages):
                                                              gfx_arch_full_details[2]))
 
 
-def add_cuda_stages(arch, extern_libs, stages):
+def add_cuda_stages(arch, extern_libs, stages, resource_usage=None, opt_level=3, maxnreg=0):
 
     stages["ptx"] = (lambda path: Path(path).read_text(),
-                     lambda src: llir_to_ptx(src, arch))
+                     lambda src: llir_to_ptx(src, arch, opt_level=opt_level))
     stages["cubin"] = (lambda path: Path(path).read_bytes(),
-                       lambda src: ptx_to_cubin(src, arch))
+                       lambda src: ptx_to_cubin(src, arch, resource_usage, opt_level, maxnreg))
+
+
+def get_default_opt_level():
+    """
+    optimization level of the kernels that do not set `opt_level`:
+    `TRITON_OPT_LEVEL` (3 by default)
+    """
+    return int(os.environ.get("TRITON_OPT_LEVEL", "3"))
+
+
+# heuristics of num_warps="auto", by the lowest compute capability they apply
+# to (0 for the others and for AMD GPUs): the bytes of its largest tensor each
+# thread of a kernel without dots handles, the elements of the result of its
+# largest dot each 32 threads of a warp compute, and the range of num_warps
+auto_num_warps_table = {
+    0: {"bytes_per_thread": 32, "dot_elems_per_warp": 2048, "min_warps": 1, "max_warps": 8},
+    # warp groups of 4 warps issue the wgmma instructions of Hopper
+    90: {"bytes_per_thread": 32, "dot_elems_per_warp": 2048, "min_warps": 4, "max_warps": 8},
+}
+
+
+def get_auto_num_warps(mod, arch, warp_size=32):
+    """
+    num_warps of a kernel compiled with `num_warps="auto"`, from the shape of
+    the largest dot of its TTIR `mod` or, without dots, from the size in bytes
+    of its largest tensor, for warps of `warp_size` threads
+    """
+    capability = arch if isinstance(arch, int) else 0
+    heuristic = auto_num_warps_table[max(cc for cc in auto_num_warps_table if cc <= capability)]
+    footprint = get_tensor_footprint(mod)
+    if footprint["dot"] is not None:
+        m, n, _, _ = footprint["dot"]
+        num_warps = m * n // (heuristic["dot_elems_per_warp"] * warp_size // 32)
+        min_warps = heuristic["min_warps"]
+    else:
+        num_warps = footprint["numel"] * footprint["bitwidth"] // 8 // (warp_size * heuristic["bytes_per_thread"])
+        min_warps = 1
+    num_warps = min(max(num_warps, min_warps), heuristic["max_warps"])
+    # largest power of 2 not above it
+    return 1 << (num_warps.bit_length() - 1)
+
+
+def get_warp_size(is_hip):
+    """
+    threads per warp of the current device: 32 on NVIDIA GPUs, and the
+    wavefront size, 64 unless reported otherwise, on AMD GPUs
+    """
+    if not is_hip:
+        return 32
+    return driver.utils.get_device_properties(get_current_device()).get("warp_size", 64)
+
+
+def get_auto_stages_shared_budget(device_type):
+    """
+    shared memory the buffers of a kernel compiled with `num_stages="auto"`
+    may use on the current device, leaving room for as many CTAs per SM as
+    `TRITON_AUTO_STAGES_CTAS_PER_SM` (1 by default)
+    """
+    if device_type in ["cuda", "hip"]:
+        max_shared = driver.utils.get_device_properties(get_current_device())["max_shared_mem"]
+    else:
+        backend = get_backend(device_type)
+        max_shared = backend.get_device_properties(backend.get_current_device())["max_shared_mem"]
+    ctas_per_sm = max(int(os.environ.get("TRITON_AUTO_STAGES_CTAS_PER_SM", "1")), 1)
+    return max_shared // ctas_per_sm
 
 
 def compile(fn, **kwargs):
@@ -365,26 +667,66 @@ def compile(fn, **kwargs):
 
     is_cuda = device_type == "cuda" and _is_cuda(arch)
     is_hip = device_type in ["cuda", "hip"] and not is_cuda
-    context = ir.context()
     constants = kwargs.get("constants", dict())
     num_warps = kwargs.get("num_warps", 4)
     num_stages = kwargs.get("num_stages", 3 if is_cuda and arch >= 75 else 2)
+    # with num_stages="auto", the pipeliner selects the stages of every loop
+    # from the shared memory of the device
+    if num_stages == "auto" and "shared_budget" not in kwargs:
+        kwargs["shared_budget"] = get_auto_stages_shared_budget(device_type)
+    # the optimization level (0-3) of LLVM, its NVPTX backend and ptxas; lower
+    # levels trade the speed of the kernel for the speed of the compilation
+    if kwargs.get("opt_level") is None:
+        kwargs["opt_level"] = get_default_opt_level()
+    opt_level = kwargs["opt_level"]
     extern_libs = kwargs.get("extern_libs", dict())
     if extern_libs is None:
         extern_libs = dict()
     debug = kwargs.get("debug", False)
+    # whether all tensors are known to be smaller than 2GB, which lets
+    # addresses be computed in 32 bits
+    i32_offsets = kwargs.get("i32_offsets", False)
+    # whether a second group of warps loads the dot operands
+    warp_specialize = kwargs.get("warp_specialize", False)
+    # whether sm90 loads block pointers with the Tensor Memory Accelerator
+    enable_tma = kwargs.get("enable_tma", False)
+    # the number of rows of the groups the 2-D program ids are remapped into
+    swizzle_pids = kwargs.get("swizzle_pids", 0)
+    # whether the grid is launched along axis 0, for grids with more than
+    # 65535 programs along axes 1 or 2 (see `fold_large_grid`)
+    large_grid = kwargs.get("large_grid", False)
+    # whether f32 math is approximated, like nvcc's --use_fast_math
+    fast_math = kwargs.get("fast_math", False)
+    # launch bounds: the registers a thread may use and the CTAs that must
+    # fit on an SM at once, 0 when unbounded
+    maxnreg = kwargs.get("maxnreg", 0)
+    min_blocks_per_sm = kwargs.get("min_blocks_per_sm", 0)
+    # the CTAs of a thread block cluster, along axis 0 of the grid
+    num_ctas = kwargs.get("num_ctas", 1)
+    if num_ctas > 1:
+        assert is_cuda and arch >= 90, "thread block clusters require sm90"
+        assert num_ctas <= 8, "thread block clusters have at most 8 CTAs"
+    # whether device prints write to the ring buffer of the runtime
+    print_buffer = kwargs.get("print_buffer", False) and is_cuda
+    # filled by the cubin stage with the assembler's `-v` report
+    resource_usage = dict()
 
     # build compilation stages
     stages = dict()
     stages["ast"] = (lambda path: fn, None)
     stages["ttir"] = (lambda path: parse_mlir_module(path, context),
-                      lambda src: optimize_ttir(ast_to_ttir(src, signature, configs[0], constants, debug=debug, arch=arch), arch))
+                      lambda src: ast_to_optimized_ttir(src, signature, configs, constants, debug, arch, context,
+                                                        i32_offsets, enable_tma, swizzle_pids, large_grid))
+    # with num_warps="auto", num_warps is picked from the tensors of the TTIR
+    get_num_warps_of = (lambda src: get_auto_num_warps(src, arch, get_warp_size(is_hip))) \
+        if num_warps == "auto" else (lambda src: num_warps)
     stages["ttgir"] = (lambda path: parse_mlir_module(path, context),
-                       lambda src: optimize_ttgir(ttir_to_ttgir(src, num_warps), num_stages, arch))
+                       lambda src: optimize_ttgir(ttir_to_ttgir(src, get_num_warps_of(src), maxnreg, min_blocks_per_sm),
+                                                  num_stages, arch, kwargs.get("shared_budget"), warp_specialize))
     stages["llir"] = (lambda path: Path(path).read_text(),
-                      lambda src: ttgir_to_llir(src, extern_libs, arch))
+                      lambda src: ttgir_to_llir(src, extern_libs, arch, fast_math, print_buffer, opt_level))
     if is_cuda:
-        add_cuda_stages(arch, extern_libs, stages)
+        add_cuda_stages(arch, extern_libs, stages, resource_usage, opt_level, maxnreg)
     elif is_hip:
         add_rocm_stages(arch, extern_libs, stages)
     else:
@@ -420,12 +762,6 @@ def compile(fn, **kwargs):
         signature = {k: v for k, v in enumerate(param_tys)}
         first_stage = list(stages.keys()).index(ir_name)
 
-    # cache manager
-    if is_cuda or is_hip:
-        so_path = make_stub(name, signature, constants)
-    else:
-        so_path = _device_backend.make_launcher_stub(name, signature, constants)
-
     # create cache manager
     fn_cache_manager = get_cache_manager(make_hash(fn, arch, **kwargs))
     # determine name and extension type of provided function
@@ -445,6 +781,13 @@ def compile(fn, **kwargs):
 
     metadata_path = metadata_group.get(metadata_filename)
 
+    # in compile-server mode, a worker process compiles the kernel into the
+    # cache, which this process then loads
+    if metadata_path is None and isinstance(fn, JITFunction) and not prune_spilling.get() \
+            and compile_in_worker(fn, dict(kwargs, cc=arch)):
+        metadata_group = fn_cache_manager.get_group(metadata_filename) or {}
+        metadata_path = metadata_group.get(metadata_filename)
+
     if metadata_path is not None:
         with open(metadata_path) as f:
             metadata = json.load(f)
@@ -453,6 +796,8 @@ def compile(fn, **kwargs):
                     "num_stages": num_stages,
                     "constants": _get_jsonable_constants(constants),
                     "debug": debug,
+                    "cluster_dims": [num_ctas, 1, 1],
+                    "large_grid": large_grid,
                     "arch": arch, }
         if ext == "ptx":
             assert "shared" in kwargs, "ptx compilation must provide shared memory size"
@@ -464,55 +809,159 @@ def compile(fn, **kwargs):
     first_stage = list(stages.keys()).index(ext)
     asm = dict()
     module = fn
-    # run compilation pipeline  and populate metadata
-    for ir_name, (parse, compile_kernel) in list(stages.items())[first_stage:]:
-        ir_filename = f"{name}.{ir_name}"
+    stats = ir.compile_statistics()
+    stage_times = dict()
+    # MLIR stages are also cached as bytecode, which is much faster to load
+    # when the pipeline has to be re-entered from them
+    mlir_stages = ["ttir", "ttgir"]
+    pipeline = list(stages.items())[first_stage:]
+    # modules of cached stages are only parsed if a later stage needs them
+    cached = [f"{name}.{ir_name}" in metadata_group for ir_name, _ in pipeline]
+    # run compilation pipeline  and populate metadata; the statistics of the
+    # passes are collected until the pipeline exits, however it does
+    stats_token = _compile_stats.set(stats)
+    # the stages parse and build their modules in a context of the pool, which
+    # gets it back whether the pipeline succeeds or raises
+    context = context_pool.acquire()
+    try:
+        for i, (ir_name, (parse, compile_kernel)) in enumerate(pipeline):
+            ir_filename = f"{name}.{ir_name}"
+            bytecode_filename = f"{ir_filename}bc"
 
-        if ir_name == ext:
-            next_module = parse(fn)
-        else:
-            path = metadata_group.get(ir_filename)
-            if path is None:
-                next_module = compile_kernel(module)
-                if ir == "amdgcn":
-                    extra_file_name = f"{name}.hsaco_path"
-                    metadata_group[ir_filename] = fn_cache_manager.put(next_module[0], ir_filename)
-                    metadata_group[extra_file_name] = fn_cache_manager.put(next_module[1], extra_file_name)
-                else:
-                    metadata_group[ir_filename] = fn_cache_manager.put(next_module, ir_filename)
-                    fn_cache_manager.put(next_module, ir_filename)
+            if ir_name == ext:
+                next_module = parse(fn)
             else:
-                if ir_name == "amdgcn":
-                    extra_file_name = f"{name}.hsaco_path"
-                    hasco_path = metadata_group.get(extra_file_name)
-                    assert hasco_path is not None, "Expected to have hsaco_path in metadata when we have the amdgcn"
-                    next_module = (parse(path), parse(hasco_path))
+                path = metadata_group.get(ir_filename)
+                if path is None:
+                    stage_start = time.perf_counter()
+                    next_module = compile_kernel(module)
+                    stage_times[ir_name] = time.perf_counter() - stage_start
+                    if ir_name == "amdgcn":
+                        extra_file_name = f"{name}.hsaco"
+                        metadata_group[ir_filename] = fn_cache_manager.put(next_module[0], ir_filename)
+                        metadata_group[extra_file_name] = fn_cache_manager.put(next_module[1], extra_file_name)
+                    else:
+                        metadata_group[ir_filename] = fn_cache_manager.put(next_module, ir_filename)
+                        fn_cache_manager.put(next_module, ir_filename)
+                        if ir_name in mlir_stages:
+                            metadata_group[bytecode_filename] = fn_cache_manager.put(bytes(next_module.bytecode()),
+                                                                                     bytecode_filename)
                 else:
-                    next_module = parse(path)
-
-        if ir_name == "cubin":
-            asm[ir_name] = next_module
-        elif ir_name == "amdgcn":
-            asm[ir_name] = str(next_module[0])
-        else:
-            asm[ir_name] = str(next_module)
-        if ir_name == "llir" and "shared" not in metadata:
-            metadata["shared"] = get_shared_memory_size(module)
-        if ir_name == "ptx":
-            metadata["name"] = get_kernel_name(next_module, pattern='// .globl')
-        if ir_name == "amdgcn":
-            metadata["name"] = get_kernel_name(next_module[0], pattern='.globl')
-            asm["hsaco_path"] = next_module[1]
-        if not is_cuda and not is_hip:
-            _device_backend.add_meta_info(ir_name, module, next_module, metadata, asm)
-        module = next_module
+                    if ir_name == "amdgcn":
+                        extra_file_name = f"{name}.hsaco"
+                        hsaco_path = metadata_group.get(extra_file_name)
+                        assert hsaco_path is not None, "Expected to have the hsaco in metadata when we have the amdgcn"
+                        next_module = (parse(path), Path(hsaco_path).read_bytes())
+                    elif ir_name in mlir_stages and (is_cuda or is_hip) and all(cached[i + 1:]):
+                        # all later stages are cached too, so only the text is needed
+                        next_module = Path(path).read_text()
+                    elif ir_name in mlir_stages and bytecode_filename in metadata_group:
+                        next_module = parse(metadata_group[bytecode_filename])
+                    else:
+                        next_module = parse(path)
+
+            if ir_name == "cubin":
+                asm[ir_name] = next_module
+            elif ir_name == "amdgcn":
+                asm[ir_name] = str(next_module[0])
+            else:
+                asm[ir_name] = str(next_module)
+            if ir_name in mlir_stages and "tensor_maps" not in metadata and not isinstance(next_module, str):
+                # the tensor maps the launcher passes to the kernel
+                metadata["tensor_maps"] = get_tensor_maps(next_module)
+            if ir_name == "ttgir" and metadata["num_warps"] == "auto" and not isinstance(next_module, str):
+                metadata["num_warps"] = get_num_warps(next_module)
+            if ir_name == "ttgir" and metadata["num_stages"] == "auto" and not isinstance(next_module, str):
+                # the largest number of stages the pipeliner selected
+                metadata["num_stages"] = get_num_stages(next_module)
+            if ir_name == "ttgir" and print_buffer and "print_records" not in metadata and not isinstance(next_module, str):
+                # how the runtime formats the records of the device prints
+                metadata["print_records"] = get_print_records(next_module)
+            if ir_name == "ttgir" and "profile_regions" not in metadata and not isinstance(next_module, str):
+                # the regions whose cycles the kernel counts
+                metadata["profile_regions"] = get_profile_regions(next_module)
+            if ir_name == "ttgir" and "num_warp_groups" not in metadata and not isinstance(next_module, str):
+                metadata["num_warp_groups"] = get_num_warp_groups(next_module)
+            if ir_name == "ttgir" and is_cuda:
+                if "reg_pressure" not in metadata and not isinstance(next_module, str):
+                    # estimated live 32-bit registers per thread
+                    metadata["reg_pressure"] = get_register_pressure(next_module)
+                    metadata["reg_budget"] = get_register_budget(next_module)
+                if prune_spilling.get() and metadata.get("reg_pressure", 0) > metadata.get("reg_budget", 255):
+                    raise OutOfResources(metadata["reg_pressure"], metadata["reg_budget"], "registers")
+            if ir_name == "llir" and "shared" not in metadata:
+                metadata["shared"] = get_shared_memory_size(module)
+                # largest amount of shared memory live at once; "shared" above it
+                # is packing overhead
+                metadata["shared_lower_bound"] = get_shared_memory_lower_bound(module)
+            if ir_name == "ptx":
+                metadata["name"] = get_kernel_name(next_module, pattern='// .globl')
+                metadata["instruction_mix"] = get_instruction_mix(next_module)
+            if ir_name == "amdgcn":
+                metadata["name"] = get_kernel_name(next_module[0], pattern='.globl')
+                asm["hsaco"] = next_module[1]
+            if not is_cuda and not is_hip:
+                _device_backend.add_meta_info(ir_name, module, next_module, metadata, asm)
+            module = next_module
+    finally:
+        _compile_stats.reset(stats_token)
+        context_pool.release(context)
     # write-back metadata, if it didn't come from the cache
     if metadata_path is None:
+        if resource_usage:
+            metadata["resource_usage"] = resource_usage
+        if stage_times:
+            metadata["compile_stats"] = {"stages": stage_times,
+                                         "timings": stats.timings,
+                                         "passes": stats.passes}
         metadata_group[metadata_filename] = fn_cache_manager.put(json.dumps(metadata), metadata_filename, binary=False)
         fn_cache_manager.put_group(metadata_filename, metadata_group)
 
+    # the launcher builds the tensor maps of the kernel, so it is only
+    # generated once they are known
+    tensor_maps = metadata.get("tensor_maps")
+    if tensor_maps and not isinstance(fn, JITFunction):
+        # the prototype of the source ends with the tensor maps
+        signature = dict(list(signature.items())[:-len(tensor_maps)])
+    if metadata.get("large_grid") and isinstance(fn, JITFunction):
+        # the kernel takes the grid after the arguments of the signature
+        num_args = len(fn.arg_names)
+        signature = {**signature, num_args: "i32", num_args + 1: "i32", num_args + 2: "i32"}
+    cluster_dims = tuple(metadata.get("cluster_dims", (1, 1, 1)))
+    launcher = None
+    so_path = None
+    if is_cuda and not tensor_maps and driver.backend == driver.CUDA:
+        # the prebuilt launcher of cuda_utils takes the signature as a
+        # descriptor, so no launcher is compiled
+        launcher = driver.utils.make_launcher(make_launcher_descriptor(signature, constants), cluster_dims)
+    elif is_cuda or is_hip:
+        so_path = make_stub(name, signature, constants, tensor_maps, cluster_dims)
+    else:
+        so_path = _device_backend.make_launcher_stub(name, signature, constants)
+
     # return handle to compiled kernel
-    return CompiledKernel(fn, so_path, metadata, asm)
+    # types of the arguments the kernel is actually launched with, in launcher
+    # order; specialized-away arguments are None
+    arg_types = [None if i in constants else ty for i, ty in signature.items()]
+    return CompiledKernel(fn, so_path, metadata, asm, arg_types, launcher)
+
+
+KernelHandles = namedtuple("KernelHandles", ["module", "function", "profile_counters"])
+
+
+def fold_large_grid(launch):
+    """
+    Wraps the launcher `launch` of a kernel compiled with `large_grid`: the
+    programs of the grid are launched along axis 0, which has room for 2^31 - 1
+    of them, and the kernel takes the grid after its arguments to recover its
+    program ids.
+    """
+    def launch_large_grid(grid_0, grid_1, grid_2, *args):
+        num_programs = grid_0 * grid_1 * grid_2
+        if num_programs > 2**31 - 1:
+            raise ValueError(f"grid ({grid_0}, {grid_1}, {grid_2}) has more than 2^31 - 1 programs")
+        return launch(num_programs, 1, 1, *args, grid_0, grid_1, grid_2)
+    return launch_large_grid
 
 
 class CompiledKernel:
@@ -520,19 +969,34 @@ class CompiledKernel:
     # Hooks for external tools to monitor the execution of triton kernels
     launch_enter_hook = None
     launch_exit_hook = None
+    # When set (see `triton.runtime.graph.KernelGraph.record`), launches are
+    # handed to the recorder instead of being submitted to the device
+    launch_recorder = None
 
-    def __init__(self, fn, so_path, metadata, asm):
-        # initialize launcher
-        import importlib.util
-        spec = importlib.util.spec_from_file_location("__triton_launcher", so_path)
-        mod = importlib.util.module_from_spec(spec)
+    def __init__(self, fn, so_path, metadata, asm, arg_types=None, launcher=None):
         self.fn = fn
-        spec.loader.exec_module(mod)
-        self.c_wrapper = getattr(mod, "launch")
+        # initialize launcher: `launcher` when given, otherwise the launch
+        # function of the stub at `so_path`
+        if launcher is not None:
+            self.c_wrapper = launcher
+        else:
+            import importlib.util
+            spec = importlib.util.spec_from_file_location("__triton_launcher", so_path)
+            mod = importlib.util.module_from_spec(spec)
+            spec.loader.exec_module(mod)
+            self.c_wrapper = getattr(mod, "launch")
+            if metadata["device_type"] == "cuda" and hasattr(mod, "set_tracer"):
+                mod.set_tracer(driver.utils.launch_tracer)
+        self.large_grid = metadata.get("large_grid", False)
+        if self.large_grid:
+            self.c_wrapper = fold_large_grid(self.c_wrapper)
         # initialize metadata
         self.shared = metadata["shared"] if "shared" in metadata else 0
-        self.num_warps = metadata["num_warps"]
+        # warps launched per CTA: each warp group runs num_warps warps
+        self.num_warps = metadata["num_warps"] * metadata.get("num_warp_groups", 1)
         self.num_stages = metadata["num_stages"]
+        # shape of the thread block clusters the CTAs are launched in
+        self.cluster_dims = tuple(metadata.get("cluster_dims", (1, 1, 1)))
         self.constants = metadata["constants"]
         self.device_type = metadata["device_type"]
         self.device_backend = get_backend(self.device_type) if self.device_type not in ["cuda", "hip"] else None
@@ -542,41 +1006,102 @@ class CompiledKernel:
         # because it involves doing runtime things
         # (e.g., checking amount of shared memory on current device)
         self.metadata = metadata
-        self.cu_module = None
-        self.cu_function = None
-
-    def _init_handles(self):
-        if self.cu_module is not None:
-            return
-
+        # per-stage and per-pass timings of the compilation that produced
+        # this kernel
+        self.compile_stats = metadata.get("compile_stats", None)
+        self.arg_types = arg_types
+        # the driver handles of the kernel on each device it was launched on,
+        # loaded from the same binary on first use there
+        self.handles = dict()
+        self._handles_lock = threading.Lock()
+        # set when the binary is loaded, see `resource_report`
+        self.n_regs = None
+        self.n_spills = None
+        self.occupancy = None
+
+    def _get_current_device(self):
+        if self.device_type in ["cuda", "hip"]:
+            return get_current_device()
+        return self.device_backend.get_current_device()
+
+    def _init_handles(self, device=None):
+        """
+        The handles of the kernel on `device` (the current device by
+        default), loading its binary there on first use.
+        """
+        if device is None:
+            device = self._get_current_device()
+        handles = self.handles.get(device, None)
+        if handles is not None:
+            return handles
+        with self._handles_lock:
+            handles = self.handles.get(device, None)
+            if handles is None:
+                handles = self._load_handles(device)
+                self.handles[device] = handles
+        return handles
+
+    def get_function(self, device):
+        """ The function handle of the kernel on `device` """
+        return self._init_handles(device).function
+
+    @property
+    def cu_module(self):
+        return self._init_handles().module
+
+    @property
+    def cu_function(self):
+        return self._init_handles().function
+
+    @property
+    def profile_counters(self):
+        return self._init_handles().profile_counters
+
+    def _load_handles(self, device):
         if self.device_type in ["cuda", "hip"]:
-            device = get_current_device()
             bin_path = {
-                driver.HIP: "hsaco_path",
+                driver.HIP: "hsaco",
                 driver.CUDA: "cubin"
             }[driver.backend]
-            max_shared = driver.utils.get_device_properties(device)["max_shared_mem"]
+            props = driver.utils.get_device_properties(device)
             fn_load_binary = driver.utils.load_binary
         else:
             assert self.device_backend
-            device = self.device_backend.get_current_device()
             bin_path = self.device_backend.get_kernel_bin()
-            max_shared = self.device_backend.get_device_properties(device)["max_shared_mem"]
+            props = self.device_backend.get_device_properties(device)
             fn_load_binary = self.device_backend.get_load_binary_fn()
 
+        max_shared = props["max_shared_mem"]
         if self.shared > max_shared:
             raise OutOfResources(self.shared, max_shared, "shared memory")
 
         mod, func, n_regs, n_spills = fn_load_binary(self.metadata["name"], self.asm[bin_path], self.shared, device)
 
+        if self.metadata.get("print_records"):
+            get_print_buffer(device).attach(mod, self.metadata["print_records"])
+        profile_counters = None
+        if self.metadata.get("profile_regions"):
+            import torch
+            # the cycles and the visits of each region
+            profile_counters = torch.zeros(2 * len(self.metadata["profile_regions"]), dtype=torch.int64,
+                                           device=device)
+            driver.utils.write_global(mod, "triton_profile_buffer",
+                                      struct.pack("<Q", profile_counters.data_ptr()))
+
+        if self.device_type == "cuda" and driver.backend == driver.CUDA:
+            driver.utils.trace_register(func, self.metadata["name"])
+        # the same binary uses the same resources on every device
         self.n_spills = n_spills
         self.n_regs = n_regs
-        self.cu_module = mod
-        self.cu_function = func
+        self.occupancy = get_occupancy(self.num_warps, n_regs, self.shared, props)
+        return KernelHandles(mod, func, profile_counters)
 
     def __getattribute__(self, name):
         if name == 'c_wrapper':
-            self._init_handles()
+            recorder = CompiledKernel.launch_recorder
+            if recorder is not None:
+                wrapper = recorder.make_wrapper(self)
+                return fold_large_grid(wrapper) if self.large_grid else wrapper
         return super().__getattribute__(name)
 
     def __getitem__(self, grid):
@@ -592,6 +1117,44 @@ class CompiledKernel:
                            CompiledKernel.launch_enter_hook, CompiledKernel.launch_exit_hook, self, *args)
         return runner
 
+    def profile(self):
+        """
+        The cycles the warps spent in each region of
+        :code:`tl.profile_region_begin` and :code:`tl.profile_region_end` since
+        the kernel was loaded on the current device or last reset, summed over
+        the warps and programs, along with the number of times they went
+        through it.
+        """
+        import torch
+        profile_counters = self.profile_counters
+        if profile_counters is None:
+            return dict()
+        torch.cuda.synchronize(profile_counters.device)
+        counters = profile_counters.tolist()
+        regions = dict()
+        for i, name in enumerate(self.metadata["profile_regions"]):
+            cycles, count = counters[2 * i], counters[2 * i + 1]
+            regions[name] = {"cycles": cycles, "count": count, "mean_cycles": cycles / count if count else 0.0}
+        return regions
+
+    def reset_profile(self):
+        if self.profile_counters is not None:
+            self.profile_counters.zero_()
+
+    def resource_report(self):
+        """
+        The resources a CTA of the kernel uses on the current device, the
+        theoretical occupancy they allow (see `get_occupancy`), and the static
+        instruction mix of its PTX.
+        """
+        self._init_handles()
+        return {"registers": self.n_regs,
+                "spills": self.n_spills,
+                "shared": self.shared,
+                "num_warps": self.num_warps,
+                "occupancy": self.occupancy,
+                "instruction_mix": self.metadata.get("instruction_mix")}
+
     def get_sass(self, fun=None):
         if 'sass' in self.asm:
             return self.asm['sass']
@@ -604,3 +1167,17 @@ class CompiledKernel:
             os.remove(path)
         self.asm['sass'] = self.sass
         return self.sass
+
+    def get_sass_report(self):
+        """
+        Static performance report of the kernel's SASS (see
+        `triton.tools.disasm.report`): instruction mix, shared-memory access
+        widths, spills, predication, and per-loop stall cycles.
+        """
+        fd, path = tempfile.mkstemp()
+        try:
+            with open(fd, 'wb') as cubin:
+                cubin.write(self.asm['cubin'])
+            return report_cubin(path, self.metadata["name"])[self.metadata["name"]]
+        finally:
+            os.remove(path)
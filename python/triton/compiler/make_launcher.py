@@ -15,24 +15,24 @@ def is_hip():
 # ----- stub --------
 
 
-def make_so_cache_key(version_hash, signature, constants):
+def make_so_cache_key(version_hash, signature, constants, tensor_maps=None, cluster_dims=(1, 1, 1)):
     # Get unique key for the compiled code
     signature = {k: 'ptr' if v[0] == '*' else v for k, v in signature.items()}
-    key = f"{version_hash}-{''.join(signature.values())}{constants}"
+    key = f"{version_hash}-{''.join(signature.values())}{constants}{tensor_maps or ''}{tuple(cluster_dims)}"
     key = hashlib.md5(key.encode("utf-8")).hexdigest()
     return key
 
 
-def make_stub(name, signature, constants):
+def make_stub(name, signature, constants, tensor_maps=None, cluster_dims=(1, 1, 1)):
     # name of files that are cached
-    so_cache_key = make_so_cache_key(version_key(), signature, constants)
+    so_cache_key = make_so_cache_key(version_key(), signature, constants, tensor_maps, cluster_dims)
     so_cache_manager = get_cache_manager(so_cache_key)
     so_name = f"{name}.so"
     # retrieve stub from cache if it exists
     cache_path = so_cache_manager.get_file(so_name)
     if cache_path is None:
         with tempfile.TemporaryDirectory() as tmpdir:
-            src = generate_launcher(constants, signature)
+            src = generate_launcher(constants, signature, tensor_maps, cluster_dims)
             src_path = os.path.join(tmpdir, "main.c")
             with open(src_path, "w") as f:
                 f.write(src)
@@ -42,6 +42,29 @@ def make_stub(name, signature, constants):
     else:
         return cache_path
 
+# codes of the scalar types in the signature descriptors of the prebuilt
+# launcher of cuda_utils (see `make_launcher` in runtime/backends/cuda.c)
+launcher_type_codes = {
+    "i1": "i",
+    "i8": "b",
+    "i16": "h",
+    "i32": "i",
+    "i64": "l",
+    "u32": "I",
+    "u64": "K",
+    "fp16": "f",
+    "bf16": "f",
+    "fp32": "f",
+    "f32": "f",
+    "fp64": "d",
+}
+
+
+def make_launcher_descriptor(signature, constants):
+    # one code per argument of the signature; constants are not passed
+    return ''.join('-' if i in constants else 'P' if ty[0] == '*' else launcher_type_codes[ty]
+                   for i, ty in signature.items())
+
 # ----- source code generation --------
 
 
@@ -64,8 +87,46 @@ def ty_to_cpp(ty):
     }[ty]
 
 
-def generate_launcher(constants, signature):
+# the tensor map data types that move elements of each size
+tensor_map_data_types = {
+    1: "CU_TENSOR_MAP_DATA_TYPE_UINT8",
+    2: "CU_TENSOR_MAP_DATA_TYPE_UINT16",
+    4: "CU_TENSOR_MAP_DATA_TYPE_UINT32",
+    8: "CU_TENSOR_MAP_DATA_TYPE_UINT64",
+}
+
+
+def generate_tensor_maps(constants, signature, tensor_maps):
+    # `tensor_maps` (see `get_tensor_maps`) refers to the arguments of the
+    # kernel, which are the non-constant arguments of the signature
+    kernel_args = [i for i in signature.keys() if i not in constants]
+
+    def value(arg, constant):
+        return f"(cuuint64_t)_arg{kernel_args[arg]}" if arg >= 0 else f"{constant}ull"
+
+    src = ""
+    for k, tensor_map in enumerate(tensor_maps):
+        elem_bytes = tensor_map["elem_bytes"]
+        dims = [value(arg, dim) for arg, dim in zip(tensor_map["dim_args"], tensor_map["dims"])]
+        strides = [f"{value(arg, stride)} * {elem_bytes}"
+                   for arg, stride in zip(tensor_map["stride_args"], tensor_map["strides"])]
+        box = [str(dim) for dim in tensor_map["box"]]
+        src += f"""
+  cuuint64_t tma_dims{k}[5] = {{{', '.join(dims)}}};
+  cuuint64_t tma_strides{k}[5] = {{{', '.join(strides) or '0'}}};
+  cuuint32_t tma_box{k}[5] = {{{', '.join(box)}}};
+  CUdeviceptr tma_desc{k} = getTensorMap((CUstream)_stream, {tensor_map_data_types[elem_bytes]}, {len(dims)}, ptr_info{kernel_args[tensor_map["base"]]}.dev_ptr, tma_dims{k}, tma_strides{k}, tma_box{k});
+  if (PyErr_Occurred()) return NULL;"""
+    return src
+
+
+def generate_launcher(constants, signature, tensor_maps=None, cluster_dims=(1, 1, 1)):
+    tensor_maps = tensor_maps or []
     arg_decls = ', '.join(f"{ty_to_cpp(ty)} arg{i}" for i, ty in signature.items())
+    arg_decls += ''.join(f", CUdeviceptr tma_desc{k}" for k in range(len(tensor_maps)))
+    # tensor maps are passed after the arguments of the signature
+    params = [f"&arg{i}" for i in signature.keys() if i not in constants]
+    params += [f"&tma_desc{k}" for k in range(len(tensor_maps))]
 
     def _extracted_type(ty):
         if ty[0] == '*':
@@ -97,8 +158,29 @@ def generate_launcher(constants, signature):
 
     format = "iiiiiKKOOO" + ''.join([format_of(_extracted_type(ty)) for ty in signature.values()])
 
+    # CTAs launched in thread block clusters of `cluster_dims`
+    cluster_launch = f"""CUlaunchAttribute attribute;
+    attribute.id = CU_LAUNCH_ATTRIBUTE_CLUSTER_DIMENSION;
+    attribute.value.clusterDim.x = {cluster_dims[0]};
+    attribute.value.clusterDim.y = {cluster_dims[1]};
+    attribute.value.clusterDim.z = {cluster_dims[2]};
+    CUlaunchConfig config = {{0}};
+    config.gridDimX = gridX;
+    config.gridDimY = gridY;
+    config.gridDimZ = gridZ;
+    config.blockDimX = 32*num_warps;
+    config.blockDimY = 1;
+    config.blockDimZ = 1;
+    config.sharedMemBytes = shared_memory;
+    config.hStream = stream;
+    config.attrs = &attribute;
+    config.numAttrs = 1;
+    CUDA_CHECK(cuLaunchKernelEx(&config, function, params, 0));"""
+
     # generate glue code
     if is_hip():
+        assert not tensor_maps, "tensor maps are only supported on CUDA"
+        assert tuple(cluster_dims) == (1, 1, 1), "thread block clusters are only supported on CUDA"
         src = f"""
     #define __HIP_PLATFORM_AMD__
     #include <hip/hip_runtime.h>
@@ -239,6 +321,168 @@ def generate_launcher(constants, signature):
     }}
     """
     else:
+        tensor_map_cache_src = """
+#if CUDA_VERSION < 12000
+#error "tensor maps require CUDA 12"
+#endif
+
+// Tensor maps are encoded on the host and copied to global memory, where
+// cp.async.bulk.tensor reads them. Each context has a pool of slots for them,
+// allocated once, which the maps are copied to asynchronously on the stream
+// of the launch that needs them first, from pinned copies. The maps are
+// cached by their contents, so steady-state launches neither allocate nor
+// synchronize, and can be captured in CUDA graphs once the maps they use are
+// cached.
+#define TENSOR_MAP_CACHE_SIZE 64
+#define TENSOR_MAP_MAX_CONTEXTS 16
+
+typedef struct _TensorMapEntry {
+  bool valid;
+  CUtensorMap map;
+  // stream the map was copied on, and event recorded after the copy, NULL
+  // once the copy is known to be complete
+  CUstream stream;
+  CUevent copied;
+  // used by a captured graph, which may replay at any time: never evicted
+  bool captured;
+} TensorMapEntry;
+
+typedef struct _TensorMapPool {
+  CUcontext ctx;
+  CUdeviceptr devMaps;
+  CUtensorMap *hostMaps;
+  TensorMapEntry entries[TENSOR_MAP_CACHE_SIZE];
+} TensorMapPool;
+
+static TensorMapPool tensorMapPools[TENSOR_MAP_MAX_CONTEXTS];
+static int numTensorMapPools = 0;
+
+static TensorMapPool *getTensorMapPool(CUcontext ctx, bool capturing) {
+  for (int i = 0; i < numTensorMapPools; ++i)
+    if (tensorMapPools[i].ctx == ctx)
+      return &tensorMapPools[i];
+  if (capturing) {
+    PyErr_SetString(PyExc_RuntimeError, "Tensor maps can't be allocated during stream capture: launch the kernel once before capturing it");
+    return NULL;
+  }
+  if (numTensorMapPools == TENSOR_MAP_MAX_CONTEXTS) {
+    PyErr_SetString(PyExc_RuntimeError, "Too many contexts with tensor maps");
+    return NULL;
+  }
+  TensorMapPool *pool = &tensorMapPools[numTensorMapPools];
+  memset(pool, 0, sizeof(*pool));
+  pool->ctx = ctx;
+  CUDA_CHECK(cuMemAlloc(&pool->devMaps, TENSOR_MAP_CACHE_SIZE * sizeof(CUtensorMap)));
+  if (PyErr_Occurred())
+    return NULL;
+  CUDA_CHECK(cuMemAllocHost((void **)&pool->hostMaps, TENSOR_MAP_CACHE_SIZE * sizeof(CUtensorMap)));
+  if (PyErr_Occurred()) {
+    cuMemFree(pool->devMaps);
+    return NULL;
+  }
+  ++numTensorMapPools;
+  return pool;
+}
+
+// Orders the launches on `stream` after the copy of the map of `entry`
+static void waitTensorMap(TensorMapEntry *entry, CUstream stream, bool capturing) {
+  if (!entry->copied || entry->stream == stream)
+    return;
+  CUresult status = cuEventQuery(entry->copied);
+  if (status == CUDA_ERROR_NOT_READY) {
+    // captured streams can't wait on events recorded outside of the capture
+    if (!capturing) {
+      CUDA_CHECK(cuStreamWaitEvent(stream, entry->copied, 0));
+      return;
+    }
+    CUDA_CHECK(cuEventSynchronize(entry->copied));
+  } else {
+    CUDA_CHECK(status);
+  }
+  CUDA_CHECK(cuEventDestroy(entry->copied));
+  entry->copied = NULL;
+}
+
+// Evicts the maps of `pool` that no captured graph uses
+static void evictTensorMaps(TensorMapPool *pool) {
+  // kernels in flight may still read the maps
+  CUDA_CHECK(cuCtxSynchronize());
+  if (PyErr_Occurred())
+    return;
+  for (int i = 0; i < TENSOR_MAP_CACHE_SIZE; ++i) {
+    TensorMapEntry *entry = &pool->entries[i];
+    if (entry->copied) {
+      CUDA_CHECK(cuEventDestroy(entry->copied));
+      entry->copied = NULL;
+    }
+    entry->valid &= entry->captured;
+  }
+}
+
+static int getFreeTensorMapSlot(TensorMapPool *pool) {
+  for (int i = 0; i < TENSOR_MAP_CACHE_SIZE; ++i)
+    if (!pool->entries[i].valid)
+      return i;
+  return -1;
+}
+
+static CUdeviceptr getTensorMap(CUstream stream, CUtensorMapDataType dataType, cuuint32_t rank, CUdeviceptr base, const cuuint64_t *dims, const cuuint64_t *strides, const cuuint32_t *box) {
+  cuuint32_t elementStrides[5] = {1, 1, 1, 1, 1};
+  CUtensorMap map;
+  memset(&map, 0, sizeof(map));
+  CUcontext ctx;
+  CUstreamCaptureStatus captureStatus;
+  CUDA_CHECK(cuCtxGetCurrent(&ctx));
+  CUDA_CHECK(cuStreamIsCapturing(stream, &captureStatus));
+  CUDA_CHECK(cuTensorMapEncodeTiled(&map, dataType, rank, (void *)base, dims, strides, box, elementStrides,
+                                    CU_TENSOR_MAP_INTERLEAVE_NONE, CU_TENSOR_MAP_SWIZZLE_NONE,
+                                    CU_TENSOR_MAP_L2_PROMOTION_L2_128B, CU_TENSOR_MAP_FLOAT_OOB_FILL_NONE));
+  if (PyErr_Occurred())
+    return 0;
+  bool capturing = captureStatus != CU_STREAM_CAPTURE_STATUS_NONE;
+  TensorMapPool *pool = getTensorMapPool(ctx, capturing);
+  if (!pool)
+    return 0;
+  for (int i = 0; i < TENSOR_MAP_CACHE_SIZE; ++i) {
+    TensorMapEntry *entry = &pool->entries[i];
+    if (entry->valid && memcmp(&entry->map, &map, sizeof(CUtensorMap)) == 0) {
+      waitTensorMap(entry, stream, capturing);
+      entry->captured |= capturing;
+      return PyErr_Occurred() ? 0 : pool->devMaps + i * sizeof(CUtensorMap);
+    }
+  }
+  // the copy of a new map would only take place when the graph is replayed
+  if (capturing) {
+    PyErr_SetString(PyExc_RuntimeError, "Tensor maps can't be created during stream capture: launch the kernel with the same tensors before capturing it");
+    return 0;
+  }
+  int slot = getFreeTensorMapSlot(pool);
+  if (slot < 0) {
+    evictTensorMaps(pool);
+    if (PyErr_Occurred())
+      return 0;
+    slot = getFreeTensorMapSlot(pool);
+  }
+  if (slot < 0) {
+    PyErr_SetString(PyExc_RuntimeError, "Too many tensor maps used by captured graphs");
+    return 0;
+  }
+  TensorMapEntry *entry = &pool->entries[slot];
+  memset(entry, 0, sizeof(*entry));
+  entry->map = map;
+  entry->stream = stream;
+  CUdeviceptr devMap = pool->devMaps + slot * sizeof(CUtensorMap);
+  // slots are only reused after a synchronization, when their copies are done
+  pool->hostMaps[slot] = map;
+  CUDA_CHECK(cuMemcpyHtoDAsync(devMap, &pool->hostMaps[slot], sizeof(CUtensorMap), stream));
+  CUDA_CHECK(cuEventCreate(&entry->copied, CU_EVENT_DISABLE_TIMING));
+  CUDA_CHECK(cuEventRecord(entry->copied, stream));
+  if (PyErr_Occurred())
+    return 0;
+  entry->valid = true;
+  return devMap;
+}
+"""
         src = f"""
 #include \"cuda.h\"
 #include <stdbool.h>
@@ -260,10 +504,29 @@ static inline void gpuAssert(CUresult code, const char *file, int line)
 
 #define CUDA_CHECK(ans) {{ gpuAssert((ans), __FILE__, __LINE__); }}
 
+// The launch tracer of cuda_utils, set by `set_tracer`
+typedef struct {{
+  volatile int enabled;
+  void *(*enter)(uint64_t function, int gridX, int gridY, int gridZ, uint64_t stream);
+  void (*exit)(void *record, uint64_t stream);
+}} TritonLaunchTracer;
+
+static TritonLaunchTracer *tracer = NULL;
+
+static PyObject* setTracer(PyObject* self, PyObject* args) {{
+  PyObject *capsule;
+  if (!PyArg_ParseTuple(args, "O", &capsule))
+    return NULL;
+  tracer = (TritonLaunchTracer *)PyCapsule_GetPointer(capsule, "triton.launch_tracer");
+  if (!tracer)
+    return NULL;
+  Py_RETURN_NONE;
+}}
+
 static void _launch(int gridX, int gridY, int gridZ, int num_warps, int shared_memory, CUstream stream, CUfunction function, {arg_decls}) {{
-  void *params[] = {{ {', '.join(f"&arg{i}" for i in signature.keys() if i not in constants)} }};
+  void *params[] = {{ {', '.join(params)} }};
   if(gridX*gridY*gridZ > 0){{
-    CUDA_CHECK(cuLaunchKernel(function, gridX, gridY, gridZ, 32*num_warps, 1, 1, shared_memory, stream, params, 0));
+    {cluster_launch if cluster_dims[0] * cluster_dims[1] * cluster_dims[2] > 1 else "CUDA_CHECK(cuLaunchKernel(function, gridX, gridY, gridZ, 32*num_warps, 1, 1, shared_memory, stream, params, 0));"}
   }}
 }}
 
@@ -312,7 +575,7 @@ static inline DevicePtrInfo getPointer(PyObject *obj, int idx) {{
   PyErr_SetString(PyExc_TypeError, "Pointer argument must be either uint64 or have data_ptr method");
   return ptr_info;
 }}
-
+{tensor_map_cache_src if tensor_maps else ""}
 static PyObject* launch(PyObject* self, PyObject* args) {{
   int gridX, gridY, gridZ;
   uint64_t _stream;
@@ -334,7 +597,11 @@ static PyObject* launch(PyObject* self, PyObject* args) {{
 
   // raise exception asap
   {"; ".join([f"DevicePtrInfo ptr_info{i} = getPointer(_arg{i}, {i}); if (!ptr_info{i}.valid) return NULL;" if ty[0] == "*" else "" for i, ty in signature.items()])};
-  _launch(gridX, gridY, gridZ, num_warps, shared_memory, (CUstream)_stream, (CUfunction)_function, {', '.join(f"ptr_info{i}.dev_ptr" if ty[0]=="*" else f"_arg{i}"for i, ty in signature.items())});
+  {generate_tensor_maps(constants, signature, tensor_maps)}
+  void *trace_record = tracer && tracer->enabled ? tracer->enter(_function, gridX, gridY, gridZ, _stream) : NULL;
+  _launch(gridX, gridY, gridZ, num_warps, shared_memory, (CUstream)_stream, (CUfunction)_function, {', '.join([f"ptr_info{i}.dev_ptr" if ty[0]=="*" else f"_arg{i}"for i, ty in signature.items()] + [f"tma_desc{k}" for k in range(len(tensor_maps))])});
+  if (trace_record)
+    tracer->exit(trace_record, _stream);
 
   if (launch_exit_hook != Py_None) {{
     PyObject_CallObject(launch_exit_hook, args);
@@ -350,6 +617,7 @@ static PyObject* launch(PyObject* self, PyObject* args) {{
 
 static PyMethodDef ModuleMethods[] = {{
   {{"launch", launch, METH_VARARGS, "Entry point for all kernels with this signature"}},
+  {{"set_tracer", setTracer, METH_VARARGS, "Record the launches with the launch tracer of cuda_utils"}},
   {{NULL, NULL, 0, NULL}} // sentinel
 }};
 
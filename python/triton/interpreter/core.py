@@ -5,5 +5,6 @@ import dataclasses
 
 @dataclasses.dataclass
 class ExecutionContext:
-    program_id: Tuple[int]
+    # ids of the batch of programs run together, one tensor per axis
+    program_id: Tuple
     program_size: Tuple[int]
@@ -1,4 +1,5 @@
 import itertools
+import os
 import random
 from typing import Tuple
 
@@ -8,8 +9,8 @@ from ..language import core as lcore
 from . import torch_wrapper
 from .core import ExecutionContext
 from .memory_map import MemoryMap
-from .tl_lang import (TritonLangProxy, WrappedTensor, _primitive_to_tensor,
-                      debugger_constexpr)
+from .tl_lang import (DivergentControlFlow, TritonLangProxy, WrappedTensor,
+                      _primitive_to_tensor, debugger_constexpr)
 
 torch = torch_wrapper.torch
 tl_method_backup = {}
@@ -54,10 +55,30 @@ def program_ids_from_grid(grid: Tuple[int, ...]) -> Tuple[int, ...]:
         yield index_combination
 
 
+def program_id_batches(grid: Tuple[int, ...], batch_size: int):
+    """
+    Splits the programs of `grid` into batches of at most `batch_size`, each
+    given as one tensor of program ids per axis
+    """
+    # program_ids_from_grid enumerates the ids of the last axis first
+    ids = torch.tensor(list(program_ids_from_grid(grid)), dtype=torch.int32, device="cuda").flip(1)
+    for start in range(0, ids.shape[0], batch_size):
+        batch = ids[start:start + batch_size]
+        yield tuple(batch[:, axis] for axis in range(len(grid)))
+
+
 class DebuggerFunction:
+    """
+    Runs the programs of the grid in batches of `TRITON_INTERPRETER_BATCH_SIZE`
+    (256 by default), evaluating each operation for the whole batch at once.
+    A batch whose programs take different paths through the kernel is rolled
+    back and replayed one program at a time.
+    """
+
     def __init__(self, func, grid=(1,)):
         self.func = func
         self.grid = grid
+        self.batch_size = int(os.environ.get("TRITON_INTERPRETER_BATCH_SIZE", "256"))
 
     def _is_constexpr(self, name):
         return name in self.func.__annotations__ and self.func.__annotations__[name] is lcore.constexpr
@@ -98,11 +119,24 @@ class DebuggerFunction:
         new_kwargs = {k: convert_arg((k, v)) for (k, v) in kwargs.items() if k not in ["num_warps", "num_stages"]}
 
         grid = self._get_grid(**kwargs)
-        for program_id in program_ids_from_grid(grid):
-            proxy = TritonLangProxy(memory, ExecutionContext(program_id, grid))
+
+        def run(program_ids):
+            proxy = TritonLangProxy(memory, ExecutionContext(program_ids, grid))
             attach_triton(tl, proxy)
-            self.func(*new_args, **new_kwargs)
-            detach_triton(tl)
+            try:
+                self.func(*new_args, **new_kwargs)
+            finally:
+                detach_triton(tl)
+
+        for program_ids in program_id_batches(grid, self.batch_size):
+            memory.begin()
+            try:
+                run(program_ids)
+            except DivergentControlFlow:
+                memory.rollback()
+                for i in range(program_ids[0].shape[0]):
+                    run(tuple(ids[i:i + 1] for ids in program_ids))
+            memory.commit()
 
 
 class GridSelector:
@@ -13,24 +13,30 @@ class RegisteredStorage:
     dtype: torch.dtype
     size: int
     ptr: int
+    nbytes: int
+    # flat typed view of the storage: accesses go to the tensor's memory
+    # directly, without any copy
+    view: torch.Tensor
 
     @property
     def end_ptr(self) -> int:
         return self.ptr + self.size
 
-    @property
-    def access_tensor(self) -> torch.Tensor:
-        return torch.tensor(self.storage, dtype=self.dtype, device=self.storage.device)
-
     def ensure_immutable(self):
-        assert self.storage.data_ptr() == self.ptr and self.storage.size() == self.size
+        assert self.storage.data_ptr() == self.ptr and self.storage.size() == self.nbytes
 
 
 class MemoryMap:
+    """
+    Pointers are the address of the storage of a tensor plus an offset in
+    elements. Stores can be journaled, so that the stores of a batch of
+    programs can be rolled back when the batch has to be replayed.
+    """
     storages: [RegisteredStorage]
 
     def __init__(self):
         self.storages = []
+        self.journal = None
 
     def _get_registered_storage(self, pointer: torch.Tensor):
         max_pointer = torch.max(pointer).item()
@@ -49,8 +55,21 @@ class MemoryMap:
 
     def add_tensor(self, t: torch.Tensor):
         storage = t.untyped_storage()
-        self.storages.append(RegisteredStorage(storage, t.dtype, storage.size(), storage.data_ptr()))
-        return t.data_ptr()
+        size = storage.size() // t.element_size()
+        view = torch.empty(0, dtype=t.dtype, device=t.device).set_(storage, 0, (size,), (1,))
+        self.storages.append(RegisteredStorage(storage, t.dtype, size, storage.data_ptr(), storage.size(), view))
+        return storage.data_ptr() + t.storage_offset()
+
+    def begin(self):
+        self.journal = []
+
+    def rollback(self):
+        for view, index, values in reversed(self.journal):
+            view[index] = values
+        self.journal = []
+
+    def commit(self):
+        self.journal = None
 
     def load(
         self,
@@ -59,44 +78,48 @@ class MemoryMap:
         other=0.0,
     ):
         assert pointer.is_cuda
-        assert 0 < pointer.dim() < 3
         assert pointer.dtype == torch.int64
 
         if mask is None:
             mask = torch.ones_like(pointer).bool()
         assert mask.is_cuda
-        assert 0 < mask.dim() < 3
         assert mask.dtype == torch.bool
-        mask = mask.expand(pointer.size())
+        pointer, mask = torch.broadcast_tensors(pointer, mask)
 
-        if torch.all(~mask):
+        if not torch.any(mask):
             # Todo: The type is wrong here, we can't determine the correct type
-            return torch.full_like(pointer, fill_value=other, dtype=torch.float16, device="cuda")
+            block = torch.zeros_like(pointer, dtype=torch.float16, device="cuda")
+            if other is not None:
+                block[...] = other
+            return block
 
         registered_storage = self._get_registered_storage(pointer[mask])
-        access_tensor = registered_storage.access_tensor
+        view = registered_storage.view
 
         index_tensor = pointer - registered_storage.ptr
 
-        block = torch.full_like(pointer, fill_value=other, dtype=access_tensor.dtype, device="cuda")
-        block[mask] = access_tensor[index_tensor[mask]]
+        block = torch.zeros_like(pointer, dtype=view.dtype, device="cuda")
+        if other is not None:
+            block[...] = other
+        block[mask] = view[index_tensor[mask]]
         return block
 
     def store(self, pointer: torch.Tensor, value: torch.Tensor, mask=None):
-        assert 0 < pointer.dim() < 3
         assert pointer.dtype == torch.int64
 
         if mask is None:
             mask = torch.ones_like(pointer).bool()
-        assert 0 < mask.dim() < 3
         assert mask.dtype == torch.bool
-        mask = mask.expand(pointer.size())
+        value = torch.as_tensor(value, device=pointer.device)
+        pointer, value, mask = torch.broadcast_tensors(pointer, value, mask)
 
-        if torch.all(~mask):
+        if not torch.any(mask):
             return
 
         registered_storage = self._get_registered_storage(pointer[mask])
-        access_tensor = registered_storage.access_tensor
+        view = registered_storage.view
 
-        index_tensor = pointer - registered_storage.ptr
-        access_tensor[index_tensor[mask]] = value[mask].to(access_tensor.dtype)
+        index = (pointer - registered_storage.ptr)[mask]
+        if self.journal is not None:
+            self.journal.append((view, index, view[index].clone()))
+        view[index] = value[mask].to(view.dtype)
@@ -7,6 +7,53 @@ from .memory_map import MemoryMap
 
 torch = torch_wrapper.torch
 
+# Every value is evaluated for a batch of programs at once: tensors have a
+# leading batch dimension, of the size of the batch or 1 for values that are
+# the same for all the programs, followed by the dimensions of the tile
+
+
+class DivergentControlFlow(Exception):
+    """
+    Raised when the programs of a batch take different paths through the
+    kernel, which then has to be run for each of them separately
+    """
+    pass
+
+
+def _uniform(x):
+    """
+    The value of `x` common to all the programs of the batch
+    """
+    if x.shape[0] > 1 and not torch.all(x == x[:1]):
+        raise DivergentControlFlow()
+    return x[0]
+
+
+def _align(*args):
+    """
+    Brings the tensors among `args` to the same rank by inserting unit
+    dimensions after the batch dimension, for them to broadcast as tiles
+    """
+    ranks = [arg.dim() for arg in args if torch.is_tensor(arg)]
+    if not ranks:
+        return args
+    rank = max(ranks)
+    return tuple(arg.reshape(arg.shape[:1] + (1,) * (rank - arg.dim()) + arg.shape[1:])
+                 if torch.is_tensor(arg) and arg.dim() < rank else arg for arg in args)
+
+
+def _to_torch_dtype(dtype):
+    if not isinstance(dtype, lcore.dtype):
+        return dtype
+    dtypes = {
+        "int1": torch.bool, "int8": torch.int8, "int16": torch.int16, "int32": torch.int32, "int64": torch.int64,
+        "uint8": torch.uint8, "fp16": torch.float16, "bf16": torch.bfloat16, "fp32": torch.float32,
+        "fp64": torch.float64,
+    }
+    if dtype.name not in dtypes:
+        raise TypeError(f"Unsupported dtype {dtype}")
+    return dtypes[dtype.name]
+
 
 def _primitive_to_tensor(x):
     """
@@ -56,6 +103,7 @@ def _tensor_operation(func):
     """
     A decorator function to unwrap WrappedTensors and debugger_constexpr before calling the function.
     Can be combined with _infer_tensor decorator to harmonize args (everything to torch tensor).
+    The tensors, including the one of a WrappedTensor `self`, are brought to the same rank.
     """
     def wrapper(*args, **kwargs):
         for arg in args:
@@ -70,8 +118,13 @@ def _tensor_operation(func):
 
         new_args = tuple(map(unwrap_tensor, args))
         new_kwargs = {k: unwrap_tensor(v) for k, v in kwargs.items()}
+        names = list(new_kwargs.keys())
+        aligned = _align(*new_args, *new_kwargs.values())
+        new_args = aligned[:len(new_args)]
+        new_kwargs = dict(zip(names, aligned[len(new_args):]))
 
-        result = func(args[0], *new_args[1:], **new_kwargs)
+        self = WrappedTensor(new_args[0]) if isinstance(args[0], WrappedTensor) else args[0]
+        result = func(self, *new_args[1:], **new_kwargs)
         return WrappedTensor(result) if torch.is_tensor(result) else result
 
     return wrapper
@@ -146,13 +199,14 @@ class WrappedTensor:
         self.tensor = tensor
 
     def __index__(self) -> int:
-        return self.tensor.item()
+        return _uniform(self.tensor).item()
 
     def __str__(self) -> str:
         return "wrapped_" + str(self.tensor)
 
     def __bool__(self) -> bool:
-        return torch.all(self.tensor == True).item()  # noqa: E712
+        value = torch.all(self.tensor.reshape(self.tensor.shape[0], -1) == True, dim=1)  # noqa: E712
+        return _uniform(value).item()
 
     @property
     def dtype(self):
@@ -296,16 +350,20 @@ class WrappedTensor:
     @_infer_tensor
     @_tensor_operation
     def __eq__(self, other):
-        return torch.equal(self.tensor, other)
+        return self.tensor == other
 
     @_infer_tensor
     @_tensor_operation
     def __ne__(self, other):
-        return not torch.equal(self.tensor, other)
+        return self.tensor != other
 
     @_tensor_operation
     def __getitem__(self, slices):
-        return self.tensor.__getitem__(slices)
+        if not isinstance(slices, tuple):
+            slices = (slices, )
+        slices = tuple(_constexpr_to_value(sl) for sl in slices)
+        # the batch dimension is kept
+        return self.tensor.__getitem__((slice(None), ) + slices)
         # if isinstance(slices, slice):
         #     slices = [slices]
         # src_shape = self.shape
@@ -322,7 +380,7 @@ class WrappedTensor:
 
     @_tensor_operation
     def to(self, dtype, bitcast=False):
-        return self.tensor.to(dtype)
+        return self.tensor.to(_to_torch_dtype(dtype))
         # if isinstance(bitcast, constexpr):
         #     bitcast = bitcast.value
         # if bitcast:
@@ -330,6 +388,16 @@ class WrappedTensor:
         # return semantic.cast(self, dtype, )
 
 
+def _reduce_dim(input, axis):
+    """
+    The dimension of `input` to reduce along `axis` of its tiles, after the
+    batch dimension, with the tiles flattened when reducing them whole
+    """
+    if axis is None:
+        return input.reshape(input.shape[0], -1), 1
+    return input, axis + 1 if axis >= 0 else axis
+
+
 def _constexpr_to_value(v):
     if isinstance(v, debugger_constexpr):
         return v.value
@@ -370,7 +438,7 @@ class TritonLangProxy:
     @_tensor_operation
     def program_id(self, axis):
         assert axis < len(self._context.program_id)
-        return torch.tensor([self._context.program_id[axis]], dtype=torch.int32, device="cuda")
+        return self._context.program_id[axis]
 
     @_tensor_operation
     def num_programs(self, axis):
@@ -379,7 +447,7 @@ class TritonLangProxy:
 
     @_tensor_operation
     def arange(self, start, end):
-        return torch.arange(start=start, end=end, dtype=torch.int32, device="cuda")
+        return torch.arange(start=start, end=end, dtype=torch.int32, device="cuda")[None]
 
     @_tensor_operation
     def zeros(self, shape, dtype):
@@ -388,23 +456,8 @@ class TritonLangProxy:
                 raise TypeError(f"Shape element {i} must have type `constexpr`")
             if not isinstance(d.value, int):
                 raise TypeError(f"Shape element {i} must have type `constexpr[int]`, got `constexpr[{type(d.value)}]")
-        shape = [x.value for x in shape]
-        if isinstance(dtype, lcore.dtype):
-            if dtype.is_fp32():
-                dtype = torch.float32
-            elif dtype.is_fp16():
-                dtype = torch.float16
-            elif dtype.is_bf16():
-                dtype = torch.bfloat16
-            elif dtype.is_int32():
-                dtype = torch.int32
-            elif dtype.is_int16():
-                dtype = torch.int16
-            elif dtype.is_int8():
-                dtype = torch.int8
-            else:
-                raise TypeError(f"Unsupported dtype {dtype}")
-        return torch.zeros(size=shape, dtype=dtype, device="cuda")
+        shape = [1] + [x.value for x in shape]
+        return torch.zeros(size=shape, dtype=_to_torch_dtype(dtype), device="cuda")
 
     @_tensor_operation
     def dequantize(self, input, scale, shift, nbit, dst_ty=None):
@@ -432,72 +485,63 @@ class TritonLangProxy:
     def dot(self, input, other, trans_a=False, trans_b=False, allow_tf32=True):
         assert input.dtype == other.dtype
         if trans_a:
-            input = input.T
+            input = input.transpose(-1, -2)
         if trans_b:
-            other = other.T
+            other = other.transpose(-1, -2)
         return torch.matmul(input=input, other=other)
 
+    def _atomic(self, pointer, mask, other, combine, *operands):
+        """
+        Applies `combine(stored, *operands)` atomically for each program of the
+        batch in turn, as the programs of a grid would, and returns the values
+        stored before each of them
+        """
+        operands = [torch.as_tensor(operand, device="cuda") for operand in operands]
+        if mask is None:
+            mask = torch.ones_like(pointer).bool()
+        pointer, mask, *operands = torch.broadcast_tensors(pointer, mask, *operands)
+        results = []
+        for i in range(pointer.shape[0]):
+            program = slice(i, i + 1)
+            # arbitrary other value as it will masked during storing
+            stored = self._memory_map.load(pointer[program], mask[program], other)
+            result = combine(stored, *[operand[program] for operand in operands])
+            self._memory_map.store(pointer[program], result, mask[program])
+            results.append(stored)
+        return torch.cat(results)
+
     @_tensor_operation
     def atomic_cas(self, pointer, cmp, val):
-        stored = self._memory_map.load(pointer, None, 0.0)
-        if not isinstance(cmp, torch.Tensor):
-            cmp = torch.tensor([cmp], dtype=stored.dtype, device="cuda")
-        if not isinstance(val, torch.Tensor):
-            val = torch.tensor([val], dtype=stored.dtype, device="cuda")
-        if stored == cmp:
-            self._memory_map.store(pointer, val, None)
-        return stored
+        return self._atomic(pointer, None, 0.0, lambda stored, cmp, val: torch.where(stored == cmp, val, stored),
+                            cmp, val)
 
     @_tensor_operation
     def atomic_xchg(self, pointer, val, mask=None):
-        if isinstance(val, int):
-            val = torch.tensor([val], dtype=torch.int32, device="cuda")
-        stored = self._memory_map.load(pointer, mask, 0.0)
-        self._memory_map.store(pointer, val, mask)
-        return stored
+        return self._atomic(pointer, mask, 0.0, lambda stored, val: val, val)
 
     @_tensor_operation
     def atomic_add(self, pointer, val, mask=None):
-        # arbitrary other value as it will masked during storing
-        stored = self._memory_map.load(pointer, mask, 0.0)
-        result = stored + val
-        self._memory_map.store(pointer, result, mask)
-        return stored
+        return self._atomic(pointer, mask, 0.0, torch.add, val)
 
     @_tensor_operation
     def atomic_max(self, pointer, val, mask=None):
-        stored = self._memory_map.load(pointer, mask, 0.0)
-        result = torch.maximum(stored, val)
-        self._memory_map.store(pointer, result, mask)
-        return stored
+        return self._atomic(pointer, mask, 0.0, torch.maximum, val)
 
     @_tensor_operation
     def atomic_min(self, pointer, val, mask=None):
-        stored = self._memory_map.load(pointer, mask, 0.0)
-        result = torch.minimum(stored, val)
-        self._memory_map.store(pointer, result, mask)
-        return stored
+        return self._atomic(pointer, mask, 0.0, torch.minimum, val)
 
     @_tensor_operation
     def atomic_and(self, pointer, val, mask=None):
-        stored = self._memory_map.load(pointer, mask, 0)
-        result = torch.bitwise_and(stored, val)
-        self._memory_map.store(pointer, result, mask)
-        return stored
+        return self._atomic(pointer, mask, 0, torch.bitwise_and, val)
 
     @_tensor_operation
     def atomic_or(self, pointer, val, mask=None):
-        stored = self._memory_map.load(pointer, mask, 0)
-        result = torch.bitwise_or(stored, val)
-        self._memory_map.store(pointer, result, mask)
-        return stored
+        return self._atomic(pointer, mask, 0, torch.bitwise_or, val)
 
     @_tensor_operation
     def atomic_xor(self, pointer, val, mask=None):
-        stored = self._memory_map.load(pointer, mask, 0)
-        result = torch.bitwise_xor(stored, val)
-        self._memory_map.store(pointer, result, mask)
-        return stored
+        return self._atomic(pointer, mask, 0, torch.bitwise_xor, val)
 
     @_tensor_operation
     def where(self, condition, x, y):
@@ -576,6 +620,10 @@ class TritonLangProxy:
 
     @_tensor_operation
     def maximum(self, x, y):
+        if isinstance(x, int):
+            x = torch.tensor(x, device="cuda")
+        if isinstance(y, int):
+            y = torch.tensor(y, device="cuda")
         return torch.maximum(x, y)
 
     @_tensor_operation
@@ -600,9 +648,8 @@ class TritonLangProxy:
 
     @_tensor_operation
     def max(self, input, axis=None):
-        if axis is None:
-            return torch.max(input)
-        return torch.max(input, dim=axis).values
+        input, dim = _reduce_dim(input, axis)
+        return torch.max(input, dim=dim).values
 
     @_tensor_operation
     def argmax(self, input, axis):
@@ -610,9 +657,8 @@ class TritonLangProxy:
 
     @_tensor_operation
     def min(self, input, axis=None):
-        if axis is None:
-            return torch.min(input)
-        return torch.min(input, dim=axis).values
+        input, dim = _reduce_dim(input, axis)
+        return torch.min(input, dim=dim).values
 
     @_tensor_operation
     def argmin(self, input, axis):
@@ -620,22 +666,19 @@ class TritonLangProxy:
 
     @_tensor_operation
     def sum(self, input, axis=None):
-        if axis is None:
-            return torch.sum(input)
-        return torch.sum(input, dim=axis)
+        input, dim = _reduce_dim(input, axis)
+        return torch.sum(input, dim=dim)
 
     @_tensor_operation
     def xor_sum(self, input, axis):
         raise NotImplementedError()
 
     @_tensor_operation
-    def cumsum(self, input, axis=None):
-        if axis is None:
-            return torch.cumsum(input)
-        return torch.cumsum(input, dim=axis)
+    def cumsum(self, input, axis=0):
+        input, dim = _reduce_dim(input, axis)
+        return torch.cumsum(input, dim=dim)
 
     @_tensor_operation
-    def cumprod(self, input, axis=None):
-        if axis is None:
-            return torch.cumprod(input)
-        return torch.cumprod(input, dim=axis)
+    def cumprod(self, input, axis=0):
+        input, dim = _reduce_dim(input, axis)
+        return torch.cumprod(input, dim=dim)
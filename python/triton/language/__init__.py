@@ -33,6 +33,8 @@ from .core import (
     broadcast,
     broadcast_to,
     cat,
+    cluster_barrier,
+    cluster_cta_rank,
     constexpr,
     cos,
     cumprod,
@@ -68,13 +70,17 @@ from .core import (
     min,
     minimum,
     multiple_of,
+    num_cluster_ctas,
     num_programs,
     pi32_t,
     pointer_type,
+    profile_region_begin,
+    profile_region_end,
     program_id,
     reduce,
     reshape,
     sin,
+    sparse_dot,
     sqrt,
     static_assert,
     static_print,
@@ -95,15 +101,20 @@ from .core import (
     xor_sum,
 )
 from .random import (
+    dropout_mask_bits,
+    dropout_mask_from_bits,
     pair_uniform_to_normal,
     philox,
     philox_impl,
     rand,
     rand4x,
+    rand4x_contiguous,
     randint,
     randint4x,
+    randint4x_contiguous,
     randn,
     randn4x,
+    randn4x_contiguous,
     uint32_to_uniform_float,
 )
 
@@ -131,6 +142,8 @@ __all__ = [
     "builtin",
     "cat",
     "cdiv",
+    "cluster_barrier",
+    "cluster_cta_rank",
     "constexpr",
     "cos",
     "cumprod",
@@ -139,6 +152,8 @@ __all__ = [
     "device_assert",
     "device_print",
     "dot",
+    "dropout_mask_bits",
+    "dropout_mask_from_bits",
     "dtype",
     "exp",
     "expand_dims",
@@ -169,25 +184,32 @@ __all__ = [
     "min",
     "minimum",
     "multiple_of",
+    "num_cluster_ctas",
     "num_programs",
     "pair_uniform_to_normal",
     "philox",
     "philox_impl",
     "pi32_t",
     "pointer_type",
+    "profile_region_begin",
+    "profile_region_end",
     "program_id",
     "rand",
     "rand4x",
+    "rand4x_contiguous",
     "randint",
     "randint4x",
+    "randint4x_contiguous",
     "randn",
     "randn4x",
+    "randn4x_contiguous",
     "ravel",
     "reduce",
     "reshape",
     "sigmoid",
     "sin",
     "softmax",
+    "sparse_dot",
     "sqrt",
     "static_range",
     "static_assert",
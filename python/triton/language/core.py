@@ -744,12 +744,13 @@ class tensor:
         assert False, "Transposition must be created by the AST Visitor"
 
     @builtin
-    def to(self, dtype, bitcast=False, _builder=None):
+    def to(self, dtype, bitcast=False, saturate=False, _builder=None):
         if isinstance(bitcast, constexpr):
             bitcast = bitcast.value
+        saturate = _constexpr_to_value(saturate)
         if bitcast:
             return semantic.bitcast(self, dtype, _builder)
-        return semantic.cast(self, dtype, _builder)
+        return semantic.cast(self, dtype, _builder, saturate)
 
 
 # -----------------------
@@ -792,6 +793,26 @@ def num_programs(axis, _builder=None):
     return semantic.num_programs(axis, _builder)
 
 
+@builtin
+def cluster_cta_rank(_builder=None):
+    """
+    Returns the rank of the current program in its thread block cluster,
+    between 0 and :code:`num_cluster_ctas() - 1`. It is 0 unless the kernel is
+    compiled with :code:`num_ctas` greater than 1 (see :code:`triton.jit`).
+    Thread block clusters need sm90 or later.
+    """
+    return semantic.cluster_cta_rank(_builder)
+
+
+@builtin
+def num_cluster_ctas(_builder=None):
+    """
+    Returns the number of programs of the thread block cluster of the current
+    program (sm90 only).
+    """
+    return semantic.num_cluster_ctas(_builder)
+
+
 # -----------------------
 # Block Initialization
 # -----------------------
@@ -962,16 +983,43 @@ def dot(input, other, allow_tf32=True, out_dtype=float32, _builder=None):
 
     The two blocks must be two-dimensional and have compatible inner dimensions.
 
+    fp8 blocks are multiplied natively into :code:`float32` on compute capability 8.9 and
+    later, where :code:`float8e4` and :code:`float8e5` can be mixed, and as :code:`float16`
+    otherwise.
+
     :param input: The first tensor to be multiplied.
-    :type input: 2D tensor of scalar-type in {:code:`float16`, :code:`bfloat16`, :code:`float32`}
+    :type input: 2D tensor of scalar-type in {:code:`float8e4`, :code:`float8e5`, :code:`float16`, :code:`bfloat16`, :code:`float32`}
     :param other: The second tensor to be multiplied.
-    :type other: 2D tensor of scalar-type in {:code:`float16`, :code:`bfloat16`, :code:`float32`}
+    :type other: 2D tensor of scalar-type in {:code:`float8e4`, :code:`float8e5`, :code:`float16`, :code:`bfloat16`, :code:`float32`}
     """
     allow_tf32 = _constexpr_to_value(allow_tf32)
     out_dtype = _constexpr_to_value(out_dtype)
     return semantic.dot(input, other, allow_tf32, out_dtype, _builder)
 
 
+@builtin
+def sparse_dot(input, other, meta, _builder=None):
+    """
+    Returns the matrix product of a 2:4 sparse block and a dense block, on the
+    sparse tensor cores of compute capability 8.0 and later.
+
+    The sparse M x K block has at most two nonzeros in every four consecutive
+    elements along K. :code:`input` holds them as an M x K/2 block, and
+    :code:`meta` an M x K/16 block of int16 whose bits [4g, 4g+4) are the
+    2-bit positions, in increasing order, of the elements
+    :code:`input[m, 8j+2g]` and :code:`input[m, 8j+2g+1]` within the elements
+    [16j+4g, 16j+4g+4) of row m.
+
+    :param input: The nonzeros of the first tensor to be multiplied.
+    :type input: 2D tensor of scalar-type in {:code:`float16`, :code:`bfloat16`}
+    :param other: The second tensor to be multiplied.
+    :type other: 2D tensor of the scalar-type of :code:`input`
+    :param meta: The positions of the nonzeros of :code:`input`.
+    :type meta: 2D tensor of scalar-type :code:`int16`
+    """
+    return semantic.sparse_dot(input, other, meta, _builder)
+
+
 # -----------------------
 # Non-Atomic Memory Operations
 # -----------------------
@@ -979,7 +1027,7 @@ def dot(input, other, allow_tf32=True, out_dtype=float32, _builder=None):
 
 @builtin
 def load(pointer, mask=None, other=None, boundary_check=tuple(), padding_option="", cache_modifier="",
-         eviction_policy="", volatile=False, _builder=None):
+         eviction_policy="", volatile=False, l2_eviction_policy="", _builder=None):
     """
     Return a tensor of data whose values are loaded from memory at location defined by `pointer`:
         (1) `pointer` could be a single element pointer, then a scalar will be loaded
@@ -1010,6 +1058,8 @@ def load(pointer, mask=None, other=None, boundary_check=tuple(), padding_option=
     :type eviction_policy: str, optional
     :param volatile: changes volatile option in NVIDIA PTX
     :type volatile: bool, optional
+    :param l2_eviction_policy: eviction priority of the loaded lines in the L2 cache (sm_80+), one of {"", "evict_first", "evict_last"}
+    :type l2_eviction_policy: str, optional
     """
     # `mask` and `other` can be constexpr
     if _constexpr_to_value(mask) is not None:
@@ -1020,12 +1070,14 @@ def load(pointer, mask=None, other=None, boundary_check=tuple(), padding_option=
     cache_modifier = _constexpr_to_value(cache_modifier)
     eviction_policy = _constexpr_to_value(eviction_policy)
     volatile = _constexpr_to_value(volatile)
+    l2_eviction_policy = _constexpr_to_value(l2_eviction_policy)
     return semantic.load(pointer, mask, other, boundary_check, padding_option, cache_modifier, eviction_policy,
-                         volatile, _builder)
+                         volatile, l2_eviction_policy, _builder)
 
 
 @builtin
-def store(pointer, value, mask=None, boundary_check=(), cache_modifier="", eviction_policy="", _builder=None):
+def store(pointer, value, mask=None, boundary_check=(), cache_modifier="", eviction_policy="",
+          l2_eviction_policy="", quantize=None, scale_ptr=None, amax_ptr=None, _builder=None):
     """
     Store a tensor of data into memory locations defined by `pointer`:
         (1) `pointer` could be a single element pointer, then a scalar will be stored
@@ -1051,6 +1103,16 @@ def store(pointer, value, mask=None, boundary_check=(), cache_modifier="", evict
     :type cache_modifier: str, optional
     :param eviction_policy: changes eviction policy in NVIDIA PTX
     :type eviction_policy: str, optional
+    :param l2_eviction_policy: eviction priority of the stored lines in the L2 cache (sm_80+), one of {"", "evict_first", "evict_last"}
+    :type l2_eviction_policy: str, optional
+    :param quantize: fp8 type `pointer` points to: `value` is multiplied by the scale at `scale_ptr`, if given, and
+        converted with saturation to the largest finite values
+    :type quantize: dtype, optional
+    :param scale_ptr: pointer to the scale of a quantized store
+    :type scale_ptr: scalar pointer, optional
+    :param amax_ptr: pointer to a float32 into which a quantized store folds the absolute max of the stored elements
+        of `value` (before scaling) with an atomic max. All the elements of a block pointer are counted.
+    :type amax_ptr: scalar pointer to float32, optional
     """
     # `value` can be constexpr
     value = _to_tensor(value, _builder)
@@ -1058,7 +1120,17 @@ def store(pointer, value, mask=None, boundary_check=(), cache_modifier="", evict
         mask = _to_tensor(mask, _builder)
     cache_modifier = _constexpr_to_value(cache_modifier)
     eviction_policy = _constexpr_to_value(eviction_policy)
-    return semantic.store(pointer, value, mask, boundary_check, cache_modifier, eviction_policy, _builder)
+    l2_eviction_policy = _constexpr_to_value(l2_eviction_policy)
+    quantize = _constexpr_to_value(quantize)
+    if quantize is not None:
+        scale_ptr = None if _constexpr_to_value(scale_ptr) is None else _to_tensor(scale_ptr, _builder)
+        amax_ptr = None if _constexpr_to_value(amax_ptr) is None else _to_tensor(amax_ptr, _builder)
+        return semantic.quantized_store(pointer, value, mask, boundary_check, cache_modifier, eviction_policy,
+                                        l2_eviction_policy, quantize, scale_ptr, amax_ptr, _builder)
+    if _constexpr_to_value(scale_ptr) is not None or _constexpr_to_value(amax_ptr) is not None:
+        raise ValueError("`scale_ptr` and `amax_ptr` are only used by quantized stores")
+    return semantic.store(pointer, value, mask, boundary_check, cache_modifier, eviction_policy, l2_eviction_policy,
+                          _builder)
 
 
 @builtin
@@ -1091,7 +1163,7 @@ def advance(base: tensor, offsets, _builder=None):
 # -----------------------
 
 
-def _add_atomic_docstr(name: str) -> Callable[[T], T]:
+def _add_atomic_docstr(name: str, extra_params: str = "") -> Callable[[T], T]:
 
     def _decorator(func: T) -> T:
         docstr = """
@@ -1105,8 +1177,13 @@ def _add_atomic_docstr(name: str) -> Callable[[T], T]:
     :type cmp: Block of dtype=`pointer.dtype.element_ty`
     :param val: The values to copy in case the expected value matches the contained value.
     :type val: Block of dtype=`pointer.dtype.element_ty`
+    :param sem: Memory semantics of the operation: "acq_rel" (default), "acquire", "release" or "relaxed".
+    :type sem: str, optional
+    :param scope: Threads the operation is ordered with: "gpu" (default), "cta" for data only
+        shared within a program, or "sys" for memory visible to the host and peer devices.
+    :type scope: str, optional
     """
-        func.__doc__ = docstr.format(name=name)
+        func.__doc__ = docstr.format(name=name) + extra_params
         return func
 
     return _decorator
@@ -1114,67 +1191,80 @@ def _add_atomic_docstr(name: str) -> Callable[[T], T]:
 
 @builtin
 @_add_atomic_docstr("compare-and-swap")
-def atomic_cas(pointer, cmp, val, sem=None, _builder=None):
+def atomic_cas(pointer, cmp, val, sem=None, scope=None, _builder=None):
     cmp = _to_tensor(cmp, _builder)
     val = _to_tensor(val, _builder)
     sem = _constexpr_to_value(sem)
-    return semantic.atomic_cas(pointer, cmp, val, sem, _builder)
+    scope = _constexpr_to_value(scope)
+    return semantic.atomic_cas(pointer, cmp, val, sem, scope, _builder)
 
 
 @builtin
 @_add_atomic_docstr("exchange")
-def atomic_xchg(pointer, val, mask=None, sem=None, _builder=None):
+def atomic_xchg(pointer, val, mask=None, sem=None, scope=None, _builder=None):
     val = _to_tensor(val, _builder)
     sem = _constexpr_to_value(sem)
-    return semantic.atomic_xchg(pointer, val, mask, sem, _builder)
+    scope = _constexpr_to_value(scope)
+    return semantic.atomic_xchg(pointer, val, mask, sem, scope, _builder)
 
 
 @builtin
-@_add_atomic_docstr("add")
-def atomic_add(pointer, val, mask=None, sem=None, _builder=None):
+@_add_atomic_docstr("add", """:param aggregate: If True, the values of the lanes of a warp adding to the same
+        address are summed first, and a single atomic is issued per address. This pays off
+        for scatter-adds with many collisions, and only applies when the result is unused.
+    :type aggregate: bool, optional
+    """)
+def atomic_add(pointer, val, mask=None, sem=None, scope=None, aggregate=False, _builder=None):
     val = _to_tensor(val, _builder)
     sem = _constexpr_to_value(sem)
-    return semantic.atomic_add(pointer, val, mask, sem, _builder)
+    scope = _constexpr_to_value(scope)
+    aggregate = _constexpr_to_value(aggregate)
+    return semantic.atomic_add(pointer, val, mask, sem, aggregate, scope, _builder)
 
 
 @builtin
 @_add_atomic_docstr("max")
-def atomic_max(pointer, val, mask=None, sem=None, _builder=None):
+def atomic_max(pointer, val, mask=None, sem=None, scope=None, _builder=None):
     val = _to_tensor(val, _builder)
     sem = _constexpr_to_value(sem)
-    return semantic.atomic_max(pointer, val, mask, sem, _builder)
+    scope = _constexpr_to_value(scope)
+    return semantic.atomic_max(pointer, val, mask, sem, scope, _builder)
 
 
 @builtin
 @_add_atomic_docstr("min")
-def atomic_min(pointer, val, mask=None, sem=None, _builder=None):
+def atomic_min(pointer, val, mask=None, sem=None, scope=None, _builder=None):
     val = _to_tensor(val, _builder)
     sem = _constexpr_to_value(sem)
-    return semantic.atomic_min(pointer, val, mask, sem, _builder)
+    scope = _constexpr_to_value(scope)
+    return semantic.atomic_min(pointer, val, mask, sem, scope, _builder)
 
 
 @builtin
 @_add_atomic_docstr("logical and")
-def atomic_and(pointer, val, mask=None, sem=None, _builder=None):
+def atomic_and(pointer, val, mask=None, sem=None, scope=None, _builder=None):
     val = _to_tensor(val, _builder)
     sem = _constexpr_to_value(sem)
-    return semantic.atomic_and(pointer, val, mask, sem, _builder)
+    scope = _constexpr_to_value(scope)
+    return semantic.atomic_and(pointer, val, mask, sem, scope, _builder)
 
 
 @builtin
 @_add_atomic_docstr("logical or")
-def atomic_or(pointer, val, mask=None, sem=None, _builder=None):
+def atomic_or(pointer, val, mask=None, sem=None, scope=None, _builder=None):
     val = _to_tensor(val, _builder)
     sem = _constexpr_to_value(sem)
-    return semantic.atomic_or(pointer, val, mask, sem, _builder)
+    scope = _constexpr_to_value(scope)
+    return semantic.atomic_or(pointer, val, mask, sem, scope, _builder)
 
 
 @builtin
 @_add_atomic_docstr("logical xor")
-def atomic_xor(pointer, val, mask=None, sem=None, _builder=None):
+def atomic_xor(pointer, val, mask=None, sem=None, scope=None, _builder=None):
     val = _to_tensor(val, _builder)
     sem = _constexpr_to_value(sem)
-    return semantic.atomic_xor(pointer, val, mask, sem, _builder)
+    scope = _constexpr_to_value(scope)
+    return semantic.atomic_xor(pointer, val, mask, sem, scope, _builder)
 
 
 # -----------------------
@@ -1283,7 +1373,7 @@ def _add_reduction_docstr(name: str, return_indices_arg: str = None, tie_break_a
     Returns the {name} of all elements in the :code:`input` tensor along the provided :code:`axis`
 
     :param input: the input values
-    :param axis: the dimension along which the reduction should be done"""
+    :param axis: the dimension, or tuple of dimensions, along which the reduction should be done"""
         if return_indices_arg is not None:
             docstr += f"""
     :param {return_indices_arg}: if true, return index corresponding to the {name} value"""
@@ -1309,9 +1399,11 @@ def reduce(input, axis, combine_fn, _builder=None, _generator=None):
     """Applies the combine_fn to all elements in :code:`input` tensors along the provided :code:`axis`
 
     :param input: the input tensor, or tuple of tensors
-    :param axis: the dimension along which the reduction should be done
+    :param axis: the dimension, or tuple of dimensions, along which the reduction should be done
     :param combine_fn: a function to combine two groups of scalar tensors (must be marked with @triton.jit)
 
+    A tuple of all the dimensions is reduced in a single reduction, as with :code:`axis=None`.
+    Any other tuple of dimensions is reduced one dimension at a time.
     """
     if isinstance(input, tensor):
         return reduce((input,), axis, combine_fn,
@@ -1335,6 +1427,20 @@ def reduce(input, axis, combine_fn, _builder=None, _generator=None):
             _builder.create_reduce_ret(*handles)
     if axis is not None:
         axis = _constexpr_to_value(axis)
+    if isinstance(axis, (tuple, list)):
+        ndim = len(input[0].shape)
+        axes = sorted({_wrap_axis(_constexpr_to_value(a), ndim) for a in axis}, reverse=True)
+        if len(axes) == ndim:
+            # a single reduction of all the elements
+            axis = None
+        else:
+            # one reduction per axis, from the last one so that the indices of
+            # the others still hold: tt.reduce takes a single axis, and `view`
+            # may reorder elements across the kept dimensions, so the reduced
+            # ones can't be flattened into one
+            for a in axes:
+                input = semantic.reduction(input, a, make_combine_region, _builder)
+            return input
     return semantic.reduction(input, axis, make_combine_region, _builder)
 
 
@@ -1357,6 +1463,8 @@ def _promote_reduction_input(t, _builder=None):
 @builtin
 def _reduce_with_indices(input, axis, combine_fn, _builder=None, _generator=None):
     axis = _constexpr_to_value(axis)
+    if isinstance(axis, (tuple, list)):
+        raise ValueError("reductions returning indices take a single axis")
     n = input.shape[axis]
     index = arange(0, n, _builder=_builder)
 
@@ -1634,6 +1742,15 @@ def debug_barrier(_builder=None):
     return semantic.debug_barrier(_builder)
 
 
+@builtin
+def cluster_barrier(_builder=None):
+    '''
+    Insert a barrier to synchronize all threads of all the programs of a
+    thread block cluster (sm90 only).
+    '''
+    return semantic.cluster_barrier(_builder)
+
+
 @builtin
 def multiple_of(input, values, _builder=None):
     """
@@ -1793,6 +1910,43 @@ def device_assert(cond, msg="", _builder=None):
     return semantic.device_assert(_to_tensor(cond, _builder), msg, file_name, func_name, lineno, _builder)
 
 
+@builtin
+def profile_region_begin(name, _builder=None):
+    '''
+    Marks the entry of the profiled region :code:`name`, which
+    :code:`profile_region_end` closes. Each warp reads its cycle counter at the
+    entry and the exit of the region; the cycles spent in every region, summed
+    over the warps and programs, are reported by the :code:`profile` method of
+    the compiled kernel.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        tl.profile_region_begin("mainloop")
+        for k in range(0, K, BLOCK_K):
+            ...
+        tl.profile_region_end("mainloop")
+
+    :param name: the name of the region. This is required to be a string literal.
+    '''
+    name = _constexpr_to_value(name)
+    assert isinstance(name, str), f"{name} is not string"
+    return semantic.profile_region(name, False, _builder)
+
+
+@builtin
+def profile_region_end(name, _builder=None):
+    '''
+    Marks the exit of the profiled region :code:`name`, opened by
+    :code:`profile_region_begin`.
+
+    :param name: the name of the region. This is required to be a string literal.
+    '''
+    name = _constexpr_to_value(name)
+    assert isinstance(name, str), f"{name} is not string"
+    return semantic.profile_region(name, True, _builder)
+
+
 # -----------------------
 # Iterators
 # -----------------------
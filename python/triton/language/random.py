@@ -176,3 +176,97 @@ def randn4x(seed, offset, n_rounds: tl.constexpr = N_ROUNDS_DEFAULT):
     n1, n2 = pair_uniform_to_normal(u1, u2)
     n3, n4 = pair_uniform_to_normal(u3, u4)
     return n1, n2, n3, n4
+
+# -------------------
+# contiguous streams
+# -------------------
+
+
+@jit
+def _spread4x(x0, x1, x2, x3):
+    # four [M] blocks -> the [M, 4] block whose row i is (x0[i], x1[i], x2[i], x3[i])
+    k = tl.arange(0, 4)[None, :]
+    return tl.where(k == 0, x0[:, None], tl.where(k == 1, x1[:, None], tl.where(k == 2, x2[:, None], x3[:, None])))
+
+
+@jit
+def randint4x_contiguous(seed, offset, n_rounds: tl.constexpr = N_ROUNDS_DEFAULT):
+    """
+    Given a :code:`seed` scalar and a 1D :code:`offset` block of counters,
+    returns a block of random :code:`int32` of shape :code:`[offset.shape[0], 4]`
+    holding the four numbers of each Philox evaluation: element :code:`[i, k]`
+    is number :code:`4 * offset[i] + k` of the stream, so that a block of
+    :code:`4 * N` contiguous elements only costs :code:`N` evaluations.
+
+    :param seed: The seed for generating random numbers.
+    :param offset: The counters to generate random numbers for.
+    """
+    i1, i2, i3, i4 = randint4x(seed, offset, n_rounds)
+    return _spread4x(i1, i2, i3, i4)
+
+
+@jit
+def rand4x_contiguous(seed, offset, n_rounds: tl.constexpr = N_ROUNDS_DEFAULT):
+    """
+    Like :code:`randint4x_contiguous`, but with random :code:`float32` in
+    :math:`U(0, 1)`.
+
+    :param seed: The seed for generating random numbers.
+    :param offset: The counters to generate random numbers for.
+    """
+    offset = offset.to(tl.uint32, bitcast=True)
+    return uint32_to_uniform_float(randint4x_contiguous(seed, offset, n_rounds))
+
+
+@jit
+def randn4x_contiguous(seed, offset, n_rounds: tl.constexpr = N_ROUNDS_DEFAULT):
+    """
+    Like :code:`randint4x_contiguous`, but with random :code:`float32` in
+    :math:`\\mathcal{N}(0, 1)`.
+
+    :param seed: The seed for generating random numbers.
+    :param offset: The counters to generate random numbers for.
+    """
+    n1, n2, n3, n4 = randn4x(seed, offset, n_rounds)
+    return _spread4x(n1, n2, n3, n4)
+
+# -------------------
+# dropout masks
+# -------------------
+
+
+@jit
+def dropout_mask_bits(seed, offset, p, n_rounds: tl.constexpr = N_ROUNDS_DEFAULT):
+    """
+    Given a :code:`seed` scalar and a 1D :code:`offset` block of word indices,
+    returns a block of :code:`uint32` dropout masks with one bit per element:
+    bit :code:`j` of word :code:`i` is set if element :code:`32 * offset[i] + j`
+    is kept, that is if its number in the :code:`rand4x_contiguous` stream is
+    greater than :code:`p`. Storing these words for the backward pass takes
+    a bit per element, and regenerates no random numbers.
+
+    :param seed: The seed for generating random numbers.
+    :param offset: The indices of the words to generate.
+    :param p: The probability of dropping an element.
+    """
+    # a word takes the four numbers of 8 Philox evaluations
+    q = tl.arange(0, 8)[None, :]
+    u1, u2, u3, u4 = rand4x(seed, offset[:, None] * 8 + q, n_rounds)
+    nibble = (u1 > p).to(tl.uint32) | ((u2 > p).to(tl.uint32) << 1) | \
+        ((u3 > p).to(tl.uint32) << 2) | ((u4 > p).to(tl.uint32) << 3)
+    # the nibbles don't overlap, so xor-ing them is or-ing them
+    return tl.xor_sum(nibble << (q * 4).to(tl.uint32), axis=1)
+
+
+@jit
+def dropout_mask_from_bits(words, offset):
+    """
+    Given the :code:`words` of :code:`dropout_mask_bits` that hold the
+    elements of the :code:`offset` block (i.e., word :code:`offset // 32` for
+    each element), returns whether each element is kept.
+
+    :param words: The words of the mask, of the shape of :code:`offset`.
+    :param offset: The offsets of the elements.
+    """
+    words = words.to(tl.uint32, bitcast=True)
+    return ((words >> (offset % 32).to(tl.uint32)) & 1) != 0
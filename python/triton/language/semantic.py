@@ -5,6 +5,7 @@ from functools import wraps
 from typing import List, Optional, Sequence, Tuple, TypeVar
 
 from .._C.libtriton.triton import ir
+from ..common.backend import get_ptx_version
 from . import core as tl
 
 T = TypeVar('T')
@@ -31,6 +32,21 @@ def program_id(axis: int, builder: ir.builder) -> tl.tensor:
 def num_programs(axis: int, builder: ir.builder) -> tl.tensor:
     return tl.tensor(builder.create_get_num_programs(axis), tl.int32)
 
+
+def _check_clusters_supported(name: str, builder: ir.builder):
+    if not (_is_cuda(builder.arch) and builder.arch >= 90):
+        raise ValueError(f"{name} needs thread block clusters, which require compute capability 9.0 or later")
+
+
+def cluster_cta_rank(builder: ir.builder) -> tl.tensor:
+    _check_clusters_supported("cluster_cta_rank", builder)
+    return tl.tensor(builder.create_get_cluster_cta_rank(), tl.int32)
+
+
+def num_cluster_ctas(builder: ir.builder) -> tl.tensor:
+    _check_clusters_supported("num_cluster_ctas", builder)
+    return tl.tensor(builder.create_get_cluster_num_ctas(), tl.int32)
+
 # ===----------------------------------------------------------------------===//
 #                               Implicit Casting Utilities
 # ===----------------------------------------------------------------------===//
@@ -670,7 +686,8 @@ def _is_cuda(arch):
 
 def cast(input: tl.tensor,
          dst_ty: tl.dtype,
-         builder: ir.builder) -> tl.tensor:
+         builder: ir.builder,
+         saturate: bool = False) -> tl.tensor:
     src_ty = input.type
     if isinstance(dst_ty, tl.constexpr):
         dst_ty = dst_ty.value
@@ -690,7 +707,7 @@ def cast(input: tl.tensor,
     # Casting with customized floating types involved: fp8 <=> bf16, fp16, fp32, fp64
     if (src_sca_ty.is_fp8() and dst_sca_ty.is_floating()) or \
        (src_sca_ty.is_floating() and dst_sca_ty.is_fp8()):
-        return tl.tensor(builder.create_fp_to_fp(input.handle, dst_ty.to_ir(builder)),
+        return tl.tensor(builder.create_fp_to_fp(input.handle, dst_ty.to_ir(builder), saturate),
                          dst_ty)
 
     # bf16 <=> (not fp32)
@@ -854,6 +871,20 @@ def _str_to_sem(sem_option):
     return sem
 
 
+def _str_to_scope(scope_option):
+    scope = ir.MEM_SYNC_SCOPE.GPU
+    if scope_option:
+        if scope_option == "gpu":
+            scope = ir.MEM_SYNC_SCOPE.GPU
+        elif scope_option == "cta":
+            scope = ir.MEM_SYNC_SCOPE.CTA
+        elif scope_option == "sys":
+            scope = ir.MEM_SYNC_SCOPE.SYSTEM
+        else:
+            raise ValueError(f"Memory sync scope {scope_option} not supported")
+    return scope
+
+
 def _canonicalize_boundary_check(boundary_check, block_shape):
     if boundary_check:
         if not hasattr(boundary_check, "__iter__"):
@@ -867,7 +898,8 @@ def _canonicalize_boundary_check(boundary_check, block_shape):
     return tuple()
 
 
-def _load_block_pointer(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, builder):
+def _load_block_pointer(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, l2_eviction,
+                        builder):
     # Load by a block pointer: `pointer_type<block_type<>>`
     # Block pointer can not have `mask` and `other` arguments
     if mask or other:
@@ -886,10 +918,10 @@ def _load_block_pointer(ptr, mask, other, boundary_check, padding, cache, evicti
 
     # Build IR
     return tl.tensor(builder.create_tensor_pointer_load(ptr.handle, boundary_check, padding, cache, eviction,
-                                                        is_volatile), dst_ty)
+                                                        is_volatile, l2_eviction), dst_ty)
 
 
-def _load_legacy(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, builder):
+def _load_legacy(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, l2_eviction, builder):
     # Load by a tensor of pointers or a pointer of scalar: `block_type<pointer_type<>>` or `pointer_type<>`
     if not ptr.type.scalar.is_ptr():
         raise ValueError(f"Unsupported ptr type {ptr.type.__repr__()} in `tl.load`")
@@ -940,10 +972,10 @@ def _load_legacy(ptr, mask, other, boundary_check, padding, cache, eviction, is_
 
     # Build IR
     if not mask:
-        return tl.tensor(builder.create_load(ptr.handle, cache, eviction, is_volatile), dst_ty)
+        return tl.tensor(builder.create_load(ptr.handle, cache, eviction, is_volatile, l2_eviction), dst_ty)
     else:
         return tl.tensor(builder.create_masked_load(ptr.handle, mask.handle, other.handle if other else None, cache,
-                                                    eviction, is_volatile), dst_ty)
+                                                    eviction, is_volatile, l2_eviction), dst_ty)
 
 
 def load(ptr: tl.tensor,
@@ -954,21 +986,27 @@ def load(ptr: tl.tensor,
          cache_modifier: str,
          eviction_policy: str,
          is_volatile: bool,
+         l2_eviction_policy: str,
          builder: ir.builder) -> tl.tensor:
     # Cache, eviction and padding options
     cache = _str_to_load_cache_modifier(cache_modifier)
     eviction = _str_to_eviction_policy(eviction_policy)
+    l2_eviction = _str_to_eviction_policy(l2_eviction_policy)
     padding = _str_to_padding_option(padding_option)
+    if is_volatile and l2_eviction != ir.EVICTION_POLICY.NORMAL:
+        raise ValueError("Volatile loads do not support an L2 eviction policy")
 
     if ptr.type.is_ptr() and ptr.type.element_ty.is_block():
         # Load by a block pointer: `pointer_type<block_type<>>`
-        return _load_block_pointer(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, builder)
+        return _load_block_pointer(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile,
+                                   l2_eviction, builder)
     else:
         # Load by a tensor of pointers or a pointer of scalar: `block_type<pointer_type<>>` or `pointer_type<>`
-        return _load_legacy(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, builder)
+        return _load_legacy(ptr, mask, other, boundary_check, padding, cache, eviction, is_volatile, l2_eviction,
+                            builder)
 
 
-def _store_block_pointer(ptr, val, mask, boundary_check, cache, eviction, builder):
+def _store_block_pointer(ptr, val, mask, boundary_check, cache, eviction, l2_eviction, builder):
     # Store by a block pointer: `pointer_type<block_type<>>`
     # Block pointers can not have the `mask` argument
     if mask:
@@ -989,11 +1027,12 @@ def _store_block_pointer(ptr, val, mask, boundary_check, cache, eviction, builde
     boundary_check = _canonicalize_boundary_check(boundary_check, block_shape)
 
     # Build IR
-    return tl.tensor(builder.create_tensor_pointer_store(ptr.handle, val.handle, boundary_check, cache, eviction),
+    return tl.tensor(builder.create_tensor_pointer_store(ptr.handle, val.handle, boundary_check, cache, eviction,
+                                                         l2_eviction),
                      tl.void)
 
 
-def _store_legacy(ptr, val, mask, boundary_check, cache, eviction, builder):
+def _store_legacy(ptr, val, mask, boundary_check, cache, eviction, l2_eviction, builder):
     # Store by a tensor of pointers or a pointer of scalar: `block_type<pointer_type<>>` or `pointer_type<>`
     if not ptr.type.scalar.is_ptr():
         raise ValueError(f"Unsupported ptr type {ptr.type.__repr__()} in `tl.store`")
@@ -1031,10 +1070,11 @@ def _store_legacy(ptr, val, mask, boundary_check, cache, eviction, builder):
 
     # Build IR
     if not mask:
-        return tl.tensor(builder.create_store(ptr.handle, val.handle, cache, eviction), tl.void)
+        return tl.tensor(builder.create_store(ptr.handle, val.handle, cache, eviction, l2_eviction), tl.void)
     if not mask.type.scalar.is_bool():
         raise ValueError("Mask must have boolean scalar type")
-    return tl.tensor(builder.create_masked_store(ptr.handle, val.handle, mask.handle, cache, eviction), tl.void)
+    return tl.tensor(builder.create_masked_store(ptr.handle, val.handle, mask.handle, cache, eviction,
+                                                 l2_eviction), tl.void)
 
 
 def store(ptr: tl.tensor,
@@ -1043,17 +1083,73 @@ def store(ptr: tl.tensor,
           boundary_check,
           cache_modifier: str,
           eviction_policy: str,
+          l2_eviction_policy: str,
           builder: ir.builder) -> tl.tensor:
     # Cache and eviction options
     cache = _str_to_store_cache_modifier(cache_modifier)
     eviction = _str_to_eviction_policy(eviction_policy)
+    l2_eviction = _str_to_eviction_policy(l2_eviction_policy)
 
     if ptr.type.is_ptr() and ptr.type.element_ty.is_block():
         # Store by a block pointer: `pointer_type<block_type<>>`
-        return _store_block_pointer(ptr, val, mask, boundary_check, cache, eviction, builder)
+        return _store_block_pointer(ptr, val, mask, boundary_check, cache, eviction, l2_eviction, builder)
     else:
         # Store by a tensor of pointers or a pointer of scalar: `block_type<pointer_type<>>` or `pointer_type<>`
-        return _store_legacy(ptr, val, mask, boundary_check, cache, eviction, builder)
+        return _store_legacy(ptr, val, mask, boundary_check, cache, eviction, l2_eviction, builder)
+
+
+def quantized_store(ptr: tl.tensor,
+                    val: tl.tensor,
+                    mask: Optional[tl.tensor],
+                    boundary_check,
+                    cache_modifier: str,
+                    eviction_policy: str,
+                    l2_eviction_policy: str,
+                    quantize: tl.dtype,
+                    scale_ptr: Optional[tl.tensor],
+                    amax_ptr: Optional[tl.tensor],
+                    builder: ir.builder) -> tl.tensor:
+    # Stores `val` times the scale at `scale_ptr`, converted to the fp8 type
+    # `quantize` with saturation, and folds the absolute max of the stored
+    # elements of `val` into the float at `amax_ptr`
+    if isinstance(quantize, tl.constexpr):
+        quantize = quantize.value
+    if not quantize.is_fp8():
+        raise ValueError(f"Quantized stores convert to fp8 types, not {quantize}")
+    is_block_ptr = ptr.type.is_ptr() and ptr.type.element_ty.is_block()
+    elt_ty = ptr.type.element_ty.element_ty if is_block_ptr else ptr.type.scalar.element_ty
+    if elt_ty != quantize:
+        raise ValueError(f"Quantized stores of {quantize} need pointers to {quantize}, not {elt_ty}")
+    if not val.type.scalar.is_floating():
+        raise ValueError(f"Quantized stores take floating-point values, not {val.type.scalar}")
+    val = cast(val, tl.float32, builder)
+
+    if amax_ptr is not None:
+        if amax_ptr.type.is_block() or amax_ptr.type.element_ty != tl.float32:
+            raise ValueError("`amax_ptr` must be a pointer to a float32 scalar")
+        # the elements of a block pointer are all counted, even out of bounds
+        amax_mask = mask if mask is not None else tl.tensor(builder.get_int1(True), tl.int1)
+        # absolute values order like their bits as signed integers (NaNs
+        # above infinities), so the max is a single integer atomic. All its
+        # addresses are the same: it is reduced over the block first and,
+        # with its result unused, issued as a single reduction.
+        i_amax = bitcast(abs(val, builder), tl.int32, builder)
+        i_amax_ptr = bitcast(amax_ptr, tl.pointer_type(tl.int32, 1), builder)
+        if is_block_ptr or ptr.type.is_block():
+            shape = ptr.type.element_ty.get_block_shapes() if is_block_ptr else ptr.type.get_block_shapes()
+            i_amax = broadcast_impl_shape(i_amax, shape, builder)
+            i_amax_ptr = broadcast_impl_shape(i_amax_ptr, shape, builder)
+            amax_mask = broadcast_impl_shape(amax_mask, shape, builder)
+        builder.create_atomic_rmw(ir.ATOMIC_OP.MAX, i_amax_ptr.handle, i_amax.handle, amax_mask.handle,
+                                  ir.MEM_SEMANTIC.RELAXED, scope=ir.MEM_SYNC_SCOPE.GPU)
+
+    if scale_ptr is not None:
+        if scale_ptr.type.is_block() or not scale_ptr.type.is_ptr():
+            raise ValueError("`scale_ptr` must be a pointer to a scalar")
+        scale = load(scale_ptr, None, None, (), "", "", "", False, "", builder)
+        val = mul(val, cast(scale, tl.float32, builder), builder)
+    val = cast(val, quantize, builder, saturate=True)
+    return store(ptr, val, mask, boundary_check, cache_modifier, eviction_policy, l2_eviction_policy, builder)
 
 
 #########
@@ -1065,12 +1161,14 @@ def atomic_cas(ptr: tl.tensor,
                cmp: tl.tensor,
                val: tl.tensor,
                sem: str,
+               scope: str,
                builder: ir.builder) -> tl.tensor:
     sem = _str_to_sem(sem)
+    scope = _str_to_scope(scope)
     element_ty = ptr.type.scalar.element_ty
     if element_ty.primitive_bitwidth not in [16, 32, 64]:
         raise ValueError("atomic_cas only supports elements with width {16, 32, 64}")
-    return tl.tensor(builder.create_atomic_cas(ptr.handle, cmp.handle, val.handle, sem), val.type)
+    return tl.tensor(builder.create_atomic_cas(ptr.handle, cmp.handle, val.handle, sem, scope), val.type)
 
 
 def atom_red_typechecking_impl(ptr: tl.tensor,
@@ -1083,7 +1181,11 @@ def atom_red_typechecking_impl(ptr: tl.tensor,
     element_ty = ptr.type.scalar.element_ty
     if element_ty is tl.float16 and op != 'add':
         raise ValueError("atomic_" + op + " does not support fp16")
-    if element_ty in [tl.int1, tl.int8, tl.int16, tl.bfloat16]:
+    # bf16x2 atomic adds need sm_90
+    bf16_supported = op == 'add' and _is_cuda(builder.arch) and builder.arch >= 90
+    if element_ty is tl.bfloat16 and not bf16_supported:
+        raise ValueError("atomic_" + op + " does not support bf16 on this target")
+    if element_ty in [tl.int1, tl.int8, tl.int16]:
         raise ValueError("atomic_" + op + " does not support " + str(element_ty))
     if ptr.type.is_block():
         if mask:
@@ -1105,9 +1207,11 @@ def atomic_max(ptr: tl.tensor,
                val: tl.tensor,
                mask: tl.tensor,
                sem: str,
+               scope: str,
                builder: ir.builder) -> tl.tensor:
     ptr, val, mask = atom_red_typechecking_impl(ptr, val, mask, 'max', builder)
     sem = _str_to_sem(sem)
+    scope = _str_to_scope(scope)
     sca_ty = val.type.scalar
     # direct call to atomic_max for integers
     if sca_ty.is_int():
@@ -1116,14 +1220,16 @@ def atomic_max(ptr: tl.tensor,
                                                        ptr.handle,
                                                        val.handle,
                                                        mask.handle,
-                                                       sem),
+                                                       sem,
+                                                       scope=scope),
                              val.type)
         else:
             return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.UMAX,
                                                        ptr.handle,
                                                        val.handle,
                                                        mask.handle,
-                                                       sem),
+                                                       sem,
+                                                       scope=scope),
                              val.type)
     # for float
     # return atomic_smax(i_ptr, i_val) if val >= 0
@@ -1132,8 +1238,8 @@ def atomic_max(ptr: tl.tensor,
     i_ptr = bitcast(ptr, tl.pointer_type(tl.int32, 1), builder)
     pos = greater_equal(val, tl.tensor(builder.get_fp32(0), sca_ty), builder)
     neg = less_than(val, tl.tensor(builder.get_fp32(0), sca_ty), builder)
-    pos_ret = tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.MAX, i_ptr.handle, i_val.handle, and_(mask, pos, builder).handle, sem), i_val.type)
-    neg_ret = tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.UMIN, i_ptr.handle, i_val.handle, and_(mask, neg, builder).handle, sem), i_val.type)
+    pos_ret = tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.MAX, i_ptr.handle, i_val.handle, and_(mask, pos, builder).handle, sem, scope=scope), i_val.type)
+    neg_ret = tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.UMIN, i_ptr.handle, i_val.handle, and_(mask, neg, builder).handle, sem, scope=scope), i_val.type)
     return where(pos, pos_ret, neg_ret, builder)
 
 
@@ -1141,9 +1247,11 @@ def atomic_min(ptr: tl.tensor,
                val: tl.tensor,
                mask: tl.tensor,
                sem: str,
+               scope: str,
                builder: ir.builder) -> tl.tensor:
     ptr, val, mask = atom_red_typechecking_impl(ptr, val, mask, 'min', builder)
     sem = _str_to_sem(sem)
+    scope = _str_to_scope(scope)
     sca_ty = val.type.scalar
     # direct call to atomic_min for integers
     if sca_ty.is_int():
@@ -1152,14 +1260,16 @@ def atomic_min(ptr: tl.tensor,
                                                        ptr.handle,
                                                        val.handle,
                                                        mask.handle,
-                                                       sem),
+                                                       sem,
+                                                       scope=scope),
                              val.type)
         else:
             return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.UMIN,
                                                        ptr.handle,
                                                        val.handle,
                                                        mask.handle,
-                                                       sem),
+                                                       sem,
+                                                       scope=scope),
                              val.type)
     # for float
     # return atomic_smin(i_ptr, i_val) if val >= 0
@@ -1172,13 +1282,15 @@ def atomic_min(ptr: tl.tensor,
                                                   i_ptr.handle,
                                                   i_val.handle,
                                                   and_(mask, pos, builder).handle,
-                                                  sem),
+                                                  sem,
+                                                  scope=scope),
                         i_val.type)
     neg_ret = tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.UMAX,
                                                   i_ptr.handle,
                                                   i_val.handle,
                                                   and_(mask, neg, builder).handle,
-                                                  sem),
+                                                  sem,
+                                                  scope=scope),
                         i_val.type)
     return where(pos, pos_ret, neg_ret, builder)
 
@@ -1187,52 +1299,63 @@ def atomic_add(ptr: tl.tensor,
                val: tl.tensor,
                mask: tl.tensor,
                sem: str,
+               aggregate: bool,
+               scope: str,
                builder: ir.builder) -> tl.tensor:
     ptr, val, mask = atom_red_typechecking_impl(ptr, val, mask, 'add', builder)
     sem = _str_to_sem(sem)
+    scope = _str_to_scope(scope)
     sca_ty = val.type.scalar
     op = ir.ATOMIC_OP.FADD if sca_ty.is_floating() else ir.ATOMIC_OP.ADD
-    return tl.tensor(builder.create_atomic_rmw(op, ptr.handle, val.handle, mask.handle, sem), val.type)
+    return tl.tensor(builder.create_atomic_rmw(op, ptr.handle, val.handle, mask.handle, sem, aggregate, scope), val.type)
 
 
 def atomic_and(ptr: tl.tensor,
                val: tl.tensor,
                mask: tl.tensor,
                sem: str,
+               scope: str,
                builder: ir.builder) -> tl.tensor:
     ptr, val, mask = atom_red_typechecking_impl(ptr, val, mask, 'and', builder)
     sem = _str_to_sem(sem)
-    return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.AND, ptr.handle, val.handle, mask.handle, sem), val.type)
+    scope = _str_to_scope(scope)
+    return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.AND, ptr.handle, val.handle, mask.handle, sem, scope=scope), val.type)
 
 
 def atomic_or(ptr: tl.tensor,
               val: tl.tensor,
               mask: tl.tensor,
               sem: str,
+              scope: str,
               builder: ir.builder) -> tl.tensor:
     ptr, val, mask = atom_red_typechecking_impl(ptr, val, mask, 'or', builder)
     sem = _str_to_sem(sem)
-    return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.OR, ptr.handle, val.handle, mask.handle, sem), val.type)
+    scope = _str_to_scope(scope)
+    return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.OR, ptr.handle, val.handle, mask.handle, sem, scope=scope), val.type)
 
 
 def atomic_xor(ptr: tl.tensor,
                val: tl.tensor,
                mask: tl.tensor,
                sem: str,
+               scope: str,
                builder: ir.builder) -> tl.tensor:
     ptr, val, mask = atom_red_typechecking_impl(ptr, val, mask, 'xor', builder)
     sem = _str_to_sem(sem)
-    return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.XOR, ptr.handle, val.handle, mask.handle, sem), val.type)
+    scope = _str_to_scope(scope)
+    return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.XOR, ptr.handle, val.handle, mask.handle, sem, scope=scope), val.type)
 
 
 def atomic_xchg(ptr: tl.tensor,
                 val: tl.tensor,
                 mask: tl.tensor,
                 sem: str,
+                scope: str,
                 builder: ir.builder) -> tl.tensor:
     ptr, val, mask = atom_red_typechecking_impl(ptr, val, mask, 'xchg', builder)
     sem = _str_to_sem(sem)
-    return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.XCHG, ptr.handle, val.handle, mask.handle, sem), val.type)
+    scope = _str_to_scope(scope)
+    return tl.tensor(builder.create_atomic_rmw(ir.ATOMIC_OP.XCHG, ptr.handle, val.handle, mask.handle, sem, scope=scope), val.type)
 
 # ===----------------------------------------------------------------------===//
 #                               Linear Algebra
@@ -1245,7 +1368,17 @@ def dot(lhs: tl.tensor,
         out_dtype: tl.dtype,
         builder: ir.builder) -> tl.tensor:
     assert lhs.type.is_block() and rhs.type.is_block()
-    assert lhs.dtype == rhs.dtype, f"First input ({lhs.dtype}) and second input ({rhs.dtype}) must have the same dtype!"
+    native_fp8 = [tl.float8e4, tl.float8e5]
+    if lhs.dtype.is_fp8() or rhs.dtype.is_fp8():
+        # e4m3 and e5m2 are multiplied natively by the tensor cores of sm_89
+        # and later, in any combination and into fp32, when ptxas supports PTX
+        # ISA 8.4; other fp8 dots run on fp16 operands
+        if not (_is_cuda(builder.arch) and builder.arch >= 89 and out_dtype.is_fp32() and
+                lhs.dtype in native_fp8 and rhs.dtype in native_fp8 and get_ptx_version() >= 84):
+            lhs = cast(lhs, tl.float16, builder)
+            rhs = cast(rhs, tl.float16, builder)
+    else:
+        assert lhs.dtype == rhs.dtype, f"First input ({lhs.dtype}) and second input ({rhs.dtype}) must have the same dtype!"
     assert len(lhs.shape) == 2, f"First input shape ({lhs.shape}) is not two dimensional!"
     assert len(rhs.shape) == 2, f"Second input shape ({rhs.shape}) is not two dimensional!"
     assert lhs.shape[1].value == rhs.shape[0].value, f"First input shape ({lhs.shape}) and second input shape {rhs.shape} are not compatible for matmul (second index of first shape ({lhs.shape[1].value}) must be equal to first index of second shape ({rhs.shape[0].value})"
@@ -1273,6 +1406,28 @@ def dot(lhs: tl.tensor,
                      ret_ty)
 
 
+def sparse_dot(lhs: tl.tensor,
+               rhs: tl.tensor,
+               meta: tl.tensor,
+               builder: ir.builder) -> tl.tensor:
+    assert _is_cuda(builder.arch) and builder.arch >= 80, "sparse_dot requires compute capability 8.0 or later"
+    assert lhs.type.is_block() and rhs.type.is_block() and meta.type.is_block()
+    assert lhs.dtype == rhs.dtype, f"First input ({lhs.dtype}) and second input ({rhs.dtype}) must have the same dtype!"
+    assert lhs.dtype in (tl.float16, tl.bfloat16), f"sparse_dot only supports float16 and bfloat16 inputs, got {lhs.dtype}"
+    assert meta.dtype == tl.int16, f"Metadata ({meta.dtype}) must be int16!"
+    assert len(lhs.shape) == 2 and len(rhs.shape) == 2, "Inputs must be two dimensional!"
+    M = lhs.shape[0].value
+    K = rhs.shape[0].value
+    N = rhs.shape[1].value
+    assert 2 * lhs.shape[1].value == K, f"First input shape ({lhs.shape}) must hold half of the elements of the inner dimension of the second input shape ({rhs.shape})"
+    assert M >= 16 and K >= 32 and N >= 16, f"Sparse dot shapes ({lhs.shape}, {rhs.shape}) must have M >= 16, K >= 32 and N >= 16!"
+    assert [d.value for d in meta.shape] == [M, K // 16], f"Metadata shape ({meta.shape}) must be [{M}, {K // 16}]!"
+    _0 = builder.create_splat(builder.get_fp32(0), [M, N])
+    ret_ty = tl.block_type(tl.float32, [M, N])
+    return tl.tensor(builder.create_sparse_dot(lhs.handle, rhs.handle, _0, meta.handle),
+                     ret_ty)
+
+
 # ===----------------------------------------------------------------------===//
 #                               Indexing
 # ===----------------------------------------------------------------------===//
@@ -1463,6 +1618,11 @@ def debug_barrier(builder: ir.builder) -> tl.tensor:
     return tl.tensor(builder.create_barrier(), tl.void)
 
 
+def cluster_barrier(builder: ir.builder) -> tl.tensor:
+    _check_clusters_supported("cluster_barrier", builder)
+    return tl.tensor(builder.create_cluster_barrier(), tl.void)
+
+
 def device_print(prefix: str, args: List[tl.tensor], builder: ir.builder) -> tl.tensor:
     new_args = []
     for arg in args:
@@ -1470,6 +1630,10 @@ def device_print(prefix: str, args: List[tl.tensor], builder: ir.builder) -> tl.
     return tl.tensor(builder.create_print(prefix, new_args), tl.void)
 
 
+def profile_region(name: str, end: bool, builder: ir.builder) -> tl.tensor:
+    return tl.tensor(builder.create_profile_region(name, end), tl.void)
+
+
 def device_assert(cond: tl.tensor, msg: str, file_name: str, func_name, lineno: int, builder: ir.builder) -> tl.tensor:
     cond_ty = cond.type
     if not cond_ty.is_block():
@@ -1,8 +1,13 @@
 # from .conv import _conv, conv
 from . import blocksparse
 from .cross_entropy import _cross_entropy, cross_entropy
-from .flash_attention import attention
-from .matmul import _matmul, matmul
+from .flash_attention import attention, paged_attention
+from .matmul import (_matmul, gelu_epilogue, grouped_matmul, linear_epilogue, matmul,
+                     silu_epilogue)
+from .norm import layer_norm, rms_norm
+from .reduction import global_reduce
+from .scan import cumsum
+from .sparse_matmul import compress_2_4, decompress_2_4, sparse_matmul
 
 __all__ = [
     "blocksparse",
@@ -10,5 +15,17 @@ __all__ = [
     "cross_entropy",
     "_matmul",
     "matmul",
+    "grouped_matmul",
+    "linear_epilogue",
+    "gelu_epilogue",
+    "silu_epilogue",
     "attention",
+    "paged_attention",
+    "layer_norm",
+    "rms_norm",
+    "global_reduce",
+    "cumsum",
+    "compress_2_4",
+    "decompress_2_4",
+    "sparse_matmul",
 ]
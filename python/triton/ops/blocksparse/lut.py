@@ -0,0 +1,113 @@
+import collections
+
+import torch
+
+from ... import jit
+from ... import language as tl
+from ... import next_power_of_2
+
+# ********************************************************
+# --------------------------------------------------------
+# Device-side construction of block-sparse look-up tables
+# Layouts may change at every step (e.g., dynamic routing),
+# so the compaction of a layout into its non-zero blocks
+# runs as Triton kernels next to the data, and the tables
+# built from it are cached per layout tensor and version
+# --------------------------------------------------------
+# ********************************************************
+
+
+@jit
+def _count_kernel(
+    LAYOUT, SIZES,
+    stride_h, stride_r, stride_c,
+    R, C,
+    BLOCK_C: tl.constexpr,
+):
+    row = tl.program_id(0)
+    off_h = row // R
+    off_r = row % R
+    cols = tl.arange(0, BLOCK_C)
+    x = tl.load(LAYOUT + off_h * stride_h + off_r * stride_r + cols * stride_c, mask=cols < C, other=0)
+    tl.store(SIZES + row, tl.sum((x != 0).to(tl.int32), 0))
+
+
+@jit
+def _compact_kernel(
+    LAYOUT, OFFSETS, NNZ, RANK,
+    stride_h, stride_r, stride_c,
+    R, C,
+    BLOCK_C: tl.constexpr,
+):
+    row = tl.program_id(0)
+    off_h = row // R
+    off_r = row % R
+    cols = tl.arange(0, BLOCK_C)
+    x = tl.load(LAYOUT + off_h * stride_h + off_r * stride_r + cols * stride_c, mask=cols < C, other=0)
+    nz = (x != 0).to(tl.int32)
+    mask = (cols < C) & (nz != 0)
+    # position of each non-zero block in the row-major order of the layout
+    pos = tl.load(OFFSETS + row) + tl.cumsum(nz, 0) - nz
+    tl.store(NNZ + pos * 3 + 0, off_h, mask=mask)
+    tl.store(NNZ + pos * 3 + 1, off_r, mask=mask)
+    tl.store(NNZ + pos * 3 + 2, cols, mask=mask)
+    tl.store(RANK + row * C + cols, pos, mask=mask)
+
+
+def compact(layout):
+    """
+    Device-side equivalent of `layout.nonzero()` for a 3D layout (or a strided
+    view of one). Returns
+      - sizes: number of non-zero blocks of each (head, row), flattened
+      - offsets: exclusive prefix sum of `sizes`
+      - nnz: (head, row, col) of every non-zero block, in row-major order
+      - rank: index of each non-zero block in `nnz`, with the layout's shape
+    """
+    H, R, C = layout.shape
+    device = layout.device
+    BLOCK_C = next_power_of_2(C)
+    strides = (layout.stride(0), layout.stride(1), layout.stride(2))
+    sizes = torch.empty(H * R, dtype=torch.int64, device=device)
+    _count_kernel[(H * R, )](layout, sizes, *strides, R, C, BLOCK_C=BLOCK_C)
+    offsets = torch.zeros_like(sizes)
+    offsets[1:] = torch.cumsum(sizes[:-1], dim=0)
+    # the number of blocks sizes the output, this is the only synchronization
+    num_blocks = int(offsets[-1] + sizes[-1])
+    nnz = torch.empty((num_blocks, 3), dtype=torch.int64, device=device)
+    rank = torch.zeros((H, R, C), dtype=torch.int64, device=device)
+    _compact_kernel[(H * R, )](layout, offsets, nnz, rank, *strides, R, C, BLOCK_C=BLOCK_C)
+    return sizes, offsets, nnz, rank
+
+
+class _LutCache:
+    """
+    LRU cache of look-up tables keyed by the memory and the version counter
+    of their layout, so that layouts recurring across steps skip the
+    construction kernels without their contents being read back to the host.
+    Entries hold a reference to their layout, whose memory therefore can't be
+    reused by another tensor while they are cached, and in-place updates of
+    the layout bump its version.
+    """
+
+    def __init__(self, max_size=128):
+        self.max_size = max_size
+        self.cache = collections.OrderedDict()
+
+    def __call__(self, fn):
+        def wrapper(layout, *args):
+            key = (fn.__name__, layout.data_ptr(), layout._version, tuple(layout.shape), layout.stride(),
+                   layout.dtype, layout.device) + args
+            if key in self.cache:
+                self.cache.move_to_end(key)
+                return self.cache[key][1]
+            ret = fn(layout, *args)
+            self.cache[key] = (layout, ret)
+            if len(self.cache) > self.max_size:
+                self.cache.popitem(last=False)
+            return ret
+        wrapper.__name__ = fn.__name__
+        wrapper.__doc__ = fn.__doc__
+        return wrapper
+
+
+cached = _LutCache()
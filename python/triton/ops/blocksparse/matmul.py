@@ -2,6 +2,7 @@ import torch
 
 from ... import cdiv, heuristics, jit
 from ... import language as tl
+from .lut import cached, compact
 
 # ********************************************************
 # --------------------------------------------------------
@@ -115,9 +116,10 @@ def sdd_matmul(a, b, trans_a, trans_b, trans_c, spdims, block, lut, widths, out=
     return c
 
 
+@cached
 def sdd_lut(layout, block, device):
-    lut = layout.nonzero(as_tuple=False).to(device).int()
-    lut = lut.contiguous()
+    _, _, nnz, _ = compact(layout.to(device))
+    lut = nnz.int().contiguous()
     return lut, None
 
 # -----------------------------
@@ -241,6 +243,7 @@ def dsd_matmul(a, b, trans_a, trans_b, trans_c, spdims, block, lut, width, out=N
     return c
 
 
+@cached
 def dsd_lut(layout, block, step, trans, device):
     """
     Generates the look-up table for incrementing pointers in the DSD/DDS matmul.
@@ -265,18 +268,15 @@ def dsd_lut(layout, block, step, trans, device):
     [32, 48, 64, 80]  <- row 1
     [0, 16, 64, 80]   <- row 2
     """
-    sizes = torch.sum(layout, 2 if trans else 1)
-    head_id, col_id = torch.ones_like(sizes).nonzero(as_tuple=True)
-    sizes = sizes.flatten()
+    layout = layout.to(device)
+    # reduce over the rows of `layout` when trans, over its columns otherwise
+    view = layout if trans else layout.transpose(1, 2)
+    sizes, offsets, nnz, _ = compact(view)
+    head_id = torch.arange(view.shape[0], device=device).repeat_interleave(view.shape[1])
+    col_id = torch.arange(view.shape[1], device=device).repeat(view.shape[0])
     segments = sizes * step
     # pointer increments
-    if trans:
-        nnz = layout.nonzero(as_tuple=False)
-    else:
-        nnz = layout.transpose(1, 2).nonzero(as_tuple=False)
     num_blocks = nnz.size(0)
-    offsets = torch.zeros_like(sizes)
-    offsets[1:] = torch.cumsum(sizes[:-1], dim=0)
     offsets = torch.min(offsets, (num_blocks - 1) * torch.ones_like(offsets))
     # -------------------------------
     # dense input pointer increments
@@ -299,16 +299,11 @@ def dsd_lut(layout, block, step, trans, device):
     # -------------------------------
     # same as above, except that the increments are in the sparse memory layout
     if trans:
-        A_idx = torch.arange(num_blocks, device=layout.device)
+        A_idx = torch.arange(num_blocks, device=device)
     else:
-        A_idx = torch.tensor([], dtype=torch.int64, device=layout.device)
-        current_offset = 0
-        for z in range(layout.size(0)):
-            layoutw = layout[z, :, :].clone().long()
-            msum = layoutw.sum()
-            layoutw[layoutw > 0] = 1 + torch.arange(msum, device=layout.device)
-            A_idx = torch.cat((A_idx, current_offset + layoutw.T[layoutw.T > 0] - 1))
-            current_offset += msum
+        # sparse blocks are stored in the row-major order of `layout`
+        _, _, _, rank = compact(layout)
+        A_idx = rank[nnz[:, 0], nnz[:, 2], nnz[:, 1]]
     A_incs = A_idx * block * block
     A_incs[1:] -= A_idx[:-1] * block * block
     A_incs = A_incs.view(-1, 1).repeat(1, div)
@@ -333,7 +328,7 @@ def dsd_lut(layout, block, step, trans, device):
     incs = torch.cat((incs, pad))
     # create lut
     lut = torch.cat((header, incs))
-    lut = lut.type(torch.int32).to(device)
+    lut = lut.type(torch.int32)
     # create locks
     return lut, width
 
@@ -3,6 +3,7 @@ import torch
 from ... import jit
 from ... import language as tl
 from ... import next_power_of_2
+from .lut import cached, compact
 
 
 def num_warps(n):
@@ -134,21 +135,14 @@ def _blocksparse_softmax_bwd(
 
 class _softmax(torch.autograd.Function):
     @staticmethod
+    @cached
     def make_lut(layout, block, device):
-        _empty = torch.tensor([], dtype=torch.int64, device=layout.device)
-        sizes = _empty.clone()
-        # sizes along rows
-        for h in range(layout.shape[0]):
-            sizes = torch.cat((sizes, layout[h, :, :].sum(-1)))
-        total_sizes = sizes * block
-        # offsets in block format
-        offsets = torch.zeros_like(sizes)
-        offsets[1:] = torch.cumsum(sizes[:-1], dim=0)
-        # block indices
-        columns = layout.nonzero(as_tuple=False)[:, 2]
+        # sizes along rows, offsets in block format and block indices
+        sizes, offsets, nnz, _ = compact(layout.to(device))
+        columns = nnz[:, 2]
         header = torch.stack((sizes, offsets), dim=1).view(-1)
-        lut = torch.cat((header, columns)).type(torch.int32).to(device)
-        return lut, int(total_sizes.max())
+        lut = torch.cat((header, columns)).type(torch.int32)
+        return lut, int(sizes.max()) * block
 
     @staticmethod
     def forward(
@@ -13,49 +13,61 @@ def num_warps(N):
     return 16
 
 
-@heuristics({'num_warps': lambda nargs: num_warps(nargs['N'])})
-@heuristics({'BLOCK': lambda nargs: next_power_of_2(nargs['N'])})
+# rows are streamed in chunks of at most MAX_BLOCK columns, so that large
+# vocabularies do not spill the whole row to local memory
+MAX_BLOCK = 4096
+
+
+def block_size(N):
+    return min(next_power_of_2(N), MAX_BLOCK)
+
+
+@heuristics({'num_warps': lambda nargs: num_warps(block_size(nargs['N']))})
+@heuristics({'BLOCK': lambda nargs: block_size(nargs['N'])})
 @jit
-def _forward(LOGITS, PROBS, IDX, LOSS, N, BLOCK: tl.constexpr):
+def _forward(LOGITS, LSE, IDX, LOSS, N, BLOCK: tl.constexpr):
     row = tl.program_id(0)
     cols = tl.arange(0, BLOCK)
     idx = tl.load(IDX + row)
-    # pointers to logit and probs
-    LOGITS = LOGITS + row * N + cols
-    WRIT_PROBS = PROBS + row * N + cols
-    READ_PROBS = PROBS + row * N + idx
-    # write-back negative log-probs
-    logits = tl.load(LOGITS, mask=cols < N, other=-float('inf'))
-    logits = logits.to(tl.float32)
-    logits = logits - tl.max(logits, 0)
-    probs = tl.log(tl.sum(tl.exp(logits), 0)) - logits
-    tl.store(WRIT_PROBS, probs, mask=cols < N)
-    # There is a bug in the compiler, which fails to insert a barrier here.
-    # We add it explicitly for now. Will be fixed soon.
-    tl.debug_barrier()
-    # write-back loss
-    probs = tl.load(READ_PROBS)
-    tl.store(LOSS + row, probs)
-
-
-@heuristics({'num_warps': lambda nargs: num_warps(nargs['N'])})
-@heuristics({'BLOCK': lambda nargs: next_power_of_2(nargs['N'])})
+    LOGITS = LOGITS + row.to(tl.int64) * N
+    # online log-sum-exp: keep the running max and the sum of exponentials
+    # rescaled to it, one chunk of the row at a time
+    m = -float('inf')
+    s = 0.
+    for start in range(0, N, BLOCK):
+        offs = start + cols
+        logits = tl.load(LOGITS + offs, mask=offs < N, other=-float('inf'))
+        logits = logits.to(tl.float32)
+        m_new = tl.maximum(m, tl.max(logits, 0))
+        s = s * tl.exp(m - m_new) + tl.sum(tl.exp(logits - m_new), 0)
+        m = m_new
+    lse = m + tl.log(s)
+    # write-back loss = -log(p[idx]) and the row statistics for backward
+    logit = tl.load(LOGITS + idx).to(tl.float32)
+    tl.store(LOSS + row, lse - logit)
+    tl.store(LSE + row, lse)
+
+
+@heuristics({'num_warps': lambda nargs: num_warps(block_size(nargs['N']))})
+@heuristics({'BLOCK': lambda nargs: block_size(nargs['N'])})
 @jit
-def _backward(PROBS, IDX, DPROBS, N, BLOCK: tl.constexpr):
+def _backward(LOGITS, DLOGITS, LSE, IDX, DLOSS, N, BLOCK: tl.constexpr):
     row = tl.program_id(0)
     cols = tl.arange(0, BLOCK)
     idx = tl.load(IDX + row)
-    # pointers to probs
-    PROBS = PROBS + row * N + cols
+    lse = tl.load(LSE + row)
+    dout = tl.load(DLOSS + row).to(tl.float32)
+    LOGITS = LOGITS + row.to(tl.int64) * N
+    DLOGITS = DLOGITS + row.to(tl.int64) * N
     # We know d(-log(p[i])/dlogit[k] = -id_mat[i,k] + p[k]
-    # and we have -log(p[k]) stored in PROBS, so this is easy
-    probs = -tl.load(PROBS, mask=cols < N, other=float('inf'))
-    probs = tl.exp(probs.to(tl.float32))
-    delta = cols == idx
-    # write result in-place in PROBS
-    dout = tl.load(DPROBS + row)
-    din = (probs - delta) * dout
-    tl.store(PROBS, din.to(PROBS.dtype.element_ty), mask=cols < N)
+    # and p[k] = exp(logit[k] - lse) is recomputed from the saved statistics
+    for start in range(0, N, BLOCK):
+        offs = start + cols
+        logits = tl.load(LOGITS + offs, mask=offs < N, other=0.)
+        probs = tl.exp(logits.to(tl.float32) - lse)
+        delta = offs == idx
+        din = (probs - delta) * dout
+        tl.store(DLOGITS + offs, din.to(DLOGITS.dtype.element_ty), mask=offs < N)
 
 
 class _cross_entropy(torch.autograd.Function):
@@ -63,33 +75,34 @@ class _cross_entropy(torch.autograd.Function):
     def forward(cls, ctx, logits, indices):
         # make sure we can use triton
         assert (indices.dtype == torch.int64), "Indices are expected to be of type long."
+        logits = logits.contiguous()
         # make kernel
         device, dtype = logits.device, logits.dtype
         n_cols = logits.shape[-1]
         # run the kernel
         result = torch.empty_like(indices, dtype=dtype, device=device)
-        neg_logprobs = torch.empty_like(logits, dtype=dtype, device=device)
+        lse = torch.empty_like(indices, dtype=torch.float32, device=device)
         grid = lambda opt: (logits.numel() // n_cols, )
-        _forward[grid](logits, neg_logprobs, indices, result, n_cols)
-        # save for backward
-        ctx.save_for_backward(neg_logprobs, indices)
+        _forward[grid](logits, lse, indices, result, n_cols)
+        # save for backward: only one float per row on top of the inputs
+        ctx.save_for_backward(logits, lse, indices)
         return result
 
     @classmethod
     def backward(cls, ctx, dneg_logprobs):
         """We know d(-log(p[i])/dlogit[k] = -id_mat[i,k] + p[k]
-        so we initialize the gradient as neg_logprobs, so we can just exponentiate
-        to get p[k], which is most of what we need...  neg_logprobs will be
-        modified in place to become the gradient we want
+        and p[k] is recomputed chunk by chunk from the logits and the
+        log-sum-exp of their row saved by the forward pass.
         """
         # load saved tensors
-        neg_logprobs, indices = ctx.saved_tensors
+        logits, lse, indices = ctx.saved_tensors
+        dneg_logprobs = dneg_logprobs.contiguous()
         # run the kernel
-        # neg_logprobs will be modified in place to become our gradient:
-        n_cols = neg_logprobs.shape[-1]
-        grid = lambda opt: (neg_logprobs.numel() // n_cols, )
-        _backward[grid](neg_logprobs, indices, dneg_logprobs, n_cols)
-        return neg_logprobs, None
+        dlogits = torch.empty_like(logits)
+        n_cols = logits.shape[-1]
+        grid = lambda opt: (logits.numel() // n_cols, )
+        _backward[grid](logits, dlogits, lse, indices, dneg_logprobs, n_cols)
+        return dlogits, None
 
 
 cross_entropy = _cross_entropy.apply
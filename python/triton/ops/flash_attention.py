@@ -10,7 +10,7 @@ Sequence Parallel implementation inspired by HazyResearch
 
 import torch
 
-from .. import cdiv, jit
+from .. import cdiv, jit, next_power_of_2
 from .. import language as tl
 
 
@@ -111,6 +111,169 @@ def _fwd_kernel(
     tl.store(O_block_ptr, acc.to(K.dtype.element_ty))
 
 
+@jit
+def _fwd_kernel_paged(
+    Q, K_cache, V_cache, sm_scale,
+    Out,
+    Cu_seqlens_q, Seqlens_k, Block_table,
+    stride_qt, stride_qh, stride_qk,
+    stride_kb, stride_kp, stride_kh, stride_kk,
+    stride_vb, stride_vp, stride_vh, stride_vk,
+    stride_ot, stride_oh, stride_ok,
+    stride_btb, stride_btp,
+    H,
+    BLOCK_M: tl.constexpr, BLOCK_DMODEL: tl.constexpr,
+    PAGE_SIZE: tl.constexpr,
+    IS_CAUSAL: tl.constexpr,
+):
+    start_m = tl.program_id(0)
+    off_hz = tl.program_id(1)
+    off_z = off_hz // H
+    off_h = off_hz % H
+    # queries of sequence `off_z` are packed at [q_start, q_start + q_len)
+    q_start = tl.load(Cu_seqlens_q + off_z)
+    q_len = tl.load(Cu_seqlens_q + off_z + 1) - q_start
+    if start_m * BLOCK_M >= q_len:
+        return
+    k_len = tl.load(Seqlens_k + off_z)
+    # initialize offsets
+    offs_m = start_m * BLOCK_M + tl.arange(0, BLOCK_M)
+    offs_n = tl.arange(0, PAGE_SIZE)
+    offs_d = tl.arange(0, BLOCK_DMODEL)
+    # queries are the last q_len tokens of the sequence
+    offs_pos = k_len - q_len + offs_m
+    Q += q_start.to(tl.int64) * stride_qt + off_h * stride_qh
+    K_cache += off_h * stride_kh
+    V_cache += off_h * stride_vh
+    Block_table += off_z * stride_btb
+    # initialize pointer to m and l
+    m_i = tl.zeros([BLOCK_M], dtype=tl.float32) - float("inf")
+    l_i = tl.zeros([BLOCK_M], dtype=tl.float32)
+    acc = tl.zeros([BLOCK_M, BLOCK_DMODEL], dtype=tl.float32)
+    qk_scale = sm_scale * 1.44269504
+    # load q: it will stay in SRAM throughout
+    q_ptrs = Q + offs_m[:, None] * stride_qt + offs_d[None, :] * stride_qk
+    q = tl.load(q_ptrs, mask=offs_m[:, None] < q_len, other=0.)
+    q = (q * qk_scale).to(K_cache.dtype.element_ty)
+    hi = k_len
+    if IS_CAUSAL:
+        hi = tl.minimum(k_len, k_len - q_len + (start_m + 1) * BLOCK_M)
+    for start_n in range(0, hi, PAGE_SIZE):
+        # -- look up the physical page holding keys [start_n, start_n + PAGE_SIZE) --
+        page = tl.load(Block_table + (start_n // PAGE_SIZE) * stride_btp).to(tl.int64)
+        mask_n = start_n + offs_n < k_len
+        k_ptrs = K_cache + page * stride_kb + offs_n[None, :] * stride_kp + offs_d[:, None] * stride_kk
+        v_ptrs = V_cache + page * stride_vb + offs_n[:, None] * stride_vp + offs_d[None, :] * stride_vk
+        k = tl.load(k_ptrs, mask=mask_n[None, :], other=0.)
+        v = tl.load(v_ptrs, mask=mask_n[:, None], other=0.)
+        # -- compute qk ---
+        qk = tl.where(mask_n[None, :], 0., float("-inf"))
+        if IS_CAUSAL:
+            qk = tl.where(offs_pos[:, None] >= (start_n + offs_n[None, :]), qk, float("-inf"))
+        qk += tl.dot(q, k, allow_tf32=True)
+        # -- compute scaling constant ---
+        m_i_new = tl.maximum(m_i, tl.max(qk, 1))
+        alpha = tl.math.exp2(m_i - m_i_new)
+        p = tl.math.exp2(qk - m_i_new[:, None])
+        # -- scale and update acc --
+        acc_scale = l_i * 0 + alpha  # workaround some compiler bug
+        acc *= acc_scale[:, None]
+        acc += tl.dot(p.to(V_cache.dtype.element_ty), v, allow_tf32=True)
+        # -- update m_i and l_i --
+        l_i = l_i * alpha + tl.sum(p, 1)
+        m_i = m_i_new
+    acc = acc / l_i[:, None]
+    # write back O
+    Out += q_start.to(tl.int64) * stride_ot + off_h * stride_oh
+    o_ptrs = Out + offs_m[:, None] * stride_ot + offs_d[None, :] * stride_ok
+    tl.store(o_ptrs, acc.to(Out.dtype.element_ty), mask=offs_m[:, None] < q_len)
+
+
+@jit
+def _decode_kernel_split(
+    Q, K_cache, V_cache, sm_scale,
+    Acc, M, L,
+    Seqlens_k, Block_table,
+    stride_qz, stride_qh, stride_qk,
+    stride_kb, stride_kp, stride_kh, stride_kk,
+    stride_vb, stride_vp, stride_vh, stride_vk,
+    stride_btb, stride_btp,
+    H,
+    BLOCK_DMODEL: tl.constexpr,
+    PAGE_SIZE: tl.constexpr,
+    NUM_SPLITS: tl.constexpr,
+):
+    off_hz = tl.program_id(0)
+    split = tl.program_id(1)
+    off_z = off_hz // H
+    off_h = off_hz % H
+    k_len = tl.load(Seqlens_k + off_z)
+    # each split handles a contiguous range of pages of the sequence
+    num_pages = tl.cdiv(k_len, PAGE_SIZE)
+    pages_per_split = tl.cdiv(num_pages, NUM_SPLITS)
+    lo = split * pages_per_split * PAGE_SIZE
+    hi = tl.minimum((split + 1) * pages_per_split * PAGE_SIZE, k_len)
+    offs_n = tl.arange(0, PAGE_SIZE)
+    offs_d = tl.arange(0, BLOCK_DMODEL)
+    K_cache += off_h * stride_kh
+    V_cache += off_h * stride_vh
+    Block_table += off_z * stride_btb
+    qk_scale = sm_scale * 1.44269504
+    # a single query row: too small for tl.dot, use broadcast-multiply-reduce
+    q = tl.load(Q + off_z * stride_qz + off_h * stride_qh + offs_d * stride_qk)
+    q = q.to(tl.float32) * qk_scale
+    m_i = -float("inf")
+    l_i = 0.
+    acc = tl.zeros([BLOCK_DMODEL], dtype=tl.float32)
+    for start_n in range(lo, hi, PAGE_SIZE):
+        page = tl.load(Block_table + (start_n // PAGE_SIZE) * stride_btp).to(tl.int64)
+        mask_n = start_n + offs_n < k_len
+        k_ptrs = K_cache + page * stride_kb + offs_n[:, None] * stride_kp + offs_d[None, :] * stride_kk
+        v_ptrs = V_cache + page * stride_vb + offs_n[:, None] * stride_vp + offs_d[None, :] * stride_vk
+        k = tl.load(k_ptrs, mask=mask_n[:, None], other=0.)
+        v = tl.load(v_ptrs, mask=mask_n[:, None], other=0.)
+        qk = tl.sum(q[None, :] * k.to(tl.float32), 1)
+        qk = tl.where(mask_n, qk, float("-inf"))
+        m_i_new = tl.maximum(m_i, tl.max(qk, 0))
+        alpha = tl.math.exp2(m_i - m_i_new)
+        p = tl.math.exp2(qk - m_i_new)
+        acc = acc * alpha + tl.sum(p[:, None] * v.to(tl.float32), 0)
+        l_i = l_i * alpha + tl.sum(p, 0)
+        m_i = m_i_new
+    # write back the unnormalized partial result of this split
+    off_s = off_hz * NUM_SPLITS + split
+    tl.store(Acc + off_s * BLOCK_DMODEL + offs_d, acc)
+    tl.store(M + off_s, m_i)
+    tl.store(L + off_s, l_i)
+
+
+@jit
+def _decode_kernel_reduce(
+    Acc, M, L,
+    Out,
+    stride_oz, stride_oh, stride_ok,
+    H,
+    BLOCK_DMODEL: tl.constexpr,
+    NUM_SPLITS: tl.constexpr,
+):
+    off_hz = tl.program_id(0)
+    off_z = off_hz // H
+    off_h = off_hz % H
+    offs_s = tl.arange(0, NUM_SPLITS)
+    offs_d = tl.arange(0, BLOCK_DMODEL)
+    # rescale every split to the global maximum; empty splits have m = -inf
+    # and l = 0, and drop out of the sums
+    m_i = tl.load(M + off_hz * NUM_SPLITS + offs_s)
+    l_i = tl.load(L + off_hz * NUM_SPLITS + offs_s)
+    acc = tl.load(Acc + (off_hz * NUM_SPLITS + offs_s[:, None]) * BLOCK_DMODEL + offs_d[None, :])
+    m_max = tl.max(m_i, 0)
+    alpha = tl.math.exp2(m_i - m_max)
+    l_sum = tl.sum(l_i * alpha, 0)
+    o = tl.sum(acc * alpha[:, None], 0) / l_sum
+    o_ptrs = Out + off_z * stride_oz + off_h * stride_oh + offs_d * stride_ok
+    tl.store(o_ptrs, o.to(Out.dtype.element_ty))
+
+
 @jit
 def _bwd_preprocess(
     Out, DO,
@@ -135,18 +298,15 @@ def _bwd_kernel_one_col_block(
     DQ, DK, DV,
     L,
     D,
-    stride_dqa, stride_qz, stride_qh, stride_qm, stride_qk,
+    stride_qz, stride_qh, stride_qm, stride_qk,
     stride_kz, stride_kh, stride_kn, stride_kk,
     stride_vz, stride_vh, stride_vk, stride_vn,
     Z, H, N_CTX,
     off_hz, start_n, num_block,
     BLOCK_M: tl.constexpr, BLOCK_DMODEL: tl.constexpr,
     BLOCK_N: tl.constexpr,
-    SEQUENCE_PARALLEL: tl.constexpr,
     CAUSAL: tl.constexpr,
 ):
-    if SEQUENCE_PARALLEL:
-        DQ += stride_dqa.to(tl.int64) * start_n
     if CAUSAL:
         lo = start_n * BLOCK_M
     else:
@@ -198,14 +358,9 @@ def _bwd_kernel_one_col_block(
         # compute dk = dot(ds.T, q)
         dk += tl.dot(tl.trans(ds), q, allow_tf32=True)
         # compute dq
-        if not SEQUENCE_PARALLEL:
-            dq = tl.load(dq_ptrs)
-            dq += tl.dot(ds, k, allow_tf32=True)
-            tl.store(dq_ptrs, dq)
-        elif SEQUENCE_PARALLEL:
-            # dq = tl.dot(ds, k, allow_tf32=True)
-            dq = tl.trans(tl.dot(tl.trans(k), tl.trans(ds), allow_tf32=True))
-            tl.store(dq_ptrs, dq)
+        dq = tl.load(dq_ptrs)
+        dq += tl.dot(ds, k, allow_tf32=True)
+        tl.store(dq_ptrs, dq)
 
         # increment pointers
         dq_ptrs += BLOCK_M * stride_qm
@@ -226,13 +381,12 @@ def _bwd_kernel(
     DQ, DK, DV,
     L,
     D,
-    stride_dqa, stride_qz, stride_qh, stride_qm, stride_qk,
+    stride_qz, stride_qh, stride_qm, stride_qk,
     stride_kz, stride_kh, stride_kn, stride_kk,
     stride_vz, stride_vh, stride_vk, stride_vn,
     Z, H, N_CTX,
     BLOCK_M: tl.constexpr, BLOCK_DMODEL: tl.constexpr,
     BLOCK_N: tl.constexpr,
-    SEQUENCE_PARALLEL: tl.constexpr,
     CAUSAL: tl.constexpr,
     # fmt: on
 ):
@@ -250,42 +404,140 @@ def _bwd_kernel(
     DV += off_z * stride_vz + off_h * stride_vh
 
     num_block_n = tl.cdiv(N_CTX, BLOCK_N)
-    if not SEQUENCE_PARALLEL:
-        for start_n in range(0, num_block_n):
-            _bwd_kernel_one_col_block(
-                Q, K, V, sm_scale, qk_scale, Out, DO,
-                DQ, DK, DV,
-                L,
-                D,
-                stride_dqa, stride_qz, stride_qh, stride_qm, stride_qk,
-                stride_kz, stride_kh, stride_kn, stride_kk,
-                stride_vz, stride_vh, stride_vk, stride_vn,
-                Z, H, N_CTX,
-                off_hz, start_n, num_block_n,
-                BLOCK_M=BLOCK_M, BLOCK_DMODEL=BLOCK_DMODEL,
-                BLOCK_N=BLOCK_N,
-                SEQUENCE_PARALLEL=SEQUENCE_PARALLEL,
-                CAUSAL=CAUSAL,
-            )
-    else:
-        start_n = tl.program_id(1)
+    for start_n in range(0, num_block_n):
         _bwd_kernel_one_col_block(
             Q, K, V, sm_scale, qk_scale, Out, DO,
             DQ, DK, DV,
             L,
             D,
-            stride_dqa, stride_qz, stride_qh, stride_qm, stride_qk,
+            stride_qz, stride_qh, stride_qm, stride_qk,
             stride_kz, stride_kh, stride_kn, stride_kk,
             stride_vz, stride_vh, stride_vk, stride_vn,
             Z, H, N_CTX,
             off_hz, start_n, num_block_n,
             BLOCK_M=BLOCK_M, BLOCK_DMODEL=BLOCK_DMODEL,
             BLOCK_N=BLOCK_N,
-            SEQUENCE_PARALLEL=SEQUENCE_PARALLEL,
             CAUSAL=CAUSAL,
         )
 
 
+@jit
+def _bwd_kernel_dkdv(
+    Q, K, V, sm_scale,
+    DO,
+    DK, DV,
+    L,
+    D,
+    stride_qz, stride_qh, stride_qm, stride_qk,
+    stride_kz, stride_kh, stride_kn, stride_kk,
+    stride_vz, stride_vh, stride_vk, stride_vn,
+    Z, H, N_CTX,
+    BLOCK_M: tl.constexpr, BLOCK_DMODEL: tl.constexpr,
+    BLOCK_N: tl.constexpr,
+    CAUSAL: tl.constexpr,
+):
+    # one program per (column block, batch/head): dk and dv of the block are
+    # owned by a single program, so no reduction across programs is needed
+    qk_scale = sm_scale * 1.44269504
+    start_n = tl.program_id(0)
+    off_hz = tl.program_id(1)
+    off_z = off_hz // H
+    off_h = off_hz % H
+    Q += off_z * stride_qz + off_h * stride_qh
+    K += off_z * stride_kz + off_h * stride_kh
+    V += off_z * stride_vz + off_h * stride_vh
+    DO += off_z * stride_qz + off_h * stride_qh
+    DK += off_z * stride_kz + off_h * stride_kh
+    DV += off_z * stride_vz + off_h * stride_vh
+    D += off_hz * N_CTX
+    L += off_hz * N_CTX
+    # initialize row/col offsets
+    offs_n = start_n * BLOCK_N + tl.arange(0, BLOCK_N)
+    offs_m = tl.arange(0, BLOCK_M)
+    offs_k = tl.arange(0, BLOCK_DMODEL)
+    # k and v stay in SRAM throughout
+    k = tl.load(K + (offs_n[:, None] * stride_kn + offs_k[None, :] * stride_kk))
+    v = tl.load(V + (offs_n[:, None] * stride_vk + offs_k[None, :] * stride_vn))
+    dv = tl.zeros([BLOCK_N, BLOCK_DMODEL], dtype=tl.float32)
+    dk = tl.zeros([BLOCK_N, BLOCK_DMODEL], dtype=tl.float32)
+    lo = start_n * BLOCK_N if CAUSAL else 0
+    # loop over rows
+    for start_m in range(lo, N_CTX, BLOCK_M):
+        offs_m_curr = start_m + offs_m
+        q = tl.load(Q + (offs_m_curr[:, None] * stride_qm + offs_k[None, :] * stride_qk))
+        do = tl.load(DO + (offs_m_curr[:, None] * stride_qm + offs_k[None, :] * stride_qk))
+        # recompute p = softmax(qk, dim=-1)
+        qk = tl.dot(q, tl.trans(k)) * qk_scale
+        if CAUSAL:
+            qk = tl.where(offs_m_curr[:, None] >= offs_n[None, :], qk, float("-inf"))
+        l_i = tl.load(L + offs_m_curr)
+        p = tl.math.exp2(qk - l_i[:, None])
+        # compute dv
+        dv += tl.dot(tl.trans(p.to(Q.dtype.element_ty)), do, allow_tf32=True)
+        # compute ds = p * (dp - delta[:, None])
+        Di = tl.load(D + offs_m_curr)
+        dp = tl.dot(do, tl.trans(v), allow_tf32=True)
+        ds = (p * (dp - Di[:, None]) * sm_scale).to(Q.dtype.element_ty)
+        # compute dk = dot(ds.T, q)
+        dk += tl.dot(tl.trans(ds), q, allow_tf32=True)
+    # write-back
+    tl.store(DV + (offs_n[:, None] * stride_vk + offs_k[None, :] * stride_vn), dv)
+    tl.store(DK + (offs_n[:, None] * stride_kn + offs_k[None, :] * stride_kk), dk)
+
+
+@jit
+def _bwd_kernel_dq(
+    Q, K, V, sm_scale,
+    DO,
+    DQ,
+    L,
+    D,
+    stride_qz, stride_qh, stride_qm, stride_qk,
+    stride_kz, stride_kh, stride_kn, stride_kk,
+    stride_vz, stride_vh, stride_vk, stride_vn,
+    Z, H, N_CTX,
+    BLOCK_M: tl.constexpr, BLOCK_DMODEL: tl.constexpr,
+    BLOCK_N: tl.constexpr,
+    CAUSAL: tl.constexpr,
+):
+    # one program per (row block, batch/head), recomputing p and ds for its
+    # rows instead of receiving them from the dk/dv programs
+    qk_scale = sm_scale * 1.44269504
+    start_m = tl.program_id(0)
+    off_hz = tl.program_id(1)
+    off_z = off_hz // H
+    off_h = off_hz % H
+    Q += off_z * stride_qz + off_h * stride_qh
+    K += off_z * stride_kz + off_h * stride_kh
+    V += off_z * stride_vz + off_h * stride_vh
+    DO += off_z * stride_qz + off_h * stride_qh
+    DQ += off_z * stride_qz + off_h * stride_qh
+    # initialize row/col offsets
+    offs_m = start_m * BLOCK_M + tl.arange(0, BLOCK_M)
+    offs_n = tl.arange(0, BLOCK_N)
+    offs_k = tl.arange(0, BLOCK_DMODEL)
+    # q, do and the row statistics stay in SRAM throughout
+    q = tl.load(Q + (offs_m[:, None] * stride_qm + offs_k[None, :] * stride_qk))
+    do = tl.load(DO + (offs_m[:, None] * stride_qm + offs_k[None, :] * stride_qk))
+    l_i = tl.load(L + off_hz * N_CTX + offs_m)
+    Di = tl.load(D + off_hz * N_CTX + offs_m)
+    dq = tl.zeros([BLOCK_M, BLOCK_DMODEL], dtype=tl.float32)
+    hi = (start_m + 1) * BLOCK_M if CAUSAL else N_CTX
+    # loop over columns
+    for start_n in range(0, hi, BLOCK_N):
+        offs_n_curr = start_n + offs_n
+        k = tl.load(K + (offs_n_curr[:, None] * stride_kn + offs_k[None, :] * stride_kk))
+        v = tl.load(V + (offs_n_curr[:, None] * stride_vk + offs_k[None, :] * stride_vn))
+        qk = tl.dot(q, tl.trans(k)) * qk_scale
+        if CAUSAL:
+            qk = tl.where(offs_m[:, None] >= offs_n_curr[None, :], qk, float("-inf"))
+        p = tl.math.exp2(qk - l_i[:, None])
+        dp = tl.dot(do, tl.trans(v), allow_tf32=True)
+        ds = (p * (dp - Di[:, None]) * sm_scale).to(Q.dtype.element_ty)
+        dq += tl.dot(ds, k, allow_tf32=True)
+    tl.store(DQ + (offs_m[:, None] * stride_qm + offs_k[None, :] * stride_qk), dq)
+
+
 class _attention(torch.autograd.Function):
 
     @staticmethod
@@ -330,15 +582,7 @@ class _attention(torch.autograd.Function):
     def backward(ctx, do):
         BLOCK = 128
         q, k, v, o, L = ctx.saved_tensors
-        sequence_parallel = ctx.sequence_parallel
-        seq_len_kv = k.shape[2]
         do = do.contiguous()
-        if sequence_parallel:
-            replicas = cdiv(seq_len_kv, BLOCK)
-            new_dq_shape = (replicas,) + q.shape
-            dq = torch.zeros(new_dq_shape, device=q.device, dtype=q.dtype)
-        else:
-            dq = torch.zeros_like(q, dtype=torch.float32)
         dk = torch.empty_like(k)
         dv = torch.empty_like(v)
         delta = torch.empty_like(L)
@@ -347,27 +591,142 @@ class _attention(torch.autograd.Function):
             delta,
             BLOCK_M=BLOCK, D_HEAD=ctx.BLOCK_DMODEL,
         )
-        _bwd_kernel[(ctx.grid[1], cdiv(seq_len_kv, BLOCK) if sequence_parallel else 1)](
+        if ctx.sequence_parallel:
+            # dk/dv and dq in separate kernels, each parallel over its own
+            # sequence axis; every output block has a single writer, so the
+            # result is deterministic and dq needs no replicas
+            dq = torch.empty_like(q)
+            args = (
+                L,
+                delta,
+                q.stride(0), q.stride(1), q.stride(2), q.stride(3),
+                k.stride(0), k.stride(1), k.stride(2), k.stride(3),
+                v.stride(0), v.stride(1), v.stride(2), v.stride(3),
+                q.shape[0], q.shape[1], q.shape[2],
+            )
+            _bwd_kernel_dkdv[(cdiv(k.shape[2], BLOCK), ctx.grid[1])](
+                q, k, v, ctx.sm_scale,
+                do,
+                dk, dv,
+                *args,
+                BLOCK_M=BLOCK, BLOCK_N=BLOCK,
+                BLOCK_DMODEL=ctx.BLOCK_DMODEL,
+                CAUSAL=ctx.causal,
+                num_warps=8,
+                num_stages=1,
+            )
+            _bwd_kernel_dq[(cdiv(q.shape[2], BLOCK), ctx.grid[1])](
+                q, k, v, ctx.sm_scale,
+                do,
+                dq,
+                *args,
+                BLOCK_M=BLOCK, BLOCK_N=BLOCK,
+                BLOCK_DMODEL=ctx.BLOCK_DMODEL,
+                CAUSAL=ctx.causal,
+                num_warps=8,
+                num_stages=1,
+            )
+            return dq, dk, dv, None, None, None
+        dq = torch.zeros_like(q, dtype=torch.float32)
+        _bwd_kernel[(ctx.grid[1], 1)](
             q, k, v, ctx.sm_scale,
             o, do,
             dq, dk, dv,
             L,
             delta,
-            o.numel(), q.stride(0), q.stride(1), q.stride(2), q.stride(3),
+            q.stride(0), q.stride(1), q.stride(2), q.stride(3),
             k.stride(0), k.stride(1), k.stride(2), k.stride(3),
             v.stride(0), v.stride(1), v.stride(2), v.stride(3),
             q.shape[0], q.shape[1], q.shape[2],
             BLOCK_M=BLOCK, BLOCK_N=BLOCK,
             BLOCK_DMODEL=ctx.BLOCK_DMODEL,
-            SEQUENCE_PARALLEL=sequence_parallel,
             CAUSAL=ctx.causal,
             num_warps=8,
             num_stages=1,
         )
-
-        if len(dq.shape) == 5:
-            dq = dq.sum(dim=0)
         return dq, dk, dv, None, None, None
 
 
 attention = _attention.apply
+
+
+def paged_attention(q, k_cache, v_cache, cu_seqlens_q, seqlens_k, block_table,
+                    sm_scale, causal=False, max_seqlen_q=None, num_splits=None):
+    """Forward attention over variable-length sequences with a paged KV cache.
+
+    :param q: queries of all sequences packed along the first axis, of shape
+        (total_q, H, D).
+    :param k_cache: keys of shape (num_pages, page_size, H, D).
+    :param v_cache: values of shape (num_pages, page_size, H, D).
+    :param cu_seqlens_q: int32 tensor of shape (Z + 1,); the queries of
+        sequence `z` are `q[cu_seqlens_q[z]:cu_seqlens_q[z + 1]]`.
+    :param seqlens_k: int32 tensor of shape (Z,) with the number of cached
+        tokens of each sequence. The queries are its last tokens.
+    :param block_table: int32 tensor of shape (Z, max_pages); token `t` of
+        sequence `z` lives at `k_cache[block_table[z, t // page_size], t % page_size]`.
+    :param max_seqlen_q: longest query length; computed from `cu_seqlens_q`
+        (with a device synchronization) when omitted. When it is 1, the
+        decode kernel splits each sequence across `num_splits` programs.
+
+    Dense variable-length attention is the special case of an identity block
+    table over a contiguous cache.
+    """
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8:
+        raise RuntimeError("Flash attention currently only supported for compute capability >= 80")
+    total_q, H, Lq = q.shape
+    page_size = k_cache.shape[1]
+    assert k_cache.shape == v_cache.shape and k_cache.shape[2:] == (H, Lq)
+    assert Lq in {16, 32, 64, 128}
+    assert page_size >= 16 and page_size & (page_size - 1) == 0, "page size must be a power of two >= 16"
+    Z = seqlens_k.shape[0]
+    if max_seqlen_q is None:
+        max_seqlen_q = int((cu_seqlens_q[1:] - cu_seqlens_q[:-1]).max())
+    o = torch.empty_like(q)
+    num_warps = 4 if Lq <= 64 else 8
+    if max_seqlen_q == 1:
+        assert total_q == Z
+        # single query per sequence: parallelize over the KV length instead
+        if num_splits is None:
+            num_sms = torch.cuda.get_device_properties(q.device).multi_processor_count
+            num_splits = min(next_power_of_2(cdiv(2 * num_sms, Z * H)), 64)
+        assert num_splits & (num_splits - 1) == 0, "num_splits must be a power of two"
+        acc = torch.empty((Z * H, num_splits, Lq), device=q.device, dtype=torch.float32)
+        M = torch.empty((Z * H, num_splits), device=q.device, dtype=torch.float32)
+        L = torch.empty_like(M)
+        _decode_kernel_split[(Z * H, num_splits)](
+            q, k_cache, v_cache, sm_scale,
+            acc, M, L,
+            seqlens_k, block_table,
+            q.stride(0), q.stride(1), q.stride(2),
+            k_cache.stride(0), k_cache.stride(1), k_cache.stride(2), k_cache.stride(3),
+            v_cache.stride(0), v_cache.stride(1), v_cache.stride(2), v_cache.stride(3),
+            block_table.stride(0), block_table.stride(1),
+            H,
+            BLOCK_DMODEL=Lq, PAGE_SIZE=page_size, NUM_SPLITS=num_splits,
+            num_warps=4)
+        _decode_kernel_reduce[(Z * H, )](
+            acc, M, L,
+            o,
+            o.stride(0), o.stride(1), o.stride(2),
+            H,
+            BLOCK_DMODEL=Lq, NUM_SPLITS=num_splits,
+            num_warps=4)
+        return o
+    BLOCK_M = 64
+    grid = (cdiv(max_seqlen_q, BLOCK_M), Z * H, 1)
+    _fwd_kernel_paged[grid](
+        q, k_cache, v_cache, sm_scale,
+        o,
+        cu_seqlens_q, seqlens_k, block_table,
+        q.stride(0), q.stride(1), q.stride(2),
+        k_cache.stride(0), k_cache.stride(1), k_cache.stride(2), k_cache.stride(3),
+        v_cache.stride(0), v_cache.stride(1), v_cache.stride(2), v_cache.stride(3),
+        o.stride(0), o.stride(1), o.stride(2),
+        block_table.stride(0), block_table.stride(1),
+        H,
+        BLOCK_M=BLOCK_M, BLOCK_DMODEL=Lq, PAGE_SIZE=page_size,
+        IS_CAUSAL=causal,
+        num_warps=num_warps,
+        num_stages=2)
+    return o
@@ -1,8 +1,13 @@
+import functools
+import math
+
 import torch
 
 from .. import Config, autotune, cdiv, heuristics, jit
 from .. import language as tl
-from .matmul_perf_model import early_config_prune, estimate_matmul_time
+from ..runtime import driver
+from .matmul_perf_model import (early_config_prune, estimate_grouped_matmul_time,
+                                estimate_matmul_time, estimate_stream_k_time)
 
 _ordered_datatypes = [torch.float16, torch.bfloat16, torch.float32]
 
@@ -25,6 +30,102 @@ def init_to_zero(name):
     return lambda nargs: nargs[name].zero_()
 
 
+# Epilogues are JIT functions applied to the accumulator of each tile before it
+# is stored to C, as
+#     EPILOGUE(acc, rm, rn, M, N, Bias, stride_biasm, stride_biasn,
+#              Residual, stride_resm, stride_resn, alpha)
+# where rm and rn are the rows and columns of the tile, and Bias, Residual and
+# alpha are the arguments given to `matmul`, None when not given. Bias and
+# Residual are indexed as tensors broadcast to the shape of C: a bias of shape
+# (N,) is added to each row, one of shape (M, 1) to each column.
+
+
+@jit
+def load_broadcast(X, rm, rn, M, N, stride_xm, stride_xn):
+    mask = (rm < M)[:, None] & (rn < N)[None, :]
+    return tl.load(X + (rm[:, None] * stride_xm + rn[None, :] * stride_xn), mask=mask, other=0.)
+
+
+@jit
+def gelu(x):
+    return 0.5 * x * (1 + tl.math.erf(x * 0.7071067811865476))
+
+
+@jit
+def silu(x):
+    return x * tl.sigmoid(x)
+
+
+@jit
+def linear_epilogue(acc, rm, rn, M, N, Bias, stride_biasm, stride_biasn,
+                    Residual, stride_resm, stride_resn, alpha):
+    ''' alpha * acc + bias + residual '''
+    if alpha is not None:
+        acc = acc * alpha
+    if Bias is not None:
+        acc += load_broadcast(Bias, rm, rn, M, N, stride_biasm, stride_biasn)
+    if Residual is not None:
+        acc += load_broadcast(Residual, rm, rn, M, N, stride_resm, stride_resn)
+    return acc
+
+
+@jit
+def gelu_epilogue(acc, rm, rn, M, N, Bias, stride_biasm, stride_biasn,
+                  Residual, stride_resm, stride_resn, alpha):
+    ''' gelu(alpha * acc + bias) + residual '''
+    acc = linear_epilogue(acc, rm, rn, M, N, Bias, stride_biasm, stride_biasn,
+                          None, stride_resm, stride_resn, alpha)
+    return linear_epilogue(gelu(acc), rm, rn, M, N, None, stride_biasm, stride_biasn,
+                           Residual, stride_resm, stride_resn, None)
+
+
+@jit
+def silu_epilogue(acc, rm, rn, M, N, Bias, stride_biasm, stride_biasn,
+                  Residual, stride_resm, stride_resn, alpha):
+    ''' silu(alpha * acc + bias) + residual '''
+    acc = linear_epilogue(acc, rm, rn, M, N, Bias, stride_biasm, stride_biasn,
+                          None, stride_resm, stride_resn, alpha)
+    return linear_epilogue(silu(acc), rm, rn, M, N, None, stride_biasm, stride_biasn,
+                           Residual, stride_resm, stride_resn, None)
+
+
+@jit
+def _tile_acc(A, B, C, M, N, K,
+              stride_am, stride_ak,
+              stride_bk, stride_bn,
+              pid_m, pid_n, pid_z,
+              dot_out_dtype: tl.constexpr,
+              BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr,
+              SPLIT_K: tl.constexpr, EVEN_K: tl.constexpr,
+              ):
+    ''' the (pid_m, pid_n) tile of A @ B, over the split pid_z of K out of SPLIT_K,
+        with the operands converted to the element type of C '''
+    rm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
+    rn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
+    ram = tl.max_contiguous(tl.multiple_of(rm % M, BLOCK_M), BLOCK_M)
+    rbn = tl.max_contiguous(tl.multiple_of(rn % N, BLOCK_N), BLOCK_N)
+    rk = pid_z * BLOCK_K + tl.arange(0, BLOCK_K)
+    # pointers
+    A = A + (ram[:, None] * stride_am + rk[None, :] * stride_ak)
+    B = B + (rk[:, None] * stride_bk + rbn[None, :] * stride_bn)
+    acc = tl.zeros((BLOCK_M, BLOCK_N), dtype=dot_out_dtype)
+    for k in range(0, tl.cdiv(K, BLOCK_K * SPLIT_K)):
+        if EVEN_K:
+            a = tl.load(A)
+            b = tl.load(B)
+        else:
+            k_remaining = K - k * (BLOCK_K * SPLIT_K)
+            _0 = tl.zeros((1, 1), dtype=C.dtype.element_ty)
+            a = tl.load(A, mask=rk[None, :] < k_remaining, other=_0)
+            b = tl.load(B, mask=rk[:, None] < k_remaining, other=_0)
+        a = a.to(C.dtype.element_ty)
+        b = b.to(C.dtype.element_ty)
+        acc += tl.dot(a, b, out_dtype=dot_out_dtype)
+        A += BLOCK_K * SPLIT_K * stride_ak
+        B += BLOCK_K * SPLIT_K * stride_bk
+    return acc
+
+
 def get_configs_io_bound():
     configs = []
     for num_stages in [2, 3, 4, 5, 6]:
@@ -65,7 +166,8 @@ def get_configs_io_bound():
         Config({'BLOCK_M': 128, 'BLOCK_N': 32, 'BLOCK_K': 64, 'SPLIT_K': 1}, num_stages=4, num_warps=4),
         Config({'BLOCK_M': 64, 'BLOCK_N': 32, 'BLOCK_K': 64, 'SPLIT_K': 1}, num_stages=5, num_warps=2),
     ] + get_configs_io_bound(),
-    key=['M', 'N', 'K'],
+    # configs tuned without an epilogue may split K, which epilogues can't
+    key=['M', 'N', 'K', 'EPILOGUE'],
     prune_configs_by={
         'early_config_prune': early_config_prune,
         'perf_model': estimate_matmul_time,
@@ -80,6 +182,9 @@ def _kernel(A, B, C, M, N, K,
             stride_am, stride_ak,
             stride_bk, stride_bn,
             stride_cm, stride_cn,
+            Bias, stride_biasm, stride_biasn,
+            Residual, stride_resm, stride_resn,
+            alpha, EPILOGUE: tl.constexpr,
             dot_out_dtype: tl.constexpr,
             BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr,
             GROUP_M: tl.constexpr, SPLIT_K: tl.constexpr, EVEN_K: tl.constexpr,
@@ -96,33 +201,16 @@ def _kernel(A, B, C, M, N, K,
     pid_m = group_id * GROUP_M + (pid % group_size)
     pid_n = (pid % width) // (group_size)
     # do matrix multiplication
-    rm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
-    rn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
-    ram = tl.max_contiguous(tl.multiple_of(rm % M, BLOCK_M), BLOCK_M)
-    rbn = tl.max_contiguous(tl.multiple_of(rn % N, BLOCK_N), BLOCK_N)
-    rk = pid_z * BLOCK_K + tl.arange(0, BLOCK_K)
-    # pointers
-    A = A + (ram[:, None] * stride_am + rk[None, :] * stride_ak)
-    B = B + (rk[:, None] * stride_bk + rbn[None, :] * stride_bn)
-    acc = tl.zeros((BLOCK_M, BLOCK_N), dtype=dot_out_dtype)
-    for k in range(0, tl.cdiv(K, BLOCK_K * SPLIT_K)):
-        if EVEN_K:
-            a = tl.load(A)
-            b = tl.load(B)
-        else:
-            k_remaining = K - k * (BLOCK_K * SPLIT_K)
-            _0 = tl.zeros((1, 1), dtype=C.dtype.element_ty)
-            a = tl.load(A, mask=rk[None, :] < k_remaining, other=_0)
-            b = tl.load(B, mask=rk[:, None] < k_remaining, other=_0)
-        a = a.to(C.dtype.element_ty)
-        b = b.to(C.dtype.element_ty)
-        acc += tl.dot(a, b, out_dtype=dot_out_dtype)
-        A += BLOCK_K * SPLIT_K * stride_ak
-        B += BLOCK_K * SPLIT_K * stride_bk
-    acc = acc.to(C.dtype.element_ty)
+    acc = _tile_acc(A, B, C, M, N, K, stride_am, stride_ak, stride_bk, stride_bn,
+                    pid_m, pid_n, pid_z, dot_out_dtype,
+                    BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K, EVEN_K)
     # rematerialize rm and rn to save registers
     rm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
     rn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
+    if EPILOGUE is not None:
+        acc = EPILOGUE(acc, rm, rn, M, N, Bias, stride_biasm, stride_biasn,
+                       Residual, stride_resm, stride_resn, alpha)
+    acc = acc.to(C.dtype.element_ty)
     C = C + (rm[:, None] * stride_cm + rn[None, :] * stride_cn)
     mask = (rm < M)[:, None] & (rn < N)[None, :]
     # handles write-back with reduction-splitting
@@ -132,13 +220,210 @@ def _kernel(A, B, C, M, N, K,
         tl.atomic_add(C, acc, mask=mask)
 
 
+@autotune(
+    configs=[
+        Config({key: value for key, value in config.kwargs.items() if key != 'SPLIT_K'},
+               num_stages=config.num_stages, num_warps=config.num_warps)
+        for config in _kernel.configs if config.kwargs['SPLIT_K'] == 1
+    ],
+    key=['M', 'N', 'K', 'EPILOGUE'],
+    prune_configs_by={
+        'early_config_prune': early_config_prune,
+        'perf_model': estimate_stream_k_time,
+        'top_k': 10
+    },
+)
+@heuristics({
+    'EVEN_K': lambda args: args['K'] % args['BLOCK_K'] == 0,
+})
+@jit
+def _kernel_stream_k(A, B, C, P, Locks, M, N, K,
+                     stride_am, stride_ak,
+                     stride_bk, stride_bn,
+                     stride_cm, stride_cn,
+                     Bias, stride_biasm, stride_biasn,
+                     Residual, stride_resm, stride_resn,
+                     alpha, EPILOGUE: tl.constexpr,
+                     dot_out_dtype: tl.constexpr,
+                     BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr,
+                     GROUP_M: tl.constexpr, EVEN_K: tl.constexpr,
+                     ):
+    # the iterations over K of all tiles are split evenly between the programs
+    pid = tl.program_id(0)
+    num_programs = tl.num_programs(0)
+    grid_m = tl.cdiv(M, BLOCK_M)
+    grid_n = tl.cdiv(N, BLOCK_N)
+    iters_per_tile = tl.cdiv(K, BLOCK_K)
+    total_iters = grid_m * grid_n * iters_per_tile
+    base_iters = total_iters // num_programs
+    extra_iters = total_iters % num_programs
+    start = pid * base_iters + min(pid, extra_iters)
+    end = start + base_iters + tl.where(pid < extra_iters, 1, 0)
+    rk = tl.arange(0, BLOCK_K)
+    # offsets in the slots of the workspace of partial tiles
+    rp = tl.arange(0, BLOCK_M)[:, None] * BLOCK_N + tl.arange(0, BLOCK_N)[None, :]
+    while start < end:
+        tile_id = start // iters_per_tile
+        tile_start = tile_id * iters_per_tile
+        tile_end = tile_start + iters_per_tile
+        iter_end = min(end, tile_end)
+        # re-order program ID for better L2 performance
+        width = GROUP_M * grid_n
+        group_id = tile_id // width
+        group_size = min(grid_m - group_id * GROUP_M, GROUP_M)
+        pid_m = group_id * GROUP_M + (tile_id % group_size)
+        pid_n = (tile_id % width) // (group_size)
+        # do matrix multiplication over the iterations of the tile in [start, iter_end)
+        rm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
+        rn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
+        ram = tl.max_contiguous(tl.multiple_of(rm % M, BLOCK_M), BLOCK_M)
+        rbn = tl.max_contiguous(tl.multiple_of(rn % N, BLOCK_N), BLOCK_N)
+        k_start = start - tile_start
+        rak = k_start * BLOCK_K + rk
+        # pointers
+        A_ptrs = A + (ram[:, None] * stride_am + rak[None, :] * stride_ak)
+        B_ptrs = B + (rak[:, None] * stride_bk + rbn[None, :] * stride_bn)
+        acc = tl.zeros((BLOCK_M, BLOCK_N), dtype=dot_out_dtype)
+        for k in range(k_start, iter_end - tile_start):
+            if EVEN_K:
+                a = tl.load(A_ptrs)
+                b = tl.load(B_ptrs)
+            else:
+                k_remaining = K - k * BLOCK_K
+                _0 = tl.zeros((1, 1), dtype=C.dtype.element_ty)
+                a = tl.load(A_ptrs, mask=rk[None, :] < k_remaining, other=_0)
+                b = tl.load(B_ptrs, mask=rk[:, None] < k_remaining, other=_0)
+            a = a.to(C.dtype.element_ty)
+            b = b.to(C.dtype.element_ty)
+            acc += tl.dot(a, b, out_dtype=dot_out_dtype)
+            A_ptrs += BLOCK_K * stride_ak
+            B_ptrs += BLOCK_K * stride_bk
+        if k_start != 0:
+            # the tile started in an earlier program, which adds this partial
+            # tile: publish it in the slot of this program
+            tl.store(P + pid * BLOCK_M * BLOCK_N + rp, acc)
+            tl.debug_barrier()
+            tl.atomic_xchg(Locks + pid, 1, sem="release")
+        else:
+            # add the partial tiles of the next programs covering this tile,
+            # always in the same order so that results are deterministic
+            next_pid = pid + 1
+            next_start = end
+            while next_start < tile_end:
+                while tl.atomic_cas(Locks + next_pid, 1, 0, sem="acquire") != 1:
+                    pass
+                acc += tl.load(P + next_pid * BLOCK_M * BLOCK_N + rp)
+                next_start += base_iters + tl.where(next_pid < extra_iters, 1, 0)
+                next_pid += 1
+            # rematerialize rm and rn to save registers
+            rcm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
+            rcn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
+            C_ptrs = C + (rcm[:, None] * stride_cm + rcn[None, :] * stride_cn)
+            mask = (rcm < M)[:, None] & (rcn < N)[None, :]
+            c = acc
+            if EPILOGUE is not None:
+                c = EPILOGUE(c, rcm, rcn, M, N, Bias, stride_biasm, stride_biasn,
+                             Residual, stride_resm, stride_resn, alpha)
+            tl.store(C_ptrs, c.to(C.dtype.element_ty), mask=mask)
+        start = iter_end
+
+
+@autotune(
+    configs=list(_kernel_stream_k.configs),
+    key=['SUM_M', 'MAX_N', 'MAX_K'],
+    prune_configs_by={
+        'early_config_prune': early_config_prune,
+        'perf_model': estimate_grouped_matmul_time,
+        'top_k': 10
+    },
+    # the rows routed to each expert change at every step
+    key_buckets='pow2',
+)
+@heuristics({
+    'EVEN_K': lambda args: args['K_GCD'] % args['BLOCK_K'] == 0,
+})
+@jit
+def _kernel_grouped(A, B, C, A_PTRS, B_PTRS, C_PTRS, SIZES, STRIDES, G,
+                    SUM_M, MAX_N, MAX_K, K_GCD,
+                    dot_out_dtype: tl.constexpr,
+                    BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr,
+                    GROUP_M: tl.constexpr, EVEN_K: tl.constexpr,
+                    ):
+    # A, B and C are the operands of the first problem, which give the element
+    # types of all of them; the others are read from the arrays of pointers,
+    # sizes (M, N, K) and strides (am, ak, bk, bn, cm, cn) of each problem
+    pid = tl.program_id(0)
+    num_programs = tl.num_programs(0)
+    # persistent programs walk the tiles of all problems in order, each
+    # taking every num_programs-th tile
+    tile = pid
+    first_tile = 0
+    for g in range(0, G):
+        M = tl.load(SIZES + g * 3)
+        N = tl.load(SIZES + g * 3 + 1)
+        K = tl.load(SIZES + g * 3 + 2)
+        grid_m = tl.cdiv(M, BLOCK_M)
+        grid_n = tl.cdiv(N, BLOCK_N)
+        last_tile = first_tile + grid_m * grid_n
+        a_ptr = tl.load(A_PTRS + g).to(tl.pointer_type(A.dtype.element_ty))
+        b_ptr = tl.load(B_PTRS + g).to(tl.pointer_type(B.dtype.element_ty))
+        c_ptr = tl.load(C_PTRS + g).to(tl.pointer_type(C.dtype.element_ty))
+        stride_am = tl.load(STRIDES + g * 6)
+        stride_ak = tl.load(STRIDES + g * 6 + 1)
+        stride_bk = tl.load(STRIDES + g * 6 + 2)
+        stride_bn = tl.load(STRIDES + g * 6 + 3)
+        stride_cm = tl.load(STRIDES + g * 6 + 4)
+        stride_cn = tl.load(STRIDES + g * 6 + 5)
+        while tile < last_tile:
+            # re-order program ID for better L2 performance
+            tile_id = tile - first_tile
+            width = GROUP_M * grid_n
+            group_id = tile_id // width
+            group_size = min(grid_m - group_id * GROUP_M, GROUP_M)
+            pid_m = group_id * GROUP_M + (tile_id % group_size)
+            pid_n = (tile_id % width) // (group_size)
+            acc = _tile_acc(a_ptr, b_ptr, C, M, N, K, stride_am, stride_ak, stride_bk, stride_bn,
+                            pid_m, pid_n, 0, dot_out_dtype,
+                            BLOCK_M, BLOCK_N, BLOCK_K, 1, EVEN_K)
+            rm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
+            rn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
+            mask = (rm < M)[:, None] & (rn < N)[None, :]
+            tl.store(c_ptr + (rm[:, None] * stride_cm + rn[None, :] * stride_cn),
+                     acc.to(C.dtype.element_ty), mask=mask)
+            tile += num_programs
+        first_tile = last_tile
+
+
 class _matmul(torch.autograd.Function):
     kernel = _kernel
+    kernel_stream_k = _kernel_stream_k
+    kernel_grouped = _kernel_grouped
 
+    # per device and stream: flags of the partial tiles of Stream-K, and
+    # their workspace. Launches on one stream run in order, so they can share
+    # them, but concurrent launches on other streams can't.
     _locks = {}
+    _workspaces = {}
+    # per problem: whether Stream-K is estimated to be faster
+    _stream_k = {}
 
     @staticmethod
-    def _call(a, b, dot_out_dtype):
+    def _use_stream_k(a, b, c, M, N, K, epilogue_args):
+        key = (a.device, a.dtype, b.dtype, M, N, K) + tuple(arg is None for arg in epilogue_args.values())
+        if key not in _matmul._stream_k:
+            named_args = dict(A=a, B=b, C=c, M=M, N=N, K=K, **epilogue_args)
+
+            def best_time(kernel, perf_model):
+                return min(perf_model(**named_args, **config.kwargs,
+                                      num_stages=config.num_stages, num_warps=config.num_warps)
+                           for config in early_config_prune(kernel.configs, named_args))
+            # the data-parallel and split-K configs are already ranked by estimate_matmul_time
+            _matmul._stream_k[key] = best_time(_kernel_stream_k, estimate_stream_k_time) < \
+                best_time(_kernel, estimate_matmul_time)
+        return _matmul._stream_k[key]
+
+    @staticmethod
+    def _call(a, b, dot_out_dtype, stream_k, epilogue, bias, residual, alpha):
         device = a.device
         # handle non-contiguous inputs if necessary
         if a.stride(0) > 1 and a.stride(1) > 1:
@@ -169,19 +454,100 @@ class _matmul(torch.autograd.Function):
                 dot_out_dtype = tl.float32
             else:
                 dot_out_dtype = tl.int32
+        # epilogue
+        if epilogue is None and (bias is not None or residual is not None or alpha is not None):
+            epilogue = linear_epilogue
+        stride_bias = torch.broadcast_to(bias, (M, N)).stride() if bias is not None else (0, 0)
+        stride_res = torch.broadcast_to(residual, (M, N)).stride() if residual is not None else (0, 0)
+        epilogue_args = dict(Bias=bias, Residual=residual, EPILOGUE=epilogue)
+        if stream_k is None:
+            stream_k = _matmul._use_stream_k(a, b, c, M, N, K, epilogue_args)
         # launch kernel
+        if stream_k:
+            num_sm = driver.utils.get_device_properties(device.index)["multiprocessor_count"]
+            key = (device, torch.cuda.current_stream(device).cuda_stream)
+            if key not in _matmul._locks:
+                # flags are reset as their partial tiles are consumed
+                _matmul._locks[key] = torch.zeros(num_sm, device=device, dtype=torch.int32)
+            workspace_size = num_sm * max(config.kwargs['BLOCK_M'] * config.kwargs['BLOCK_N']
+                                          for config in _kernel_stream_k.configs)
+            if key not in _matmul._workspaces or _matmul._workspaces[key].numel() < workspace_size:
+                _matmul._workspaces[key] = torch.empty(workspace_size, device=device, dtype=torch.float32)
+            workspace = _matmul._workspaces[key]
+            if dot_out_dtype == tl.float16:
+                workspace = workspace.view(torch.float16)
+            elif dot_out_dtype == tl.int32:
+                workspace = workspace.view(torch.int32)
+            grid = lambda META: (min(num_sm, cdiv(M, META['BLOCK_M']) * cdiv(N, META['BLOCK_N']) *
+                                     cdiv(K, META['BLOCK_K'])),)
+            _kernel_stream_k[grid](a, b, c, workspace, _matmul._locks[key], M, N, K,
+                                   a.stride(0), a.stride(1),
+                                   b.stride(0), b.stride(1),
+                                   c.stride(0), c.stride(1),
+                                   bias, *stride_bias, residual, *stride_res, alpha, epilogue,
+                                   dot_out_dtype=dot_out_dtype,
+                                   GROUP_M=8)
+            return c
         grid = lambda META: (cdiv(M, META['BLOCK_M']) * cdiv(N, META['BLOCK_N']), META['SPLIT_K'])
         _kernel[grid](a, b, c, M, N, K,
                       a.stride(0), a.stride(1),
                       b.stride(0), b.stride(1),
                       c.stride(0), c.stride(1),
+                      bias, *stride_bias, residual, *stride_res, alpha, epilogue,
                       dot_out_dtype=dot_out_dtype,
                       GROUP_M=8)
         return c
 
     @staticmethod
-    def forward(ctx, a, b, dot_out_dtype=None):
-        return _matmul._call(a, b, dot_out_dtype=dot_out_dtype)
+    def forward(ctx, a, b, dot_out_dtype=None, stream_k=None, epilogue=None, bias=None, residual=None, alpha=None):
+        return _matmul._call(a, b, dot_out_dtype=dot_out_dtype, stream_k=stream_k, epilogue=epilogue,
+                             bias=bias, residual=residual, alpha=alpha)
 
 
-matmul = _matmul.apply
+def matmul(a, b, dot_out_dtype=None, stream_k=None, epilogue=None, bias=None, residual=None, alpha=None):
+    ''' a @ b, through `epilogue` if given
+        stream_k: whether to split the iterations over K of all tiles evenly between the SMs (Stream-K)
+            rather than launching a program per tile (or per split of a tile with SPLIT_K); by default,
+            the decomposition estimated to be the fastest
+        epilogue: JIT function applied to the tiles of the result before they are stored (see
+            `linear_epilogue`); defaults to `linear_epilogue` when bias, residual or alpha is given
+        bias, residual: tensors broadcastable to the result, passed to the epilogue
+        alpha: scale passed to the epilogue '''
+    return _matmul.apply(a, b, dot_out_dtype, stream_k, epilogue, bias, residual, alpha)
+
+
+def grouped_matmul(a, b, dot_out_dtype=None):
+    ''' [a[i] @ b[i] for i in range(len(a))], for problems of any sizes with operands of the same dtypes,
+        in a single launch: persistent programs, one per SM, walk the tiles of all problems, so that small
+        problems (e.g., the experts of a mixture-of-experts layer) share waves instead of each launching
+        their own. Tuned once per power of 2 of the total number of rows '''
+    assert len(a) == len(b), "a and b must hold as many matrices"
+    if len(a) == 0:
+        return []
+    device = a[0].device
+    for x, y in zip(a, b):
+        assert x.dtype == a[0].dtype and y.dtype == b[0].dtype, "the problems must have the same dtypes"
+        assert x.shape[1] == y.shape[0], "incompatible dimensions"
+    c_dtype = get_higher_dtype(a[0].dtype, b[0].dtype)
+    c = [torch.empty((x.shape[0], y.shape[1]), device=device, dtype=c_dtype) for x, y in zip(a, b)]
+    if dot_out_dtype is None:
+        dot_out_dtype = tl.float32 if c_dtype in [torch.float16, torch.float32, torch.bfloat16] else tl.int32
+    else:
+        assert isinstance(dot_out_dtype, torch.dtype), "dot_out_dtype must be a torch.dtype"
+        dot_out_dtype = {torch.float16: tl.float16, torch.float32: tl.float32,
+                         torch.bfloat16: tl.float32}.get(dot_out_dtype, tl.int32)
+    # the device-side schedule: pointers, sizes and strides of every problem
+    ptrs = torch.tensor([[x.data_ptr() for x in a], [y.data_ptr() for y in b], [z.data_ptr() for z in c]],
+                        dtype=torch.int64).to(device)
+    sizes = torch.tensor([[x.shape[0], y.shape[1], x.shape[1]] for x, y in zip(a, b)], dtype=torch.int32).to(device)
+    strides = torch.tensor([x.stride() + y.stride() + z.stride() for x, y, z in zip(a, b, c)],
+                           dtype=torch.int64).to(device)
+    K_GCD = functools.reduce(math.gcd, [x.shape[1] for x in a])
+    num_sm = driver.utils.get_device_properties(device.index)["multiprocessor_count"]
+    grid = lambda META: (max(1, min(num_sm, sum(cdiv(x.shape[0], META['BLOCK_M']) * cdiv(y.shape[1], META['BLOCK_N'])
+                                                for x, y in zip(a, b)))),)
+    _kernel_grouped[grid](a[0], b[0], c[0], ptrs[0], ptrs[1], ptrs[2], sizes, strides, len(a),
+                          sum(x.shape[0] for x in a), max(y.shape[1] for y in b), max(x.shape[1] for x in a), K_GCD,
+                          dot_out_dtype=dot_out_dtype,
+                          GROUP_M=8)
+    return c
@@ -37,19 +37,42 @@ def estimate_matmul_time(
     A, B, C,
     M, N, K,
     BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K,
-    debug=False, **kwargs
+    STREAM_K=False, debug=False, **kwargs
 ):
     ''' return estimated running time in ms
-          = max(compute, loading) + store '''
+          = max(compute, loading) + store
+        where compute accounts for the idle SMs of the last wave of CTAs, and
+        store for the partial tiles with STREAM_K '''
     backend = runtime.backend.CUDA
     device = torch.cuda.current_device()
     dtype = A.dtype
     dtsize = A.element_size()
+    num_sm = driver.utils.get_device_properties(device)["multiprocessor_count"]
 
     num_cta_m = cdiv(M, BLOCK_M)
     num_cta_n = cdiv(N, BLOCK_N)
     num_cta_k = SPLIT_K
     num_ctas = num_cta_m * num_cta_n * num_cta_k
+    num_partial_tiles = 0
+    if STREAM_K:
+        # the iterations over K of all tiles are split evenly between (at most)
+        # one CTA per SM; CTAs starting within a tile store a partial tile
+        iters_per_tile = cdiv(K, BLOCK_K)
+        total_iters = num_ctas * iters_per_tile
+        num_ctas = min(num_sm, total_iters)
+        base_iters, extra_iters = divmod(total_iters, num_ctas)
+        num_partial_tiles = sum((pid * base_iters + min(pid, extra_iters)) % iters_per_tile != 0
+                                for pid in range(num_ctas))
+        wave_efficiency = 1
+    else:
+        # CTAs of the last wave can leave SMs idle
+        max_shared_memory = driver.utils.get_device_properties(device)["max_shared_mem"]
+        required_shared_memory = (BLOCK_M + BLOCK_N) * BLOCK_K * num_stages * dtsize
+        ctas_per_sm = max(1, min(max_shared_memory // max(required_shared_memory, 1), 64 // num_warps))
+        ctas_per_wave = num_sm * ctas_per_sm
+        wave_efficiency = 1
+        if num_ctas > ctas_per_wave:
+            wave_efficiency = num_ctas / (cdiv(num_ctas, ctas_per_wave) * ctas_per_wave)
 
     # If the input is smaller than the block size
     M, N = max(M, BLOCK_M), max(N, BLOCK_N)
@@ -57,10 +80,9 @@ def estimate_matmul_time(
     # time to compute
     total_ops = 2 * M * N * K / (1024 * 1024 * 1024)  # GOPS
     tput = get_tflops(backend, device, num_ctas, num_warps, dtype)
-    compute_ms = total_ops / tput
+    compute_ms = total_ops / tput / wave_efficiency
 
     # time to load data
-    num_sm = driver.utils.get_device_properties(device)["multiprocessor_count"]
     active_cta_ratio = min(1, num_ctas / num_sm)
     active_cta_ratio_bw1 = min(1, num_ctas / 32)  # 32 active ctas are enough to saturate
     active_cta_ratio_bw2 = max(min(1, (num_ctas - 32) / (108 - 32)), 0)  # 32-108, remaining 5%
@@ -76,6 +98,10 @@ def estimate_matmul_time(
     total_l2 = (load_a_l2 + load_b_l2) / (1024 * 1024)
     # loading time in ms
     load_ms = total_dram / dram_bw + total_l2 / l2_bw
+    # the epilogue reads its operands along with the tiles of C
+    epilogue_operands = [kwargs.get('Bias'), kwargs.get('Residual')]
+    epilogue_dram = sum(x.numel() * x.element_size() for x in epilogue_operands if x is not None) / (1024 * 1024)
+    load_ms += epilogue_dram / dram_bw
 
     # estimate storing time
     store_bw = dram_bw * 0.6  # :o
@@ -88,6 +114,8 @@ def estimate_matmul_time(
         # c.zero_()
         zero_ms = M * N * 2 / (1024 * 1024) / store_bw
         store_ms += zero_ms
+    # partial tiles are written to and read back from a workspace
+    store_ms += num_partial_tiles * BLOCK_M * BLOCK_N * 4 * 2 / (1024 * 1024) / store_bw
 
     total_time_ms = max(compute_ms, load_ms) + store_ms
     if debug:
@@ -97,6 +125,19 @@ def estimate_matmul_time(
     return total_time_ms
 
 
+def estimate_stream_k_time(**kwargs):
+    ''' return estimated running time in ms of the Stream-K decomposition '''
+    return estimate_matmul_time(SPLIT_K=1, STREAM_K=True, **kwargs)
+
+
+def estimate_grouped_matmul_time(SUM_M, MAX_N, MAX_K, G, BLOCK_M, **kwargs):
+    ''' return estimated running time in ms of a grouped matmul, as that of a
+        single matmul of the rows of all problems, where each problem wastes
+        half a tile of rows on average '''
+    M = SUM_M + G * BLOCK_M // 2
+    return estimate_matmul_time(M=M, N=MAX_N, K=MAX_K, BLOCK_M=BLOCK_M, SPLIT_K=1, **kwargs)
+
+
 def early_config_prune(configs, named_args):
     device = torch.cuda.current_device()
     capability = torch.cuda.get_device_capability()
@@ -117,16 +158,20 @@ def early_config_prune(configs, named_args):
             pruned_configs.append(config)
     configs = pruned_configs
 
+    # epilogues apply to whole tiles, not to the partial sums of SPLIT_K
+    if named_args.get('EPILOGUE') is not None:
+        configs = [config for config in configs if config.kwargs.get('SPLIT_K', 1) == 1]
+
     # Some dtypes do not allow atomic_add
     if dtype not in [torch.float16, torch.float32]:
-        configs = [config for config in configs if config.kwargs['SPLIT_K'] == 1]
+        configs = [config for config in configs if config.kwargs.get('SPLIT_K', 1) == 1]
 
     # group configs by (BLOCK_M,_N,_K, SPLIT_K, num_warps)
     configs_map = {}
     for config in configs:
         kw = config.kwargs
         BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K, num_warps, num_stages = \
-            kw['BLOCK_M'], kw['BLOCK_N'], kw['BLOCK_K'], kw['SPLIT_K'], config.num_warps, config.num_stages
+            kw['BLOCK_M'], kw['BLOCK_N'], kw['BLOCK_K'], kw.get('SPLIT_K', 1), config.num_warps, config.num_stages
 
         key = (BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K, num_warps)
         if key in configs_map:
@@ -0,0 +1,290 @@
+import torch
+
+from .. import cdiv, heuristics, jit
+from .. import language as tl
+from .. import next_power_of_2, reinterpret
+
+
+def num_warps(N):
+    if N < 2048:
+        return 4
+    elif N < 8192:
+        return 8
+    return 16
+
+
+# rows are streamed in chunks of at most MAX_BLOCK columns, so that wide rows
+# do not spill the whole row to local memory
+MAX_BLOCK = 8192
+
+
+def block_size(N):
+    return min(next_power_of_2(N), MAX_BLOCK)
+
+
+@heuristics({'num_warps': lambda nargs: num_warps(block_size(nargs['N']))})
+@heuristics({'BLOCK': lambda nargs: block_size(nargs['N'])})
+@jit
+def _forward(X, RES, H, Y, W, B, MEAN, RSTD, N, eps, scale,
+             IS_RMS: tl.constexpr, HAS_RES: tl.constexpr, HAS_BIAS: tl.constexpr,
+             BLOCK: tl.constexpr):
+    row = tl.program_id(0)
+    cols = tl.arange(0, BLOCK)
+    X += row.to(tl.int64) * N
+    Y += row.to(tl.int64) * N
+    # first pass: sum (layer norm) or sum of squares (rms norm) of the row,
+    # which is the sum of the input and the residual if there is one
+    acc = tl.zeros([BLOCK], dtype=tl.float32)
+    if HAS_RES:
+        RES += row.to(tl.int64) * N
+        H += row.to(tl.int64) * N
+    for start in range(0, N, BLOCK):
+        offs = start + cols
+        mask = offs < N
+        x = tl.load(X + offs, mask=mask, other=0.)
+        if HAS_RES:
+            x = (x.to(tl.float32) + tl.load(RES + offs, mask=mask, other=0.).to(tl.float32)).to(H.dtype.element_ty)
+            tl.store(H + offs, x, mask=mask)
+        x = x.to(tl.float32)
+        if IS_RMS:
+            acc += x * x
+        else:
+            acc += x
+    # the next passes read the sum back
+    if HAS_RES:
+        X = H
+    if IS_RMS:
+        mean = 0.
+        var = tl.sum(acc, axis=0) / N
+    else:
+        mean = tl.sum(acc, axis=0) / N
+        # second pass: variance around the mean
+        acc = tl.zeros([BLOCK], dtype=tl.float32)
+        for start in range(0, N, BLOCK):
+            offs = start + cols
+            mask = offs < N
+            x = tl.load(X + offs, mask=mask, other=0.).to(tl.float32)
+            x = tl.where(mask, x - mean, 0.)
+            acc += x * x
+        var = tl.sum(acc, axis=0) / N
+        tl.store(MEAN + row, mean)
+    rstd = 1 / tl.sqrt(var + eps)
+    tl.store(RSTD + row, rstd)
+    # last pass: normalize and apply the affine transform
+    for start in range(0, N, BLOCK):
+        offs = start + cols
+        mask = offs < N
+        x = tl.load(X + offs, mask=mask, other=0.).to(tl.float32)
+        w = tl.load(W + offs, mask=mask, other=0.).to(tl.float32)
+        y = (x - mean) * rstd * w
+        if HAS_BIAS:
+            y += tl.load(B + offs, mask=mask, other=0.).to(tl.float32)
+        tl.store(Y + offs, (y * scale).to(Y.dtype.element_ty), mask=mask)
+
+
+@heuristics({'num_warps': lambda nargs: num_warps(block_size(nargs['N']))})
+@heuristics({'BLOCK': lambda nargs: block_size(nargs['N'])})
+@heuristics({'SINGLE_BLOCK': lambda nargs: nargs['N'] <= MAX_BLOCK})
+@jit
+def _backward(DY, DH, X, W, DX, MEAN, RSTD, DW_PARTIAL, DB_PARTIAL, M, N, ROWS_PER_PROGRAM,
+              IS_RMS: tl.constexpr, HAS_DH: tl.constexpr, HAS_BIAS: tl.constexpr,
+              BLOCK: tl.constexpr, SINGLE_BLOCK: tl.constexpr):
+    # first stage of the reduction of dw and db: each program accumulates the
+    # partial sums of its own rows, in order, into its own row of the
+    # partials, so that the result does not depend on scheduling
+    pid = tl.program_id(0)
+    cols = tl.arange(0, BLOCK)
+    row_start = pid * ROWS_PER_PROGRAM
+    row_end = tl.minimum(row_start + ROWS_PER_PROGRAM, M)
+    DW_PARTIAL += pid * N
+    if HAS_BIAS:
+        DB_PARTIAL += pid * N
+    if SINGLE_BLOCK:
+        # the partial sums of the whole row stay in registers
+        mask = cols < N
+        w = tl.load(W + cols, mask=mask, other=0.).to(tl.float32)
+        dw = tl.zeros([BLOCK], dtype=tl.float32)
+        db = tl.zeros([BLOCK], dtype=tl.float32)
+        for row in range(row_start, row_end):
+            off = row.to(tl.int64) * N
+            x = tl.load(X + off + cols, mask=mask, other=0.).to(tl.float32)
+            dy = tl.load(DY + off + cols, mask=mask, other=0.).to(tl.float32)
+            rstd = tl.load(RSTD + row)
+            if IS_RMS:
+                xhat = x * rstd
+            else:
+                xhat = (x - tl.load(MEAN + row)) * rstd
+            wdy = w * dy
+            c1 = tl.sum(xhat * wdy, axis=0) / N
+            if IS_RMS:
+                dx = (wdy - xhat * c1) * rstd
+            else:
+                c2 = tl.sum(wdy, axis=0) / N
+                dx = (wdy - (xhat * c1 + c2)) * rstd
+            if HAS_DH:
+                dx += tl.load(DH + off + cols, mask=mask, other=0.).to(tl.float32)
+            tl.store(DX + off + cols, dx.to(DX.dtype.element_ty), mask=mask)
+            dw += dy * xhat
+            db += dy
+        tl.store(DW_PARTIAL + cols, dw, mask=mask)
+        if HAS_BIAS:
+            tl.store(DB_PARTIAL + cols, db, mask=mask)
+    else:
+        # wide rows: the partial sums are accumulated chunk by chunk in memory
+        # (zero-initialized), which only this program touches
+        for row in range(row_start, row_end):
+            off = row.to(tl.int64) * N
+            rstd = tl.load(RSTD + row)
+            mean = 0.
+            if not IS_RMS:
+                mean = tl.load(MEAN + row)
+            acc1 = tl.zeros([BLOCK], dtype=tl.float32)
+            acc2 = tl.zeros([BLOCK], dtype=tl.float32)
+            for start in range(0, N, BLOCK):
+                offs = start + cols
+                mask = offs < N
+                x = tl.load(X + off + offs, mask=mask, other=0.).to(tl.float32)
+                dy = tl.load(DY + off + offs, mask=mask, other=0.).to(tl.float32)
+                w = tl.load(W + offs, mask=mask, other=0.).to(tl.float32)
+                xhat = tl.where(mask, (x - mean) * rstd, 0.)
+                acc1 += xhat * w * dy
+                acc2 += w * dy
+            c1 = tl.sum(acc1, axis=0) / N
+            c2 = 0.
+            if not IS_RMS:
+                c2 = tl.sum(acc2, axis=0) / N
+            for start in range(0, N, BLOCK):
+                offs = start + cols
+                mask = offs < N
+                x = tl.load(X + off + offs, mask=mask, other=0.).to(tl.float32)
+                dy = tl.load(DY + off + offs, mask=mask, other=0.).to(tl.float32)
+                w = tl.load(W + offs, mask=mask, other=0.).to(tl.float32)
+                xhat = (x - mean) * rstd
+                dx = (w * dy - (xhat * c1 + c2)) * rstd
+                if HAS_DH:
+                    dx += tl.load(DH + off + offs, mask=mask, other=0.).to(tl.float32)
+                tl.store(DX + off + offs, dx.to(DX.dtype.element_ty), mask=mask)
+                dw = tl.load(DW_PARTIAL + offs, mask=mask)
+                tl.store(DW_PARTIAL + offs, dw + dy * xhat, mask=mask)
+                if HAS_BIAS:
+                    db = tl.load(DB_PARTIAL + offs, mask=mask)
+                    tl.store(DB_PARTIAL + offs, db + dy, mask=mask)
+
+
+@jit
+def _reduce_partials(PARTIAL, OUT, G, N, BLOCK_G: tl.constexpr, BLOCK_N: tl.constexpr):
+    # second stage: sums the partials of all programs in a fixed order
+    cols = tl.program_id(0) * BLOCK_N + tl.arange(0, BLOCK_N)
+    acc = tl.zeros([BLOCK_G, BLOCK_N], dtype=tl.float32)
+    for start in range(0, G, BLOCK_G):
+        rows = start + tl.arange(0, BLOCK_G)
+        mask = (rows[:, None] < G) & (cols[None, :] < N)
+        acc += tl.load(PARTIAL + rows[:, None] * N + cols[None, :], mask=mask, other=0.)
+    tl.store(OUT + cols, tl.sum(acc, axis=0).to(OUT.dtype.element_ty), mask=cols < N)
+
+
+def _norm_forward(x, weight, bias, residual, eps, is_rms, out_dtype=None, out_scale=1.):
+    N = x.shape[-1]
+    assert weight.shape == (N, ), "weight must have the size of the last dimension of x"
+    x = x.reshape(-1, N).contiguous()
+    M = x.shape[0]
+    if residual is not None:
+        assert residual.shape[-1] == N and residual.numel() == x.numel(), "residual must have the shape of x"
+        residual = residual.reshape(-1, N).contiguous()
+        h = torch.empty_like(x)
+    else:
+        h = None
+    if out_dtype is None:
+        y = torch.empty_like(x)
+    else:
+        assert out_dtype in [tl.float8e4, tl.float8e4b15, tl.float8e5], "out_dtype must be a triton fp8 type"
+        y = reinterpret(torch.empty((M, N), dtype=torch.int8, device=x.device), out_dtype)
+    mean = None if is_rms else torch.empty((M, ), dtype=torch.float32, device=x.device)
+    rstd = torch.empty((M, ), dtype=torch.float32, device=x.device)
+    _forward[(M, )](x, residual, h, y, weight, bias, mean, rstd, N, eps, out_scale,
+                    IS_RMS=is_rms, HAS_RES=residual is not None, HAS_BIAS=bias is not None)
+    return y, x if h is None else h, mean, rstd
+
+
+def _norm_backward(dy, dh, h, weight, bias, mean, rstd, is_rms):
+    N = h.shape[-1]
+    M = h.shape[0]
+    dy = dy.reshape(-1, N).contiguous()
+    if dh is not None:
+        dh = dh.reshape(-1, N).contiguous()
+    # one partial sum of dw and db per program, a few programs per SM
+    num_sms = torch.cuda.get_device_properties(h.device).multi_processor_count
+    rows_per_program = cdiv(M, 4 * num_sms)
+    G = cdiv(M, rows_per_program)
+    dx = torch.empty_like(h)
+    dw_partial = torch.zeros((G, N), dtype=torch.float32, device=h.device)
+    db_partial = torch.zeros((G, N), dtype=torch.float32, device=h.device) if bias is not None else None
+    _backward[(G, )](dy, dh, h, weight, dx, mean, rstd, dw_partial, db_partial, M, N, rows_per_program,
+                     IS_RMS=is_rms, HAS_DH=dh is not None, HAS_BIAS=bias is not None)
+    BLOCK_G, BLOCK_N = 32, 128
+    grid = (cdiv(N, BLOCK_N), )
+    dw = torch.empty_like(weight)
+    _reduce_partials[grid](dw_partial, dw, G, N, BLOCK_G=BLOCK_G, BLOCK_N=BLOCK_N)
+    db = None
+    if bias is not None:
+        db = torch.empty_like(bias)
+        _reduce_partials[grid](db_partial, db, G, N, BLOCK_G=BLOCK_G, BLOCK_N=BLOCK_N)
+    return dx, dw, db
+
+
+class _norm(torch.autograd.Function):
+    @staticmethod
+    def forward(ctx, x, weight, bias, residual, eps, is_rms):
+        y, h, mean, rstd = _norm_forward(x, weight, bias, residual, eps, is_rms)
+        ctx.save_for_backward(h, weight, bias, mean, rstd)
+        ctx.is_rms = is_rms
+        ctx.has_residual = residual is not None
+        ctx.shape = x.shape
+        if residual is not None:
+            return y.view(x.shape), h.view(x.shape)
+        return y.view(x.shape)
+
+    @staticmethod
+    def backward(ctx, dy, *dh):
+        h, weight, bias, mean, rstd = ctx.saved_tensors
+        # the gradient of the sum returned next to y flows into x and residual
+        dh = dh[0] if ctx.has_residual else None
+        dx, dw, db = _norm_backward(dy, dh, h, weight, bias, mean, rstd, ctx.is_rms)
+        dx = dx.view(ctx.shape)
+        return dx, dw, db, dx if ctx.has_residual else None, None, None
+
+
+def _norm_apply(x, weight, bias, residual, eps, is_rms, out_dtype, out_scale):
+    if out_dtype is None:
+        return _norm.apply(x, weight, bias, residual, eps, is_rms)
+    # quantized outputs feed inference and are not differentiable
+    y, h, _, _ = _norm_forward(x, weight, bias, residual, eps, is_rms, out_dtype, out_scale)
+    if residual is not None:
+        return y, h.view(x.shape)
+    return y
+
+
+def layer_norm(x, weight, bias=None, eps=1e-5, residual=None, out_dtype=None, out_scale=1.):
+    """
+    Layer normalization over the last dimension of :code:`x`, followed by
+    the affine transform of :code:`weight` and :code:`bias`.
+
+    Rows wider than :code:`MAX_BLOCK` are streamed in chunks. The backward
+    pass reduces the gradients of :code:`weight` and :code:`bias` in two
+    stages without atomics, so they are deterministic.
+
+    :param residual: if given, :code:`x + residual` is normalized instead of
+        :code:`x`, and returned next to the output as :code:`(y, x + residual)`
+    :param out_dtype: a triton fp8 type to quantize the output to, as
+        :code:`y * out_scale`. The output is then a 2D tensor reinterpreted to
+        that type, and is not differentiable
+    """
+    return _norm_apply(x, weight, bias, residual, eps, False, out_dtype, out_scale)
+
+
+def rms_norm(x, weight, eps=1e-6, residual=None, out_dtype=None, out_scale=1.):
+    """
+    Root mean square normalization over the last dimension of :code:`x`,
+    scaled by :code:`weight`. Takes the same options as :code:`layer_norm`.
+    """
+    return _norm_apply(x, weight, None, residual, eps, True, out_dtype, out_scale)
@@ -0,0 +1,104 @@
+import torch
+
+from .. import cdiv, jit, next_power_of_2
+from .. import language as tl
+
+
+@jit
+def _combine(a, b, OP: tl.constexpr):
+    if OP == "sum":
+        return a + b
+    elif OP == "max":
+        return tl.maximum(a, b)
+    else:
+        return tl.minimum(a, b)
+
+
+@jit
+def _reduce(x, OP: tl.constexpr):
+    if OP == "sum":
+        return tl.sum(x, 0)
+    elif OP == "max":
+        return tl.max(x, 0)
+    else:
+        return tl.min(x, 0)
+
+
+@jit
+def _kernel(X, Y, Partials, Counter, N,
+            OP: tl.constexpr, IDENTITY: tl.constexpr,
+            BLOCK: tl.constexpr, PARTIALS_BLOCK: tl.constexpr):
+    pid = tl.program_id(0)
+    num_programs = tl.num_programs(0)
+    # each program reduces a fixed set of tiles, in a fixed order
+    acc = tl.full([BLOCK], IDENTITY, Partials.dtype.element_ty)
+    for start in range(pid * BLOCK, N, num_programs * BLOCK):
+        offs = start + tl.arange(0, BLOCK)
+        mask = offs < N
+        x = tl.load(X + offs, mask=mask)
+        x = tl.where(mask, x.to(Partials.dtype.element_ty), IDENTITY)
+        acc = _combine(acc, x, OP)
+    tl.store(Partials + pid, _reduce(acc, OP))
+    tl.debug_barrier()
+    count = tl.atomic_add(Counter, 1, sem="acq_rel")
+    # the last program done reduces the partials of all the programs, and
+    # resets the counter for the next launch
+    if count == num_programs - 1:
+        offs = tl.arange(0, PARTIALS_BLOCK)
+        mask = offs < num_programs
+        partials = tl.load(Partials + offs, mask=mask, volatile=True)
+        partials = tl.where(mask, partials, IDENTITY)
+        tl.store(Y, _reduce(partials, OP).to(Y.dtype.element_ty))
+        tl.store(Counter, 0)
+
+
+# counters of the programs done, per device and stream: they are left at 0 by
+# every launch, so launches on one stream can share them, but concurrent
+# launches on other streams can't
+_counters = {}
+
+
+def global_reduce(x, op="sum", block=4096, num_warps=8):
+    """Reduction of all the elements of :code:`x` to a scalar, in a single
+    launch and with a result that does not change from run to run.
+
+    :code:`op` is one of "sum", "max" and "min". Each program reduces a fixed
+    set of tiles of :code:`block` elements to a partial in a workspace, then
+    counts itself done with an atomic; the last program done reduces the
+    partials. The number of programs only depends on the number of elements
+    and on the device, so sums are always evaluated in the same order, unlike
+    sums accumulated with :code:`tl.atomic_add`.
+
+    Float64 values are accumulated in float64, the other floating-point
+    values in float32 and integers in int64.
+    The result is a 0-d tensor of the dtype of :code:`x`, or int64 for sums
+    of integers, as for :code:`torch.sum`.
+    """
+    assert op in ("sum", "max", "min"), f"unsupported reduction {op}"
+    x_flat = x.contiguous().view(-1)
+    n = x_flat.numel()
+    assert n > 0 or op == "sum", f"{op} of an empty tensor"
+    if x.is_floating_point():
+        acc_dtype = torch.float64 if x.dtype == torch.float64 else torch.float32
+        identity = {"sum": 0., "max": float("-inf"), "min": float("inf")}[op]
+    else:
+        acc_dtype = torch.int64
+        identity = {"sum": 0, "max": torch.iinfo(x.dtype).min, "min": torch.iinfo(x.dtype).max}[op]
+    out_dtype = torch.int64 if op == "sum" and not x.is_floating_point() else x.dtype
+    if n == 0:
+        return torch.zeros((), device=x.device, dtype=out_dtype)
+    # a few programs per SM: enough to fill the device, few enough that the
+    # partials fit in the tile of the last program
+    num_sms = torch.cuda.get_device_properties(x.device).multi_processor_count
+    num_programs = min(cdiv(n, block), 4 * num_sms)
+    # every program writes its partial and the last one `y`: no fills needed
+    y = torch.empty((), device=x.device, dtype=out_dtype)
+    partials = torch.empty(num_programs, device=x.device, dtype=acc_dtype)
+    key = (x.device, torch.cuda.current_stream(x.device).cuda_stream)
+    if key not in _counters:
+        _counters[key] = torch.zeros(1, device=x.device, dtype=torch.int32)
+    _kernel[(num_programs, )](x_flat, y, partials, _counters[key], n,
+                              OP=op, IDENTITY=identity,
+                              BLOCK=block, PARTIALS_BLOCK=next_power_of_2(num_programs),
+                              num_warps=num_warps)
+    return y
@@ -0,0 +1,83 @@
+import torch
+
+from .. import cdiv, jit
+from .. import language as tl
+
+# status of the tiles of a scan, in the flags of the tiles
+_INVALID = 0
+_AGGREGATE = 1
+_PREFIX = 2
+
+
+@jit
+def _kernel(X, Y, Aggregates, Prefixes, Flags, Counter, N,
+            BLOCK: tl.constexpr):
+    # tiles are numbered in the order in which programs start, so that the
+    # tiles a program looks back at belong to programs that already run
+    tile = tl.atomic_add(Counter, 1)
+    offs = tile * BLOCK + tl.arange(0, BLOCK)
+    x = tl.load(X + offs, mask=offs < N, other=0)
+    x = x.to(Aggregates.dtype.element_ty)
+    y = tl.cumsum(x, 0)
+    aggregate = tl.sum(x, 0)
+    prefix = 0
+    prefix = prefix.to(Aggregates.dtype.element_ty)
+    if tile > 0:
+        # publish the aggregate of the tile, so that the next tiles do not
+        # have to wait for its prefix
+        tl.store(Aggregates + tile, aggregate)
+        tl.debug_barrier()
+        tl.atomic_xchg(Flags + tile, _AGGREGATE, sem="release")
+        # decoupled look-back: add the aggregates of the previous tiles until
+        # one of them has published its inclusive prefix
+        prev = tile - 1
+        while prev >= 0:
+            status = tl.atomic_or(Flags + prev, 0, sem="acquire")
+            while status == _INVALID:
+                status = tl.atomic_or(Flags + prev, 0, sem="acquire")
+            if status == _PREFIX:
+                prefix += tl.load(Prefixes + prev, volatile=True)
+                prev = -1
+            else:
+                prefix += tl.load(Aggregates + prev, volatile=True)
+                prev -= 1
+    tl.store(Prefixes + tile, prefix + aggregate)
+    tl.debug_barrier()
+    tl.atomic_xchg(Flags + tile, _PREFIX, sem="release")
+    y += prefix
+    tl.store(Y + offs, y.to(Y.dtype.element_ty), mask=offs < N)
+
+
+def cumsum(x, block=1024, num_warps=4):
+    """Inclusive prefix sum of all the elements of :code:`x`, in a single
+    pass over the device.
+
+    Each program scans a tile of :code:`block` elements and adds the sum of
+    the previous tiles, which it gathers with a decoupled look-back: tiles
+    publish their aggregate as soon as it is known, and their inclusive
+    prefix once they have looked back, in per-tile status flags in global
+    memory. Elements are read and written once.
+
+    Sums are accumulated in float64 for float64 inputs, in float32 for the
+    other floating-point inputs and in int64 for integer inputs.
+    The result has the shape and dtype of :code:`x`.
+    """
+    x_flat = x.contiguous().view(-1)
+    y = torch.empty_like(x_flat)
+    n = x_flat.numel()
+    if n == 0:
+        return y.view(x.shape)
+    if x.dtype == torch.float64:
+        acc_dtype = torch.float64
+    elif x.is_floating_point():
+        acc_dtype = torch.float32
+    else:
+        acc_dtype = torch.int64
+    num_tiles = cdiv(n, block)
+    aggregates = torch.empty(num_tiles, device=x.device, dtype=acc_dtype)
+    prefixes = torch.empty(num_tiles, device=x.device, dtype=acc_dtype)
+    flags = torch.zeros(num_tiles, device=x.device, dtype=torch.int32)
+    counter = torch.zeros(1, device=x.device, dtype=torch.int32)
+    _kernel[(num_tiles, )](x_flat, y, aggregates, prefixes, flags, counter, n,
+                           BLOCK=block, num_warps=num_warps)
+    return y.view(x.shape)
@@ -0,0 +1,135 @@
+import torch
+
+from .. import Config, autotune, cdiv, heuristics, jit
+from .. import language as tl
+
+
+def compress_2_4(a):
+    """Prunes the rows of :code:`a` to 2:4 sparsity and compresses them.
+
+    The two elements of largest magnitude of every four consecutive elements
+    of a row are kept. Returns them as a tensor of shape (M, K / 2), and
+    their positions as the int16 metadata of shape (M, K / 16) expected by
+    :code:`tl.sparse_dot`.
+    """
+    M, K = a.shape
+    assert K % 16 == 0, "the number of columns must be a multiple of 16"
+    groups = a.view(M, K // 4, 4)
+    idx = groups.abs().topk(2, dim=-1).indices.sort(dim=-1).values
+    values = groups.gather(-1, idx).reshape(M, K // 2)
+    # 4 bits per group of four, 4 groups per int16
+    bits = (idx[..., 0] | (idx[..., 1] << 2)).view(M, K // 16, 4).to(torch.int32)
+    shifts = torch.arange(0, 16, 4, device=a.device, dtype=torch.int32)
+    meta = (bits << shifts).sum(dim=-1, dtype=torch.int32)
+    meta = torch.where(meta >= 1 << 15, meta - (1 << 16), meta).to(torch.int16)
+    return values.contiguous(), meta.contiguous()
+
+
+def decompress_2_4(values, meta):
+    """The dense tensor of which :code:`values` and :code:`meta` are the
+    :code:`compress_2_4` compression."""
+    M, K = values.shape[0], values.shape[1] * 2
+    meta = meta.to(torch.int32) & 0xffff
+    shifts = torch.arange(0, 16, 2, device=meta.device, dtype=torch.int32)
+    idx = ((meta[..., None] >> shifts) & 3).view(M, K // 4, 2).to(torch.int64)
+    dense = torch.zeros((M, K // 4, 4), device=values.device, dtype=values.dtype)
+    dense.scatter_(-1, idx, values.view(M, K // 4, 2))
+    return dense.view(M, K)
+
+
+@autotune(
+    configs=[
+        Config({'BLOCK_M': 128, 'BLOCK_N': 128, 'BLOCK_K': 64}, num_stages=3, num_warps=4),
+        Config({'BLOCK_M': 128, 'BLOCK_N': 64, 'BLOCK_K': 64}, num_stages=4, num_warps=4),
+        Config({'BLOCK_M': 64, 'BLOCK_N': 128, 'BLOCK_K': 64}, num_stages=4, num_warps=4),
+        Config({'BLOCK_M': 64, 'BLOCK_N': 64, 'BLOCK_K': 64}, num_stages=4, num_warps=4),
+        Config({'BLOCK_M': 128, 'BLOCK_N': 256, 'BLOCK_K': 32}, num_stages=3, num_warps=8),
+        Config({'BLOCK_M': 64, 'BLOCK_N': 32, 'BLOCK_K': 64}, num_stages=5, num_warps=2),
+    ],
+    key=['M', 'N', 'K'],
+)
+@heuristics({
+    'EVEN_K': lambda args: args['K'] % args['BLOCK_K'] == 0,
+})
+@jit
+def _kernel(A, Meta, B, C, M, N, K,
+            stride_am, stride_ak,
+            stride_metam, stride_metak,
+            stride_bk, stride_bn,
+            stride_cm, stride_cn,
+            BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr,
+            GROUP_M: tl.constexpr, EVEN_K: tl.constexpr,
+            ):
+    pid = tl.program_id(0)
+    grid_m = tl.cdiv(M, BLOCK_M)
+    grid_n = tl.cdiv(N, BLOCK_N)
+    # re-order program ID for better L2 performance
+    width = GROUP_M * grid_n
+    group_id = pid // width
+    group_size = min(grid_m - group_id * GROUP_M, GROUP_M)
+    pid_m = group_id * GROUP_M + (pid % group_size)
+    pid_n = (pid % width) // (group_size)
+    rm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
+    rn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
+    ram = tl.max_contiguous(tl.multiple_of(rm % M, BLOCK_M), BLOCK_M)
+    rbn = tl.max_contiguous(tl.multiple_of(rn % N, BLOCK_N), BLOCK_N)
+    # columns of the compressed A, of its metadata and rows of B
+    rak = tl.arange(0, BLOCK_K // 2)
+    rmetak = tl.arange(0, BLOCK_K // 16)
+    rk = tl.arange(0, BLOCK_K)
+    A = A + (ram[:, None] * stride_am + rak[None, :] * stride_ak)
+    Meta = Meta + (ram[:, None] * stride_metam + rmetak[None, :] * stride_metak)
+    B = B + (rk[:, None] * stride_bk + rbn[None, :] * stride_bn)
+    acc = tl.zeros((BLOCK_M, BLOCK_N), dtype=tl.float32)
+    for k in range(0, tl.cdiv(K, BLOCK_K)):
+        if EVEN_K:
+            a = tl.load(A)
+            meta = tl.load(Meta)
+            b = tl.load(B)
+        else:
+            # masked columns of A are zeros, at the first two positions of
+            # their groups of four (0x4444)
+            k_remaining = K - k * BLOCK_K
+            a = tl.load(A, mask=rak[None, :] < k_remaining // 2, other=0.)
+            meta = tl.load(Meta, mask=rmetak[None, :] < k_remaining // 16, other=0x4444)
+            b = tl.load(B, mask=rk[:, None] < k_remaining, other=0.)
+        acc += tl.sparse_dot(a, b, meta)
+        A += BLOCK_K // 2 * stride_ak
+        Meta += BLOCK_K // 16 * stride_metak
+        B += BLOCK_K * stride_bk
+    acc = acc.to(C.dtype.element_ty)
+    C = C + (rm[:, None] * stride_cm + rn[None, :] * stride_cn)
+    mask = (rm < M)[:, None] & (rn < N)[None, :]
+    tl.store(C, acc, mask=mask)
+
+
+def sparse_matmul(a, meta, b):
+    """Product of the 2:4 sparse matrix compressed by :code:`compress_2_4`
+    into :code:`a` and :code:`meta`, and the dense matrix :code:`b`.
+
+    Runs on the sparse tensor cores of compute capability 8.0 and later, for
+    float16 and bfloat16 inputs, with float32 accumulation. The inner
+    dimension must be a multiple of 16.
+    """
+    device = a.device
+    assert a.dtype == b.dtype and a.dtype in (torch.float16, torch.bfloat16), \
+        "sparse_matmul supports float16 and bfloat16 inputs of the same type"
+    assert torch.cuda.get_device_capability(device)[0] >= 8, \
+        "sparse_matmul requires compute capability 8.0 or later"
+    M, K = a.shape[0], a.shape[1] * 2
+    assert b.shape[0] == K, "incompatible dimensions"
+    assert meta.shape == (M, K // 16) and meta.dtype == torch.int16, \
+        "the metadata must be the int16 tensor of shape (M, K / 16) of compress_2_4"
+    assert K % 16 == 0, "the inner dimension must be a multiple of 16"
+    N = b.shape[1]
+    c = torch.empty((M, N), device=device, dtype=a.dtype)
+
+    def grid(META):
+        return (cdiv(M, META['BLOCK_M']) * cdiv(N, META['BLOCK_N']), )
+    _kernel[grid](a, meta, b, c, M, N, K,
+                  a.stride(0), a.stride(1),
+                  meta.stride(0), meta.stride(1),
+                  b.stride(0), b.stride(1),
+                  c.stride(0), c.stride(1),
+                  GROUP_M=8)
+    return c
@@ -1,8 +1,11 @@
-from .autotuner import (Autotuner, Config, Heuristics, OutOfResources, autotune,
-                        heuristics)
+from .autotuner import (Autotuner, Config, CostModelTopK, Exhaustive, Heuristics, OutOfResources,
+                        SearchStrategy, SuccessiveHalving, autotune, heuristics)
 from .driver import driver
+from .graph import KernelGraph
 from .jit import (JITFunction, KernelInterface, MockTensor, TensorWrapper, reinterpret,
-                  version_key)
+                  version_key, warmup_from_manifest)
+from . import tracing
+from .print_buffer import PrintBuffer, flush_print_buffer
 
 __all__ = [
     "driver",
@@ -11,11 +14,20 @@ __all__ = [
     "autotune",
     "heuristics",
     "JITFunction",
+    "KernelGraph",
     "KernelInterface",
     "version_key",
     "reinterpret",
     "TensorWrapper",
     "OutOfResources",
     "MockTensor",
+    "PrintBuffer",
+    "flush_print_buffer",
+    "tracing",
     "Autotuner",
+    "SearchStrategy",
+    "Exhaustive",
+    "CostModelTopK",
+    "SuccessiveHalving",
+    "warmup_from_manifest",
 ]
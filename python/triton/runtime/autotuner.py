@@ -1,11 +1,16 @@
 from __future__ import annotations
 
 import builtins
+import contextvars
+import math
+import os
 import time
+from concurrent.futures import ThreadPoolExecutor
 from typing import Dict
 
 from ..testing import do_bench
-from .jit import KernelInterface
+from .jit import JITFunction, KernelInterface, get_current_device
+from .tuning_db import TuningDatabase, config_matches, config_to_json, device_fingerprint
 
 
 class OutOfResources(Exception):
@@ -24,20 +29,53 @@ class OutOfResources(Exception):
         return (type(self), (self.required, self.limit, self.name))
 
 
+# Set while an autotuner compiles its configs with `prune_spilling`: compilation
+# then stops after TTGIR, raising `OutOfResources`, when the estimated register
+# pressure of the kernel exceeds the register budget of its threads
+prune_spilling = contextvars.ContextVar("prune_spilling", default=False)
+
+
 class Autotuner(KernelInterface):
-    def __init__(self, fn, arg_names, configs, key, reset_to_zero, prune_configs_by: Dict = None, warmup=25, rep=100):
+    def __init__(self, fn, arg_names, configs, key, reset_to_zero, prune_configs_by: Dict = None, warmup=25, rep=100, parallel_compile=False,
+                 persistent=None, search=None, multi_device=None, prune_spilling=False, prune_occupancy=False,
+                 max_spills=None, early_stop=None, key_buckets=None, tune_in_background=False):
         '''
         :param prune_configs_by: a dict of functions that are used to prune configs, fields:
             'perf_model': performance model used to predicate running time with different configs, returns running time
             'top_k': number of configs to bench
             'prune_num_stages_by'(optional): a function used to prune num_stages. It takes configs:List[Config] as its input, and returns pruned configs.
+        :param parallel_compile: if True (or a number of worker threads), compile all pruned configs concurrently
+            before benchmarking any of them.
+        :param persistent: store tuning results in a `TuningDatabase` and reuse them across processes. Defaults to
+            the `TRITON_AUTOTUNE_PERSISTENT` environment variable.
+        :param search: the `SearchStrategy` deciding which configs are benchmarked, and for how long;
+            defaults to benchmarking every pruned config.
+        :param multi_device: spread the benchmarking of configs over all visible devices identical to the
+            current one. Defaults to the `TRITON_AUTOTUNE_MULTI_DEVICE` environment variable.
+        :param prune_spilling: skip the configs predicted to spill registers, before generating their code.
+        :param prune_occupancy: skip the compiled configs of which no CTA fits on an SM.
+        :param max_spills: skip the compiled configs spilling more 32-bit registers per thread than this.
+        :param early_stop: stop benchmarking a config once it is certainly slower than the fastest config benchmarked
+            so far. Defaults to the `TRITON_AUTOTUNE_EARLY_STOP` environment variable.
+        :param key_buckets: how the integer values of `key` are bucketed before looking up tuned configs: "pow2",
+            a sorted list of bucket upper bounds, a function of the value, or a dict of those by key name.
+        :param tune_in_background: tune new buckets on a background thread, while the config of the nearest tuned
+            bucket serves the calls.
         '''
         if not configs:
             self.configs = [Config({}, num_warps=4, num_stages=2)]
         else:
             self.configs = configs
         self.key_idx = [arg_names.index(k) for k in key]
+        if isinstance(key_buckets, dict):
+            self.key_buckets = [key_buckets.get(k) for k in key]
+        else:
+            self.key_buckets = [key_buckets] * len(key)
         self.cache = {}
+        self.tune_in_background = tune_in_background
+        self._pending = set()
+        self._background = None
+        self._background_error = None
         # hook to reset all required tensor to zeros before relaunching a kernel
         self.hook = lambda args: 0
         if reset_to_zero is not None:
@@ -60,8 +98,76 @@ class Autotuner(KernelInterface):
         self.fn = fn
         self.warmup = warmup
         self.rep = rep
-
-    def _bench(self, *args, config, **meta):
+        self.parallel_compile = parallel_compile
+        if persistent is None:
+            persistent = os.environ.get("TRITON_AUTOTUNE_PERSISTENT", "0") == "1"
+        self.tuning_db = TuningDatabase() if persistent else None
+        self.search = search if search is not None else Exhaustive()
+        if multi_device is None:
+            multi_device = os.environ.get("TRITON_AUTOTUNE_MULTI_DEVICE", "0") == "1"
+        self.multi_device = multi_device
+        self.prune_spilling = prune_spilling
+        self.prune_occupancy = prune_occupancy
+        self.max_spills = max_spills
+        if early_stop is None:
+            early_stop = os.environ.get("TRITON_AUTOTUNE_EARLY_STOP", "0") == "1"
+        self.early_stop = early_stop
+
+    def _run_config(self, *args, **kwargs):
+        token = prune_spilling.set(self.prune_spilling)
+        try:
+            return self.fn.run(*args, **kwargs)
+        finally:
+            prune_spilling.reset(token)
+
+    def _fits_resources(self, bin):
+        # whether a compiled config passes `prune_occupancy` and `max_spills`
+        report = bin.resource_report()
+        if self.prune_occupancy and report["occupancy"] is not None and report["occupancy"]["ctas_per_sm"] == 0:
+            return False
+        return self.max_spills is None or report["spills"] <= self.max_spills
+
+    def _tuning_key(self, key):
+        jit_fn = self.fn
+        while not isinstance(jit_fn, JITFunction):
+            jit_fn = jit_fn.fn
+        device = device_fingerprint(get_current_device())
+        return TuningDatabase.make_key(jit_fn.cache_key, device, key, self.configs)
+
+    def _load_tuned(self, key):
+        entry = self.tuning_db.get(self._tuning_key(key))
+        if entry is None:
+            return None
+        for config in self.configs:
+            if config_matches(config, entry["config"]):
+                return config
+        return None
+
+    def _store_tuned(self, key, best, timings):
+        entry = {"kernel": self.fn.__name__,
+                 "device": device_fingerprint(get_current_device()),
+                 "key": repr(key),
+                 "config": config_to_json(best),
+                 "timings": [{"config": config_to_json(config), "ms": timing} for config, timing in timings.items()]}
+        self.tuning_db.put(self._tuning_key(key), entry)
+
+    def _precompile(self, *args, configs, **meta):
+        def compile_config(config):
+            if meta.keys() & config.kwargs.keys():
+                return
+            current = dict(meta, **config.kwargs)
+            try:
+                self._run_config(*args, num_warps=config.num_warps, num_stages=config.num_stages, warmup=True,
+                                 **current)
+            except Exception:
+                # the error is raised again, and reported, when `_bench`
+                # compiles this config on the main thread
+                pass
+        max_workers = None if self.parallel_compile is True else self.parallel_compile
+        with ThreadPoolExecutor(max_workers=max_workers) as executor:
+            list(executor.map(compile_config, configs))
+
+    def _bench(self, *args, config, _rep=None, _nargs=None, _bencher=None, **meta):
         # check for conflicts, i.e. meta-parameters both provided
         # as kwargs and by the autotuner
         conflicts = meta.keys() & config.kwargs.keys()
@@ -72,19 +178,32 @@ class Autotuner(KernelInterface):
             )
         # augment meta-parameters with tunable ones
         current = dict(meta, **config.kwargs)
-        full_nargs = {**self.nargs, **current}
+        full_nargs = {**(self.nargs if _nargs is None else _nargs), **current}
 
         def kernel_call():
             if config.pre_hook:
                 config.pre_hook(full_nargs)
             self.hook(args)
-            self.fn.run(*args, num_warps=config.num_warps, num_stages=config.num_stages, **current)
+            self._run_config(*args, num_warps=config.num_warps, num_stages=config.num_stages, **current)
         try:
-            return do_bench(kernel_call, warmup=self.warmup, rep=self.rep, quantiles=(0.5, 0.2, 0.8))
+            if self.prune_occupancy or self.max_spills is not None:
+                # the binary is checked before any launch is timed
+                bin = self._run_config(*args, num_warps=config.num_warps, num_stages=config.num_stages,
+                                       warmup=True, **current)
+                if bin is not None and not self._fits_resources(bin):
+                    return [float('inf'), float('inf'), float('inf')]
+            rep = self.rep if _rep is None else _rep
+            stop_above = _bencher.best_ci_high if _bencher is not None and self.early_stop else None
+            stats = do_bench(kernel_call, warmup=min(self.warmup, rep), rep=rep, quantiles=(0.5, 0.2, 0.8),
+                             return_mode="stats", stop_above=stop_above)
+            if _bencher is not None:
+                _bencher.best_ci_high = builtins.min(_bencher.best_ci_high, stats.ci_high)
+            return stats.quantiles
         except OutOfResources:
             return [float('inf'), float('inf'), float('inf')]
 
     def run(self, *args, **kwargs):
+        self._raise_background_error()
         self.nargs = dict(zip(self.arg_names, args))
         if len(self.configs) > 1:
             all_args = {**self.nargs, **kwargs}
@@ -92,19 +211,23 @@ class Autotuner(KernelInterface):
             for name in self.arg_names:
                 if name in all_args:
                     _args.append(all_args[name])
-            key = tuple(_args[i] for i in self.key_idx)
-            if key not in self.cache:
+            key = self._bucket_key(tuple(_args[i] for i in self.key_idx))
+            if key not in self.cache and self.tuning_db is not None:
+                tuned = self._load_tuned(key)
+                if tuned is not None:
+                    self.cache[key] = tuned
+            if key in self.cache:
+                config = self.cache[key]
+            else:
                 # prune configs
                 pruned_configs = self.prune_configs(kwargs)
-                bench_start = time.time()
-                timings = {config: self._bench(*args, config=config, **kwargs)
-                           for config in pruned_configs}
-                bench_end = time.time()
-                self.bench_time = bench_end - bench_start
-                self.cache[key] = builtins.min(timings, key=timings.get)
-                self.hook(args)
-                self.configs_timings = timings
-            config = self.cache[key]
+                nearest = self._nearest_tuned(key) if self.tune_in_background else None
+                if nearest is not None:
+                    self._tune_in_background(key, args, kwargs, pruned_configs)
+                    config = nearest
+                else:
+                    self._tune(key, args, kwargs, pruned_configs, self.nargs)
+                    config = self.cache[key]
         else:
             config = self.configs[0]
         self.best_config = config
@@ -115,6 +238,83 @@ class Autotuner(KernelInterface):
         self.nargs = None
         return ret
 
+    def _bucket_key(self, key):
+        return tuple(value if bucket is None else _bucket_value(value, bucket)
+                     for value, bucket in zip(key, self.key_buckets))
+
+    def _nearest_tuned(self, key):
+        """ the config of the tuned key closest to `key`, None if there is none """
+        nearest, nearest_distance = None, math.inf
+        for other, config in list(self.cache.items()):
+            distance = _key_distance(key, other)
+            if distance < nearest_distance:
+                nearest, nearest_distance = config, distance
+        return nearest
+
+    def _tune(self, key, args, kwargs, pruned_configs, nargs):
+        if self.parallel_compile:
+            self._precompile(*args, configs=pruned_configs, **kwargs)
+        bench_start = time.time()
+        devices = _identical_devices(get_current_device()) if self.multi_device else None
+        bench = _Bencher(self, args, kwargs, devices, nargs)
+        timings = self.search.search(pruned_configs, bench, {**nargs, **kwargs}, self.rep)
+        bench_end = time.time()
+        self.bench_time = bench_end - bench_start
+        best = builtins.min(timings, key=timings.get)
+        self.hook(args)
+        self.configs_timings = timings
+        if self.tuning_db is not None:
+            self._store_tuned(key, best, timings)
+        self.cache[key] = best
+
+    def _tune_in_background(self, key, args, kwargs, pruned_configs):
+        """
+        Tunes `key` on a worker thread and its own stream, on copies of the
+        tensor arguments taken now, so that the benchmarks neither race with
+        nor block the caller's kernels. Their timings are less precise, as
+        they share the device with the caller's work. An exception of the
+        tuning is raised by the next call, and `key` is tuned again then.
+        """
+        import torch
+        if key in self._pending:
+            return
+        self._pending.add(key)
+        copy = lambda arg: arg.clone() if isinstance(arg, torch.Tensor) else arg
+        args = tuple(copy(arg) for arg in args)
+        kwargs = {name: copy(arg) for name, arg in kwargs.items()}
+        nargs = dict(zip(self.arg_names, args))
+        device = get_current_device()
+        stream = torch.cuda.Stream(device)
+        stream.wait_stream(torch.cuda.current_stream(device))
+
+        def tune():
+            try:
+                with torch.cuda.device(device), torch.cuda.stream(stream):
+                    self._tune(key, args, kwargs, pruned_configs, nargs)
+                    stream.synchronize()
+            except BaseException as e:
+                if self._background_error is None:
+                    self._background_error = e
+            finally:
+                self._pending.discard(key)
+        if self._background is None:
+            self._background = ThreadPoolExecutor(max_workers=1)
+        self._background.submit(tune)
+
+    def _raise_background_error(self):
+        error, self._background_error = self._background_error, None
+        if error is not None:
+            raise error
+
+    def wait_for_tuning(self):
+        """
+        Waits for the tunings started in the background, and raises the
+        first exception of those not raised by a call yet.
+        """
+        if self._background is not None:
+            self._background.submit(lambda: None).result()
+        self._raise_background_error()
+
     def prune_configs(self, kwargs):
         pruned_configs = self.configs
         if self.early_config_prune:
@@ -145,6 +345,36 @@ class Autotuner(KernelInterface):
         self.nargs = None
 
 
+def _bucket_value(value, bucket):
+    """ the bucket of an integer `value` of a key, see `autotune`'s `key_buckets` """
+    if isinstance(value, bool) or not isinstance(value, int):
+        return value
+    if bucket == "pow2":
+        return 1 << builtins.max(value - 1, 0).bit_length()
+    if callable(bucket):
+        return bucket(value)
+    for bound in bucket:
+        if value <= bound:
+            return bound
+    return math.inf
+
+
+def _key_distance(a, b):
+    """ how far apart two bucketed keys are: the sum of the log2 ratios of their numbers """
+    if len(a) != len(b):
+        return math.inf
+    distance = 0
+    for x, y in zip(a, b):
+        if x == y:
+            continue
+        numbers = isinstance(x, (int, float)) and isinstance(y, (int, float)) and \
+            not isinstance(x, bool) and not isinstance(y, bool)
+        if not numbers or x <= 0 or y <= 0 or math.isinf(x) or math.isinf(y):
+            return math.inf
+        distance += abs(math.log2(x) - math.log2(y))
+    return distance
+
+
 class Config:
     """
     An object that represents a possible kernel configuration for the auto-tuner to try.
@@ -153,11 +383,14 @@ class Config:
     :type meta: dict[Str, Any]
     :ivar num_warps: the number of warps to use for the kernel when compiled for GPUs. For example, if
                       `num_warps=8`, then each kernel instance will be automatically parallelized to
-                      cooperatively execute using `8 * 32 = 256` threads.
-    :type num_warps: int
+                      cooperatively execute using `8 * 32 = 256` threads. With `num_warps="auto"`, it is
+                      picked from the largest dot or tensor of the kernel.
+    :type num_warps: int or str
     :ivar num_stages: the number of stages that the compiler should use when software-pipelining loops.
-                       Mostly useful for matrix multiplication workloads on SM80+ GPUs.
-    :type num_stages: int
+                       Mostly useful for matrix multiplication workloads on SM80+ GPUs. With
+                       `num_stages="auto"`, every loop gets as many stages as fit in the shared memory
+                       of the device.
+    :type num_stages: int or str
     :ivar pre_hook: a function that will be called before the kernel is called. Parameters of this
                     function are args.
     """
@@ -177,7 +410,156 @@ class Config:
         return ', '.join(res)
 
 
-def autotune(configs, key, prune_configs_by=None, reset_to_zero=None, warmup=25, rep=100):
+def _identical_devices(device):
+    """ `device` followed by all other visible devices of the same model """
+    import torch
+    props = torch.cuda.get_device_properties(device)
+    devices = [device]
+    for other in range(torch.cuda.device_count()):
+        if other == device:
+            continue
+        other_props = torch.cuda.get_device_properties(other)
+        if (other_props.name, other_props.major, other_props.minor, other_props.total_memory) == \
+                (props.name, props.major, props.minor, props.total_memory):
+            devices.append(other)
+    return devices
+
+
+def _to_device(arg, device):
+    import torch
+    if isinstance(arg, torch.Tensor) and arg.is_cuda:
+        return arg.to(device)
+    return arg
+
+
+class _Bencher:
+    """
+    Benchmarks configs with the arguments of one autotuner call. `map` splits
+    its configs over `devices`, benchmarking in one thread per device on
+    copies of the tensor arguments, so that each device compiles and times
+    its own share. With the autotuner's `early_stop`, the configs benchmarked
+    on the current device stop once the confidence interval of their median
+    runtime lies above that of the fastest one so far.
+    """
+
+    def __init__(self, autotuner, args, kwargs, devices=None, nargs=None):
+        self.autotuner = autotuner
+        self.args = args
+        self.kwargs = kwargs
+        self.devices = devices or []
+        self.nargs = nargs
+        self.best_ci_high = float('inf')
+
+    def __call__(self, config, rep=None):
+        return self.autotuner._bench(*self.args, config=config, _rep=rep, _nargs=self.nargs, _bencher=self,
+                                     **self.kwargs)
+
+    def _bench_on(self, device, configs, rep):
+        import torch
+        if device == self.devices[0]:
+            return {config: self(config, rep) for config in configs}
+        with torch.cuda.device(device):
+            args = tuple(_to_device(arg, device) for arg in self.args)
+            kwargs = {name: _to_device(arg, device) for name, arg in self.kwargs.items()}
+            nargs = dict(zip(self.autotuner.arg_names, args))
+            timings = {config: self.autotuner._bench(*args, config=config, _rep=rep, _nargs=nargs, **kwargs)
+                       for config in configs}
+            torch.cuda.synchronize()
+        return timings
+
+    def map(self, configs, rep=None):
+        """ the timings of all `configs`, benchmarked for `rep` ms """
+        configs = list(configs)
+        num_devices = builtins.min(len(self.devices), len(configs))
+        if num_devices <= 1:
+            return {config: self(config, rep) for config in configs}
+        shards = [configs[i::num_devices] for i in range(num_devices)]
+        # the current device is per thread: the share of the current device
+        # is benchmarked on the calling thread, the others in worker threads
+        with ThreadPoolExecutor(max_workers=num_devices - 1) as executor:
+            futures = [executor.submit(self._bench_on, device, shard, rep)
+                       for device, shard in zip(self.devices[1:], shards[1:])]
+            results = self._bench_on(self.devices[0], shards[0], rep)
+            for future in futures:
+                results.update(future.result())
+        return {config: results[config] for config in configs}
+
+
+class SearchStrategy:
+    """
+    Decides which configs the autotuner benchmarks, and for how long.
+
+    `search` gets the candidate configs, a `bench` object, the kernel's
+    arguments by name, and the autotuner's `rep`. `bench(config, rep=None)`
+    returns the [median, p20, p80] runtime of a config when benchmarked for
+    `rep` ms (the autotuner's `rep` by default); `bench.map(configs, rep=None)`
+    returns a dict of such timings and may benchmark configs concurrently on
+    several devices. `search` returns the timings of the configs the best one
+    should be picked from.
+    """
+
+    def search(self, configs, bench, nargs, rep):
+        raise NotImplementedError
+
+
+class Exhaustive(SearchStrategy):
+    """ benchmarks every config """
+
+    def search(self, configs, bench, nargs, rep):
+        return bench.map(configs)
+
+
+class CostModelTopK(SearchStrategy):
+    """
+    Ranks configs by `perf_model` (called like the `perf_model` of
+    `prune_configs_by`, with the kernel's arguments, the config's
+    meta-parameters, num_warps and num_stages) and only benchmarks the
+    `top_k` most promising ones; a float `top_k` <= 1 is a fraction of the
+    configs.
+    """
+
+    def __init__(self, perf_model, top_k):
+        self.perf_model = perf_model
+        self.top_k = top_k
+
+    def search(self, configs, bench, nargs, rep):
+        top_k = self.top_k
+        if isinstance(top_k, float) and top_k <= 1.0:
+            top_k = max(1, int(len(configs) * top_k))
+        estimates = {config: self.perf_model(**nargs, **config.kwargs, num_stages=config.num_stages,
+                                             num_warps=config.num_warps)
+                     for config in configs}
+        ranked = sorted(configs, key=lambda config: estimates[config])
+        return bench.map(ranked[:top_k])
+
+
+class SuccessiveHalving(SearchStrategy):
+    """
+    Benchmarks all configs briefly (`min_rep` ms), keeps the fastest
+    1 / `eta` of them, and repeats with `eta` times longer runs until a
+    single config is left or the runs reach the autotuner's `rep`; the
+    survivors of the last round are then ranked on full-length runs.
+    """
+
+    def __init__(self, min_rep=5, eta=2):
+        assert eta > 1
+        self.min_rep = min_rep
+        self.eta = eta
+
+    def search(self, configs, bench, nargs, rep):
+        survivors = list(configs)
+        round_rep = self.min_rep
+        while len(survivors) > 1 and round_rep < rep:
+            timings = bench.map(survivors, round_rep)
+            keep = max(1, -(-len(survivors) // self.eta))
+            survivors = sorted(survivors, key=lambda config: timings[config])[:keep]
+            round_rep *= self.eta
+        return bench.map(survivors)
+
+
+def autotune(configs, key, prune_configs_by=None, reset_to_zero=None, warmup=25, rep=100, parallel_compile=False,
+             persistent=None, search=None, multi_device=None, prune_spilling=False, prune_occupancy=False,
+             max_spills=None, early_stop=None, key_buckets=None, tune_in_background=False):
     """
     Decorator for auto-tuning a :code:`triton.jit`'d function.
 
@@ -212,9 +594,49 @@ def autotune(configs, key, prune_configs_by=None, reset_to_zero=None, warmup=25,
     :type warmup: int
     :param rep: Repetition time (in ms) to pass to benchmarking, defaults to 100.
     :type rep: int
+    :param parallel_compile: compile all the configs on a thread pool before benchmarking them. Either a bool,
+                             or the number of worker threads to use.
+    :type parallel_compile: bool or int
+    :param persistent: reuse tuning results across processes through an on-disk (and optionally remote)
+                       `TuningDatabase`, keyed by kernel, device, driver and tuning key. Defaults to
+                       the `TRITON_AUTOTUNE_PERSISTENT` environment variable.
+    :type persistent: bool
+    :param search: how to explore the pruned configs, e.g. :code:`triton.runtime.SuccessiveHalving()`.
+                   Defaults to benchmarking all of them for `rep` ms.
+    :type search: triton.runtime.SearchStrategy
+    :param multi_device: if True, benchmark configs concurrently on all visible devices identical to the current one,
+                         each device timing a share of them. Defaults to the `TRITON_AUTOTUNE_MULTI_DEVICE` environment
+                         variable.
+    :type multi_device: bool
+    :param prune_spilling: if True, configs whose register pressure, estimated on their TTGIR, exceeds the registers
+                           available to each thread are not benchmarked, and their LLVM IR and binary not generated.
+    :type prune_spilling: bool
+    :param prune_occupancy: if True, compiled configs with a theoretical occupancy of zero, i.e. whose registers or
+                            shared memory do not let a single CTA reside on an SM, are not benchmarked.
+    :type prune_occupancy: bool
+    :param max_spills: if set, compiled configs spilling more 32-bit registers per thread than this are not
+                       benchmarked.
+    :type max_spills: int
+    :param early_stop: if True, stop benchmarking a config once the confidence interval of its median runtime lies
+                       above that of the fastest config so far; its reported timings are then less precise. Defaults
+                       to the `TRITON_AUTOTUNE_EARLY_STOP` environment variable.
+    :type early_stop: bool
+    :param key_buckets: tune once per bucket of the integer values of `key`, rather than per value, so that dynamic
+                        shapes such as sequence lengths do not trigger a new tuning at every call. Either "pow2" (the
+                        next power of two), a sorted list of bucket upper bounds (values above the last bound share a
+                        bucket), a function from value to bucket, or a dict of those by argument name of `key`.
+    :type key_buckets: str, list[int], callable or dict
+    :param tune_in_background: if True, a bucket not tuned yet is tuned on a background thread, on copies of the
+                               arguments, while the calls use the config of the nearest tuned bucket. The first
+                               call, with no tuned bucket at all, is still tuned in the foreground. An exception
+                               of a background tuning is raised by the next call, or by `kernel.wait_for_tuning()`,
+                               which waits for the tunings in flight.
+    :type tune_in_background: bool
     """
     def decorator(fn):
-        return Autotuner(fn, fn.arg_names, configs, key, reset_to_zero, prune_configs_by, warmup, rep)
+        return Autotuner(fn, fn.arg_names, configs, key, reset_to_zero, prune_configs_by, warmup, rep, parallel_compile,
+                         persistent, search, multi_device, prune_spilling, prune_occupancy, max_spills, early_stop,
+                         key_buckets, tune_in_background)
 
     return decorator
 
@@ -1,6 +1,15 @@
 #include "cuda.h"
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
 
 static inline void gpuAssert(CUresult code, const char *file, int line) {
   if (code != CUDA_SUCCESS) {
@@ -21,6 +30,13 @@ static inline void gpuAssert(CUresult code, const char *file, int line) {
       return NULL;                                                             \
   }
 
+#define CUDA_CHECK_AND_GOTO(ans, label)                                        \
+  {                                                                            \
+    gpuAssert((ans), __FILE__, __LINE__);                                      \
+    if (PyErr_Occurred())                                                      \
+      goto label;                                                              \
+  }
+
 static PyObject *getDeviceProperties(PyObject *self, PyObject *args) {
   int device_id;
   if (!PyArg_ParseTuple(args, "i", &device_id))
@@ -35,6 +51,13 @@ static PyObject *getDeviceProperties(PyObject *self, PyObject *args) {
   int sm_clock_rate;
   int mem_clock_rate;
   int mem_bus_width;
+  // the resources an SM shares among its resident CTAs
+  int max_regs_per_sm;
+  int max_threads_per_sm;
+  int max_shared_mem_per_sm;
+  int max_blocks_per_sm;
+  int warp_size;
+  int l2_size;
   CUDA_CHECK(cuDeviceGetAttribute(
       &max_shared_mem, CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_BLOCK_OPTIN,
       device));
@@ -46,12 +69,48 @@ static PyObject *getDeviceProperties(PyObject *self, PyObject *args) {
       &mem_clock_rate, CU_DEVICE_ATTRIBUTE_MEMORY_CLOCK_RATE, device));
   CUDA_CHECK(cuDeviceGetAttribute(
       &mem_bus_width, CU_DEVICE_ATTRIBUTE_GLOBAL_MEMORY_BUS_WIDTH, device));
+  CUDA_CHECK(cuDeviceGetAttribute(
+      &max_regs_per_sm, CU_DEVICE_ATTRIBUTE_MAX_REGISTERS_PER_MULTIPROCESSOR,
+      device));
+  CUDA_CHECK(cuDeviceGetAttribute(
+      &max_threads_per_sm, CU_DEVICE_ATTRIBUTE_MAX_THREADS_PER_MULTIPROCESSOR,
+      device));
+  CUDA_CHECK(cuDeviceGetAttribute(
+      &max_shared_mem_per_sm,
+      CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_MULTIPROCESSOR, device));
+  CUDA_CHECK(cuDeviceGetAttribute(
+      &max_blocks_per_sm, CU_DEVICE_ATTRIBUTE_MAX_BLOCKS_PER_MULTIPROCESSOR,
+      device));
+  CUDA_CHECK(
+      cuDeviceGetAttribute(&warp_size, CU_DEVICE_ATTRIBUTE_WARP_SIZE, device));
+  CUDA_CHECK(cuDeviceGetAttribute(&l2_size, CU_DEVICE_ATTRIBUTE_L2_CACHE_SIZE,
+                                  device));
 
-  return Py_BuildValue("{s:i, s:i, s:i, s:i, s:i}", "max_shared_mem",
-                       max_shared_mem, "multiprocessor_count",
-                       multiprocessor_count, "sm_clock_rate", sm_clock_rate,
-                       "mem_clock_rate", mem_clock_rate, "mem_bus_width",
-                       mem_bus_width);
+  return Py_BuildValue(
+      "{s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i}",
+      "max_shared_mem", max_shared_mem, "multiprocessor_count",
+      multiprocessor_count, "sm_clock_rate", sm_clock_rate, "mem_clock_rate",
+      mem_clock_rate, "mem_bus_width", mem_bus_width, "max_regs_per_sm",
+      max_regs_per_sm, "max_threads_per_sm", max_threads_per_sm,
+      "max_shared_mem_per_sm", max_shared_mem_per_sm, "max_blocks_per_sm",
+      max_blocks_per_sm, "warp_size", warp_size, "l2_size", l2_size);
+}
+
+// The primary context of each device, retained when the first kernel is
+// loaded there and held until the process exits
+#define MAX_PRIMARY_CONTEXTS 64
+static CUcontext primaryContexts[MAX_PRIMARY_CONTEXTS];
+
+static CUresult getPrimaryContext(CUcontext *ctx, int device) {
+  if (device < 0 || device >= MAX_PRIMARY_CONTEXTS)
+    return CUDA_ERROR_INVALID_DEVICE;
+  if (!primaryContexts[device]) {
+    CUresult res = cuDevicePrimaryCtxRetain(&primaryContexts[device], device);
+    if (res != CUDA_SUCCESS)
+      return res;
+  }
+  *ctx = primaryContexts[device];
+  return CUDA_SUCCESS;
 }
 
 static PyObject *loadBinary(PyObject *self, PyObject *args) {
@@ -65,42 +124,68 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
     return NULL;
   }
   CUfunction fun;
-  CUmodule mod;
+  CUmodule mod = 0;
   int32_t n_regs = 0;
   int32_t n_spills = 0;
-  // create driver handles
+  // create driver handles, in the primary context of `device` whatever the
+  // current context is, so that a kernel loaded on several devices gets a
+  // module in each of their contexts
   CUcontext pctx = 0;
-  CUDA_CHECK(cuCtxGetCurrent(&pctx));
-  if (!pctx) {
-    CUDA_CHECK(cuDevicePrimaryCtxRetain(&pctx, device));
+  CUcontext current = 0;
+  CUDA_CHECK(cuCtxGetCurrent(&current));
+  CUDA_CHECK(getPrimaryContext(&pctx, device));
+  if (!current) {
     CUDA_CHECK(cuCtxSetCurrent(pctx));
+  } else if (current != pctx) {
+    CUDA_CHECK(cuCtxPushCurrent(pctx));
   }
 
-  CUDA_CHECK(cuModuleLoadData(&mod, data));
-  CUDA_CHECK(cuModuleGetFunction(&fun, mod, name));
+  CUDA_CHECK_AND_GOTO(cuModuleLoadData(&mod, data), cleanup);
+  CUDA_CHECK_AND_GOTO(cuModuleGetFunction(&fun, mod, name), cleanup);
   // get allocated registers and spilled registers from the function
-  CUDA_CHECK(cuFuncGetAttribute(&n_regs, CU_FUNC_ATTRIBUTE_NUM_REGS, fun));
-  CUDA_CHECK(
-      cuFuncGetAttribute(&n_spills, CU_FUNC_ATTRIBUTE_LOCAL_SIZE_BYTES, fun));
+  CUDA_CHECK_AND_GOTO(
+      cuFuncGetAttribute(&n_regs, CU_FUNC_ATTRIBUTE_NUM_REGS, fun), cleanup);
+  CUDA_CHECK_AND_GOTO(
+      cuFuncGetAttribute(&n_spills, CU_FUNC_ATTRIBUTE_LOCAL_SIZE_BYTES, fun),
+      cleanup);
   n_spills /= 4;
   // set dynamic shared memory if necessary
   int shared_optin;
-  CUDA_CHECK(cuDeviceGetAttribute(
-      &shared_optin, CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_BLOCK_OPTIN,
-      device));
+  CUDA_CHECK_AND_GOTO(
+      cuDeviceGetAttribute(&shared_optin,
+                           CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_BLOCK_OPTIN,
+                           device),
+      cleanup);
   if (shared > 49152 && shared_optin > 49152) {
-    CUDA_CHECK(cuFuncSetCacheConfig(fun, CU_FUNC_CACHE_PREFER_SHARED));
+    CUDA_CHECK_AND_GOTO(cuFuncSetCacheConfig(fun, CU_FUNC_CACHE_PREFER_SHARED),
+                        cleanup);
     int shared_total, shared_static;
-    CUDA_CHECK(cuDeviceGetAttribute(
-        &shared_total, CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_MULTIPROCESSOR,
-        device));
-    CUDA_CHECK(cuFuncGetAttribute(&shared_static,
-                                  CU_FUNC_ATTRIBUTE_SHARED_SIZE_BYTES, fun));
-    CUDA_CHECK(
+    CUDA_CHECK_AND_GOTO(
+        cuDeviceGetAttribute(
+            &shared_total,
+            CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_MULTIPROCESSOR, device),
+        cleanup);
+    CUDA_CHECK_AND_GOTO(cuFuncGetAttribute(&shared_static,
+                                           CU_FUNC_ATTRIBUTE_SHARED_SIZE_BYTES,
+                                           fun),
+                        cleanup);
+    CUDA_CHECK_AND_GOTO(
         cuFuncSetAttribute(fun, CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,
-                           shared_optin - shared_static));
+                           shared_optin - shared_static),
+        cleanup);
   }
 
+cleanup:
+  // on error, unload the module and restore the current context, keeping
+  // the error that brought us here
+  if (PyErr_Occurred() && mod)
+    cuModuleUnload(mod);
+  if (current && current != pctx) {
+    if (PyErr_Occurred())
+      cuCtxPopCurrent(NULL);
+    else
+      CUDA_CHECK(cuCtxPopCurrent(NULL));
+  }
   if (PyErr_Occurred()) {
     return NULL;
   }
@@ -108,11 +193,723 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
                        n_spills);
 }
 
+// Copies `data` to the start of the global variable `name` of a module
+static PyObject *writeGlobal(PyObject *self, PyObject *args) {
+  uint64_t module;
+  const char *name;
+  const char *data;
+  Py_ssize_t data_size;
+  if (!PyArg_ParseTuple(args, "Ksy#", &module, &name, &data, &data_size))
+    return NULL;
+  CUdeviceptr ptr;
+  size_t size;
+  CUDA_CHECK(cuModuleGetGlobal(&ptr, &size, (CUmodule)module, name));
+  if ((size_t)data_size > size) {
+    PyErr_SetString(PyExc_ValueError, "data is larger than the global");
+    return NULL;
+  }
+  CUDA_CHECK(cuMemcpyHtoD(ptr, data, data_size));
+  Py_RETURN_NONE;
+}
+
+// Kernel nodes take their arguments as a single packed buffer laid out as in
+// the kernel's parameter space; the driver copies it into the node.
+static CUDA_KERNEL_NODE_PARAMS makeKernelNodeParams(
+    uint64_t function, int gridX, int gridY, int gridZ, int num_warps,
+    int shared, void **extra) {
+  CUDA_KERNEL_NODE_PARAMS params;
+  memset(&params, 0, sizeof(params));
+  params.func = (CUfunction)function;
+  params.gridDimX = gridX;
+  params.gridDimY = gridY;
+  params.gridDimZ = gridZ;
+  params.blockDimX = 32 * num_warps;
+  params.blockDimY = 1;
+  params.blockDimZ = 1;
+  params.sharedMemBytes = shared;
+  params.kernelParams = NULL;
+  params.extra = extra;
+  return params;
+}
+
+static PyObject *graphCreate(PyObject *self, PyObject *args) {
+  CUgraph graph;
+  CUDA_CHECK(cuGraphCreate(&graph, 0));
+  return PyLong_FromUnsignedLongLong((uint64_t)graph);
+}
+
+static PyObject *graphAddKernelNode(PyObject *self, PyObject *args) {
+  uint64_t graph, function, dependency;
+  int gridX, gridY, gridZ, num_warps, shared, clusterX, clusterY, clusterZ;
+  const char *data;
+  Py_ssize_t data_size;
+  if (!PyArg_ParseTuple(args, "KKKiiiiiiiiy#", &graph, &dependency, &function,
+                        &gridX, &gridY, &gridZ, &num_warps, &shared, &clusterX,
+                        &clusterY, &clusterZ, &data, &data_size))
+    return NULL;
+#if CUDA_VERSION < 12000
+  if (clusterX * clusterY * clusterZ > 1) {
+    PyErr_SetString(PyExc_RuntimeError,
+                    "thread block clusters require CUDA 12");
+    return NULL;
+  }
+#endif
+  size_t size = data_size;
+  void *extra[] = {CU_LAUNCH_PARAM_BUFFER_POINTER, (void *)data,
+                   CU_LAUNCH_PARAM_BUFFER_SIZE, &size, CU_LAUNCH_PARAM_END};
+  CUDA_KERNEL_NODE_PARAMS params = makeKernelNodeParams(
+      function, gridX, gridY, gridZ, num_warps, shared, extra);
+  CUgraphNode node;
+  CUgraphNode dep = (CUgraphNode)dependency;
+  CUDA_CHECK(
+      cuGraphAddKernelNode(&node, (CUgraph)graph, dep ? &dep : NULL, dep ? 1 : 0,
+                           &params));
+#if CUDA_VERSION >= 12000
+  // Like the launcher, launch the CTAs in clusters of the kernel's shape
+  if (clusterX * clusterY * clusterZ > 1) {
+    CUkernelNodeAttrValue value;
+    memset(&value, 0, sizeof(value));
+    value.clusterDim.x = clusterX;
+    value.clusterDim.y = clusterY;
+    value.clusterDim.z = clusterZ;
+    CUDA_CHECK(cuGraphKernelNodeSetAttribute(
+        node, CU_KERNEL_NODE_ATTRIBUTE_CLUSTER_DIMENSION, &value));
+  }
+#endif
+  return PyLong_FromUnsignedLongLong((uint64_t)node);
+}
+
+static PyObject *graphSetKernelNodeParams(PyObject *self, PyObject *args) {
+  uint64_t exec, node, function;
+  int gridX, gridY, gridZ, num_warps, shared;
+  const char *data;
+  Py_ssize_t data_size;
+  if (!PyArg_ParseTuple(args, "KKKiiiiiy#", &exec, &node, &function, &gridX,
+                        &gridY, &gridZ, &num_warps, &shared, &data,
+                        &data_size))
+    return NULL;
+  size_t size = data_size;
+  void *extra[] = {CU_LAUNCH_PARAM_BUFFER_POINTER, (void *)data,
+                   CU_LAUNCH_PARAM_BUFFER_SIZE, &size, CU_LAUNCH_PARAM_END};
+  CUDA_KERNEL_NODE_PARAMS params = makeKernelNodeParams(
+      function, gridX, gridY, gridZ, num_warps, shared, extra);
+  if (exec)
+    CUDA_CHECK(cuGraphExecKernelNodeSetParams((CUgraphExec)exec,
+                                              (CUgraphNode)node, &params))
+  else
+    CUDA_CHECK(cuGraphKernelNodeSetParams((CUgraphNode)node, &params))
+  Py_RETURN_NONE;
+}
+
+static PyObject *graphInstantiate(PyObject *self, PyObject *args) {
+  uint64_t graph;
+  if (!PyArg_ParseTuple(args, "K", &graph))
+    return NULL;
+  CUgraphExec exec;
+  CUDA_CHECK(cuGraphInstantiateWithFlags(&exec, (CUgraph)graph, 0));
+  return PyLong_FromUnsignedLongLong((uint64_t)exec);
+}
+
+static PyObject *graphLaunch(PyObject *self, PyObject *args) {
+  uint64_t exec, stream;
+  if (!PyArg_ParseTuple(args, "KK", &exec, &stream))
+    return NULL;
+  CUresult result;
+  Py_BEGIN_ALLOW_THREADS;
+  result = cuGraphLaunch((CUgraphExec)exec, (CUstream)stream);
+  Py_END_ALLOW_THREADS;
+  CUDA_CHECK(result);
+  Py_RETURN_NONE;
+}
+
+static PyObject *graphDestroy(PyObject *self, PyObject *args) {
+  uint64_t graph, exec;
+  if (!PyArg_ParseTuple(args, "KK", &graph, &exec))
+    return NULL;
+  if (exec)
+    CUDA_CHECK(cuGraphExecDestroy((CUgraphExec)exec));
+  if (graph)
+    CUDA_CHECK(cuGraphDestroy((CUgraph)graph));
+  Py_RETURN_NONE;
+}
+
+// ----- launch tracing -----
+//
+// Launchers record every launch into a ring buffer owned by the launching
+// thread, so that recording takes no lock. Each record holds the host time
+// around the launch and, optionally, CUDA events timing the kernel on its
+// stream. Launchers reach the tracer through the `launch_tracer` capsule.
+
+typedef struct {
+  // read by launchers before every launch
+  volatile int enabled;
+  void *(*enter)(uint64_t function, int gridX, int gridY, int gridZ,
+                 uint64_t stream);
+  void (*exit)(void *record, uint64_t stream);
+} TritonLaunchTracer;
+
+typedef struct {
+  uint64_t function;
+  uint64_t stream;
+  int grid[3];
+  // CLOCK_MONOTONIC, in ns
+  uint64_t hostBegin;
+  uint64_t hostEnd;
+  // created on first use of the slot, when events are enabled
+  CUevent begin;
+  CUevent end;
+  int hasEvents;
+} TraceRecord;
+
+typedef struct TraceBuffer {
+  TraceRecord *records;
+  uint64_t capacity;
+  // records published by the owning thread, and the first one to collect
+  _Atomic uint64_t head;
+  uint64_t tail;
+  long tid;
+  struct TraceBuffer *next;
+} TraceBuffer;
+
+#define TRACE_NAMES_SIZE 4096
+
+typedef struct {
+  _Atomic uint64_t function;
+  char *name;
+} TraceName;
+
+static pthread_mutex_t traceMutex = PTHREAD_MUTEX_INITIALIZER;
+static TraceBuffer *traceBuffers = NULL;
+// bumped when the buffers are freed, so that threads allocate new ones
+static uint64_t traceGeneration = 0;
+static _Thread_local TraceBuffer *traceBuffer = NULL;
+static _Thread_local uint64_t traceBufferGeneration = 0;
+static uint64_t traceCapacity = 1 << 16;
+static int traceEvents = 0;
+// the GPU timeline is relative to this event, recorded when tracing starts
+static CUevent traceRefEvent = NULL;
+static uint64_t traceRefHost = 0;
+static TraceName traceNames[TRACE_NAMES_SIZE];
+static void (*nvtxRangePush)(const char *) = NULL;
+static void (*nvtxRangePop)(void) = NULL;
+
+static uint64_t traceNow(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static const char *traceName(uint64_t function) {
+  for (uint64_t i = 0; i < TRACE_NAMES_SIZE; ++i) {
+    TraceName *entry = &traceNames[(function + i) % TRACE_NAMES_SIZE];
+    uint64_t found = atomic_load_explicit(&entry->function,
+                                          memory_order_acquire);
+    if (found == function)
+      return entry->name;
+    if (found == 0)
+      break;
+  }
+  return "triton_kernel";
+}
+
+static TraceBuffer *getTraceBuffer(void) {
+  if (traceBuffer && traceBufferGeneration == traceGeneration)
+    return traceBuffer;
+  TraceBuffer *buffer = calloc(1, sizeof(TraceBuffer));
+  pthread_mutex_lock(&traceMutex);
+  buffer->capacity = traceCapacity;
+  pthread_mutex_unlock(&traceMutex);
+  buffer->records = calloc(buffer->capacity, sizeof(TraceRecord));
+  buffer->tid = syscall(SYS_gettid);
+  pthread_mutex_lock(&traceMutex);
+  buffer->next = traceBuffers;
+  traceBuffers = buffer;
+  traceBufferGeneration = traceGeneration;
+  pthread_mutex_unlock(&traceMutex);
+  traceBuffer = buffer;
+  return buffer;
+}
+
+// Frees the buffers of all the threads and the events of their records.
+// Launchers hold the GIL from `traceEnter` to `traceExit`, as do the callers
+// of this function, so no record is being written.
+static void traceFreeBuffers(void) {
+  pthread_mutex_lock(&traceMutex);
+  TraceBuffer *buffer = traceBuffers;
+  while (buffer) {
+    for (uint64_t i = 0; i < buffer->capacity; ++i) {
+      if (buffer->records[i].begin)
+        cuEventDestroy(buffer->records[i].begin);
+      if (buffer->records[i].end)
+        cuEventDestroy(buffer->records[i].end);
+    }
+    TraceBuffer *next = buffer->next;
+    free(buffer->records);
+    free(buffer);
+    buffer = next;
+  }
+  traceBuffers = NULL;
+  ++traceGeneration;
+  pthread_mutex_unlock(&traceMutex);
+}
+
+static void *traceEnter(uint64_t function, int gridX, int gridY, int gridZ,
+                        uint64_t stream) {
+  TraceBuffer *buffer = getTraceBuffer();
+  uint64_t head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+  TraceRecord *record = &buffer->records[head % buffer->capacity];
+  record->function = function;
+  record->stream = stream;
+  record->grid[0] = gridX;
+  record->grid[1] = gridY;
+  record->grid[2] = gridZ;
+  record->hasEvents = 0;
+  if (nvtxRangePush)
+    nvtxRangePush(traceName(function));
+  if (traceEvents) {
+    if (!record->begin)
+      cuEventCreate(&record->begin, CU_EVENT_DEFAULT);
+    if (!record->end)
+      cuEventCreate(&record->end, CU_EVENT_DEFAULT);
+    record->hasEvents =
+        cuEventRecord(record->begin, (CUstream)stream) == CUDA_SUCCESS;
+  }
+  record->hostBegin = traceNow();
+  return record;
+}
+
+static void traceExit(void *ptr, uint64_t stream) {
+  TraceRecord *record = ptr;
+  record->hostEnd = traceNow();
+  if (record->hasEvents)
+    record->hasEvents =
+        cuEventRecord(record->end, (CUstream)stream) == CUDA_SUCCESS;
+  if (nvtxRangePop)
+    nvtxRangePop();
+  // publishes the record to `trace_collect`
+  TraceBuffer *buffer = traceBuffer;
+  atomic_fetch_add_explicit(&buffer->head, 1, memory_order_release);
+}
+
+static TritonLaunchTracer launchTracer = {0, traceEnter, traceExit};
+
+static PyObject *traceStart(PyObject *self, PyObject *args) {
+  int events, nvtx;
+  unsigned long long capacity;
+  if (!PyArg_ParseTuple(args, "ppK", &events, &nvtx, &capacity))
+    return NULL;
+  // the launches of a previous trace that were not collected are dropped
+  if (!launchTracer.enabled)
+    traceFreeBuffers();
+  pthread_mutex_lock(&traceMutex);
+  // threads that already traced keep their buffers
+  traceCapacity = capacity;
+  pthread_mutex_unlock(&traceMutex);
+  traceEvents = 0;
+  if (events) {
+    CUcontext ctx = NULL;
+    CUDA_CHECK(cuCtxGetCurrent(&ctx));
+    if (!ctx) {
+      PyErr_SetString(PyExc_RuntimeError,
+                      "tracing with events requires a current CUDA context");
+      return NULL;
+    }
+    if (!traceRefEvent)
+      CUDA_CHECK(cuEventCreate(&traceRefEvent, CU_EVENT_DEFAULT));
+    CUDA_CHECK(cuEventRecord(traceRefEvent, NULL));
+    CUDA_CHECK(cuEventSynchronize(traceRefEvent));
+    traceRefHost = traceNow();
+    traceEvents = 1;
+  }
+  nvtxRangePush = NULL;
+  nvtxRangePop = NULL;
+  if (nvtx) {
+    void *lib = dlopen("libnvToolsExt.so.1", RTLD_NOW | RTLD_GLOBAL);
+    if (!lib) {
+      PyErr_SetString(PyExc_RuntimeError, "libnvToolsExt.so.1 not found");
+      return NULL;
+    }
+    nvtxRangePush = (void (*)(const char *))dlsym(lib, "nvtxRangePushA");
+    nvtxRangePop = (void (*)(void))dlsym(lib, "nvtxRangePop");
+    if (!nvtxRangePush || !nvtxRangePop)
+      nvtxRangePush = NULL, nvtxRangePop = NULL;
+  }
+  launchTracer.enabled = 1;
+  Py_RETURN_NONE;
+}
+
+static PyObject *traceStop(PyObject *self, PyObject *args) {
+  launchTracer.enabled = 0;
+  Py_RETURN_NONE;
+}
+
+// Names the launches of `function` in NVTX ranges and collected records
+static PyObject *traceRegister(PyObject *self, PyObject *args) {
+  uint64_t function;
+  const char *name;
+  if (!PyArg_ParseTuple(args, "Ks", &function, &name))
+    return NULL;
+  pthread_mutex_lock(&traceMutex);
+  for (uint64_t i = 0; i < TRACE_NAMES_SIZE; ++i) {
+    TraceName *entry = &traceNames[(function + i) % TRACE_NAMES_SIZE];
+    uint64_t found = atomic_load(&entry->function);
+    if (found == function)
+      break;
+    if (found == 0) {
+      entry->name = strdup(name);
+      atomic_store_explicit(&entry->function, function, memory_order_release);
+      break;
+    }
+  }
+  pthread_mutex_unlock(&traceMutex);
+  Py_RETURN_NONE;
+}
+
+// Synchronizes the streams the timed records of the buffers were launched
+// on, once each
+static void traceSynchronizeStreams(void) {
+  uint64_t *streams = NULL;
+  size_t numStreams = 0, capacity = 0;
+  for (TraceBuffer *buffer = traceBuffers; buffer; buffer = buffer->next) {
+    uint64_t head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+    uint64_t begin = buffer->tail;
+    if (head - begin > buffer->capacity)
+      begin = head - buffer->capacity;
+    for (uint64_t i = begin; i < head; ++i) {
+      TraceRecord *record = &buffer->records[i % buffer->capacity];
+      if (!record->hasEvents)
+        continue;
+      size_t j = 0;
+      while (j < numStreams && streams[j] != record->stream)
+        ++j;
+      if (j < numStreams)
+        continue;
+      if (numStreams == capacity) {
+        capacity = capacity ? 2 * capacity : 16;
+        uint64_t *grown = realloc(streams, capacity * sizeof(uint64_t));
+        if (!grown)
+          break;
+        streams = grown;
+      }
+      streams[numStreams++] = record->stream;
+    }
+  }
+  for (size_t j = 0; j < numStreams; ++j)
+    cuStreamSynchronize((CUstream)streams[j]);
+  free(streams);
+}
+
+// Returns, and forgets, the records published since the last collection:
+// (name, gridX, gridY, gridZ, stream, tid, host begin, host end, gpu begin,
+// gpu end), with times in ns and gpu times of -1 when not measured. Records
+// that were overwritten before their collection are lost. Once tracing has
+// stopped, the collection ends the trace and frees its buffers.
+static PyObject *traceCollect(PyObject *self, PyObject *args) {
+  PyObject *records = PyList_New(0);
+  if (!records)
+    return NULL;
+  pthread_mutex_lock(&traceMutex);
+  // the kernels of the records have to complete for their times to be read
+  traceSynchronizeStreams();
+  for (TraceBuffer *buffer = traceBuffers; buffer; buffer = buffer->next) {
+    uint64_t head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+    uint64_t begin = buffer->tail;
+    if (head - begin > buffer->capacity)
+      begin = head - buffer->capacity;
+    for (uint64_t i = begin; i < head; ++i) {
+      TraceRecord *record = &buffer->records[i % buffer->capacity];
+      long long gpuBegin = -1, gpuEnd = -1;
+      float begin_ms, end_ms;
+      if (record->hasEvents && traceRefEvent &&
+          cuEventElapsedTime(&begin_ms, traceRefEvent, record->begin) ==
+              CUDA_SUCCESS &&
+          cuEventElapsedTime(&end_ms, traceRefEvent, record->end) ==
+              CUDA_SUCCESS) {
+        gpuBegin = traceRefHost + (long long)(begin_ms * 1e6);
+        gpuEnd = traceRefHost + (long long)(end_ms * 1e6);
+      }
+      PyObject *item = Py_BuildValue(
+          "(siiiKlKKLL)", traceName(record->function), record->grid[0],
+          record->grid[1], record->grid[2], record->stream, buffer->tid,
+          record->hostBegin, record->hostEnd, gpuBegin, gpuEnd);
+      if (!item || PyList_Append(records, item) < 0) {
+        Py_XDECREF(item);
+        Py_DECREF(records);
+        pthread_mutex_unlock(&traceMutex);
+        return NULL;
+      }
+      Py_DECREF(item);
+    }
+    buffer->tail = head;
+  }
+  pthread_mutex_unlock(&traceMutex);
+  if (!launchTracer.enabled)
+    traceFreeBuffers();
+  return records;
+}
+
+// ----- prebuilt launcher -----
+//
+// Kernels are launched by launchers of this module, driven by a descriptor of
+// their signature, rather than by a launcher generated and compiled for each
+// signature. The descriptor holds one code per argument: 'P' for pointers,
+// the PyArg_ParseTuple code of the C type of scalars ('b', 'h', 'i', 'l',
+// 'I', 'K', 'f' or 'd'; fp16 and bf16 scalars are passed as floats) and '-'
+// for constants, which the kernel does not take.
+
+#define LAUNCHER_MAX_ARGS 256
+
+typedef union {
+  CUdeviceptr ptr;
+  int8_t i8;
+  int16_t i16;
+  int32_t i32;
+  int64_t i64;
+  uint32_t u32;
+  uint64_t u64;
+  float f32;
+  double f64;
+} LaunchArg;
+
+typedef struct {
+  PyObject_HEAD char descriptor[LAUNCHER_MAX_ARGS + 1];
+  Py_ssize_t numArgs;
+  // shape of the thread block clusters, in CTAs
+  int clusterDims[3];
+} Launcher;
+
+// Launches CTAs grouped in clusters of `clusterDims` CTAs, which sm90 runs
+// on the SMs of a GPC at once, sharing their shared memory, when there is
+// more than one CTA per cluster
+static CUresult launchKernel(CUfunction function, int gridX, int gridY,
+                             int gridZ, int numWarps, const int *clusterDims,
+                             int shared, CUstream stream, void **params) {
+  if (clusterDims[0] * clusterDims[1] * clusterDims[2] == 1)
+    return cuLaunchKernel(function, gridX, gridY, gridZ, 32 * numWarps, 1, 1,
+                          shared, stream, params, 0);
+#if CUDA_VERSION >= 12000
+  CUlaunchAttribute attribute;
+  attribute.id = CU_LAUNCH_ATTRIBUTE_CLUSTER_DIMENSION;
+  attribute.value.clusterDim.x = clusterDims[0];
+  attribute.value.clusterDim.y = clusterDims[1];
+  attribute.value.clusterDim.z = clusterDims[2];
+  CUlaunchConfig config;
+  memset(&config, 0, sizeof(config));
+  config.gridDimX = gridX;
+  config.gridDimY = gridY;
+  config.gridDimZ = gridZ;
+  config.blockDimX = 32 * numWarps;
+  config.blockDimY = 1;
+  config.blockDimZ = 1;
+  config.sharedMemBytes = shared;
+  config.hStream = stream;
+  config.attrs = &attribute;
+  config.numAttrs = 1;
+  return cuLaunchKernelEx(&config, function, params, 0);
+#else
+  return CUDA_ERROR_NOT_SUPPORTED;
+#endif
+}
+
+// The device address of argument `idx`: an integer, None or an object with
+// a `data_ptr` method, such as a tensor.
+static int getDevicePointer(PyObject *obj, Py_ssize_t idx, CUdeviceptr *ptr) {
+  *ptr = 0;
+  if (obj == Py_None)
+    return 0;
+  if (PyLong_Check(obj)) {
+    *ptr = PyLong_AsUnsignedLongLong(obj);
+    return PyErr_Occurred() ? -1 : 0;
+  }
+  PyObject *dataPtr = PyObject_GetAttrString(obj, "data_ptr");
+  if (!dataPtr) {
+    PyErr_SetString(PyExc_TypeError,
+                    "Pointer argument must be either uint64 or have data_ptr "
+                    "method");
+    return -1;
+  }
+  PyObject *ret = PyObject_CallObject(dataPtr, NULL);
+  Py_DECREF(dataPtr);
+  if (!ret)
+    return -1;
+  if (!PyLong_Check(ret)) {
+    Py_DECREF(ret);
+    PyErr_SetString(PyExc_TypeError,
+                    "data_ptr method of Pointer object must return 64-bit int");
+    return -1;
+  }
+  *ptr = PyLong_AsUnsignedLongLong(ret);
+  Py_DECREF(ret);
+  if (!*ptr)
+    return 0;
+  uint64_t devPtr;
+  CUresult status = cuPointerGetAttribute(
+      &devPtr, CU_POINTER_ATTRIBUTE_DEVICE_POINTER, *ptr);
+  if (status == CUDA_ERROR_INVALID_VALUE) {
+    PyErr_Format(PyExc_ValueError,
+                 "Pointer argument (at %zd) cannot be accessed from Triton "
+                 "(cpu tensor?)",
+                 idx);
+    return -1;
+  }
+  if (status == CUDA_SUCCESS)
+    *ptr = devPtr;
+  return 0;
+}
+
+// Same arguments as the generated launchers: the grid, num_warps, the shared
+// memory, the stream, the function, the launch hooks, the compiled kernel
+// and the arguments of the signature.
+static PyObject *launcherCall(PyObject *obj, PyObject *args,
+                              PyObject *kwargs) {
+  Launcher *self = (Launcher *)obj;
+  if (PyTuple_GET_SIZE(args) != 10 + self->numArgs) {
+    PyErr_Format(PyExc_TypeError, "launcher takes %zd arguments (%zd given)",
+                 10 + self->numArgs, PyTuple_GET_SIZE(args));
+    return NULL;
+  }
+  int gridX = PyLong_AsLong(PyTuple_GET_ITEM(args, 0));
+  int gridY = PyLong_AsLong(PyTuple_GET_ITEM(args, 1));
+  int gridZ = PyLong_AsLong(PyTuple_GET_ITEM(args, 2));
+  int numWarps = PyLong_AsLong(PyTuple_GET_ITEM(args, 3));
+  int shared = PyLong_AsLong(PyTuple_GET_ITEM(args, 4));
+  uint64_t stream = PyLong_AsUnsignedLongLongMask(PyTuple_GET_ITEM(args, 5));
+  uint64_t function = PyLong_AsUnsignedLongLongMask(PyTuple_GET_ITEM(args, 6));
+  PyObject *enterHook = PyTuple_GET_ITEM(args, 7);
+  PyObject *exitHook = PyTuple_GET_ITEM(args, 8);
+  if (PyErr_Occurred())
+    return NULL;
+
+  if (enterHook != Py_None)
+    Py_XDECREF(PyObject_CallObject(enterHook, args));
+
+  LaunchArg values[LAUNCHER_MAX_ARGS];
+  void *params[LAUNCHER_MAX_ARGS];
+  int numParams = 0;
+  for (Py_ssize_t i = 0; i < self->numArgs; ++i) {
+    PyObject *arg = PyTuple_GET_ITEM(args, 10 + i);
+    LaunchArg *value = &values[numParams];
+    switch (self->descriptor[i]) {
+    case '-':
+      continue;
+    case 'P':
+      if (getDevicePointer(arg, i, &value->ptr) < 0)
+        return NULL;
+      break;
+    case 'b':
+      value->i8 = (int8_t)PyLong_AsLong(arg);
+      break;
+    case 'h':
+      value->i16 = (int16_t)PyLong_AsLong(arg);
+      break;
+    case 'i':
+      value->i32 = (int32_t)PyLong_AsLong(arg);
+      break;
+    case 'l':
+      value->i64 = PyLong_AsLongLong(arg);
+      break;
+    case 'I':
+      value->u32 = (uint32_t)PyLong_AsUnsignedLongMask(arg);
+      break;
+    case 'K':
+      value->u64 = PyLong_AsUnsignedLongLongMask(arg);
+      break;
+    case 'f':
+      value->f32 = (float)PyFloat_AsDouble(arg);
+      break;
+    case 'd':
+      value->f64 = PyFloat_AsDouble(arg);
+      break;
+    }
+    if (PyErr_Occurred())
+      return NULL;
+    params[numParams++] = value;
+  }
+
+  void *record = launchTracer.enabled
+                     ? traceEnter(function, gridX, gridY, gridZ, stream)
+                     : NULL;
+  if (gridX * gridY * gridZ > 0)
+    gpuAssert(launchKernel((CUfunction)function, gridX, gridY, gridZ, numWarps,
+                           self->clusterDims, shared, (CUstream)stream,
+                           params),
+              __FILE__, __LINE__);
+  if (record)
+    traceExit(record, stream);
+
+  if (exitHook != Py_None)
+    Py_XDECREF(PyObject_CallObject(exitHook, args));
+  if (PyErr_Occurred())
+    return NULL;
+  Py_RETURN_NONE;
+}
+
+static PyTypeObject LauncherType = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "cuda_utils.Launcher",
+    .tp_basicsize = sizeof(Launcher),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_call = launcherCall,
+    .tp_doc = "Launches the kernels of a signature descriptor",
+};
+
+static PyObject *makeLauncher(PyObject *self, PyObject *args) {
+  const char *descriptor;
+  int clusterDims[3] = {1, 1, 1};
+  if (!PyArg_ParseTuple(args, "s|(iii)", &descriptor, &clusterDims[0],
+                        &clusterDims[1], &clusterDims[2]))
+    return NULL;
+  if (clusterDims[0] < 1 || clusterDims[1] < 1 || clusterDims[2] < 1) {
+    PyErr_SetString(PyExc_ValueError, "cluster dimensions must be positive");
+    return NULL;
+  }
+  size_t numArgs = strlen(descriptor);
+  if (numArgs > LAUNCHER_MAX_ARGS) {
+    PyErr_Format(PyExc_ValueError, "kernels take at most %d arguments",
+                 LAUNCHER_MAX_ARGS);
+    return NULL;
+  }
+  if (strspn(descriptor, "-PbhilIKfd") != numArgs) {
+    PyErr_Format(PyExc_ValueError, "invalid signature descriptor '%s'",
+                 descriptor);
+    return NULL;
+  }
+  Launcher *launcher = PyObject_New(Launcher, &LauncherType);
+  if (!launcher)
+    return NULL;
+  memcpy(launcher->descriptor, descriptor, numArgs + 1);
+  launcher->numArgs = numArgs;
+  memcpy(launcher->clusterDims, clusterDims, sizeof(clusterDims));
+  return (PyObject *)launcher;
+}
+
 static PyMethodDef ModuleMethods[] = {
     {"load_binary", loadBinary, METH_VARARGS,
      "Load provided cubin into CUDA driver"},
     {"get_device_properties", getDeviceProperties, METH_VARARGS,
      "Get the properties for a given device"},
+    {"write_global", writeGlobal, METH_VARARGS,
+     "Write the global variable of a loaded module"},
+    {"graph_create", graphCreate, METH_VARARGS, "Create an empty CUDA graph"},
+    {"graph_add_kernel_node", graphAddKernelNode, METH_VARARGS,
+     "Append a kernel launch with packed arguments to a CUDA graph"},
+    {"graph_set_kernel_node_params", graphSetKernelNodeParams, METH_VARARGS,
+     "Update the launch parameters of a kernel node"},
+    {"graph_instantiate", graphInstantiate, METH_VARARGS,
+     "Instantiate a CUDA graph"},
+    {"graph_launch", graphLaunch, METH_VARARGS,
+     "Launch an instantiated CUDA graph"},
+    {"graph_destroy", graphDestroy, METH_VARARGS,
+     "Destroy a CUDA graph and its instantiation"},
+    {"trace_start", traceStart, METH_VARARGS,
+     "Start recording the launches of all launchers"},
+    {"trace_stop", traceStop, METH_VARARGS, "Stop recording launches"},
+    {"trace_register", traceRegister, METH_VARARGS,
+     "Name the launches of a function in traces"},
+    {"trace_collect", traceCollect, METH_VARARGS,
+     "Return the launches recorded since the last collection"},
+    {"make_launcher", makeLauncher, METH_VARARGS,
+     "Return the launcher of the kernels of a signature descriptor, launched "
+     "in clusters of the given shape"},
     {NULL, NULL, 0, NULL} // sentinel
 };
 
@@ -122,10 +919,19 @@ static struct PyModuleDef ModuleDef = {PyModuleDef_HEAD_INIT, "cuda_utils",
                                        ModuleMethods};
 
 PyMODINIT_FUNC PyInit_cuda_utils(void) {
+  if (PyType_Ready(&LauncherType) < 0)
+    return NULL;
   PyObject *m = PyModule_Create(&ModuleDef);
   if (m == NULL) {
     return NULL;
   }
   PyModule_AddFunctions(m, ModuleMethods);
+  PyObject *tracer =
+      PyCapsule_New(&launchTracer, "triton.launch_tracer", NULL);
+  if (!tracer || PyModule_AddObject(m, "launch_tracer", tracer) < 0) {
+    Py_XDECREF(tracer);
+    Py_DECREF(m);
+    return NULL;
+  }
   return m;
 }
@@ -35,11 +35,15 @@ static PyObject *getDeviceProperties(PyObject *self, PyObject *args) {
   HIP_CHECK(hipGetDeviceProperties(&props, device_id));
 
   // create a struct to hold device properties
-  return Py_BuildValue("{s:i, s:i, s:i, s:i, s:i}", "max_shared_mem",
-                       props.sharedMemPerBlock, "multiprocessor_count",
-                       props.multiProcessorCount, "sm_clock_rate",
-                       props.clockRate, "mem_clock_rate", props.memoryClockRate,
-                       "mem_bus_width", props.memoryBusWidth);
+  return Py_BuildValue(
+      "{s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i}", "max_shared_mem",
+      props.sharedMemPerBlock, "multiprocessor_count",
+      props.multiProcessorCount, "sm_clock_rate", props.clockRate,
+      "mem_clock_rate", props.memoryClockRate, "mem_bus_width",
+      props.memoryBusWidth, "max_threads_per_sm",
+      props.maxThreadsPerMultiProcessor, "max_shared_mem_per_sm",
+      (int)props.maxSharedMemoryPerMultiProcessor, "warp_size", props.warpSize,
+      "l2_size", props.l2CacheSize);
 }
 
 static PyObject *loadBinary(PyObject *self, PyObject *args) {
@@ -53,21 +57,6 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
     return NULL;
   }
 
-  // Open HSACO file
-  FILE *hsaco_file;
-  if ((hsaco_file = fopen(data, "rb")) == NULL) {
-    return NULL;
-  }
-
-  // Read HSCAO file into Buffer
-  fseek(hsaco_file, 0L, SEEK_END);
-  size_t hsaco_file_size = ftell(hsaco_file);
-  unsigned char *hsaco =
-      (unsigned char *)malloc(hsaco_file_size * sizeof(unsigned char));
-  rewind(hsaco_file);
-  fread(hsaco, sizeof(unsigned char), hsaco_file_size, hsaco_file);
-  fclose(hsaco_file);
-
   // set HIP options
   hipJitOption opt[] = {hipJitOptionErrorLogBufferSizeBytes,
                         hipJitOptionErrorLogBuffer,
@@ -83,9 +72,8 @@ static PyObject *loadBinary(PyObject *self, PyObject *args) {
   // launch HIP Binary
   hipModule_t mod;
   hipFunction_t fun;
-  hipModuleLoadDataEx(&mod, hsaco, 5, opt, optval);
+  hipModuleLoadDataEx(&mod, data, 5, opt, optval);
   hipModuleGetFunction(&fun, mod, name);
-  free(hsaco);
 
   // get allocated registers and spilled registers from the function
   int n_regs = 0;
@@ -1,6 +1,10 @@
+import fcntl
 import json
 import os
 import random
+import struct
+import tempfile
+import threading
 from abc import ABC, abstractmethod
 from pathlib import Path
 from typing import Dict, Optional
@@ -110,6 +114,394 @@ class FileCacheManager(CacheManager):
         return filepath
 
 
+class _PackedArchive:
+    """
+    An append-only archive of cache entries in a single file.
+
+    Each record is a fixed-size header followed by the key, the file name and
+    the payload; "touch" records carry no payload and only mark an entry as
+    recently used. The index is rebuilt by scanning the headers, once per
+    process and then incrementally whenever the file has grown or has been
+    replaced by a compaction. Writers append whole records under an exclusive
+    `flock`, and compaction rewrites the live, most recently used entries
+    that fit the byte budget into a new file that atomically replaces the old
+    one; readers keep their descriptor on the old file, so offsets they
+    already hold stay valid.
+    """
+
+    HEADER = struct.Struct("<4sBHHQ")
+    MAGIC = b"TRC1"
+    PUT = 0
+    TOUCH = 1
+
+    def __init__(self, path, max_bytes):
+        self.path = path
+        self.max_bytes = max_bytes
+        self.lock = threading.Lock()
+        self.fd = None
+        self.inode = None
+        self.scanned = 0
+        # (key, filename) -> [offset, size, last use]
+        self.index = dict()
+        self.clock = 0
+        self.touched = set()
+        self.live_bytes = 0
+
+    def _open(self):
+        if self.fd is not None:
+            os.close(self.fd)
+        self.fd = os.open(self.path, os.O_RDWR | os.O_CREAT | os.O_APPEND, 0o644)
+        self.inode = os.fstat(self.fd).st_ino
+        self.scanned = 0
+        self.index = dict()
+        self.clock = 0
+        self.live_bytes = 0
+
+    def _refresh(self):
+        try:
+            st = os.stat(self.path)
+        except FileNotFoundError:
+            st = None
+        if self.fd is None or st is None or st.st_ino != self.inode:
+            self._open()
+            st = os.fstat(self.fd)
+        if st.st_size > self.scanned:
+            self._scan(st.st_size)
+
+    def _scan(self, end):
+        offset = self.scanned
+        size = self.HEADER.size
+        while offset + size <= end:
+            magic, kind, key_len, name_len, data_len = self.HEADER.unpack(os.pread(self.fd, size, offset))
+            record_end = offset + size + key_len + name_len + data_len
+            # a torn write at the end of the file is skipped until completed
+            if magic != self.MAGIC or record_end > end:
+                break
+            names = os.pread(self.fd, key_len + name_len, offset + size)
+            entry_key = (names[:key_len].decode(), names[key_len:].decode())
+            self.clock += 1
+            if kind == self.PUT:
+                old = self.index.get(entry_key)
+                if old is not None:
+                    self.live_bytes -= old[1]
+                self.index[entry_key] = [offset + size + key_len + name_len, data_len, self.clock]
+                self.live_bytes += data_len
+            elif entry_key in self.index:
+                self.index[entry_key][2] = self.clock
+            offset = record_end
+        self.scanned = offset
+
+    def _lock_exclusive(self):
+        # another process may compact the archive between our open and our
+        # flock, in which case the lock has to be taken on the new file
+        while True:
+            self._refresh()
+            fcntl.flock(self.fd, fcntl.LOCK_EX)
+            try:
+                if os.stat(self.path).st_ino == self.inode:
+                    self._scan(os.fstat(self.fd).st_size)
+                    return
+            except FileNotFoundError:
+                pass
+            fcntl.flock(self.fd, fcntl.LOCK_UN)
+
+    def _append(self, kind, key, filename, data=b""):
+        key_bytes, name_bytes = key.encode(), filename.encode()
+        record = self.HEADER.pack(self.MAGIC, kind, len(key_bytes), len(name_bytes), len(data)) + key_bytes + name_bytes + data
+        self._lock_exclusive()
+        try:
+            os.write(self.fd, record)
+            self._scan(os.fstat(self.fd).st_size)
+        finally:
+            fcntl.flock(self.fd, fcntl.LOCK_UN)
+
+    def get(self, key, filename):
+        with self.lock:
+            entry = self.index.get((key, filename))
+            if entry is None:
+                self._refresh()
+                entry = self.index.get((key, filename))
+                if entry is None:
+                    return None
+            offset, size, _ = entry
+            data = os.pread(self.fd, size, offset)
+            # record the use once per process so that eviction is LRU
+            # across all the processes sharing the archive
+            if (key, filename) not in self.touched:
+                self.touched.add((key, filename))
+                self._append(self.TOUCH, key, filename)
+            return data
+
+    def has(self, key, filename):
+        with self.lock:
+            if (key, filename) not in self.index:
+                self._refresh()
+            return (key, filename) in self.index
+
+    def put(self, key, filename, data):
+        with self.lock:
+            self._append(self.PUT, key, filename, data)
+            self.touched.add((key, filename))
+            if self.max_bytes > 0 and os.fstat(self.fd).st_size > 2 * self.max_bytes:
+                self._compact()
+
+    def _compact(self):
+        self._lock_exclusive()
+        try:
+            if os.fstat(self.fd).st_size <= 2 * self.max_bytes:
+                return
+            keep, total = [], 0
+            for entry_key, (offset, size, last_use) in sorted(self.index.items(), key=lambda kv: -kv[1][2]):
+                if total + size > self.max_bytes:
+                    continue
+                keep.append((entry_key, offset, size))
+                total += size
+            temp_path = f"{self.path}.tmp.pid_{os.getpid()}_{random.randint(0, 1000000)}"
+            with open(temp_path, "wb") as f:
+                # oldest first, so that a rescan restores the same recency order
+                for (key, filename), offset, size in reversed(keep):
+                    key_bytes, name_bytes = key.encode(), filename.encode()
+                    f.write(self.HEADER.pack(self.MAGIC, self.PUT, len(key_bytes), len(name_bytes), size))
+                    f.write(key_bytes + name_bytes + os.pread(self.fd, size, offset))
+            os.replace(temp_path, self.path)
+        finally:
+            fcntl.flock(self.fd, fcntl.LOCK_UN)
+        self._refresh()
+
+
+_packed_archives = dict()
+_packed_archives_lock = threading.Lock()
+# scratch files written by this process, which are up to date
+_packed_materialized = set()
+
+
+class PackedCacheManager(CacheManager):
+    """
+    A cache manager that keeps every entry in a single archive file
+    (`$TRITON_CACHE_DIR/packed.bin`) instead of a directory per key, bounded
+    to `TRITON_CACHE_MAX_BYTES` (default 1 GiB) with least-recently-used
+    eviction. Select it with
+    `TRITON_CACHE_MANAGER=triton.runtime.cache:PackedCacheManager`.
+
+    Callers consume cache entries as paths, so entries that are looked up are
+    materialized, on their first lookup in a process, under a local scratch
+    directory (`TRITON_PACKED_CACHE_SCRATCH`, by default in the system temp
+    dir), which keeps the shared cache directory down to a single file.
+    """
+
+    def __init__(self, key):
+        self.key = key
+        cache_dir = os.environ.get('TRITON_CACHE_DIR', default_cache_dir())
+        self.archive = None
+        if cache_dir:
+            os.makedirs(cache_dir, exist_ok=True)
+            path = os.path.join(cache_dir, "packed.bin")
+            with _packed_archives_lock:
+                if path not in _packed_archives:
+                    max_bytes = int(os.environ.get("TRITON_CACHE_MAX_BYTES", str(1 << 30)))
+                    _packed_archives[path] = _PackedArchive(path, max_bytes)
+                self.archive = _packed_archives[path]
+        scratch = os.environ.get("TRITON_PACKED_CACHE_SCRATCH",
+                                 os.path.join(tempfile.gettempdir(), f"triton-packed-{os.getuid()}"))
+        self.scratch_dir = os.path.join(scratch, self.key)
+
+    def _materialize(self, filename, data) -> str:
+        os.makedirs(self.scratch_dir, exist_ok=True)
+        filepath = os.path.join(self.scratch_dir, filename)
+        temp_path = f"{filepath}.tmp.pid_{os.getpid()}_{random.randint(0, 1000000)}"
+        with open(temp_path, "wb") as f:
+            f.write(data)
+        os.replace(temp_path, filepath)
+        _packed_materialized.add(filepath)
+        return filepath
+
+    def has_file(self, filename) -> bool:
+        return self.archive is not None and self.archive.has(self.key, filename)
+
+    def get_file(self, filename) -> Optional[str]:
+        if self.archive is None:
+            return None
+        # entries already materialized are only checked for eviction
+        filepath = os.path.join(self.scratch_dir, filename)
+        if filepath in _packed_materialized and os.path.exists(filepath):
+            return filepath if self.archive.has(self.key, filename) else None
+        data = self.archive.get(self.key, filename)
+        if data is None:
+            return None
+        return self._materialize(filename, data)
+
+    def get_group(self, filename: str) -> Optional[Dict[str, str]]:
+        grp_path = self.get_file(f"__grp__{filename}")
+        if grp_path is None:
+            return None
+        with open(grp_path) as f:
+            child_paths = json.load(f).get("child_paths", None)
+        # Invalid group data.
+        if child_paths is None:
+            return None
+        result = {}
+        for c in child_paths:
+            p = self.get_file(c)
+            if p is None:
+                # evicted since the group was written
+                return None
+            result[c] = p
+        return result
+
+    def put_group(self, filename: str, group: Dict[str, str]):
+        if self.archive is None:
+            return
+        grp_contents = json.dumps({"child_paths": sorted(list(group.keys()))})
+        return self.put(grp_contents, f"__grp__{filename}", binary=False)
+
+    def put(self, data, filename, binary=True) -> str:
+        if self.archive is None:
+            return
+        data = data if isinstance(data, bytes) else str(data).encode()
+        self.archive.put(self.key, filename, data)
+        return self._materialize(filename, data)
+
+
+class RemoteCacheBackend(ABC):
+    """ a flat key-value store shared by many hosts """
+
+    @abstractmethod
+    def get(self, key: str) -> Optional[bytes]:
+        pass
+
+    @abstractmethod
+    def put(self, key: str, data: bytes):
+        pass
+
+
+class HTTPRemoteCacheBackend(RemoteCacheBackend):
+    """ `GET`s and `PUT`s `<url>/<key>`, e.g. against an object store bucket """
+
+    def __init__(self, url, timeout):
+        self.url = url.rstrip("/")
+        self.timeout = timeout
+
+    def get(self, key):
+        import urllib.error
+        import urllib.request
+        try:
+            with urllib.request.urlopen(f"{self.url}/{key}", timeout=self.timeout) as response:
+                return response.read()
+        except urllib.error.HTTPError as e:
+            if e.code == 404:
+                return None
+            raise
+
+    def put(self, key, data):
+        import urllib.request
+        request = urllib.request.Request(f"{self.url}/{key}", data=data, method="PUT",
+                                         headers={"Content-Type": "application/octet-stream"})
+        urllib.request.urlopen(request, timeout=self.timeout).close()
+
+
+class RedisRemoteCacheBackend(RemoteCacheBackend):
+
+    def __init__(self, url, timeout):
+        import redis
+        self.client = redis.Redis.from_url(url, socket_timeout=timeout)
+
+    def get(self, key):
+        return self.client.get(key)
+
+    def put(self, key, data):
+        self.client.set(key, data)
+
+
+def _make_remote_backend(url, timeout) -> RemoteCacheBackend:
+    if url.startswith("redis://") or url.startswith("rediss://"):
+        return RedisRemoteCacheBackend(url, timeout)
+    if url.startswith("http://") or url.startswith("https://"):
+        return HTTPRemoteCacheBackend(url, timeout)
+    raise ValueError(f"unsupported remote cache url {url}")
+
+
+def _pack_bundle(files: Dict[str, bytes]) -> bytes:
+    header = json.dumps({name: len(data) for name, data in files.items()}).encode()
+    return struct.pack("<Q", len(header)) + header + b"".join(files.values())
+
+
+def _unpack_bundle(bundle: bytes) -> Dict[str, bytes]:
+    header_len, = struct.unpack_from("<Q", bundle)
+    offset = 8 + header_len
+    files = dict()
+    for name, size in json.loads(bundle[8:offset]).items():
+        if os.path.basename(name) != name or offset + size > len(bundle):
+            raise ValueError("malformed remote cache bundle")
+        files[name] = bundle[offset:offset + size]
+        offset += size
+    return files
+
+
+class RemoteCacheManager(FileCacheManager):
+    """
+    Shares compiled kernels between hosts through a remote key-value store
+    (`TRITON_REMOTE_CACHE_URL`: `http(s)://` object storage or `redis://`),
+    in front of the local disk cache.
+
+    Groups are content-addressed by the cache key (from `make_hash`) and
+    their name: `put_group` uploads every file of the group as one bundle,
+    and a `get_group` that misses locally downloads the bundle into the
+    local cache. Remote errors are reported once and otherwise treated as
+    misses, so an unreachable store only costs the local compilation.
+    """
+
+    _backend = None
+    _backend_url = None
+    _warned = False
+
+    def __init__(self, key):
+        super().__init__(key)
+        url = os.environ.get("TRITON_REMOTE_CACHE_URL", "")
+        if url and url != RemoteCacheManager._backend_url:
+            timeout = float(os.environ.get("TRITON_REMOTE_CACHE_TIMEOUT", "5"))
+            RemoteCacheManager._backend = _make_remote_backend(url, timeout)
+            RemoteCacheManager._backend_url = url
+        self.backend = RemoteCacheManager._backend if url else None
+
+    def _remote_key(self, filename):
+        return f"{self.key}/{filename}"
+
+    def _report(self, e):
+        if not RemoteCacheManager._warned:
+            RemoteCacheManager._warned = True
+            import warnings
+            warnings.warn(f"remote triton cache unavailable, falling back to local cache: {e}")
+
+    def get_group(self, filename: str) -> Optional[Dict[str, str]]:
+        group = super().get_group(filename)
+        if group is not None or self.backend is None or not self.cache_dir:
+            return group
+        try:
+            bundle = self.backend.get(self._remote_key(filename))
+            if bundle is None:
+                return None
+            files = _unpack_bundle(bundle)
+        except Exception as e:
+            self._report(e)
+            return None
+        for name, data in files.items():
+            super().put(data, name)
+        local_group = {name: self._make_path(name) for name in files}
+        super().put_group(filename, local_group)
+        return local_group
+
+    def put_group(self, filename: str, group: Dict[str, str]):
+        ret = super().put_group(filename, group)
+        if self.backend is None or not self.cache_dir:
+            return ret
+        try:
+            files = {name: Path(self._make_path(name)).read_bytes() for name in group}
+            self.backend.put(self._remote_key(filename), _pack_bundle(files))
+        except Exception as e:
+            self._report(e)
+        return ret
+
+
 __cache_cls = FileCacheManager
 __cache_cls_nme = "DEFAULT"
 
@@ -121,6 +513,10 @@ def get_cache_manager(key) -> CacheManager:
     global __cache_cls
     global __cache_cls_nme
 
+    # a configured remote store is used in front of the default local cache
+    if user_cache_manager is None and os.environ.get("TRITON_REMOTE_CACHE_URL"):
+        return RemoteCacheManager(key)
+
     if user_cache_manager is not None and user_cache_manager != __cache_cls_nme:
         import importlib
         module_path, clz_nme = user_cache_manager.split(":")
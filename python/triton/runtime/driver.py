@@ -31,7 +31,8 @@ class CudaUtils(object):
             cls.instance = super(CudaUtils, cls).__new__(cls)
         return cls.instance
 
-    def __init__(self):
+    @staticmethod
+    def _build_utils():
         dirname = os.path.dirname(os.path.realpath(__file__))
         src = Path(os.path.join(dirname, "backends", "cuda.c")).read_text()
         key = hashlib.md5(src.encode("utf-8")).hexdigest()
@@ -50,8 +51,30 @@ class CudaUtils(object):
         spec = importlib.util.spec_from_file_location("cuda_utils", cache_path)
         mod = importlib.util.module_from_spec(spec)
         spec.loader.exec_module(mod)
+        return mod
+
+    def __init__(self):
+        try:
+            # built along with libtriton when the CUDA driver library was
+            # found at build time, so that no C compiler is needed at runtime
+            from .._C import cuda_utils as mod
+        except ImportError:
+            mod = self._build_utils()
         self.load_binary = mod.load_binary
         self.get_device_properties = mod.get_device_properties
+        self.write_global = mod.write_global
+        self.graph_create = mod.graph_create
+        self.graph_add_kernel_node = mod.graph_add_kernel_node
+        self.graph_set_kernel_node_params = mod.graph_set_kernel_node_params
+        self.graph_instantiate = mod.graph_instantiate
+        self.graph_launch = mod.graph_launch
+        self.graph_destroy = mod.graph_destroy
+        self.launch_tracer = mod.launch_tracer
+        self.trace_start = mod.trace_start
+        self.trace_stop = mod.trace_stop
+        self.trace_register = mod.trace_register
+        self.trace_collect = mod.trace_collect
+        self.make_launcher = mod.make_launcher
 
 
 class CudaDriver(DriverBase):
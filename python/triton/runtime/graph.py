@@ -0,0 +1,167 @@
+import struct
+from contextlib import contextmanager
+
+from .driver import driver
+from .jit import get_cuda_stream
+
+# struct formats of the kernel parameters, as passed by the generated launcher
+_param_formats = {
+    "i1": "i",
+    "i32": "i",
+    "i64": "q",
+    "u32": "I",
+    "u64": "Q",
+    "fp16": "f",
+    "bf16": "f",
+    "fp32": "f",
+    "f32": "f",
+    "fp64": "d",
+}
+
+
+def _pointer_of(arg):
+    if arg is None:
+        return 0
+    if isinstance(arg, int):
+        return arg
+    return arg.data_ptr()
+
+
+def pack_args(kernel, args):
+    """
+    Packs launch arguments the way they are laid out in the parameter space of
+    `kernel` (each argument at its natural alignment). Callable arguments are
+    evaluated first.
+    """
+    if kernel.arg_types is None:
+        raise RuntimeError("kernel was not compiled with argument type information")
+    if len(args) != len(kernel.arg_types):
+        raise TypeError(f"kernel takes {len(kernel.arg_types)} arguments, got {len(args)}")
+    fmt = "@"
+    values = []
+    for ty, arg in zip(kernel.arg_types, args):
+        if ty is None:
+            continue
+        if callable(arg):
+            arg = arg()
+        if ty[0] == "*":
+            fmt += "Q"
+            values.append(_pointer_of(arg))
+        else:
+            fmt += _param_formats[ty]
+            values.append(arg)
+    return struct.pack(fmt, *values)
+
+
+class _KernelNode:
+
+    def __init__(self, kernel, grid, args):
+        self.kernel = kernel
+        self.grid = tuple(grid) + (1,) * (3 - len(grid))
+        self.args = args
+        self.params = pack_args(kernel, args)
+        self.handle = None
+
+    @property
+    def dynamic(self):
+        return any(callable(arg) for arg in self.args)
+
+
+class KernelGraph:
+    """
+    A sequence of Triton kernel launches, replayed as a single CUDA graph.
+
+    Launches are recorded either explicitly, with `add`, or by running regular
+    launch code under `record()`; nothing is submitted to the device while
+    recording. Recorded launches run in order, exactly as if they had been
+    issued back-to-back on one stream.
+
+    Arguments of a recorded launch can be rebound with `update`. Alternatively,
+    arguments given as callables (e.g. `lambda: cache.data_ptr()`) are
+    re-evaluated on every `launch`, and the graph is patched when their value
+    changes, which keeps pointer and scalar arguments of decode loops current
+    without re-recording.
+
+    Example:
+
+        graph = KernelGraph()
+        with graph.record():
+            for layer in layers:
+                kernel[grid](x, layer.weight, n)
+        graph.launch()
+    """
+
+    def __init__(self):
+        self.nodes = []
+        self._graph = None
+        self._exec = None
+
+    def add(self, kernel, grid, *args):
+        """ appends a launch of the compiled `kernel` and returns its node id """
+        if self._exec is not None:
+            raise RuntimeError("cannot add launches to an instantiated graph")
+        if kernel.metadata.get("tensor_maps"):
+            # their tensor maps are built by the launcher, which graph nodes bypass
+            raise RuntimeError("kernels using tensor maps cannot be recorded: capture them with stream capture instead")
+        kernel._init_handles()
+        node = _KernelNode(kernel, grid, args)
+        if self._graph is None:
+            self._graph = driver.utils.graph_create()
+        dependency = self.nodes[-1].handle if self.nodes else 0
+        node.handle = driver.utils.graph_add_kernel_node(self._graph, dependency, kernel.cu_function, *node.grid,
+                                                         kernel.num_warps, kernel.shared, *kernel.cluster_dims,
+                                                         node.params)
+        self.nodes.append(node)
+        return len(self.nodes) - 1
+
+    def make_wrapper(self, kernel):
+        def record(grid_0, grid_1, grid_2, num_warps, shared, stream, function, enter_hook, exit_hook, bin, *args):
+            # like the launcher, empty grids launch nothing
+            if grid_0 * grid_1 * grid_2 > 0:
+                self.add(kernel, (grid_0, grid_1, grid_2), *args)
+        return record
+
+    @contextmanager
+    def record(self):
+        """ records the launches of Triton kernels issued within the block """
+        from ..compiler.compiler import CompiledKernel
+        if CompiledKernel.launch_recorder is not None:
+            raise RuntimeError("another KernelGraph is already recording")
+        CompiledKernel.launch_recorder = self
+        try:
+            yield self
+        finally:
+            CompiledKernel.launch_recorder = None
+
+    def _set_params(self, node):
+        kernel = node.kernel
+        driver.utils.graph_set_kernel_node_params(self._exec or 0, node.handle, kernel.cu_function, *node.grid,
+                                                  kernel.num_warps, kernel.shared, node.params)
+
+    def update(self, node_id, *args, grid=None):
+        """ rebinds the arguments (and optionally the grid) of a recorded launch """
+        node = self.nodes[node_id]
+        if grid is not None:
+            node.grid = tuple(grid) + (1,) * (3 - len(grid))
+        node.args = args
+        node.params = pack_args(node.kernel, args)
+        self._set_params(node)
+
+    def launch(self, stream=None):
+        if not self.nodes:
+            return
+        for node in self.nodes:
+            if node.dynamic:
+                params = pack_args(node.kernel, node.args)
+                if params != node.params:
+                    node.params = params
+                    self._set_params(node)
+        if self._exec is None:
+            self._exec = driver.utils.graph_instantiate(self._graph)
+        if stream is None:
+            stream = get_cuda_stream()
+        driver.utils.graph_launch(self._exec, stream)
+
+    def __del__(self):
+        if self._graph is not None or self._exec is not None:
+            driver.utils.graph_destroy(self._graph or 0, self._exec or 0)
@@ -4,14 +4,18 @@ import ast
 import functools
 import hashlib
 import inspect
+import json
 import os
-import subprocess
 import textwrap
-from collections import defaultdict, namedtuple
+import threading
+import warnings
+from collections import namedtuple
+from concurrent.futures import Future, ThreadPoolExecutor
 from typing import (Callable, Generic, Iterable, List, Optional, TypeVar, Union, cast,
                     overload)
 
-from ..common.backend import get_backend, path_to_ptxas
+from .._C.libtriton.triton import runtime as _native_runtime
+from ..common.backend import get_backend, get_ptxas_version_output, path_to_ptxas
 
 TRITON_PATH = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
 TRITON_VERSION = "2.1.0"
@@ -43,8 +47,137 @@ def get_device_capability(idx):
     return torch.cuda.get_device_capability(idx)
 
 
+@functools.lru_cache()
+def _cached_device_capability(idx):
+    return get_device_capability(idx)
+
+
 T = TypeVar('T')
 
+
+class KernelCache(dict):
+    """
+    The compiled kernels of a JITFunction on one device, keyed by the full
+    launcher key. `launches` additionally maps the natively built keys of the
+    launcher's fast path to the same kernels, and is dropped whenever the
+    kernels themselves change so that it can never go stale.
+
+    Lookups are plain dict reads and take no lock. Misses go through
+    `compile_once`, so that threads asking for the same kernel concurrently
+    wait on a single compilation instead of each running their own.
+    """
+
+    def __init__(self, *args, **kwargs):
+        super().__init__(*args, **kwargs)
+        self.launches = dict()
+        self._lock = threading.Lock()
+        self._in_flight = dict()
+        self._background = dict()
+
+    def compile_once(self, key, compile_fn):
+        """
+        Returns the kernel cached under `key`, compiling it with `compile_fn`
+        if needed. Only the first of several concurrent callers compiles;
+        the others block until it is done and get its result (or exception).
+        A None result is handed out but not cached.
+        """
+        with self._lock:
+            bin = self.get(key, None)
+            if bin is not None:
+                return bin
+            future = self._in_flight.get(key, None)
+            owner = future is None
+            if owner:
+                future = Future()
+                self._in_flight[key] = future
+        if not owner:
+            return future.result()
+        try:
+            bin = compile_fn()
+        except BaseException as e:
+            with self._lock:
+                del self._in_flight[key]
+            future.set_exception(e)
+            raise
+        with self._lock:
+            if bin is not None:
+                dict.__setitem__(self, key, bin)
+                self.launches.clear()
+            del self._in_flight[key]
+        future.set_result(bin)
+        return bin
+
+    def compile_in_background(self, key, compile_fn):
+        """
+        Runs `compile_once(key, compile_fn)` on the background compilation
+        thread, unless the kernel is cached or was already scheduled. A
+        failed compilation is reported as a warning and is not retried.
+        """
+        def run():
+            try:
+                self.compile_once(key, compile_fn)
+            except Exception as e:
+                warnings.warn(f"background compilation failed: {e}")
+                return
+            with self._lock:
+                del self._background[key]
+        with self._lock:
+            if key in self or key in self._background:
+                return
+            self._background[key] = _background_compiler().submit(run)
+
+    def wait(self):
+        """ Blocks until the kernels compiling in the background are done """
+        with self._lock:
+            futures = list(self._background.values())
+        for future in futures:
+            future.result()
+
+    def __setitem__(self, key, value):
+        self.launches.clear()
+        super().__setitem__(key, value)
+
+    def __delitem__(self, key):
+        self.launches.clear()
+        super().__delitem__(key)
+
+    def clear(self):
+        self.launches.clear()
+        super().clear()
+
+    def pop(self, *args):
+        self.launches.clear()
+        return super().pop(*args)
+
+    def popitem(self):
+        self.launches.clear()
+        return super().popitem()
+
+    def update(self, *args, **kwargs):
+        self.launches.clear()
+        super().update(*args, **kwargs)
+
+    def setdefault(self, key, default=None):
+        self.launches.clear()
+        return super().setdefault(key, default)
+
+
+@functools.lru_cache()
+def _background_compiler():
+    return ThreadPoolExecutor(max_workers=1, thread_name_prefix="triton-background-compile")
+
+
+def _generic_spec(spec_key):
+    # `spec_key` with no argument specialized
+    return tuple(False if isinstance(spec, bool) else (False,) * len(spec) for spec in spec_key)
+
+
+class DeviceKernelCaches(dict):
+    """ `KernelCache`s by device; created on first use without racing threads """
+
+    def __missing__(self, device):
+        return self.setdefault(device, KernelCache())
+
 # -----------------------------------------------------------------------------
 # Dependencies Finder
 # -----------------------------------------------------------------------------
@@ -96,6 +229,17 @@ class DependenciesFinder(ast.NodeVisitor):
 # -----------------------------------------------------------------------------
 
 
+def _library_hash(path):
+    # the build writes the hash of the library next to it, which is much
+    # cheaper to read than hashing the library
+    hash_path = path + ".md5"
+    if os.path.exists(hash_path) and os.path.getmtime(hash_path) >= os.path.getmtime(path):
+        with open(hash_path) as f:
+            return f.read().strip()
+    with open(path, "rb") as f:
+        return hashlib.md5(f.read()).hexdigest()
+
+
 @functools.lru_cache()
 def version_key():
     import pkgutil
@@ -109,16 +253,15 @@ def version_key():
         with open(lib.module_finder.find_spec(lib.name).origin, "rb") as f:
             contents += [hashlib.md5(f.read()).hexdigest()]
     # backend
-    with open(os.path.join(TRITON_PATH, "_C/libtriton.so"), "rb") as f:
-        contents += [hashlib.md5(f.read()).hexdigest()]
+    contents += [_library_hash(os.path.join(TRITON_PATH, "_C/libtriton.so"))]
     # language
     language_path = os.path.join(TRITON_PATH, 'language')
     for lib in pkgutil.iter_modules([language_path]):
         with open(lib.module_finder.find_spec(lib.name).origin, "rb") as f:
             contents += [hashlib.md5(f.read()).hexdigest()]
     # ptxas version
-    ptxas = path_to_ptxas()[0]
-    ptxas_version = hashlib.md5(subprocess.check_output([ptxas, "--version"])).hexdigest()
+    ptxas = path_to_ptxas()[0].split(" ")[0]
+    ptxas_version = hashlib.md5(get_ptxas_version_output(ptxas).encode("utf-8")).hexdigest()
     return '-'.join(TRITON_VERSION) + '-' + ptxas_version + '-' + '-'.join(contents)
 
 
@@ -206,6 +349,47 @@ class JITFunction(KernelInterface[T]):
         return namedtuple("instance_descriptor", ["divisible_by_16", "equal_to_1"])(tuple(divisible_by_16), tuple(equal_to_1))
         # return _triton.code_gen.instance_descriptor(divisible_by_16, equal_to_1)
 
+    def _get_generic_config(self):
+        # the configuration of the kernel that tiered compilation falls back
+        # to: no argument is specialized, as with `do_not_specialize`
+        return namedtuple("instance_descriptor", ["divisible_by_16", "equal_to_1"])((), ())
+
+    def _peer_kernel(self, device, device_type, key):
+        """
+        The kernel cached under `key` for another device with the same
+        architecture as `device`, if any. A `CompiledKernel` loads itself on
+        each device it is launched on, so that the devices of a node can
+        share a single compilation or cache read.
+        """
+        if device_type not in ["cuda", "hip"]:
+            return None
+        capability = _cached_device_capability(device)
+        for peer, cache in list(self.cache.items()):
+            bin = cache.get(key, None)
+            if peer != device and bin is not None and _cached_device_capability(peer) == capability:
+                return bin
+        return None
+
+    def _tiered_kernel(self, device, key, compile_fn, generic_key, compile_generic_fn):
+        """
+        Returns the kernel to launch now for a miss on `key` in tiered mode.
+        If the generic variant of the kernel, compiled without any argument
+        specialization, is cached, it is launched while the specialized kernel
+        compiles in the background; later launches find the latter in the
+        cache once it is ready. Otherwise the specialized kernel is compiled
+        on the spot, and the generic variant in the background, for the next
+        misses.
+        """
+        cache = self.cache[device]
+        generic = cache.get(generic_key, None)
+        if generic is None:
+            bin = cache.compile_once(key, compile_fn)
+            if key != generic_key:
+                cache.compile_in_background(generic_key, compile_generic_fn)
+            return bin
+        cache.compile_in_background(key, compile_fn)
+        return generic
+
     @staticmethod
     def _type_of(key):
         # None are nullptr -- implicitly converted to *i8
@@ -243,6 +427,20 @@ class JITFunction(KernelInterface[T]):
         constants = dict(zip(self.constexprs, constexpr_key))
         return constants
 
+    def _get_swizzle_group_size(self, constants):
+        # the number of rows of the groups of `swizzle_pids`, 0 if the program
+        # ids are not remapped
+        if isinstance(self.swizzle_pids, str):
+            return int(constants[self.arg_names.index(self.swizzle_pids)])
+        return self.swizzle_pids or 0
+
+    def _get_launch_bound(self, bound, constants):
+        # `maxnreg` and `min_blocks_per_sm` like `swizzle_pids`: a number, or
+        # the name of the constexpr argument holding it; 0 if unbounded
+        if isinstance(bound, str):
+            return int(constants[self.arg_names.index(bound)])
+        return bound or 0
+
     def _call_hook(self, key, signature, device, constants, num_warps, num_stages, extern_libs, configs):
         if JITFunction.cache_hook is None:
             return False
@@ -264,6 +462,29 @@ class JITFunction(KernelInterface[T]):
 
         return JITFunction.cache_hook(key=key, repr=repr, fn=LegacyCompiler(module, name), compile={"key": key, **kwargs}, is_manual_warmup=False, already_compiled=False)
 
+    def _record_manifest(self, all_args, num_warps, num_stages, extern_libs):
+        """
+        Appends the specialization being compiled to the manifest named by
+        `TRITON_KERNEL_MANIFEST`, for `warmup_from_manifest`. Launches with
+        arguments that can't be described in JSON are not recorded.
+        """
+        args = []
+        for i, arg in enumerate(all_args):
+            if i not in self.constexprs and hasattr(arg, "data_ptr"):
+                args.append({"dtype": str(arg.dtype).split(".")[-1],
+                             "aligned": arg.data_ptr() % JITFunction.divisibility == 0})
+            else:
+                args.append({"value": arg})
+        entry = {"module": self.module, "name": self.__name__, "args": args,
+                 "num_warps": num_warps, "num_stages": num_stages, "extern_libs": extern_libs}
+        try:
+            line = json.dumps(entry, sort_keys=True)
+        except (TypeError, ValueError):
+            return
+        with _manifest_lock:
+            with open(_manifest_path(), "a") as f:
+                f.write(line + "\n")
+
     def _get_arg_specialization_key(self, arg) -> str:
         arg_annotation = self.__annotations__.get(arg, '')
         if arg_annotation == '':
@@ -324,16 +545,40 @@ class JITFunction(KernelInterface[T]):
         grid_args = ','.join([f'"{arg}": {arg}' for arg in self.arg_names])
         args_signature = ', '.join(name if dflt == inspect._empty else f'{name} = {dflt}' for name, dflt in zip(self.arg_names, self.arg_defaults))
 
+        all_args = ', '.join(self.arg_names)
+
         src = f"""
 def {self.fn.__name__}({args_signature}, grid=None, num_warps=4, num_stages=3, extern_libs=None, stream=None, warmup=False, device=None, device_type=None):
     from ..compiler import compile, CompiledKernel
+    # fast path: the whole argument key is built natively and looked up in a
+    # single dict, which is all that's needed once the kernel was launched
+    # with equivalent arguments on the current device
+    fast_key = None
+    if not warmup and grid is not None and extern_libs is None and device_type is None:
+        fast_key = _launch_key(({all_args},), _constexpr_mask, num_warps, num_stages)
+        if fast_key is not None:
+            fast_device = get_current_device() if device is None else device
+            bin = cache[fast_device].launches.get(fast_key, None)
+            if bin is not None:
+                if callable(grid):
+                    grid = grid({{{grid_args}}})
+                grid_size = len(grid)
+                grid_0 = grid[0]
+                grid_1 = grid[1] if grid_size > 1 else 1
+                grid_2 = grid[2] if grid_size > 2 else 1
+                if bin.large_grid == (grid_1 > 65535 or grid_2 > 65535):
+                    if stream is None:
+                        stream = get_cuda_stream(fast_device)
+                    bin.c_wrapper(grid_0, grid_1, grid_2, bin.num_warps, bin.shared, stream, bin.get_function(fast_device), CompiledKernel.launch_enter_hook, CompiledKernel.launch_exit_hook, bin, {args})
+                    return bin
     sig_key =  {sig_keys},
     constexpr_key = {f'{constexpr_keys},' if len(constexpr_keys) > 0 else ()}
     spec_key = {f'{spec_keys},' if len(spec_keys) > 0 else ()}
-    key = (version_key, sig_key, constexpr_key, spec_key, num_warps, num_stages, self.debug)
+    options_key = (num_warps, num_stages, self.debug, self.i32_offsets, self.warp_specialize, self.enable_tma, self.swizzle_pids, self.fast_math, self.print_buffer, self.opt_level, self.maxnreg, self.min_blocks_per_sm, self.num_ctas)
+    key = (version_key, sig_key, constexpr_key, spec_key) + options_key
     if not extern_libs is None:
       key = (key, tuple(extern_libs.items()))
-    assert num_warps > 0 and (num_warps & (num_warps - 1)) == 0, "num_warps must be a power of 2"
+    assert num_warps == "auto" or num_warps > 0 and (num_warps & (num_warps - 1)) == 0, "num_warps must be a power of 2"
     assert grid is not None
     if callable(grid):
         grid = grid({{{grid_args}}})
@@ -341,6 +586,11 @@ def {self.fn.__name__}({args_signature}, grid=None, num_warps=4, num_stages=3, e
     grid_0 = grid[0]
     grid_1 = grid[1] if grid_size > 1 else 1
     grid_2 = grid[2] if grid_size > 2 else 1
+    # grids with more than 65535 programs along axes 1 or 2 are launched
+    # along axis 0 by a variant of the kernel that recovers its program ids
+    large_grid = grid_1 > 65535 or grid_2 > 65535
+    if large_grid:
+        key = (key, "large_grid")
 
     if device_type is None:
         device_types = [_device_type for _device_type in {device_types} if _device_type != '']
@@ -368,7 +618,9 @@ def {self.fn.__name__}({args_signature}, grid=None, num_warps=4, num_stages=3, e
     bin = cache[device].get(key, None)
     if bin is not None:
       if not warmup:
-          bin.c_wrapper(grid_0, grid_1, grid_2, bin.num_warps, bin.shared, stream, bin.cu_function, CompiledKernel.launch_enter_hook, CompiledKernel.launch_exit_hook, bin, {args})
+          bin.c_wrapper(grid_0, grid_1, grid_2, bin.num_warps, bin.shared, stream, bin.get_function(device), CompiledKernel.launch_enter_hook, CompiledKernel.launch_exit_hook, bin, {args})
+          if fast_key is not None and device_type in ['cuda', 'hip']:
+              cache[device].launches[fast_key] = bin
       return bin
     # kernel not cached -- compile
     else:
@@ -385,18 +637,46 @@ def {self.fn.__name__}({args_signature}, grid=None, num_warps=4, num_stages=3, e
       for i, arg in constants.items():
         if callable(arg):
           raise TypeError(f"Callable constexpr at index {{i}} is not supported")
-      if not self._call_hook(key, signature, device, constants, num_warps, num_stages, extern_libs, configs):
-        bin = compile(self, signature=signature, device=device, constants=constants, num_warps=num_warps, num_stages=num_stages, extern_libs=extern_libs, configs=configs, debug=self.debug, device_type=device_type)
-        if not warmup:
-            bin.c_wrapper(grid_0, grid_1, grid_2, bin.num_warps, bin.shared, stream, bin.cu_function, CompiledKernel.launch_enter_hook, CompiledKernel.launch_exit_hook, bin, *args)
-        self.cache[device][key] = bin
+      def _compile(key=key, configs=configs, constants=constants):
+        # devices of the same architecture share their kernels
+        peer = self._peer_kernel(device, device_type, key)
+        if peer is not None:
+          return peer
+        if self._call_hook(key, signature, device, constants, num_warps, num_stages, extern_libs, configs):
+          return None
+        if _manifest_path():
+          self._record_manifest(all_args, num_warps, num_stages, extern_libs)
+        return compile(self, signature=signature, device=device, constants=constants, num_warps=num_warps, num_stages=num_stages, extern_libs=extern_libs, configs=configs, debug=self.debug, i32_offsets=self.i32_offsets, warp_specialize=self.warp_specialize, enable_tma=self.enable_tma, swizzle_pids=self._get_swizzle_group_size(constants), large_grid=large_grid, fast_math=self.fast_math, print_buffer=self.print_buffer, opt_level=self.opt_level, maxnreg=self._get_launch_bound(self.maxnreg, constants), min_blocks_per_sm=self._get_launch_bound(self.min_blocks_per_sm, constants), num_ctas=self._get_launch_bound(self.num_ctas, constants) or 1, device_type=device_type)
+      if self.tiered and not warmup:
+        generic_key = (version_key, sig_key, constexpr_key, _generic_spec(spec_key)) + options_key
+        if not extern_libs is None:
+          generic_key = (generic_key, tuple(extern_libs.items()))
+        if large_grid:
+          generic_key = (generic_key, "large_grid")
+        generic_configs = self._get_generic_config(),
+        generic_constants = {{i: arg for i, arg in constants.items() if i not in configs[0].equal_to_1}}
+        bin = self._tiered_kernel(device, key, _compile, generic_key, lambda: _compile(generic_key, generic_configs, generic_constants))
+        if bin is not None:
+          bin.c_wrapper(grid_0, grid_1, grid_2, bin.num_warps, bin.shared, stream, bin.get_function(device), CompiledKernel.launch_enter_hook, CompiledKernel.launch_exit_hook, bin, *args)
         return bin
-      return None
+      # concurrent cold calls with the same key share a single compilation
+      bin = self.cache[device].compile_once(key, _compile)
+      if bin is None:
+        return None
+      if not warmup:
+          bin.c_wrapper(grid_0, grid_1, grid_2, bin.num_warps, bin.shared, stream, bin.get_function(device), CompiledKernel.launch_enter_hook, CompiledKernel.launch_exit_hook, bin, *args)
+      if fast_key is not None and device_type in ['cuda', 'hip']:
+          self.cache[device].launches[fast_key] = bin
+      return bin
 """
         scope = {"version_key": version_key(),
+                 "_launch_key": _native_runtime.launch_key,
+                 "_manifest_path": _manifest_path,
+                 "_constexpr_mask": tuple(i in self.constexprs for i in range(len(self.arg_names))),
                  "get_cuda_stream": get_cuda_stream,
                  "self": self,
                  "_spec_of": self._spec_of,
+                 "_generic_spec": _generic_spec,
                  "_key_of": self._key_of,
                  "_device_of": self._device_of,
                  "_pinned_memory_of": self._pinned_memory_of,
@@ -408,7 +688,9 @@ def {self.fn.__name__}({args_signature}, grid=None, num_warps=4, num_stages=3, e
         exec(src, scope)
         return scope[self.fn.__name__]
 
-    def __init__(self, fn, version=None, do_not_specialize=None, debug=None, noinline=None):
+    def __init__(self, fn, version=None, do_not_specialize=None, debug=None, noinline=None, i32_offsets=False,
+                 warp_specialize=False, enable_tma=False, swizzle_pids=None, fast_math=False, print_buffer=False,
+                 opt_level=None, maxnreg=None, min_blocks_per_sm=None, num_ctas=None, tiered=False):
         self.fn = fn
         self.module = fn.__module__
         self.version = version
@@ -424,7 +706,7 @@ def {self.fn.__name__}({args_signature}, grid=None, num_warps=4, num_stages=3, e
         self.src = textwrap.dedent(inspect.getsource(fn))
         self.src = self.src[self.src.find("def"):]
         # cache of just-in-time compiled kernels
-        self.cache = defaultdict(dict)
+        self.cache = DeviceKernelCaches()
         self.hash = None
         # JITFunction can be instantiated as kernel
         # when called with a grid using __getitem__
@@ -432,10 +714,25 @@ def {self.fn.__name__}({args_signature}, grid=None, num_warps=4, num_stages=3, e
         self.kernel = None
         self.debug = True if os.environ.get("TRITON_DEBUG", "0") == "1" else debug
         self.noinline = noinline
+        self.i32_offsets = i32_offsets
+        self.warp_specialize = warp_specialize
+        self.enable_tma = enable_tma
+        self.swizzle_pids = swizzle_pids
+        self.fast_math = fast_math
+        self.print_buffer = print_buffer or os.environ.get("TRITON_PRINT_BUFFER", "0") == "1"
+        self.opt_level = int(os.environ.get("TRITON_OPT_LEVEL", "3")) if opt_level is None else opt_level
+        assert self.opt_level in (0, 1, 2, 3), f"opt_level must be 0, 1, 2 or 3, got {self.opt_level}"
+        self.maxnreg = maxnreg
+        self.min_blocks_per_sm = min_blocks_per_sm
+        self.num_ctas = num_ctas
+        self.tiered = tiered or os.environ.get("TRITON_TIERED_COMPILE", "0") == "1"
         # annotations
         self.__annotations__ = {name: _normalize_ty(ty) for name, ty in fn.__annotations__.items()}
         # index of constexprs
         self.constexprs = [self.arg_names.index(name) for name, ty in self.__annotations__.items() if 'constexpr' in ty]
+        if isinstance(swizzle_pids, str):
+            assert swizzle_pids in self.arg_names and self.arg_names.index(swizzle_pids) in self.constexprs, \
+                f"swizzle_pids={swizzle_pids!r} is not a constexpr argument of {fn.__name__}"
         # launcher
         self.run = self._make_launcher()
         # re-use docs of wrapped function
@@ -446,12 +743,14 @@ def {self.fn.__name__}({args_signature}, grid=None, num_warps=4, num_stages=3, e
 
     @property
     def cache_key(self):
-        # TODO : hash should be attribute of `self`
+        # `hash` covers the source of the function and of its callees, and is
+        # computed once per function object, whether for its own key or while
+        # hashing a caller
         if self.hash is None:
             dependencies_finder = DependenciesFinder(globals=self.__globals__, src=self.src)
             dependencies_finder.visit(self.parse())
-            self.hash = dependencies_finder.ret + version_key()
-        return self.hash
+            self.hash = dependencies_finder.ret
+        return self.hash + version_key()
 
     def warmup(self, *args, **kwargs):
         return self.run(*map(MockTensor.wrap_dtype, args), **kwargs, warmup=True)
@@ -469,12 +768,21 @@ def {self.fn.__name__}({args_signature}, grid=None, num_warps=4, num_stages=3, e
     def __call__(self, *args, **kwargs):
         raise RuntimeError("Cannot call @triton.jit'd outside of the scope of a kernel")
 
+    # compilation options in the key of the launcher's slow path
+    _launch_options = frozenset(['debug', 'i32_offsets', 'warp_specialize', 'enable_tma', 'swizzle_pids', 'fast_math',
+                                 'print_buffer', 'opt_level', 'maxnreg', 'min_blocks_per_sm', 'num_ctas'])
+
     def __setattr__(self, name, value):
         # - when kernel decorators change, cached kernel
         #   needs to be cleared
         if name == 'kernel_decorators':
             self.kernel = None
         super(JITFunction, self).__setattr__(name, value)
+        # - the keys of the launcher's fast path leave out the compilation
+        #   options, so its launches are dropped when one changes
+        if name in self._launch_options and 'cache' in self.__dict__:
+            for kernel_cache in self.cache.values():
+                kernel_cache.launches.clear()
         # - when `.src` attribute is set, cache path needs
         #   to be reinitialized
         if name == 'src':
@@ -501,6 +809,17 @@ def jit(
     do_not_specialize: Optional[Iterable[int]] = None,
     debug: Optional[bool] = None,
     noinline: Optional[bool] = None,
+    i32_offsets: bool = False,
+    warp_specialize: bool = False,
+    enable_tma: bool = False,
+    swizzle_pids: Optional[Union[int, str]] = None,
+    fast_math: bool = False,
+    print_buffer: bool = False,
+    opt_level: Optional[int] = None,
+    maxnreg: Optional[Union[int, str]] = None,
+    min_blocks_per_sm: Optional[Union[int, str]] = None,
+    num_ctas: Optional[Union[int, str]] = None,
+    tiered: bool = False,
 ) -> Callable[[T], JITFunction[T]]:
     ...
 
@@ -512,6 +831,17 @@ def jit(
     do_not_specialize: Optional[Iterable[int]] = None,
     debug: Optional[bool] = None,
     noinline: Optional[bool] = None,
+    i32_offsets: bool = False,
+    warp_specialize: bool = False,
+    enable_tma: bool = False,
+    swizzle_pids: Optional[Union[int, str]] = None,
+    fast_math: bool = False,
+    print_buffer: bool = False,
+    opt_level: Optional[int] = None,
+    maxnreg: Optional[Union[int, str]] = None,
+    min_blocks_per_sm: Optional[Union[int, str]] = None,
+    num_ctas: Optional[Union[int, str]] = None,
+    tiered: bool = False,
     interpret: Optional[bool] = None,
 ) -> Union[JITFunction[T], Callable[[T], JITFunction[T]]]:
     """
@@ -530,6 +860,70 @@ def jit(
 
     :param fn: the function to be jit-compiled
     :type fn: Callable
+    :param noinline: compile the function, when called from other jit'd
+        functions, as a device function of its own rather than inlining it.
+        Tensor arguments and results are passed in the registers of their
+        layout, and the callee gets the base of its own shared memory
+    :type noinline: bool
+    :param i32_offsets: promise that every tensor the kernel accesses is smaller
+        than 2GB, so that pointer offsets are computed in 32 bits even when the
+        kernel computes them in 64 bits
+    :type i32_offsets: bool
+    :param warp_specialize: on sm80 and later, launch a second group of
+        :code:`num_warps` warps that loads the dot operands of the main loop
+        into shared memory, so that the warps computing the dots do not issue
+        the loads
+    :type warp_specialize: bool
+    :param enable_tma: on sm90, load the blocks of block pointers with the
+        Tensor Memory Accelerator when their tensors can be described by
+        tensor maps, which the launcher builds on the host
+    :type enable_tma: bool
+    :param swizzle_pids: remap the program ids of a 2-D grid so that programs
+        launched together compute tiles in groups of this many rows (axis 0),
+        column after column (axis 1), which then share their operands in L2.
+        Either a number of rows, or the name of a :code:`tl.constexpr`
+        argument holding it, which autotuner configs can then set
+    :type swizzle_pids: int or str
+    :param fast_math: lower f32 division, square roots, exponentials,
+        logarithms, sines, cosines and the libdevice :code:`rsqrt`, :code:`exp2`,
+        :code:`log2` and :code:`tanh` to approximate instructions that flush
+        denormals to zero, and let LLVM reassociate and contract floating-point
+        operations, like nvcc's :code:`--use_fast_math`
+    :type fast_math: bool
+    :param print_buffer: write the values of :code:`tl.device_print` as binary
+        records to a ring buffer of device memory, with one atomic per warp,
+        instead of formatting them with :code:`vprintf`. The records are
+        formatted on the host by :code:`triton.runtime.flush_print_buffer`.
+        Also enabled by setting the environment variable
+        :code:`TRITON_PRINT_BUFFER=1`
+    :type print_buffer: bool
+    :param opt_level: optimization level, from 0 to 3, of LLVM, its NVPTX
+        backend and ptxas. Lower levels compile faster, which suits
+        autotuning sweeps and debugging, but generate slower kernels.
+        Defaults to the environment variable :code:`TRITON_OPT_LEVEL`, or 3
+    :type opt_level: int
+    :param maxnreg: the most registers a thread of the kernel may use, which
+        trades spills for occupancy. Like :code:`swizzle_pids`, either a
+        number or the name of a :code:`tl.constexpr` argument holding it, so
+        that autotuner configs can search over it
+    :type maxnreg: int or str
+    :param min_blocks_per_sm: the number of programs that must be able to run
+        on an SM at once, which bounds the registers of a thread accordingly.
+        Either a number or the name of a :code:`tl.constexpr` argument
+    :type min_blocks_per_sm: int or str
+    :param num_ctas: on sm90, launch the programs in thread block clusters of
+        this many consecutive programs along axis 0, at most 8, which run at
+        once and can synchronize with :code:`tl.cluster_barrier`. The grid
+        size along axis 0 must be a multiple of it. Either a number or the
+        name of a :code:`tl.constexpr` argument
+    :type num_ctas: int or str
+    :param tiered: when a launch needs a specialization of the kernel (for
+        the divisibility by 16 or the value 1 of its arguments) that isn't
+        compiled yet, launch a variant that doesn't specialize on any
+        argument, if it was compiled, and compile the specialized kernel on a
+        background thread for the next launches. Also enabled by setting the
+        environment variable :code:`TRITON_TIERED_COMPILE=1`
+    :type tiered: bool
     """
 
     def decorator(fn: T) -> JITFunction[T]:
@@ -544,6 +938,17 @@ def jit(
                 do_not_specialize=do_not_specialize,
                 debug=debug,
                 noinline=noinline,
+                i32_offsets=i32_offsets,
+                warp_specialize=warp_specialize,
+                enable_tma=enable_tma,
+                swizzle_pids=swizzle_pids,
+                fast_math=fast_math,
+                print_buffer=print_buffer,
+                opt_level=opt_level,
+                maxnreg=maxnreg,
+                min_blocks_per_sm=min_blocks_per_sm,
+                num_ctas=num_ctas,
+                tiered=tiered,
             )
     if fn is not None:
         return decorator(fn)
@@ -568,12 +973,64 @@ class MockTensor:
             return MockTensor(arg)
         return arg
 
-    def __init__(self, dtype):
+    def __init__(self, dtype, aligned=True):
         self.dtype = dtype
+        self.aligned = aligned
 
-    @staticmethod
-    def data_ptr():
-        return 0  # optimistically assumes multiple of 16
+    def data_ptr(self):
+        # by default, optimistically assumes multiple of 16
+        return 0 if self.aligned else 1
+
+
+_manifest_lock = threading.Lock()
+
+
+def _manifest_path():
+    return os.environ.get("TRITON_KERNEL_MANIFEST", "")
+
+
+def warmup_from_manifest(path, max_workers=None):
+    """
+    Compiles, in parallel, every kernel specialization recorded in the
+    manifest at `path`, and makes them available to the launchers of this
+    process as if they had already been launched.
+
+    Manifests are written by processes run with `TRITON_KERNEL_MANIFEST`
+    set: each JSON line describes one compiled specialization (the
+    arguments' dtypes and alignment, constexpr and scalar values, num_warps
+    and num_stages). Kernels are looked up by module and name, so their
+    modules must be importable. Entries that fail to compile are skipped
+    with a warning.
+
+    :return: the number of specializations compiled or loaded from cache
+    """
+    import importlib
+
+    import torch
+
+    with open(path) as f:
+        entries = list(dict.fromkeys(line.strip() for line in f if line.strip()))
+
+    def warmup(line):
+        entry = json.loads(line)
+        fn = getattr(importlib.import_module(entry["module"]), entry["name"])
+        # unwrap autotuners and heuristics
+        while not isinstance(fn, JITFunction):
+            fn = fn.fn
+        args = [MockTensor(getattr(torch, arg["dtype"]), arg["aligned"]) if "dtype" in arg else arg["value"]
+                for arg in entry["args"]]
+        return fn.run(*args, grid=(1,), num_warps=entry["num_warps"], num_stages=entry["num_stages"],
+                      extern_libs=entry["extern_libs"], warmup=True)
+
+    def try_warmup(line):
+        try:
+            return warmup(line) is not None
+        except Exception as e:
+            warnings.warn(f"could not warm up {line}: {e}")
+            return False
+
+    with ThreadPoolExecutor(max_workers=max_workers) as executor:
+        return sum(executor.map(try_warmup, entries))
 
 
 class TensorWrapper:
@@ -0,0 +1,45 @@
+"""
+Theoretical occupancy of a kernel, from the resources of its CTAs and those
+of an SM, as reported by `driver.utils.get_device_properties`.
+"""
+
+# registers are allocated to warps in units of this many
+_REG_ALLOC_UNIT = 256
+
+
+def _round_up(value, unit):
+    return (value + unit - 1) // unit * unit
+
+
+def get_occupancy(num_warps, n_regs, shared, props):
+    """
+    The CTAs of a kernel launched with `num_warps` warps, using `n_regs`
+    registers per thread and `shared` bytes of shared memory, that can be
+    resident on an SM at once.
+
+    :return: a dict with the resident `ctas_per_sm` and `warps_per_sm`, the
+        `occupancy` (ratio of the resident warps to the most an SM can run)
+        and the resource that `limit`s it: "warps", "blocks", "registers" or
+        "shared". Limits whose SM capacity the device does not report are
+        ignored.
+    """
+    warp_size = props.get("warp_size", 32)
+    max_warps = props.get("max_threads_per_sm", 0) // warp_size
+    limits = dict()
+    if max_warps:
+        limits["warps"] = max_warps // num_warps
+    if props.get("max_blocks_per_sm"):
+        limits["blocks"] = props["max_blocks_per_sm"]
+    if n_regs and props.get("max_regs_per_sm"):
+        regs_per_warp = _round_up(n_regs * warp_size, _REG_ALLOC_UNIT)
+        limits["registers"] = props["max_regs_per_sm"] // regs_per_warp // num_warps
+    if shared and props.get("max_shared_mem_per_sm"):
+        limits["shared"] = props["max_shared_mem_per_sm"] // shared
+    if not limits:
+        return None
+    limit = min(limits, key=limits.get)
+    ctas = limits[limit]
+    return {"ctas_per_sm": ctas,
+            "warps_per_sm": ctas * num_warps,
+            "occupancy": ctas * num_warps / max_warps if max_warps else None,
+            "limit": limit}
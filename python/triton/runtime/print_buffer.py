@@ -0,0 +1,120 @@
+import struct
+import sys
+
+from .driver import driver
+from .jit import get_current_device
+
+# words of a record before the values, see BufferedPrintOpConversion
+_HEADER_WORDS = 7
+_WARP_SIZE = 32
+
+
+def _format_value(ty, words):
+    if ty.startswith("!tt.ptr"):
+        return hex(words[0] | words[1] << 32)
+    if ty == "f64":
+        return str(struct.unpack("<d", struct.pack("<II", *words))[0])
+    if ty == "f32":
+        return str(struct.unpack("<f", struct.pack("<I", words[0]))[0])
+    if ty == "f16":
+        return str(struct.unpack("<e", struct.pack("<H", words[0] & 0xffff))[0])
+    if ty == "bf16":
+        return str(struct.unpack("<f", struct.pack("<I", (words[0] & 0xffff) << 16))[0])
+    if ty.startswith("i"):
+        bits = int(ty[1:])
+        value = words[0] if bits <= 32 else words[0] | words[1] << 32
+        if bits > 1 and value >> (bits - 1):
+            value -= 1 << bits
+        return str(value)
+    # fp8 and other types are shown as their bits
+    return hex(words[0])
+
+
+def _num_words(ty):
+    return 2 if ty.startswith("!tt.ptr") or ty in ("f64", "i64") else 1
+
+
+class PrintBuffer:
+    """
+    Ring buffer of device memory that kernels compiled with
+    :code:`print_buffer=True` write the values of their :code:`tl.device_print`
+    to, as binary records reserved with one atomic per warp. :code:`flush`
+    formats them on the host; once the buffer wraps around, the oldest records
+    are overwritten.
+    """
+
+    def __init__(self, device, capacity=1 << 24):
+        import torch
+        assert capacity & (capacity - 1) == 0, "the capacity must be a power of two"
+        self.capacity = capacity
+        # the 64-bit count of reserved words, then the records
+        self.data = torch.zeros(capacity + 2, dtype=torch.int32, device=device)
+        # the print records of the modules, by key
+        self.modules = []
+
+    def attach(self, module, print_records):
+        """Points the prints of a loaded module to this buffer."""
+        key = len(self.modules)
+        self.modules.append(print_records)
+        desc = struct.pack("<QQQ", self.data.data_ptr(), self.capacity, key)
+        driver.utils.write_global(module, "triton_print_buffer", desc)
+
+    def _records(self, words):
+        head = words[0] | words[1] << 32
+        ring = words[2:]
+        word = lambda i: ring[i & (self.capacity - 1)]
+        pos = max(0, head - self.capacity)
+        # the first records left may be partly overwritten; a record starts
+        # with its own logical offset
+        while pos < head and word(pos) != pos & 0xffffffff:
+            pos += 1
+        while pos < head and word(pos) == pos & 0xffffffff:
+            key, id_and_size = word(pos + 1), word(pos + 2)
+            size = id_and_size & 0xffff
+            if size == 0 or pos + size > head or key >= len(self.modules):
+                break
+            yield self.modules[key][id_and_size >> 16], [word(pos + i) for i in range(size)]
+            pos += size
+
+    def flush(self, file=None):
+        """
+        Waits for the device, writes the records in the buffer to :code:`file`
+        (standard output by default) and empties the buffer.
+        """
+        import torch
+        file = sys.stdout if file is None else file
+        torch.cuda.synchronize(self.data.device)
+        words = [w & 0xffffffff for w in self.data.tolist()]
+        for record, values in self._records(words):
+            pid = tuple(values[3:6])
+            warp = values[6]
+            for lane in range(_WARP_SIZE):
+                slot = 0
+                formatted = []
+                for ty, num_elems in record["args"]:
+                    for _ in range(num_elems):
+                        n = _num_words(ty)
+                        elem_words = [values[_HEADER_WORDS + (slot + i) * _WARP_SIZE + lane] for i in range(n)]
+                        formatted.append(_format_value(ty, elem_words))
+                        slot += n
+                tid = warp * _WARP_SIZE + lane
+                print(f"pid ({pid[0]}, {pid[1]}, {pid[2]}) tid {tid}{record['prefix']}{', '.join(formatted)}", file=file)
+        self.data[:2].zero_()
+
+
+_print_buffers = dict()
+
+
+def get_print_buffer(device=None):
+    """The print buffer of :code:`device`, created on first use."""
+    if device is None:
+        device = get_current_device()
+    if device not in _print_buffers:
+        _print_buffers[device] = PrintBuffer(device)
+    return _print_buffers[device]
+
+
+def flush_print_buffer(device=None, file=None):
+    """Formats the device prints buffered since the last flush."""
+    if device in _print_buffers or (device is None and get_current_device() in _print_buffers):
+        get_print_buffer(device).flush(file)
@@ -0,0 +1,88 @@
+"""
+Native tracing of kernel launches.
+
+While tracing, the launchers of CUDA kernels record each launch (kernel name,
+grid, stream, host time and, optionally, the GPU time measured with CUDA
+events) into a ring buffer of the launching thread, without taking a lock or
+calling into Python. Unlike `CompiledKernel.launch_enter_hook`, this is cheap
+enough to leave enabled in production.
+
+.. code-block:: python
+
+    triton.runtime.tracing.start()
+    serve()
+    triton.runtime.tracing.export_chrome_trace("trace.json")
+"""
+
+import json
+
+from .driver import driver
+
+
+def start(events=True, nvtx=False, capacity=1 << 16):
+    """
+    Start recording launches.
+
+    :param events: time the kernels on their streams with CUDA events, which
+        costs two event records per launch
+    :param nvtx: wrap each launch in an NVTX range named after the kernel,
+        for Nsight Systems
+    :param capacity: the launches each thread keeps before overwriting its
+        oldest records; threads that already traced keep their buffers
+    """
+    driver.utils.trace_start(events, nvtx, capacity)
+
+
+def stop():
+    """ Stop recording launches; the recorded ones can still be collected once """
+    driver.utils.trace_stop()
+
+
+def collect():
+    """
+    The launches recorded since the last collection, as dicts with the
+    kernel `name`, `grid`, `stream`, `tid` of the launching thread, and the
+    `host_begin`, `host_end`, `gpu_begin` and `gpu_end` times in ns of
+    CLOCK_MONOTONIC (the GPU times are None without events). Synchronizes the
+    streams of the timed kernels. After `stop`, this ends the trace and frees
+    the buffers of the recorded launches.
+    """
+    launches = []
+    for name, grid_x, grid_y, grid_z, stream, tid, host_begin, host_end, gpu_begin, gpu_end in \
+            driver.utils.trace_collect():
+        launches.append({"name": name, "grid": (grid_x, grid_y, grid_z), "stream": stream, "tid": tid,
+                         "host_begin": host_begin, "host_end": host_end,
+                         "gpu_begin": gpu_begin if gpu_begin >= 0 else None,
+                         "gpu_end": gpu_end if gpu_end >= 0 else None})
+    return launches
+
+
+def to_chrome_trace(launches):
+    """
+    The Chrome trace (chrome://tracing, Perfetto) of `launches`: the host
+    side of each launch on the thread that issued it, and the kernel on its
+    stream.
+    """
+    trace_events = []
+    for launch in launches:
+        args = {"grid": list(launch["grid"]), "stream": launch["stream"]}
+        trace_events.append({"name": launch["name"], "cat": "launch", "ph": "X", "pid": "host",
+                             "tid": launch["tid"], "ts": launch["host_begin"] / 1000,
+                             "dur": (launch["host_end"] - launch["host_begin"]) / 1000, "args": args})
+        if launch["gpu_begin"] is not None:
+            trace_events.append({"name": launch["name"], "cat": "kernel", "ph": "X", "pid": "gpu",
+                                 "tid": f"stream {launch['stream']:#x}", "ts": launch["gpu_begin"] / 1000,
+                                 "dur": (launch["gpu_end"] - launch["gpu_begin"]) / 1000, "args": args})
+    return {"traceEvents": trace_events, "displayTimeUnit": "ns"}
+
+
+def export_chrome_trace(path, launches=None):
+    """
+    Write the Chrome trace of `launches`, by default those collected now,
+    to `path`. Returns the launches written.
+    """
+    if launches is None:
+        launches = collect()
+    with open(path, "w") as f:
+        json.dump(to_chrome_trace(launches), f)
+    return launches
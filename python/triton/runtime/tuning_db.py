@@ -0,0 +1,124 @@
+import functools
+import hashlib
+import json
+import os
+import random
+from pathlib import Path
+from typing import Dict, Optional
+
+from .cache import _make_remote_backend
+
+
+def default_tuning_dir():
+    return os.path.join(Path.home(), ".triton", "autotune")
+
+
+@functools.lru_cache()
+def device_fingerprint(device):
+    """ what tuning results depend on besides the kernel: device model and driver """
+    import torch
+    name = torch.cuda.get_device_name(device)
+    if torch.version.hip is not None:
+        return f"{name}-hip{torch.version.hip}"
+    driver_version = "unknown"
+    try:
+        import ctypes
+        version = ctypes.c_int()
+        if ctypes.CDLL("libcuda.so.1").cuDriverGetVersion(ctypes.byref(version)) == 0:
+            driver_version = str(version.value)
+    except OSError:
+        pass
+    return f"{name}-cuda{driver_version}"
+
+
+def config_to_json(config):
+    return {"kwargs": config.kwargs, "num_warps": config.num_warps, "num_stages": config.num_stages}
+
+
+def config_matches(config, entry):
+    return config.kwargs == entry["kwargs"] and config.num_warps == entry["num_warps"] \
+        and config.num_stages == entry["num_stages"]
+
+
+class TuningDatabase:
+    """
+    Persistent autotuning results, shared across processes.
+
+    Each entry records the winning config and the timings of every config
+    benchmarked for one kernel (by `cache_key`), device model, driver version
+    and value of the autotuning key, as one JSON file under `path`
+    (`TRITON_AUTOTUNE_DIR`, by default ~/.triton/autotune). Entries are only
+    read when the autotuner misses in memory. With
+    `TRITON_AUTOTUNE_REMOTE_URL` set, entries missing locally are fetched from,
+    and new entries published to, the same kind of remote store as the
+    compilation cache.
+    """
+
+    def __init__(self, path=None, remote_url=None):
+        self.path = path or os.environ.get("TRITON_AUTOTUNE_DIR", default_tuning_dir())
+        remote_url = remote_url if remote_url is not None else os.environ.get("TRITON_AUTOTUNE_REMOTE_URL", "")
+        self.remote = None
+        if remote_url:
+            timeout = float(os.environ.get("TRITON_REMOTE_CACHE_TIMEOUT", "5"))
+            self.remote = _make_remote_backend(remote_url, timeout)
+
+    @staticmethod
+    def make_key(fn_key, device, key_values, configs):
+        # the set of candidate configs is part of the key, as a winner is only
+        # meaningful among the configs it was picked from
+        candidates = sorted(json.dumps(config_to_json(c), sort_keys=True, default=str) for c in configs)
+        key = f"{fn_key}-{device}-{key_values!r}-{candidates}"
+        return hashlib.sha256(key.encode("utf-8")).hexdigest()
+
+    def _entry_path(self, key):
+        return os.path.join(self.path, f"{key}.json")
+
+    def get(self, key) -> Optional[Dict]:
+        path = self._entry_path(key)
+        if os.path.exists(path):
+            with open(path) as f:
+                return json.load(f)
+        if self.remote is None:
+            return None
+        try:
+            data = self.remote.get(f"autotune/{key}")
+        except Exception:
+            return None
+        if data is None:
+            return None
+        entry = json.loads(data)
+        self._write(key, entry)
+        return entry
+
+    def _write(self, key, entry):
+        os.makedirs(self.path, exist_ok=True)
+        path = self._entry_path(key)
+        temp_path = f"{path}.tmp.pid_{os.getpid()}_{random.randint(0, 1000000)}"
+        with open(temp_path, "w") as f:
+            json.dump(entry, f, sort_keys=True)
+        os.replace(temp_path, path)
+
+    def put(self, key, entry):
+        self._write(key, entry)
+        if self.remote is not None:
+            try:
+                self.remote.put(f"autotune/{key}", json.dumps(entry, sort_keys=True).encode())
+            except Exception:
+                pass
+
+    def export_entries(self) -> Dict[str, Dict]:
+        entries = dict()
+        if os.path.isdir(self.path):
+            for filename in sorted(os.listdir(self.path)):
+                if filename.endswith(".json"):
+                    with open(os.path.join(self.path, filename)) as f:
+                        entries[filename[:-len(".json")]] = json.load(f)
+        return entries
+
+    def import_entries(self, entries: Dict[str, Dict], overwrite=False) -> int:
+        imported = 0
+        for key, entry in entries.items():
+            if overwrite or not os.path.exists(self._entry_path(key)):
+                self._write(key, entry)
+                imported += 1
+        return imported
@@ -77,11 +77,156 @@ def do_bench_cudagraph(fn, rep=20, grad_to_none=None):
     return torch.mean(torch.tensor(ret)).item()
 
 
+class BenchContext:
+    """
+    The state `do_bench` keeps on a device between calls: a buffer of twice the
+    size of the device's L2 cache (256 MB when the driver does not report it),
+    zeroed before every timed run of the benchmarked function so that the L2
+    holds none of its data.
+    """
+
+    def __init__(self, device, fast_flush=True):
+        import torch
+        from .runtime import driver
+        l2_size = driver.utils.get_device_properties(device).get("l2_size", 0)
+        size = 2 * l2_size if l2_size > 0 else int(256e6)
+        # a 4-byte type zeroes the buffer with fewer instructions
+        if fast_flush:
+            self.cache = torch.empty(size // 4, dtype=torch.int, device=torch.device('cuda', device))
+        else:
+            self.cache = torch.empty(size, dtype=torch.int8, device=torch.device('cuda', device))
+
+    def flush(self):
+        self.cache.zero_()
+
+
+_bench_contexts = dict()
+
+
+def get_bench_context(device=None, fast_flush=True):
+    """ the `BenchContext` of `device`, the current one by default """
+    import torch
+    if device is None:
+        device = torch.cuda.current_device()
+    key = (device, fast_flush)
+    if key not in _bench_contexts:
+        _bench_contexts[key] = BenchContext(device, fast_flush)
+    return _bench_contexts[key]
+
+
+class BenchStats:
+    """
+    The runtimes (in ms) measured by `do_bench`: their `median`, `mean`, the
+    95% confidence interval [`ci_low`, `ci_high`] of the median, the
+    requested `quantiles` (or None), and the number of `samples` they were
+    computed from.
+    """
+
+    def __init__(self, times, quantiles=None):
+        import torch
+        times = sorted(times)
+        n = len(times)
+        self.samples = n
+        self.median = times[(n - 1) // 2] if n % 2 else (times[n // 2 - 1] + times[n // 2]) / 2
+        self.mean = sum(times) / n
+        # distribution-free interval of the median, between the order
+        # statistics n / 2 -+ 1.96 * sqrt(n) / 2
+        half_width = 0.98 * n ** 0.5
+        self.ci_low = times[max(0, int(n / 2 - half_width))]
+        self.ci_high = times[min(n - 1, -int(-(n / 2 + half_width)))]
+        self.quantiles = None
+        if quantiles is not None:
+            self.quantiles = torch.quantile(torch.tensor(times, dtype=torch.float),
+                                            torch.tensor(quantiles, dtype=torch.float)).tolist()
+
+    def __repr__(self):
+        return f"BenchStats(median={self.median}, ci=[{self.ci_low}, {self.ci_high}], samples={self.samples})"
+
+
+def drop_outliers(times):
+    """ `times` without those beyond 1.5 inter-quartile ranges of the quartiles """
+    import torch
+    if len(times) < 4:
+        return list(times)
+    q1, q3 = torch.quantile(torch.tensor(times, dtype=torch.float), torch.tensor([0.25, 0.75])).tolist()
+    low, high = q1 - 1.5 * (q3 - q1), q3 + 1.5 * (q3 - q1)
+    return [t for t in times if low <= t <= high]
+
+
+def _time_events(fn, ctx, n_repeat, grad_to_none, check):
+    # one event pair per run; with a `check`, the runs are timed in chunks
+    # after which it may stop the benchmark, otherwise all at once so that
+    # the device only synchronizes at the end
+    import torch
+    chunk = n_repeat if check is None else max(1, -(-n_repeat // 4))
+    start_event = [torch.cuda.Event(enable_timing=True) for i in range(chunk)]
+    end_event = [torch.cuda.Event(enable_timing=True) for i in range(chunk)]
+    times = []
+    while len(times) < n_repeat:
+        n = min(chunk, n_repeat - len(times))
+        for i in range(n):
+            # we don't want `fn` to accumulate gradient values
+            # if it contains a backward pass. So we clear the
+            # provided gradients
+            if grad_to_none is not None:
+                for x in grad_to_none:
+                    x.grad = None
+            # we clear the L2 cache before each run
+            ctx.flush()
+            # record time of `fn`
+            start_event[i].record()
+            fn()
+            end_event[i].record()
+        torch.cuda.synchronize()
+        times += [s.elapsed_time(e) for s, e in zip(start_event[:n], end_event[:n])]
+        if check is not None and check(times):
+            break
+    return times
+
+
+def _time_graph(fn, ctx, n_repeat, check):
+    # the runs, each preceded by a flush of the L2, are captured in batches
+    # in a CUDA graph; a sample is the time of a replay minus that of a graph
+    # of the flushes alone, divided by the batch size
+    import torch
+    batch = max(1, min(n_repeat // 10, 100))
+    n_samples = max(1, n_repeat // batch)
+    stream = torch.cuda.Stream()
+    with torch.cuda.stream(stream):
+        graph = torch.cuda.CUDAGraph()
+        with torch.cuda.graph(graph, stream=stream):
+            for _ in range(batch):
+                ctx.flush()
+                fn()
+        flush_graph = torch.cuda.CUDAGraph()
+        with torch.cuda.graph(flush_graph, stream=stream):
+            for _ in range(batch):
+                ctx.flush()
+    torch.cuda.synchronize()
+    events = [torch.cuda.Event(enable_timing=True) for _ in range(3)]
+    times = []
+    for _ in range(n_samples):
+        events[0].record()
+        graph.replay()
+        events[1].record()
+        flush_graph.replay()
+        events[2].record()
+        torch.cuda.synchronize()
+        elapsed = events[0].elapsed_time(events[1]) - events[1].elapsed_time(events[2])
+        times.append(max(elapsed, 0.0) / batch)
+        if check is not None and len(times) >= 3 and check(times):
+            break
+    return times
+
+
 def do_bench(fn, warmup=25, rep=100, grad_to_none=None,
              quantiles=None,
              fast_flush=True,
-             return_mode="mean"):
-    assert return_mode in ["min", "max", "mean", "median"]
+             return_mode="mean",
+             use_cuda_graph=False,
+             reject_outliers=False,
+             stop_above=None):
+    assert return_mode in ["min", "max", "mean", "median", "stats"]
     import torch
     """
     Benchmark the runtime of the provided function. By default, return the median runtime of :code:`fn` along with
@@ -99,25 +244,30 @@ def do_bench(fn, warmup=25, rep=100, grad_to_none=None,
     :type quantiles: list[float]
     :param fast_flush: Use faster kernel to flush L2 between measurements
     :type fast_flush: bool
+    :param return_mode: "min", "max", "mean" or "median" of the runtimes, or "stats" for a `BenchStats`, which
+                        includes the requested quantiles.
+    :type return_mode: str
+    :param use_cuda_graph: Time batches of runs replayed from a CUDA graph rather than every launch, which removes
+                           the launch overhead and the jitter of the host from short runtimes.
+    :type use_cuda_graph: bool
+    :param reject_outliers: Drop the runtimes beyond 1.5 inter-quartile ranges of the quartiles
+    :type reject_outliers: bool
+    :param stop_above: Stop the benchmark early once the confidence interval of the median runtime lies above this
+                       value (in ms)
+    :type stop_above: float, optional
     """
+    assert not (use_cuda_graph and grad_to_none is not None)
+    ctx = get_bench_context(fast_flush=fast_flush)
 
     fn()
     torch.cuda.synchronize()
 
-    # We maintain a buffer of 256 MB that we clear
-    # before each kernel call to make sure that the L2
-    # doesn't contain any input data before the run
-    if fast_flush:
-        cache = torch.empty(int(256e6 // 4), dtype=torch.int, device='cuda')
-    else:
-        cache = torch.empty(int(256e6), dtype=torch.int8, device='cuda')
-
     # Estimate the runtime of the function
     start_event = torch.cuda.Event(enable_timing=True)
     end_event = torch.cuda.Event(enable_timing=True)
     start_event.record()
     for _ in range(5):
-        cache.zero_()
+        ctx.flush()
         fn()
     end_event.record()
     torch.cuda.synchronize()
@@ -126,28 +276,26 @@ def do_bench(fn, warmup=25, rep=100, grad_to_none=None,
     # compute number of warmup and repeat
     n_warmup = max(1, int(warmup / estimate_ms))
     n_repeat = max(1, int(rep / estimate_ms))
-    start_event = [torch.cuda.Event(enable_timing=True) for i in range(n_repeat)]
-    end_event = [torch.cuda.Event(enable_timing=True) for i in range(n_repeat)]
     # Warm-up
     for _ in range(n_warmup):
         fn()
+
+    def filtered(times):
+        return drop_outliers(times) if reject_outliers else times
+
+    check = None
+    if stop_above is not None:
+        def check(times):
+            return BenchStats(filtered(times)).ci_low > stop_above
     # Benchmark
-    for i in range(n_repeat):
-        # we don't want `fn` to accumulate gradient values
-        # if it contains a backward pass. So we clear the
-        # provided gradients
-        if grad_to_none is not None:
-            for x in grad_to_none:
-                x.grad = None
-        # we clear the L2 cache before each run
-        cache.zero_()
-        # record time of `fn`
-        start_event[i].record()
-        fn()
-        end_event[i].record()
-    # Record clocks
-    torch.cuda.synchronize()
-    times = torch.tensor([s.elapsed_time(e) for s, e in zip(start_event, end_event)], dtype=torch.float)
+    if use_cuda_graph:
+        times = _time_graph(fn, ctx, n_repeat, check)
+    else:
+        times = _time_events(fn, ctx, n_repeat, grad_to_none, check)
+    times = filtered(times)
+    if return_mode == "stats":
+        return BenchStats(times, quantiles)
+    times = torch.tensor(times, dtype=torch.float)
     if quantiles is not None:
         ret = torch.quantile(times, torch.tensor(quantiles, dtype=torch.float)).tolist()
         if len(ret) == 1:
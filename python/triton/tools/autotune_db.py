@@ -0,0 +1,39 @@
+import json
+from argparse import ArgumentParser
+
+from triton.runtime.tuning_db import TuningDatabase
+
+desc = """
+Triton autotuning database tool:
+
+Exports the persistent autotuning results of this machine (see the
+`persistent` argument of `triton.autotune`) into a single JSON file, or
+imports such a file, so that tuning done once can be shipped to identical
+machines.
+
+Example usage:
+python autotune_db.py export -o tuned.json
+python autotune_db.py import tuned.json
+"""
+
+if __name__ == "__main__":
+    parser = ArgumentParser(description=desc)
+    parser.add_argument("--db", type=str, default=None, help="Tuning database directory (default: TRITON_AUTOTUNE_DIR)")
+    subparsers = parser.add_subparsers(dest="command", required=True)
+    export_parser = subparsers.add_parser("export", help="Write all tuning results to a file")
+    export_parser.add_argument("--out", "-o", type=str, required=True, help="Out filename")
+    import_parser = subparsers.add_parser("import", help="Add the tuning results of a file")
+    import_parser.add_argument("path", type=str, help="File written by `export`")
+    import_parser.add_argument("--overwrite", action="store_true", help="Replace existing results")
+    args = parser.parse_args()
+
+    db = TuningDatabase(args.db, remote_url="")
+    if args.command == "export":
+        entries = db.export_entries()
+        with open(args.out, "w") as f:
+            json.dump(entries, f, indent=2, sort_keys=True)
+        print(f"exported {len(entries)} tuning results")
+    else:
+        with open(args.path) as f:
+            entries = json.load(f)
+        print(f"imported {db.import_entries(entries, overwrite=args.overwrite)} of {len(entries)} tuning results")
@@ -25,21 +25,49 @@ static inline void gpuAssert(CUresult code, const char *file, int line) {{
 }}
 
 // globals
-#define CUBIN_NAME {kernel_name}_cubin
 CUmodule {kernel_name}_mod = NULL;
 CUfunction {kernel_name}_func = NULL;
-unsigned char CUBIN_NAME[{bin_size}] = {{ {bin_data} }};
+int {kernel_name}_shared = 0;
+{bin_defs}
+
+// one entry per compiled target, sorted by compute capability
+typedef struct {{
+    int cc;
+    unsigned char *bin;
+    int shared;
+}} {kernel_name}_image_t;
+static const {kernel_name}_image_t {kernel_name}_images[{num_images}] = {{ {bin_table} }};
 
 
 void unload_{kernel_name}(void) {{
     CUDA_CHECK(cuModuleUnload({kernel_name}_mod));
 }}
 
+// SASS runs on devices of the same major version and an equal or newer minor
+// version, so pick the newest image that satisfies both
+static const {kernel_name}_image_t *select_{kernel_name}(CUdevice dev) {{
+    int major, minor;
+    CUDA_CHECK(cuDeviceGetAttribute(&major, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MAJOR, dev));
+    CUDA_CHECK(cuDeviceGetAttribute(&minor, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MINOR, dev));
+    const {kernel_name}_image_t *best = NULL;
+    for (int i = 0; i < {num_images}; i++) {{
+      const {kernel_name}_image_t *img = &{kernel_name}_images[i];
+      if (img->cc / 10 == major && img->cc % 10 <= minor)
+        best = img;
+    }}
+    return best;
+}}
+
 // TODO: some code duplication with `runtime/backend/cuda.c`
 void load_{kernel_name}() {{
-    int dev = 0;
-    void *bin = (void *)&CUBIN_NAME;
-    int shared = {shared};
+    CUdevice dev;
+    CUDA_CHECK(cuCtxGetDevice(&dev));
+    const {kernel_name}_image_t *img = select_{kernel_name}(dev);
+    if (img == NULL)
+      CUDA_CHECK(CUDA_ERROR_NO_BINARY_FOR_GPU);
+    void *bin = (void *)img->bin;
+    int shared = img->shared;
+    {kernel_name}_shared = shared;
     CUDA_CHECK(cuModuleLoadData(&{kernel_name}_mod, bin));
     CUDA_CHECK(cuModuleGetFunction(&{kernel_name}_func, {kernel_name}_mod, "{triton_kernel_name}"));
     // set dynamic shared memory if necessary
@@ -60,5 +88,5 @@ CUresult {kernel_name}(CUstream stream, unsigned int gX, unsigned int gY, unsign
     void *args[{num_args}] = {{ {arg_pointers} }};
     // TODO: shared memory
     if(gX * gY * gZ > 0)
-      return cuLaunchKernel({kernel_name}_func, gX, gY, gZ, {num_warps} * 32, 1, 1, {shared}, stream, args, NULL);
+      return cuLaunchKernel({kernel_name}_func, gX, gY, gZ, {num_warps} * 32, 1, 1, {kernel_name}_shared, stream, args, NULL);
 }}
@@ -1,6 +1,7 @@
 import binascii
 import hashlib
 import importlib.util
+from concurrent.futures import ThreadPoolExecutor
 import sys
 from argparse import ArgumentParser
 from pathlib import Path
@@ -8,6 +9,7 @@ from typing import List
 
 import triton
 from triton.compiler.code_generator import kernel_suffix
+from triton.compiler.compiler import get_architecture_descriptor
 from triton.compiler.make_launcher import ty_to_cpp
 
 desc = """
@@ -32,6 +34,11 @@ CUresult kernel_{specialization_suffix}(CUstream stream, unsigned gX, unsigned g
 
 Different such specialized entry points can be combined using the `linker.py` script.
 
+By default the kernel is compiled for the current device only. Passing a list of
+compute capabilities, e.g. `--target 80,89,90`, compiles all of them concurrently and
+embeds one cubin per target; the loader then picks the best match for the device
+of the current context at runtime.
+
 NOTE: when resolving the scope of /path/to/kernel.py, the file will be executed from within its parent directory with the python interpreter
 used to run this `compile.py` script
 """
@@ -46,6 +53,8 @@ if __name__ == "__main__":
     parser.add_argument("--out-name", "-on", type=str, default=None, help="Out name for the compiled kernel")
     parser.add_argument("--out-path", "-o", type=Path, default=None, help="Out filename")
     parser.add_argument("--signature", "-s", type=str, help="Signature of the kernel", required=True)
+    parser.add_argument("--target", "-t", type=str, default=None,
+                        help="Comma-separated compute capabilities to compile for (default: current device)")
     args = parser.parse_args()
 
     out_name = args.out_name if args.out_name else args.kernel_name
@@ -96,7 +105,17 @@ if __name__ == "__main__":
     config = triton.compiler.instance_descriptor(divisible_by_16=divisible_by_16, equal_to_1=equal_to_1)
     for i in equal_to_1:
         constexprs.update({i: 1})
-    ccinfo = triton.compile(kernel, signature=signature, constants=constexprs, configs=[config], num_warps=args.num_warps)
+    if args.target:
+        targets = sorted({int(t.strip()) for t in args.target.split(",")})
+    else:
+        targets = [get_architecture_descriptor(None)]
+
+    def compile_for(cc):
+        return triton.compile(kernel, signature=signature, constants=constexprs, configs=[config],
+                              num_warps=args.num_warps, cc=cc)
+
+    with ThreadPoolExecutor(max_workers=len(targets)) as executor:
+        ccinfos = list(executor.map(compile_for, targets))
     arg_names = []
     arg_types = []
     for i in signature.keys():
@@ -108,18 +127,25 @@ if __name__ == "__main__":
     suffix = kernel_suffix(signature.values(), config)
     func_name = '_'.join([out_name, sig_hash, suffix])
     triton_kernel_name = '_'.join([args.kernel_name, suffix])
-    hex_ = str(binascii.hexlify(ccinfo.asm["cubin"]))[2:-1]
+    bin_defs = []
+    bin_table = []
+    for cc, ccinfo in zip(targets, ccinfos):
+        hex_ = str(binascii.hexlify(ccinfo.asm["cubin"]))[2:-1]
+        bin_data = ", ".join([f"0x{x}{y}" for x, y in zip(hex_[::2], hex_[1::2])])
+        bin_name = f"{func_name}_cubin_sm{cc}"
+        bin_defs.append(f"unsigned char {bin_name}[{len(hex_) // 2}] = {{ {bin_data} }};")
+        bin_table.append(f"{{ {cc}, {bin_name}, {ccinfo.shared} }}")
     params = {
         "kernel_name": func_name,
         "triton_kernel_name": triton_kernel_name,
-        "bin_size": len(hex_),
-        "bin_data": ", ".join([f"0x{x}{y}" for x, y in zip(hex_[::2], hex_[1::2])]),
+        "bin_defs": "\n".join(bin_defs),
+        "bin_table": ", ".join(bin_table),
+        "num_images": len(targets),
         "signature": ", ".join([f"{ty_to_cpp(ty)} {name}" for name, ty in zip(arg_names, arg_types)]),
         "full_signature": ", ".join([f"{ty_to_cpp(signature[i])} {kernel.arg_names[i]}" for i in signature.keys()]),
         "arg_pointers": ", ".join([f"&{arg}" for arg in arg_names]),
         "num_args": len(arg_names),
         "kernel_docstring": "",
-        "shared": ccinfo.shared,
         "num_warps": args.num_warps,
         "_placeholder": "",
     }
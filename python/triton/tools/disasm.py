@@ -120,3 +120,171 @@ def extract(file_path, fun):
             ret += asm + '\n'
         ret += '\n'
         return ret
+
+
+# ------------------------------------------------------------------------------
+# Static performance report
+# ------------------------------------------------------------------------------
+
+PRED_RE = re.compile(r'^@(!?)(U?P\w+)\s+')
+# classes of the SASS instruction mix, by opcode; the first match wins
+_sass_classes = [
+    ("mma", ("HMMA", "IMMA", "DMMA", "HGMMA", "IGMMA", "QGMMA", "BMMA")),
+    ("async_copy", ("LDGSTS", "LDGDEPBAR", "DEPBAR", "UBLKCP", "UTMALDG", "UTMASTG")),
+    ("global_load", ("LDG",)),
+    ("global_store", ("STG",)),
+    ("local_load", ("LDL",)),
+    ("local_store", ("STL",)),
+    ("shared_load", ("LDS", "LDSM")),
+    ("shared_store", ("STS",)),
+    ("atomic", ("ATOM", "ATOMS", "ATOMG", "RED")),
+    ("barrier", ("BAR", "SYNCS", "MEMBAR", "WARPSYNC")),
+    ("shuffle", ("SHFL",)),
+    ("branch", ("BRA", "BRX", "JMP", "CALL", "RET", "EXIT", "BSSY", "BSYNC")),
+]
+_width_suffixes = {"U8": 8, "S8": 8, "U16": 16, "S16": 16, "64": 64, "128": 128}
+
+
+def _sass_functions(sass_str):
+    """
+    Parse the output of `cuobjdump -sass` into {name: [(offset, asm, stall)]}.
+    """
+    functions = {}
+    lines = sass_str.splitlines()
+    line_idx = 0
+    insts = None
+    while line_idx < len(lines):
+        line = lines[line_idx]
+        line_idx += 1
+        if FNAME_RE.match(line):
+            insts = functions.setdefault(FNAME_RE.match(line).group(1), [])
+            continue
+        if insts is None or FLINE_RE.match(line) is None or line_idx >= len(lines):
+            continue
+        offset = int(line.split('*/')[0].strip().lstrip('/*'), 16)
+        asm = FLINE_RE.match(line).group(1).rstrip(' ;').strip()
+        stall = (int(SLINE_RE.match(lines[line_idx]).group(1), 16) >> 41) & 0xf
+        line_idx += 1
+        insts.append((offset, asm, stall))
+    return functions
+
+
+def _report_function(insts):
+    mix = {name: 0 for name, _ in _sass_classes}
+    mix.update(other=0, total=0)
+    shared_widths = {"load": {}, "store": {}}
+    predicated = 0
+    never_executed = 0
+    loops = []
+    for offset, asm, stall in insts:
+        pred = PRED_RE.match(asm)
+        if pred is not None:
+            predicated += 1
+            # `@!PT` guards instructions that never execute (e.g., padding)
+            if pred.group(1) == "!" and pred.group(2) == "PT":
+                never_executed += 1
+            asm = asm[pred.end():]
+        opcode, *mods = asm.split(None, 1)[0].split(".")
+        if opcode == "NOP":
+            continue
+        mix["total"] += 1
+        for name, opcodes in _sass_classes:
+            if opcode in opcodes:
+                mix[name] += 1
+                break
+        else:
+            mix["other"] += 1
+        if opcode in ("LDS", "STS"):
+            width = next((_width_suffixes[m] for m in mods if m in _width_suffixes), 32)
+            widths = shared_widths["load" if opcode == "LDS" else "store"]
+            widths[width] = widths.get(width, 0) + 1
+        # a backward branch closes a loop whose body starts at its target
+        bra = BRA_RE.match(asm + ";")
+        if bra is not None and int(bra.group(2), 16) <= offset:
+            start = int(bra.group(2), 16)
+            body = [i for i in insts if start <= i[0] <= offset]
+            loops.append({"start": start, "end": offset, "instructions": len(body),
+                          "stall_cycles": sum(i[2] for i in body)})
+    return {"instruction_mix": mix, "shared_widths": shared_widths,
+            "spills": {"loads": mix["local_load"], "stores": mix["local_store"]},
+            "predicated": predicated, "never_executed": never_executed, "loops": loops}
+
+
+def report(sass_str, fun=None):
+    '''
+    Build a static performance report of the kernels of a `cuobjdump -sass` listing.
+    :param sass_str: the raw output of `cuobjdump -sass`
+    :param fun: if provided, only report this function
+    :return: {function name: report}, where each report holds
+        - instruction_mix: instruction counts by class, "other", and "total" (NOPs excluded)
+        - shared_widths: number of LDS/STS of each access width in bits
+        - spills: number of local-memory loads and stores
+        - predicated: number of predicated instructions; never_executed those under `@!PT`
+        - loops: for each backward branch, its byte range, number of instructions, and the
+          sum of the stall cycles encoded in their control bits. This is a static lower
+          bound on the cycles of one iteration of a warp: it ignores scoreboard waits.
+    '''
+    functions = _sass_functions(sass_str)
+    if fun is not None:
+        functions = {fun: functions[fun]}
+    return {name: _report_function(insts) for name, insts in functions.items()}
+
+
+def report_cubin(file_path, fun=None):
+    sass_str = subprocess.check_output(["cuobjdump", "-sass", file_path]).decode()
+    return report(sass_str, fun)
+
+
+def diff_reports(old, new):
+    '''
+    Compare two reports of the same function; returns {path: (old, new)} for
+    every scalar that differs, with the path of nested fields joined by ".".
+    '''
+    def flatten(d, prefix=""):
+        ret = {}
+        for k, v in d.items():
+            key = f"{prefix}{k}"
+            if isinstance(v, dict):
+                ret.update(flatten(v, key + "."))
+            elif isinstance(v, list):
+                ret.update(flatten(dict(enumerate(v)), key + "."))
+            else:
+                ret[key] = v
+        return ret
+    old, new = flatten(old), flatten(new)
+    return {k: (old.get(k), new.get(k)) for k in sorted(old.keys() | new.keys())
+            if old.get(k) != new.get(k)}
+
+
+if __name__ == "__main__":
+    import json
+    from argparse import ArgumentParser
+
+    parser = ArgumentParser(description="Static performance report of the kernels of a cubin")
+    parser.add_argument("cubin", help="path to the cubin")
+    parser.add_argument("--fun", default=None, help="only report this function")
+    parser.add_argument("--diff", default=None, help="path to a cubin to compare against")
+    parser.add_argument("--json", action="store_true", help="print the report as JSON")
+    args = parser.parse_args()
+
+    reports = report_cubin(args.cubin, args.fun)
+    if args.diff is not None:
+        others = report_cubin(args.diff, args.fun)
+        reports = {name: diff_reports(others[name], r) for name, r in reports.items() if name in others}
+    if args.json:
+        print(json.dumps(reports, indent=2, default=str))
+    else:
+        for name, r in reports.items():
+            print(f"Function: {name}")
+            if args.diff is not None:
+                for k, (old, new) in r.items():
+                    print(f"  {k}: {old} -> {new}")
+                continue
+            mix = ", ".join(f"{k}={v}" for k, v in r["instruction_mix"].items() if v)
+            print(f"  instructions: {mix}")
+            print(f"  shared widths: {r['shared_widths']}")
+            print(f"  spills: {r['spills']}")
+            print(f"  predicated: {r['predicated']} (never executed: {r['never_executed']})")
+            for loop in r["loops"]:
+                print(f"  loop [{loop['start']:#06x}, {loop['end']:#06x}]: "
+                      f"{loop['instructions']} instructions, >= {loop['stall_cycles']} cycles")
@@ -134,36 +134,125 @@ void unload_{name}();
     """
 
 
+# largest number of distinct specialization predicates for which the
+# dispatcher is a lookup table rather than a chain of conditionals
+MAX_TABLE_PREDICATES = 12
+
+
+def make_predicates(metas: Sequence[KernelLinkerMeta]):
+    """ the distinct (arg index, hint) pairs the specializations of a kernel depend on """
+    return sorted({(i, hint) for meta in metas for i, hint in enumerate(meta.sizes) if hint is not None})
+
+
+def make_dispatch_table(metas: Sequence[KernelLinkerMeta], preds):
+    """
+    maps every combination of predicate bits to the index (in `metas`) of the
+    most specialized kernel they satisfy, or -1 if there is none
+    """
+    bit = {pred: 1 << i for i, pred in enumerate(preds)}
+    masks = [sum(bit[(i, hint)] for i, hint in enumerate(meta.sizes) if hint is not None) for meta in metas]
+    table = []
+    for key in range(1 << len(preds)):
+        best = -1
+        for idx, mask in enumerate(masks):
+            if mask & ~key == 0 and (best == -1 or metas[idx].num_specs > metas[best].num_specs):
+                best = idx
+        table.append(best)
+    return table
+
+
 def make_kernel_dispatcher(name: str, metas: Sequence[KernelLinkerMeta]) -> str:
+    metas = sorted(metas, key=lambda m: -m.num_specs)
+    cond_fn = lambda val, hint: f"({val} % {hint} == 0)" if hint == 16 else f"({val} == {hint})" if hint == 1 else None
+    call_fn = lambda meta: f"{name}_{meta.sig_hash}_{meta.suffix}(stream, gX, gY, gZ, {', '.join(arg for arg, hint in zip(meta.arg_names, meta.sizes) if hint != 1)})"
+
     src = f"// launcher for: {name}\n"
-    for meta in sorted(metas, key=lambda m: -m.num_specs):
+    for meta in metas:
         src += f"CUresult {name}_{meta.sig_hash}_{meta.suffix}(CUstream stream, unsigned int gX, unsigned int gY, unsigned int gZ, {gen_signature(meta)});\n"
     src += "\n"
 
     src += f"CUresult {name}(CUstream stream, unsigned int gX, unsigned int gY, unsigned int gZ, {gen_signature_with_full_args(metas[-1])}){{"
     src += "\n"
-    for meta in sorted(metas, key=lambda m: -m.num_specs):
-        cond_fn = lambda val, hint: f"({val} % {hint} == 0)" if hint == 16 else f"({val} == {hint})" if hint == 1 else None
-        conds = " && ".join([cond_fn(val, hint) for val, hint in zip(meta.arg_names, meta.sizes) if hint is not None])
-        src += f"  if ({conds})\n"
-        arg_names = [arg for arg, hint in zip(meta.arg_names, meta.sizes) if hint != 1]
-        src += f"    return {name}_{meta.sig_hash}_{meta.suffix}(stream, gX, gY, gZ, {', '.join(arg_names)});\n"
+    preds = make_predicates(metas)
+    if len(preds) <= MAX_TABLE_PREDICATES:
+        # pack the predicates into a key and look the kernel up in a
+        # precomputed table, so launching costs the same for any number of
+        # specializations
+        table = make_dispatch_table(metas, preds)
+        arg_names = metas[-1].arg_names
+        src += f"  static const int16_t table[{len(table)}] = {{{', '.join(map(str, table))}}};\n"
+        bits = [f"((unsigned){cond_fn(arg_names[i], hint)} << {b})" for b, (i, hint) in enumerate(preds)]
+        src += f"  unsigned key = {' | '.join(bits) if bits else '0'};\n"
+        src += "  switch (table[key]) {\n"
+        for idx, meta in enumerate(metas):
+            src += f"  case {idx}:\n"
+            src += f"    return {call_fn(meta)};\n"
+        src += "  }\n"
+    else:
+        for meta in metas:
+            conds = " && ".join([cond_fn(val, hint) for val, hint in zip(meta.arg_names, meta.sizes) if hint is not None])
+            src += f"  if ({conds if conds else '1'})\n"
+            src += f"    return {call_fn(meta)};\n"
     src += "\n"
     src += "  return CUDA_ERROR_INVALID_VALUE;\n"
     src += "}\n"
 
     for mode in ["load", "unload"]:
         src += f"\n// {mode} for: {name}\n"
-        for meta in sorted(metas, key=lambda m: -m.num_specs):
+        for meta in metas:
             src += f"void {mode}_{name}_{meta.sig_hash}_{meta.suffix}();\n"
         src += f"void {mode}_{name}() {{"
         src += "\n"
-        for meta in sorted(metas, key=lambda m: -m.num_specs):
+        for meta in metas:
             src += f"  {mode}_{name}_{meta.sig_hash}_{meta.suffix}();\n"
         src += "}\n"
     return src
 
 
+def make_heuristic_selector(name: str, configs, kernels) -> str:
+    """
+    `configs` is [{"kernel": <linked kernel>, "cond": <C expression over the kernel arguments>}, ...]:
+    the first config whose condition holds is launched, and an empty condition always holds.
+    Grid dimensions are passed through, so callers size the grid for the config chosen by `<name>_select`.
+    """
+    for config in configs:
+        if config["kernel"] not in kernels:
+            raise LinkerError(f"heuristic {name} refers to unknown kernel {config['kernel']}")
+    metas = [kernels[config["kernel"]][-1] for config in configs]
+    for meta in metas[1:]:
+        if meta.arg_ctypes != metas[0].arg_ctypes:
+            raise LinkerError(f"Mismatched signature for kernels of heuristic {name}")
+    signature = gen_signature_with_full_args(metas[0])
+    arg_names = ", ".join(metas[0].arg_names)
+
+    src = f"// heuristic selector for: {name}\n"
+    src += f"int {name}_select({signature}) {{\n"
+    for idx, config in enumerate(configs):
+        src += f"  if ({config['cond'] or '1'})\n"
+        src += f"    return {idx};\n"
+    src += "  return -1;\n"
+    src += "}\n\n"
+    src += f"CUresult {name}(CUstream stream, unsigned int gX, unsigned int gY, unsigned int gZ, {signature}) {{\n"
+    src += f"  switch ({name}_select({arg_names})) {{\n"
+    for idx, config in enumerate(configs):
+        src += f"  case {idx}:\n"
+        src += f"    return {config['kernel']}(stream, gX, gY, gZ, {arg_names});\n"
+    src += "  }\n"
+    src += "  return CUDA_ERROR_INVALID_VALUE;\n"
+    src += "}\n"
+    for mode in ["load", "unload"]:
+        src += f"\nvoid {mode}_{name}() {{\n"
+        for kernel in dict.fromkeys(config["kernel"] for config in configs):
+            src += f"  {mode}_{kernel}();\n"
+        src += "}\n"
+    return src
+
+
+def make_heuristic_decls(name: str, configs, kernels) -> str:
+    meta = kernels[configs[0]["kernel"]][-1]
+    return make_decls(name, [meta]) + f"int {name}_select({gen_signature_with_full_args(meta)});\n"
+
+
 desc = """
 Triton ahead-of-time linker:
 
@@ -171,6 +260,15 @@ This program takes in header files generated by compile.py, and generates a
 single entry-point responsible for dispatching the user's input to the right
 kernel given the specializations that were compiled.
 
+Optionally, `--heuristics` takes a JSON file such as
+
+{"matmul": [{"kernel": "matmul_128x128x32", "cond": "M >= 1024 && N >= 1024"},
+            {"kernel": "matmul_64x64x32", "cond": ""}]}
+
+and emits a `matmul` entry point that launches the first linked kernel whose
+condition holds, with `matmul_select` exposing the choice so that callers can
+size the grid accordingly.
+
 Example usage:
 python link.py /path/to/headers/*.h -o kernel_name
 """
@@ -186,6 +284,8 @@ if __name__ == "__main__":
     )
     parser.add_argument("--out", "-o", type=Path, help="Out filename")
     parser.add_argument("--prefix", type=str, default="", help="String to prefix kernel dispatcher names")
+    parser.add_argument("--heuristics", type=Path, default=None,
+                        help="JSON file mapping selector names to size-based rules choosing among the linked kernels")
     args = parser.parse_args()
 
     # metadata
@@ -197,13 +297,20 @@ if __name__ == "__main__":
         includes.append(h_path.name)
         parser.extract_linker_meta(h_str)
 
+    heuristics = dict()
+    if args.heuristics is not None:
+        import json
+        heuristics = json.loads(args.heuristics.read_text())
+
     # generate headers
     decls = [make_decls(name, meta) for name, meta in parser.kernels.items()]
+    decls += [make_heuristic_decls(name, configs, parser.kernels) for name, configs in heuristics.items()]
     with args.out.with_suffix(".h").open("w") as fp:
         fp.write("#include <cuda.h>\n" + "\n".join(decls))
 
     # generate source
     defs = [make_kernel_dispatcher(name, meta) for name, meta in parser.kernels.items()]
+    defs += [make_heuristic_selector(name, configs, parser.kernels) for name, configs in heuristics.items()]
     with args.out.with_suffix(".c").open("w") as fp:
         out = ""
         out += "#include <cuda.h>\n"
@@ -214,11 +214,11 @@ tt.func @cmp() {
   %1 = arith.constant dense<0> : tensor<128xi32>
   // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = <none>
   %2 = arith.cmpi eq, %0, %1 : tensor<128xi32>
-  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = <none>
+  // CHECK-NEXT: contiguity = [1], divisibility = [4611686018427387904], constancy = [128], constant_value = 0
   %3 = arith.cmpi slt, %0, %1 : tensor<128xi32>
   // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [1], constant_value = <none>
   %4 = arith.cmpi sle, %0, %1 : tensor<128xi32>
-  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = <none>
+  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = 1
   %5 = arith.cmpi sge, %0, %1 : tensor<128xi32>
   // CHECK-NEXT: contiguity = [1], divisibility = [8], constancy = [128], constant_value = 8
   %6 = arith.constant dense<8> : tensor<128xi32>
@@ -268,7 +268,7 @@ tt.func @select() {
   %1 = arith.constant dense<0> : tensor<128xi32>
   // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = <none>
   %2 = arith.cmpi eq, %0, %1 : tensor<128xi32>
-  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = <none>
+  // CHECK-NEXT: contiguity = [1], divisibility = [4611686018427387904], constancy = [128], constant_value = 0
   %3 = arith.cmpi slt, %0, %1 : tensor<128xi32>
   // CHECK-NEXT: contiguity = [1], divisibility = [4611686018427387904], constancy = [1], constant_value = 0
   %4 = arith.constant 0 : i1
@@ -348,6 +348,90 @@ tt.func @for() {
 
 // -----
 
+// CHECK-LABEL: @for_recurrence
+tt.func @for_recurrence(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1: i32 {tt.divisibility = 16 : i32}) {
+  %0 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32>
+  %1 = tt.splat %arg0 : (!tt.ptr<f16>) -> tensor<64x!tt.ptr<f16>>
+  %2 = tt.addptr %1, %0 : tensor<64x!tt.ptr<f16>>, tensor<64xi32>
+  %c32_i32 = arith.constant 32 : i32
+  %3 = arith.muli %arg1, %c32_i32 : i32
+  %4 = tt.splat %3 : (i32) -> tensor<64xi32>
+  %c64 = arith.constant dense<64> : tensor<64xi32>
+  %c256 = arith.constant dense<256> : tensor<64xi32>
+  %lb = arith.constant 0 : index
+  %ub = arith.constant 256 : index
+  %step = arith.constant 64 : index
+  %5:2 = scf.for %iv = %lb to %ub step %step iter_args(%ptr = %2, %k = %0) -> (tensor<64x!tt.ptr<f16>>, tensor<64xi32>) {
+    // CHECK: arith.cmpi slt, %{{.*}} => contiguity = [1], divisibility = [1], constancy = [64], constant_value = 1
+    %6 = arith.cmpi slt, %k, %c256 : tensor<64xi32>
+    %7 = tt.load %ptr, %6 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<64xf16>
+    // CHECK: tt.addptr %{{.*}} => contiguity = [64], divisibility = [16], constancy = [1], constant_value = <none>
+    %8 = tt.addptr %ptr, %4 : tensor<64x!tt.ptr<f16>>, tensor<64xi32>
+    // CHECK: arith.addi %{{.*}} => contiguity = [64], divisibility = [64], constancy = [1], constant_value = <none>, value_range = [64, 319]
+    %9 = arith.addi %k, %c64 : tensor<64xi32>
+    scf.yield %8, %9 : tensor<64x!tt.ptr<f16>>, tensor<64xi32>
+  }
+  tt.return
+}
+
+// -----
+
+// CHECK-LABEL: @value_range
+tt.func @value_range() {
+  // CHECK: contiguity = [128], divisibility = [1073741824], constancy = [1], constant_value = <none>, value_range = [0, 127]
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1], divisibility = [64], constancy = [128], constant_value = 64, value_range = [64, 64]
+  %1 = arith.constant dense<64> : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [64], divisibility = [64], constancy = [1], constant_value = <none>, value_range = [0, 63]
+  %2 = arith.remsi %0, %1 : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = 1, value_range = [1, 1]
+  %3 = arith.cmpi slt, %2, %1 : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [64], constant_value = <none>, value_range = [0, 1]
+  %4 = arith.cmpi slt, %0, %1 : tensor<128xi32>
+  // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [1], constant_value = <none>, value_range = [0, 2147483646]
+  %pid = tt.get_program_id x : i32
+  // CHECK-NEXT: contiguity = [1], divisibility = [4611686018427387904], constancy = [1], constant_value = 0, value_range = [0, 0]
+  %lb = arith.constant 0 : index
+  // CHECK-NEXT: contiguity = [1], divisibility = [64], constancy = [1], constant_value = 64, value_range = [64, 64]
+  %ub = arith.constant 64 : index
+  // CHECK-NEXT: contiguity = [1], divisibility = [16], constancy = [1], constant_value = 16, value_range = [16, 16]
+  %step = arith.constant 16 : index
+  // CHECK-NEXT: contiguity = [1], divisibility = [256], constancy = [128], constant_value = 256, value_range = [256, 256]
+  %n = arith.constant dense<256> : tensor<128xi32>
+  scf.for %iv = %lb to %ub step %step {
+    // CHECK-NEXT: contiguity = [1], divisibility = [16], constancy = [1], constant_value = <none>, value_range = [0, 48]
+    %5 = arith.index_cast %iv : index to i32
+    // CHECK-NEXT: contiguity = [1], divisibility = [16], constancy = [128], constant_value = <none>, value_range = [0, 48]
+    %6 = tt.splat %5 : (i32) -> tensor<128xi32>
+    // CHECK-NEXT: contiguity = [128], divisibility = [16], constancy = [1], constant_value = <none>, value_range = [0, 175]
+    %7 = arith.addi %6, %0 : tensor<128xi32>
+    // CHECK-NEXT: contiguity = [1], divisibility = [1], constancy = [128], constant_value = 1, value_range = [1, 1]
+    %8 = arith.cmpi slt, %7, %n : tensor<128xi32>
+  }
+  tt.return
+}
+
+// -----
+
+// CHECK-LABEL: @value_range_casts
+tt.func @value_range_casts() {
+  // CHECK: value_range = [0, 127]
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  // CHECK-NEXT: value_range = [64, 64]
+  %1 = arith.constant dense<64> : tensor<128xi32>
+  // CHECK-NEXT: value_range = [0, 1]
+  %2 = arith.cmpi slt, %0, %1 : tensor<128xi32>
+  // CHECK-NEXT: value_range = [-1, 0]
+  %3 = arith.extsi %2 : tensor<128xi1> to tensor<128xi32>
+  // CHECK-NEXT: value_range = [0, 127]
+  %4 = arith.trunci %0 : tensor<128xi32> to tensor<128xi8>
+  // CHECK-NEXT: constant_value = <none>{{$}}
+  %5 = arith.trunci %0 : tensor<128xi32> to tensor<128xi4>
+  tt.return
+}
+
+// -----
+
 // CHECK-LABEL: @permute_2d
 tt.func @permute_2d(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: i32 {tt.divisibility = 16 : i32}, %arg2: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg3: i32 {tt.divisibility = 16 : i32}) {
   // CHECK: contiguity = [1, 1], divisibility = [1, 1], constancy = [128, 128], constant_value = 1
@@ -3,10 +3,12 @@
 #AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
 #sliceAd0 = #triton_gpu.slice<{dim = 0, parent = #AL}>
 #BL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+#AL_T = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [0, 1]}>
 #A_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
 #A_SHARED_T = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [0, 1]}>
 #B_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
 #C = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#C3 = #triton_gpu.mma<{versionMajor = 3, warpsPerCTA = [4, 1]}>
 #A_DOT = #triton_gpu.dot_op<{opIdx = 0, parent = #C, kWidth=2}>
 #B_DOT = #triton_gpu.dot_op<{opIdx = 1, parent = #C, kWidth=2}>
 
@@ -158,75 +160,119 @@ tt.func @longlive(%A : !tt.ptr<f16>) {
 // This example triggers graph coloring with > 1 colors.
 // CHECK-LABEL: multi_color
 tt.func @multi_color(%A : !tt.ptr<f16>) {
-  // CHECK: offset = 0, size = 64
+  // CHECK: offset = 1280, size = 64
   %cst = arith.constant dense<0.000000e+00> : tensor<4x8xf16, #A_SHARED>
-  // CHECK-NEXT: offset = 1216, size = 32
+  // CHECK-NEXT: offset = 1408, size = 32
   %cst_0 = arith.constant dense<0.000000e+00> : tensor<4x4xf16, #A_SHARED>
-  // CHECK-NEXT: offset = 1248, size = 128
+  // CHECK-NEXT: offset = 1152, size = 128
   %cst_1 = arith.constant dense<0.000000e+00> : tensor<16x4xf16, #A_SHARED>
-  %cst_2 = arith.constant dense<0.000000e+00> : tensor<16x32xf16, #AL>
-  // CHECK-NEXT: scratch offset = 64, size = 1152
-  %0 = triton_gpu.convert_layout %cst_2 : (tensor<16x32xf16, #AL>) -> tensor<16x32xf16, #AL>
+  %cst_2 = arith.constant dense<0.000000e+00> : tensor<32x128xf16, #AL>
+  // CHECK-NEXT: scratch offset = 0, size = 1152
+  %0 = triton_gpu.convert_layout %cst_2 : (tensor<32x128xf16, #AL>) -> tensor<32x128xf16, #B_DOT>
   %1 = triton_gpu.convert_layout %cst : (tensor<4x8xf16, #A_SHARED>) -> tensor<4x8xf16, #AL>
   // CHECK-NEXT: offset = 0, size = 128
   %cst_3 = arith.constant dense<0.000000e+00> : tensor<4x16xf16, #A_SHARED>
   %2 = triton_gpu.convert_layout %cst_0 : (tensor<4x4xf16, #A_SHARED>) -> tensor<4x4xf16, #AL>
   // CHECK-NEXT: scratch offset = 0, size = 1152
-  %3 = triton_gpu.convert_layout %cst_2 : (tensor<16x32xf16, #AL>) -> tensor<16x32xf16, #AL>
-  // CHECK-NEXT: offset = 0, size = 256
+  %3 = triton_gpu.convert_layout %cst_2 : (tensor<32x128xf16, #AL>) -> tensor<32x128xf16, #B_DOT>
+  // CHECK-NEXT: offset = 512, size = 256
   %cst_4 = arith.constant dense<0.000000e+00> : tensor<4x32xf16, #A_SHARED>
-  // CHECK-NEXT: offset = 256, size = 64
+  // CHECK-NEXT: offset = 768, size = 64
   %cst_5 = arith.constant dense<0.000000e+00> : tensor<4x8xf16, #A_SHARED>
   %4 = triton_gpu.convert_layout %cst_5 : (tensor<4x8xf16, #A_SHARED>) -> tensor<4x8xf16, #AL>
   %5 = triton_gpu.convert_layout %cst_5 : (tensor<4x8xf16, #A_SHARED>) -> tensor<4x8xf16, #AL>
-  // CHECK-NEXT: offset = 256, size = 512
+  // CHECK-NEXT: offset = 0, size = 512
   %cst_6 = arith.constant dense<0.000000e+00> : tensor<8x32xf16, #A_SHARED>
-  // CHECK-NEXT: offset = 2528, size = 128
+  // CHECK-NEXT: offset = 1280, size = 128
   %cst_7 = arith.constant dense<0.000000e+00> : tensor<2x32xf16, #A_SHARED>
   %6 = triton_gpu.convert_layout %cst_0 : (tensor<4x4xf16, #A_SHARED>) -> tensor<4x4xf16, #AL>
-  // CHECK-NEXT: offset = 256, size = 512
+  // CHECK-NEXT: offset = 0, size = 512
   %cst_8 = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #A_SHARED>
-  // CHECK-NEXT: offset = 256, size = 32
+  // CHECK-NEXT: offset = 768, size = 32
   %cst_9 = arith.constant dense<0.000000e+00> : tensor<4x4xf16, #A_SHARED>
-  // CHECK-NEXT: offset = 256, size = 512
+  // CHECK-NEXT: offset = 0, size = 512
   %cst_10 = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #A_SHARED>
   %7 = triton_gpu.convert_layout %cst_1 : (tensor<16x4xf16, #A_SHARED>) -> tensor<16x4xf16, #AL>
   %8 = triton_gpu.convert_layout %cst_4 : (tensor<4x32xf16, #A_SHARED>) -> tensor<4x32xf16, #AL>
   // CHECK-NEXT: scratch offset = 0, size = 1152
-  %9 = triton_gpu.convert_layout %cst_2 : (tensor<16x32xf16, #AL>) -> tensor<16x32xf16, #AL>
+  %9 = triton_gpu.convert_layout %cst_2 : (tensor<32x128xf16, #AL>) -> tensor<32x128xf16, #B_DOT>
   %cst_11 = arith.constant dense<0.000000e+00> : tensor<4x4xf16, #AL>
   %10 = triton_gpu.convert_layout %cst_7 : (tensor<2x32xf16, #A_SHARED>) -> tensor<2x32xf16, #AL>
   %cst_12 = arith.constant dense<0.000000e+00> : tensor<4x16xf16, #AL>
   %cst_13 = arith.constant dense<0.000000e+00> : tensor<8x32xf16, #AL>
-  // CHECK-NEXT: size = 2656
+  // CHECK-NEXT: size = 1440
   tt.return
 }
 
 // This example triggers graph coloring with multiple rounds
 // CHECK-LABEL: multi_color_multi_rounds
 tt.func @multi_color_multi_rounds(%arg0: !tt.ptr<f16>) {
-  // CHECK: offset = 0, size = 32
+  // CHECK: offset = 9472, size = 32
   %cst = arith.constant dense<0.000000e+00> : tensor<4x4xf16, #A_SHARED>
-  // CHECK-NEXT: offset = 1184, size = 128
+  // CHECK-NEXT: offset = 9344, size = 128
   %cst_0 = arith.constant dense<0.000000e+00> : tensor<16x4xf16, #A_SHARED>
-  // CHECK-NEXT: offset = 1312, size = 8192
+  // CHECK-NEXT: offset = 0, size = 8192
   %cst_1 = arith.constant dense<0.000000e+00> : tensor<1024x4xf16, #A_SHARED>
-  %cst_2 = arith.constant dense<0.000000e+00> : tensor<16x32xf16, #AL>
-  // CHECK-NEXT: scratch offset = 32, size = 1152
-  %0 = triton_gpu.convert_layout %cst_2 : (tensor<16x32xf16, #AL>) -> tensor<16x32xf16, #AL>
+  %cst_2 = arith.constant dense<0.000000e+00> : tensor<32x128xf16, #AL>
+  // CHECK-NEXT: scratch offset = 8192, size = 1152
+  %0 = triton_gpu.convert_layout %cst_2 : (tensor<32x128xf16, #AL>) -> tensor<32x128xf16, #B_DOT>
   %1 = triton_gpu.convert_layout %cst : (tensor<4x4xf16, #A_SHARED>) -> tensor<4x4xf16, #AL>
-  // CHECK-NEXT: offset = 11968, size = 128
+  // CHECK-NEXT: offset = 8704, size = 128
   %cst_3 = arith.constant dense<0.000000e+00> : tensor<2x32xf16, #A_SHARED>
   %2 = triton_gpu.convert_layout %cst : (tensor<4x4xf16, #A_SHARED>) -> tensor<4x4xf16, #AL>
-  // CHECK-NEXT: offset = 0, size = 512
+  // CHECK-NEXT: offset = 8192, size = 512
   %cst_4 = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #A_SHARED>
   %3 = triton_gpu.convert_layout %cst_0 : (tensor<16x4xf16, #A_SHARED>) -> tensor<16x4xf16, #AL>
   %4 = triton_gpu.convert_layout %cst_1 : (tensor<1024x4xf16, #A_SHARED>) -> tensor<1024x4xf16, #AL>
   // CHECK-NEXT: scratch offset = 0, size = 1152
-  %5 = triton_gpu.convert_layout %cst_2 : (tensor<16x32xf16, #AL>) -> tensor<16x32xf16, #AL>
+  %5 = triton_gpu.convert_layout %cst_2 : (tensor<32x128xf16, #AL>) -> tensor<32x128xf16, #B_DOT>
   %6 = triton_gpu.convert_layout %cst_3 : (tensor<2x32xf16, #A_SHARED>) -> tensor<2x32xf16, #AL>
-  // CHECK-NEXT: size = 12096
+  // CHECK-NEXT: size = 9504
+  tt.return
+}
+
+// Rows padded by 4 elements give 2-way bank conflicts to the 8-byte
+// accesses of the half-warps, swizzled rows need no padding
+// CHECK-LABEL: swizzled_scratch
+tt.func @swizzled_scratch() {
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x32xf16, #AL>
+  // CHECK: scratch offset = 0, size = 1024
+  %0 = triton_gpu.convert_layout %cst : (tensor<16x32xf16, #AL>) -> tensor<16x32xf16, #AL>
+  tt.return
+  // CHECK-NEXT: size = 1024
+}
+
+// Each quad of lanes stores 8 elements of a row of the accumulator, and
+// the padding puts consecutive rows on overlapping banks
+// CHECK-LABEL: swizzled_mma_scratch
+tt.func @swizzled_mma_scratch() {
+  %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #C>
+  // CHECK: scratch offset = 0, size = 8192
+  %0 = triton_gpu.convert_layout %cst : (tensor<64x64xf32, #C>) -> tensor<64x64xf32, #AL>
+  tt.return
+  // CHECK-NEXT: size = 8192
+}
+
+// stmatrix writes rows of 16 bytes, which the rows padded by 16 bytes put
+// on distinct banks
+// CHECK-LABEL: stmatrix_scratch
+tt.func @stmatrix_scratch() {
+  %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf16, #C3>
+  // CHECK: scratch offset = 0, size = 5120
+  %0 = triton_gpu.convert_layout %cst : (tensor<64x64xf16, #C3>) -> tensor<64x64xf16, #AL>
+  tt.return
+  // CHECK-NEXT: size = 5120
+}
+
+// Each warp holds the same rows in both layouts, and its lanes exchange
+// their elements with shuffles
+// CHECK-LABEL: warp_shuffle_cvt
+tt.func @warp_shuffle_cvt() {
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x32xf16, #AL>
+  // CHECK-NOT: scratch
+  %0 = triton_gpu.convert_layout %cst : (tensor<16x32xf16, #AL>) -> tensor<16x32xf16, #AL_T>
   tt.return
+  // CHECK: size = 0
 }
 
 
@@ -254,6 +300,53 @@ tt.func @scratch() {
   // CHECK-NEXT: size = 512
 }
 
+// Each warp holds whole columns, which shuffles reduce
+// CHECK-LABEL: warp_synchronous_reduce
+tt.func @warp_synchronous_reduce() {
+  %cst0 = arith.constant dense<0.000000e+00> : tensor<4x32xf16, #AL>
+  // CHECK-NOT: scratch
+  %b = "tt.reduce" (%cst0) ({
+  ^bb0(%arg0: f16, %arg1: f16):
+    %add = arith.addf %arg0, %arg1 : f16
+    tt.reduce.return %add : f16
+  }) {axis = 0 : i32} : (tensor<4x32xf16, #AL>) -> tensor<32xf16, #sliceAd0>
+  tt.return
+  // CHECK: size = 0
+}
+
+// CHECK-LABEL: scan_across_warps
+tt.func @scan_across_warps() {
+  %cst0 = arith.constant dense<0.000000e+00> : tensor<16x32xf32, #AL>
+  // CHECK: scratch offset = 0, size = 512
+  %b = "tt.scan" (%cst0) ({
+  ^bb0(%arg0: f32, %arg1: f32):
+    %add = arith.addf %arg0, %arg1 : f32
+    tt.scan.return %add : f32
+  }) {axis = 0 : i32} : (tensor<16x32xf32, #AL>) -> tensor<16x32xf32, #AL>
+  tt.return
+  // CHECK-NEXT: size = 512
+}
+
+// Warps hold whole rows, whose scans only need warp shuffles
+// CHECK-LABEL: scan_within_warps
+tt.func @scan_within_warps() {
+  %cst0 = arith.constant dense<0.000000e+00> : tensor<16x32xf32, #AL>
+  %cst1 = arith.constant dense<0.000000e+00> : tensor<32xf32, #sliceAd0>
+  // CHECK-NOT: scratch
+  %b = "tt.scan" (%cst0) ({
+  ^bb0(%arg0: f32, %arg1: f32):
+    %add = arith.addf %arg0, %arg1 : f32
+    tt.scan.return %add : f32
+  }) {axis = 1 : i32} : (tensor<16x32xf32, #AL>) -> tensor<16x32xf32, #AL>
+  %c = "tt.scan" (%cst1) ({
+  ^bb0(%arg0: f32, %arg1: f32):
+    %add = arith.addf %arg0, %arg1 : f32
+    tt.scan.return %add : f32
+  }) {axis = 0 : i32} : (tensor<32xf32, #sliceAd0>) -> tensor<32xf32, #sliceAd0>
+  tt.return
+  // CHECK: size = 0
+}
+
 // CHECK-LABEL: trans
 tt.func @trans(%A : !tt.ptr<f16>) {
   // CHECK: offset = 0, size = 1024
@@ -548,3 +641,29 @@ tt.func @call_graph_2(%A : !tt.ptr<f16>, %cond : i1) {
 }
 
 }
+
+// -----
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#C = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#A_DOT = #triton_gpu.dot_op<{opIdx = 0, parent = #C, kWidth=2}>
+
+// The two warp groups run their branches at the same time, so their scratch
+// buffers must not overlap
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.num-warp-groups" = 2 : i32} {
+
+// CHECK-LABEL: warp_groups_scratch
+tt.func @warp_groups_scratch(%is_producer : i1, %A : tensor<128x32xf16, #AL>, %B : tensor<128x32xf16, #AL>) {
+  scf.if %is_producer {
+    // CHECK: scratch offset = {{0|4608}}, size = 4608
+    %a = triton_gpu.convert_layout %A : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A_DOT>
+  } else {
+    // CHECK-NEXT: scratch offset = {{0|4608}}, size = 4608
+    %b = triton_gpu.convert_layout %B : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A_DOT>
+  }
+  tt.return
+  // Side by side rather than both at offset 0
+  // CHECK-NEXT: size = 9216
+}
+
+}
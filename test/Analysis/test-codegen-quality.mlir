@@ -0,0 +1,86 @@
+// RUN: triton-opt %s -split-input-file --mlir-disable-threading --convert-scf-to-cf -test-print-codegen-quality 2>&1 | FileCheck %s
+
+// Conventions: each function prints a `@name => shared = <bytes>, barriers =
+// <n>, warp syncs = <n>` line, to be matched with CHECK-LABEL, followed by
+// one `<op> => ...` line per global or shared memory access in program order
+// and one `loop depth <d> => ...` line per loop in the order of their headers.
+// Lock down performance-critical properties with CHECK-NEXT so that any
+// narrower access or extra barrier fails the test.
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// CHECK-LABEL: @vectorized => shared = 0, barriers = 0, warp syncs = 0
+tt.func @vectorized(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  %0 = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked>
+  %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<512x!tt.ptr<f32>, #blocked>
+  %2 = tt.addptr %1, %0 : tensor<512x!tt.ptr<f32>, #blocked>, tensor<512xi32, #blocked>
+  // CHECK-NEXT: tt.load => global = 128 bits
+  %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<512xf32, #blocked>
+  %4 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<512x!tt.ptr<f32>, #blocked>
+  %5 = tt.addptr %4, %0 : tensor<512x!tt.ptr<f32>, #blocked>, tensor<512xi32, #blocked>
+  // CHECK-NEXT: tt.store => global = 128 bits
+  tt.store %5, %3 {cache = 1 : i32, evict = 1 : i32} : tensor<512xf32, #blocked>
+  tt.return
+}
+
+// Without divisibility hints the base pointers are only known to be aligned
+// to their element type
+// CHECK-LABEL: @unaligned => shared = 0, barriers = 0, warp syncs = 0
+tt.func @unaligned(%arg0: !tt.ptr<f32>, %arg1: !tt.ptr<f32>) {
+  %0 = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked>
+  %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<512x!tt.ptr<f32>, #blocked>
+  %2 = tt.addptr %1, %0 : tensor<512x!tt.ptr<f32>, #blocked>, tensor<512xi32, #blocked>
+  // CHECK-NEXT: tt.load => global = 32 bits
+  %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<512xf32, #blocked>
+  %4 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<512x!tt.ptr<f32>, #blocked>
+  %5 = tt.addptr %4, %0 : tensor<512x!tt.ptr<f32>, #blocked>, tensor<512xi32, #blocked>
+  // CHECK-NEXT: tt.store => global = 32 bits
+  tt.store %5, %3 {cache = 1 : i32, evict = 1 : i32} : tensor<512xf32, #blocked>
+  tt.return
+}
+
+}
+
+// -----
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#BL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A_SHARED = #triton_gpu.shared<{vec = 8, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+#B_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// The shared buffer written and read in each iteration needs a barrier
+// between the store and the load, and one before the store of the next
+// iteration
+// CHECK-LABEL: @shared_loop => shared = 8192, barriers = 2, warp syncs = 0
+tt.func @shared_loop(%lb : index, %ub : index, %step : index, %A : !tt.ptr<f16>) {
+  %a_ptr = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<128x32x!tt.ptr<f16>, #AL>
+  %acc_init = arith.constant dense<0.00e+00> : tensor<128x32xf16, #BL>
+  %acc = scf.for %iv = %lb to %ub step %step iter_args(%prev = %acc_init) -> (tensor<128x32xf16, #BL>) {
+    // CHECK-NEXT: tt.load => global = 16 bits
+    %a_ = tt.load %a_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xf16, #AL>
+    // CHECK-NEXT: triton_gpu.convert_layout => shared store = 64 bits
+    %a_smem = triton_gpu.convert_layout %a_ : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A_SHARED>
+    // CHECK-NEXT: triton_gpu.convert_layout => shared load = 64 bits
+    %a = triton_gpu.convert_layout %a_smem : (tensor<128x32xf16, #A_SHARED>) -> tensor<128x32xf16, #BL>
+    %next = arith.addf %prev, %a : tensor<128x32xf16, #BL>
+    scf.yield %next : tensor<128x32xf16, #BL>
+  }
+  // CHECK-NEXT: loop depth 1 => barriers = 2, warp syncs = 0
+  tt.return
+}
+
+// CHECK-LABEL: @insert_slice_async => shared = 512, barriers = 0, warp syncs = 0
+tt.func @insert_slice_async(%A : !tt.ptr<f16>, %i1 : i1) {
+  %a_ptr = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<16x16x!tt.ptr<f16>, #AL>
+  %mask = tt.splat %i1 : (i1) -> tensor<16x16xi1, #AL>
+  %other = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #AL>
+  %tensor = triton_gpu.alloc_tensor : tensor<1x16x16xf16, #B_SHARED>
+  %index = arith.constant 0 : i32
+  // CHECK-NEXT: triton_gpu.insert_slice_async => global = 16 bits, shared store = 16 bits
+  %0 = triton_gpu.insert_slice_async %a_ptr, %tensor, %index, %mask, %other {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16x!tt.ptr<f16>, #AL> -> tensor<1x16x16xf16, #B_SHARED>
+  tt.return
+}
+
+}
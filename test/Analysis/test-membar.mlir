@@ -2,6 +2,7 @@
 
 #AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
 #sliceAd0 = #triton_gpu.slice<{dim = 0, parent = #AL}>
+#AL_W = #triton_gpu.blocked<{sizePerThread = [2, 2], threadsPerWarp = [2, 16], warpsPerCTA = [4, 1], order = [1, 0]}>
 #BL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
 #A_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
 #A_SHARED_T = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [0, 1]}>
@@ -61,15 +62,129 @@ tt.func @war_single_block(%A : !tt.ptr<f16>) {
   %0 = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<128x32x!tt.ptr<f16>, #AL>
   %1 = tt.load %0, %cst1, %cst2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xf16, #AL>
   %2 = triton_gpu.convert_layout %1 : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A_SHARED>
-  // CHECK: gpu.barrier
+  // Every element is stored and loaded by the warp owning it in #AL
+  // CHECK: triton_gpu.warp_sync
   // CHECK-NEXT: triton_gpu.convert_layout
   %3 = triton_gpu.convert_layout %2 : (tensor<128x32xf16, #A_SHARED>) -> tensor<128x32xf16, #AL>
-  // CHECK: gpu.barrier
+  // CHECK: triton_gpu.warp_sync
   // CHECK-NEXT: %4 = triton_gpu.convert_layout
   %4 = triton_gpu.convert_layout %1 : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A_SHARED>
   tt.return
 }
 
+// CHECK-LABEL: replicated_warps
+tt.func @replicated_warps(%A : !tt.ptr<f16>) {
+  %cst1 = arith.constant dense<true> : tensor<8x32xi1, #AL>
+  %cst2 = arith.constant dense<0.000000e+00> : tensor<8x32xf16, #AL>
+  %0 = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<8x32x!tt.ptr<f16>, #AL>
+  %1 = tt.load %0, %cst1, %cst2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<8x32xf16, #AL>
+  %2 = triton_gpu.convert_layout %1 : (tensor<8x32xf16, #AL>) -> tensor<8x32xf16, #A_SHARED>
+  // The 16 rows of the warps of #AL cover the 8 rows twice: warps 2 and 3
+  // hold the elements of warps 0 and 1
+  // CHECK-NOT: triton_gpu.warp_sync
+  // CHECK: gpu.barrier
+  // CHECK-NEXT: triton_gpu.convert_layout
+  %3 = triton_gpu.convert_layout %2 : (tensor<8x32xf16, #A_SHARED>) -> tensor<8x32xf16, #AL>
+  tt.return
+}
+
+// CHECK-LABEL: warp_sync_same_warp_tiling
+tt.func @warp_sync_same_warp_tiling(%A : !tt.ptr<f16>) {
+  %cst1 = arith.constant dense<true> : tensor<128x32xi1, #AL>
+  %cst2 = arith.constant dense<0.000000e+00> : tensor<128x32xf16, #AL>
+  %0 = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<128x32x!tt.ptr<f16>, #AL>
+  %1 = tt.load %0, %cst1, %cst2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xf16, #AL>
+  %2 = triton_gpu.convert_layout %1 : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A_SHARED>
+  // Warps own the same 4x32 tiles in #AL and #AL_W
+  // CHECK-NOT: gpu.barrier
+  // CHECK: triton_gpu.warp_sync
+  // CHECK-NEXT: triton_gpu.convert_layout
+  %3 = triton_gpu.convert_layout %2 : (tensor<128x32xf16, #A_SHARED>) -> tensor<128x32xf16, #AL_W>
+  // The same bytes are owned by other warps in #BL
+  // CHECK: gpu.barrier
+  // CHECK-NEXT: triton_gpu.convert_layout
+  %4 = triton_gpu.convert_layout %2 : (tensor<128x32xf16, #A_SHARED>) -> tensor<128x32xf16, #BL>
+  tt.return
+}
+
+// CHECK-LABEL: warp_sync_after_cta_write
+tt.func @warp_sync_after_cta_write(%A : !tt.ptr<f16>) {
+  %cst1 = arith.constant dense<true> : tensor<128x32xi1, #AL>
+  %cst2 = arith.constant dense<0.000000e+00> : tensor<128x32xf16, #AL>
+  %0 = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<128x32x!tt.ptr<f16>, #AL>
+  %1 = tt.load %0, %cst1, %cst2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xf16, #AL>
+  %2 = triton_gpu.convert_layout %1 : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A_SHARED>
+  // CHECK: triton_gpu.warp_sync
+  // CHECK-NEXT: triton_gpu.convert_layout
+  %3 = triton_gpu.convert_layout %2 : (tensor<128x32xf16, #A_SHARED>) -> tensor<128x32xf16, #AL>
+  // tt.cat loads %2 from other warps than the ones that stored it
+  // CHECK: gpu.barrier
+  // CHECK-NEXT: tt.cat
+  %4 = tt.cat %2, %2 {axis = 0} : (tensor<128x32xf16, #A_SHARED>, tensor<128x32xf16, #A_SHARED>) -> tensor<256x32xf16, #A_SHARED>
+  tt.return
+}
+
+// CHECK-LABEL: redundant_barrier
+tt.func @redundant_barrier() {
+  %cst0 = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #A_SHARED>
+  // CHECK: gpu.barrier
+  // CHECK-NEXT: triton_gpu.convert_layout
+  gpu.barrier
+  gpu.barrier {triton_gpu.membar}
+  %0 = triton_gpu.convert_layout %cst0 : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #AL>
+  tt.return
+}
+
+// The barrier at the end of the loop body already syncs the next iteration
+// CHECK-LABEL: redundant_loop_barrier
+tt.func @redundant_loop_barrier(%lb : index, %ub : index, %step : index) {
+  %cst0 = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #A_SHARED>
+  gpu.barrier
+  // CHECK: ^bb2:
+  // CHECK-NEXT: triton_gpu.convert_layout
+  // CHECK-NEXT: gpu.barrier
+  scf.for %iv = %lb to %ub step %step {
+    gpu.barrier {triton_gpu.membar}
+    %0 = triton_gpu.convert_layout %cst0 : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #AL>
+    gpu.barrier {triton_gpu.membar}
+  }
+  tt.return
+}
+
+// Barriers not inserted by the analysis, e.g. from tl.debug_barrier, are kept
+// CHECK-LABEL: user_barrier
+tt.func @user_barrier() {
+  // CHECK: gpu.barrier
+  // CHECK-NEXT: gpu.barrier
+  // CHECK-NEXT: tt.return
+  gpu.barrier
+  gpu.barrier
+  tt.return
+}
+
+// Global memory accesses, which may be ordered by a barrier, clobber it
+// CHECK-LABEL: global_store_barrier
+tt.func @global_store_barrier(%A : !tt.ptr<f32>, %v : f32) {
+  // CHECK: gpu.barrier
+  // CHECK-NEXT: tt.store
+  // CHECK-NEXT: gpu.barrier
+  gpu.barrier
+  tt.store %A, %v : f32
+  gpu.barrier {triton_gpu.membar}
+  tt.return
+}
+
+// CHECK-LABEL: redundant_warp_sync
+tt.func @redundant_warp_sync() {
+  %cst0 = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #A_SHARED>
+  // CHECK: gpu.barrier
+  // CHECK-NEXT: triton_gpu.convert_layout
+  gpu.barrier
+  triton_gpu.warp_sync
+  %0 = triton_gpu.convert_layout %cst0 : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #AL>
+  tt.return
+}
+
 // CHECK-LABEL: scratch
 tt.func @scratch() {
   %cst0 = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #A_SHARED>
@@ -100,6 +215,19 @@ tt.func @async_wait() {
   tt.return
 }
 
+// CHECK-LABEL: async_wait_consecutive
+tt.func @async_wait_consecutive() {
+  %cst0 = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #A_SHARED>
+  // CHECK: triton_gpu.async_wait {num = 4 : i32}
+  // CHECK-NEXT: triton_gpu.async_wait {num = 3 : i32}
+  // CHECK-NEXT: gpu.barrier
+  // CHECK-NEXT: triton_gpu.convert_layout
+  triton_gpu.async_wait {num = 4 : i32}
+  triton_gpu.async_wait {num = 3 : i32}
+  %0 = triton_gpu.convert_layout %cst0 : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #AL>
+  tt.return
+}
+
 // CHECK-LABEL: alloc
 tt.func @alloc() {
   %0 = triton_gpu.alloc_tensor : tensor<16x16xf16, #A_SHARED>
@@ -536,7 +664,7 @@ tt.func @convert_layout3(%cond : i1) {
   } else {
     %0 = triton_gpu.alloc_tensor : tensor<16x16xf16, #A_SHARED>
     // CHECK: triton_gpu.convert_layout
-    // CHECK-NEXT: gpu.barrier
+    // CHECK-NEXT: triton_gpu.warp_sync
     // CHECK-NEXT: triton_gpu.convert_layout
     %1 = triton_gpu.convert_layout %0 : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #AL>
     %2 = triton_gpu.convert_layout %1 : (tensor<16x16xf16, #AL>) -> tensor<16x16xf16, #A_SHARED>
@@ -636,3 +764,28 @@ tt.func @call_graph_2(%A : !tt.ptr<f16>, %cond : i1) {
 }
 
 }
+
+// -----
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [1, 1], order = [1, 0]}>
+#BL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [1, 1], order = [1, 0]}>
+#A_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+
+// CHECK-LABEL: warp_sync_single_warp
+tt.func @warp_sync_single_warp(%A : !tt.ptr<f16>) {
+  %cst1 = arith.constant dense<true> : tensor<32x32xi1, #AL>
+  %cst2 = arith.constant dense<0.000000e+00> : tensor<32x32xf16, #AL>
+  %0 = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<32x32x!tt.ptr<f16>, #AL>
+  %1 = tt.load %0, %cst1, %cst2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x32xf16, #AL>
+  %2 = triton_gpu.convert_layout %1 : (tensor<32x32xf16, #AL>) -> tensor<32x32xf16, #A_SHARED>
+  // A single warp owns every element
+  // CHECK-NOT: gpu.barrier
+  // CHECK: triton_gpu.warp_sync
+  // CHECK-NEXT: triton_gpu.convert_layout
+  %3 = triton_gpu.convert_layout %2 : (tensor<32x32xf16, #A_SHARED>) -> tensor<32x32xf16, #BL>
+  tt.return
+}
+
+}
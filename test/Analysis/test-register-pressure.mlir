@@ -0,0 +1,49 @@
+// RUN: triton-opt %s -split-input-file --mlir-disable-threading -test-print-register-pressure 2>&1 | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// CHECK-LABEL: @elementwise => 12
+tt.func @elementwise(%arg0: !tt.ptr<f32>) {
+  // CHECK-NEXT: tt.make_range => 6
+  %0 = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked>
+  // CHECK-NEXT: tt.splat => 12
+  %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<512x!tt.ptr<f32>, #blocked>
+  // CHECK-NEXT: tt.addptr => 12
+  %2 = tt.addptr %1, %0 : tensor<512x!tt.ptr<f32>, #blocked>, tensor<512xi32, #blocked>
+  // CHECK-NEXT: tt.load => 12
+  %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<512xf32, #blocked>
+  // CHECK-NEXT: arith.addf => 12
+  %4 = arith.addf %3, %3 : tensor<512xf32, #blocked>
+  tt.store %2, %4 {cache = 1 : i32, evict = 1 : i32} : tensor<512xf32, #blocked>
+  tt.return
+}
+
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// CHECK-LABEL: @loop => 132
+tt.func @loop(%lb : index, %ub : index, %step : index) -> tensor<128x128xf32, #mma> {
+  // Splat constants are immediates
+  // CHECK-NEXT: arith.constant => 3
+  %cst = arith.constant dense<0.000000e+00> : tensor<128x128xf32, #mma>
+  // CHECK-NEXT: tt.make_range => 7
+  %range = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked>
+  // The loop bounds die at the loop, the range used in its body stays live
+  // CHECK-NEXT: arith.addf => 132
+  // CHECK-NEXT: arith.addi => 132
+  // CHECK-NEXT: scf.for => 132
+  %0 = scf.for %iv = %lb to %ub step %step iter_args(%acc = %cst) -> (tensor<128x128xf32, #mma>) {
+    %1 = arith.addf %acc, %acc : tensor<128x128xf32, #mma>
+    %2 = arith.addi %range, %range : tensor<512xi32, #blocked>
+    scf.yield %1 : tensor<128x128xf32, #mma>
+  }
+  tt.return %0 : tensor<128x128xf32, #mma>
+}
+
+}
@@ -0,0 +1,68 @@
+// RUN: triton-opt %s -split-input-file --mlir-disable-threading -test-print-uniformity 2>&1 | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// CHECK-LABEL: @uniformity_1d
+tt.func @uniformity_1d(%arg0: f32) {
+  // CHECK-NEXT: tt.make_range => none
+  %0 = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked>
+  // CHECK-NEXT: arith.constant => cta
+  %c4 = arith.constant dense<4> : tensor<512xi32, #blocked>
+  // CHECK-NEXT: arith.constant => cta
+  %c128 = arith.constant dense<128> : tensor<512xi32, #blocked>
+  // Each thread holds 4 consecutive elements
+  // CHECK-NEXT: arith.divsi => thread
+  %1 = arith.divsi %0, %c4 : tensor<512xi32, #blocked>
+  // Each warp holds 128 consecutive elements
+  // CHECK-NEXT: arith.divsi => warp
+  %2 = arith.divsi %0, %c128 : tensor<512xi32, #blocked>
+  // Floating-point ops are as uniform as their operands
+  // CHECK-NEXT: arith.sitofp => thread
+  %3 = arith.sitofp %1 : tensor<512xi32, #blocked> to tensor<512xf32, #blocked>
+  // CHECK-NEXT: tt.splat => cta
+  %4 = tt.splat %arg0 : (f32) -> tensor<512xf32, #blocked>
+  // CHECK-NEXT: arith.mulf => cta
+  %5 = arith.mulf %4, %4 : tensor<512xf32, #blocked>
+  // CHECK-NEXT: arith.mulf => thread
+  %6 = arith.mulf %3, %5 : tensor<512xf32, #blocked>
+  // CHECK-NEXT: arith.sitofp => none
+  %7 = arith.sitofp %0 : tensor<512xi32, #blocked> to tensor<512xf32, #blocked>
+  // CHECK-NEXT: arith.addf => none
+  %8 = arith.addf %7, %6 : tensor<512xf32, #blocked>
+  tt.return
+}
+
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+#slice = #triton_gpu.slice<{dim = 0, parent = #blocked}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// CHECK-LABEL: @uniformity_2d
+tt.func @uniformity_2d() {
+  // CHECK-NEXT: tt.make_range => none
+  %0 = tt.make_range {end = 16 : i32, start = 0 : i32} : tensor<16xi32, #slice>
+  // CHECK-NEXT: arith.constant => cta
+  %c4 = arith.constant dense<4> : tensor<16xi32, #slice>
+  // Only blocked layouts are uniform over part of the tensor
+  // CHECK-NEXT: arith.divsi => none
+  %1 = arith.divsi %0, %c4 : tensor<16xi32, #slice>
+  // CHECK-NEXT: tt.expand_dims => thread
+  %2 = tt.expand_dims %1 {axis = 0 : i32} : (tensor<16xi32, #slice>) -> tensor<1x16xi32, #blocked>
+  // The 64 rows are covered twice, each thread holding rows r and r + 32
+  // CHECK-NEXT: tt.broadcast => thread
+  %3 = tt.broadcast %2 : (tensor<1x16xi32, #blocked>) -> tensor<64x16xi32, #blocked>
+  // CHECK-NEXT: tt.expand_dims => none
+  %4 = tt.expand_dims %0 {axis = 0 : i32} : (tensor<16xi32, #slice>) -> tensor<1x16xi32, #blocked>
+  %5 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+  %6 = tt.expand_dims %5 {axis = 1 : i32} : (tensor<64xi32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>) -> tensor<64x1xi32, #blocked>
+  // A row-invariant value differs between the rows of a thread
+  // CHECK: tt.broadcast => none
+  %7 = tt.broadcast %6 : (tensor<64x1xi32, #blocked>) -> tensor<64x16xi32, #blocked>
+  tt.return
+}
+
+}
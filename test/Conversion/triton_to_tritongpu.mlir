@@ -88,3 +88,50 @@ tt.func public @select_op(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg
   tt.store %6, %4 {cache = 1 : i32, evict = 1 : i32} : tensor<128xf32>
   tt.return
 }
+
+// -----
+
+// CHECK-DAG: #[[vec4:.*]] = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [2], order = [0]}>
+// CHECK-DAG: #[[vec1:.*]] = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [2], order = [0]}>
+// CHECK-LABEL: vectorized_1d
+tt.func public @vectorized_1d(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  // 128 bits of the widest (f32) accesses per thread, whatever the element type
+  // CHECK: tt.make_range {{.*}} : tensor<1024xi32, #[[vec4]]>
+  %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32>
+  %1 = tt.splat %arg0 : (!tt.ptr<f16>) -> tensor<1024x!tt.ptr<f16>>
+  %2 = tt.addptr %1, %0 : tensor<1024x!tt.ptr<f16>>, tensor<1024xi32>
+  // CHECK: tt.load {{.*}} : tensor<1024xf16, #[[vec4]]>
+  %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf16>
+  %4 = arith.extf %3 : tensor<1024xf16> to tensor<1024xf32>
+  %5 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<1024x!tt.ptr<f32>>
+  %6 = tt.addptr %5, %0 : tensor<1024x!tt.ptr<f32>>, tensor<1024xi32>
+  tt.store %6, %4 {cache = 1 : i32, evict = 1 : i32} : tensor<1024xf32>
+  // too few elements for more than one per thread
+  // CHECK: tt.make_range {{.*}} : tensor<64xi32, #[[vec1]]>
+  %7 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32>
+  tt.return
+}
+
+// -----
+
+// CHECK-LABEL: trans_in_registers
+tt.func @trans_in_registers(%ptr: tensor<32x64x!tt.ptr<f32>>, %out: tensor<64x32x!tt.ptr<f32>>) {
+  %a = tt.load %ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x64xf32>
+  // CHECK-NOT: triton_gpu.convert_layout
+  // CHECK: tt.trans %{{.*}} : (tensor<32x64xf32, #blocked{{.*}}>) -> tensor<64x32xf32, #blocked{{.*}}>
+  %b = tt.trans %a : (tensor<32x64xf32>) -> tensor<64x32xf32>
+  tt.store %out, %b : tensor<64x32xf32>
+  tt.return
+}
+
+// -----
+
+// CHECK-LABEL: trans_of_dot_operand
+tt.func @trans_of_dot_operand(%a: tensor<32x32xf16>, %b: tensor<32x32xf16>) -> tensor<32x32xf32> {
+  %c = arith.constant dense<0.000000e+00> : tensor<32x32xf32>
+  // CHECK: triton_gpu.convert_layout %{{.*}} -> tensor<32x32xf16, #shared>
+  // CHECK: tt.trans %{{.*}} : (tensor<32x32xf16, #shared>) -> tensor<32x32xf16, #shared1>
+  %bt = tt.trans %b : (tensor<32x32xf16>) -> tensor<32x32xf16>
+  %d = tt.dot %a, %bt, %c {allowTF32 = true} : tensor<32x32xf16> * tensor<32x32xf16> -> tensor<32x32xf32>
+  tt.return %d : tensor<32x32xf32>
+}
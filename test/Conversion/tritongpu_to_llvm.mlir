@@ -12,6 +12,16 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.maxnreg" = 128 : i32, "triton_gpu.min-blocks-per-sm" = 2 : i32} {
+  // CHECK: llvm.func @test_launch_bounds
+  // CHECK:  attributes {nvvm.kernel = 1 : ui1, nvvm.maxnreg = 128 : i32, nvvm.maxntid = [128 : i32], nvvm.minctasm = 2 : i32} {{.*}}
+  tt.func @test_launch_bounds(%A : !tt.ptr<f16>) {
+    tt.return
+  }
+} // end module
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
 module attributes {"triton_gpu.num-warps" = 4 : i32} {
   // CHECK-LABEL: basic_load
@@ -96,6 +106,26 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: load_store_with_l2_evict
+  tt.func @load_store_with_l2_evict(%a_ptr_init : tensor<256x!tt.ptr<f32>, #blocked0>, %b_ptr_init : tensor<256x!tt.ptr<f32>, #blocked0>) {
+    //      CHECK: llvm.inline_asm
+    // CHECK-SAME: createpolicy.fractional.L2::evict_first.b64 $0, 1.0;
+    //      CHECK: llvm.inline_asm
+    // CHECK-SAME: ld.global.L2::cache_hint.b32
+    %1 = tt.load %a_ptr_init {cache = 1 : i32, evict = 1 : i32, isVolatile = false, l2Evict = 2 : i32} : tensor<256xf32, #blocked0>
+    //      CHECK: llvm.inline_asm
+    // CHECK-SAME: createpolicy.fractional.L2::evict_last.b64 $0, 1.0;
+    //      CHECK: llvm.inline_asm
+    // CHECK-SAME: st.global.L2::cache_hint.b32
+    tt.store %b_ptr_init, %1 {cache = 1 : i32, evict = 1 : i32, l2Evict = 3 : i32} : tensor<256xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [2], order = [0]}>
 module attributes {"triton_gpu.num-warps" = 2 : i32} {
   // CHECK-LABEL: global_load_store_no_vec
@@ -355,6 +385,46 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: uniform_addf
+  tt.func @uniform_addf(%arg0 : f32, %arg1 : tensor<512xf32,#blocked0>) {
+    // The 4 elements of a thread are equal and computed once
+    // CHECK: llvm.fadd
+    // CHECK-NOT: llvm.fadd
+    // CHECK: llvm.fmul
+    // CHECK: llvm.fmul
+    // CHECK: llvm.fmul
+    // CHECK: llvm.fmul
+    // CHECK-NOT: llvm.fmul
+    %0 = tt.splat %arg0 : (f32) -> tensor<512xf32,#blocked0>
+    %1 = arith.addf %0, %0 : tensor<512xf32,#blocked0>
+    %2 = arith.mulf %1, %arg1 : tensor<512xf32,#blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: half2_arith
+  tt.func @half2_arith(%arg0 : tensor<256xf16,#blocked0>, %arg1 : tensor<256xf16,#blocked0>, %arg2 : tensor<256xbf16,#blocked0>, %arg3 : tensor<256xbf16,#blocked0>) {
+    // CHECK: llvm.fadd %{{.*}}, %{{.*}} : vector<2xf16>
+    // CHECK-NOT: llvm.fadd
+    %0 = arith.addf %arg0, %arg1 : tensor<256xf16,#blocked0>
+    // CHECK: llvm.fmul %{{.*}}, %{{.*}} : vector<2xf16>
+    %1 = arith.mulf %0, %arg1 : tensor<256xf16,#blocked0>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: fma.rn.bf16x2 $0, $2, c, $1;
+    // CHECK-NOT: fma.rn.bf16 $0
+    %2 = arith.subf %arg2, %arg3 : tensor<256xbf16,#blocked0>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
 module attributes {"triton_gpu.num-warps" = 4 : i32} {
   // CHECK-LABEL: basic_addi
@@ -455,6 +525,28 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.num-warp-groups" = 2 : i32} {
+  // CHECK-LABEL: warp_groups
+  tt.func @warp_groups() {
+    // CHECK: nvvm.read.ptx.sreg.tid.x
+    // CHECK: llvm.udiv
+    %0 = triton_gpu.get_warp_group_id : i32
+    // CHECK: bar.arrive $0, 0x100;
+    triton_gpu.named_barrier_arrive %0 {numThreads = 256 : i32}
+    // CHECK: bar.sync $0, 0x100;
+    triton_gpu.named_barrier_wait %0 {numThreads = 256 : i32}
+    // Barriers only synchronize the warps of the group
+    // CHECK: nvvm.read.ptx.sreg.tid.x
+    // CHECK: llvm.udiv
+    // CHECK: bar.sync $0, 0x80;
+    // CHECK-NOT: nvvm.barrier0
+    gpu.barrier
+    tt.return
+  }
+}
+
+// -----
+
 #block0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [4], warpsPerCTA = [4], order = [0]}>
 #block1 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [8], warpsPerCTA = [4], order = [0]}>
 #block2 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [4, 1], warpsPerCTA = [4, 1], order = [1, 0]}>
@@ -523,9 +615,9 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
     %index = arith.constant 1 : i32
 
     // CHECK: llvm.inline_asm has_side_effects asm_dialect = att
-    // CHECK-SAME: cp.async.cg.shared.global [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x10, 0x10
+    // CHECK-SAME: cp.async.cg.shared.global.L2::128B [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x10, 0x10
     // CHECK: llvm.inline_asm has_side_effects asm_dialect = att
-    // CHECK-SAME: cp.async.cg.shared.global [ ${{.*}} + 16 ], [ ${{.*}} + 0 ], 0x10, 0x10
+    // CHECK-SAME: cp.async.cg.shared.global.L2::128B [ ${{.*}} + 16 ], [ ${{.*}} + 0 ], 0x10, 0x10
     // CHECK: llvm.inline_asm has_side_effects asm_dialect = att
     // CHECK-SAME: cp.async.commit_group
     %a = triton_gpu.insert_slice_async %a_ptr, %tensor, %index {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x64x!tt.ptr<f32>, #AL> -> tensor<2x16x64xf32, #A>
@@ -565,13 +657,13 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
     %index = arith.constant 1 : i32
 
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: cp.async.ca.shared.global [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
+    // CHECK-SAME: cp.async.ca.shared.global.L2::128B [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: cp.async.ca.shared.global [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
+    // CHECK-SAME: cp.async.ca.shared.global.L2::128B [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: cp.async.ca.shared.global [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
+    // CHECK-SAME: cp.async.ca.shared.global.L2::128B [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: cp.async.ca.shared.global [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
+    // CHECK-SAME: cp.async.ca.shared.global.L2::128B [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
     // CHECK: llvm.inline_asm
     // CHECK-SAME: cp.async.commit_group
     %a = triton_gpu.insert_slice_async %a_ptr, %tensor, %index {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x32x!tt.ptr<f32>, #AL> -> tensor<2x16x32xf32, #A>
@@ -614,21 +706,21 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
     // CHECK: llvm.mul
     // CHECK: llvm.add
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: cp.async.ca.shared.global [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
+    // CHECK-SAME: cp.async.ca.shared.global.L2::128B [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: cp.async.ca.shared.global [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
+    // CHECK-SAME: cp.async.ca.shared.global.L2::128B [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: cp.async.ca.shared.global [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
+    // CHECK-SAME: cp.async.ca.shared.global.L2::128B [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: cp.async.ca.shared.global [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
+    // CHECK-SAME: cp.async.ca.shared.global.L2::128B [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: cp.async.ca.shared.global [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
+    // CHECK-SAME: cp.async.ca.shared.global.L2::128B [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: cp.async.ca.shared.global [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
+    // CHECK-SAME: cp.async.ca.shared.global.L2::128B [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: cp.async.ca.shared.global [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
+    // CHECK-SAME: cp.async.ca.shared.global.L2::128B [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
     // CHECK: llvm.inline_asm
-    // CHECK-SAME: cp.async.ca.shared.global [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
+    // CHECK-SAME: cp.async.ca.shared.global.L2::128B [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x4, 0x4
     // CHECK: llvm.inline_asm
     // CHECK-SAME: cp.async.commit_group
     %a = triton_gpu.insert_slice_async %a_ptr, %tensor, %index {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x32x!tt.ptr<f32>, #AL> -> tensor<2x32x32xf32, #A>
@@ -639,6 +731,41 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [2, 16], warpsPerCTA = [4, 1], order = [1, 0]}>
+#ALs0 = #triton_gpu.slice<{dim = 0, parent = #AL}>
+#A = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: insert_slice_async_prefix_mask
+  tt.func @insert_slice_async_prefix_mask(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %n: i32) {
+    %off_ = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32, #ALs0>
+    %off1 = tt.expand_dims %off_ {axis = 0 : i32} : (tensor<128xi32, #ALs0>) -> tensor<1x128xi32, #AL>
+    %off = tt.broadcast %off1 : (tensor<1x128xi32, #AL>) -> tensor<16x128xi32, #AL>
+    %bound = tt.splat %n : (i32) -> tensor<16x128xi32, #AL>
+    %mask = arith.cmpi slt, %off, %bound : tensor<16x128xi32, #AL>
+    %a_init = tt.splat %arg0 : (!tt.ptr<f16>) -> tensor<16x128x!tt.ptr<f16>, #AL>
+    %a_ptr = tt.addptr %a_init, %off : tensor<16x128x!tt.ptr<f16>, #AL>, tensor<16x128xi32, #AL>
+    %tensor = triton_gpu.alloc_tensor : tensor<2x16x128xf16, #A>
+    %index = arith.constant 1 : i32
+
+    // The tail of a vector past the bound is zero-filled: the vectors are
+    // copied whole, with the size of their valid elements
+    // CHECK: llvm.select
+    // CHECK: llvm.add
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: cp.async.cg.shared.global.L2::256B [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x10, $
+    // CHECK: cp.async.commit_group
+    %a = triton_gpu.insert_slice_async %a_ptr, %tensor, %index, %mask {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x128x!tt.ptr<f16>, #AL> -> tensor<2x16x128xf16, #A>
+    triton_gpu.async_commit_group
+    // Loads asking for L1 keep it
+    // CHECK: cp.async.ca.shared.global.L2::256B [ ${{.*}} + 0 ], [ ${{.*}} + 0 ], 0x10, $
+    %b = triton_gpu.insert_slice_async %a_ptr, %tensor, %index, %mask {axis = 0 : i32, cache = 2 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x128x!tt.ptr<f16>, #AL> -> tensor<2x16x128xf16, #A>
+    triton_gpu.async_commit_group
+    tt.return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
 module attributes {"triton_gpu.num-warps" = 4 : i32} {
   // CHECK: basic_splat
@@ -744,22 +871,10 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
   // CHECK: llvm.mlir.global external @global_smem() {addr_space = 3 : i32} : !llvm.array<0 x i8>
   // CHECK-LABEL: convert_layout_blocked_blocked_multi_rep
   tt.func @convert_layout_blocked_blocked_multi_rep(%arg0: tensor<16x16xf32, #blocked0>) {
-    // CHECK: llvm.mlir.addressof @global_smem
-    // CHECK: llvm.store
-    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
-    // CHECK: nvvm.barrier0
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
-    // CHECK: nvvm.barrier0
-    // CHECK: llvm.store
-    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
-    // CHECK: nvvm.barrier0
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
+    // The single warp holds the whole tensor in both layouts
+    // CHECK-NOT: llvm.mlir.addressof @global_smem
+    // CHECK-COUNT-16: shfl.sync.idx.b32
+    // CHECK-NOT: nvvm.barrier0
     %0 = triton_gpu.convert_layout %arg0 : (tensor<16x16xf32, #blocked0>) -> tensor<16x16xf32, #blocked1>
     tt.return
   }
@@ -795,6 +910,157 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
   }
 }
 
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
+#shared0 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#shared1 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [0, 1]}>
+#mma0 = #triton_gpu.mma<{versionMajor=2, warpsPerCTA=[1,1]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx=0, parent=#mma0, kWidth=4}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx=1, parent=#mma0, kWidth=4}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: convert_dot_fp8
+  tt.func @convert_dot_fp8(%A: tensor<16x32xf8E4M3FNUZ, #blocked0>, %B: tensor<32x16xf8E5M2, #blocked0>) {
+    %AA = triton_gpu.convert_layout %A : (tensor<16x32xf8E4M3FNUZ, #blocked0>) -> tensor<16x32xf8E4M3FNUZ, #shared0>
+    %BB = triton_gpu.convert_layout %B : (tensor<32x16xf8E5M2, #blocked0>) -> tensor<32x16xf8E5M2, #shared1>
+    %AA_DOT = triton_gpu.convert_layout %AA : (tensor<16x32xf8E4M3FNUZ, #shared0>) -> tensor<16x32xf8E4M3FNUZ, #dot_operand_a>
+    %BB_DOT = triton_gpu.convert_layout %BB : (tensor<32x16xf8E5M2, #shared1>) -> tensor<32x16xf8E5M2, #dot_operand_b>
+    %cst0 = arith.constant dense<0.000000e+00> : tensor<16x16xf32, #mma0>
+
+    // The operands stay fp8 up to the tensor cores, which take them k32 at a time
+    // CHECK-NOT: cvt.rn.f16x2
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: mma.sync.aligned.m16n8k32.row.col.f32.e4m3.e5m2.f32
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: mma.sync.aligned.m16n8k32.row.col.f32.e4m3.e5m2.f32
+    // CHECK-NOT: mma.sync
+    %D = tt.dot %AA_DOT, %BB_DOT, %cst0 {allowTF32 = true, transA = false, transB = false} : tensor<16x32xf8E4M3FNUZ, #dot_operand_a> * tensor<32x16xf8E5M2, #dot_operand_b> -> tensor<16x16xf32, #mma0>
+
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [16, 2], warpsPerCTA = [1, 1], order = [1, 0]}>
+#shared0 = #triton_gpu.shared<{vec = 1, perPhase=2, maxPhase=8 ,order = [1, 0]}>
+#shared1 = #triton_gpu.shared<{vec = 1, perPhase=1, maxPhase=1 ,order = [1, 0]}>
+#mma0 = #triton_gpu.mma<{versionMajor=2, warpsPerCTA=[1,1]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx=0, parent=#mma0, kWidth=2}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx=1, parent=#mma0, kWidth=2}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: convert_sparse_dot
+  tt.func @convert_sparse_dot(%A: tensor<16x16xf16, #blocked0>, %B: tensor<32x16xf16, #blocked0>, %M: tensor<16x2xi16, #blocked1>) {
+    %AA = triton_gpu.convert_layout %A : (tensor<16x16xf16, #blocked0>) -> tensor<16x16xf16, #shared0>
+    %BB = triton_gpu.convert_layout %B : (tensor<32x16xf16, #blocked0>) -> tensor<32x16xf16, #shared0>
+    %MM = triton_gpu.convert_layout %M : (tensor<16x2xi16, #blocked1>) -> tensor<16x2xi16, #shared1>
+    %AA_DOT = triton_gpu.convert_layout %AA : (tensor<16x16xf16, #shared0>) -> tensor<16x16xf16, #dot_operand_a>
+    %BB_DOT = triton_gpu.convert_layout %BB : (tensor<32x16xf16, #shared0>) -> tensor<32x16xf16, #dot_operand_b>
+    %cst0 = arith.constant dense<0.000000e+00> : tensor<16x16xf32, #mma0>
+
+    // CHECK: llvm.load {{.*}} : !llvm.ptr<i16, 3>
+    // CHECK: llvm.load {{.*}} : !llvm.ptr<i16, 3>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: mma.sp.sync.aligned.m16n8k32.row.col.f32.f16.f16.f32
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: mma.sp.sync.aligned.m16n8k32.row.col.f32.f16.f16.f32
+    // CHECK-NOT: mma.sp.sync
+    %D = tt.sparse_dot %AA_DOT, %BB_DOT, %cst0, %MM : tensor<16x16xf16, #dot_operand_a> * tensor<32x16xf16, #dot_operand_b> , tensor<16x2xi16, #shared1> -> tensor<16x16xf32, #mma0>
+
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#shared0 = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0]}>
+#mma0 = #triton_gpu.mma<{versionMajor = 3, warpsPerCTA = [4, 1]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx=0, parent=#mma0}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx=1, parent=#mma0}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: convert_dot_mmav3
+  tt.func @convert_dot_mmav3(%A: tensor<64x64xf16, #blocked0>, %B: tensor<64x64xf16, #blocked0>) {
+    %AA = triton_gpu.convert_layout %A : (tensor<64x64xf16, #blocked0>) -> tensor<64x64xf16, #shared0>
+    %BB = triton_gpu.convert_layout %B : (tensor<64x64xf16, #blocked0>) -> tensor<64x64xf16, #shared0>
+    // CHECK-NOT: ldmatrix
+    %AA_DOT = triton_gpu.convert_layout %AA : (tensor<64x64xf16, #shared0>) -> tensor<64x64xf16, #dot_operand_a>
+    %BB_DOT = triton_gpu.convert_layout %BB : (tensor<64x64xf16, #shared0>) -> tensor<64x64xf16, #dot_operand_b>
+    %cst0 = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #mma0>
+
+    // CHECK: wgmma.fence.sync.aligned
+    // CHECK-COUNT-4: wgmma.mma_async.sync.aligned.m64n64k16.f32.f16.f16
+    // CHECK: wgmma.commit_group.sync.aligned
+    // CHECK: wgmma.wait_group.sync.aligned 0
+    %D = tt.dot %AA_DOT, %BB_DOT, %cst0 {allowTF32 = true, transA = false, transB = false} : tensor<64x64xf16, #dot_operand_a> * tensor<64x64xf16, #dot_operand_b> -> tensor<64x64xf32, #mma0>
+
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 16], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [16, 1], threadsPerWarp = [4, 8], warpsPerCTA = [1, 4], order = [0, 1]}>
+#shared0 = #triton_gpu.shared<{vec = 16, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+#shared1 = #triton_gpu.shared<{vec = 16, perPhase = 2, maxPhase = 4, order = [0, 1]}>
+#mma0 = #triton_gpu.mma<{versionMajor = 3, warpsPerCTA = [4, 1]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx=0, parent=#mma0}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx=1, parent=#mma0}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: convert_dot_mmav3_fp8
+  tt.func @convert_dot_mmav3_fp8(%A: tensor<64x64xf8E4M3FNUZ, #blocked0>, %B: tensor<64x64xf8E4M3FNUZ, #blocked1>) {
+    %AA = triton_gpu.convert_layout %A : (tensor<64x64xf8E4M3FNUZ, #blocked0>) -> tensor<64x64xf8E4M3FNUZ, #shared0>
+    %BB = triton_gpu.convert_layout %B : (tensor<64x64xf8E4M3FNUZ, #blocked1>) -> tensor<64x64xf8E4M3FNUZ, #shared1>
+    %AA_DOT = triton_gpu.convert_layout %AA : (tensor<64x64xf8E4M3FNUZ, #shared0>) -> tensor<64x64xf8E4M3FNUZ, #dot_operand_a>
+    %BB_DOT = triton_gpu.convert_layout %BB : (tensor<64x64xf8E4M3FNUZ, #shared1>) -> tensor<64x64xf8E4M3FNUZ, #dot_operand_b>
+    %cst0 = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #mma0>
+
+    // fp8 is read K-major without the transpose immediates
+    // CHECK: wgmma.fence.sync.aligned
+    // CHECK-COUNT-2: wgmma.mma_async.sync.aligned.m64n64k32.f32.e4m3.e4m3 {{.*}}, p, 1, 1;
+    // CHECK: wgmma.commit_group.sync.aligned
+    %D = tt.dot %AA_DOT, %BB_DOT, %cst0 {allowTF32 = true, transA = false, transB = false} : tensor<64x64xf8E4M3FNUZ, #dot_operand_a> * tensor<64x64xf8E4M3FNUZ, #dot_operand_b> -> tensor<64x64xf32, #mma0>
+
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: tma_load
+  tt.func @tma_load(%desc: !tt.ptr<i8>, %x: i32, %y: i32) {
+    // CHECK: mbarrier.init.shared::cta.b64
+    // CHECK: mbarrier.arrive.expect_tx.shared::cta.b64 _, [$1], 8192
+    // CHECK-NEXT: cp.async.bulk.tensor.2d.shared::cluster.global.mbarrier::complete_tx::bytes [$2], [$3, {$4, $5}], [$1]
+    // CHECK: mbarrier.try_wait.parity.shared::cta.b64
+    // CHECK-COUNT-4: llvm.load {{.*}} : !llvm.ptr<vector<8xf16>, 3>
+    // CHECK: mbarrier.inval.shared::cta.b64
+    %0 = tt.tma_load %desc, [%x, %y] {order = array<i32: 1, 0>} : !tt.ptr<i8> -> tensor<64x64xf16, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: block_load
+  tt.func @block_load(%base: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %m: i64, %n: i64, %stride: i64 {tt.divisibility = 16 : i32}, %x: i64) {
+    %c0 = arith.constant 0 : i64
+    %c1 = arith.constant 1 : i64
+    // Only the rows are checked, and the rows are read as vectors
+    // CHECK-COUNT-4: llvm.icmp "slt"
+    // CHECK-NOT: llvm.icmp "slt"
+    // CHECK-COUNT-4: @${{.*}} ld.global.v4.b32
+    %0 = tt.block_load %base, [%m, %n], [%stride, %c1], [%x, %c0] {boundaryCheck = array<i32: 0>, cache = 1 : i32, evict = 1 : i32, isVolatile = false, order = array<i32: 1, 0>, padding = 1 : i32} : !tt.ptr<f16> -> tensor<64x64xf16, #blocked0>
+    tt.return
+  }
+}
+
 // TODO: problems in MLIR's parser on slice layout
 // #blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
 // module attributes {"triton_gpu.num-warps" = 1 : i32} {
@@ -826,6 +1092,41 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: convert_layout_mmav2_blocked_swizzled
+  tt.func @convert_layout_mmav2_blocked_swizzled(%arg0: tensor<64x64xf32, #mma>) {
+    // CHECK: llvm.xor
+    // CHECK: llvm.store
+    // CHECK-SAME: !llvm.ptr<vector<2xf32>, 3>
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.xor
+    // CHECK: llvm.load
+    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
+    %0 = triton_gpu.convert_layout %arg0 : (tensor<64x64xf32, #mma>) -> tensor<64x64xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 3, warpsPerCTA = [4, 1]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: convert_layout_mmav3_blocked_stmatrix
+  tt.func @convert_layout_mmav3_blocked_stmatrix(%arg0: tensor<64x64xf16, #mma>) {
+    // CHECK-COUNT-8: stmatrix.sync.aligned.m8n8.x2.shared.b16
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.load
+    // CHECK-SAME: !llvm.ptr<vector<8xf16>, 3>
+    %0 = triton_gpu.convert_layout %arg0 : (tensor<64x64xf16, #mma>) -> tensor<64x64xf16, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 4], order = [1, 0]}>
 #mma = #triton_gpu.mma<{versionMajor = 1, versionMinor = 3, warpsPerCTA = [2, 2]}>
 module attributes {"triton_gpu.num-warps" = 1 : i32} {
@@ -898,9 +1199,10 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
   // CHECK-LABEL: convert_blocked_to_blocked_ptr
   tt.func @convert_blocked_to_blocked_ptr(%src:tensor<32x!tt.ptr<f32>, #blocked0>) {
     // CHECK: llvm.ptrtoint
-    // CHECK: llvm.store
-    // CHECK: nvvm.barrier0
+    // CHECK: shfl.sync.idx.b32
+    // CHECK: shfl.sync.idx.b32
     // CHECK: llvm.inttoptr
+    // CHECK-NOT: nvvm.barrier0
     // CHECK-COUNT-4: llvm.insertvalue
     %cvt = triton_gpu.convert_layout %src : (tensor<32x!tt.ptr<f32>, #blocked0>) -> tensor<32x!tt.ptr<f32>, #blocked1>
     tt.return
@@ -909,6 +1211,22 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [0, 1]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: convert_layout_blocked_blocked_shfl
+  tt.func @convert_layout_blocked_blocked_shfl(%arg0: tensor<32x16xf32, #blocked0>) {
+    // Each warp holds the same 8 rows in both layouts
+    // CHECK-NOT: llvm.mlir.addressof @global_smem
+    // CHECK-COUNT-4: shfl.sync.idx.b32
+    // CHECK-NOT: nvvm.barrier0
+    %0 = triton_gpu.convert_layout %arg0 : (tensor<32x16xf32, #blocked0>) -> tensor<32x16xf32, #blocked1>
+    tt.return
+  }
+}
+
+// -----
+
 #blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 4], order = [1, 0]}>
 #shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
 #mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [2, 2]}>
@@ -981,6 +1299,32 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 4], order = [1, 0]}>
+#shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx=0, parent=#blocked}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx=1, parent=#blocked}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: matmul_fmadot_f16
+  tt.func @matmul_fmadot_f16(%ptr:!tt.ptr<f32> {tt.divisibility = 16 : i32},
+  %a:tensor<32x16xf16, #shared>, %b:tensor<16x32xf16, #shared>) {
+    %cst = arith.constant dense<0.000000e+00> : tensor<32x32xf32, #blocked>
+    // CHECK: llvm.load %{{.*}} : !llvm.ptr<vector<8xf16>, 3>
+    %a_mat = triton_gpu.convert_layout %a : (tensor<32x16xf16, #shared>) -> tensor<32x16xf16, #dot_operand_a>
+    // CHECK: llvm.load %{{.*}} : !llvm.ptr<vector<4xf16>, 3>
+    %b_mat = triton_gpu.convert_layout %b : (tensor<16x32xf16, #shared>) -> tensor<16x32xf16, #dot_operand_b>
+    // CHECK: llvm.intr.fma({{.*}}) : (vector<2xf16>, vector<2xf16>, vector<2xf16>) -> vector<2xf16>
+    // CHECK: llvm.fpext %{{.*}} : f16 to f32
+    // CHECK-NOT: llvm.intr.fmuladd
+    %28 = tt.dot %a_mat, %b_mat, %cst {allowTF32 = false, transA = false, transB = false} : tensor<32x16xf16, #dot_operand_a> * tensor<16x32xf16, #dot_operand_b> -> tensor<32x32xf32, #blocked>
+    %30 = tt.splat %ptr : (!tt.ptr<f32>) -> tensor<32x1x!tt.ptr<f32>, #blocked>
+    %36 = tt.broadcast %30 : (tensor<32x1x!tt.ptr<f32>, #blocked>) -> tensor<32x32x!tt.ptr<f32>, #blocked>
+    tt.store %36, %28 : tensor<32x32xf32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
 #mma = #triton_gpu.mma<{versionMajor=2, warpsPerCTA=[2, 2]}>
 #shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
 #blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 4], order = [1, 0]}>
@@ -1024,11 +1368,61 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 module attributes {"triton_gpu.num-warps" = 4 : i32} {
   // CHECK-LABEL: atomic_add_f32
   tt.func @atomic_add_f32(%arg0 : tensor<256x!tt.ptr<f32>, #blocked0>, %arg1 : tensor<256xi1, #blocked0>, %arg2 : tensor<256xf32, #blocked0>) {
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @$2 red.global.gpu.relaxed.add.f32
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @$2 red.global.gpu.relaxed.add.f32
+    %0 = "tt.atomic_rmw" (%arg0, %arg2, %arg1) {atomic_rmw_op = 5 : i32, sem = 1 : i32} : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: atomic_add_f32_used
+  tt.func @atomic_add_f32_used(%arg0 : tensor<256x!tt.ptr<f32>, #blocked0>, %arg1 : tensor<256xi1, #blocked0>, %arg2 : tensor<256xf32, #blocked0>) {
     // CHECK: llvm.inline_asm
     // CHECK-SAME: @$3 atom.global.gpu.relaxed.add.f32
     // CHECK: llvm.inline_asm
     // CHECK-SAME: @$3 atom.global.gpu.relaxed.add.f32
     %0 = "tt.atomic_rmw" (%arg0, %arg2, %arg1) {atomic_rmw_op = 5 : i32, sem = 1 : i32} : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf32, #blocked0>
+    tt.store %arg0, %0 : tensor<256xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: atomic_add_f16x2
+  tt.func @atomic_add_f16x2(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1 : tensor<256xf16, #blocked0>) {
+    %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+    %1 = tt.splat %arg0 : (!tt.ptr<f16>) -> tensor<256x!tt.ptr<f16>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<256x!tt.ptr<f16>, #blocked0>, tensor<256xi32, #blocked0>
+    %true = arith.constant dense<true> : tensor<256xi1, #blocked0>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: red.global.gpu.relaxed.add.noftz.f16x2
+    // CHECK-NOT: red.global
+    %3 = "tt.atomic_rmw" (%2, %arg1, %true) {atomic_rmw_op = 5 : i32, sem = 1 : i32} : (tensor<256x!tt.ptr<f16>, #blocked0>, tensor<256xf16, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf16, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: atomic_add_f32_aggregate
+  tt.func @atomic_add_f32_aggregate(%arg0 : tensor<128x!tt.ptr<f32>, #blocked0>, %arg1 : tensor<128xi1, #blocked0>, %arg2 : tensor<128xf32, #blocked0>) {
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: match.any.sync.b64
+    // CHECK-COUNT-5: vote.sync.ballot.b32
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @$2 red.global.gpu.relaxed.add.f32
+    %0 = "tt.atomic_rmw" (%arg0, %arg2, %arg1) {aggregate, atomic_rmw_op = 5 : i32, sem = 1 : i32} : (tensor<128x!tt.ptr<f32>, #blocked0>, tensor<128xf32, #blocked0>, tensor<128xi1, #blocked0>) -> tensor<128xf32, #blocked0>
     tt.return
   }
 }
@@ -1039,9 +1433,54 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
   // CHECK-LABEL: atomic_add_f32_scalar
   tt.func @atomic_add_f32_scalar(%arg0 : !tt.ptr<f32>, %arg1 : i1, %arg2 : f32) {
     // CHECK: llvm.icmp "eq"
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @$2 red.global.gpu.relaxed.add.f32
+    // CHECK-NOT: st.shared
+    %0 = "tt.atomic_rmw" (%arg0, %arg2, %arg1) {atomic_rmw_op = 5 : i32, sem = 1: i32} : (!tt.ptr<f32>, f32, i1) -> f32
+    tt.return
+  }
+}
+
+// -----
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: atomic_add_f32_scalar_used
+  tt.func @atomic_add_f32_scalar_used(%arg0 : !tt.ptr<f32>, %arg1 : i1, %arg2 : f32) {
     // CHECK: llvm.inline_asm
     // CHECK-SAME: @$3 atom.global.gpu.relaxed.add.f32
+    // CHECK: st.shared.b32
     %0 = "tt.atomic_rmw" (%arg0, %arg2, %arg1) {atomic_rmw_op = 5 : i32, sem = 1: i32} : (!tt.ptr<f32>, f32, i1) -> f32
+    tt.store %arg0, %0 : f32
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: atomic_add_scope
+  tt.func @atomic_add_scope(%arg0 : tensor<128x!tt.ptr<i32>, #blocked0>, %arg1 : tensor<128xi1, #blocked0>, %arg2 : tensor<128xi32, #blocked0>) {
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @$2 red.global.cta.relaxed.add.s32
+    %0 = "tt.atomic_rmw" (%arg0, %arg2, %arg1) {atomic_rmw_op = 4 : i32, scope = 2 : i32, sem = 1 : i32} : (tensor<128x!tt.ptr<i32>, #blocked0>, tensor<128xi32, #blocked0>, tensor<128xi1, #blocked0>) -> tensor<128xi32, #blocked0>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: @$3 atom.global.sys.acq_rel.max.s32
+    %1 = "tt.atomic_rmw" (%arg0, %arg2, %arg1) {atomic_rmw_op = 6 : i32, scope = 3 : i32, sem = 4 : i32} : (tensor<128x!tt.ptr<i32>, #blocked0>, tensor<128xi32, #blocked0>, tensor<128xi1, #blocked0>) -> tensor<128xi32, #blocked0>
+    tt.store %arg0, %1 : tensor<128xi32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: atomic_cas_scope
+  tt.func @atomic_cas_scope(%arg0 : !tt.ptr<i32>, %arg1 : i32, %arg2 : i32) {
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: atom.global.sys.acquire.cas.b32
+    %0 = "tt.atomic_cas" (%arg0, %arg1, %arg2) {scope = 3 : i32, sem = 2 : i32} : (!tt.ptr<i32>, i32, i32) -> i32
+    tt.store %arg0, %0 : i32
     tt.return
   }
 }
@@ -1160,6 +1599,31 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
   }
 }
 
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: test_index_cache_function
+  tt.func @test_index_cache_function() {
+    // CHECK: nvvm.read.ptx.sreg.tid.x
+    %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+    tt.return
+  }
+  // Each function has its own indices, computed in its entry block
+  // CHECK-LABEL: test_index_cache_entry_block
+  tt.func @test_index_cache_entry_block(%arg0: i1) {
+    // CHECK: nvvm.read.ptx.sreg.tid.x
+    // CHECK: llvm.cond_br
+    // CHECK-NOT: nvvm.read.ptx.sreg.tid.x
+    cf.cond_br %arg0, ^bb1, ^bb2
+    ^bb1:  // pred: ^bb0
+      %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+      cf.br ^bb2
+    ^bb2:  // 2 preds: ^bb0, ^bb1
+      %1 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+      tt.return
+  }
+}
+
 // -----
 
 #mma = #triton_gpu.mma<{versionMajor=2, warpsPerCTA=[2, 2]}>
@@ -1253,3 +1717,181 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
     tt.return
   }
 }
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: reduce_warp_redux
+  tt.func @reduce_warp_redux(%arg0: tensor<4x32xi32, #blocked>) {
+    // CHECK: redux.sync.add.s32
+    // CHECK-NOT: shfl.sync
+    // CHECK-NOT: nvvm.barrier0
+    %0 = "tt.reduce"(%arg0) ({
+    ^bb0(%arg1: i32, %arg2: i32):
+      %1 = arith.addi %arg1, %arg2 : i32
+      tt.reduce.return %1 : i32
+    }) {axis = 1 : i32} : (tensor<4x32xi32, #blocked>) -> tensor<4xi32, #triton_gpu.slice<{dim = 1, parent = #blocked}>>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 4], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: reduce_warp_shfl_slow_axis
+  tt.func @reduce_warp_shfl_slow_axis(%arg0: tensor<8x16xf32, #blocked>) {
+    // The 8 lanes along the rows are 4 lanes apart
+    // CHECK: shfl.sync.bfly.b32 {{.*}}, 0x10, 0x1f
+    // CHECK: shfl.sync.bfly.b32 {{.*}}, 0x8, 0x1f
+    // CHECK: shfl.sync.bfly.b32 {{.*}}, 0x4, 0x1f
+    // CHECK-NOT: nvvm.barrier0
+    %0 = "tt.reduce"(%arg0) ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %1 = arith.addf %arg1, %arg2 : f32
+      tt.reduce.return %1 : f32
+    }) {axis = 0 : i32} : (tensor<8x16xf32, #blocked>) -> tensor<16xf32, #triton_gpu.slice<{dim = 0, parent = #blocked}>>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 4], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: scan_warp_slow_axis
+  tt.func @scan_warp_slow_axis(%arg0: tensor<16x16xf32, #blocked>) {
+    // The 8 lanes along the columns are 4 lanes apart
+    // CHECK: shfl.sync.up.b32 {{.*}}, 0x4, 0x0
+    // CHECK: shfl.sync.up.b32 {{.*}}, 0x8, 0x0
+    // CHECK: shfl.sync.up.b32 {{.*}}, 0x10, 0x0
+    // The second row of blocks adds the last lane of the first one
+    // CHECK: shfl.sync.idx.b32
+    // CHECK-NOT: nvvm.barrier0
+    %0 = "tt.scan"(%arg0) ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %1 = arith.addf %arg1, %arg2 : f32
+      tt.scan.return %1 : f32
+    }) {axis = 0 : i32} : (tensor<16x16xf32, #blocked>) -> tensor<16x16xf32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#slice = #triton_gpu.slice<{dim = 1, parent = #blocked}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: scan_slice_across_warps
+  tt.func @scan_slice_across_warps(%arg0: tensor<16xf32, #slice>) {
+    // CHECK: shfl.sync.up.b32 {{.*}}, 0x8, 0x0
+    // CHECK: shfl.sync.up.b32 {{.*}}, 0x10, 0x0
+    // CHECK: st.shared
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.load
+    %0 = "tt.scan"(%arg0) ({
+    ^bb0(%arg1: f32, %arg2: f32):
+      %1 = arith.addf %arg1, %arg2 : f32
+      tt.scan.return %1 : f32
+    }) {axis = 0 : i32} : (tensor<16xf32, #slice>) -> tensor<16xf32, #slice>
+    tt.return
+  }
+}
+
+// -----
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK: llvm.mlir.global external @triton_profile_buffer(0 : i64) {addr_space = 1 : i32, alignment = 8 : i64} : i64
+  // CHECK-LABEL: profile_region
+  tt.func @profile_region() {
+    // CHECK: mov.u64 $0, %clock64;
+    // CHECK: llvm.sub
+    // CHECK: red.global.add.u64
+    tt.profile_region "a"
+    // the counters of "b" start at word 2
+    // CHECK: llvm.mlir.constant(2 : i32)
+    // CHECK: mov.u64 $0, %clock64;
+    // CHECK: red.global.add.u64
+    tt.profile_region "b"
+    // CHECK: mov.u64 $0, %clock64;
+    // CHECK: red.global.add.u64
+    // CHECK: red.global.add.u64
+    tt.profile_region "b" {end}
+    tt.profile_region "a" {end}
+    tt.return
+  }
+}
+
+// -----
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: cluster_ops
+  tt.func @cluster_ops(%arg0: !tt.ptr<i32>) {
+    // CHECK: mov.u32 $0, %cluster_ctarank;
+    %0 = tt.get_cluster_cta_rank : i32
+    // CHECK: mov.u32 $0, %cluster_nctarank;
+    %1 = tt.get_cluster_num_ctas : i32
+    // CHECK: barrier.cluster.arrive.release.aligned;
+    // CHECK-SAME: barrier.cluster.wait.acquire.aligned;
+    tt.cluster_barrier
+    %2 = arith.addi %0, %1 : i32
+    tt.store %arg0, %2 {cache = 1 : i32, evict = 1 : i32} : i32
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [4, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 4], order = [0, 1]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The transposition of a blocked tensor keeps its registers
+  // CHECK-LABEL: trans_blocked
+  tt.func @trans_blocked(%arg0: tensor<16x32xf32, #blocked>) -> tensor<32x16xf32, #blocked1> {
+    // CHECK-NOT: llvm.store
+    // CHECK-NOT: barrier
+    // CHECK: llvm.return
+    %0 = tt.trans %arg0 : (tensor<16x32xf32, #blocked>) -> tensor<32x16xf32, #blocked1>
+    tt.return %0 : tensor<32x16xf32, #blocked1>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [2, 2], threadsPerWarp = [4, 8], warpsPerCTA = [1, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // A thread holds 2 rows of 2 columns of the broadcast: the sum of the
+  // broadcasts is computed once per column.
+  // CHECK-LABEL: elementwise_of_broadcasts
+  tt.func @elementwise_of_broadcasts(%arg0: tensor<1x16xf32, #blocked>, %arg1: tensor<1x16xf32, #blocked>) -> tensor<8x16xf32, #blocked> {
+    %0 = tt.broadcast %arg0 : (tensor<1x16xf32, #blocked>) -> tensor<8x16xf32, #blocked>
+    %1 = tt.broadcast %arg1 : (tensor<1x16xf32, #blocked>) -> tensor<8x16xf32, #blocked>
+    // CHECK-COUNT-2: llvm.fadd
+    // CHECK-NOT: llvm.fadd
+    %2 = arith.addf %0, %1 : tensor<8x16xf32, #blocked>
+    tt.return %2 : tensor<8x16xf32, #blocked>
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // Tensors are passed to and returned from device functions in the
+  // registers of their layout, followed by the callee's shared memory base
+  // CHECK: llvm.func @noinline_tensor_fn(%arg0: !llvm.struct<(f32, f32)>, %arg1: !llvm.ptr<i8, 3>) -> !llvm.struct<(f32, f32)>
+  // CHECK-SAME: passthrough = ["noinline"]
+  tt.func private @noinline_tensor_fn(%arg0: tensor<256xf32, #blocked0>) -> tensor<256xf32, #blocked0> attributes {noinline = true} {
+    %0 = arith.addf %arg0, %arg0 : tensor<256xf32, #blocked0>
+    tt.return %0 : tensor<256xf32, #blocked0>
+  }
+
+  // CHECK-LABEL: call_noinline_tensor
+  tt.func @call_noinline_tensor(%arg0: tensor<256xf32, #blocked0>, %arg1: tensor<256x!tt.ptr<f32>, #blocked0>) {
+    // CHECK: llvm.call @noinline_tensor_fn
+    %0 = tt.call @noinline_tensor_fn(%arg0) : (tensor<256xf32, #blocked0>) -> tensor<256xf32, #blocked0>
+    tt.store %arg1, %0 {cache = 1 : i32, evict = 1 : i32} : tensor<256xf32, #blocked0>
+    tt.return
+  }
+}
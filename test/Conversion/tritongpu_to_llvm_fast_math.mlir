@@ -0,0 +1,45 @@
+// RUN: triton-opt %s -split-input-file --convert-triton-gpu-to-llvm=fast-math=true | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: fast_math_f32
+  tt.func @fast_math_f32(%arg0 : tensor<128xf32, #blocked>, %arg1 : tensor<128xf32, #blocked>) {
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: div.approx.ftz.f32
+    %0 = arith.divf %arg0, %arg1 : tensor<128xf32, #blocked>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: sqrt.approx.ftz.f32
+    %1 = math.sqrt %0 : tensor<128xf32, #blocked>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: ex2.approx.ftz.f32
+    %2 = math.exp %1 : tensor<128xf32, #blocked>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: lg2.approx.ftz.f32
+    // CHECK: llvm.fmul
+    %3 = math.log %2 : tensor<128xf32, #blocked>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: sin.approx.ftz.f32
+    %4 = math.sin %3 : tensor<128xf32, #blocked>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: rsqrt.approx.ftz.f32
+    %5 = tt.pure_extern_elementwise %4 {libname = "libdevice", libpath = "", symbol = "__nv_rsqrtf"} : (tensor<128xf32, #blocked>) -> tensor<128xf32, #blocked>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: tanh.approx.f32
+    %6 = tt.pure_extern_elementwise %5 {libname = "libdevice", libpath = "", symbol = "__nv_tanhf"} : (tensor<128xf32, #blocked>) -> tensor<128xf32, #blocked>
+    // CHECK: llvm.call @__nv_erff
+    %7 = tt.pure_extern_elementwise %6 {libname = "libdevice", libpath = "", symbol = "__nv_erff"} : (tensor<128xf32, #blocked>) -> tensor<128xf32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: fast_math_f64
+  tt.func @fast_math_f64(%arg0 : tensor<128xf64, #blocked>) {
+    // CHECK-NOT: approx
+    %0 = math.sqrt %arg0 : tensor<128xf64, #blocked>
+    tt.return
+  }
+}
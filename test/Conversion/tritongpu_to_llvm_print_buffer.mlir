@@ -0,0 +1,35 @@
+// RUN: triton-opt %s -split-input-file --convert-triton-gpu-to-llvm=print-buffer=true | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK: llvm.mlir.global external @triton_print_buffer(dense<0> : tensor<3xi64>) {addr_space = 1 : i32, alignment = 8 : i64} : !llvm.array<3 x i64>
+  // CHECK-LABEL: buffered_print
+  tt.func @buffered_print(%arg0 : tensor<256xf32, #blocked>, %arg1 : i64) {
+    // CHECK-NOT: vprintf
+    // one record of 7 + 32 * (2 + 2) words reserved per warp
+    // CHECK: llvm.mlir.constant(135 : i64)
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: atom.global.add.u64
+    // CHECK: nvvm.shfl.sync idx
+    // CHECK: nvvm.shfl.sync idx
+    // CHECK-COUNT-5: st.global.b32
+    // CHECK-NOT: st.global
+    tt.print ": " : %arg0, %arg1 : tensor<256xf32, #blocked>, i64
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // the second print of the module is identified by 1 << 16
+  // CHECK-LABEL: buffered_print_ids
+  tt.func @buffered_print_ids(%arg0 : tensor<128xi32, #blocked>) {
+    // CHECK: llvm.mlir.constant(39 : i32)
+    tt.print ": " : %arg0 : tensor<128xi32, #blocked>
+    // CHECK: llvm.mlir.constant(65575 : i32)
+    tt.print ": " : %arg0 : tensor<128xi32, #blocked>
+    tt.return
+  }
+}
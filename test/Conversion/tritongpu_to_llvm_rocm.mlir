@@ -0,0 +1,117 @@
+// RUN: triton-opt %s -split-input-file --convert-triton-gpu-to-llvm=is-rocm=true | FileCheck %s
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
+#shared0 = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#mfma0 = #triton_gpu.mfma<{versionMajor = 2, warpsPerCTA = [1, 1]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx = 0, parent = #mfma0}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx = 1, parent = #mfma0}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: convert_dot_mfma
+  tt.func @convert_dot_mfma(%A: tensor<32x16xf16, #blocked0>, %B: tensor<16x32xf16, #blocked0>) {
+    %AA = triton_gpu.convert_layout %A : (tensor<32x16xf16, #blocked0>) -> tensor<32x16xf16, #shared0>
+    %BB = triton_gpu.convert_layout %B : (tensor<16x32xf16, #blocked0>) -> tensor<16x32xf16, #shared0>
+    // CHECK: llvm.load {{.*}}vector<4xf16>
+    %AA_DOT = triton_gpu.convert_layout %AA : (tensor<32x16xf16, #shared0>) -> tensor<32x16xf16, #dot_operand_a>
+    %BB_DOT = triton_gpu.convert_layout %BB : (tensor<16x32xf16, #shared0>) -> tensor<16x32xf16, #dot_operand_b>
+    %cst0 = arith.constant dense<0.000000e+00> : tensor<32x32xf32, #mfma0>
+
+    // CHECK-COUNT-2: rocdl.mfma.f32.32x32x8f16
+    %D = tt.dot %AA_DOT, %BB_DOT, %cst0 {allowTF32 = true} : tensor<32x16xf16, #dot_operand_a> * tensor<16x32xf16, #dot_operand_b> -> tensor<32x32xf32, #mfma0>
+
+    tt.return
+  }
+}
+
+// -----
+
+#mfma0 = #triton_gpu.mfma<{versionMajor = 2, warpsPerCTA = [1, 1]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx = 0, parent = #mfma0, kWidth = 4}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx = 1, parent = #mfma0, kWidth = 4}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // The result of a dot is the operand of the next one through shared memory
+  // CHECK-LABEL: chained_dot_mfma
+  tt.func @chained_dot_mfma(%A: tensor<32x32xf16, #dot_operand_a>, %B: tensor<32x32xf16, #dot_operand_b>) {
+    %cst0 = arith.constant dense<0.000000e+00> : tensor<32x32xf32, #mfma0>
+    // CHECK-COUNT-4: rocdl.mfma.f32.32x32x8f16
+    %C = tt.dot %A, %B, %cst0 {allowTF32 = true} : tensor<32x32xf16, #dot_operand_a> * tensor<32x32xf16, #dot_operand_b> -> tensor<32x32xf32, #mfma0>
+    %P = arith.truncf %C : tensor<32x32xf32, #mfma0> to tensor<32x32xf16, #mfma0>
+    // CHECK: llvm.store
+    // CHECK: llvm.load {{.*}}vector<4xf16>
+    %P_DOT = triton_gpu.convert_layout %P : (tensor<32x32xf16, #mfma0>) -> tensor<32x32xf16, #dot_operand_a>
+    // CHECK-COUNT-4: rocdl.mfma.f32.32x32x8f16
+    %D = tt.dot %P_DOT, %B, %cst0 {allowTF32 = true} : tensor<32x32xf16, #dot_operand_a> * tensor<32x32xf16, #dot_operand_b> -> tensor<32x32xf32, #mfma0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [64], warpsPerCTA = [1], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 1 : i32, "triton_gpu.gfx-major" = 9 : i32} {
+  // CHECK-LABEL: buffer_load
+  tt.func @buffer_load(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: i32 {tt.divisibility = 16 : i32}) {
+    %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<256x!tt.ptr<f32>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xi32, #blocked0>
+    %3 = tt.splat %arg1 : (i32) -> tensor<256xi32, #blocked0>
+    %4 = "triton_gpu.cmpi"(%0, %3) {predicate = 2 : i64} : (tensor<256xi32, #blocked0>, tensor<256xi32, #blocked0>) -> tensor<256xi1, #blocked0>
+    // The offsets are in range: one descriptor, and a 128-bit buffer load
+    // moved out of the buffer when masked off
+    // CHECK: llvm.ptrtoint
+    // CHECK: llvm.mlir.constant(159744 : i32)
+    // CHECK: llvm.insertelement {{.*}} : vector<4xi32>
+    // CHECK: llvm.select {{.*}} : i1, i32
+    // CHECK: rocdl.raw.buffer.load {{.*}} : vector<4xi32>
+    // CHECK-NOT: llvm.inline_asm
+    %5 = tt.load %2, %4 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<256xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [64], warpsPerCTA = [1], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: masked_load
+  tt.func @masked_load(%arg0: tensor<256x!tt.ptr<f32>, #blocked0> {tt.divisibility = 16 : i32, tt.contiguity = 256 : i32}, %arg1: tensor<256xi1, #blocked0> {tt.constancy = 4 : i32}) {
+    // Pointers of unknown base are loaded with masked loads
+    // CHECK-NOT: rocdl.raw.buffer.load
+    // CHECK: llvm.intr.masked.load {{.*}} -> vector<4xf32>
+    %0 = tt.load %arg0, %arg1 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<256xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [1], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 1 : i32, "triton_gpu.gfx-major" = 11 : i32} {
+  // The descriptors of gfx11 have another format
+  // CHECK-LABEL: buffer_load_gfx11
+  tt.func @buffer_load_gfx11(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32, #blocked0>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>, #blocked0>, tensor<128xi32, #blocked0>
+    // CHECK: llvm.mlir.constant(822099968 : i32)
+    // CHECK: rocdl.raw.buffer.load {{.*}} : vector<4xi32>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32, #blocked0>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [64], warpsPerCTA = [1], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // Without a known architecture, there are no buffer loads
+  // CHECK-LABEL: buffer_load_unknown_arch
+  tt.func @buffer_load_unknown_arch(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+    %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<256x!tt.ptr<f32>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xi32, #blocked0>
+    // CHECK-NOT: rocdl.raw.buffer.load
+    // CHECK: llvm.load {{.*}}vector<4xf32>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<256xf32, #blocked0>
+    tt.return
+  }
+}
@@ -0,0 +1,44 @@
+// RUN: triton-opt %s -split-input-file --convert-triton-gpu-to-llvm=compute-capability=89 | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: fp8_upcast
+  tt.func @fp8_upcast(%arg0 : tensor<512xf8E4M3FNUZ, #blocked>, %arg1 : tensor<512xf8E5M2, #blocked>) {
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: cvt.rn.f16x2.e4m3x2
+    %0 = tt.fp_to_fp %arg0 : tensor<512xf8E4M3FNUZ, #blocked> -> tensor<512xf16, #blocked>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: cvt.rn.f16x2.e5m2x2
+    %1 = tt.fp_to_fp %arg1 : tensor<512xf8E5M2, #blocked> -> tensor<512xf16, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: fp8_downcast_saturate
+  tt.func @fp8_downcast_saturate(%arg0 : tensor<512xf16, #blocked>, %arg1 : tensor<512xf32, #blocked>) {
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: cvt.rn.satfinite.e4m3x2.f16x2
+    %0 = tt.fp_to_fp %arg0 {saturate} : tensor<512xf16, #blocked> -> tensor<512xf8E4M3FNUZ, #blocked>
+    // CHECK-NOT: cvt.rn.f16.f32
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: cvt.rn.satfinite.e5m2x2.f32
+    %1 = tt.fp_to_fp %arg1 {saturate} : tensor<512xf32, #blocked> -> tensor<512xf8E5M2, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: fp8_downcast
+  tt.func @fp8_downcast(%arg0 : tensor<512xf16, #blocked>) {
+    // CHECK-NOT: satfinite
+    %0 = tt.fp_to_fp %arg0 : tensor<512xf16, #blocked> -> tensor<512xf8E4M3FNUZ, #blocked>
+    tt.return
+  }
+}
@@ -0,0 +1,34 @@
+// RUN: triton-opt %s -split-input-file --convert-triton-gpu-to-llvm=compute-capability=90 | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: atomic_add_v4_f32
+  tt.func @atomic_add_v4_f32(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1 : tensor<512xf32, #blocked>) {
+    %0 = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<512x!tt.ptr<f32>, #blocked>
+    %2 = tt.addptr %1, %0 : tensor<512x!tt.ptr<f32>, #blocked>, tensor<512xi32, #blocked>
+    %true = arith.constant dense<true> : tensor<512xi1, #blocked>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: red.global.gpu.relaxed.add.v4.f32
+    %3 = "tt.atomic_rmw" (%2, %arg1, %true) {atomic_rmw_op = 5 : i32, sem = 1 : i32} : (tensor<512x!tt.ptr<f32>, #blocked>, tensor<512xf32, #blocked>, tensor<512xi1, #blocked>) -> tensor<512xf32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [8], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: atomic_add_v4_bf16x2
+  tt.func @atomic_add_v4_bf16x2(%arg0: !tt.ptr<bf16> {tt.divisibility = 16 : i32}, %arg1 : tensor<1024xbf16, #blocked>) {
+    %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #blocked>
+    %1 = tt.splat %arg0 : (!tt.ptr<bf16>) -> tensor<1024x!tt.ptr<bf16>, #blocked>
+    %2 = tt.addptr %1, %0 : tensor<1024x!tt.ptr<bf16>, #blocked>, tensor<1024xi32, #blocked>
+    %true = arith.constant dense<true> : tensor<1024xi1, #blocked>
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: atom.global.gpu.relaxed.add.noftz.v4.bf16x2
+    %3 = "tt.atomic_rmw" (%2, %arg1, %true) {atomic_rmw_op = 5 : i32, sem = 1 : i32} : (tensor<1024x!tt.ptr<bf16>, #blocked>, tensor<1024xbf16, #blocked>, tensor<1024xi1, #blocked>) -> tensor<1024xbf16, #blocked>
+    tt.store %2, %3 : tensor<1024xbf16, #blocked>
+    tt.return
+  }
+}
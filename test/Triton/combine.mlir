@@ -215,3 +215,95 @@ tt.func @test_fold_views() -> (tensor<16x8xf32>, tensor<16x128xf32>, tensor<1x1x
 
     tt.return %b, %c, %d : tensor<16x8xf32>, tensor<16x128xf32>, tensor<1x1x128xf32>
 }
+
+// CHECK-LABEL: @test_combine_broadcast_mul_reduce_pattern
+tt.func @test_combine_broadcast_mul_reduce_pattern(%a : tensor<32x16xf16>, %b : tensor<16x64xf16>, %d : tensor<32x64xf32>) -> tensor<32x64xf32> {
+    // CHECK-NOT: tt.reduce
+    // CHECK: %[[res:.*]] = tt.dot %{{.*}}, %{{.*}}, %{{.*}} {allowTF32 = true} : tensor<32x16xf16> * tensor<16x64xf16> -> tensor<32x64xf32>
+    %ea = tt.expand_dims %a {axis = 2 : i32} : (tensor<32x16xf16>) -> tensor<32x16x1xf16>
+    %eb = tt.expand_dims %b {axis = 0 : i32} : (tensor<16x64xf16>) -> tensor<1x16x64xf16>
+    %ba = tt.broadcast %ea : (tensor<32x16x1xf16>) -> tensor<32x16x64xf16>
+    %bb = tt.broadcast %eb : (tensor<1x16x64xf16>) -> tensor<32x16x64xf16>
+    %fa = arith.extf %ba : tensor<32x16x64xf16> to tensor<32x16x64xf32>
+    %fb = arith.extf %bb : tensor<32x16x64xf16> to tensor<32x16x64xf32>
+    %mul = arith.mulf %fb, %fa : tensor<32x16x64xf32>
+    %sum = "tt.reduce" (%mul) ({
+    ^bb0(%arg0: f32, %arg1: f32):
+      %add = arith.addf %arg0, %arg1 : f32
+      tt.reduce.return %add : f32
+    }) {axis = 1 : i32} : (tensor<32x16x64xf32>) -> tensor<32x64xf32>
+    // accumulate form folds into the dot accumulator
+    // CHECK-NOT: arith.addf
+    %acc = arith.addf %d, %sum : tensor<32x64xf32>
+    // CHECK: tt.return %[[res]] : tensor<32x64xf32>
+    tt.return %acc : tensor<32x64xf32>
+}
+
+// CHECK-LABEL: @test_combine_broadcast_mul_reduce_fail_pattern
+tt.func @test_combine_broadcast_mul_reduce_fail_pattern(%a : tensor<32x8xf32>, %b : tensor<8x64xf32>) -> tensor<32x64xf32> {
+    // K = 8 is too small for tt.dot
+    // CHECK-NOT: tt.dot
+    // CHECK: tt.reduce
+    %ea = tt.expand_dims %a {axis = 2 : i32} : (tensor<32x8xf32>) -> tensor<32x8x1xf32>
+    %eb = tt.expand_dims %b {axis = 0 : i32} : (tensor<8x64xf32>) -> tensor<1x8x64xf32>
+    %ba = tt.broadcast %ea : (tensor<32x8x1xf32>) -> tensor<32x8x64xf32>
+    %bb = tt.broadcast %eb : (tensor<1x8x64xf32>) -> tensor<32x8x64xf32>
+    %mul = arith.mulf %ba, %bb : tensor<32x8x64xf32>
+    %sum = "tt.reduce" (%mul) ({
+    ^bb0(%arg0: f32, %arg1: f32):
+      %add = arith.addf %arg0, %arg1 : f32
+      tt.reduce.return %add : f32
+    }) {axis = 1 : i32} : (tensor<32x8x64xf32>) -> tensor<32x64xf32>
+    tt.return %sum : tensor<32x64xf32>
+}
+
+// CHECK-LABEL: @test_combine_sibling_reduces_pattern
+tt.func @test_combine_sibling_reduces_pattern(%x : tensor<32x64xf32>, %y : tensor<32x64xf32>) -> (tensor<32xf32>, tensor<32xf32>) {
+    // CHECK: %[[res:.*]]:2 = "tt.reduce"(%{{.*}}, %{{.*}}) ({
+    // CHECK-NEXT: ^bb0(%[[a0:.*]]: f32, %[[a1:.*]]: f32, %[[b0:.*]]: f32, %[[b1:.*]]: f32):
+    // CHECK-NEXT: %[[max:.*]] = arith.maxf %[[a0]], %[[b0]] : f32
+    // CHECK-NEXT: %[[add:.*]] = arith.addf %[[a1]], %[[b1]] : f32
+    // CHECK-NEXT: tt.reduce.return %[[max]], %[[add]] : f32, f32
+    // CHECK-NEXT: }) {axis = 1 : i32} : (tensor<32x64xf32>, tensor<32x64xf32>) -> (tensor<32xf32>, tensor<32xf32>)
+    // CHECK-NOT: tt.reduce
+    %max = "tt.reduce" (%x) ({
+    ^bb0(%arg0: f32, %arg1: f32):
+      %m = arith.maxf %arg0, %arg1 : f32
+      tt.reduce.return %m : f32
+    }) {axis = 1 : i32} : (tensor<32x64xf32>) -> tensor<32xf32>
+    %sq = arith.mulf %y, %y : tensor<32x64xf32>
+    %sum = "tt.reduce" (%sq) ({
+    ^bb0(%arg0: f32, %arg1: f32):
+      %add = arith.addf %arg0, %arg1 : f32
+      tt.reduce.return %add : f32
+    }) {axis = 1 : i32} : (tensor<32x64xf32>) -> tensor<32xf32>
+    // CHECK: tt.return %[[res]]#0, %[[res]]#1
+    tt.return %max, %sum : tensor<32xf32>, tensor<32xf32>
+}
+
+// CHECK-LABEL: @test_combine_sibling_reduces_fail_pattern
+tt.func @test_combine_sibling_reduces_fail_pattern(%x : tensor<32x64xf32>) -> (tensor<32xf32>, tensor<64xf32>) {
+    // the second reduction depends on the first one
+    // CHECK: "tt.reduce"(%{{.*}}) ({
+    // CHECK: "tt.reduce"(%{{.*}}) ({
+    %max = "tt.reduce" (%x) ({
+    ^bb0(%arg0: f32, %arg1: f32):
+      %m = arith.maxf %arg0, %arg1 : f32
+      tt.reduce.return %m : f32
+    }) {axis = 1 : i32} : (tensor<32x64xf32>) -> tensor<32xf32>
+    %e = tt.expand_dims %max {axis = 1 : i32} : (tensor<32xf32>) -> tensor<32x1xf32>
+    %b = tt.broadcast %e : (tensor<32x1xf32>) -> tensor<32x64xf32>
+    %d = arith.subf %x, %b : tensor<32x64xf32>
+    %sum = "tt.reduce" (%d) ({
+    ^bb0(%arg0: f32, %arg1: f32):
+      %add = arith.addf %arg0, %arg1 : f32
+      tt.reduce.return %add : f32
+    }) {axis = 1 : i32} : (tensor<32x64xf32>) -> tensor<32xf32>
+    // different axis
+    %sum0 = "tt.reduce" (%x) ({
+    ^bb0(%arg0: f32, %arg1: f32):
+      %add = arith.addf %arg0, %arg1 : f32
+      tt.reduce.return %add : f32
+    }) {axis = 0 : i32} : (tensor<32x64xf32>) -> tensor<64xf32>
+    tt.return %sum, %sum0 : tensor<32xf32>, tensor<64xf32>
+}
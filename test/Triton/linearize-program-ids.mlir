@@ -0,0 +1,50 @@
+// RUN: triton-opt %s -split-input-file -triton-linearize-program-ids | FileCheck %s
+
+// CHECK-LABEL: @linearize_3d
+// CHECK-SAME: (%arg0: !tt.ptr<i32>, %[[NUM_X:.*]]: i32, %[[NUM_Y:.*]]: i32, %[[NUM_Z:.*]]: i32)
+// CHECK: %[[PID:.*]] = tt.get_program_id x : i32
+// CHECK: %[[ROWS:.*]] = arith.divsi %[[PID]], %[[NUM_X]] : i32
+// CHECK: %[[X:.*]] = arith.remsi %[[PID]], %[[NUM_X]] : i32
+// CHECK: %[[Y:.*]] = arith.remsi %[[ROWS]], %[[NUM_Y]] : i32
+// CHECK: %[[Z:.*]] = arith.divsi %[[ROWS]], %[[NUM_Y]] : i32
+// CHECK-NOT: tt.get_program_id
+// CHECK-NOT: tt.get_num_programs
+// CHECK: tt.return %[[X]], %[[Y]], %[[Z]], %[[NUM_Y]] : i32, i32, i32, i32
+tt.func public @linearize_3d(%arg0: !tt.ptr<i32>) -> (i32, i32, i32, i32) {
+  %0 = tt.get_program_id x : i32
+  %1 = tt.get_program_id y : i32
+  %2 = tt.get_program_id z : i32
+  %3 = tt.get_num_programs {axis = 1 : i32} : i32
+  tt.return %0, %1, %2, %3 : i32, i32, i32, i32
+}
+
+// -----
+
+// The grid goes before the tensor maps of the kernel
+module attributes {tt.tensor_maps = [{base = 0 : i32}]} {
+  // CHECK-LABEL: @before_tensor_maps
+  // CHECK-SAME: (%arg0: !tt.ptr<f16>, %arg1: i32, %arg2: i32, %arg3: i32, %arg4: !tt.ptr<i8, 1>)
+  tt.func public @before_tensor_maps(%arg0: !tt.ptr<f16>, %arg1: !tt.ptr<i8, 1>) {
+    tt.return
+  }
+}
+
+// -----
+
+// Calls pass the grid of their caller on
+// CHECK-LABEL: @callee
+// CHECK-SAME: (%arg0: i32, %[[NUM_X:.*]]: i32, %{{.*}}: i32, %{{.*}}: i32)
+// CHECK: arith.remsi %{{.*}}, %[[NUM_X]] : i32
+tt.func private @callee(%arg0: i32) -> i32 {
+  %0 = tt.get_program_id x : i32
+  %1 = arith.addi %0, %arg0 : i32
+  tt.return %1 : i32
+}
+
+// CHECK-LABEL: @caller
+// CHECK-SAME: (%arg0: i32, %[[NUM_X:.*]]: i32, %[[NUM_Y:.*]]: i32, %[[NUM_Z:.*]]: i32)
+// CHECK: tt.call @callee(%arg0, %[[NUM_X]], %[[NUM_Y]], %[[NUM_Z]]) : (i32, i32, i32, i32) -> i32
+tt.func public @caller(%arg0: i32) -> i32 {
+  %0 = tt.call @callee(%arg0) : (i32) -> i32
+  tt.return %0 : i32
+}
@@ -0,0 +1,45 @@
+// RUN: triton-opt %s -split-input-file -triton-narrow-offsets | FileCheck %s
+// RUN: triton-opt %s -split-input-file -triton-narrow-offsets=assume-small-tensors=true | FileCheck %s --check-prefix=SMALL
+
+// CHECK-NOT: tt.small_tensors
+// SMALL: module attributes {tt.small_tensors}
+// CHECK-LABEL: @offset_in_range
+tt.func @offset_in_range(%arg0: !tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>> {
+  // CHECK: %[[range:.*]] = tt.make_range
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  // CHECK-NOT: arith.extsi
+  %1 = arith.extsi %0 : tensor<128xi32> to tensor<128xi64>
+  // CHECK: %[[c4:.*]] = arith.constant dense<4> : tensor<128xi32>
+  %c4 = arith.constant dense<4> : tensor<128xi64>
+  // CHECK: %[[offset:.*]] = arith.muli %[[range]], %[[c4]] : tensor<128xi32>
+  %2 = arith.muli %1, %c4 : tensor<128xi64>
+  %3 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+  // CHECK: tt.addptr %{{.*}}, %[[offset]] : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  %4 = tt.addptr %3, %2 : tensor<128x!tt.ptr<f32>>, tensor<128xi64>
+  tt.return %4 : tensor<128x!tt.ptr<f32>>
+}
+
+// -----
+
+// CHECK-LABEL: @runtime_stride
+// SMALL-LABEL: @runtime_stride
+tt.func @runtime_stride(%arg0: !tt.ptr<f32>, %arg1: i64) -> tensor<128x!tt.ptr<f32>> {
+  // SMALL: %[[stride:.*]] = arith.trunci %arg1 : i64 to i32
+  // SMALL: %[[pid:.*]] = tt.get_program_id x : i32
+  %pid = tt.get_program_id x : i32
+  %0 = arith.extsi %pid : i32 to i64
+  // CHECK: arith.muli %{{.*}}, %arg1 : i64
+  // SMALL: %[[row:.*]] = arith.muli %[[pid]], %[[stride]] : i32
+  %1 = arith.muli %0, %arg1 : i64
+  %2 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  %3 = arith.extsi %2 : tensor<128xi32> to tensor<128xi64>
+  // SMALL: %[[splat:.*]] = tt.splat %[[row]] : (i32) -> tensor<128xi32>
+  %4 = tt.splat %1 : (i64) -> tensor<128xi64>
+  // SMALL: %[[offset:.*]] = arith.addi %[[splat]], %{{.*}} : tensor<128xi32>
+  %5 = arith.addi %4, %3 : tensor<128xi64>
+  %6 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>>
+  // CHECK: tt.addptr %{{.*}}, %{{.*}} : tensor<128x!tt.ptr<f32>>, tensor<128xi64>
+  // SMALL: tt.addptr %{{.*}}, %[[offset]] : tensor<128x!tt.ptr<f32>>, tensor<128xi32>
+  %7 = tt.addptr %6, %5 : tensor<128x!tt.ptr<f32>>, tensor<128xi64>
+  tt.return %7 : tensor<128x!tt.ptr<f32>>
+}
@@ -0,0 +1,51 @@
+// RUN: triton-opt %s -split-input-file -triton-rewrite-tensor-pointer="compute-capability=90 enable-tma=true" | FileCheck %s
+
+// CHECK: module attributes {tt.tensor_maps = [{base = 0 : i32, box = array<i64: 64, 128>, dim_args = array<i32: 2, 1>, dims = array<i64: 0, 0>, elem_bytes = 2 : i32, stride_args = array<i32: 3>, strides = array<i64: 0>}]}
+// CHECK-LABEL: tt.func public @tma_load
+// CHECK-SAME: %[[DESC:arg[0-9]+]]: !tt.ptr<i8>)
+tt.func public @tma_load(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1: i32, %arg2: i32, %arg3: i32 {tt.divisibility = 16 : i32}, %arg4: i32) -> tensor<128x64xf16> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c0_i32 = arith.constant 0 : i32
+  %c64_i32 = arith.constant 64 : i32
+  %c1_i64 = arith.constant 1 : i64
+  %cst = arith.constant dense<0.000000e+00> : tensor<128x64xf16>
+  %0 = arith.extsi %arg1 : i32 to i64
+  %1 = arith.extsi %arg2 : i32 to i64
+  %2 = arith.extsi %arg3 : i32 to i64
+  %3 = arith.index_cast %arg4 : i32 to index
+  // CHECK-NOT: tt.make_tensor_ptr
+  %4 = tt.make_tensor_ptr %arg0, [%0, %1], [%2, %c1_i64], [%c0_i32, %c0_i32] {order = array<i32: 1, 0>} : !tt.ptr<tensor<128x64xf16>>
+  %5:2 = scf.for %arg5 = %c0 to %3 step %c1 iter_args(%arg6 = %cst, %arg7 = %4) -> (tensor<128x64xf16>, !tt.ptr<tensor<128x64xf16>>) {
+    // CHECK: tt.tma_load %[[DESC]], [%{{.*}}, %{{.*}}] {order = array<i32: 1, 0>} : !tt.ptr<i8> -> tensor<128x64xf16>
+    %7 = tt.load %arg7 {boundaryCheck = array<i32: 0, 1>, cache = 1 : i32, evict = 1 : i32, isVolatile = false, padding = 1 : i32} : !tt.ptr<tensor<128x64xf16>> -> tensor<128x64xf16>
+    %8 = arith.addf %arg6, %7 : tensor<128x64xf16>
+    // CHECK-NOT: tt.advance
+    %9 = tt.advance %arg7, [%c0_i32, %c64_i32] : !tt.ptr<tensor<128x64xf16>>
+    scf.yield %8, %9 : tensor<128x64xf16>, !tt.ptr<tensor<128x64xf16>>
+  }
+  // Blocks of the same tensor share their tensor map
+  // CHECK: tt.tma_load %[[DESC]]
+  %6 = tt.load %4 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : !tt.ptr<tensor<128x64xf16>> -> tensor<128x64xf16>
+  %10 = arith.addf %5#0, %6 : tensor<128x64xf16>
+  tt.return %10 : tensor<128x64xf16>
+}
+
+// -----
+
+// The rows of the tensor are not contiguous
+// CHECK-NOT: tt.tensor_maps
+// CHECK-LABEL: tt.func public @strided_load
+// CHECK-NOT: !tt.ptr<i8>
+// CHECK-NOT: tt.tma_load
+// CHECK: tt.load
+tt.func public @strided_load(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1: i32, %arg2: i32, %arg3: i32 {tt.divisibility = 16 : i32}, %arg4: i32) -> tensor<128x64xf16> {
+  %c0_i32 = arith.constant 0 : i32
+  %0 = arith.extsi %arg1 : i32 to i64
+  %1 = arith.extsi %arg2 : i32 to i64
+  %2 = arith.extsi %arg3 : i32 to i64
+  %3 = arith.extsi %arg4 : i32 to i64
+  %4 = tt.make_tensor_ptr %arg0, [%0, %1], [%2, %3], [%c0_i32, %c0_i32] {order = array<i32: 1, 0>} : !tt.ptr<tensor<128x64xf16>>
+  %5 = tt.load %4 {boundaryCheck = array<i32: 0, 1>, cache = 1 : i32, evict = 1 : i32, isVolatile = false, padding = 1 : i32} : !tt.ptr<tensor<128x64xf16>> -> tensor<128x64xf16>
+  tt.return %5 : tensor<128x64xf16>
+}
@@ -81,3 +81,21 @@ tt.func public @matmul_kernel(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32},
   tt.store %45, %30, %54 {cache = 1 : i32, evict = 1 : i32} : tensor<128x32xf16>
   tt.return
 }
+
+// CHECK-LABEL: @block_load
+tt.func public @block_load(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1: i32, %arg2: i32, %arg3: i32 {tt.divisibility = 16 : i32}) -> tensor<64x64xf16> {
+  %c0_i32 = arith.constant 0 : i32
+  %c1_i64 = arith.constant 1 : i64
+  %c64_i32 = arith.constant 64 : i32
+  %0 = tt.get_program_id x : i32
+  %1 = arith.muli %0, %c64_i32 : i32
+  %2 = arith.extsi %arg1 : i32 to i64
+  %3 = arith.extsi %arg2 : i32 to i64
+  %4 = arith.extsi %arg3 : i32 to i64
+  // CHECK-NOT: tt.make_tensor_ptr
+  %5 = tt.make_tensor_ptr %arg0, [%2, %3], [%4, %c1_i64], [%1, %c0_i32] {order = array<i32: 1, 0>} : !tt.ptr<tensor<64x64xf16>>
+  // CHECK: tt.block_load %arg0, [%{{.*}}, %{{.*}}], [%{{.*}}, %{{.*}}], [%{{.*}}, %{{.*}}] {boundaryCheck = array<i32: 0>, {{.*}}order = array<i32: 1, 0>{{.*}}} : !tt.ptr<f16> -> tensor<64x64xf16>
+  // CHECK-NOT: tt.load
+  %6 = tt.load %5 {boundaryCheck = array<i32: 0>, cache = 1 : i32, evict = 1 : i32, isVolatile = false, padding = 1 : i32} : !tt.ptr<tensor<64x64xf16>> -> tensor<64x64xf16>
+  tt.return %6 : tensor<64x64xf16>
+}
@@ -0,0 +1,36 @@
+// RUN: triton-opt %s -split-input-file -triton-swizzle-program-ids=group-size=4 | FileCheck %s
+
+// CHECK-LABEL: @swizzle_2d
+// CHECK-DAG: %[[X:.*]] = tt.get_program_id x : i32
+// CHECK-DAG: %[[Y:.*]] = tt.get_program_id y : i32
+// CHECK-DAG: %[[NUM_X:.*]] = tt.get_num_programs {axis = 0 : i32} : i32
+// CHECK-DAG: %[[NUM_Y:.*]] = tt.get_num_programs {axis = 1 : i32} : i32
+// CHECK-DAG: %[[SIZE:.*]] = arith.constant 4 : i32
+// CHECK: %[[ROW:.*]] = arith.muli %[[Y]], %[[NUM_X]] : i32
+// CHECK: %[[PID:.*]] = arith.addi %[[ROW]], %[[X]] : i32
+// CHECK: %[[GROUP_PROGRAMS:.*]] = arith.muli %[[SIZE]], %[[NUM_Y]] : i32
+// CHECK: %[[GROUP:.*]] = arith.divsi %[[PID]], %[[GROUP_PROGRAMS]] : i32
+// CHECK: %[[FIRST_X:.*]] = arith.muli %[[GROUP]], %[[SIZE]] : i32
+// CHECK: %[[LEFT_X:.*]] = arith.subi %[[NUM_X]], %[[FIRST_X]] : i32
+// CHECK: %[[GROUP_X:.*]] = arith.minsi %[[LEFT_X]], %[[SIZE]] : i32
+// CHECK: %[[IN_GROUP:.*]] = arith.remsi %[[PID]], %[[GROUP_PROGRAMS]] : i32
+// CHECK: %[[REM:.*]] = arith.remsi %[[IN_GROUP]], %[[GROUP_X]] : i32
+// CHECK: %[[NEW_X:.*]] = arith.addi %[[FIRST_X]], %[[REM]] : i32
+// CHECK: %[[NEW_Y:.*]] = arith.divsi %[[IN_GROUP]], %[[GROUP_X]] : i32
+// CHECK: %[[Z:.*]] = tt.get_program_id z : i32
+// CHECK: tt.return %[[NEW_X]], %[[NEW_Y]], %[[Z]] : i32, i32, i32
+tt.func @swizzle_2d() -> (i32, i32, i32) {
+  %0 = tt.get_program_id x : i32
+  %1 = tt.get_program_id y : i32
+  %2 = tt.get_program_id z : i32
+  tt.return %0, %1, %2 : i32, i32, i32
+}
+
+// -----
+
+// Functions without program ids are left alone
+// CHECK-LABEL: @no_pids
+// CHECK-NOT: tt.get_num_programs
+tt.func @no_pids(%arg0: i32) -> i32 {
+  tt.return %arg0 : i32
+}
@@ -0,0 +1,34 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-accelerate-matmul="compute-capability=0 mfma-version=2" | FileCheck %s
+
+// CHECK: #[[MFMA:.+]] = #triton_gpu.mfma<{versionMajor = 2, warpsPerCTA = [2, 2]}>
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [4, 1], order = [1, 0]}>
+#dot_a = #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>
+#dot_b = #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: mfma_dot
+  tt.func @mfma_dot(%a: tensor<128x32xf16, #dot_a>, %b: tensor<32x128xf16, #dot_b>) -> tensor<128x128xf32, #blocked> {
+    %cst = arith.constant dense<0.000000e+00> : tensor<128x128xf32, #blocked>
+    // CHECK: triton_gpu.convert_layout {{.*}} -> tensor<128x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #[[MFMA]], kWidth = 4}>>
+    // CHECK: triton_gpu.convert_layout {{.*}} -> tensor<32x128xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #[[MFMA]], kWidth = 4}>>
+    // CHECK: tt.dot {{.*}} -> tensor<128x128xf32, #[[MFMA]]>
+    %d = tt.dot %a, %b, %cst {allowTF32 = true} : tensor<128x32xf16, #dot_a> * tensor<32x128xf16, #dot_b> -> tensor<128x128xf32, #blocked>
+    tt.return %d : tensor<128x128xf32, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [4, 1], order = [1, 0]}>
+#dot_a = #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>
+#dot_b = #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The result tiles are smaller than those of the instructions
+  // CHECK-LABEL: fma_dot
+  tt.func @fma_dot(%a: tensor<16x32xf16, #dot_a>, %b: tensor<32x16xf16, #dot_b>) -> tensor<16x16xf32, #blocked> {
+    %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf32, #blocked>
+    // CHECK-NOT: mfma
+    // CHECK: tt.dot {{.*}} -> tensor<16x16xf32, #blocked>
+    %d = tt.dot %a, %b, %cst {allowTF32 = true} : tensor<16x32xf16, #dot_a> * tensor<32x16xf16, #dot_b> -> tensor<16x16xf32, #blocked>
+    tt.return %d : tensor<16x16xf32, #blocked>
+  }
+}
@@ -0,0 +1,130 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-accelerate-matmul=compute-capability=80 | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-accelerate-matmul="compute-capability=89 ptx-version=84" | FileCheck %s --check-prefix=SM89
+// RUN: triton-opt %s -split-input-file -tritongpu-accelerate-matmul="compute-capability=89 ptx-version=81" | FileCheck %s --check-prefix=PTX81
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [2, 16], warpsPerCTA = [4, 1], order = [1, 0]}>
+#dot_a = #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>
+#dot_b = #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: skinny_dot
+  tt.func @skinny_dot(%a: tensor<16x16xf16, #blocked>, %b: tensor<16x16xf16, #blocked>) -> tensor<16x16xf32, #blocked> {
+    %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf32, #blocked>
+    %a_dot = triton_gpu.convert_layout %a : (tensor<16x16xf16, #blocked>) -> tensor<16x16xf16, #dot_a>
+    %b_dot = triton_gpu.convert_layout %b : (tensor<16x16xf16, #blocked>) -> tensor<16x16xf16, #dot_b>
+    // CHECK-NOT: tt.dot
+    // CHECK: arith.extf
+    // CHECK: arith.mulf {{.*}} : tensor<16x16x16xf32
+    // CHECK: tt.reduce
+    // CHECK: axis = 1
+    // CHECK: arith.addf
+    %d = tt.dot %a_dot, %b_dot, %cst {allowTF32 = true} : tensor<16x16xf16, #dot_a> * tensor<16x16xf16, #dot_b> -> tensor<16x16xf32, #blocked>
+    tt.return %d : tensor<16x16xf32, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [2, 16], warpsPerCTA = [4, 1], order = [1, 0]}>
+#dot_a = #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>
+#dot_b = #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: skinny_dot_large_k
+  tt.func @skinny_dot_large_k(%a: tensor<16x128xf16, #blocked>, %b: tensor<128x64xf16, #blocked>) -> tensor<16x64xf32, #blocked> {
+    %cst = arith.constant dense<0.000000e+00> : tensor<16x64xf32, #blocked>
+    %a_dot = triton_gpu.convert_layout %a : (tensor<16x128xf16, #blocked>) -> tensor<16x128xf16, #dot_a>
+    %b_dot = triton_gpu.convert_layout %b : (tensor<128x64xf16, #blocked>) -> tensor<128x64xf16, #dot_b>
+    // CHECK-NOT: tt.reduce
+    // CHECK: tt.dot {{.*}} -> tensor<16x64xf32, #mma>
+    %d = tt.dot %a_dot, %b_dot, %cst {allowTF32 = true} : tensor<16x128xf16, #dot_a> * tensor<128x64xf16, #dot_b> -> tensor<16x64xf32, #blocked>
+    tt.return %d : tensor<16x64xf32, #blocked>
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#dot_a = #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>
+#dot_b = #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: fp8_dot
+  // SM89-LABEL: fp8_dot
+  // PTX81-LABEL: fp8_dot
+  tt.func @fp8_dot(%a: tensor<64x64xf8E4M3FNUZ, #blocked>, %b: tensor<64x64xf8E5M2, #blocked>) -> tensor<64x64xf32, #blocked> {
+    %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #blocked>
+    %a_dot = triton_gpu.convert_layout %a : (tensor<64x64xf8E4M3FNUZ, #blocked>) -> tensor<64x64xf8E4M3FNUZ, #dot_a>
+    %b_dot = triton_gpu.convert_layout %b : (tensor<64x64xf8E5M2, #blocked>) -> tensor<64x64xf8E5M2, #dot_b>
+    // fp8 tensor cores need sm_89 and PTX ISA 8.4
+    // CHECK: tt.dot {{.*}} -> tensor<64x64xf32, #blocked>
+    // PTX81: tt.dot {{.*}} -> tensor<64x64xf32, #blocked>
+    // SM89: triton_gpu.convert_layout {{.*}} -> tensor<64x64xf8E4M3FNUZ, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 4}>>
+    // SM89: triton_gpu.convert_layout {{.*}} -> tensor<64x64xf8E5M2, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 4}>>
+    // SM89: tt.dot {{.*}} -> tensor<64x64xf32, #mma>
+    %d = tt.dot %a_dot, %b_dot, %cst {allowTF32 = true} : tensor<64x64xf8E4M3FNUZ, #dot_a> * tensor<64x64xf8E5M2, #dot_b> -> tensor<64x64xf32, #blocked>
+    tt.return %d : tensor<64x64xf32, #blocked>
+  }
+}
+
+// -----
+
+// The result of the first dot is the A operand of the second one: both put
+// their warps along M, so that it converts in registers
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#dot_a = #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>
+#dot_b = #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>
+// CHECK: #mma = #triton_gpu.mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [4, 1]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: chained_dot_a
+  tt.func @chained_dot_a(%q: tensor<64x64xf16, #dot_a>, %k: tensor<64x64xf16, #dot_b>, %v: tensor<64x64xf16, #dot_b>) -> tensor<64x64xf32, #blocked> {
+    %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #blocked>
+    // CHECK: tt.dot {{.*}} -> tensor<64x64xf32, #mma>
+    %qk = tt.dot %q, %k, %cst {allowTF32 = true} : tensor<64x64xf16, #dot_a> * tensor<64x64xf16, #dot_b> -> tensor<64x64xf32, #blocked>
+    %p = arith.truncf %qk : tensor<64x64xf32, #blocked> to tensor<64x64xf16, #blocked>
+    %p_dot = triton_gpu.convert_layout %p : (tensor<64x64xf16, #blocked>) -> tensor<64x64xf16, #dot_a>
+    // CHECK: tt.dot {{.*}} -> tensor<64x64xf32, #mma>
+    %o = tt.dot %p_dot, %v, %cst {allowTF32 = true} : tensor<64x64xf16, #dot_a> * tensor<64x64xf16, #dot_b> -> tensor<64x64xf32, #blocked>
+    tt.return %o : tensor<64x64xf32, #blocked>
+  }
+}
+
+// -----
+
+// The result of the first dot is the B operand of the second one, which
+// converts through shared memory whatever the tiling: both keep the tiling
+// loading the fewest operand bytes
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#dot_a = #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>
+#dot_b = #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>
+// CHECK: #mma = #triton_gpu.mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [2, 2]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: chained_dot_b
+  tt.func @chained_dot_b(%q: tensor<64x64xf16, #dot_a>, %k: tensor<64x64xf16, #dot_b>, %v: tensor<64x64xf16, #dot_a>) -> tensor<64x64xf32, #blocked> {
+    %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #blocked>
+    // CHECK: tt.dot {{.*}} -> tensor<64x64xf32, #mma>
+    %qk = tt.dot %q, %k, %cst {allowTF32 = true} : tensor<64x64xf16, #dot_a> * tensor<64x64xf16, #dot_b> -> tensor<64x64xf32, #blocked>
+    %p = arith.truncf %qk : tensor<64x64xf32, #blocked> to tensor<64x64xf16, #blocked>
+    %p_dot = triton_gpu.convert_layout %p : (tensor<64x64xf16, #blocked>) -> tensor<64x64xf16, #dot_b>
+    // CHECK: tt.dot {{.*}} -> tensor<64x64xf32, #mma>
+    %o = tt.dot %v, %p_dot, %cst {allowTF32 = true} : tensor<64x64xf16, #dot_a> * tensor<64x64xf16, #dot_b> -> tensor<64x64xf32, #blocked>
+    tt.return %o : tensor<64x64xf32, #blocked>
+  }
+}
+
+// -----
+
+// Warps go along the long side of non-square tiles
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#dot_a = #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>
+#dot_b = #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>
+// CHECK: #mma = #triton_gpu.mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [1, 4]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: wide_dot
+  tt.func @wide_dot(%a: tensor<32x64xf16, #dot_a>, %b: tensor<64x256xf16, #dot_b>) -> tensor<32x256xf32, #blocked> {
+    %cst = arith.constant dense<0.000000e+00> : tensor<32x256xf32, #blocked>
+    // CHECK: tt.dot {{.*}} -> tensor<32x256xf32, #mma>
+    %d = tt.dot %a, %b, %cst {allowTF32 = true} : tensor<32x64xf16, #dot_a> * tensor<64x256xf16, #dot_b> -> tensor<32x256xf32, #blocked>
+    tt.return %d : tensor<32x256xf32, #blocked>
+  }
+}
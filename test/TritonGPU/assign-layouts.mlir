@@ -0,0 +1,63 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-assign-layouts | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#dotA = #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 2}>
+#dotB = #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 2}>
+
+// The accumulator is carried in the layout of the dot, and converted once
+// after the loop rather than twice per iteration
+// CHECK-LABEL: tt.func @loop_carried
+// CHECK: %[[CST:.*]] = arith.constant dense<0.000000e+00> : tensor<128x128xf32, #mma>
+// CHECK: %[[RES:.*]] = scf.for {{.*}} iter_args(%[[ACC:.*]] = %[[CST]]) -> (tensor<128x128xf32, #mma>)
+// CHECK-NOT: triton_gpu.convert_layout
+// CHECK:   %[[D:.*]] = tt.dot {{.*}}, {{.*}}, %[[ACC]]
+// CHECK-NEXT: scf.yield %[[D]]
+// CHECK: %[[CVT:.*]] = triton_gpu.convert_layout %[[RES]] : (tensor<128x128xf32, #mma>) -> tensor<128x128xf32, #blocked>
+// CHECK: tt.store %{{.*}}, %[[CVT]]
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+tt.func @loop_carried(%a: tensor<128x32xf16, #dotA>, %b: tensor<32x128xf16, #dotB>,
+                      %ptr: tensor<128x128x!tt.ptr<f32>, #blocked>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c16 = arith.constant 16 : index
+  %cst = arith.constant dense<0.000000e+00> : tensor<128x128xf32, #blocked>
+  %res = scf.for %iv = %c0 to %c16 step %c1 iter_args(%acc = %cst) -> (tensor<128x128xf32, #blocked>) {
+    %acc_mma = triton_gpu.convert_layout %acc : (tensor<128x128xf32, #blocked>) -> tensor<128x128xf32, #mma>
+    %d = tt.dot %a, %b, %acc_mma {allowTF32 = true} : tensor<128x32xf16, #dotA> * tensor<32x128xf16, #dotB> -> tensor<128x128xf32, #mma>
+    %d_blocked = triton_gpu.convert_layout %d : (tensor<128x128xf32, #mma>) -> tensor<128x128xf32, #blocked>
+    scf.yield %d_blocked : tensor<128x128xf32, #blocked>
+  }
+  tt.store %ptr, %res : tensor<128x128xf32, #blocked>
+  tt.return
+}
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+
+// The sum keeps the layout of its loads, and is converted after the loop
+// CHECK-LABEL: tt.func @conversion_after_loop
+// CHECK: scf.for {{.*}} -> (tensor<128x128xf32, #blocked>)
+// CHECK-NOT: triton_gpu.convert_layout
+// CHECK: scf.yield
+// CHECK: triton_gpu.convert_layout %{{.*}} : (tensor<128x128xf32, #blocked>) -> tensor<128x128xf32, #mma>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+tt.func @conversion_after_loop(%x_ptr: tensor<128x128x!tt.ptr<f32>, #blocked>,
+                               %y_ptr: tensor<128x128x!tt.ptr<f32>, #mma>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c16 = arith.constant 16 : index
+  %cst = arith.constant dense<0.000000e+00> : tensor<128x128xf32, #blocked>
+  %res = scf.for %iv = %c0 to %c16 step %c1 iter_args(%acc = %cst) -> (tensor<128x128xf32, #blocked>) {
+    %x = tt.load %x_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x128xf32, #blocked>
+    %sum = arith.addf %acc, %x : tensor<128x128xf32, #blocked>
+    scf.yield %sum : tensor<128x128xf32, #blocked>
+  }
+  %res_mma = triton_gpu.convert_layout %res : (tensor<128x128xf32, #blocked>) -> tensor<128x128xf32, #mma>
+  tt.store %y_ptr, %res_mma : tensor<128x128xf32, #mma>
+  tt.return
+}
+}
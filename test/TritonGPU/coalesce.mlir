@@ -51,3 +51,46 @@ tt.func @transpose(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32},
 }
 
 }
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [32, 1], warpsPerCTA = [4, 1], order = [0, 1]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// Block loads are vectorized along their unit-stride dimension
+// CHECK: [[COALESCED:#.*]] = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+// CHECK-LABEL: block_load
+// CHECK: tt.block_load {{.*}} -> tensor<64x64xf16, [[COALESCED]]>
+tt.func @block_load(%base: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %m: i64, %n: i64, %stride: i64 {tt.divisibility = 16 : i32}, %x: i64) -> tensor<64x64xf16, #blocked0> {
+  %c0 = arith.constant 0 : i64
+  %c1 = arith.constant 1 : i64
+  %0 = tt.block_load %base, [%m, %n], [%stride, %c1], [%x, %c0] {boundaryCheck = array<i32: 0>, cache = 1 : i32, evict = 1 : i32, isVolatile = false, order = array<i32: 1, 0>, padding = 1 : i32} : !tt.ptr<f16> -> tensor<64x64xf16, #blocked0>
+  tt.return %0 : tensor<64x64xf16, #blocked0>
+}
+
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// Atomics to a single address are reduced over the block first
+// CHECK-LABEL: uniform_atomic_add
+// CHECK: %[[PTRS:.*]] = tt.ptr_to_int {{.*}} -> tensor<256xi64
+// CHECK: %[[VALS:.*]] = arith.select %{{.*}}, %{{.*}}, %{{.*}} : tensor<256xi1
+// CHECK: %[[MASKS:.*]] = arith.extui %{{.*}} : tensor<256xi1, #{{.*}}> to tensor<256xi32
+// CHECK: %[[RED:.*]]:3 = "tt.reduce"(%[[VALS]], %[[PTRS]], %[[MASKS]])
+// CHECK: arith.addf
+// CHECK: arith.maxui
+// CHECK: %[[PTR:.*]] = tt.int_to_ptr %[[RED]]#1 : i64 -> !tt.ptr<f32>
+// CHECK: %[[MASK:.*]] = arith.cmpi ne, %[[RED]]#2
+// CHECK: "tt.atomic_rmw"(%[[PTR]], %[[RED]]#0, %[[MASK]]) {{.*}} : (!tt.ptr<f32>, f32, i1) -> f32
+// CHECK-NOT: tt.atomic_rmw
+tt.func @uniform_atomic_add(%arg0: !tt.ptr<f32>, %arg1: tensor<256xf32, #blocked0>, %arg2: tensor<256xi1, #blocked0>) {
+  %0 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<256x!tt.ptr<f32>, #blocked0>
+  %1 = "tt.atomic_rmw"(%0, %arg1, %arg2) {atomic_rmw_op = 5 : i32, sem = 1 : i32} : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf32, #blocked0>
+  tt.return
+}
+
+}
@@ -1499,3 +1499,53 @@ module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-war
     tt.return
   }
 }
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+#blocked2 = #triton_gpu.blocked<{sizePerThread = [4, 4], threadsPerWarp = [4, 8], warpsPerCTA = [1, 4], order = [1, 0]}>
+#blocked3 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+#blocked4 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [2, 16], warpsPerCTA = [4, 1], order = [1, 0]}>
+// CHECK-DAG: [[$VIEW_SRC:#.*]] = #triton_gpu.blocked<{sizePerThread = [8], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+// CHECK-DAG: [[$VIEW_DST:#.*]] = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  // Each thread holds 8 distinct elements of the tensor in both layouts: the
+  // view renames registers into the layout of the conversion.
+  // CHECK-LABEL: view_renames_registers
+  // CHECK-NOT: triton_gpu.convert_layout
+  // CHECK: tt.view %{{.*}} -> tensor<32x32xf32, [[$VIEW_DST]]>
+  // CHECK-NOT: triton_gpu.convert_layout
+  tt.func @view_renames_registers(%arg0: tensor<1024xf32, #blocked0>) -> tensor<32x32xf32, #blocked1> {
+    %0 = tt.view %arg0 : (tensor<1024xf32, #blocked0>) -> tensor<32x32xf32, #blocked3>
+    %1 = triton_gpu.convert_layout %0 : (tensor<32x32xf32, #blocked3>) -> tensor<32x32xf32, #blocked1>
+    tt.return %1 : tensor<32x32xf32, #blocked1>
+  }
+
+  // The threads of #blocked2 replicate the elements of the tensor, so the
+  // conversion stays.
+  // CHECK-LABEL: view_replicated
+  // CHECK: tt.view
+  // CHECK: triton_gpu.convert_layout
+  tt.func @view_replicated(%arg0: tensor<256xf32, #blocked0>) -> tensor<16x16xf32, #blocked2> {
+    %0 = tt.view %arg0 : (tensor<256xf32, #blocked0>) -> tensor<16x16xf32, #blocked4>
+    %1 = triton_gpu.convert_layout %0 : (tensor<16x16xf32, #blocked4>) -> tensor<16x16xf32, #blocked2>
+    tt.return %1 : tensor<16x16xf32, #blocked2>
+  }
+
+  // The conversion moves through the view to the range, where it folds.
+  // CHECK-LABEL: view_of_range
+  // CHECK-NOT: triton_gpu.convert_layout
+  // CHECK: tt.make_range {{.*}} : tensor<1024xi32, [[$VIEW_SRC]]>
+  // CHECK: tt.view %{{.*}} -> tensor<32x32xi32, [[$VIEW_DST]]>
+  // CHECK-NOT: triton_gpu.convert_layout
+  // CHECK: tt.return
+  tt.func @view_of_range() -> tensor<32x32xi32, #blocked1> {
+    %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #blocked0>
+    %1 = arith.muli %0, %0 : tensor<1024xi32, #blocked0>
+    %2 = tt.view %1 : (tensor<1024xi32, #blocked0>) -> tensor<32x32xi32, #blocked3>
+    %3 = arith.addi %2, %2 : tensor<32x32xi32, #blocked3>
+    %4 = triton_gpu.convert_layout %3 : (tensor<32x32xi32, #blocked3>) -> tensor<32x32xi32, #blocked1>
+    tt.return %4 : tensor<32x32xi32, #blocked1>
+  }
+}
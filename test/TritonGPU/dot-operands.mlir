@@ -137,3 +137,43 @@ tt.func @update_kwidth_slice(
 }
 
 }
+
+// -----
+
+#blockedA = #triton_gpu.blocked<{sizePerThread = [1, 2], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#blockedB = #triton_gpu.blocked<{sizePerThread = [2, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 4], order = [0, 1]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [1, 4]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// CHECK: #[[BB:.*]] = #triton_gpu.blocked<{sizePerThread = [2, 1], threadsPerWarp = [8, 4], warpsPerCTA = [1, 4], order = [0, 1]}>
+// CHECK: #[[MMA:.*]] = #triton_gpu.mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [1, 4]}>
+
+// CHECK: tt.func @push_dequant_chain
+// CHECK-DAG: %[[SHIFT:.+]] = arith.constant dense<4> : tensor<16x16xi8, #triton_gpu.dot_op<{opIdx = 1, parent = #[[MMA]], kWidth = 4}>>
+// CHECK-DAG: %[[BLOAD:.*]] = tt.load %{{.*}} : tensor<16x16xi8, #[[BB]]>
+// CHECK-DAG: %[[SLOAD:.*]] = tt.load %{{.*}} : tensor<16x16xf16, #[[BB]]>
+// CHECK-DAG: %[[BCVT:.*]] = triton_gpu.convert_layout %[[BLOAD]] : (tensor<16x16xi8, #[[BB]]>) -> tensor<16x16xi8, #triton_gpu.dot_op<{opIdx = 1, parent = #[[MMA]], kWidth = 4}>>
+// CHECK-DAG: %[[SCVT:.*]] = triton_gpu.convert_layout %[[SLOAD]] : (tensor<16x16xf16, #[[BB]]>) -> tensor<16x16xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #[[MMA]], kWidth = 4}>>
+// CHECK: %[[BSHR:.*]] = arith.shrsi %[[BCVT]], %[[SHIFT]] : tensor<16x16xi8, #triton_gpu.dot_op<{opIdx = 1, parent = #[[MMA]], kWidth = 4}>>
+// CHECK: %[[BF16:.*]] = arith.sitofp %[[BSHR]] : tensor<16x16xi8, #triton_gpu.dot_op<{opIdx = 1, parent = #[[MMA]], kWidth = 4}>> to tensor<16x16xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #[[MMA]], kWidth = 4}>>
+// CHECK: %[[BDQ:.*]] = arith.mulf %[[BF16]], %[[SCVT]] : tensor<16x16xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #[[MMA]], kWidth = 4}>>
+// CHECK: tt.dot %{{.*}}, %[[BDQ]], %{{.*}}
+tt.func @push_dequant_chain(
+                   %pa: tensor<16x16x!tt.ptr<f16>, #blockedA> {tt.divisibility=16: i32, tt.contiguity=2 : i32},
+                   %pb: tensor<16x16x!tt.ptr<i8>, #blockedB> {tt.divisibility=16: i32, tt.contiguity=2 : i32},
+                   %ps: tensor<16x16x!tt.ptr<f16>, #blockedB> {tt.divisibility=16: i32, tt.contiguity=2 : i32},
+                   %c: tensor<16x16xf32, #mma>) -> tensor<16x16xf32, #mma>{
+  %shift = arith.constant dense<4> : tensor<16x16xi8, #blockedB>
+  %a = tt.load %pa {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16xf16, #blockedA>
+  %b = tt.load %pb {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16xi8, #blockedB>
+  %s = tt.load %ps {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16xf16, #blockedB>
+  %bshr = arith.shrsi %b, %shift : tensor<16x16xi8, #blockedB>
+  %bf16 = arith.sitofp %bshr : tensor<16x16xi8, #blockedB> to tensor<16x16xf16, #blockedB>
+  %bdq = arith.mulf %bf16, %s : tensor<16x16xf16, #blockedB>
+  %al = triton_gpu.convert_layout %a : (tensor<16x16xf16, #blockedA>) -> tensor<16x16xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 4}>>
+  %bl = triton_gpu.convert_layout %bdq : (tensor<16x16xf16, #blockedB>) -> tensor<16x16xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 4}>>
+  %r = tt.dot %al, %bl, %c {allowTF32 = true} : tensor<16x16xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 4}>> * tensor<16x16xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 4}>> -> tensor<16x16xf32, #mma>
+  tt.return %r : tensor<16x16xf32, #mma>
+}
+
+}
@@ -0,0 +1,89 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-flatten-loops | FileCheck %s
+
+#BLK = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+
+// CHECK-LABEL: tt.func @persistent_sum
+// CHECK: %[[OUTER_TRIP:.*]] = arith.maxsi
+// CHECK: %[[INNER_TRIP:.*]] = arith.maxsi
+// CHECK: %[[HAS_ITERS:.*]] = arith.cmpi sgt, %[[INNER_TRIP]]
+// CHECK: %[[TOTAL:.*]] = arith.muli {{.*}} : i64
+// CHECK: %[[FITS:.*]] = arith.cmpi sle, %[[TOTAL]]
+// CHECK: %[[CAN_FLATTEN:.*]] = arith.andi %[[HAS_ITERS]], %[[FITS]]
+// CHECK: scf.if %[[CAN_FLATTEN]]
+// CHECK:   arith.muli %[[OUTER_TRIP]], %[[INNER_TRIP]] : i32
+// CHECK:   %[[FLAT:.*]] = scf.for
+// CHECK:     %[[FIRST:.*]] = arith.cmpi eq
+// CHECK:     tt.addptr
+// CHECK:     %[[FIRST_SPLAT:.*]] = tt.splat %[[FIRST]]
+// CHECK:     %[[ACC:.*]] = triton_gpu.select %[[FIRST_SPLAT]]
+// CHECK:     tt.load
+// CHECK:     arith.addf %[[ACC]]
+// CHECK:     %[[LAST:.*]] = arith.cmpi eq
+// CHECK:     scf.if %[[LAST]] {
+// CHECK:       tt.store
+// CHECK:     }
+// CHECK:     scf.yield
+// CHECK: } else {
+// CHECK:   scf.for
+// CHECK:     scf.for
+// CHECK-NOT: scf.for
+// CHECK:     tt.store
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+tt.func @persistent_sum(%num_tiles : i32, %num_ctas : i32, %k_tiles : i32,
+                        %X : !tt.ptr<f32> {tt.divisibility = 16 : i32},
+                        %Y : !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %pid = tt.get_program_id x : i32
+  %x_ptr_splat = tt.splat %X : (!tt.ptr<f32>) -> tensor<32x64x!tt.ptr<f32>, #BLK>
+  %y_ptr = tt.splat %Y : (!tt.ptr<f32>) -> tensor<32x64x!tt.ptr<f32>, #BLK>
+  %acc_init = arith.constant dense<0.00e+00> : tensor<32x64xf32, #BLK>
+  %x_off = arith.constant dense<64> : tensor<32x64xi32, #BLK>
+  scf.for %tile = %pid to %num_tiles step %num_ctas : i32 {
+    %tile_off = tt.splat %tile : (i32) -> tensor<32x64xi32, #BLK>
+    %x_ptr_init = tt.addptr %x_ptr_splat, %tile_off : tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xi32, #BLK>
+    %loop:2 = scf.for %k = %c0 to %k_tiles step %c1 iter_args(%x_ptr = %x_ptr_init, %prev_acc = %acc_init) -> (tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xf32, #BLK>) : i32 {
+      %x = tt.load %x_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x64xf32, #BLK>
+      %acc = arith.addf %prev_acc, %x : tensor<32x64xf32, #BLK>
+      %next_x_ptr = tt.addptr %x_ptr, %x_off : tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xi32, #BLK>
+      scf.yield %next_x_ptr, %acc : tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xf32, #BLK>
+    }
+    %y_ptr_tile = tt.addptr %y_ptr, %tile_off : tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xi32, #BLK>
+    tt.store %y_ptr_tile, %loop#1 : tensor<32x64xf32, #BLK>
+  }
+  tt.return
+}
+}
+
+// -----
+
+#BLK = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+
+// Loads before the inner loop would run at every iteration: not flattened
+// CHECK-LABEL: tt.func @pre_load
+// CHECK-NOT: scf.if
+// CHECK: scf.for
+// CHECK:   tt.load
+// CHECK:   scf.for
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+tt.func @pre_load(%num_tiles : i32, %k_tiles : i32,
+                  %X : !tt.ptr<f32> {tt.divisibility = 16 : i32},
+                  %Y : !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  %c0 = arith.constant 0 : i32
+  %c1 = arith.constant 1 : i32
+  %x_ptr_init = tt.splat %X : (!tt.ptr<f32>) -> tensor<32x64x!tt.ptr<f32>, #BLK>
+  %y_ptr = tt.splat %Y : (!tt.ptr<f32>) -> tensor<32x64x!tt.ptr<f32>, #BLK>
+  %x_off = arith.constant dense<64> : tensor<32x64xi32, #BLK>
+  scf.for %tile = %c0 to %num_tiles step %c1 : i32 {
+    %acc_init = tt.load %y_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x64xf32, #BLK>
+    %loop:2 = scf.for %k = %c0 to %k_tiles step %c1 iter_args(%x_ptr = %x_ptr_init, %prev_acc = %acc_init) -> (tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xf32, #BLK>) : i32 {
+      %x = tt.load %x_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x64xf32, #BLK>
+      %acc = arith.addf %prev_acc, %x : tensor<32x64xf32, #BLK>
+      %next_x_ptr = tt.addptr %x_ptr, %x_off : tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xi32, #BLK>
+      scf.yield %next_x_ptr, %acc : tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xf32, #BLK>
+    }
+    tt.store %y_ptr, %loop#1 : tensor<32x64xf32, #BLK>
+  }
+  tt.return
+}
+}
@@ -0,0 +1,44 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-pipeline="num-stages=0 shared-memory-budget=40000" -canonicalize | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-pipeline="num-stages=0 shared-memory-budget=8000" -canonicalize | FileCheck %s --check-prefix=SMALL
+
+#BLK = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#BLKs0 = #triton_gpu.slice<{parent=#BLK, dim=0}>
+
+// 4 stages of 8KB fit in the budget
+// CHECK: module attributes {{.*}}"triton_gpu.num-stages" = 4 : i32
+// CHECK-LABEL: tt.func @streaming_sum
+// CHECK: triton_gpu.alloc_tensor : tensor<4x32x64xf32
+// CHECK-COUNT-3: triton_gpu.insert_slice_async
+// CHECK: triton_gpu.async_wait {num = 2 : i32}
+// CHECK: scf.for
+// CHECK:   triton_gpu.async_wait {num = 2 : i32}
+// CHECK:   triton_gpu.convert_layout
+// CHECK:   triton_gpu.insert_slice_async
+// CHECK-NOT: triton_gpu.async_wait
+// CHECK: scf.yield
+// Not even 2 stages fit
+// SMALL-NOT: triton_gpu.num-stages
+// SMALL-LABEL: tt.func @streaming_sum
+// SMALL-NOT: triton_gpu.insert_slice_async
+// SMALL: tt.load
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+tt.func @streaming_sum(%lb : index, %ub : index, %step : index,
+                       %X : !tt.ptr<f32> {tt.divisibility = 16 : i32}) -> tensor<32x64xf32, #BLK> {
+  %x_ptr_splat = tt.splat %X : (!tt.ptr<f32>) -> tensor<32x64x!tt.ptr<f32>, #BLK>
+  %x_tmp0 = tt.make_range {end = 64: i32, start = 0: i32} : tensor<64xi32, #BLKs0>
+  %x_tmp1 = tt.expand_dims %x_tmp0 {axis = 0 : i32} : (tensor<64xi32, #BLKs0>) -> tensor<1x64xi32, #BLK>
+  %x_offs = tt.broadcast %x_tmp1 : (tensor<1x64xi32, #BLK>) -> tensor<32x64xi32, #BLK>
+  %x_ptr_init = tt.addptr %x_ptr_splat, %x_offs : tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xi32, #BLK>
+
+  %acc_init = arith.constant dense<0.00e+00> : tensor<32x64xf32, #BLK>
+  %x_off = arith.constant dense<64> : tensor<32x64xi32, #BLK>
+
+  %loop:2 = scf.for %iv = %lb to %ub step %step iter_args(%x_ptr = %x_ptr_init, %prev_acc = %acc_init) -> (tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xf32, #BLK>) {
+    %x = tt.load %x_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x64xf32, #BLK>
+    %acc = arith.addf %prev_acc, %x : tensor<32x64xf32, #BLK>
+    %next_x_ptr = tt.addptr %x_ptr, %x_off : tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xi32, #BLK>
+    scf.yield %next_x_ptr, %acc : tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xf32, #BLK>
+  }
+  tt.return %loop#1 : tensor<32x64xf32, #BLK>
+}
+}
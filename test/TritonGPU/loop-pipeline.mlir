@@ -1,4 +1,5 @@
 // RUN: triton-opt %s -split-input-file -tritongpu-pipeline=num-stages=3 -canonicalize | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-pipeline="num-stages=3 shared-memory-budget=16384" -canonicalize | FileCheck %s --check-prefix=SMALL
 
 // 4 warps
 // matmul: 128x32 @ 32x128 -> 128x128
@@ -33,7 +34,9 @@
 // CHECK: %[[A0:.*]] = triton_gpu.extract_slice %[[A1BUFFER]][0, 0, 0]
 // CHECK: %[[B0:.*]] = triton_gpu.extract_slice %[[B1BUFFER]][0, 0, 0]
 // CHECK: scf.for {{.*}} iter_args({{.*}}, {{.*}}, {{.*}}, {{.*}}, {{.*}}, %[[arg_a0:.*]] = %[[A0]], %[[arg_b0:.*]] = %[[B0]], {{.*}}, {{.*}}, {{.*}}, %[[PIPELINE_IDX:.*]] = %[[CONSTANT_2]], %[[LOOP_IDX:.*]] = %[[CONSTANT_1]]
+// CHECK:   triton_gpu.async_wait {num = 3 : i32}
 // CHECK:   %[[arg_a0_dot_op:.*]] = triton_gpu.convert_layout %[[arg_a0]]
+// CHECK:   triton_gpu.async_wait {num = 2 : i32}
 // CHECK:   %[[arg_b0_dot_op_0:.*]] = triton_gpu.convert_layout %[[arg_b0]]
 // CHECK:   %[[arg_b0_dot_op_1:.*]] = arith.mulf %[[arg_b0_dot_op_0]]
 // CHECK:   tt.dot %[[arg_a0_dot_op]], %[[arg_b0_dot_op_1]], {{.*}}
@@ -41,7 +44,7 @@
 // CHECK-DAG: %[[EXTRACT_IDX:.*]] = arith.remsi %[[LOOP_IDX]], %[[CONSTANT_3]]
 // CHECK:   %[[NEXT_A_BUFFER:.*]] = triton_gpu.insert_slice_async {{.*}}, {{.*}}, %[[INSERT_IDX]]
 // CHECK:   %[[NEXT_B_BUFFER:.*]] = triton_gpu.insert_slice_async {{.*}}, {{.*}}, %[[INSERT_IDX]]
-// CHECK:   triton_gpu.async_wait {num = 2 : i32}
+// CHECK-NOT: triton_gpu.async_wait
 // CHECK:   %[[NEXT_A:.*]] = triton_gpu.extract_slice %[[NEXT_A_BUFFER]][%[[EXTRACT_IDX]], 0, 0]
 // CHECK:   %[[NEXT_B:.*]] = triton_gpu.extract_slice %[[NEXT_B_BUFFER]][%[[EXTRACT_IDX]], 0, 0]
 // CHECK-DAG: %[[NEXT_PIPELINE_IDX:.*]] = arith.addi %[[PIPELINE_IDX]], %[[CONSTANT_1]]
@@ -107,14 +110,16 @@ tt.func @matmul_loop(%lb : index, %ub : index, %step : index,
 // CHECK:   %[[A0:.*]] = triton_gpu.extract_slice %[[A1BUFFER]][0, 0, 0]
 // CHECK:   %[[B0:.*]] = triton_gpu.extract_slice %[[B1BUFFER]][0, 0, 0]
 // CHECK:   scf.for {{.*}} iter_args({{.*}}, {{.*}}, {{.*}}, {{.*}}, {{.*}}, %[[arg_a0:.*]] = %[[A0]], %[[arg_b0:.*]] = %[[B0]], {{.*}}, {{.*}}, {{.*}}, %[[PIPELINE_IDX:.*]] = %[[CONSTANT_2]], %[[LOOP_IDX:.*]] = %[[CONSTANT_1]]
+// CHECK:     triton_gpu.async_wait {num = 3 : i32}
 // CHECK:     %[[arg_a0_dot_op:.*]] = triton_gpu.convert_layout %[[arg_a0]]
+// CHECK:     triton_gpu.async_wait {num = 2 : i32}
 // CHECK:     %[[arg_b0_dot_op:.*]] = triton_gpu.convert_layout %[[arg_b0]]
 // CHECK:     tt.dot %[[arg_a0_dot_op]], %[[arg_b0_dot_op]], {{.*}}
 // CHECK-DAG: %[[INSERT_IDX:.*]] = arith.remsi %[[PIPELINE_IDX]], %[[CONSTANT_3]]
 // CHECK-DAG: %[[EXTRACT_IDX:.*]] = arith.remsi %[[LOOP_IDX]], %[[CONSTANT_3]]
 // CHECK:     %[[NEXT_A_BUFFER:.*]] = triton_gpu.insert_slice_async {{.*}}, {{.*}}, %[[INSERT_IDX]]
 // CHECK:     %[[NEXT_B_BUFFER:.*]] = triton_gpu.insert_slice_async {{.*}}, {{.*}}, %[[INSERT_IDX]]
-// CHECK:     triton_gpu.async_wait {num = 2 : i32}
+// CHECK-NOT: triton_gpu.async_wait
 // CHECK:   %[[NEXT_A:.*]] = triton_gpu.extract_slice %[[NEXT_A_BUFFER]][%[[EXTRACT_IDX]], 0, 0]
 // CHECK:   %[[NEXT_B:.*]] = triton_gpu.extract_slice %[[NEXT_B_BUFFER]][%[[EXTRACT_IDX]], 0, 0]
 // CHECK-DAG: %[[NEXT_PIPELINE_IDX:.*]] = arith.addi %[[PIPELINE_IDX]], %[[CONSTANT_1]]
@@ -177,12 +182,13 @@ tt.func @matmul_loop_nested(%lb : index, %ub : index, %step : index,
 // CHECK: triton_gpu.async_wait {num = 1 : i32}
 // CHECK: %[[B0:.*]] = triton_gpu.extract_slice %[[B1BUFFER]][0, 0, 0]
 // CHECK: scf.for {{.*}} iter_args({{.*}}, {{.*}}, {{.*}}, %[[arg_b0:.*]] = %[[B0]], {{.*}}, {{.*}}, %[[PIPELINE_IDX:.*]] = %[[CONSTANT_2]], %[[LOOP_IDX:.*]] = %[[CONSTANT_1]]
+// CHECK:   triton_gpu.async_wait {num = 1 : i32}
 // CHECK:   %[[arg_b0_dot_op:.*]] = triton_gpu.convert_layout %[[arg_b0]]
 // CHECK:   tt.dot {{.*}}, %[[arg_b0_dot_op]], {{.*}}
 // CHECK-DAG: %[[INSERT_IDX:.*]] = arith.remsi %[[PIPELINE_IDX]], %[[CONSTANT_3]]
 // CHECK-DAG: %[[EXTRACT_IDX:.*]] = arith.remsi %[[LOOP_IDX]], %[[CONSTANT_3]]
 // CHECK:   %[[NEXT_B_BUFFER:.*]] = triton_gpu.insert_slice_async {{.*}}, {{.*}}, %[[INSERT_IDX]]
-// CHECK:   triton_gpu.async_wait {num = 1 : i32}
+// CHECK-NOT: triton_gpu.async_wait
 // CHECK:   %[[NEXT_B:.*]] = triton_gpu.extract_slice %[[NEXT_B_BUFFER]][%[[EXTRACT_IDX]], 0, 0]
 // CHECK-DAG: %[[NEXT_PIPELINE_IDX:.*]] = arith.addi %[[PIPELINE_IDX]], %[[CONSTANT_1]]
 // CHECK-DAG: %[[NEXT_LOOP_IDX:.*]] = arith.addi %[[LOOP_IDX]], %[[CONSTANT_1]]
@@ -238,7 +244,8 @@ tt.func @matmul_loop_single_pipeline(%lb : index, %ub : index, %step : index,
 // CHECK: %[[NEXT_BUFFER_1:.*]] = tt.addptr %arg14, {{.*}}
 // CHECK: triton_gpu.insert_slice_async %[[NEXT_BUFFER_1]]
 // CHECK: triton_gpu.insert_slice_async %[[NEXT_BUFFER_0]]
-// CHECK: triton_gpu.async_wait {num = 2 : i32}
+// CHECK-NOT: triton_gpu.async_wait
+// CHECK: scf.yield
 tt.func @lut_bmm_scalar(%77: i64 {tt.divisibility=16: i32},
                    %76: index,
                    %49: tensor<16x16x!tt.ptr<f16>, #AL> {tt.divisibility=16: i32, tt.contiguity=2 : i32},
@@ -282,7 +289,8 @@ tt.func @lut_bmm_scalar(%77: i64 {tt.divisibility=16: i32},
 // CHECK: %[[NEXT_BUFFER_1:.*]] = tt.addptr %arg14, {{.*}}
 // CHECK: triton_gpu.insert_slice_async %[[NEXT_BUFFER_1]]
 // CHECK: triton_gpu.insert_slice_async %[[NEXT_BUFFER_0]]
-// CHECK: triton_gpu.async_wait {num = 2 : i32}
+// CHECK-NOT: triton_gpu.async_wait
+// CHECK: scf.yield
 tt.func @lut_bmm_vector(%77: tensor<16x16xi64, #BL> {tt.divisibility=16: i32, tt.constancy=16: i32},
                    %76: index,
                    %49: tensor<16x16x!tt.ptr<f16>, #AL> {tt.divisibility=16: i32, tt.contiguity=2 : i32},
@@ -497,3 +505,46 @@ tt.func @dep_arg_two_uses(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32},
   }
   tt.return %91#3 : tensor<128x128xf32, #C>
 }
+
+// -----
+
+#BLK = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#BLKs0 = #triton_gpu.slice<{parent=#BLK, dim=0}>
+
+// A load that does not feed a dot is converted back to its layout
+// CHECK-LABEL: tt.func @streaming_sum
+// CHECK: triton_gpu.alloc_tensor : tensor<3x32x64xf32
+// CHECK: triton_gpu.insert_slice_async
+// CHECK: triton_gpu.insert_slice_async
+// CHECK: triton_gpu.async_wait {num = 1 : i32}
+// CHECK: %[[X0:.*]] = triton_gpu.extract_slice %{{.*}}[0, 0, 0]
+// CHECK: scf.for {{.*}} iter_args({{.*}}, {{.*}}, {{.*}}, %[[ARG_X:.*]] = %[[X0]], {{.*}}, {{.*}}, {{.*}}, {{.*}})
+// CHECK:   triton_gpu.async_wait {num = 1 : i32}
+// CHECK:   %[[X:.*]] = triton_gpu.convert_layout %[[ARG_X]] : ({{.*}}) -> tensor<32x64xf32, #blocked>
+// CHECK:   arith.addf %{{.*}}, %[[X]]
+// CHECK:   triton_gpu.insert_slice_async
+// CHECK-NOT: triton_gpu.async_wait
+// CHECK:   triton_gpu.extract_slice
+// Its buffers don't fit in 16KB
+// SMALL-LABEL: tt.func @streaming_sum
+// SMALL-NOT: triton_gpu.insert_slice_async
+// SMALL: tt.load
+tt.func @streaming_sum(%lb : index, %ub : index, %step : index,
+                       %X : !tt.ptr<f32> {tt.divisibility = 16 : i32}) -> tensor<32x64xf32, #BLK> {
+  %x_ptr_splat = tt.splat %X : (!tt.ptr<f32>) -> tensor<32x64x!tt.ptr<f32>, #BLK>
+  %x_tmp0 = tt.make_range {end = 64: i32, start = 0: i32} : tensor<64xi32, #BLKs0>
+  %x_tmp1 = tt.expand_dims %x_tmp0 {axis = 0 : i32} : (tensor<64xi32, #BLKs0>) -> tensor<1x64xi32, #BLK>
+  %x_offs = tt.broadcast %x_tmp1 : (tensor<1x64xi32, #BLK>) -> tensor<32x64xi32, #BLK>
+  %x_ptr_init = tt.addptr %x_ptr_splat, %x_offs : tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xi32, #BLK>
+
+  %acc_init = arith.constant dense<0.00e+00> : tensor<32x64xf32, #BLK>
+  %x_off = arith.constant dense<64> : tensor<32x64xi32, #BLK>
+
+  %loop:2 = scf.for %iv = %lb to %ub step %step iter_args(%x_ptr = %x_ptr_init, %prev_acc = %acc_init) -> (tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xf32, #BLK>) {
+    %x = tt.load %x_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x64xf32, #BLK>
+    %acc = arith.addf %prev_acc, %x : tensor<32x64xf32, #BLK>
+    %next_x_ptr = tt.addptr %x_ptr, %x_off : tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xi32, #BLK>
+    scf.yield %next_x_ptr, %acc : tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xf32, #BLK>
+  }
+  tt.return %loop#1 : tensor<32x64xf32, #BLK>
+}
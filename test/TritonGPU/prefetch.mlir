@@ -1,4 +1,5 @@
 // RUN: triton-opt %s -split-input-file -tritongpu-prefetch -canonicalize | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-prefetch=prefetch-depth=2 -canonicalize | FileCheck %s --check-prefix=DEPTH2
 
 // 4 warps
 // matmul: 128x32 @ 32x128 -> 128x128
@@ -31,6 +32,19 @@
 // CHECK-DAG:   %[[NEXT_B_PREFETCH_SMEM:.*]] = triton_gpu.extract_slice {{.*}}[0, 0] [16, 128]
 // CHECK-DAG:   %[[NEXT_B_PREFETCH:.*]] = triton_gpu.convert_layout %[[NEXT_B_PREFETCH_SMEM]]
 // CHECK:     scf.yield {{.*}}, {{.*}}, {{.*}}, {{.*}}, {{.*}}, %[[NEXT_A_PREFETCH_CVT]], %[[NEXT_B_PREFETCH]]
+
+// Both K slices are prefetched: no slice is loaded before the dots
+// DEPTH2-LABEL: tt.func @matmul_loop_mixed
+// DEPTH2-DAG: triton_gpu.extract_slice %{{.*}}[0, 0] [128, 16]
+// DEPTH2-DAG: triton_gpu.extract_slice %{{.*}}[0, 16] [128, 16]
+// DEPTH2:     scf.for
+// DEPTH2-NOT:   triton_gpu.extract_slice
+// DEPTH2:       tt.dot
+// DEPTH2:       tt.dot
+// DEPTH2-NOT:   tt.dot
+// DEPTH2-DAG:   triton_gpu.extract_slice %{{.*}}[0, 0] [128, 16]
+// DEPTH2-DAG:   triton_gpu.extract_slice %{{.*}}[0, 16] [128, 16]
+// DEPTH2:     scf.yield
 tt.func @matmul_loop_mixed(%lb : index, %ub : index, %step : index, %A : !tt.ptr<f8E5M2>, %B : !tt.ptr<f16>) -> tensor<128x128xf32, #C>{
   %a_ptr_init = tt.broadcast %A : (!tt.ptr<f8E5M2>) -> tensor<128x32x!tt.ptr<f8E5M2>, #AL>
   %b_ptr_init = tt.broadcast %B : (!tt.ptr<f16>) -> tensor<32x128x!tt.ptr<f16>, #BL>
@@ -66,3 +80,44 @@ tt.func @matmul_loop_mixed(%lb : index, %ub : index, %step : index, %A : !tt.ptr
   }
   tt.return %loop#4 : tensor<128x128xf32, #C>
 }
+
+// -----
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+
+// A loop-carried shared buffer read by a reduction is converted to registers
+// at the end of the previous iteration
+// CHECK-LABEL: tt.func @reduce_loop
+// CHECK:     %[[X0:.*]] = triton_gpu.convert_layout %{{.*}} : (tensor<128x32xf16, #shared>) -> tensor<128x32xf16, #blocked>
+// CHECK:     scf.for {{.*}} iter_args({{.*}}, %[[X_ARG:.*]] = %[[X0]])
+// CHECK-NOT:   triton_gpu.convert_layout
+// CHECK:       "tt.reduce"(%[[X_ARG]])
+// CHECK:       %[[X_NEXT_SMEM:.*]] = triton_gpu.convert_layout %{{.*}} : (tensor<128x32xf16, #blocked>) -> tensor<128x32xf16, #shared>
+// CHECK:       %[[X_NEXT:.*]] = triton_gpu.convert_layout %[[X_NEXT_SMEM]]
+// CHECK:       scf.yield {{.*}}, %[[X_NEXT]]
+tt.func @reduce_loop(%lb : index, %ub : index, %step : index, %X : !tt.ptr<f16>) -> tensor<128xf16, #triton_gpu.slice<{dim = 1, parent = #AL}>> {
+  %x_ptr_init = tt.broadcast %X : (!tt.ptr<f16>) -> tensor<128x32x!tt.ptr<f16>, #AL>
+  %x_off = arith.constant dense<4> : tensor<128x32xi32, #AL>
+  %acc_init = arith.constant dense<0.00e+00> : tensor<128xf16, #triton_gpu.slice<{dim = 1, parent = #AL}>>
+
+  %x_ = tt.load %x_ptr_init {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xf16, #AL>
+  %x_init = triton_gpu.convert_layout %x_ : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A>
+
+  %loop:3 = scf.for %iv = %lb to %ub step %step iter_args(%x_ptr = %x_ptr_init, %acc = %acc_init, %x = %x_init) -> (tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128xf16, #triton_gpu.slice<{dim = 1, parent = #AL}>>, tensor<128x32xf16, #A>) {
+    %x_reg = triton_gpu.convert_layout %x : (tensor<128x32xf16, #A>) -> tensor<128x32xf16, #AL>
+    %sum = "tt.reduce" (%x_reg) ({
+    ^bb0(%lhs: f16, %rhs: f16):
+      %add = arith.addf %lhs, %rhs : f16
+      tt.reduce.return %add : f16
+    }) {axis = 1 : i32} : (tensor<128x32xf16, #AL>) -> tensor<128xf16, #triton_gpu.slice<{dim = 1, parent = #AL}>>
+    %next_acc = arith.addf %acc, %sum : tensor<128xf16, #triton_gpu.slice<{dim = 1, parent = #AL}>>
+
+    %next_x_ptr = tt.addptr %x_ptr, %x_off : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+    %next_x_ = tt.load %next_x_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xf16, #AL>
+    %next_x = triton_gpu.convert_layout %next_x_ : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A>
+
+    scf.yield %next_x_ptr, %next_acc, %next_x : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128xf16, #triton_gpu.slice<{dim = 1, parent = #AL}>>, tensor<128x32xf16, #A>
+  }
+  tt.return %loop#1 : tensor<128xf16, #triton_gpu.slice<{dim = 1, parent = #AL}>>
+}
@@ -0,0 +1,48 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-rematerialize=register-budget=16 | FileCheck %s
+
+// The pointers of the store are computed again after the loop, which needs
+// more registers than the budget.
+// CHECK-LABEL: rematerialize_pointers
+//       CHECK:   scf.for
+//       CHECK:   tt.make_range
+//  CHECK-NEXT:   tt.splat
+//  CHECK-NEXT:   tt.addptr
+//  CHECK-NEXT:   tt.store
+#blocked = #triton_gpu.blocked<{sizePerThread = [8], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @rematerialize_pointers(%arg0: !tt.ptr<f32>, %arg1: i32) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c8 = arith.constant 8 : index
+    %cst = arith.constant dense<0.000000e+00> : tensor<1024xf32, #blocked>
+    %0 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32, #blocked>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<1024x!tt.ptr<f32>, #blocked>
+    %2 = tt.addptr %1, %0 : tensor<1024x!tt.ptr<f32>, #blocked>, tensor<1024xi32, #blocked>
+    %3 = scf.for %iv = %c0 to %c8 step %c1 iter_args(%acc = %cst) -> (tensor<1024xf32, #blocked>) {
+      %4 = arith.addf %acc, %acc : tensor<1024xf32, #blocked>
+      scf.yield %4 : tensor<1024xf32, #blocked>
+    }
+    tt.store %2, %3 {cache = 1 : i32, evict = 1 : i32} : tensor<1024xf32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+// Nothing changes when the function fits in the budget.
+// CHECK-LABEL: within_budget
+//       CHECK:   tt.make_range
+//  CHECK-NEXT:   tt.splat
+//  CHECK-NEXT:   tt.addptr
+//  CHECK-NEXT:   tt.load
+#blocked = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @within_budget(%arg0: !tt.ptr<f32>) {
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32, #blocked>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>, #blocked>
+    %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>, #blocked>, tensor<128xi32, #blocked>
+    %3 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32, #blocked>
+    tt.store %2, %3 {cache = 1 : i32, evict = 1 : i32} : tensor<128xf32, #blocked>
+    tt.return
+  }
+}
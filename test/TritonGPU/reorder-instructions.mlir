@@ -47,3 +47,77 @@ module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-war
     tt.return
   }
 }
+
+// -----
+
+// The loads from shared memory of the second dot are issued before the first
+// dot, so that they overlap with it
+// CHECK-LABEL: interleave_loads_and_mma
+//       CHECK: scf.for
+//       CHECK:   triton_gpu.convert_layout %{{.*}} -> tensor<64x16xf16, #triton_gpu.dot_op<{opIdx = 0
+//  CHECK-NEXT:   triton_gpu.convert_layout %{{.*}} -> tensor<16x64xf16, #triton_gpu.dot_op<{opIdx = 1
+//  CHECK-NEXT:   triton_gpu.convert_layout %{{.*}} -> tensor<64x16xf16, #triton_gpu.dot_op<{opIdx = 0
+//  CHECK-NEXT:   triton_gpu.convert_layout %{{.*}} -> tensor<16x64xf16, #triton_gpu.dot_op<{opIdx = 1
+//  CHECK-NEXT:   tt.dot
+//  CHECK-NEXT:   tt.dot
+//  CHECK-NEXT:   scf.yield
+#mma = #triton_gpu.mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [4, 1]}>
+#shared = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 4, order = [1, 0]}>
+#dotA = #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 2}>
+#dotB = #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 2}>
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @interleave_loads_and_mma(%a0: tensor<64x16xf16, #shared>, %b0: tensor<16x64xf16, #shared>,
+                                           %a1: tensor<64x16xf16, #shared>, %b1: tensor<16x64xf16, #shared>) -> tensor<64x64xf32, #mma> {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c16 = arith.constant 16 : index
+    %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #mma>
+    %res = scf.for %iv = %c0 to %c16 step %c1 iter_args(%acc = %cst) -> (tensor<64x64xf32, #mma>) {
+      %ad0 = triton_gpu.convert_layout %a0 : (tensor<64x16xf16, #shared>) -> tensor<64x16xf16, #dotA>
+      %bd0 = triton_gpu.convert_layout %b0 : (tensor<16x64xf16, #shared>) -> tensor<16x64xf16, #dotB>
+      %d0 = tt.dot %ad0, %bd0, %acc {allowTF32 = true} : tensor<64x16xf16, #dotA> * tensor<16x64xf16, #dotB> -> tensor<64x64xf32, #mma>
+      %ad1 = triton_gpu.convert_layout %a1 : (tensor<64x16xf16, #shared>) -> tensor<64x16xf16, #dotA>
+      %bd1 = triton_gpu.convert_layout %b1 : (tensor<16x64xf16, #shared>) -> tensor<16x64xf16, #dotB>
+      %d1 = tt.dot %ad1, %bd1, %d0 {allowTF32 = true} : tensor<64x16xf16, #dotA> * tensor<16x64xf16, #dotB> -> tensor<64x64xf32, #mma>
+      scf.yield %d1 : tensor<64x64xf32, #mma>
+    }
+    tt.return %res : tensor<64x64xf32, #mma>
+  }
+}
+
+// -----
+
+// Hoisting the loads of the second dot would exceed the register budget:
+// the first dot is issued first to free its operands
+// CHECK-LABEL: keep_order_under_pressure
+//       CHECK: scf.for
+//       CHECK:   triton_gpu.convert_layout
+//  CHECK-NEXT:   triton_gpu.convert_layout
+//  CHECK-NEXT:   tt.dot
+//  CHECK-NEXT:   triton_gpu.convert_layout
+//  CHECK-NEXT:   triton_gpu.convert_layout
+//  CHECK-NEXT:   tt.dot
+//  CHECK-NEXT:   scf.yield
+#mma = #triton_gpu.mma<{versionMajor = 2, versionMinor = 0, warpsPerCTA = [4, 1]}>
+#shared = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 4, order = [1, 0]}>
+#dotA = #triton_gpu.dot_op<{opIdx = 0, parent = #mma, kWidth = 2}>
+#dotB = #triton_gpu.dot_op<{opIdx = 1, parent = #mma, kWidth = 2}>
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @keep_order_under_pressure(%a0: tensor<256x16xf16, #shared>, %b0: tensor<16x256xf16, #shared>,
+                                            %a1: tensor<256x16xf16, #shared>, %b1: tensor<16x256xf16, #shared>) -> tensor<256x256xf32, #mma> {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c16 = arith.constant 16 : index
+    %cst = arith.constant dense<0.000000e+00> : tensor<256x256xf32, #mma>
+    %res = scf.for %iv = %c0 to %c16 step %c1 iter_args(%acc = %cst) -> (tensor<256x256xf32, #mma>) {
+      %ad0 = triton_gpu.convert_layout %a0 : (tensor<256x16xf16, #shared>) -> tensor<256x16xf16, #dotA>
+      %bd0 = triton_gpu.convert_layout %b0 : (tensor<16x256xf16, #shared>) -> tensor<16x256xf16, #dotB>
+      %d0 = tt.dot %ad0, %bd0, %acc {allowTF32 = true} : tensor<256x16xf16, #dotA> * tensor<16x256xf16, #dotB> -> tensor<256x256xf32, #mma>
+      %ad1 = triton_gpu.convert_layout %a1 : (tensor<256x16xf16, #shared>) -> tensor<256x16xf16, #dotA>
+      %bd1 = triton_gpu.convert_layout %b1 : (tensor<16x256xf16, #shared>) -> tensor<16x256xf16, #dotB>
+      %d1 = tt.dot %ad1, %bd1, %d0 {allowTF32 = true} : tensor<256x16xf16, #dotA> * tensor<16x256xf16, #dotB> -> tensor<256x256xf32, #mma>
+      scf.yield %d1 : tensor<256x256xf32, #mma>
+    }
+    tt.return %res : tensor<256x256xf32, #mma>
+  }
+}
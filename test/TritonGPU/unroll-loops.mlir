@@ -0,0 +1,105 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-unroll-loops | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-unroll-loops=register-budget=1 | FileCheck %s --check-prefix=BUDGET
+
+// The loop is fully unrolled, the load of the second iteration being issued
+// before the computations of the first.
+// CHECK-LABEL: unroll_interleave
+//   CHECK-NOT:   scf.for
+//       CHECK:   %[[X0:.*]] = tt.load
+//       CHECK:   %[[X1:.*]] = tt.load
+//       CHECK:   %[[ACC:.*]] = arith.addf %{{.*}}, %[[X0]]
+//       CHECK:   arith.addf %[[ACC]], %[[X1]]
+// Without registers for the loads in flight, the loop is left as is.
+// BUDGET-LABEL: unroll_interleave
+//       BUDGET:   scf.for
+//       BUDGET:   tt.load
+//   BUDGET-NOT:   tt.load
+//       BUDGET:   scf.yield
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @unroll_interleave(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+    %c0 = arith.constant 0 : i32
+    %c1 = arith.constant 1 : i32
+    %c2 = arith.constant 2 : i32
+    %c512 = arith.constant 512 : i32
+    %cst = arith.constant dense<0.000000e+00> : tensor<512xf32, #blocked>
+    %base = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<512x!tt.ptr<f32>, #blocked>
+    %0 = scf.for %iv = %c0 to %c2 step %c1 iter_args(%acc = %cst) -> (tensor<512xf32, #blocked>) : i32 {
+      %range = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked>
+      %off = arith.muli %iv, %c512 : i32
+      %offs = tt.splat %off : (i32) -> tensor<512xi32, #blocked>
+      %idx = arith.addi %range, %offs : tensor<512xi32, #blocked>
+      %ptrs = tt.addptr %base, %idx : tensor<512x!tt.ptr<f32>, #blocked>, tensor<512xi32, #blocked>
+      %x = tt.load %ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<512xf32, #blocked>
+      %next = arith.addf %acc, %x : tensor<512xf32, #blocked>
+      scf.yield %next : tensor<512xf32, #blocked>
+    }
+    %range = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked>
+    %out = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<512x!tt.ptr<f32>, #blocked>
+    %outs = tt.addptr %out, %range : tensor<512x!tt.ptr<f32>, #blocked>, tensor<512xi32, #blocked>
+    tt.store %outs, %0 {cache = 1 : i32, evict = 1 : i32} : tensor<512xf32, #blocked>
+    tt.return
+  }
+}
+
+// -----
+
+// Loads after a store of the previous iteration stay after it.
+// CHECK-LABEL: unroll_store
+//   CHECK-NOT:   scf.for
+//       CHECK:   tt.load
+//       CHECK:   tt.store
+//       CHECK:   tt.load
+//       CHECK:   tt.store
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @unroll_store(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+    %c0 = arith.constant 0 : i32
+    %c1 = arith.constant 1 : i32
+    %c2 = arith.constant 2 : i32
+    %c512 = arith.constant 512 : i32
+    %base = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<512x!tt.ptr<f32>, #blocked>
+    scf.for %iv = %c0 to %c2 step %c1 : i32 {
+      %range = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked>
+      %off = arith.muli %iv, %c512 : i32
+      %offs = tt.splat %off : (i32) -> tensor<512xi32, #blocked>
+      %idx = arith.addi %range, %offs : tensor<512xi32, #blocked>
+      %ptrs = tt.addptr %base, %idx : tensor<512x!tt.ptr<f32>, #blocked>, tensor<512xi32, #blocked>
+      %x = tt.load %ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<512xf32, #blocked>
+      %y = arith.addf %x, %x : tensor<512xf32, #blocked>
+      tt.store %ptrs, %y {cache = 1 : i32, evict = 1 : i32} : tensor<512xf32, #blocked>
+    }
+    tt.return
+  }
+}
+
+// -----
+
+// Loads whose address depends on a load of the previous iteration stay after
+// it.
+// CHECK-LABEL: unroll_dependent_address
+//   CHECK-NOT:   scf.for
+//       CHECK:   %[[V0:.*]] = tt.load
+//       CHECK:   %[[OFFS:.*]] = arith.addi %{{.*}}, %[[V0]]
+//       CHECK:   %[[PTRS:.*]] = tt.addptr %{{.*}}, %[[OFFS]]
+//       CHECK:   tt.load %[[PTRS]]
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 32 : i32} {
+  tt.func public @unroll_dependent_address(%arg0: !tt.ptr<i32> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<i32> {tt.divisibility = 16 : i32}) {
+    %c0 = arith.constant 0 : i32
+    %c1 = arith.constant 1 : i32
+    %c2 = arith.constant 2 : i32
+    %range = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked>
+    %base = tt.splat %arg0 : (!tt.ptr<i32>) -> tensor<512x!tt.ptr<i32>, #blocked>
+    %0 = scf.for %iv = %c0 to %c2 step %c1 iter_args(%offs = %range) -> (tensor<512xi32, #blocked>) : i32 {
+      %ptrs = tt.addptr %base, %offs : tensor<512x!tt.ptr<i32>, #blocked>, tensor<512xi32, #blocked>
+      %v = tt.load %ptrs {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<512xi32, #blocked>
+      %next = arith.addi %offs, %v : tensor<512xi32, #blocked>
+      scf.yield %next : tensor<512xi32, #blocked>
+    }
+    %out = tt.splat %arg1 : (!tt.ptr<i32>) -> tensor<512x!tt.ptr<i32>, #blocked>
+    %outs = tt.addptr %out, %range : tensor<512x!tt.ptr<i32>, #blocked>, tensor<512xi32, #blocked>
+    tt.store %outs, %0 {cache = 1 : i32, evict = 1 : i32} : tensor<512xi32, #blocked>
+    tt.return
+  }
+}
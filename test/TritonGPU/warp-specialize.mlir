@@ -0,0 +1,118 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-warp-specialize=num-stages=3 | FileCheck %s
+
+// 4 warps
+// matmul: 128x32 @ 32x128 -> 128x128
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#BL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+#ALs0 = #triton_gpu.slice<{parent=#AL, dim=0}>
+#BLs0 = #triton_gpu.slice<{parent=#BL, dim=0}>
+#C = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#A = #triton_gpu.dot_op<{opIdx = 0, parent = #C, kWidth=2}>
+#B = #triton_gpu.dot_op<{opIdx = 1, parent = #C, kWidth=2}>
+
+// CHECK: module attributes {{.*}}"triton_gpu.num-warp-groups" = 2 : i32
+// CHECK-LABEL: tt.func @matmul_loop
+// CHECK: %[[GROUP:.*]] = triton_gpu.get_warp_group_id : i32
+// CHECK: %[[ABUFFER:.*]] = triton_gpu.alloc_tensor : tensor<3x128x32xf16
+// CHECK: %[[BBUFFER:.*]] = triton_gpu.alloc_tensor : tensor<3x32x128xf16
+// CHECK: tt.make_range
+// CHECK: %[[IS_PRODUCER:.*]] = arith.cmpi eq, %[[GROUP]]
+// CHECK: scf.if %[[IS_PRODUCER]] {
+// Producer: fill the slots, then signal the last ones
+// CHECK:   %[[PRODUCER:.*]]:5 = scf.for
+// CHECK:     %[[SLOT:.*]] = arith.remui
+// CHECK:     scf.if
+// CHECK:       triton_gpu.named_barrier_wait {{.*}} {numThreads = 256 : i32}
+// CHECK:     triton_gpu.insert_slice_async {{.*}}, {{.*}}, %[[SLOT]]
+// CHECK:     triton_gpu.insert_slice_async {{.*}}, {{.*}}, %[[SLOT]]
+// CHECK:     triton_gpu.async_commit_group
+// CHECK:     triton_gpu.async_wait {num = 2 : i32}
+// CHECK:     scf.if
+// CHECK:       triton_gpu.named_barrier_arrive {{.*}} {numThreads = 256 : i32}
+// CHECK:     scf.yield
+// CHECK:   triton_gpu.async_wait {num = 0 : i32}
+// CHECK:   scf.for {{.*}} to %[[PRODUCER]]#4
+// CHECK:     triton_gpu.named_barrier_arrive
+// CHECK:   scf.for {{.*}} to %[[PRODUCER]]#4
+// CHECK:     triton_gpu.named_barrier_wait
+// Consumer: the original kernel, reading the operands from the slots
+// CHECK: } else {
+// CHECK:   scf.for
+// CHECK:     %[[CSLOT:.*]] = arith.remui
+// CHECK:     triton_gpu.named_barrier_wait
+// CHECK:     %[[A:.*]] = triton_gpu.extract_slice %[[ABUFFER]][%[[CSLOT]], 0, 0]
+// CHECK:     %[[B:.*]] = triton_gpu.extract_slice %[[BBUFFER]][%[[CSLOT]], 0, 0]
+// CHECK-NOT: tt.load
+// CHECK:     %[[A_DOT:.*]] = triton_gpu.convert_layout %[[A]]
+// CHECK:     %[[B_DOT:.*]] = triton_gpu.convert_layout %[[B]]
+// CHECK:     tt.dot %[[A_DOT]], %[[B_DOT]]
+// CHECK:     triton_gpu.named_barrier_arrive
+// CHECK:     scf.yield
+// CHECK:   tt.store
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+tt.func @matmul_loop(%lb : index, %ub : index, %step : index,
+                     %A : !tt.ptr<f16> {tt.divisibility = 16 : i32},
+                     %B : !tt.ptr<f16> {tt.divisibility = 16 : i32},
+                     %C : !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  // A ptrs
+  %a_ptr_splat = tt.splat %A : (!tt.ptr<f16>) -> tensor<128x32x!tt.ptr<f16>, #AL>
+  %a_tmp0 = tt.make_range {end = 32: i32, start = 0: i32} : tensor<32xi32, #ALs0>
+  %a_tmp1 = tt.expand_dims %a_tmp0 {axis = 0 : i32} : (tensor<32xi32, #ALs0>) -> tensor<1x32xi32, #AL>
+  %a_offs = tt.broadcast %a_tmp1 : (tensor<1x32xi32, #AL>) -> tensor<128x32xi32, #AL>
+  %a_ptr_init = tt.addptr %a_ptr_splat, %a_offs : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+  // B ptrs
+  %b_ptr_splat = tt.splat %B : (!tt.ptr<f16>) -> tensor<32x128x!tt.ptr<f16>, #BL>
+  %b_tmp0 = tt.make_range {end = 128: i32, start = 0: i32} : tensor<128xi32, #BLs0>
+  %b_tmp1 = tt.expand_dims %b_tmp0 {axis = 0 : i32} : (tensor<128xi32, #BLs0>) -> tensor<1x128xi32, #BL>
+  %b_offs = tt.broadcast %b_tmp1 : (tensor<1x128xi32, #BL>) -> tensor<32x128xi32, #BL>
+  %b_ptr_init = tt.addptr %b_ptr_splat, %b_offs : tensor<32x128x!tt.ptr<f16>, #BL>, tensor<32x128xi32, #BL>
+
+  %c_init = arith.constant dense<0.00e+00> : tensor<128x128xf32, #C>
+  %a_off = arith.constant dense<4> : tensor<128x32xi32, #AL>
+  %b_off = arith.constant dense<4> : tensor<32x128xi32, #BL>
+
+  %loop:3 = scf.for %iv = %lb to %ub step %step iter_args(%a_ptr = %a_ptr_init, %b_ptr = %b_ptr_init, %prev_c = %c_init) -> (tensor<128x32x!tt.ptr<f16>, #AL>, tensor<32x128x!tt.ptr<f16>, #BL>, tensor<128x128xf32, #C>) {
+    %a_ = tt.load %a_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xf16, #AL>
+    %a = triton_gpu.convert_layout %a_ : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A>
+    %b_ = tt.load %b_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x128xf16, #BL>
+    %b = triton_gpu.convert_layout %b_ : (tensor<32x128xf16, #BL>) -> tensor<32x128xf16, #B>
+
+    %c = tt.dot %a, %b, %prev_c {allowTF32 = true, transA = false, transB = false} : tensor<128x32xf16, #A> * tensor<32x128xf16, #B> -> tensor<128x128xf32, #C>
+
+    %next_a_ptr = tt.addptr %a_ptr, %a_off : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+    %next_b_ptr = tt.addptr %b_ptr, %b_off : tensor<32x128x!tt.ptr<f16>, #BL>, tensor<32x128xi32, #BL>
+    scf.yield %next_a_ptr, %next_b_ptr, %c : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<32x128x!tt.ptr<f16>, #BL>, tensor<128x128xf32, #C>
+  }
+  %c_ptr = tt.splat %C : (!tt.ptr<f32>) -> tensor<128x128x!tt.ptr<f32>, #C>
+  tt.store %c_ptr, %loop#2 : tensor<128x128xf32, #C>
+  tt.return
+}
+}
+
+// -----
+
+#BLK = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+
+// Only dot operands are streamed
+// CHECK-NOT: triton_gpu.num-warp-groups
+// CHECK-LABEL: tt.func @streaming_sum
+// CHECK-NOT: triton_gpu.get_warp_group_id
+// CHECK: tt.load
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+tt.func @streaming_sum(%lb : index, %ub : index, %step : index,
+                       %X : !tt.ptr<f32> {tt.divisibility = 16 : i32},
+                       %Y : !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  %x_ptr_init = tt.splat %X : (!tt.ptr<f32>) -> tensor<32x64x!tt.ptr<f32>, #BLK>
+  %acc_init = arith.constant dense<0.00e+00> : tensor<32x64xf32, #BLK>
+  %x_off = arith.constant dense<64> : tensor<32x64xi32, #BLK>
+  %loop:2 = scf.for %iv = %lb to %ub step %step iter_args(%x_ptr = %x_ptr_init, %prev_acc = %acc_init) -> (tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xf32, #BLK>) {
+    %x = tt.load %x_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x64xf32, #BLK>
+    %acc = arith.addf %prev_acc, %x : tensor<32x64xf32, #BLK>
+    %next_x_ptr = tt.addptr %x_ptr, %x_off : tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xi32, #BLK>
+    scf.yield %next_x_ptr, %acc : tensor<32x64x!tt.ptr<f32>, #BLK>, tensor<32x64xf32, #BLK>
+  }
+  %y_ptr = tt.splat %Y : (!tt.ptr<f32>) -> tensor<32x64x!tt.ptr<f32>, #BLK>
+  tt.store %y_ptr, %loop#1 : tensor<32x64xf32, #BLK>
+  tt.return
+}
+}
@@ -0,0 +1,181 @@
+#include "mlir/Analysis/CFGLoopInfo.h"
+#include "mlir/Dialect/GPU/IR/GPUDialect.h"
+#include "mlir/IR/Dominance.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/Allocation.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/Membar.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+
+using namespace mlir;
+using ::mlir::triton::gpu::SharedEncodingAttr;
+
+namespace {
+
+// Prints the properties of each function that decide the quality of the code
+// it lowers to, so that lit tests can lock them down:
+//   - the width in bits of each global access, as the LLVM lowering
+//     vectorizes it
+//   - the vector width in bits of each shared memory write and read
+//   - the number of barriers and warp syncs in the function and in each
+//     loop, once the membar analysis has inserted them
+//   - the shared memory footprint
+// Loops are found in the CFG, so scf has to be lowered to cf first, as for
+// the membar analysis.
+struct TestCodegenQualityPass
+    : public PassWrapper<TestCodegenQualityPass, OperationPass<ModuleOp>> {
+
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(TestCodegenQualityPass);
+
+  StringRef getArgument() const final { return "test-print-codegen-quality"; }
+  StringRef getDescription() const final {
+    return "print the access widths, barriers and shared memory footprint of "
+           "each function";
+  }
+
+  static unsigned getGlobalVecBits(ModuleAxisInfoAnalysis &axisInfo, Value ptr,
+                                   Value mask) {
+    unsigned bitWidth = triton::getPointeeBitWidth(ptr.getType());
+    if (!ptr.getType().isa<RankedTensorType>())
+      return bitWidth;
+    // Same as LoadStoreConversionBase::getVectorSize
+    unsigned vec =
+        std::min<unsigned>(128 / bitWidth, axisInfo.getPtrContiguity(ptr));
+    if (mask && !axisInfo.isAllTrueMask(mask))
+      vec = std::min(vec, axisInfo.getMaskAlignment(mask));
+    return vec * bitWidth;
+  }
+
+  // Same as storeDistributedToShared and loadSharedToDistributed: the
+  // vectors are as wide as both the shared layout and the elements each
+  // thread holds contiguously allow
+  static unsigned getSharedVecBits(Type sharedType, Type distributedType) {
+    auto sharedTy = sharedType.cast<RankedTensorType>();
+    auto sharedLayout = sharedTy.getEncoding().cast<SharedEncodingAttr>();
+    auto distributedLayout =
+        distributedType.cast<RankedTensorType>().getEncoding();
+    auto order = triton::gpu::getOrder(distributedLayout);
+    unsigned vec = 1;
+    if (order == sharedLayout.getOrder())
+      vec = std::min<unsigned>(
+          sharedLayout.getVec(),
+          triton::gpu::getContigPerThread(distributedLayout)[order[0]]);
+    unsigned bitWidth = sharedTy.getElementType().getIntOrFloatBitWidth();
+    return std::min<unsigned>(vec * bitWidth, 128);
+  }
+
+  // Same as InsertSliceAsyncOpConversion: the copies are as wide as the
+  // contiguity of the pointers, the shared layout and masks that are not
+  // known to be prefixes of the vectors allow
+  static unsigned getAsyncCopyVecBits(ModuleAxisInfoAnalysis &axisInfo,
+                                      triton::gpu::InsertSliceAsyncOp op) {
+    auto sharedLayout = op.getType()
+                            .cast<RankedTensorType>()
+                            .getEncoding()
+                            .cast<SharedEncodingAttr>();
+    unsigned vec = axisInfo.getPtrContiguity(op.getSrc());
+    if (sharedLayout.getVec() > 1)
+      vec = std::min(vec, sharedLayout.getVec());
+    Value mask = op.getMask();
+    if (mask && axisInfo.getMaskAlignment(mask) < vec &&
+        !axisInfo.isPrefixMask(mask, vec))
+      vec = axisInfo.getMaskAlignment(mask);
+    return vec * triton::getPointeeBitWidth(op.getSrc().getType());
+  }
+
+  static bool isShared(Type type) {
+    auto tensorTy = type.dyn_cast<RankedTensorType>();
+    return tensorTy && tensorTy.getEncoding() &&
+           tensorTy.getEncoding().isa<SharedEncodingAttr>();
+  }
+
+  static bool isBarrier(Operation &op) {
+    return isa<gpu::BarrierOp, triton::gpu::NamedBarrierWaitOp>(op);
+  }
+
+  static bool isWarpSync(Operation &op) {
+    return isa<triton::gpu::WarpSyncOp>(op);
+  }
+
+  static void printAccesses(raw_ostream &os, ModuleAxisInfoAnalysis &axisInfo,
+                            Operation *op) {
+    if (auto loadOp = dyn_cast<triton::LoadOp>(op)) {
+      os << op->getName() << " => global = "
+         << getGlobalVecBits(axisInfo, loadOp.getPtr(), loadOp.getMask())
+         << " bits\n";
+    } else if (auto storeOp = dyn_cast<triton::StoreOp>(op)) {
+      os << op->getName() << " => global = "
+         << getGlobalVecBits(axisInfo, storeOp.getPtr(), storeOp.getMask())
+         << " bits\n";
+    } else if (auto insertOp = dyn_cast<triton::gpu::InsertSliceAsyncOp>(op)) {
+      os << op->getName() << " => global = "
+         << getGlobalVecBits(axisInfo, insertOp.getSrc(), insertOp.getMask())
+         << " bits, shared store = "
+         << getAsyncCopyVecBits(axisInfo, insertOp) << " bits\n";
+    } else if (auto cvtOp = dyn_cast<triton::gpu::ConvertLayoutOp>(op)) {
+      Type srcTy = cvtOp.getSrc().getType();
+      Type dstTy = cvtOp.getType();
+      if (isShared(dstTy) && !isShared(srcTy))
+        os << op->getName()
+           << " => shared store = " << getSharedVecBits(dstTy, srcTy)
+           << " bits\n";
+      else if (isShared(srcTy) && !isShared(dstTy))
+        os << op->getName()
+           << " => shared load = " << getSharedVecBits(srcTy, dstTy)
+           << " bits\n";
+    }
+  }
+
+  void runOnOperation() override {
+    auto &os = llvm::errs();
+    ModuleOp moduleOp = getOperation();
+    ModuleAxisInfoAnalysis axisInfo(moduleOp);
+    ModuleAllocation allocation(moduleOp);
+    ModuleMembarAnalysis membarPass(&allocation);
+    membarPass.run();
+
+    moduleOp.walk([&](triton::FuncOp funcOp) {
+      auto opName = SymbolTable::getSymbolName(funcOp).getValue().str();
+      unsigned barriers = 0, warpSyncs = 0;
+      funcOp.walk([&](Operation *op) {
+        barriers += isBarrier(*op);
+        warpSyncs += isWarpSync(*op);
+      });
+      os << "@" << opName
+         << " => shared = " << allocation.getSharedMemorySize(funcOp)
+         << ", barriers = " << barriers << ", warp syncs = " << warpSyncs
+         << "\n";
+      funcOp.walk([&](Operation *op) { printAccesses(os, axisInfo, op); });
+
+      Region &body = funcOp.getBody();
+      if (body.hasOneBlock())
+        return;
+      DominanceInfo domInfo(funcOp);
+      CFGLoopInfo loopInfo(domInfo.getDomTree(&body));
+      // Loops are printed in the order of their headers
+      for (Block &block : body) {
+        CFGLoop *loop = loopInfo.getLoopFor(&block);
+        if (!loop || loop->getHeader() != &block)
+          continue;
+        unsigned loopBarriers = 0, loopWarpSyncs = 0;
+        for (Block *loopBlock : loop->getBlocks()) {
+          loopBarriers += llvm::count_if(*loopBlock, isBarrier);
+          loopWarpSyncs += llvm::count_if(*loopBlock, isWarpSync);
+        }
+        os << "loop depth " << loop->getLoopDepth()
+           << " => barriers = " << loopBarriers
+           << ", warp syncs = " << loopWarpSyncs << "\n";
+      }
+    });
+  }
+};
+
+} // namespace
+
+namespace mlir {
+namespace test {
+void registerTestCodegenQualityPass() {
+  PassRegistration<TestCodegenQualityPass>();
+}
+} // namespace test
+} // namespace mlir
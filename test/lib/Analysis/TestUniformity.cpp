@@ -0,0 +1,42 @@
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/Uniformity.h"
+
+using namespace mlir;
+
+namespace {
+
+struct TestUniformityPass
+    : public PassWrapper<TestUniformityPass, OperationPass<ModuleOp>> {
+
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(TestUniformityPass);
+
+  StringRef getArgument() const final { return "test-print-uniformity"; }
+  StringRef getDescription() const final {
+    return "print the result of the uniformity analysis";
+  }
+
+  void runOnOperation() override {
+    auto &os = llvm::errs();
+    ModuleOp moduleOp = getOperation();
+    ModuleAxisInfoAnalysis axisInfoAnalysis(moduleOp);
+    UniformityAnalysis analysis(axisInfoAnalysis);
+    moduleOp.walk([&](triton::FuncOp funcOp) {
+      auto opName = SymbolTable::getSymbolName(funcOp).getValue().str();
+      os << "@" << opName << "\n";
+      funcOp.walk([&](Operation *op) {
+        for (Value result : op->getResults())
+          os << op->getName() << " => "
+             << stringifyUniformity(analysis.getUniformity(result)) << "\n";
+      });
+    });
+  }
+};
+
+} // namespace
+
+namespace mlir {
+namespace test {
+void registerTestUniformityPass() { PassRegistration<TestUniformityPass>(); }
+} // namespace test
+} // namespace mlir
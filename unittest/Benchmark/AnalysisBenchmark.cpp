@@ -0,0 +1,269 @@
+//===- AnalysisBenchmark.cpp - Scaling of analyses and passes -------------===//
+//
+// Times the analyses and passes whose cost grows with the size of a module on
+// parametric TritonGPU modules of increasing size, and prints the empirical
+// exponent of each step of the scaling curve, so that superlinear behaviour
+// shows up long before it hits the largest kernels.
+//
+// Usage: triton-analysis-bench [max-size] [benchmark-name-filter]
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/ControlFlow/IR/ControlFlow.h"
+#include "mlir/Dialect/GPU/IR/GPUDialect.h"
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassManager.h"
+#include "triton/Analysis/Allocation.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Analysis/Membar.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <string>
+
+using namespace mlir;
+
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Module generators
+//===----------------------------------------------------------------------===//
+
+const char *kHeader = R"(
+#blocked = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#BL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A_SHARED = #triton_gpu.shared<{vec = 8, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+)";
+
+const char *kVec = "tensor<512xf32, #blocked>";
+const char *kOff = "tensor<512xi32, #blocked>";
+const char *kPtr = "tensor<512x!tt.ptr<f32>, #blocked>";
+
+// `n` loads from offsets computed by a chain of integer ops, all summed up:
+// thousands of values for the axis info and alignment analyses
+std::string genElementwise(int n) {
+  std::string s = kHeader;
+  s += "tt.func @kernel(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {\n";
+  s += llvm::formatv("  %r = tt.make_range {{end = 512 : i32, start = 0 : "
+                     "i32} : {0}\n",
+                     kOff);
+  s += llvm::formatv("  %c = arith.constant dense<4> : {0}\n", kOff);
+  s += llvm::formatv("  %p = tt.splat %arg0 : (!tt.ptr<f32>) -> {0}\n", kPtr);
+  s += llvm::formatv("  %o0 = arith.addi %r, %c : {0}\n", kOff);
+  s += llvm::formatv("  %s0 = arith.constant dense<0.0> : {0}\n", kVec);
+  for (int i = 1; i <= n; ++i) {
+    s += llvm::formatv("  %o{0} = arith.addi %o{1}, %c : {2}\n", i, i - 1,
+                       kOff);
+    s += llvm::formatv("  %p{0} = tt.addptr %p, %o{0} : {1}, {2}\n", i, kPtr,
+                       kOff);
+    s += llvm::formatv("  %v{0} = tt.load %p{0} {{cache = 1 : i32, evict = 1 "
+                       ": i32, isVolatile = false} : {1}\n",
+                       i, kVec);
+    s += llvm::formatv("  %s{0} = arith.addf %s{1}, %v{0} : {2}\n", i, i - 1,
+                       kVec);
+  }
+  s += llvm::formatv("  tt.store %p1, %s{0} {{cache = 1 : i32, evict = 1 : "
+                     "i32} : {1}\n",
+                     n, kVec);
+  s += "  tt.return\n}\n}\n";
+  return s;
+}
+
+// `n` shared buffers all live until the end of the function: `n^2`
+// interferences for the allocation analysis
+std::string genSharedBuffers(int n) {
+  std::string s = kHeader;
+  const char *reg = "tensor<32x32xf16, #AL>";
+  const char *smem = "tensor<32x32xf16, #A_SHARED>";
+  const char *out = "tensor<32x32xf16, #BL>";
+  s += "tt.func @kernel(%arg0: !tt.ptr<f16>) {\n";
+  s += llvm::formatv("  %p = tt.splat %arg0 : (!tt.ptr<f16>) -> "
+                     "tensor<32x32x!tt.ptr<f16>, #AL>\n");
+  s += llvm::formatv("  %a0 = arith.constant dense<0.0> : {0}\n", out);
+  for (int i = 1; i <= n; ++i) {
+    s += llvm::formatv("  %v{0} = tt.load %p {{cache = 1 : i32, evict = 1 : "
+                       "i32, isVolatile = false} : {1}\n",
+                       i, reg);
+    s += llvm::formatv(
+        "  %m{0} = triton_gpu.convert_layout %v{0} : ({1}) -> {2}\n", i, reg,
+        smem);
+  }
+  for (int i = 1; i <= n; ++i) {
+    s += llvm::formatv(
+        "  %l{0} = triton_gpu.convert_layout %m{0} : ({1}) -> {2}\n", i, smem,
+        out);
+    s += llvm::formatv("  %a{0} = arith.addf %a{1}, %l{0} : {2}\n", i, i - 1,
+                       out);
+  }
+  s += "  tt.return\n}\n}\n";
+  return s;
+}
+
+// Loops nested `n / 8` deep, each with a few ops on its loop-carried value
+std::string genLoopNest(int n) {
+  int depth = std::max(n / 8, 1);
+  std::string s = kHeader;
+  s += "tt.func @kernel(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, "
+       "%lb: index, %ub: index, %step: index) {\n";
+  s += llvm::formatv("  %r = tt.make_range {{end = 512 : i32, start = 0 : "
+                     "i32} : {0}\n",
+                     kOff);
+  s += llvm::formatv("  %p = tt.splat %arg0 : (!tt.ptr<f32>) -> {0}\n", kPtr);
+  s += llvm::formatv("  %acc_init = arith.constant dense<0.0> : {0}\n", kVec);
+  std::string carried = "%acc_init";
+  for (int d = 0; d < depth; ++d) {
+    s += llvm::formatv("  %acc{0} = scf.for %iv{0} = %lb to %ub step %step "
+                       "iter_args(%a{0} = {1}) -> ({2}) {{\n",
+                       d, carried, kVec);
+    s += llvm::formatv("  %q{0} = tt.addptr %p, %r : {1}, {2}\n", d, kPtr,
+                       kOff);
+    s += llvm::formatv("  %x{0} = tt.load %q{0} {{cache = 1 : i32, evict = 1 "
+                       ": i32, isVolatile = false} : {1}\n",
+                       d, kVec);
+    s += llvm::formatv("  %b{0} = arith.addf %a{0}, %x{0} : {1}\n", d, kVec);
+    carried = llvm::formatv("%b{0}", d).str();
+  }
+  for (int d = depth - 1; d >= 0; --d) {
+    s += llvm::formatv("  scf.yield {0} : {1}\n  }\n", carried, kVec);
+    carried = llvm::formatv("%acc{0}", d).str();
+  }
+  s += llvm::formatv("  tt.store %p, {0} {{cache = 1 : i32, evict = 1 : "
+                     "i32} : {1}\n",
+                     carried, kVec);
+  s += "  tt.return\n}\n}\n";
+  return s;
+}
+
+// `n` elementwise ops, each behind a round trip through another layout that
+// the layout conversion removal has to see through
+std::string genLayoutConversions(int n) {
+  std::string s = kHeader;
+  const char *vec1 = "tensor<512xf32, #blocked1>";
+  s += "tt.func @kernel(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {\n";
+  s += llvm::formatv("  %r = tt.make_range {{end = 512 : i32, start = 0 : "
+                     "i32} : {0}\n",
+                     kOff);
+  s += llvm::formatv("  %p0 = tt.splat %arg0 : (!tt.ptr<f32>) -> {0}\n", kPtr);
+  s += llvm::formatv("  %p = tt.addptr %p0, %r : {0}, {1}\n", kPtr, kOff);
+  s += llvm::formatv("  %v0 = tt.load %p {{cache = 1 : i32, evict = 1 : i32, "
+                     "isVolatile = false} : {0}\n",
+                     kVec);
+  for (int i = 1; i <= n; ++i) {
+    s += llvm::formatv(
+        "  %w{0} = triton_gpu.convert_layout %v{1} : ({2}) -> {3}\n", i, i - 1,
+        kVec, vec1);
+    s += llvm::formatv("  %e{0} = math.exp %w{0} : {1}\n", i, vec1);
+    s += llvm::formatv(
+        "  %v{0} = triton_gpu.convert_layout %e{0} : ({1}) -> {2}\n", i, vec1,
+        kVec);
+  }
+  s += llvm::formatv("  tt.store %p, %v{0} {{cache = 1 : i32, evict = 1 : "
+                     "i32} : {1}\n",
+                     n, kVec);
+  s += "  tt.return\n}\n}\n";
+  return s;
+}
+
+//===----------------------------------------------------------------------===//
+// Benchmarks
+//===----------------------------------------------------------------------===//
+
+struct Benchmark {
+  const char *name;
+  std::function<std::string(int)> generate;
+  std::function<void(ModuleOp)> run;
+};
+
+void runPass(ModuleOp moduleOp, std::unique_ptr<Pass> pass) {
+  PassManager pm(moduleOp.getContext());
+  pm.addPass(std::move(pass));
+  if (failed(pm.run(moduleOp)))
+    llvm::report_fatal_error("benchmark pass failed");
+}
+
+const Benchmark kBenchmarks[] = {
+    {"axis-info/elementwise", genElementwise,
+     [](ModuleOp m) { ModuleAxisInfoAnalysis analysis(m); }},
+    {"axis-info/loop-nest", genLoopNest,
+     [](ModuleOp m) { ModuleAxisInfoAnalysis analysis(m); }},
+    {"allocation/shared-buffers", genSharedBuffers,
+     [](ModuleOp m) { ModuleAllocation allocation(m); }},
+    {"membar/shared-buffers", genSharedBuffers,
+     [](ModuleOp m) {
+       ModuleAllocation allocation(m);
+       ModuleMembarAnalysis membarPass(&allocation);
+       membarPass.run();
+     }},
+    {"remove-layout-conversions/chain", genLayoutConversions,
+     [](ModuleOp m) {
+       runPass(m, triton::gpu::createTritonGPURemoveLayoutConversionsPass());
+     }},
+    {"remove-layout-conversions/loop-nest", genLoopNest,
+     [](ModuleOp m) {
+       runPass(m, triton::gpu::createTritonGPURemoveLayoutConversionsPass());
+     }},
+};
+
+// Best of `reps` runs, each on a freshly parsed module since passes mutate it
+double timeMs(MLIRContext &context, const Benchmark &bench,
+              const std::string &source, int reps) {
+  double best = INFINITY;
+  for (int i = 0; i < reps; ++i) {
+    auto moduleOp = parseSourceString<ModuleOp>(source, &context);
+    if (!moduleOp)
+      llvm::report_fatal_error("failed to parse generated module");
+    auto start = std::chrono::steady_clock::now();
+    bench.run(*moduleOp);
+    auto end = std::chrono::steady_clock::now();
+    best = std::min(
+        best, std::chrono::duration<double, std::milli>(end - start).count());
+  }
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int maxSize = argc > 1 ? std::atoi(argv[1]) : 2048;
+  llvm::StringRef filter = argc > 2 ? argv[2] : "";
+
+  MLIRContext context;
+  context.loadDialect<triton::TritonDialect, triton::gpu::TritonGPUDialect,
+                      arith::ArithDialect, math::MathDialect, scf::SCFDialect,
+                      cf::ControlFlowDialect, gpu::GPUDialect>();
+  context.disableMultithreading();
+
+  auto &os = llvm::outs();
+  os << llvm::formatv("{0,-40} {1,8} {2,12} {3,10}\n", "benchmark", "size",
+                      "time (ms)", "exponent");
+  for (const Benchmark &bench : kBenchmarks) {
+    if (!llvm::StringRef(bench.name).contains(filter))
+      continue;
+    double prevMs = 0;
+    for (int size = 64; size <= maxSize; size *= 2) {
+      std::string source = bench.generate(size);
+      double ms = timeMs(context, bench, source, /*reps=*/3);
+      // Slope of the log-log scaling curve: ~1 is linear, ~2 quadratic
+      std::string exponent =
+          prevMs > 0.01 ? llvm::formatv("{0:f2}", std::log2(ms / prevMs)).str()
+                        : "-";
+      os << llvm::formatv("{0,-40} {1,8} {2,12:f3} {3,10}\n", bench.name,
+                          size, ms, exponent);
+      prevMs = ms;
+    }
+  }
+  return 0;
+}
@@ -143,5 +143,21 @@ TEST_F(PTXAsmFormatTest, onlyAttachMLIRArgs) {
   ASSERT_EQ(builder.getAllMLIRArgs().size(), 3);
 }
 
+TEST_F(PTXAsmFormatTest, temporaryStrings) {
+  PTXBuilder builder;
+
+  // The builder keeps its own copies of the suffixes and constraints.
+  auto &ld = *builder.create(std::string("ld"));
+  for (int width : {2, 4})
+    ld.o("v" + std::to_string(width), width == 4);
+  ld.o(std::string("b32"));
+  auto *dst = builder.newOperand(std::string("=r"));
+  auto *addr = builder.newAddrOperand(v[1], std::string("l"));
+  ld(dst, addr);
+
+  EXPECT_EQ(builder.dump(), "ld.v4.b32 $0, [ $1 + 0 ];");
+  EXPECT_EQ(builder.getConstraints(), "=r,l");
+}
+
 } // namespace triton
 } // namespace mlir